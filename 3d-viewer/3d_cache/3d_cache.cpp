@@ -29,8 +29,11 @@
 #include <fstream>
 #include <utility>
 #include <iterator>
+#include <algorithm>
+#include <set>
 
 #include <wx/datetime.h>
+#include <wx/dir.h>
 #include <wx/filename.h>
 #include <wx/log.h>
 #include <wx/stdpaths.h>
@@ -52,11 +55,26 @@
 #include "sg/scenegraph.h"
 #include "filename_resolver.h"
 #include "3d_plugin_manager.h"
+#include "3d_mesh_cache.h"
+#include "3d_mesh_simplify.h"
+#include "parallel_tasks.h"
 #include "plugins/3dapi/ifsg_api.h"
 
 
 #define MASK_3D_CACHE "3D_CACHE"
 
+// Size limit of the cache directory, shared by all projects
+#define MAX_3D_CACHE_DIR_SIZE ( 512ULL * 1024 * 1024 )
+
+// A level of detail is only kept if it has at most this fraction of the triangles of
+// the previous level
+#define MAX_LOD_TRIANGLE_RATIO 0.6
+
+// Error bounds of the levels of detail, relative to the model bounding box diagonal
+static const float s_lodError[S3D_MODEL_LOD_COUNT] = { 0.0f, 0.002f, 0.008f, 0.03f };
+
+wxDEFINE_EVENT( EVT_3D_MODELS_LOADED, wxCommandEvent );
+
 static wxCriticalSection lock3D_cache;
 
 
@@ -136,6 +154,13 @@ public:
     std::string   pluginInfo;   // PluginName:Version string
     SCENEGRAPH*   sceneData;
     S3DMODEL*     renderData;
+
+    /// simplified models of levels 1 to S3D_MODEL_LOD_COUNT - 1, NULL if a level is
+    /// not worth it
+    S3DMODEL*     lodData[S3D_MODEL_LOD_COUNT - 1];
+    bool          lodLoaded;
+
+    void DestroyLodData();
 };
 
 
@@ -143,7 +168,11 @@ S3D_CACHE_ENTRY::S3D_CACHE_ENTRY()
 {
     sceneData = NULL;
     renderData = NULL;
+    lodLoaded = false;
     memset( sha1sum, 0, 20 );
+
+    for( int i = 0; i < S3D_MODEL_LOD_COUNT - 1; ++i )
+        lodData[i] = NULL;
 }
 
 
@@ -154,6 +183,20 @@ S3D_CACHE_ENTRY::~S3D_CACHE_ENTRY()
 
     if( NULL != renderData )
         S3D::Destroy3DModel( &renderData );
+
+    DestroyLodData();
+}
+
+
+void S3D_CACHE_ENTRY::DestroyLodData()
+{
+    for( int i = 0; i < S3D_MODEL_LOD_COUNT - 1; ++i )
+    {
+        if( NULL != lodData[i] )
+            S3D::Destroy3DModel( &lodData[i] );
+    }
+
+    lodLoaded = false;
 }
 
 
@@ -168,6 +211,7 @@ void S3D_CACHE_ENTRY::SetSHA1( const unsigned char* aSHA1Sum )
     }
 
     memcpy( sha1sum, aSHA1Sum, 20 );
+    m_CacheBaseName.clear();
     return;
 }
 
@@ -183,6 +227,7 @@ const wxString S3D_CACHE_ENTRY::GetCacheBaseName( void )
 
 S3D_CACHE::S3D_CACHE()
 {
+    m_Prefetching = false;
     m_DirtyCache = false;
     m_FNResolver = new FILENAME_RESOLVER;
     m_Plugins = new S3D_PLUGIN_MANAGER;
@@ -205,7 +250,8 @@ S3D_CACHE::~S3D_CACHE()
 }
 
 
-SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr,
+                             bool aSceneData )
 {
     if( aCachePtr )
         *aCachePtr = NULL;
@@ -258,10 +304,17 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCach
                 if( NULL != mi->second->renderData )
                     S3D::Destroy3DModel( &mi->second->renderData );
 
-                mi->second->sceneData = m_Plugins->Load3DModel( full3Dpath, mi->second->pluginInfo );
+                mi->second->DestroyLodData();
+
+                if( aSceneData || !loadMeshData( mi->second ) )
+                    loadSceneData( mi->second, full3Dpath );
             }
         }
 
+        // the entry may have been created from a mesh cache file, without scene data
+        if( aSceneData && NULL == mi->second->sceneData && NULL != mi->second->renderData )
+            loadSceneData( mi->second, full3Dpath );
+
         if( NULL != aCachePtr )
             *aCachePtr = mi->second;
 
@@ -269,7 +322,7 @@ SCENEGRAPH* S3D_CACHE::load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCach
     }
 
     // a cache item does not exist; search the Filename->Cachename map
-    return checkCache( full3Dpath, aCachePtr );
+    return checkCache( full3Dpath, aCachePtr, aSceneData );
 }
 
 
@@ -279,7 +332,8 @@ SCENEGRAPH* S3D_CACHE::Load( const wxString& aModelFile )
 }
 
 
-SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr )
+SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr,
+                                   bool aSceneData )
 {
     if( aCachePtr )
         *aCachePtr = NULL;
@@ -336,18 +390,35 @@ SCENEGRAPH* S3D_CACHE::checkCache( const wxString& aFileName, S3D_CACHE_ENTRY**
 
     ep->SetSHA1( sha1sum );
 
-    wxString bname = ep->GetCacheBaseName();
-    wxString cachename = m_CacheDir + bname + wxT( ".3dc" );
+    // the renderers only need the meshes, which load much faster than the scene graph
+    if( !aSceneData && loadMeshData( ep ) )
+        return NULL;
 
-    if( wxFileName::FileExists( cachename ) && loadCacheData( ep ) )
-        return ep->sceneData;
+    loadSceneData( ep, aFileName );
 
-    ep->sceneData = m_Plugins->Load3DModel( aFileName, ep->pluginInfo );
+    return ep->sceneData;
+}
 
-    if( NULL != ep->sceneData )
-        saveCacheData( ep );
 
-    return ep->sceneData;
+bool S3D_CACHE::loadSceneData( S3D_CACHE_ENTRY* aCacheItem, const wxString& aFileName )
+{
+    wxString cachename = m_CacheDir + aCacheItem->GetCacheBaseName() + wxT( ".3dc" );
+
+    if( wxFileName::FileExists( cachename ) && loadCacheData( aCacheItem ) )
+    {
+        // keep the most recently used files when cleaning the cache directory
+        wxFileName( cachename ).Touch();
+        return true;
+    }
+
+    aCacheItem->sceneData = m_Plugins->Load3DModel( aFileName, aCacheItem->pluginInfo );
+
+    if( NULL == aCacheItem->sceneData )
+        return false;
+
+    saveCacheData( aCacheItem );
+
+    return true;
 }
 
 
@@ -502,6 +573,91 @@ bool S3D_CACHE::saveCacheData( S3D_CACHE_ENTRY* aCacheItem )
 }
 
 
+bool S3D_CACHE::loadMeshData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    if( m_CacheDir.empty() )
+        return false;
+
+    wxString fname = m_CacheDir + aCacheItem->GetCacheBaseName() + wxT( ".3dm" );
+
+    if( !wxFileName::FileExists( fname ) )
+        return false;
+
+    S3DMODEL* model = ReadMeshCache( fname );
+
+    if( NULL == model )
+        return false;
+
+    if( NULL != aCacheItem->renderData )
+        S3D::Destroy3DModel( &aCacheItem->renderData );
+
+    aCacheItem->DestroyLodData();
+    aCacheItem->renderData = model;
+
+    // keep the most recently used files when cleaning the cache directory
+    wxFileName( fname ).Touch();
+
+    return true;
+}
+
+
+bool S3D_CACHE::saveMeshData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    if( NULL == aCacheItem->renderData || m_CacheDir.empty() )
+        return false;
+
+    wxString fname = m_CacheDir + aCacheItem->GetCacheBaseName() + wxT( ".3dm" );
+
+    return WriteMeshCache( fname, *aCacheItem->renderData );
+}
+
+
+void S3D_CACHE::cleanCacheDir()
+{
+    wxArrayString files;
+
+    if( m_CacheDir.empty() ||
+        !wxDir::GetAllFiles( m_CacheDir, &files, wxT( "*.3d?" ), wxDIR_FILES ) )
+        return;
+
+    std::vector< std::pair< wxDateTime, wxString > > usedFiles;
+    unsigned long long dirSize = 0;
+
+    for( unsigned int i = 0; i < files.GetCount(); ++i )
+    {
+        wxFileName fname( files[i] );
+        wxULongLong size = fname.GetSize();
+
+        if( size != wxInvalidSize )
+            dirSize += size.GetValue();
+
+        usedFiles.push_back( std::make_pair( fname.GetModificationTime(), files[i] ) );
+    }
+
+    if( dirSize <= MAX_3D_CACHE_DIR_SIZE )
+        return;
+
+    // oldest files first
+    std::sort( usedFiles.begin(), usedFiles.end(),
+               []( const std::pair< wxDateTime, wxString >& a,
+                   const std::pair< wxDateTime, wxString >& b )
+               {
+                   return a.first.IsEarlierThan( b.first );
+               } );
+
+    for( unsigned int i = 0; i < usedFiles.size() && dirSize > MAX_3D_CACHE_DIR_SIZE; ++i )
+    {
+        wxULongLong size = wxFileName::GetSize( usedFiles[i].second );
+
+        if( size != wxInvalidSize && wxRemoveFile( usedFiles[i].second ) )
+            dirSize -= std::min( dirSize, (unsigned long long) size.GetValue() );
+    }
+
+    wxLogTrace( MASK_3D_CACHE, " * [3D model] cache directory cleaned, %llu bytes used",
+                dirSize );
+}
+
+
 bool S3D_CACHE::Set3DConfigDir( const wxString& aConfigDir )
 {
     if( !m_ConfigDir.empty() )
@@ -582,6 +738,8 @@ bool S3D_CACHE::Set3DConfigDir( const wxString& aConfigDir )
     }
 
     m_CacheDir = cfgdir.GetPathWithSep();
+    cleanCacheDir();
+
     return true;
 }
 
@@ -645,6 +803,8 @@ bool S3D_CACHE::SetProjectDir( const wxString& aProjDir )
 {
     bool hasChanged = false;
 
+    WaitForPrefetch();
+
     if( m_FNResolver->SetProjectDir( aProjDir, &hasChanged ) && hasChanged )
     {
         m_CacheMap.clear();
@@ -694,6 +854,8 @@ std::list< wxString > const* S3D_CACHE::GetFileFilters( void ) const
 
 void S3D_CACHE::FlushCache( bool closePlugins )
 {
+    WaitForPrefetch();
+
     std::list< S3D_CACHE_ENTRY* >::iterator sCL = m_CacheList.begin();
     std::list< S3D_CACHE_ENTRY* >::iterator eCL = m_CacheList.end();
 
@@ -722,30 +884,254 @@ void S3D_CACHE::ClosePlugins( void )
 }
 
 
-S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName )
+S3DMODEL* S3D_CACHE::GetModel( const wxString& aModelFileName, int aLod )
 {
     S3D_CACHE_ENTRY* cp = NULL;
-    SCENEGRAPH* sp = load( aModelFileName, &cp );
-
-    if( !sp )
-        return NULL;
+    SCENEGRAPH* sp = load( aModelFileName, &cp, false );
 
     if( !cp )
     {
-        wxLogTrace( MASK_3D_CACHE,
-                    "%s:%s:%d\n  * [BUG] model loaded with no associated S3D_CACHE_ENTRY",
-                    __FILE__, __FUNCTION__, __LINE__ );
+        if( sp )
+            wxLogTrace( MASK_3D_CACHE,
+                        "%s:%s:%d\n  * [BUG] model loaded with no associated S3D_CACHE_ENTRY",
+                        __FILE__, __FUNCTION__, __LINE__ );
 
         return NULL;
     }
 
-    if( cp->renderData )
-        return cp->renderData;
+    return getRenderData( cp, aLod );
+}
+
 
-    S3DMODEL* mp = S3D::GetModel( sp );
-    cp->renderData = mp;
+float S3D_CACHE::GetLodError( int aLod )
+{
+    return s_lodError[ std::max( 0, std::min( aLod, S3D_MODEL_LOD_COUNT - 1 ) ) ];
+}
+
+
+S3DMODEL* S3D_CACHE::getRenderData( S3D_CACHE_ENTRY* aCacheItem, int aLod )
+{
+    if( !aCacheItem->renderData && aCacheItem->sceneData )
+    {
+        aCacheItem->renderData = S3D::GetModel( aCacheItem->sceneData );
+
+        if( aCacheItem->renderData )
+            saveMeshData( aCacheItem );
+    }
+
+    if( !aCacheItem->renderData || aLod <= 0 )
+        return aCacheItem->renderData;
+
+    if( !aCacheItem->lodLoaded )
+        loadLodData( aCacheItem );
+
+    for( int lod = std::min( aLod, S3D_MODEL_LOD_COUNT - 1 ); lod > 0; --lod )
+    {
+        if( aCacheItem->lodData[lod - 1] )
+            return aCacheItem->lodData[lod - 1];
+    }
 
-    return mp;
+    return aCacheItem->renderData;
+}
+
+
+void S3D_CACHE::loadLodData( S3D_CACHE_ENTRY* aCacheItem )
+{
+    aCacheItem->lodLoaded = true;
+
+    const S3DMODEL& model = *aCacheItem->renderData;
+    unsigned int nTriangles = GetModelTriangleCount( model );
+
+    if( nTriangles < MIN_LOD_TRIANGLES )
+        return;
+
+    const float diagonal = GetModelDiagonal( model );
+
+    // The levels are saved next to the mesh cache file; the levels which do not remove
+    // enough triangles have no file and are created again (the simplification is much
+    // faster than the loading of the model)
+    for( int lod = 1; lod < S3D_MODEL_LOD_COUNT; ++lod )
+    {
+        wxString fname;
+        S3DMODEL* lodModel = NULL;
+
+        if( !m_CacheDir.empty() )
+        {
+            fname = m_CacheDir + aCacheItem->GetCacheBaseName() +
+                    wxString::Format( wxT( ".lod%d.3dm" ), lod );
+
+            if( wxFileName::FileExists( fname ) )
+            {
+                lodModel = ReadMeshCache( fname );
+
+                if( lodModel )
+                    wxFileName( fname ).Touch();
+            }
+        }
+
+        if( !lodModel )
+        {
+            lodModel = SimplifyModel( model, diagonal * s_lodError[lod] );
+
+            if( lodModel &&
+                GetModelTriangleCount( *lodModel ) > nTriangles * MAX_LOD_TRIANGLE_RATIO )
+            {
+                S3D::Destroy3DModel( &lodModel );
+            }
+
+            if( lodModel && !fname.empty() )
+                WriteMeshCache( fname, *lodModel );
+        }
+
+        if( lodModel )
+        {
+            aCacheItem->lodData[lod - 1] = lodModel;
+            nTriangles = GetModelTriangleCount( *lodModel );
+        }
+    }
+}
+
+
+void S3D_CACHE::prefetchModel( const wxString& aFullPath )
+{
+    S3D_CACHE_ENTRY* ep = new S3D_CACHE_ENTRY;
+    ep->modTime = wxFileName( aFullPath ).GetModificationTime();
+
+    // hashing the model file and reading the mesh cache do not use shared data
+    unsigned char sha1sum[20];
+    bool hashed = !m_CacheDir.empty() && getSHA1( aFullPath, sha1sum );
+
+    if( hashed )
+    {
+        ep->SetSHA1( sha1sum );
+        loadMeshData( ep );
+    }
+
+    if( hashed && NULL == ep->renderData )
+    {
+        // plugins are not reentrant, they are only used under the cache lock
+        wxCriticalSectionLocker lock( lock3D_cache );
+
+        if( m_CacheMap.find( aFullPath ) != m_CacheMap.end() )
+        {
+            delete ep;
+            return;
+        }
+
+        if( loadSceneData( ep, aFullPath ) )
+            getRenderData( ep );
+    }
+
+    // the levels of detail are built here rather than by the renderers, which would
+    // simplify the heavy models on the GUI thread
+    if( NULL != ep->renderData )
+        loadLodData( ep );
+
+    wxCriticalSectionLocker lock( lock3D_cache );
+
+    if( m_CacheMap.find( aFullPath ) != m_CacheMap.end() )
+    {
+        delete ep;
+        return;
+    }
+
+    m_CacheList.push_back( ep );
+    m_CacheMap.insert( std::pair< wxString, S3D_CACHE_ENTRY* >( aFullPath, ep ) );
+}
+
+
+void S3D_CACHE::PrefetchModels( const std::vector< wxString >& aModelFiles,
+                                wxEvtHandler* aNotifyHandler )
+{
+    std::vector< wxString > paths;
+
+    {
+        wxCriticalSectionLocker lock( lock3D_cache );
+
+        for( const wxString& modelFile : aModelFiles )
+        {
+            wxString full3Dpath = m_FNResolver->ResolvePath( modelFile );
+
+            if( !full3Dpath.empty() && m_CacheMap.find( full3Dpath ) == m_CacheMap.end() )
+                paths.push_back( full3Dpath );
+        }
+    }
+
+    std::lock_guard< std::mutex > lock( m_PrefetchLock );
+
+    // the models already requested are loaded or being loaded by the running prefetch
+    size_t nqueued = m_PrefetchQueue.size();
+
+    for( const wxString& path : paths )
+    {
+        if( m_PrefetchPaths.insert( path ).second )
+            m_PrefetchQueue.push_back( path );
+    }
+
+    if( m_PrefetchQueue.size() == nqueued && !m_Prefetching )
+        return;
+
+    if( aNotifyHandler && std::find( m_PrefetchHandlers.begin(), m_PrefetchHandlers.end(),
+                                     aNotifyHandler ) == m_PrefetchHandlers.end() )
+        m_PrefetchHandlers.push_back( aNotifyHandler );
+
+    // the running prefetch picks up the queued models before it ends
+    if( m_Prefetching )
+        return;
+
+    // m_Prefetching is cleared by the previous prefetch thread just before it exits, so
+    // it is joined without waiting
+    if( m_PrefetchThread.joinable() )
+        m_PrefetchThread.join();
+
+    m_Prefetching = true;
+
+    m_PrefetchThread = std::thread( [this]()
+    {
+        std::vector< wxEvtHandler* > handlers;
+        size_t nmodels = 0;
+
+        // the models queued while a batch loads are loaded by the next batch
+        while( true )
+        {
+            std::vector< wxString > paths;
+
+            {
+                std::lock_guard< std::mutex > queueLock( m_PrefetchLock );
+
+                if( m_PrefetchQueue.empty() )
+                {
+                    m_PrefetchPaths.clear();
+                    handlers.swap( m_PrefetchHandlers );
+                    m_Prefetching = false;
+                    break;
+                }
+
+                paths.assign( m_PrefetchQueue.begin(), m_PrefetchQueue.end() );
+                m_PrefetchQueue.clear();
+            }
+
+            PARALLEL_TASKS::Run( paths.size(), [&]( size_t i )
+            {
+                prefetchModel( paths[i] );
+            } );
+
+            nmodels += paths.size();
+        }
+
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] %u models loaded in the background",
+                    (unsigned int) nmodels );
+
+        for( wxEvtHandler* handler : handlers )
+            wxQueueEvent( handler, new wxCommandEvent( EVT_3D_MODELS_LOADED ) );
+    } );
+}
+
+
+void S3D_CACHE::WaitForPrefetch()
+{
+    if( m_PrefetchThread.joinable() )
+        m_PrefetchThread.join();
 }
 
 
@@ -29,8 +29,15 @@
 #ifndef CACHE_3D_H
 #define CACHE_3D_H
 
+#include <atomic>
+#include <deque>
 #include <list>
 #include <map>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+#include <wx/event.h>
 #include <wx/string.h>
 #include "kicad_string.h"
 #include "filename_resolver.h"
@@ -38,6 +45,9 @@
 #include "plugins/3dapi/c3dmodel.h"
 
 
+/// Number of levels of detail of the models; level 0 is the model as loaded
+#define S3D_MODEL_LOD_COUNT 4
+
 class  PGM_BASE;
 class  S3D_CACHE;
 class  S3D_CACHE_ENTRY;
@@ -45,6 +55,9 @@ class  SCENEGRAPH;
 class  FILENAME_RESOLVER;
 class  S3D_PLUGIN_MANAGER;
 
+/// Sent by S3D_CACHE to the handler given to PrefetchModels() when the models are loaded
+wxDECLARE_EVENT( EVT_3D_MODELS_LOADED, wxCommandEvent );
+
 
 class S3D_CACHE
 {
@@ -73,6 +86,24 @@ private:
     /// current KiCad project dir
     wxString m_ProjDir;
 
+    /// thread loading the models requested by PrefetchModels()
+    std::thread m_PrefetchThread;
+
+    /// set true while the prefetch thread is loading models
+    std::atomic<bool> m_Prefetching;
+
+    /// protects the prefetch queue, the requested paths and the handlers to notify
+    std::mutex m_PrefetchLock;
+
+    /// models waiting to be loaded by the prefetch thread (full paths)
+    std::deque< wxString > m_PrefetchQueue;
+
+    /// models requested since the prefetch thread started, loaded or not (full paths)
+    std::set< wxString > m_PrefetchPaths;
+
+    /// handlers to notify when the prefetch thread is done
+    std::vector< wxEvtHandler* > m_PrefetchHandlers;
+
     /** Find or create cache entry for file name
      *
      * Searches the cache list for the given filename and retrieves
@@ -81,10 +112,13 @@ private:
      *
      * @param[in]   aFileName   file name (full or partial path)
      * @param[out]  aCachePtr   optional return address for cache entry pointer
+     * @param[in]   aSceneData  set false when only the render data is needed; the
+     *                          scene data is not loaded if a mesh cache file exists
      * @return      SCENEGRAPH object associated with file name
      * @retval      NULL    on error
      */
-    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = NULL );
+    SCENEGRAPH* checkCache( const wxString& aFileName, S3D_CACHE_ENTRY** aCachePtr = NULL,
+                            bool aSceneData = true );
 
     /**
      * Function getSHA1
@@ -103,8 +137,37 @@ private:
     // save scene data to a cache file
     bool saveCacheData( S3D_CACHE_ENTRY* aCacheItem );
 
+    // load scene data from a cache file or, failing that, from the model file
+    bool loadSceneData( S3D_CACHE_ENTRY* aCacheItem, const wxString& aFileName );
+
+    // load render data from a mesh cache file
+    bool loadMeshData( S3D_CACHE_ENTRY* aCacheItem );
+
+    // save render data to a mesh cache file
+    bool saveMeshData( S3D_CACHE_ENTRY* aCacheItem );
+
+    // return the render data of a cache entry, converting the scene data if needed;
+    // aLod > 0 returns a simplified model, see GetModel()
+    S3DMODEL* getRenderData( S3D_CACHE_ENTRY* aCacheItem, int aLod = 0 );
+
+    // load the simplified models of a cache entry from the mesh cache files, creating
+    // the missing ones; called by the prefetch worker threads, and by getRenderData()
+    // for the models which were not prefetched
+    void loadLodData( S3D_CACHE_ENTRY* aCacheItem );
+
     // the real load function (can supply a cache entry pointer to member functions)
-    SCENEGRAPH* load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr = NULL );
+    SCENEGRAPH* load( const wxString& aModelFile, S3D_CACHE_ENTRY** aCachePtr = NULL,
+                      bool aSceneData = true );
+
+    // load a model not yet in the cache; called by the prefetch worker threads
+    void prefetchModel( const wxString& aFullPath );
+
+    /**
+     * Function cleanCacheDir
+     * deletes the least recently used cache files until the cache directory size is
+     * below MAX_3D_CACHE_DIR_SIZE.  Cache files are touched when they are used.
+     */
+    void cleanCacheDir();
 
 public:
     S3D_CACHE();
@@ -195,10 +258,57 @@ public:
      * attempts to load the scene data for a model and to translate it
      * into an S3D_MODEL structure for display by a renderer
      *
+     * Heavy models have simplified versions, created by PrefetchModels() (or on the
+     * first request for models which were not prefetched) and stored in the cache
+     * directory.  The level of detail aLod of a model differs from the
+     * model by at most GetLodError( aLod ) times the diagonal of its bounding box.  If
+     * the model has no such level, the closest finer level is returned.
+     *
      * @param aModelFileName is the full path to the model to be loaded
+     * @param aLod is the level of detail, 0 to S3D_MODEL_LOD_COUNT - 1
      * @return is a pointer to the render data or NULL if not available
      */
-    S3DMODEL* GetModel( const wxString& aModelFileName );
+    S3DMODEL* GetModel( const wxString& aModelFileName, int aLod = 0 );
+
+    /**
+     * Function GetLodError
+     * @return the maximum error of the level of detail aLod of the models, relative to
+     * the diagonal of their bounding box
+     */
+    static float GetLodError( int aLod );
+
+    /**
+     * Function PrefetchModels
+     * starts loading the given models in the background.  The models are loaded by
+     * several threads: the hashing of the model files and the reading of the mesh
+     * cache files run in parallel, plugins are invoked one at a time.
+     *
+     * This function does not block: if a prefetch is running, the models which are
+     * not already requested are queued and loaded by the running prefetch.
+     *
+     * While IsPrefetching() returns true, GetModel() may block until the prefetch is
+     * done; renderers should show placeholders instead.
+     *
+     * @param aModelFiles is the list of models (full or partial path) to be loaded
+     * @param aNotifyHandler is an optional handler which receives an
+     * EVT_3D_MODELS_LOADED event when all queued models are loaded; it must outlive
+     * the prefetch, see WaitForPrefetch()
+     */
+    void PrefetchModels( const std::vector< wxString >& aModelFiles,
+                         wxEvtHandler* aNotifyHandler = NULL );
+
+    /**
+     * Function IsPrefetching
+     * returns true while models requested by PrefetchModels() are being loaded
+     */
+    bool IsPrefetching() const { return m_Prefetching; }
+
+    /**
+     * Function WaitForPrefetch
+     * blocks until the models requested by PrefetchModels() are loaded, including
+     * the ones queued while the prefetch was running
+     */
+    void WaitForPrefetch();
 
     wxString GetModelHash( const wxString& aModelFileName );
 };
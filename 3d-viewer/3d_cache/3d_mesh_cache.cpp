@@ -0,0 +1,488 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.cpp
+ *
+ * File layout (host byte order, every block is padded to 4 bytes):
+ *
+ *   MESH_CACHE_HEADER
+ *   SMATERIAL[ m_materials ]
+ *   for each mesh:
+ *     MESH_CACHE_MESH
+ *     uint16_t[ 3 * m_vertexSize ]     positions, quantized in the mesh bounding box
+ *     int16_t[ 2 * m_vertexSize ]      normals, octahedral mapping
+ *     float[ 2 * m_vertexSize ]        texture coordinates, if MESH_HAS_TEXCOORDS
+ *     uint8_t[ 3 * m_vertexSize ]      colors, if MESH_HAS_COLORS
+ *     uint16_t or uint32_t[ m_faceIdxSize ]    indexes, 16 bits if m_vertexSize <= 65536
+ */
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+#include <stdint.h>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#include "3d_mesh_cache.h"
+#include "plugins/3dapi/ifsg_api.h"
+
+
+#define MASK_3D_CACHE "3D_CACHE"
+
+// Change the version when the layout of the file or of SMATERIAL changes
+#define MESH_CACHE_VERSION 1
+
+static const char MESH_CACHE_MAGIC[4] = { 'K', '3', 'D', 'M' };
+
+enum MESH_CACHE_FLAGS
+{
+    MESH_HAS_TEXCOORDS  = 1 << 0,
+    MESH_HAS_COLORS     = 1 << 1
+};
+
+
+struct MESH_CACHE_HEADER
+{
+    char     m_magic[4];
+    uint32_t m_version;
+    uint32_t m_materialSize;    ///< size of SMATERIAL, guards against a different layout
+    uint32_t m_materials;
+    uint32_t m_meshes;
+};
+
+
+struct MESH_CACHE_MESH
+{
+    uint32_t m_vertexSize;
+    uint32_t m_faceIdxSize;
+    uint32_t m_materialIdx;
+    uint32_t m_flags;
+    float    m_min[3];
+    float    m_max[3];
+};
+
+
+static size_t pad4( size_t aSize )
+{
+    return ( aSize + 3 ) & ~( (size_t) 3 );
+}
+
+
+static void appendBlock( std::vector<char>& aBuffer, const void* aData, size_t aSize )
+{
+    if( aSize == 0 )
+        return;
+
+    size_t offset = aBuffer.size();
+
+    aBuffer.resize( offset + pad4( aSize ), 0 );
+    memcpy( &aBuffer[offset], aData, aSize );
+}
+
+
+static void encodeNormal( const SFVEC3F& aNormal, int16_t* aDst )
+{
+    float l1 = fabs( aNormal.x ) + fabs( aNormal.y ) + fabs( aNormal.z );
+
+    if( l1 <= 0.0f )
+    {
+        aDst[0] = 0;
+        aDst[1] = 0;
+        return;
+    }
+
+    float x = aNormal.x / l1;
+    float y = aNormal.y / l1;
+
+    // Fold the lower hemisphere over the diagonals of the square
+    if( aNormal.z < 0.0f )
+    {
+        float ox = x;
+
+        x = ( 1.0f - fabs( y ) )  * ( ( x >= 0.0f ) ? 1.0f : -1.0f );
+        y = ( 1.0f - fabs( ox ) ) * ( ( y >= 0.0f ) ? 1.0f : -1.0f );
+    }
+
+    aDst[0] = (int16_t) lrintf( x * 32767.0f );
+    aDst[1] = (int16_t) lrintf( y * 32767.0f );
+}
+
+
+static SFVEC3F decodeNormal( const int16_t* aSrc )
+{
+    float x = aSrc[0] / 32767.0f;
+    float y = aSrc[1] / 32767.0f;
+    float z = 1.0f - fabs( x ) - fabs( y );
+
+    if( z < 0.0f )
+    {
+        float ox = x;
+
+        x = ( 1.0f - fabs( y ) )  * ( ( x >= 0.0f ) ? 1.0f : -1.0f );
+        y = ( 1.0f - fabs( ox ) ) * ( ( y >= 0.0f ) ? 1.0f : -1.0f );
+    }
+
+    return glm::normalize( SFVEC3F( x, y, z ) );
+}
+
+
+static uint8_t quantizeColor( float aValue )
+{
+    return (uint8_t) lrintf( glm::clamp( aValue, 0.0f, 1.0f ) * 255.0f );
+}
+
+
+bool WriteMeshCache( const wxString& aFileName, const S3DMODEL& aModel )
+{
+    std::vector<char> buffer;
+
+    MESH_CACHE_HEADER header;
+
+    memcpy( header.m_magic, MESH_CACHE_MAGIC, sizeof( header.m_magic ) );
+    header.m_version = MESH_CACHE_VERSION;
+    header.m_materialSize = sizeof( SMATERIAL );
+    header.m_materials = aModel.m_MaterialsSize;
+    header.m_meshes = aModel.m_MeshesSize;
+
+    appendBlock( buffer, &header, sizeof( header ) );
+
+    if( aModel.m_MaterialsSize )
+        appendBlock( buffer, aModel.m_Materials, aModel.m_MaterialsSize * sizeof( SMATERIAL ) );
+
+    for( unsigned int m = 0; m < aModel.m_MeshesSize; ++m )
+    {
+        const SMESH& mesh = aModel.m_Meshes[m];
+        const unsigned int nv = mesh.m_VertexSize;
+
+        if( ( nv && ( !mesh.m_Positions || !mesh.m_Normals ) ) ||
+            ( mesh.m_FaceIdxSize && !mesh.m_FaceIdx ) )
+        {
+            wxLogTrace( MASK_3D_CACHE, " * [3D model] cannot cache incomplete mesh data" );
+            return false;
+        }
+
+        MESH_CACHE_MESH info;
+
+        info.m_vertexSize = nv;
+        info.m_faceIdxSize = mesh.m_FaceIdxSize;
+        info.m_materialIdx = mesh.m_MaterialIdx;
+        info.m_flags = ( mesh.m_Texcoords ? MESH_HAS_TEXCOORDS : 0 ) |
+                       ( mesh.m_Color ? MESH_HAS_COLORS : 0 );
+
+        SFVEC3F bmin( 0.0f );
+        SFVEC3F bmax( 0.0f );
+
+        if( nv )
+        {
+            bmin = mesh.m_Positions[0];
+            bmax = mesh.m_Positions[0];
+
+            for( unsigned int i = 1; i < nv; ++i )
+            {
+                bmin = glm::min( bmin, mesh.m_Positions[i] );
+                bmax = glm::max( bmax, mesh.m_Positions[i] );
+            }
+        }
+
+        for( int i = 0; i < 3; ++i )
+        {
+            info.m_min[i] = bmin[i];
+            info.m_max[i] = bmax[i];
+        }
+
+        appendBlock( buffer, &info, sizeof( info ) );
+
+        const SFVEC3F extent = bmax - bmin;
+        const SFVEC3F scale( ( extent.x > 0.0f ) ? 65535.0f / extent.x : 0.0f,
+                             ( extent.y > 0.0f ) ? 65535.0f / extent.y : 0.0f,
+                             ( extent.z > 0.0f ) ? 65535.0f / extent.z : 0.0f );
+
+        std::vector<uint16_t> positions( 3 * nv );
+
+        for( unsigned int i = 0; i < nv; ++i )
+        {
+            const SFVEC3F q = ( mesh.m_Positions[i] - bmin ) * scale;
+
+            positions[3 * i + 0] = (uint16_t) lrintf( q.x );
+            positions[3 * i + 1] = (uint16_t) lrintf( q.y );
+            positions[3 * i + 2] = (uint16_t) lrintf( q.z );
+        }
+
+        appendBlock( buffer, positions.data(), positions.size() * sizeof( uint16_t ) );
+
+        std::vector<int16_t> normals( 2 * nv );
+
+        for( unsigned int i = 0; i < nv; ++i )
+            encodeNormal( mesh.m_Normals[i], &normals[2 * i] );
+
+        appendBlock( buffer, normals.data(), normals.size() * sizeof( int16_t ) );
+
+        if( mesh.m_Texcoords )
+            appendBlock( buffer, mesh.m_Texcoords, nv * sizeof( SFVEC2F ) );
+
+        if( mesh.m_Color )
+        {
+            std::vector<uint8_t> colors( 3 * nv );
+
+            for( unsigned int i = 0; i < nv; ++i )
+            {
+                colors[3 * i + 0] = quantizeColor( mesh.m_Color[i].r );
+                colors[3 * i + 1] = quantizeColor( mesh.m_Color[i].g );
+                colors[3 * i + 2] = quantizeColor( mesh.m_Color[i].b );
+            }
+
+            appendBlock( buffer, colors.data(), colors.size() );
+        }
+
+        if( nv <= 65536 )
+        {
+            std::vector<uint16_t> indexes( mesh.m_FaceIdx, mesh.m_FaceIdx + mesh.m_FaceIdxSize );
+
+            appendBlock( buffer, indexes.data(), indexes.size() * sizeof( uint16_t ) );
+        }
+        else
+        {
+            appendBlock( buffer, mesh.m_FaceIdx, mesh.m_FaceIdxSize * sizeof( unsigned int ) );
+        }
+    }
+
+    // Write to a temporary file first, so an other KiCad instance sharing the cache
+    // directory never reads a partially written file
+    wxString tmpName = aFileName + wxT( ".tmp" );
+
+    {
+        wxFFile file( tmpName, "wb" );
+
+        if( !file.IsOpened() ||
+            file.Write( buffer.data(), buffer.size() ) != buffer.size() || !file.Close() )
+        {
+            wxLogTrace( MASK_3D_CACHE, " * [3D model] cannot write mesh cache file '%s'",
+                        tmpName );
+            wxRemoveFile( tmpName );
+            return false;
+        }
+    }
+
+    return wxRenameFile( tmpName, aFileName, true );
+}
+
+
+/**
+ * Reads the blocks of a mesh cache file from a buffer, checking every access
+ * against the buffer size.
+ */
+class MESH_CACHE_READER
+{
+public:
+    MESH_CACHE_READER( const std::vector<char>& aBuffer ) :
+        m_buffer( aBuffer ),
+        m_offset( 0 )
+    {
+    }
+
+    const void* Read( size_t aSize )
+    {
+        if( aSize > m_buffer.size() - m_offset )
+            return NULL;
+
+        const void* data = m_buffer.data() + m_offset;
+        m_offset += std::min( pad4( aSize ), m_buffer.size() - m_offset );
+
+        return data;
+    }
+
+private:
+    const std::vector<char>& m_buffer;
+    size_t                   m_offset;
+};
+
+
+static bool readMesh( MESH_CACHE_READER& aReader, unsigned int aMaterials, SMESH& aMesh )
+{
+    const MESH_CACHE_MESH* info =
+            (const MESH_CACHE_MESH*) aReader.Read( sizeof( MESH_CACHE_MESH ) );
+
+    if( !info || info->m_materialIdx >= aMaterials || ( info->m_faceIdxSize % 3 ) )
+        return false;
+
+    const unsigned int nv = info->m_vertexSize;
+    const unsigned int ni = info->m_faceIdxSize;
+
+    const uint16_t* positions = (const uint16_t*) aReader.Read( 3 * (size_t) nv * sizeof( uint16_t ) );
+    const int16_t* normals = (const int16_t*) aReader.Read( 2 * (size_t) nv * sizeof( int16_t ) );
+    const SFVEC2F* texcoords = NULL;
+    const uint8_t* colors = NULL;
+
+    if( info->m_flags & MESH_HAS_TEXCOORDS )
+    {
+        texcoords = (const SFVEC2F*) aReader.Read( nv * sizeof( SFVEC2F ) );
+
+        if( !texcoords )
+            return false;
+    }
+
+    if( info->m_flags & MESH_HAS_COLORS )
+    {
+        colors = (const uint8_t*) aReader.Read( 3 * (size_t) nv );
+
+        if( !colors )
+            return false;
+    }
+
+    const void* indexes = aReader.Read( ni * ( ( nv <= 65536 ) ? sizeof( uint16_t )
+                                                                : sizeof( unsigned int ) ) );
+
+    if( !positions || !normals || !indexes )
+        return false;
+
+    const SFVEC3F bmin( info->m_min[0], info->m_min[1], info->m_min[2] );
+    const SFVEC3F scale = ( SFVEC3F( info->m_max[0], info->m_max[1], info->m_max[2] ) - bmin ) /
+                          65535.0f;
+
+    aMesh.m_VertexSize = nv;
+    aMesh.m_FaceIdxSize = ni;
+    aMesh.m_MaterialIdx = info->m_materialIdx;
+    aMesh.m_Positions = new SFVEC3F[nv];
+    aMesh.m_Normals = new SFVEC3F[nv];
+    aMesh.m_FaceIdx = new unsigned int[ni];
+
+    for( unsigned int i = 0; i < nv; ++i )
+    {
+        aMesh.m_Positions[i] = bmin + SFVEC3F( positions[3 * i + 0],
+                                               positions[3 * i + 1],
+                                               positions[3 * i + 2] ) * scale;
+        aMesh.m_Normals[i] = decodeNormal( &normals[2 * i] );
+    }
+
+    if( texcoords )
+    {
+        aMesh.m_Texcoords = new SFVEC2F[nv];
+        memcpy( aMesh.m_Texcoords, texcoords, nv * sizeof( SFVEC2F ) );
+    }
+
+    if( colors )
+    {
+        aMesh.m_Color = new SFVEC3F[nv];
+
+        for( unsigned int i = 0; i < nv; ++i )
+            aMesh.m_Color[i] = SFVEC3F( colors[3 * i + 0],
+                                        colors[3 * i + 1],
+                                        colors[3 * i + 2] ) / 255.0f;
+    }
+
+    if( nv <= 65536 )
+    {
+        const uint16_t* idx = (const uint16_t*) indexes;
+
+        for( unsigned int i = 0; i < ni; ++i )
+            aMesh.m_FaceIdx[i] = idx[i];
+    }
+    else
+    {
+        memcpy( aMesh.m_FaceIdx, indexes, ni * sizeof( unsigned int ) );
+    }
+
+    for( unsigned int i = 0; i < ni; ++i )
+    {
+        if( aMesh.m_FaceIdx[i] >= nv )
+            return false;
+    }
+
+    return true;
+}
+
+
+S3DMODEL* ReadMeshCache( const wxString& aFileName )
+{
+    // The whole file is read at once; the decoding touches all the data anyway
+    std::vector<char> buffer;
+
+    {
+        wxFFile file( aFileName, "rb" );
+
+        if( !file.IsOpened() )
+            return NULL;
+
+        wxFileOffset length = file.Length();
+
+        if( length < (wxFileOffset) sizeof( MESH_CACHE_HEADER ) )
+            return NULL;
+
+        buffer.resize( length );
+
+        if( file.Read( buffer.data(), length ) != (size_t) length )
+            return NULL;
+    }
+
+    MESH_CACHE_READER reader( buffer );
+
+    const MESH_CACHE_HEADER* header =
+            (const MESH_CACHE_HEADER*) reader.Read( sizeof( MESH_CACHE_HEADER ) );
+
+    if( memcmp( header->m_magic, MESH_CACHE_MAGIC, sizeof( header->m_magic ) ) ||
+        header->m_version != MESH_CACHE_VERSION ||
+        header->m_materialSize != sizeof( SMATERIAL ) ||
+        header->m_materials == 0 )
+    {
+        wxLogTrace( MASK_3D_CACHE, " * [3D model] incompatible mesh cache file '%s'",
+                    aFileName );
+        return NULL;
+    }
+
+    const unsigned int nmaterials = header->m_materials;
+    const unsigned int nmeshes = header->m_meshes;
+
+    const SMATERIAL* materials =
+            (const SMATERIAL*) reader.Read( nmaterials * (size_t) sizeof( SMATERIAL ) );
+
+    if( !materials || nmeshes > buffer.size() / sizeof( MESH_CACHE_MESH ) )
+        return NULL;
+
+    S3DMODEL* model = S3D::New3DModel();
+
+    model->m_MaterialsSize = nmaterials;
+    model->m_Materials = new SMATERIAL[nmaterials];
+    memcpy( model->m_Materials, materials, nmaterials * sizeof( SMATERIAL ) );
+
+    model->m_MeshesSize = nmeshes;
+    model->m_Meshes = new SMESH[nmeshes];
+
+    for( unsigned int m = 0; m < nmeshes; ++m )
+        S3D::Init3DMesh( model->m_Meshes[m] );
+
+    for( unsigned int m = 0; m < nmeshes; ++m )
+    {
+        if( !readMesh( reader, nmaterials, model->m_Meshes[m] ) )
+        {
+            wxLogTrace( MASK_3D_CACHE, " * [3D model] corrupted mesh cache file '%s'",
+                        aFileName );
+            S3D::Destroy3DModel( &model );
+            return NULL;
+        }
+    }
+
+    return model;
+}
@@ -0,0 +1,62 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_cache.h
+ * reads and writes the render data of 3D models (S3DMODEL) in a compact binary form
+ *
+ * The mesh cache files (.3dm) sit next to the scene graph cache files (.3dc) and let
+ * the renderers get a model without parsing and converting its scene graph.  The
+ * vertex data is quantized: positions to 16 bits relative to the mesh bounding box,
+ * normals to 2x16 bits (octahedral mapping) and colors to 8 bits per channel.  The
+ * data is only meant for display.
+ */
+
+#ifndef MESH_CACHE_3D_H
+#define MESH_CACHE_3D_H
+
+#include <wx/string.h>
+#include "plugins/3dapi/c3dmodel.h"
+
+/**
+ * Function WriteMeshCache
+ * writes the render data of a model to a mesh cache file, replacing any existing file.
+ *
+ * @param aFileName is the name of the file to write
+ * @param aModel is the model to store
+ * @return true on success
+ */
+bool WriteMeshCache( const wxString& aFileName, const S3DMODEL& aModel );
+
+/**
+ * Function ReadMeshCache
+ * reads a mesh cache file.  This function does not use any shared state, so it may be
+ * called from several threads at the same time.
+ *
+ * @param aFileName is the name of the file to read
+ * @return a new model, to be freed by S3D::Destroy3DModel(), or NULL if the file is
+ * missing, corrupted or was written by an incompatible version
+ */
+S3DMODEL* ReadMeshCache( const wxString& aFileName );
+
+#endif  // MESH_CACHE_3D_H
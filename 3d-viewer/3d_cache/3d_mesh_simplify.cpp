@@ -0,0 +1,375 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_simplify.cpp
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <stdint.h>
+
+#include <glm/glm.hpp>
+
+#include "3d_mesh_simplify.h"
+#include "plugins/3dapi/ifsg_api.h"
+
+
+// Number of bits of each grid coordinate in a cluster key; 3 more bits hold the
+// normal direction
+#define CLUSTER_COORD_BITS 20
+
+static const float CLUSTER_COORD_MAX = (float) ( ( 1 << CLUSTER_COORD_BITS ) - 1 );
+
+
+struct CLUSTER
+{
+    SFVEC3F      m_position;
+    SFVEC3F      m_normal;
+    SFVEC3F      m_color;
+    SFVEC2F      m_texcoord;
+    unsigned int m_count;
+    unsigned int m_direction;   ///< normal direction shared by the vertices, see normalDirection()
+};
+
+
+/// The vertexes of a triangle, the smallest first; the winding is kept
+struct TRIANGLE_KEY
+{
+    unsigned int m_v[3];
+
+    TRIANGLE_KEY( unsigned int a, unsigned int b, unsigned int c )
+    {
+        if( a < b && a < c )
+            m_v[0] = a, m_v[1] = b, m_v[2] = c;
+        else if( b < c )
+            m_v[0] = b, m_v[1] = c, m_v[2] = a;
+        else
+            m_v[0] = c, m_v[1] = a, m_v[2] = b;
+    }
+
+    bool operator==( const TRIANGLE_KEY& aOther ) const
+    {
+        return m_v[0] == aOther.m_v[0] && m_v[1] == aOther.m_v[1] && m_v[2] == aOther.m_v[2];
+    }
+};
+
+
+struct TRIANGLE_KEY_HASH
+{
+    size_t operator()( const TRIANGLE_KEY& aKey ) const
+    {
+        return ( (size_t) aKey.m_v[0] * 73856093u ) ^
+               ( (size_t) aKey.m_v[1] * 19349663u ) ^
+               ( (size_t) aKey.m_v[2] * 83492791u );
+    }
+};
+
+
+/**
+ * Returns the major axis of a normal and its sign, as 2 * axis + (negative ? 1 : 0).
+ * Only the vertexes with the same direction are merged, so the faces of a box or of
+ * a pin keep sharp edges.
+ */
+static unsigned int normalDirection( const SFVEC3F& aNormal )
+{
+    const SFVEC3F a = glm::abs( aNormal );
+
+    if( a.x >= a.y && a.x >= a.z )
+        return ( aNormal.x < 0.0f ) ? 1 : 0;
+
+    if( a.y >= a.z )
+        return ( aNormal.y < 0.0f ) ? 3 : 2;
+
+    return ( aNormal.z < 0.0f ) ? 5 : 4;
+}
+
+
+static bool getModelBBox( const S3DMODEL& aModel, SFVEC3F& aMin, SFVEC3F& aMax )
+{
+    bool found = false;
+
+    for( unsigned int m = 0; m < aModel.m_MeshesSize; ++m )
+    {
+        const SMESH& mesh = aModel.m_Meshes[m];
+
+        if( !mesh.m_Positions )
+            continue;
+
+        for( unsigned int i = 0; i < mesh.m_VertexSize; ++i )
+        {
+            if( !found )
+            {
+                aMin = mesh.m_Positions[i];
+                aMax = mesh.m_Positions[i];
+                found = true;
+            }
+
+            aMin = glm::min( aMin, mesh.m_Positions[i] );
+            aMax = glm::max( aMax, mesh.m_Positions[i] );
+        }
+    }
+
+    return found;
+}
+
+
+unsigned int GetModelTriangleCount( const S3DMODEL& aModel )
+{
+    unsigned int count = 0;
+
+    for( unsigned int m = 0; m < aModel.m_MeshesSize; ++m )
+        count += aModel.m_Meshes[m].m_FaceIdxSize / 3;
+
+    return count;
+}
+
+
+float GetModelDiagonal( const S3DMODEL& aModel )
+{
+    SFVEC3F bmin;
+    SFVEC3F bmax;
+
+    if( !getModelBBox( aModel, bmin, bmax ) )
+        return 0.0f;
+
+    return glm::length( bmax - bmin );
+}
+
+
+/**
+ * Simplifies a mesh by merging its vertexes in grid cells of size aCellSize.
+ * @return false if no triangle is left
+ */
+static bool simplifyMesh( const SMESH& aMesh, const SFVEC3F& aOrigin, float aCellSize,
+                          SMESH& aResult )
+{
+    const unsigned int nv = aMesh.m_VertexSize;
+
+    if( !nv || !aMesh.m_Positions || !aMesh.m_Normals || !aMesh.m_FaceIdx )
+        return false;
+
+    std::unordered_map< uint64_t, unsigned int > clusterIndex;
+    std::vector< CLUSTER > clusters;
+    std::vector< unsigned int > vertexCluster( nv );
+
+    for( unsigned int i = 0; i < nv; ++i )
+    {
+        const SFVEC3F cell = ( aMesh.m_Positions[i] - aOrigin ) / aCellSize;
+        const unsigned int direction = normalDirection( aMesh.m_Normals[i] );
+        uint64_t key = 0;
+
+        for( int axis = 0; axis < 3; ++axis )
+        {
+            float c = std::floor( cell[axis] );
+
+            // also catches NaN coordinates
+            if( !( c > 0.0f ) )
+                c = 0.0f;
+
+            key = ( key << CLUSTER_COORD_BITS ) | (uint64_t) std::min( c, CLUSTER_COORD_MAX );
+        }
+
+        key = ( key << 3 ) | direction;
+
+        auto it = clusterIndex.insert( std::make_pair( key, (unsigned int) clusters.size() ) );
+
+        if( it.second )
+        {
+            CLUSTER cluster;
+
+            cluster.m_position = SFVEC3F( 0.0f );
+            cluster.m_normal = SFVEC3F( 0.0f );
+            cluster.m_color = SFVEC3F( 0.0f );
+            cluster.m_texcoord = SFVEC2F( 0.0f );
+            cluster.m_count = 0;
+            cluster.m_direction = direction;
+
+            clusters.push_back( cluster );
+        }
+
+        CLUSTER& cluster = clusters[it.first->second];
+
+        cluster.m_position += aMesh.m_Positions[i];
+        cluster.m_normal += aMesh.m_Normals[i];
+
+        if( aMesh.m_Color )
+            cluster.m_color += aMesh.m_Color[i];
+
+        if( aMesh.m_Texcoords )
+            cluster.m_texcoord += aMesh.m_Texcoords[i];
+
+        cluster.m_count++;
+        vertexCluster[i] = it.first->second;
+    }
+
+    // Keep the triangles whose vertexes are in different clusters, once
+    std::unordered_set< TRIANGLE_KEY, TRIANGLE_KEY_HASH > usedTriangles;
+    std::vector< unsigned int > faces;
+
+    for( unsigned int i = 0; i + 2 < aMesh.m_FaceIdxSize; i += 3 )
+    {
+        const unsigned int* idx = &aMesh.m_FaceIdx[i];
+
+        if( idx[0] >= nv || idx[1] >= nv || idx[2] >= nv )
+            continue;
+
+        const unsigned int a = vertexCluster[idx[0]];
+        const unsigned int b = vertexCluster[idx[1]];
+        const unsigned int c = vertexCluster[idx[2]];
+
+        if( a == b || b == c || a == c )
+            continue;
+
+        if( !usedTriangles.insert( TRIANGLE_KEY( a, b, c ) ).second )
+            continue;
+
+        faces.push_back( a );
+        faces.push_back( b );
+        faces.push_back( c );
+    }
+
+    if( faces.empty() )
+        return false;
+
+    // Only the clusters used by a triangle become vertexes of the result
+    std::vector< unsigned int > vertexIndex( clusters.size(), UINT_MAX );
+    unsigned int nResult = 0;
+
+    for( unsigned int& f : faces )
+    {
+        if( vertexIndex[f] == UINT_MAX )
+            vertexIndex[f] = nResult++;
+
+        f = vertexIndex[f];
+    }
+
+    aResult.m_VertexSize = nResult;
+    aResult.m_Positions = new SFVEC3F[nResult];
+    aResult.m_Normals = new SFVEC3F[nResult];
+
+    if( aMesh.m_Color )
+        aResult.m_Color = new SFVEC3F[nResult];
+
+    if( aMesh.m_Texcoords )
+        aResult.m_Texcoords = new SFVEC2F[nResult];
+
+    for( unsigned int c = 0; c < clusters.size(); ++c )
+    {
+        const unsigned int v = vertexIndex[c];
+
+        if( v == UINT_MAX )
+            continue;
+
+        const CLUSTER& cluster = clusters[c];
+        const float weight = 1.0f / cluster.m_count;
+
+        aResult.m_Positions[v] = cluster.m_position * weight;
+
+        const float normalLength = glm::length( cluster.m_normal );
+
+        if( normalLength > FLT_EPSILON )
+        {
+            aResult.m_Normals[v] = cluster.m_normal / normalLength;
+        }
+        else
+        {
+            SFVEC3F normal( 0.0f );
+            normal[cluster.m_direction / 2] = ( cluster.m_direction & 1 ) ? -1.0f : 1.0f;
+            aResult.m_Normals[v] = normal;
+        }
+
+        if( aResult.m_Color )
+            aResult.m_Color[v] = cluster.m_color * weight;
+
+        if( aResult.m_Texcoords )
+            aResult.m_Texcoords[v] = cluster.m_texcoord * weight;
+    }
+
+    aResult.m_FaceIdxSize = faces.size();
+    aResult.m_FaceIdx = new unsigned int[faces.size()];
+    memcpy( aResult.m_FaceIdx, faces.data(), faces.size() * sizeof( unsigned int ) );
+    aResult.m_MaterialIdx = aMesh.m_MaterialIdx;
+
+    return true;
+}
+
+
+S3DMODEL* SimplifyModel( const S3DMODEL& aModel, float aMaxError )
+{
+    SFVEC3F bmin;
+    SFVEC3F bmax;
+
+    if( !( aMaxError > 0.0f ) || !aModel.m_MaterialsSize || !getModelBBox( aModel, bmin, bmax ) )
+        return NULL;
+
+    const unsigned int nModelTriangles = GetModelTriangleCount( aModel );
+
+    // the light models draw fast enough, their simplified versions are not worth it
+    if( nModelTriangles < MIN_LOD_TRIANGLES )
+        return NULL;
+
+    // A vertex is replaced by the average of the vertexes of its cell, which is in the
+    // cell: they are at most one cell diagonal apart
+    const float cellSize = aMaxError / sqrtf( 3.0f );
+
+    std::vector< SMESH > meshes;
+    unsigned int nTriangles = 0;
+
+    for( unsigned int m = 0; m < aModel.m_MeshesSize; ++m )
+    {
+        SMESH mesh;
+        S3D::Init3DMesh( mesh );
+
+        if( simplifyMesh( aModel.m_Meshes[m], bmin, cellSize, mesh ) )
+        {
+            nTriangles += mesh.m_FaceIdxSize / 3;
+            meshes.push_back( mesh );
+        }
+    }
+
+    if( meshes.empty() || nTriangles >= nModelTriangles )
+    {
+        for( SMESH& mesh : meshes )
+            S3D::Free3DMesh( mesh );
+
+        return NULL;
+    }
+
+    S3DMODEL* model = S3D::New3DModel();
+
+    model->m_MaterialsSize = aModel.m_MaterialsSize;
+    model->m_Materials = new SMATERIAL[aModel.m_MaterialsSize];
+    memcpy( model->m_Materials, aModel.m_Materials, aModel.m_MaterialsSize * sizeof( SMATERIAL ) );
+
+    model->m_MeshesSize = meshes.size();
+    model->m_Meshes = new SMESH[meshes.size()];
+    std::copy( meshes.begin(), meshes.end(), model->m_Meshes );
+
+    return model;
+}
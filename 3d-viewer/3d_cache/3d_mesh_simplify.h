@@ -0,0 +1,68 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file 3d_mesh_simplify.h
+ * creates simplified versions of the render data of 3D models (S3DMODEL)
+ *
+ * The simplification clusters the vertices on a regular grid: all the vertices of a
+ * grid cell with a similar normal are merged into one vertex and the triangles which
+ * collapse are removed.  The distance between a vertex and the vertex replacing it is
+ * bounded by the requested error, so the simplified models can be used as levels of
+ * detail.  The simplification runs in linear time, it is meant for the heavy models
+ * of connectors and packages, whose details are not visible from a distance.
+ */
+
+#ifndef MESH_SIMPLIFY_3D_H
+#define MESH_SIMPLIFY_3D_H
+
+#include "plugins/3dapi/c3dmodel.h"
+
+/// Models with fewer triangles are not simplified
+#define MIN_LOD_TRIANGLES 20000
+
+/**
+ * Function GetModelTriangleCount
+ * @return the number of triangles of all the meshes of aModel
+ */
+unsigned int GetModelTriangleCount( const S3DMODEL& aModel );
+
+/**
+ * Function GetModelDiagonal
+ * @return the length of the diagonal of the bounding box of aModel, in model units
+ */
+float GetModelDiagonal( const S3DMODEL& aModel );
+
+/**
+ * Function SimplifyModel
+ * creates a simplified copy of a model.  This function does not use any shared state,
+ * so it may be called from several threads at the same time.
+ *
+ * @param aModel is the model to simplify
+ * @param aMaxError is the maximum distance, in model units, between a vertex of aModel
+ * and the vertex replacing it in the simplified model
+ * @return a new model, to be freed by S3D::Destroy3DModel(), or NULL if aModel has
+ * fewer than MIN_LOD_TRIANGLES triangles or no triangle could be removed
+ */
+S3DMODEL* SimplifyModel( const S3DMODEL& aModel, float aMaxError );
+
+#endif  // MESH_SIMPLIFY_3D_H
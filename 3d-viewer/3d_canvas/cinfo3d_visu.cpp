@@ -43,6 +43,8 @@
  */
 const wxChar *CINFO3D_VISU::m_logTrace = wxT( "KI_TRACE_EDA_CINFO3D_VISU" );
 
+std::mutex CINFO3D_VISU::m_strokeTextLock;
+
 
 CINFO3D_VISU G_null_CINFO3D_VISU;
 
@@ -60,6 +62,7 @@ CINFO3D_VISU::CINFO3D_VISU() :
 
     m_render_engine = RENDER_ENGINE_OPENGL_LEGACY;
     m_material_mode = MATERIAL_MODE_NORMAL;
+    m_model_quality = MODEL_QUALITY_FULL;
 
     m_boardPos = wxPoint();
     m_boardSize = wxSize();
@@ -89,6 +92,12 @@ CINFO3D_VISU::CINFO3D_VISU() :
     m_calc_seg_min_factor3DU = 0.0f;
     m_calc_seg_max_factor3DU = 0.0f;
 
+    m_layersBuilt = false;
+    memset( m_layersRevision, 0, sizeof( m_layersRevision ) );
+    m_layersBiuTo3Dunits = 0.0;
+    m_layersCopperCount = 0;
+    m_layersRenderEngine = RENDER_ENGINE_OPENGL_LEGACY;
+
 
     memset( m_layerZcoordTop, 0, sizeof( m_layerZcoordTop ) );
     memset( m_layerZcoordBottom, 0, sizeof( m_layerZcoordBottom ) );
@@ -97,6 +106,7 @@ CINFO3D_VISU::CINFO3D_VISU() :
     SetFlag( FL_MODULE_ATTRIBUTES_NORMAL, true );
     SetFlag( FL_SHOW_BOARD_BODY, true );
     SetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS, true );
+    SetFlag( FL_RENDER_OPENGL_MODEL_LOD, true );
     SetFlag( FL_MODULE_ATTRIBUTES_NORMAL, true );
     SetFlag( FL_MODULE_ATTRIBUTES_NORMAL_INSERT, true );
     SetFlag( FL_MODULE_ATTRIBUTES_VIRTUAL, true );
@@ -31,6 +31,7 @@
 #define CINFO3D_VISU_H
 
 #include <vector>
+#include <mutex>
 #include "../3d_rendering/3d_render_raytracing/accelerators/ccontainer2d.h"
 #include "../3d_rendering/3d_render_raytracing/accelerators/ccontainer.h"
 #include "../3d_rendering/3d_render_raytracing/shapes3D/cbbox.h"
@@ -245,6 +246,18 @@ class CINFO3D_VISU
      */
     MATERIAL_MODE MaterialModeGet() const { return m_material_mode; }
 
+    /**
+     * @brief ModelQualitySet
+     * @param aModelQuality = the quality of the 3d shape models used by the raytracer
+     */
+    void ModelQualitySet( MODEL_QUALITY aModelQuality ) { m_model_quality = aModelQuality; }
+
+    /**
+     * @brief ModelQualityGet
+     * @return quality of the 3d shape models used by the raytracer
+     */
+    MODEL_QUALITY ModelQualityGet() const { return m_model_quality; }
+
     /**
      * @brief GetBoardPoly - Get the current polygon of the epoxy board
      * @return the shape polygon
@@ -418,9 +431,38 @@ class CINFO3D_VISU
     const MAP_POLY &GetPolyMapHoles_Outer() const { return m_layers_outer_holes_poly; }
 
  private:
+
+    /**
+     * The 2D data of one layer.  It is built by a layer task and moved to the
+     * layer maps once all the tasks are finished, so the tasks never touch the maps.
+     */
+    struct LAYER_ITEMS
+    {
+        PCB_LAYER_ID     m_layer;
+        CBVHCONTAINER2D *m_container;       ///< 2d objects of the layer
+        SHAPE_POLY_SET  *m_poly;            ///< layer contours, or NULL if not needed
+        CBVHCONTAINER2D *m_holes;           ///< blind / buried via holes, or NULL if none
+        SHAPE_POLY_SET  *m_outerHolesPoly;  ///< contours of m_holes (outer), or NULL
+        SHAPE_POLY_SET  *m_innerHolesPoly;  ///< contours of m_holes (inner), or NULL
+    };
+
     void createBoardPolygon();
     void createLayers( REPORTER *aStatusTextReporter );
     void destroyLayers();
+    void destroyLayer( PCB_LAYER_ID aLayer );
+    void destroyThroughHoles();
+
+    /**
+     * @brief layersNeedFullRebuild - check if the settings changed since the last
+     * layers build in a way that invalidates all the layers (e.g. the 3D units scale)
+     */
+    bool layersNeedFullRebuild() const;
+
+    // Helper functions to build one layer, they can run in parallel
+    void createCopperLayer( const std::vector< const TRACK *> &aTrackList,
+                            LAYER_ITEMS &aItems );
+    void createTechLayer( LAYER_ITEMS &aItems );
+    void createThroughHoles( const std::vector< const TRACK *> &aTrackList );
 
     // Helper functions to create the board
     COBJECT2D *createNewTrack( const TRACK* aTrack , int aClearanceValue ) const;
@@ -532,6 +574,9 @@ class CINFO3D_VISU
     /// mode to render the 3d shape models material
     MATERIAL_MODE       m_material_mode;
 
+    /// quality of the 3d shape models used by the raytracer
+    MODEL_QUALITY       m_model_quality;
+
 
     // Pcb board position
 
@@ -664,6 +709,28 @@ class CINFO3D_VISU
     /// Computed medium diameter of the holes in 3D units
     float        m_stats_hole_med_diameter;
 
+
+    // Layers build state, used to rebuild only the changed layers
+
+    /// true if the layers were built and the state below is valid
+    bool              m_layersBuilt;
+
+    /// board revision of each layer when it was built
+    unsigned int      m_layersRevision[PCB_LAYER_ID_COUNT];
+
+    /// settings used by the last layers build
+    double            m_layersBiuTo3Dunits;
+    unsigned int      m_layersCopperCount;
+    RENDER_ENGINE     m_layersRenderEngine;
+    std::vector<bool> m_layersDrawFlags;
+    LSET              m_layersEnabled;
+
+    /**
+     *  The stroke font text functions use global data (basic_gal and the callback
+     *  parameters), this lock serializes the text conversions of the layer tasks.
+     */
+    static std::mutex m_strokeTextLock;
+
     /**
      *  Trace mask used to enable or disable the trace output of this class.
      *  The debug output can be turned on by setting the WXTRACE environment variable to
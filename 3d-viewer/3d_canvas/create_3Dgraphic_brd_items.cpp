@@ -99,6 +99,8 @@ void CINFO3D_VISU::AddShapeWithClearanceToContainer( const TEXTE_PCB* aTextPCB,
     if( aTextPCB->IsMirrored() )
         size.x = -size.x;
 
+    std::lock_guard<std::mutex> lock( m_strokeTextLock );
+
     s_boardItem    = (const BOARD_ITEM *)&aTextPCB;
     s_dstcontainer = aDstContainer;
     s_textWidth    = aTextPCB->GetThickness() + ( 2 * aClearanceValue );
@@ -225,6 +227,11 @@ void CINFO3D_VISU::AddGraphicsShapesWithClearanceToContainer( const MODULE* aMod
     if( aModule->Value().GetLayer() == aLayerId && aModule->Value().IsVisible() )
         texts.push_back( &aModule->Value() );
 
+    if( texts.empty() )
+        return;
+
+    std::lock_guard<std::mutex> lock( m_strokeTextLock );
+
     s_boardItem    = (const BOARD_ITEM *)&aModule->Value();
     s_dstcontainer = aDstContainer;
     s_biuTo3Dunits = m_biuTo3Dunits;
@@ -50,14 +50,57 @@
 #include <class_text_mod.h>
 #include <convert_basic_shapes_to_polygon.h>
 #include <trigo.h>
+#include <parallel_tasks.h>
 #include <utility>
 #include <vector>
-#include <thread>
 #include <algorithm>
-#include <atomic>
 
 #include <profile.h>
 
+
+// Number of segments to draw a circle using segments (used on countour zones
+// and text copper elements )
+static const int segcountforcircle = 12;
+
+// segments to draw a circle to build texts. Is is used only to build
+// the shape of each segment of the stroke font, therefore no need to have
+// many segments per circle.
+static const int segcountInStrokeFont = 12;
+
+// draw graphic items, on technical layers
+static const PCB_LAYER_ID teckLayerList[] = {
+        B_Adhes,
+        F_Adhes,
+        B_Paste,
+        F_Paste,
+        B_SilkS,
+        F_SilkS,
+        B_Mask,
+        F_Mask,
+
+        // Aux Layers
+        Dwgs_User,
+        Cmts_User,
+        Eco1_User,
+        Eco2_User,
+        Edge_Cuts,
+        Margin
+    };
+
+
+template< class MAP >
+static void deleteLayerEntry( MAP &aMap, PCB_LAYER_ID aLayer )
+{
+    typename MAP::iterator ii = aMap.find( aLayer );
+
+    if( ii != aMap.end() )
+    {
+        delete ii->second;
+        aMap.erase( ii );
+    }
+}
+
+
 void CINFO3D_VISU::destroyLayers()
 {
     if( !m_layers_poly.empty() )
@@ -125,43 +168,97 @@ void CINFO3D_VISU::destroyLayers()
         m_layers_holes2D.clear();
     }
 
+    destroyThroughHoles();
+
+    m_layersBuilt = false;
+}
+
+
+void CINFO3D_VISU::destroyLayer( PCB_LAYER_ID aLayer )
+{
+    deleteLayerEntry( m_layers_poly, aLayer );
+    deleteLayerEntry( m_layers_inner_holes_poly, aLayer );
+    deleteLayerEntry( m_layers_outer_holes_poly, aLayer );
+    deleteLayerEntry( m_layers_container2D, aLayer );
+    deleteLayerEntry( m_layers_holes2D, aLayer );
+}
+
+
+void CINFO3D_VISU::destroyThroughHoles()
+{
     m_through_holes_inner.Clear();
     m_through_holes_outer.Clear();
     m_through_holes_vias_outer.Clear();
     m_through_holes_vias_inner.Clear();
     m_through_outer_holes_poly_NPTH.RemoveAllContours();
     m_through_outer_holes_poly.RemoveAllContours();
-    //m_through_inner_holes_poly.RemoveAllContours();
+    m_through_inner_holes_poly.RemoveAllContours();
 
     m_through_outer_holes_vias_poly.RemoveAllContours();
     m_through_inner_holes_vias_poly.RemoveAllContours();
 }
 
 
-void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
+bool CINFO3D_VISU::layersNeedFullRebuild() const
 {
-    // Number of segments to draw a circle using segments (used on countour zones
-    // and text copper elements )
-    const int    segcountforcircle = 12;
-    const double correctionFactor  = GetCircleCorrectionFactor( segcountforcircle );
+    if( !m_layersBuilt )
+        return true;
+
+    // The 2d objects are stored in 3D units and some layers contents depend on
+    // the render engine and the render flags
+    if( ( m_layersBiuTo3Dunits != m_biuTo3Dunits ) ||
+        ( m_layersCopperCount != m_copperLayersCount ) ||
+        ( m_layersRenderEngine != m_render_engine ) ||
+        ( m_layersDrawFlags != m_drawFlags ) )
+        return true;
+
+    for( LSEQ seq = LSET::AllLayersMask().Seq(); seq; ++seq )
+    {
+        if( Is3DLayerEnabled( *seq ) != m_layersEnabled[*seq] )
+            return true;
+    }
+
+    return false;
+}
 
-    // segments to draw a circle to build texts. Is is used only to build
-    // the shape of each segment of the stroke font, therefore no need to have
-    // many segments per circle.
-    const int segcountInStrokeFont  = 12;
-    const double correctionFactorStroke = GetCircleCorrectionFactor( segcountInStrokeFont );
 
-    destroyLayers();
+void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
+{
+#ifdef PRINT_STATISTICS_3D_VIEWER
+    unsigned stats_startCopperLayersTime = GetRunningMicroSecs();
+#endif
 
-    // Build Copper layers
-    // Based on: https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L692
+    // Find the layers to build: all of them after a settings change, otherwise only
+    // the layers whose items changed since the last build
     // /////////////////////////////////////////////////////////////////////////
+    const bool fullRebuild = layersNeedFullRebuild();
+    LSET changedLayers;
 
-    #ifdef PRINT_STATISTICS_3D_VIEWER
-    unsigned stats_startCopperLayersTime = GetRunningMicroSecs();
+    for( LSEQ seq = LSET::AllLayersMask().Seq(); seq; ++seq )
+    {
+        if( fullRebuild || ( m_board->GetLayerRevision( *seq ) != m_layersRevision[*seq] ) )
+            changedLayers.set( *seq );
+    }
 
-    unsigned start_Time = stats_startCopperLayersTime;
-#endif
+    // Through holes cross all the copper layers
+    const bool buildThroughHoles = fullRebuild ||
+                                   ( changedLayers & LSET::AllCuMask() ).any();
+
+    if( fullRebuild )
+    {
+        destroyLayers();
+    }
+    else
+    {
+        for( LSEQ seq = changedLayers.Seq(); seq; ++seq )
+            destroyLayer( *seq );
+
+        if( buildThroughHoles )
+            destroyThroughHoles();
+    }
+
+    wxLogTrace( m_logTrace, wxT( "CINFO3D_VISU::createLayers %s, %d changed layers" ),
+                fullRebuild ? "full rebuild" : "incremental", (int) changedLayers.count() );
 
     PCB_LAYER_ID cu_seq[MAX_CU_LAYERS];
     LSET     cu_set = LSET::AllCuMask( m_copperLayersCount );
@@ -170,8 +267,6 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
     m_stats_track_med_width         = 0;
     m_stats_nr_vias                 = 0;
     m_stats_via_med_hole_diameter   = 0;
-    m_stats_nr_holes                = 0;
-    m_stats_hole_med_diameter       = 0;
 
     // Prepare track list, convert in a vector. Calc statistic for the holes
     // /////////////////////////////////////////////////////////////////////////
@@ -208,311 +303,192 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
     if( m_stats_nr_vias )
         m_stats_via_med_hole_diameter /= (float)m_stats_nr_vias;
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T01: %.3f ms\n", (float)( GetRunningMicroSecs()  - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
-
-    // Prepare copper layers index and containers
+    // Prepare the list of layers to build
     // /////////////////////////////////////////////////////////////////////////
-    std::vector< PCB_LAYER_ID > layer_id;
-    layer_id.clear();
-    layer_id.reserve( m_copperLayersCount );
+    std::vector< LAYER_ITEMS > layers;
+    layers.reserve( m_copperLayersCount + DIM( teckLayerList ) );
 
     for( unsigned i = 0; i < DIM( cu_seq ); ++i )
         cu_seq[i] = ToLAYER_ID( B_Cu - i );
 
-    for( LSEQ cu = cu_set.Seq( cu_seq, DIM( cu_seq ) ); cu; ++cu )
+    LSEQ cu = cu_set.Seq( cu_seq, DIM( cu_seq ) );
+    LSEQ tech = LSET::AllNonCuMask().Seq( teckLayerList, DIM( teckLayerList ) );
+
+    LSEQ layerSeq = cu;
+    layerSeq.insert( layerSeq.end(), tech.begin(), tech.end() );
+
+    for( unsigned int i = 0; i < layerSeq.size(); ++i )
     {
-        const PCB_LAYER_ID curr_layer_id = *cu;
+        const PCB_LAYER_ID curr_layer_id = layerSeq[i];
+
+        if( !changedLayers[curr_layer_id] )
+            continue;
 
         if( !Is3DLayerEnabled( curr_layer_id ) ) // Skip non enabled layers
             continue;
 
-        layer_id.push_back( curr_layer_id );
+        LAYER_ITEMS items;
 
-        CBVHCONTAINER2D *layerContainer = new CBVHCONTAINER2D;
-        m_layers_container2D[curr_layer_id] = layerContainer;
+        items.m_layer          = curr_layer_id;
+        items.m_container      = NULL;
+        items.m_poly           = NULL;
+        items.m_holes          = NULL;
+        items.m_outerHolesPoly = NULL;
+        items.m_innerHolesPoly = NULL;
 
-        if( GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) &&
-            (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY) )
-        {
-            SHAPE_POLY_SET *layerPoly = new SHAPE_POLY_SET;
-            m_layers_poly[curr_layer_id] = layerPoly;
-        }
+        layers.push_back( items );
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T02: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
-
+    // Build the layers (and the through holes) as independent tasks.
+    // Each task only writes its own LAYER_ITEMS, the layer maps are filled after.
+    // /////////////////////////////////////////////////////////////////////////
     if( aStatusTextReporter )
-        aStatusTextReporter->Report( _( "Create tracks and vias" ) );
+        aStatusTextReporter->Report( _( "Build layers" ) );
+
+    // The through holes are the first task, it is the largest one
+    const size_t firstLayerTask = buildThroughHoles ? 1 : 0;
+    const size_t nrTasks = firstLayerTask + layers.size();
+
+    PARALLEL_TASKS::Run( nrTasks, [&]( size_t i )
+    {
+        if( i < firstLayerTask )
+            createThroughHoles( trackList );
+        else if( IsCopperLayer( layers[i - firstLayerTask].m_layer ) )
+            createCopperLayer( trackList, layers[i - firstLayerTask] );
+        else
+            createTechLayer( layers[i - firstLayerTask] );
+    } );
 
-    // Create tracks as objects and add it to container
+    // Move the new layers to the maps
     // /////////////////////////////////////////////////////////////////////////
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
+    for( unsigned int i = 0; i < layers.size(); ++i )
     {
-        const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+        const LAYER_ITEMS &items = layers[i];
 
-        wxASSERT( m_layers_container2D.find( curr_layer_id ) != m_layers_container2D.end() );
+        m_layers_container2D[items.m_layer] = items.m_container;
 
-        CBVHCONTAINER2D *layerContainer = m_layers_container2D[curr_layer_id];
+        if( items.m_poly )
+            m_layers_poly[items.m_layer] = items.m_poly;
 
-        // ADD TRACKS
-        unsigned int nTracks = trackList.size();
+        if( items.m_holes )
+            m_layers_holes2D[items.m_layer] = items.m_holes;
 
-        for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
+        if( items.m_outerHolesPoly )
         {
-            const TRACK *track = trackList[trackIdx];
-
-            // NOTE: Vias can be on multiple layers
-            if( !track->IsOnLayer( curr_layer_id ) )
-                continue;
+            wxASSERT( items.m_innerHolesPoly );
 
-            // Add object item to layer container
-            layerContainer->Add( createNewTrack( track, 0.0f ) );
+            m_layers_outer_holes_poly[items.m_layer] = items.m_outerHolesPoly;
+            m_layers_inner_holes_poly[items.m_layer] = items.m_innerHolesPoly;
         }
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T03: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
-
-    // Create VIAS and THTs objects and add it to holes containers
+    // Remember what was built
     // /////////////////////////////////////////////////////////////////////////
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
+    for( LSEQ seq = LSET::AllLayersMask().Seq(); seq; ++seq )
     {
-        const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+        m_layersRevision[*seq] = m_board->GetLayerRevision( *seq );
+        m_layersEnabled.set( *seq, Is3DLayerEnabled( *seq ) );
+    }
 
-        // ADD TRACKS
-        unsigned int nTracks = trackList.size();
+    m_layersBiuTo3Dunits = m_biuTo3Dunits;
+    m_layersCopperCount  = m_copperLayersCount;
+    m_layersRenderEngine = m_render_engine;
+    m_layersDrawFlags    = m_drawFlags;
+    m_layersBuilt        = true;
 
-        for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
-        {
-            const TRACK *track = trackList[trackIdx];
+#ifdef PRINT_STATISTICS_3D_VIEWER
+    unsigned stats_endCopperLayersTime = GetRunningMicroSecs();
 
-            if( !track->IsOnLayer( curr_layer_id ) )
-                continue;
+    printf( "CINFO3D_VISU::createLayers times\n" );
+    printf( "  Layers (%u of %u) and holes: %.3f ms\n",
+            (unsigned int) layers.size(), (unsigned int) layerSeq.size(),
+            (float)( stats_endCopperLayersTime - stats_startCopperLayersTime ) / 1e3 );
+    printf( "Statistics:\n" );
+    printf( "  m_stats_nr_tracks                   %u\n", m_stats_nr_tracks );
+    printf( "  m_stats_nr_vias                     %u\n", m_stats_nr_vias );
+    printf( "  m_stats_nr_holes                    %u\n", m_stats_nr_holes );
+    printf( "  m_stats_via_med_hole_diameter (3DU) %f\n", m_stats_via_med_hole_diameter );
+    printf( "  m_stats_hole_med_diameter     (3DU) %f\n", m_stats_hole_med_diameter );
+    printf( "  m_calc_seg_min_factor3DU      (3DU) %f\n", m_calc_seg_min_factor3DU );
+    printf( "  m_calc_seg_max_factor3DU      (3DU) %f\n", m_calc_seg_max_factor3DU );
+#endif
+}
 
-            // ADD VIAS and THT
-            if( track->Type() == PCB_VIA_T )
-            {
-                const VIA *via = static_cast< const VIA*>( track );
-                const VIATYPE_T viatype = via->GetViaType();
-                const float holediameter = via->GetDrillValue() * BiuTo3Dunits();
-                const float thickness = GetCopperThickness3DU();
-                const float hole_inner_radius = ( holediameter / 2.0f );
-
-                const SFVEC2F via_center(  via->GetStart().x * m_biuTo3Dunits,
-                                          -via->GetStart().y * m_biuTo3Dunits );
-
-                if( viatype != VIA_THROUGH )
-                {
-
-                    // Add hole objects
-                    // /////////////////////////////////////////////////////////
-
-                    CBVHCONTAINER2D *layerHoleContainer = NULL;
-
-                    // Check if the layer is already created
-                    if( m_layers_holes2D.find( curr_layer_id ) == m_layers_holes2D.end() )
-                    {
-                        // not found, create a new container
-                        layerHoleContainer = new CBVHCONTAINER2D;
-                        m_layers_holes2D[curr_layer_id] = layerHoleContainer;
-                    }
-                    else
-                    {
-                        // found
-                        layerHoleContainer = m_layers_holes2D[curr_layer_id];
-                    }
-
-                    // Add a hole for this layer
-                    layerHoleContainer->Add( new CFILLEDCIRCLE2D( via_center,
-                                                                  hole_inner_radius + thickness,
-                                                                  *track ) );
-                }
-                else if( lIdx == 0 ) // it only adds once the THT holes
-                {
-                    // Add through hole object
-                    // /////////////////////////////////////////////////////////
-                    m_through_holes_outer.Add( new CFILLEDCIRCLE2D( via_center,
-                                                                    hole_inner_radius + thickness,
-                                                                    *track ) );
-
-                    m_through_holes_vias_outer.Add(
-                                new CFILLEDCIRCLE2D( via_center,
-                                                     hole_inner_radius + thickness,
-                                                     *track ) );
-
-                    m_through_holes_inner.Add( new CFILLEDCIRCLE2D( via_center,
-                                                                    hole_inner_radius,
-                                                                    *track ) );
-
-                    //m_through_holes_vias_inner.Add( new CFILLEDCIRCLE2D( via_center,
-                    //                                                     hole_inner_radius,
-                    //                                                     *track ) );
-                }
-            }
-        }
-    }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T04: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
+void CINFO3D_VISU::createThroughHoles( const std::vector< const TRACK *> &aTrackList )
+{
+    m_stats_nr_holes                = 0;
+    m_stats_hole_med_diameter       = 0;
 
-    // Create VIAS and THTs objects and add it to holes containers
+    // Create through VIAS objects and add it to holes containers
     // /////////////////////////////////////////////////////////////////////////
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
-    {
-        const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+    const unsigned int nTracks = aTrackList.size();
 
-        // ADD TRACKS
-        const unsigned int nTracks = trackList.size();
+    for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
+    {
+        const TRACK *track = aTrackList[trackIdx];
 
-        for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
-        {
-            const TRACK *track = trackList[trackIdx];
+        if( track->Type() != PCB_VIA_T )
+            continue;
 
-            if( !track->IsOnLayer( curr_layer_id ) )
-                continue;
+        const VIA *via = static_cast< const VIA*>( track );
 
-            // ADD VIAS and THT
-            if( track->Type() == PCB_VIA_T )
-            {
-                const VIA *via = static_cast< const VIA*>( track );
-                const VIATYPE_T viatype = via->GetViaType();
-
-                if( viatype != VIA_THROUGH )
-                {
-
-                    // Add VIA hole contourns
-                    // /////////////////////////////////////////////////////////
-
-                    // Add outter holes of VIAs
-                    SHAPE_POLY_SET *layerOuterHolesPoly = NULL;
-                    SHAPE_POLY_SET *layerInnerHolesPoly = NULL;
-
-                    // Check if the layer is already created
-                    if( m_layers_outer_holes_poly.find( curr_layer_id ) ==
-                        m_layers_outer_holes_poly.end() )
-                    {
-                        // not found, create a new container
-                        layerOuterHolesPoly = new SHAPE_POLY_SET;
-                        m_layers_outer_holes_poly[curr_layer_id] = layerOuterHolesPoly;
-
-                        wxASSERT( m_layers_inner_holes_poly.find( curr_layer_id ) ==
-                                  m_layers_inner_holes_poly.end() );
-
-                        layerInnerHolesPoly = new SHAPE_POLY_SET;
-                        m_layers_inner_holes_poly[curr_layer_id] = layerInnerHolesPoly;
-                    }
-                    else
-                    {
-                        // found
-                        layerOuterHolesPoly = m_layers_outer_holes_poly[curr_layer_id];
-
-                        wxASSERT( m_layers_inner_holes_poly.find( curr_layer_id ) !=
-                                  m_layers_inner_holes_poly.end() );
-
-                        layerInnerHolesPoly = m_layers_inner_holes_poly[curr_layer_id];
-                    }
-
-                    const int holediameter = via->GetDrillValue();
-                    const int hole_outer_radius = (holediameter / 2) + GetCopperThicknessBIU();
-
-                    TransformCircleToPolygon( *layerOuterHolesPoly,
-                                              via->GetStart(),
-                                              hole_outer_radius,
-                                              GetNrSegmentsCircle( hole_outer_radius * 2 ) );
-
-                    TransformCircleToPolygon( *layerInnerHolesPoly,
-                                              via->GetStart(),
-                                              holediameter / 2,
-                                              GetNrSegmentsCircle( holediameter ) );
-                }
-                else if( lIdx == 0 ) // it only adds once the THT holes
-                {
-                    const int holediameter = via->GetDrillValue();
-                    const int hole_outer_radius = (holediameter / 2)+ GetCopperThicknessBIU();
-
-                    // Add through hole contourns
-                    // /////////////////////////////////////////////////////////
-                    TransformCircleToPolygon( m_through_outer_holes_poly,
-                                              via->GetStart(),
-                                              hole_outer_radius,
-                                              GetNrSegmentsCircle( hole_outer_radius * 2 ) );
-
-                    TransformCircleToPolygon( m_through_inner_holes_poly,
-                                              via->GetStart(),
-                                              holediameter / 2,
-                                              GetNrSegmentsCircle( holediameter ) );
-
-                    // Add samething for vias only
-
-                    TransformCircleToPolygon( m_through_outer_holes_vias_poly,
-                                              via->GetStart(),
-                                              hole_outer_radius,
-                                              GetNrSegmentsCircle( hole_outer_radius * 2 ) );
-
-                    //TransformCircleToPolygon( m_through_inner_holes_vias_poly,
-                    //                          via->GetStart(),
-                    //                          holediameter / 2,
-                    //                          GetNrSegmentsCircle( holediameter ) );
-                }
-            }
-        }
-    }
-
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T05: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
+        if( via->GetViaType() != VIA_THROUGH )
+            continue;
 
-    // Creates outline contours of the tracks and add it to the poly of the layer
-    // /////////////////////////////////////////////////////////////////////////
-    if( GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) &&
-        (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY) )
-    {
-        for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
-        {
-            const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+        const float holediameter = via->GetDrillValue() * BiuTo3Dunits();
+        const float thickness = GetCopperThickness3DU();
+        const float hole_inner_radius = ( holediameter / 2.0f );
 
-            wxASSERT( m_layers_poly.find( curr_layer_id ) != m_layers_poly.end() );
+        const SFVEC2F via_center(  via->GetStart().x * m_biuTo3Dunits,
+                                  -via->GetStart().y * m_biuTo3Dunits );
 
-            SHAPE_POLY_SET *layerPoly = m_layers_poly[curr_layer_id];
+        // Add through hole object
+        // /////////////////////////////////////////////////////////////////////
+        m_through_holes_outer.Add( new CFILLEDCIRCLE2D( via_center,
+                                                        hole_inner_radius + thickness,
+                                                        *track ) );
 
-            // ADD TRACKS
-            unsigned int nTracks = trackList.size();
+        m_through_holes_vias_outer.Add( new CFILLEDCIRCLE2D( via_center,
+                                                             hole_inner_radius + thickness,
+                                                             *track ) );
 
-            for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
-            {
-                const TRACK *track = trackList[trackIdx];
+        m_through_holes_inner.Add( new CFILLEDCIRCLE2D( via_center,
+                                                        hole_inner_radius,
+                                                        *track ) );
 
-                if( !track->IsOnLayer( curr_layer_id ) )
-                    continue;
+        //m_through_holes_vias_inner.Add( new CFILLEDCIRCLE2D( via_center,
+        //                                                     hole_inner_radius,
+        //                                                     *track ) );
 
-                // Add the track contour
-                int nrSegments = GetNrSegmentsCircle( track->GetWidth() );
+        const int holediameterBIU = via->GetDrillValue();
+        const int hole_outer_radius = (holediameterBIU / 2) + GetCopperThicknessBIU();
 
-                track->TransformShapeWithClearanceToPolygon(
-                            *layerPoly,
-                            0,
-                            nrSegments,
-                            GetCircleCorrectionFactor( nrSegments ) );
-            }
-        }
+        // Add through hole contourns
+        // /////////////////////////////////////////////////////////////////////
+        TransformCircleToPolygon( m_through_outer_holes_poly,
+                                  via->GetStart(),
+                                  hole_outer_radius,
+                                  GetNrSegmentsCircle( hole_outer_radius * 2 ) );
+
+        TransformCircleToPolygon( m_through_inner_holes_poly,
+                                  via->GetStart(),
+                                  holediameterBIU / 2,
+                                  GetNrSegmentsCircle( holediameterBIU ) );
+
+        // Add samething for vias only
+
+        TransformCircleToPolygon( m_through_outer_holes_vias_poly,
+                                  via->GetStart(),
+                                  hole_outer_radius,
+                                  GetNrSegmentsCircle( hole_outer_radius * 2 ) );
+
+        //TransformCircleToPolygon( m_through_inner_holes_vias_poly,
+        //                          via->GetStart(),
+        //                          holediameterBIU / 2,
+        //                          GetNrSegmentsCircle( holediameterBIU ) );
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T06: %.3f ms\n", (float)( GetRunningMicroSecs()  - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
-
     // Add holes of modules
     // /////////////////////////////////////////////////////////////////////////
     for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
@@ -539,14 +515,10 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
             m_through_holes_inner.Add( createNewPadDrill( pad,       0 ) );
         }
     }
+
     if( m_stats_nr_holes )
         m_stats_hole_med_diameter /= (float)m_stats_nr_holes;
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T07: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
-
     // Add contours of the pad holes (pads can be Circle or Segment holes)
     // /////////////////////////////////////////////////////////////////////////
     for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
@@ -589,636 +561,443 @@ void CINFO3D_VISU::createLayers( REPORTER *aStatusTextReporter )
         }
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T08: %.3f ms\n", (float)( GetRunningMicroSecs()  - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
+    // This will make a union of all added contourns
+    m_through_inner_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_poly_NPTH.Simplify( SHAPE_POLY_SET::PM_FAST );
+    m_through_outer_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
+    //m_through_inner_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST ); // Not in use
 
-    // Add modules PADs objects to containers
-    // /////////////////////////////////////////////////////////////////////////
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
-    {
-        const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+    // Build BVH for holes
+    m_through_holes_inner.BuildBVH();
+    m_through_holes_outer.BuildBVH();
+}
 
-        wxASSERT( m_layers_container2D.find( curr_layer_id ) != m_layers_container2D.end() );
 
-        CBVHCONTAINER2D *layerContainer = m_layers_container2D[curr_layer_id];
+// Based on: https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L692
+void CINFO3D_VISU::createCopperLayer( const std::vector< const TRACK *> &aTrackList,
+                                      LAYER_ITEMS &aItems )
+{
+    const PCB_LAYER_ID curr_layer_id = aItems.m_layer;
+    const double correctionFactor  = GetCircleCorrectionFactor( segcountforcircle );
+    const bool buildPoly = GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) &&
+                           (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY);
 
-        // ADD PADS
-        for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
-        {
-            // Note: NPTH pads are not drawn on copper layers when the pad
-            // has same shape as its hole
-            AddPadsShapesWithClearanceToContainer( module,
-                                                   layerContainer,
-                                                   curr_layer_id,
-                                                   0,
-                                                   true );
+    CBVHCONTAINER2D *layerContainer = new CBVHCONTAINER2D;
+    aItems.m_container = layerContainer;
 
-            // Micro-wave modules may have items on copper layers
-            AddGraphicsShapesWithClearanceToContainer( module,
-                                                       layerContainer,
-                                                       curr_layer_id,
-                                                       0 );
-        }
+    SHAPE_POLY_SET *layerPoly = NULL;
+
+    if( buildPoly )
+    {
+        layerPoly = new SHAPE_POLY_SET;
+        aItems.m_poly = layerPoly;
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T09: %.3f ms\n", (float)( GetRunningMicroSecs()  - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
+    const unsigned int nTracks = aTrackList.size();
 
-    // Add modules PADs poly contourns
-    // /////////////////////////////////////////////////////////////////////////
-    if( GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) &&
-        (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY) )
+    for( unsigned int trackIdx = 0; trackIdx < nTracks; ++trackIdx )
     {
-        for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
-        {
-            const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+        const TRACK *track = aTrackList[trackIdx];
 
-            wxASSERT( m_layers_poly.find( curr_layer_id ) != m_layers_poly.end() );
+        // NOTE: Vias can be on multiple layers
+        if( !track->IsOnLayer( curr_layer_id ) )
+            continue;
 
-            SHAPE_POLY_SET *layerPoly = m_layers_poly[curr_layer_id];
+        // Add object item to layer container
+        layerContainer->Add( createNewTrack( track, 0.0f ) );
 
-            // ADD PADS
-            for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
-            {
-                // Construct polys
-                // /////////////////////////////////////////////////////////////
-
-                // Note: NPTH pads are not drawn on copper layers when the pad
-                // has same shape as its hole
-                transformPadsShapesWithClearanceToPolygon( module->PadsList(),
-                                                           curr_layer_id,
-                                                           *layerPoly,
-                                                           0,
-                                                           true );
-
-                // Micro-wave modules may have items on copper layers
-                module->TransformGraphicTextWithClearanceToPolygonSet( curr_layer_id,
-                                                                        *layerPoly,
-                                                                        0,
-                                                                        segcountforcircle,
-                                                                        correctionFactor );
-
-                transformGraphicModuleEdgeToPolygonSet( module, curr_layer_id, *layerPoly );
-            }
+        // Add the track contour
+        if( layerPoly )
+        {
+            int nrSegments = GetNrSegmentsCircle( track->GetWidth() );
+
+            track->TransformShapeWithClearanceToPolygon(
+                        *layerPoly,
+                        0,
+                        nrSegments,
+                        GetCircleCorrectionFactor( nrSegments ) );
         }
-    }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T10: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
+        // ADD blind and buried VIAS holes (through holes are done once for all layers)
+        if( track->Type() != PCB_VIA_T )
+            continue;
 
-    // Add graphic item on copper layers to object containers
-    // /////////////////////////////////////////////////////////////////////////
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
-    {
-        const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+        const VIA *via = static_cast< const VIA*>( track );
 
-        wxASSERT( m_layers_container2D.find( curr_layer_id ) != m_layers_container2D.end() );
+        if( via->GetViaType() == VIA_THROUGH )
+            continue;
+
+        const float holediameter = via->GetDrillValue() * BiuTo3Dunits();
+        const float thickness = GetCopperThickness3DU();
+        const float hole_inner_radius = ( holediameter / 2.0f );
 
-        CBVHCONTAINER2D *layerContainer = m_layers_container2D[curr_layer_id];
+        const SFVEC2F via_center(  via->GetStart().x * m_biuTo3Dunits,
+                                  -via->GetStart().y * m_biuTo3Dunits );
 
-        // ADD GRAPHIC ITEMS ON COPPER LAYERS (texts)
-        for( auto item : m_board->Drawings() )
+        if( aItems.m_holes == NULL )
         {
-            if( !item->IsOnLayer( curr_layer_id ) )
-                continue;
+            aItems.m_holes = new CBVHCONTAINER2D;
+            aItems.m_outerHolesPoly = new SHAPE_POLY_SET;
+            aItems.m_innerHolesPoly = new SHAPE_POLY_SET;
+        }
 
-            switch( item->Type() )
-            {
-            case PCB_LINE_T:  // should not exist on copper layers
-            {
-                AddShapeWithClearanceToContainer( (DRAWSEGMENT*)item,
-                                                  layerContainer,
-                                                  curr_layer_id,
-                                                  0 );
-            }
-            break;
+        // Add a hole for this layer
+        aItems.m_holes->Add( new CFILLEDCIRCLE2D( via_center,
+                                                  hole_inner_radius + thickness,
+                                                  *track ) );
 
-            case PCB_TEXT_T:
-                AddShapeWithClearanceToContainer( (TEXTE_PCB*) item,
-                                                  layerContainer,
-                                                  curr_layer_id,
-                                                  0 );
-            break;
+        // Add VIA hole contourns
+        const int holediameterBIU = via->GetDrillValue();
+        const int hole_outer_radius = (holediameterBIU / 2) + GetCopperThicknessBIU();
 
-            case PCB_DIMENSION_T:
-                AddShapeWithClearanceToContainer( (DIMENSION*) item,
-                                                  layerContainer,
-                                                  curr_layer_id,
-                                                  0 );
-            break;
+        TransformCircleToPolygon( *aItems.m_outerHolesPoly,
+                                  via->GetStart(),
+                                  hole_outer_radius,
+                                  GetNrSegmentsCircle( hole_outer_radius * 2 ) );
 
-            default:
-                wxLogTrace( m_logTrace,
-                            wxT( "createLayers: item type: %d not implemented" ),
-                            item->Type() );
-            break;
-            }
-        }
+        TransformCircleToPolygon( *aItems.m_innerHolesPoly,
+                                  via->GetStart(),
+                                  holediameterBIU / 2,
+                                  GetNrSegmentsCircle( holediameterBIU ) );
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T11: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
-
-    // Add graphic item on copper layers to poly contourns
+    // Add modules PADs objects and contours
     // /////////////////////////////////////////////////////////////////////////
-    if( GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) &&
-        (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY) )
+    for( const MODULE* module = m_board->m_Modules; module; module = module->Next() )
     {
-        for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
-        {
-            const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+        // Note: NPTH pads are not drawn on copper layers when the pad
+        // has same shape as its hole
+        AddPadsShapesWithClearanceToContainer( module,
+                                               layerContainer,
+                                               curr_layer_id,
+                                               0,
+                                               true );
+
+        // Micro-wave modules may have items on copper layers
+        AddGraphicsShapesWithClearanceToContainer( module,
+                                                   layerContainer,
+                                                   curr_layer_id,
+                                                   0 );
 
-            wxASSERT( m_layers_poly.find( curr_layer_id ) != m_layers_poly.end() );
+        if( !layerPoly )
+            continue;
 
-            SHAPE_POLY_SET *layerPoly = m_layers_poly[curr_layer_id];
+        transformPadsShapesWithClearanceToPolygon( module->PadsList(),
+                                                   curr_layer_id,
+                                                   *layerPoly,
+                                                   0,
+                                                   true );
 
-            // ADD GRAPHIC ITEMS ON COPPER LAYERS (texts)
-            for( auto item : m_board->Drawings() )
-            {
-                if( !item->IsOnLayer( curr_layer_id ) )
-                    continue;
+        {
+            std::lock_guard<std::mutex> lock( m_strokeTextLock );
 
-                switch( item->Type() )
-                {
-                case PCB_LINE_T: // should not exist on copper layers
-                {
-                    const int nrSegments =
-                            GetNrSegmentsCircle( item->GetBoundingBox().GetSizeMax() );
-
-                    ( (DRAWSEGMENT*) item )->TransformShapeWithClearanceToPolygon(
-                                *layerPoly,
-                                0,
-                                nrSegments,
-                                GetCircleCorrectionFactor( nrSegments ) );
-                }
-                break;
-
-                case PCB_TEXT_T:
-                    ( (TEXTE_PCB*) item )->TransformShapeWithClearanceToPolygonSet(
-                                *layerPoly,
-                                0,
-                                segcountforcircle,
-                                correctionFactor );
-                break;
-
-                default:
-                    wxLogTrace( m_logTrace,
-                                wxT( "createLayers: item type: %d not implemented" ),
-                                item->Type() );
-                break;
-                }
-            }
+            module->TransformGraphicTextWithClearanceToPolygonSet( curr_layer_id,
+                                                                    *layerPoly,
+                                                                    0,
+                                                                    segcountforcircle,
+                                                                    correctionFactor );
         }
-    }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T12: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
+        transformGraphicModuleEdgeToPolygonSet( module, curr_layer_id, *layerPoly );
+    }
 
-    if( GetFlag( FL_ZONE ) )
+    // Add graphic item on copper layers to object containers and contours
+    // /////////////////////////////////////////////////////////////////////////
+    for( auto item : m_board->Drawings() )
     {
-        if( aStatusTextReporter )
-            aStatusTextReporter->Report( _( "Create zones" ) );
-
-        // Add zones objects
-        // /////////////////////////////////////////////////////////////////////
-        std::atomic<size_t> nextZone( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        if( !item->IsOnLayer( curr_layer_id ) )
+            continue;
 
-        size_t parallelThreadCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        switch( item->Type() )
         {
-            std::thread t = std::thread( [&]()
-            {
-                for( size_t areaId = nextZone.fetch_add( 1 );
-                            areaId < static_cast<size_t>( m_board->GetAreaCount() );
-                            areaId = nextZone.fetch_add( 1 ) )
-                {
-                    const ZONE_CONTAINER* zone = m_board->GetArea( areaId );
+        case PCB_LINE_T:  // should not exist on copper layers
+        {
+            AddShapeWithClearanceToContainer( (DRAWSEGMENT*)item,
+                                              layerContainer,
+                                              curr_layer_id,
+                                              0 );
 
-                    if( zone == nullptr )
-                        break;
+            if( layerPoly )
+            {
+                const int nrSegments =
+                        GetNrSegmentsCircle( item->GetBoundingBox().GetSizeMax() );
 
-                    auto layerContainer = m_layers_container2D.find( zone->GetLayer() );
+                ( (DRAWSEGMENT*) item )->TransformShapeWithClearanceToPolygon(
+                            *layerPoly,
+                            0,
+                            nrSegments,
+                            GetCircleCorrectionFactor( nrSegments ) );
+            }
+        }
+        break;
 
-                    if( layerContainer != m_layers_container2D.end() )
-                        AddSolidAreasShapesToContainer( zone, layerContainer->second,
-                                                        zone->GetLayer() );
-                }
+        case PCB_TEXT_T:
+            AddShapeWithClearanceToContainer( (TEXTE_PCB*) item,
+                                              layerContainer,
+                                              curr_layer_id,
+                                              0 );
 
-                threadsFinished++;
-            } );
+            if( layerPoly )
+            {
+                std::lock_guard<std::mutex> lock( m_strokeTextLock );
 
-            t.detach();
+                ( (TEXTE_PCB*) item )->TransformShapeWithClearanceToPolygonSet(
+                            *layerPoly,
+                            0,
+                            segcountforcircle,
+                            correctionFactor );
+            }
+        break;
+
+        case PCB_DIMENSION_T:
+            AddShapeWithClearanceToContainer( (DIMENSION*) item,
+                                              layerContainer,
+                                              curr_layer_id,
+                                              0 );
+        break;
+
+        default:
+            wxLogTrace( m_logTrace,
+                        wxT( "createLayers: item type: %d not implemented" ),
+                        item->Type() );
+        break;
         }
-
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
-
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "fill zones T13: %.3f ms\n", (float)( GetRunningMicroSecs()  - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
-
-    if( GetFlag( FL_ZONE ) &&
-        GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) &&
-        (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY) )
+    // Add zones objects and contours
+    // /////////////////////////////////////////////////////////////////////////
+    if( GetFlag( FL_ZONE ) )
     {
-        // ADD COPPER ZONES
         for( int ii = 0; ii < m_board->GetAreaCount(); ++ii )
         {
             const ZONE_CONTAINER* zone = m_board->GetArea( ii );
 
-            if( zone == nullptr )
-                break;
+            if( zone->GetLayer() != curr_layer_id )
+                continue;
 
-            auto layerContainer = m_layers_poly.find( zone->GetLayer() );
+            AddSolidAreasShapesToContainer( zone, layerContainer, curr_layer_id );
 
-            if( layerContainer != m_layers_poly.end() )
-                zone->TransformSolidAreasShapesToPolygonSet( *layerContainer->second, segcountforcircle, correctionFactor );
+            if( layerPoly )
+                zone->TransformSolidAreasShapesToPolygonSet( *layerPoly,
+                                                             segcountforcircle,
+                                                             correctionFactor );
         }
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T14: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time  ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
+    // This will make a union of all added contours
+    if( layerPoly )
+        layerPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
 
-    // Simplify layer polygons
-    // /////////////////////////////////////////////////////////////////////////
+    if( aItems.m_holes )
+    {
+        aItems.m_outerHolesPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
+        aItems.m_innerHolesPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
 
-    if( aStatusTextReporter )
-        aStatusTextReporter->Report( _( "Simplifying copper layers polygons" ) );
+        aItems.m_holes->BuildBVH();
+    }
+}
+
+
+// Based on: https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L1059
+void CINFO3D_VISU::createTechLayer( LAYER_ITEMS &aItems )
+{
+    const PCB_LAYER_ID curr_layer_id = aItems.m_layer;
+    const double correctionFactorStroke = GetCircleCorrectionFactor( segcountInStrokeFont );
+
+    CBVHCONTAINER2D *layerContainer = new CBVHCONTAINER2D;
+    aItems.m_container = layerContainer;
 
-    if( GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) &&
-        (m_render_engine == RENDER_ENGINE_OPENGL_LEGACY) )
+    SHAPE_POLY_SET *layerPoly = new SHAPE_POLY_SET;
+    aItems.m_poly = layerPoly;
+
+    // Add drawing objects
+    // /////////////////////////////////////////////////////////////////////////
+    for( auto item : m_board->Drawings() )
     {
-        std::atomic<size_t> nextItem( 0 );
-        std::atomic<size_t> threadsFinished( 0 );
+        if( !item->IsOnLayer( curr_layer_id ) )
+            continue;
 
-        size_t parallelThreadCount = std::min<size_t>(
-                std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-                layer_id.size() );
-        for( size_t ii = 0; ii < parallelThreadCount; ++ii )
+        switch( item->Type() )
         {
-            std::thread t = std::thread( [&nextItem, &threadsFinished, &layer_id, this]()
-            {
-                for( size_t i = nextItem.fetch_add( 1 );
-                            i < layer_id.size();
-                            i = nextItem.fetch_add( 1 ) )
-                {
-                    auto layerPoly = m_layers_poly.find( layer_id[i] );
+        case PCB_LINE_T:
+            AddShapeWithClearanceToContainer( (DRAWSEGMENT*)item,
+                                              layerContainer,
+                                              curr_layer_id,
+                                              0 );
+            break;
 
-                    if( layerPoly != m_layers_poly.end() )
-                        // This will make a union of all added contours
-                        layerPoly->second->Simplify( SHAPE_POLY_SET::PM_FAST );
-                }
+        case PCB_TEXT_T:
+            AddShapeWithClearanceToContainer( (TEXTE_PCB*) item,
+                                              layerContainer,
+                                              curr_layer_id,
+                                              0 );
+            break;
 
-                threadsFinished++;
-            } );
+        case PCB_DIMENSION_T:
+            AddShapeWithClearanceToContainer( (DIMENSION*) item,
+                                              layerContainer,
+                                              curr_layer_id,
+                                              0 );
+            break;
 
-            t.detach();
+        default:
+            break;
         }
-
-        while( threadsFinished < parallelThreadCount )
-            std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
     }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T15: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time ) / 1e3 );
-    start_Time = GetRunningMicroSecs();
-#endif
 
-    // Simplify holes polygon contours
+    // Add drawing contours
     // /////////////////////////////////////////////////////////////////////////
-    if( aStatusTextReporter )
-        aStatusTextReporter->Report( _( "Simplify holes contours" ) );
-
-    for( unsigned int lIdx = 0; lIdx < layer_id.size(); ++lIdx )
+    for( auto item : m_board->Drawings() )
     {
-        const PCB_LAYER_ID curr_layer_id = layer_id[lIdx];
+        if( !item->IsOnLayer( curr_layer_id ) )
+            continue;
 
-        if( m_layers_outer_holes_poly.find( curr_layer_id ) !=
-            m_layers_outer_holes_poly.end() )
+        switch( item->Type() )
         {
-            // found
-            SHAPE_POLY_SET *polyLayer = m_layers_outer_holes_poly[curr_layer_id];
-            polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
-
-            wxASSERT( m_layers_inner_holes_poly.find( curr_layer_id ) !=
-                      m_layers_inner_holes_poly.end() );
+        case PCB_LINE_T:
+        {
+            const unsigned int nr_segments =
+                    GetNrSegmentsCircle( item->GetBoundingBox().GetSizeMax() );
 
-            polyLayer = m_layers_inner_holes_poly[curr_layer_id];
-            polyLayer->Simplify( SHAPE_POLY_SET::PM_FAST );
+            ((DRAWSEGMENT*) item)->TransformShapeWithClearanceToPolygon( *layerPoly,
+                                                                         0,
+                                                                         nr_segments,
+                                                                         0.0 );
         }
-    }
+            break;
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    printf( "T16: %.3f ms\n", (float)( GetRunningMicroSecs() - start_Time ) / 1e3 );
-#endif
-    // End Build Copper layers
+        case PCB_TEXT_T:
+        {
+            std::lock_guard<std::mutex> lock( m_strokeTextLock );
 
+            ((TEXTE_PCB*) item)->TransformShapeWithClearanceToPolygonSet( *layerPoly,
+                                                                          0,
+                                                                          segcountInStrokeFont,
+                                                                          1.0 );
+        }
+            break;
 
-    // This will make a union of all added contourns
-    m_through_inner_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_poly_NPTH.Simplify( SHAPE_POLY_SET::PM_FAST );
-    m_through_outer_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST );
-    //m_through_inner_holes_vias_poly.Simplify( SHAPE_POLY_SET::PM_FAST ); // Not in use
+        default:
+            break;
+        }
+    }
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    unsigned stats_endCopperLayersTime = GetRunningMicroSecs();
-#endif
 
-    // Build Tech layers
-    // Based on: https://github.com/KiCad/kicad-source-mirror/blob/master/3d-viewer/3d_draw.cpp#L1059
+    // Add modules tech layers - objects
     // /////////////////////////////////////////////////////////////////////////
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    unsigned stats_startTechLayersTime = GetRunningMicroSecs();
-#endif
-
-    if( aStatusTextReporter )
-        aStatusTextReporter->Report( _( "Build Tech layers" ) );
-
-    // draw graphic items, on technical layers
-    static const PCB_LAYER_ID teckLayerList[] = {
-            B_Adhes,
-            F_Adhes,
-            B_Paste,
-            F_Paste,
-            B_SilkS,
-            F_SilkS,
-            B_Mask,
-            F_Mask,
-
-            // Aux Layers
-            Dwgs_User,
-            Cmts_User,
-            Eco1_User,
-            Eco2_User,
-            Edge_Cuts,
-            Margin
-        };
-
-    // User layers are not drawn here, only technical layers
-
-    for( LSEQ seq = LSET::AllNonCuMask().Seq( teckLayerList, DIM( teckLayerList ) );
-         seq;
-         ++seq )
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
     {
-        const PCB_LAYER_ID curr_layer_id = *seq;
-
-        if( !Is3DLayerEnabled( curr_layer_id ) )
-                    continue;
-
-        CBVHCONTAINER2D *layerContainer = new CBVHCONTAINER2D;
-        m_layers_container2D[curr_layer_id] = layerContainer;
-
-        SHAPE_POLY_SET *layerPoly = new SHAPE_POLY_SET;
-        m_layers_poly[curr_layer_id] = layerPoly;
-
-        // Add drawing objects
-        // /////////////////////////////////////////////////////////////////////
-        for( auto item : m_board->Drawings() )
+        if( (curr_layer_id == F_SilkS) || (curr_layer_id == B_SilkS) )
         {
-            if( !item->IsOnLayer( curr_layer_id ) )
-                continue;
+            D_PAD*  pad = module->PadsList();
+            int     linewidth = g_DrawDefaultLineThickness;
 
-            switch( item->Type() )
+            for( ; pad; pad = pad->Next() )
             {
-            case PCB_LINE_T:
-                AddShapeWithClearanceToContainer( (DRAWSEGMENT*)item,
-                                                  layerContainer,
-                                                  curr_layer_id,
-                                                  0 );
-                break;
-
-            case PCB_TEXT_T:
-                AddShapeWithClearanceToContainer( (TEXTE_PCB*) item,
-                                                  layerContainer,
-                                                  curr_layer_id,
-                                                  0 );
-                break;
-
-            case PCB_DIMENSION_T:
-                AddShapeWithClearanceToContainer( (DIMENSION*) item,
-                                                  layerContainer,
-                                                  curr_layer_id,
-                                                  0 );
-                break;
-
-            default:
-                break;
+                if( !pad->IsOnLayer( curr_layer_id ) )
+                    continue;
+
+                buildPadShapeThickOutlineAsSegments( pad,
+                                                     layerContainer,
+                                                     linewidth );
             }
         }
+        else
+        {
+            AddPadsShapesWithClearanceToContainer( module,
+                                                   layerContainer,
+                                                   curr_layer_id,
+                                                   0,
+                                                   false );
+        }
+
+        AddGraphicsShapesWithClearanceToContainer( module,
+                                                   layerContainer,
+                                                   curr_layer_id,
+                                                   0 );
+    }
 
 
-        // Add drawing contours
-        // /////////////////////////////////////////////////////////////////////
-        for( auto item : m_board->Drawings() )
+    // Add modules tech layers - contours
+    // /////////////////////////////////////////////////////////////////////////
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        if( (curr_layer_id == F_SilkS) || (curr_layer_id == B_SilkS) )
         {
-            if( !item->IsOnLayer( curr_layer_id ) )
-                continue;
+            D_PAD*  pad = module->PadsList();
+            const int linewidth = g_DrawDefaultLineThickness;
 
-            switch( item->Type() )
+            for( ; pad; pad = pad->Next() )
             {
-            case PCB_LINE_T:
-            {
-                const unsigned int nr_segments =
-                        GetNrSegmentsCircle( item->GetBoundingBox().GetSizeMax() );
-
-                ((DRAWSEGMENT*) item)->TransformShapeWithClearanceToPolygon( *layerPoly,
-                                                                             0,
-                                                                             nr_segments,
-                                                                             0.0 );
-            }
-                break;
-
-            case PCB_TEXT_T:
-                ((TEXTE_PCB*) item)->TransformShapeWithClearanceToPolygonSet( *layerPoly,
-                                                                              0,
-                                                                              segcountInStrokeFont,
-                                                                              1.0 );
-                break;
+                if( !pad->IsOnLayer( curr_layer_id ) )
+                    continue;
 
-            default:
-                break;
+                buildPadShapeThickOutlineAsPolygon( pad, *layerPoly, linewidth );
             }
         }
-
-
-        // Add modules tech layers - objects
-        // /////////////////////////////////////////////////////////////////////
-        for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+        else
         {
-            if( (curr_layer_id == F_SilkS) || (curr_layer_id == B_SilkS) )
-            {
-                D_PAD*  pad = module->PadsList();
-                int     linewidth = g_DrawDefaultLineThickness;
-
-                for( ; pad; pad = pad->Next() )
-                {
-                    if( !pad->IsOnLayer( curr_layer_id ) )
-                        continue;
-
-                    buildPadShapeThickOutlineAsSegments( pad,
-                                                         layerContainer,
-                                                         linewidth );
-                }
-            }
-            else
-            {
-                AddPadsShapesWithClearanceToContainer( module,
-                                                       layerContainer,
+            transformPadsShapesWithClearanceToPolygon( module->PadsList(),
                                                        curr_layer_id,
+                                                       *layerPoly,
                                                        0,
                                                        false );
-            }
-
-            AddGraphicsShapesWithClearanceToContainer( module,
-                                                       layerContainer,
-                                                       curr_layer_id,
-                                                       0 );
         }
 
-
-        // Add modules tech layers - contours
-        // /////////////////////////////////////////////////////////////////////
-        for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+        // On tech layers, use a poor circle approximation, only for texts (stroke font)
         {
-            if( (curr_layer_id == F_SilkS) || (curr_layer_id == B_SilkS) )
-            {
-                D_PAD*  pad = module->PadsList();
-                const int linewidth = g_DrawDefaultLineThickness;
-
-                for( ; pad; pad = pad->Next() )
-                {
-                    if( !pad->IsOnLayer( curr_layer_id ) )
-                        continue;
-
-                    buildPadShapeThickOutlineAsPolygon( pad, *layerPoly, linewidth );
-                }
-            }
-            else
-            {
-                transformPadsShapesWithClearanceToPolygon( module->PadsList(),
-                                                           curr_layer_id,
-                                                           *layerPoly,
-                                                           0,
-                                                           false );
-            }
+            std::lock_guard<std::mutex> lock( m_strokeTextLock );
 
-            // On tech layers, use a poor circle approximation, only for texts (stroke font)
             module->TransformGraphicTextWithClearanceToPolygonSet( curr_layer_id,
                                                                    *layerPoly,
                                                                    0,
                                                                    segcountInStrokeFont,
                                                                    correctionFactorStroke,
                                                                    segcountInStrokeFont );
-
-            // Add the remaining things with dynamic seg count for circles
-            transformGraphicModuleEdgeToPolygonSet( module, curr_layer_id, *layerPoly );
         }
 
-
-        // Draw non copper zones
-        // /////////////////////////////////////////////////////////////////////
-        if( GetFlag( FL_ZONE ) )
-        {
-            for( int ii = 0; ii < m_board->GetAreaCount(); ++ii )
-            {
-                ZONE_CONTAINER* zone = m_board->GetArea( ii );
-
-                if( !zone->IsOnLayer( curr_layer_id ) )
-                    continue;
-
-                AddSolidAreasShapesToContainer( zone,
-                                                layerContainer,
-                                                curr_layer_id );
-            }
-
-            for( int ii = 0; ii < m_board->GetAreaCount(); ++ii )
-            {
-                ZONE_CONTAINER* zone = m_board->GetArea( ii );
-
-                if( !zone->IsOnLayer( curr_layer_id ) )
-                    continue;
-
-                zone->TransformSolidAreasShapesToPolygonSet( *layerPoly,
-                                                             // Use the same segcount as stroke font
-                                                             segcountInStrokeFont,
-                                                             correctionFactorStroke );
-            }
-        }
-
-        // This will make a union of all added contours
-        layerPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
+        // Add the remaining things with dynamic seg count for circles
+        transformGraphicModuleEdgeToPolygonSet( module, curr_layer_id, *layerPoly );
     }
-    // End Build Tech layers
-
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    unsigned stats_endTechLayersTime = GetRunningMicroSecs();
-#endif
 
 
-    // Build BVH for holes and vias
+    // Draw non copper zones
     // /////////////////////////////////////////////////////////////////////////
+    if( GetFlag( FL_ZONE ) )
+    {
+        for( int ii = 0; ii < m_board->GetAreaCount(); ++ii )
+        {
+            ZONE_CONTAINER* zone = m_board->GetArea( ii );
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    unsigned stats_startHolesBVHTime = GetRunningMicroSecs();
-#endif
-    if( aStatusTextReporter )
-        aStatusTextReporter->Report( _( "Build BVH for holes and vias" ) );
+            if( !zone->IsOnLayer( curr_layer_id ) )
+                continue;
 
-    m_through_holes_inner.BuildBVH();
-    m_through_holes_outer.BuildBVH();
+            AddSolidAreasShapesToContainer( zone,
+                                            layerContainer,
+                                            curr_layer_id );
+        }
 
-    if( !m_layers_holes2D.empty() )
-    {
-        for( MAP_CONTAINER_2D::iterator ii = m_layers_holes2D.begin();
-             ii != m_layers_holes2D.end();
-             ++ii )
+        for( int ii = 0; ii < m_board->GetAreaCount(); ++ii )
         {
-            ((CBVHCONTAINER2D *)(ii->second))->BuildBVH();
+            ZONE_CONTAINER* zone = m_board->GetArea( ii );
+
+            if( !zone->IsOnLayer( curr_layer_id ) )
+                continue;
+
+            zone->TransformSolidAreasShapesToPolygonSet( *layerPoly,
+                                                         // Use the same segcount as stroke font
+                                                         segcountInStrokeFont,
+                                                         correctionFactorStroke );
         }
     }
 
+    // This will make a union of all added contours
+    layerPoly->Simplify( SHAPE_POLY_SET::PM_FAST );
+
     // We only need the Solder mask to initialize the BVH
     // because..?
-    if( (CBVHCONTAINER2D *)m_layers_container2D[B_Mask] )
-        ((CBVHCONTAINER2D *)m_layers_container2D[B_Mask])->BuildBVH();
-
-    if( (CBVHCONTAINER2D *)m_layers_container2D[F_Mask] )
-        ((CBVHCONTAINER2D *)m_layers_container2D[F_Mask])->BuildBVH();
-
-#ifdef PRINT_STATISTICS_3D_VIEWER
-    unsigned stats_endHolesBVHTime = GetRunningMicroSecs();
-
-    printf( "CINFO3D_VISU::createLayers times\n" );
-    printf( "  Copper Layers:          %.3f ms\n",
-            (float)( stats_endCopperLayersTime  - stats_startCopperLayersTime  ) / 1e3 );
-    printf( "  Holes BVH creation:     %.3f ms\n",
-            (float)( stats_endHolesBVHTime      - stats_startHolesBVHTime      ) / 1e3 );
-    printf( "  Tech Layers:            %.3f ms\n",
-            (float)( stats_endTechLayersTime    - stats_startTechLayersTime    ) / 1e3 );
-    printf( "Statistics:\n" );
-    printf( "  m_stats_nr_tracks                   %u\n", m_stats_nr_tracks );
-    printf( "  m_stats_nr_vias                     %u\n", m_stats_nr_vias );
-    printf( "  m_stats_nr_holes                    %u\n", m_stats_nr_holes );
-    printf( "  m_stats_via_med_hole_diameter (3DU) %f\n", m_stats_via_med_hole_diameter );
-    printf( "  m_stats_hole_med_diameter     (3DU) %f\n", m_stats_hole_med_diameter );
-    printf( "  m_calc_seg_min_factor3DU      (3DU) %f\n", m_calc_seg_min_factor3DU );
-    printf( "  m_calc_seg_max_factor3DU      (3DU) %f\n", m_calc_seg_max_factor3DU );
-#endif
+    if( (curr_layer_id == B_Mask) || (curr_layer_id == F_Mask) )
+        layerContainer->BuildBVH();
 }
@@ -37,6 +37,7 @@
 #include "../3d_viewer/eda_3d_viewer.h"
 #include "../3d_rendering/test_cases.h"
 #include <class_board.h>
+#include <class_module.h>
 #include "status_text_reporter.h"
 #include <gl_context_mgr.h>
 #include <profile.h>        // To use GetRunningMicroSecs or another profiling utility
@@ -149,6 +150,13 @@ EDA_3D_CANVAS::EDA_3D_CANVAS( wxWindow *aParent,
 
     wxASSERT( a3DCachePointer != NULL );
     m_settings.Set3DCacheManager( a3DCachePointer );
+
+    Connect( EVT_3D_MODELS_LOADED,
+             wxCommandEventHandler( EDA_3D_CANVAS::OnModelsLoaded ),
+             NULL,
+             this );
+
+    prefetch_3D_models();
 }
 
 
@@ -156,6 +164,10 @@ EDA_3D_CANVAS::~EDA_3D_CANVAS()
 {
     wxLogTrace( m_logTrace, wxT( "EDA_3D_CANVAS::~EDA_3D_CANVAS" ) );
 
+    // The cache notifies this canvas when the models are loaded
+    if( m_settings.Get3DCacheManager() )
+        m_settings.Get3DCacheManager()->WaitForPrefetch();
+
     releaseOpenGL();
 }
 
@@ -235,11 +247,50 @@ void EDA_3D_CANVAS::ReloadRequest( BOARD *aBoard , S3D_CACHE *aCachePointer )
     if( aBoard != NULL )
         m_settings.SetBoard( aBoard );
 
+    prefetch_3D_models();
+
     if( m_3d_render )
         m_3d_render->ReloadRequest();
 }
 
 
+void EDA_3D_CANVAS::prefetch_3D_models()
+{
+    S3D_CACHE *cache = m_settings.Get3DCacheManager();
+
+    if( !cache || !m_settings.GetBoard() )
+        return;
+
+    std::vector< wxString > modelFiles;
+
+    for( const MODULE* module = m_settings.GetBoard()->m_Modules;
+         module;
+         module = module->Next() )
+    {
+        for( const MODULE_3D_SETTINGS& model : module->Models() )
+        {
+            if( !model.m_Filename.empty() )
+                modelFiles.push_back( model.m_Filename );
+        }
+    }
+
+    cache->PrefetchModels( modelFiles, this );
+}
+
+
+void EDA_3D_CANVAS::OnModelsLoaded( wxCommandEvent &event )
+{
+    (void)event;
+
+    // Only the OpenGL renderer draws placeholders, the raytracer waits for the models
+    if( m_3d_render && ( m_3d_render == m_3d_render_ogl_legacy ) )
+    {
+        m_3d_render->ReloadRequest();
+        Request_refresh();
+    }
+}
+
+
 void EDA_3D_CANVAS::RenderRaytracingRequest()
 {
     m_3d_render = m_3d_render_raytracing;
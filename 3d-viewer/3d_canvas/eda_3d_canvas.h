@@ -165,6 +165,12 @@ class EDA_3D_CANVAS : public HIDPI_GL_CANVAS
 
     void OnTimerTimeout_Redraw( wxTimerEvent& event );
 
+    /**
+     * @brief OnModelsLoaded - called when the 3D models loaded in the background
+     * are available; it replaces the placeholders by the models
+     */
+    void OnModelsLoaded( wxCommandEvent& event );
+
     DECLARE_EVENT_TABLE()
 
  private:
@@ -215,6 +221,12 @@ class EDA_3D_CANVAS : public HIDPI_GL_CANVAS
      */
     void releaseOpenGL();
 
+    /**
+     * @brief prefetch_3D_models - start loading the 3D models of the board in the
+     * background, so the viewer does not wait for them
+     */
+    void prefetch_3D_models();
+
  private:
 
     /// current OpenGL context
@@ -47,6 +47,7 @@ enum DISPLAY3D_FLG {
     // OpenGL options
     FL_RENDER_OPENGL_SHOW_MODEL_BBOX,
     FL_RENDER_OPENGL_COPPER_THICKNESS,
+    FL_RENDER_OPENGL_MODEL_LOD,
 
     // Raytracing options
     FL_RENDER_RAYTRACING_SHADOWS,
@@ -94,4 +95,14 @@ enum MATERIAL_MODE
     MATERIAL_MODE_CAD_MODE      ///< Use a gray shading based on diffuse material
 };
 
+
+/// Quality of the 3d shape models; the values are levels of detail of the 3D cache
+enum MODEL_QUALITY
+{
+    MODEL_QUALITY_FULL,     ///< Use the models as loaded
+    MODEL_QUALITY_HIGH,     ///< Use simplified models, with errors not visible on a board view
+    MODEL_QUALITY_MEDIUM,
+    MODEL_QUALITY_LOW
+};
+
 #endif // _3D_ENUMS_H_
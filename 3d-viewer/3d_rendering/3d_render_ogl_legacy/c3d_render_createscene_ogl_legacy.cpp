@@ -36,6 +36,12 @@
 #include <trigo.h>
 #include <project.h>
 #include <profile.h>        // To use GetRunningMicroSecs or another profiling utility
+#include <base_units.h>
+
+/**
+  * Scale convertion from 3d model units to pcb units
+  */
+#define UNITS3D_TO_UNITSPCB (IU_PER_MM)
 
 
 void C3D_RENDER_OGL_LEGACY::add_object_to_triangle_layer( const CFILLEDCIRCLE2D * aFilledCircle,
@@ -918,6 +924,77 @@ void C3D_RENDER_OGL_LEGACY::generate_3D_Vias_and_Pads()
 }
 
 
+/**
+ * Returns the transformation of a 3D model of a footprint, from the model units to the
+ * 3D units.
+ */
+static glm::mat4 get_3D_model_matrix( const CINFO3D_VISU &aSettings,
+                                      const MODULE *aModule,
+                                      const MODULE_3D_SETTINGS &aModel )
+{
+    const wxPoint pos = aModule->GetPosition();
+
+    glm::mat4 matrix = glm::translate( glm::mat4( 1.0f ),
+                                       SFVEC3F(  pos.x * aSettings.BiuTo3Dunits(),
+                                                -pos.y * aSettings.BiuTo3Dunits(),
+                                                 aSettings.GetModulesZcoord3DIU(
+                                                         aModule->IsFlipped() ) ) );
+
+    if( aModule->GetOrientation() )
+        matrix = glm::rotate( matrix,
+                              (float)( aModule->GetOrientation() / 1800.0 * M_PI ),
+                              SFVEC3F( 0.0f, 0.0f, 1.0f ) );
+
+    if( aModule->IsFlipped() )
+    {
+        matrix = glm::rotate( matrix, glm::pi<float>(), SFVEC3F( 0.0f, 1.0f, 0.0f ) );
+        matrix = glm::rotate( matrix, glm::pi<float>(), SFVEC3F( 0.0f, 0.0f, 1.0f ) );
+    }
+
+    const float modelunit_to_3d_units_factor = aSettings.BiuTo3Dunits() * UNITS3D_TO_UNITSPCB;
+
+    matrix = glm::scale( matrix, SFVEC3F( modelunit_to_3d_units_factor ) );
+
+    matrix = glm::translate( matrix, SFVEC3F( aModel.m_Offset.x,
+                                              aModel.m_Offset.y,
+                                              aModel.m_Offset.z ) );
+
+    matrix = glm::rotate( matrix, (float)( -aModel.m_Rotation.z / 180.0 * M_PI ),
+                          SFVEC3F( 0.0f, 0.0f, 1.0f ) );
+    matrix = glm::rotate( matrix, (float)( -aModel.m_Rotation.y / 180.0 * M_PI ),
+                          SFVEC3F( 0.0f, 1.0f, 0.0f ) );
+    matrix = glm::rotate( matrix, (float)( -aModel.m_Rotation.x / 180.0 * M_PI ),
+                          SFVEC3F( 1.0f, 0.0f, 0.0f ) );
+
+    return glm::scale( matrix, SFVEC3F( aModel.m_Scale.x,
+                                        aModel.m_Scale.y,
+                                        aModel.m_Scale.z ) );
+}
+
+
+/**
+ * Returns the box drawn in place of the models of a footprint: its outline, extruded
+ * out of the board.
+ */
+static CBBOX get_3D_model_placeholder( const CINFO3D_VISU &aSettings, const MODULE *aModule )
+{
+    const EDA_RECT rect = aModule->GetFootprintRect();
+    const float zpos = aSettings.GetModulesZcoord3DIU( aModule->IsFlipped() );
+    const float height = ( aModule->IsFlipped() ? -1.0f : 1.0f ) *
+                         Millimeter2iu( 1.0 ) * aSettings.BiuTo3Dunits();
+
+    CBBOX bbox( SFVEC3F(  rect.GetLeft()   * aSettings.BiuTo3Dunits(),
+                         -rect.GetTop()    * aSettings.BiuTo3Dunits(),
+                          zpos ) );
+
+    bbox.Union( SFVEC3F(  rect.GetRight()  * aSettings.BiuTo3Dunits(),
+                         -rect.GetBottom() * aSettings.BiuTo3Dunits(),
+                          zpos + height ) );
+
+    return bbox;
+}
+
+
 /*
  * This function will get models from the cache and load it to openGL lists
  * in the form of C_OGL_3DMODEL. So this map of models will work as a local
@@ -931,12 +1008,23 @@ void C3D_RENDER_OGL_LEGACY::load_3D_models( REPORTER *aStatusTextReporter )
         (!m_settings.GetFlag( FL_MODULE_ATTRIBUTES_VIRTUAL )) )
         return;
 
+    // The models may still be loading in the background, in that case draw
+    // placeholders; the scene is reloaded when the models are available
+    const bool modelsPending = m_settings.Get3DCacheManager() &&
+                               m_settings.Get3DCacheManager()->IsPrefetching();
+
     // Go for all modules
     for( const MODULE* module = m_settings.GetBoard()->m_Modules;
          module;
          module = module->Next() )
     {
-        if( !module->Models().empty() )
+        if( !module->Models().empty() && modelsPending )
+        {
+            if( m_settings.ShouldModuleBeDisplayed( (MODULE_ATTR_T)module->GetAttributes() ) )
+                m_3dmodel_placeholders[module->IsFlipped() ? 0 : 1].push_back(
+                        get_3D_model_placeholder( m_settings, module ) );
+        }
+        else if( !module->Models().empty() )
         {
             // Get the list of model files for this model
             auto sM = module->Models().begin();
@@ -961,20 +1049,50 @@ void C3D_RENDER_OGL_LEGACY::load_3D_models( REPORTER *aStatusTextReporter )
                     if( m_3dmodel_map.find( sM->m_Filename ) == m_3dmodel_map.end() )
                     {
                         // It is not present, try get it from cache
-                        const S3DMODEL *modelPtr =
-                                m_settings.Get3DCacheManager()->GetModel( sM->m_Filename );
+                        S3D_CACHE *cacheMgr = m_settings.Get3DCacheManager();
+                        const S3DMODEL *modelPtr = cacheMgr->GetModel( sM->m_Filename );
 
                         // only add it if the return is not NULL
                         if( modelPtr )
                         {
-                            C_OGL_3DMODEL* ogl_model =
-                                    new C_OGL_3DMODEL( *modelPtr,
-                                                       m_settings.MaterialModeGet() );
-
-                            if( ogl_model )
-                                m_3dmodel_map[ sM->m_Filename ] = ogl_model;
+                            OGL_3DMODEL_LODS &lods = m_3dmodel_map[ sM->m_Filename ];
+
+                            lods.push_back( new C_OGL_3DMODEL( *modelPtr,
+                                                               m_settings.MaterialModeGet() ) );
+
+                            // The simplified models are picked by screen size when
+                            // rendering; the cache returns the same model for the
+                            // levels a model does not have
+                            const int nLods = m_settings.GetFlag( FL_RENDER_OPENGL_MODEL_LOD ) ?
+                                              S3D_MODEL_LOD_COUNT : 1;
+
+                            for( int lod = 1; lod < nLods; ++lod )
+                            {
+                                const S3DMODEL *lodPtr =
+                                        cacheMgr->GetModel( sM->m_Filename, lod );
+
+                                if( lodPtr && ( lodPtr != modelPtr ) )
+                                    lods.push_back( new C_OGL_3DMODEL(
+                                            *lodPtr, m_settings.MaterialModeGet() ) );
+                                else
+                                    lods.push_back( lods.back() );
+
+                                if( lodPtr )
+                                    modelPtr = lodPtr;
+                            }
                         }
                     }
+
+                    // Store the instance, the footprints are drawn grouped by model
+                    MAP_3DMODEL::const_iterator ii = m_3dmodel_map.find( sM->m_Filename );
+
+                    if( ( ii != m_3dmodel_map.end() ) &&
+                        m_settings.ShouldModuleBeDisplayed(
+                                (MODULE_ATTR_T)module->GetAttributes() ) )
+                    {
+                        m_3dmodel_instances[module->IsFlipped() ? 0 : 1][&ii->second].push_back(
+                                get_3D_model_matrix( m_settings, module, *sM ) );
+                    }
                 }
 
                 ++sM;
@@ -38,11 +38,6 @@
 
 #include <base_units.h>
 
-/**
-  * Scale convertion from 3d model units to pcb units
-  */
-#define UNITS3D_TO_UNITSPCB (IU_PER_MM)
-
 C3D_RENDER_OGL_LEGACY::C3D_RENDER_OGL_LEGACY( CINFO3D_VISU &aSettings ) :
                        C3D_RENDER_BASE( aSettings )
 {
@@ -887,12 +882,22 @@ void C3D_RENDER_OGL_LEGACY::ogl_free_all_display_lists()
          ii != m_3dmodel_map.end();
          ++ii )
     {
-        C_OGL_3DMODEL *pointer = static_cast<C_OGL_3DMODEL*>(ii->second);
-        delete pointer;
+        const OGL_3DMODEL_LODS &lods = ii->second;
+
+        for( unsigned int i = 0; i < lods.size(); ++i )
+        {
+            if( ( i == 0 ) || ( lods[i] != lods[i - 1] ) )
+                delete lods[i];
+        }
     }
 
     m_3dmodel_map.clear();
 
+    m_3dmodel_instances[0].clear();
+    m_3dmodel_instances[1].clear();
+    m_3dmodel_placeholders[0].clear();
+    m_3dmodel_placeholders[1].clear();
+
 
     delete m_ogl_disp_list_board;
     m_ogl_disp_list_board = 0;
@@ -977,118 +982,123 @@ void C3D_RENDER_OGL_LEGACY::render_solder_mask_layer( PCB_LAYER_ID aLayerID,
 }
 
 
-void C3D_RENDER_OGL_LEGACY::render_3D_models( bool aRenderTopOrBot,
-                                              bool aRenderTransparentOnly )
+// Largest error, in pixels, of the simplified models drawn in place of a model
+#define MAX_MODEL_LOD_PIXEL_ERROR 1.0f
+
+/**
+ * Returns the coarsest level of detail of a model whose error, once projected on the
+ * screen, is at most MAX_MODEL_LOD_PIXEL_ERROR.
+ */
+static unsigned int get_3D_model_lod( const CCAMERA &aCamera,
+                                      const wxSize &aWindowSize,
+                                      const OGL_3DMODEL_LODS &aLods,
+                                      const glm::mat4 &aModelMatrix )
 {
-    // Go for all modules
-    if( m_settings.GetBoard()->m_Modules.GetCount() )
-    {
-        for( const MODULE* module = m_settings.GetBoard()->m_Modules;
-             module;
-             module = module->Next() )
-        {
-            if( !module->Models().empty() )
-                if( m_settings.ShouldModuleBeDisplayed( (MODULE_ATTR_T)module->GetAttributes() ) )
-                    if( ( aRenderTopOrBot && !module->IsFlipped()) ||
-                        (!aRenderTopOrBot &&  module->IsFlipped()) )
-                        render_3D_module( module, aRenderTransparentOnly );
-        }
-    }
+    if( aLods.size() <= 1 )
+        return 0;
+
+    // Bounding sphere of the model, in 3D units
+    const CBBOX &bbox = aLods[0]->GetBBox();
+    const float scale = glm::length( SFVEC3F( aModelMatrix[0] ) );
+    const float radius = 0.5f * glm::length( bbox.GetExtent() ) * scale;
+    const glm::vec4 center = aModelMatrix * glm::vec4( bbox.GetCenter(), 1.0f );
+
+    // Project the center and a point of the sphere in a plane parallel to the screen
+    const SFVEC3F cameraUp = SFVEC3F( aCamera.GetViewMatrix_Inv()[1] );
+    const glm::mat4 viewProjection = aCamera.GetProjectionMatrix() * aCamera.GetViewMatrix();
+    const glm::vec4 p0 = viewProjection * center;
+    const glm::vec4 p1 = viewProjection * ( center + glm::vec4( cameraUp * radius, 0.0f ) );
+
+    // Behind the camera: not visible
+    if( ( p0.w <= 0.0f ) || ( p1.w <= 0.0f ) )
+        return aLods.size() - 1;
+
+    const float pixelRadius = 0.5f * aWindowSize.y *
+                              glm::length( SFVEC2F( p1 ) / p1.w - SFVEC2F( p0 ) / p0.w );
+
+    // The errors are relative to the diagonal of the model, twice the radius
+    unsigned int lod = 0;
+
+    while( ( lod + 1 < aLods.size() ) &&
+           ( S3D_CACHE::GetLodError( lod + 1 ) * 2.0f * pixelRadius <=
+             MAX_MODEL_LOD_PIXEL_ERROR ) )
+        ++lod;
+
+    return lod;
 }
 
 
-void C3D_RENDER_OGL_LEGACY::render_3D_module( const MODULE* module,
+void C3D_RENDER_OGL_LEGACY::render_3D_models( bool aRenderTopOrBot,
                                               bool aRenderTransparentOnly )
 {
-    if( !module->Models().empty() )
-    {
-        const double zpos = m_settings.GetModulesZcoord3DIU( module->IsFlipped() );
-
-        glPushMatrix();
+    // The instances are grouped by model, so the footprints using the same model are
+    // drawn one after the other
+    const MAP_3DMODEL_INSTANCES &instances = m_3dmodel_instances[aRenderTopOrBot ? 1 : 0];
 
-        wxPoint pos = module->GetPosition();
+    for( MAP_3DMODEL_INSTANCES::const_iterator ii = instances.begin();
+         ii != instances.end();
+         ++ii )
+    {
+        const OGL_3DMODEL_LODS &lods = *ii->first;
 
-        glTranslatef(  pos.x * m_settings.BiuTo3Dunits(),
-                      -pos.y * m_settings.BiuTo3Dunits(),
-                       zpos );
+        if( ( (!aRenderTransparentOnly) && !lods[0]->Have_opaque() ) ||
+            ( aRenderTransparentOnly && !lods[0]->Have_transparent() ) )
+            continue;
 
-        if( module->GetOrientation() )
-            glRotated( (double) module->GetOrientation() / 10.0, 0.0, 0.0, 1.0 );
+        const std::vector< glm::mat4 > &modelMatrices = ii->second;
 
-        if( module->IsFlipped() )
+        for( unsigned int i = 0; i < modelMatrices.size(); ++i )
         {
-            glRotatef( 180.0f, 0.0f, 1.0f, 0.0f );
-            glRotatef( 180.0f, 0.0f, 0.0f, 1.0f );
-        }
+            // Heavy models far from the camera are drawn simplified
+            const C_OGL_3DMODEL *modelPtr =
+                    lods[get_3D_model_lod( m_settings.CameraGet(), m_windowSize,
+                                           lods, modelMatrices[i] )];
 
-        double modelunit_to_3d_units_factor = m_settings.BiuTo3Dunits() * UNITS3D_TO_UNITSPCB;
+            glPushMatrix();
 
-        glScaled( modelunit_to_3d_units_factor,
-                  modelunit_to_3d_units_factor,
-                  modelunit_to_3d_units_factor );
+            glMultMatrixf( glm::value_ptr( modelMatrices[i] ) );
 
-        // Get the list of model files for this model
-        auto sM = module->Models().begin();
-        auto eM = module->Models().end();
+            if( aRenderTransparentOnly )
+                modelPtr->Draw_transparent();
+            else
+                modelPtr->Draw_opaque();
 
-        while( sM != eM )
-        {
-            if( !sM->m_Filename.empty() )
+            if( m_settings.GetFlag( FL_RENDER_OPENGL_SHOW_MODEL_BBOX ) )
             {
-                // Check if the model is present in our cache map
-                if( m_3dmodel_map.find( sM->m_Filename ) != m_3dmodel_map.end() )
-                {
-                    // It is not present, try get it from cache
-                    const C_OGL_3DMODEL *modelPtr = m_3dmodel_map[ sM->m_Filename ];
-
-                    if( modelPtr )
-                    {
-                        if( ( (!aRenderTransparentOnly) && modelPtr->Have_opaque() ) ||
-                            ( aRenderTransparentOnly && modelPtr->Have_transparent() ) )
-                        {
-                            glPushMatrix();
+                glEnable( GL_BLEND );
+                glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
 
-                            glTranslatef( sM->m_Offset.x, sM->m_Offset.y, sM->m_Offset.z );
+                glLineWidth( 1 );
+                modelPtr->Draw_bboxes();
 
-                            glRotatef( -sM->m_Rotation.z, 0.0f, 0.0f, 1.0f );
-                            glRotatef( -sM->m_Rotation.y, 0.0f, 1.0f, 0.0f );
-                            glRotatef( -sM->m_Rotation.x, 1.0f, 0.0f, 0.0f );
+                glDisable( GL_LIGHTING );
 
-                            glScalef( sM->m_Scale.x, sM->m_Scale.y, sM->m_Scale.z );
+                glColor4f( 0.0f, 1.0f, 0.0f, 1.0f );
 
-                            if( aRenderTransparentOnly )
-                                modelPtr->Draw_transparent();
-                            else
-                                modelPtr->Draw_opaque();
+                glLineWidth( 4 );
+                modelPtr->Draw_bbox();
 
-                            if( m_settings.GetFlag( FL_RENDER_OPENGL_SHOW_MODEL_BBOX ) )
-                            {
-                                glEnable( GL_BLEND );
-                                glBlendFunc( GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA );
+                glEnable( GL_LIGHTING );
+            }
 
-                                glLineWidth( 1 );
-                                modelPtr->Draw_bboxes();
+            glPopMatrix();
+        }
+    }
 
-                                glDisable( GL_LIGHTING );
+    const std::vector< CBBOX > &placeholders = m_3dmodel_placeholders[aRenderTopOrBot ? 1 : 0];
 
-                                glColor4f( 0.0f, 1.0f, 0.0f, 1.0f );
+    if( !aRenderTransparentOnly && !placeholders.empty() )
+    {
+        glDisable( GL_LIGHTING );
 
-                                glLineWidth( 4 );
-                                modelPtr->Draw_bbox();
+        glColor4f( 0.5f, 0.5f, 0.5f, 1.0f );
 
-                                glEnable( GL_LIGHTING );
-                            }
+        glLineWidth( 1 );
 
-                            glPopMatrix();
-                        }
-                    }
-                }
-            }
-
-            ++sM;
-        }
+        for( unsigned int i = 0; i < placeholders.size(); ++i )
+            OGL_draw_bbox( placeholders[i] );
 
-        glPopMatrix();
+        glEnable( GL_LIGHTING );
     }
 }
 
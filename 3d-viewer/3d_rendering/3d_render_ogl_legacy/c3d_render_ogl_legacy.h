@@ -45,11 +45,19 @@
 #include "3d_cache/3d_info.h"
 
 #include <map>
+#include <vector>
 
 
 typedef std::map< PCB_LAYER_ID, CLAYERS_OGL_DISP_LISTS* > MAP_OGL_DISP_LISTS;
 typedef std::map< PCB_LAYER_ID, CLAYER_TRIANGLES * > MAP_TRIANGLES;
-typedef std::map< wxString, C_OGL_3DMODEL * > MAP_3DMODEL;
+/// The levels of detail of a model, see S3D_CACHE::GetModel(); the full model first.
+/// A level the model does not have is the same object as the previous level
+typedef std::vector< C_OGL_3DMODEL * > OGL_3DMODEL_LODS;
+
+typedef std::map< wxString, OGL_3DMODEL_LODS > MAP_3DMODEL;
+
+/// Maps a model with the transformations of the footprint models that use it
+typedef std::map< const OGL_3DMODEL_LODS *, std::vector< glm::mat4 > > MAP_3DMODEL_INSTANCES;
 
 #define SIZE_OF_CIRCLE_TEXTURE 1024
 
@@ -106,6 +114,13 @@ private:
 
     MAP_3DMODEL m_3dmodel_map;
 
+    /// Instances of the models of the footprints on bottom [0] and top [1] layers
+    MAP_3DMODEL_INSTANCES m_3dmodel_instances[2];
+
+    /// Boxes drawn in place of the footprints models while they are loaded in the
+    /// background, on bottom [0] and top [1] layers
+    std::vector< CBBOX > m_3dmodel_placeholders[2];
+
 private:
     void generate_through_outer_holes();
     void generate_through_inner_holes();
@@ -184,7 +199,6 @@ private:
      */
     void render_3D_models( bool aRenderTopOrBot, bool aRenderTransparentOnly );
 
-    void render_3D_module( const MODULE* module, bool aRenderTransparentOnly );
 
     void setLight_Front( bool enabled );
     void setLight_Top( bool enabled );
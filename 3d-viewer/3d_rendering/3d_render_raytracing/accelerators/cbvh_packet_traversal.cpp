@@ -103,6 +103,9 @@ bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
     if( (&m_nodes[0]) == NULL )
         return false;
 
+    if( m_useWideBVH )
+        return intersectWide( aRayPacket, aHitInfoPacket );
+
     bool anyHitted = false;
     int todoOffset = 0, nodeNum = 0;
     StackNode todo[MAX_TODOS];
@@ -221,6 +224,9 @@ static inline unsigned int partRays( const RAYPACKET &aRayPacket,
 bool CBVH_PBRT::Intersect( const RAYPACKET &aRayPacket,
                            HITINFO_PACKET *aHitInfoPacket ) const
 {
+    if( m_useWideBVH )
+        return intersectWide( aRayPacket, aHitInfoPacket );
+
     bool anyHitted = false;
     int todoOffset = 0, nodeNum = 0;
     StackNode todo[MAX_TODOS];
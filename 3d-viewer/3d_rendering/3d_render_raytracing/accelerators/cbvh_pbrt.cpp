@@ -234,7 +234,8 @@ CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
                       int aMaxPrimsInNode,
                       SPLITMETHOD aSplitMethod ) :
     m_maxPrimsInNode( std::min( 255, aMaxPrimsInNode ) ),
-    m_splitMethod( aSplitMethod )
+    m_splitMethod( aSplitMethod ),
+    m_useWideBVH( true )
 {
     if( aObjectContainer.GetList().empty() )
     {
@@ -304,6 +305,8 @@ CBVH_PBRT::CBVH_PBRT( const CGENERICCONTAINER &aObjectContainer,
 
     wxASSERT( offset == (unsigned int)totalNodes );
 
+    buildWideBVH();
+
 #ifdef PRINT_STATISTICS_3D_VIEWER
     uint32_t treeBytes = totalNodes * sizeof( LinearBVHNode ) + sizeof( *this ) +
                          m_primitives.size() * sizeof( m_primitives[0] ) +
@@ -1131,6 +1134,9 @@ bool CBVH_PBRT::Intersect( const RAY &aRay, HITINFO &aHitInfo ) const
     if( !m_nodes )
         return false;
 
+    if( m_useWideBVH )
+        return intersectWide( aRay, aHitInfo );
+
     bool hit = false;
 
     // Follow ray through BVH nodes to find primitive intersections
@@ -1263,6 +1269,9 @@ bool CBVH_PBRT::IntersectP( const RAY &aRay, float aMaxDistance ) const
     if( !m_nodes )
         return false;
 
+    if( m_useWideBVH )
+        return intersectWideP( aRay, aMaxDistance );
+
     // Follow ray through BVH nodes to find primitive intersections
     int todoOffset = 0, nodeNum = 0;
     int todo[MAX_TODOS];
@@ -72,6 +72,7 @@
 
 #include "caccelerator.h"
 #include <list>
+#include <vector>
 #include <stdint.h>
 
 // Forward Declarations
@@ -98,6 +99,24 @@ struct LinearBVHNode
 };
 
 
+/**
+ * Node of the 4-wide BVH collapsed from the binary one. The bounds of the children
+ * are stored as a structure of arrays, so a ray is tested against all of them at once.
+ */
+struct WideBVHNode
+{
+    // 96 bytes
+    float bounds[2][3][4];  ///< [min/max][x/y/z][child]
+
+    // 16 bytes
+    int child[4];           ///< wide node index, or ~index of a binary leaf node
+
+    // 16 bytes
+    int nChildren;
+    int pad[3];             ///< ensure 128 byte total size
+};
+
+
 enum SPLITMETHOD
 {
     SPLIT_MIDDLE,
@@ -123,6 +142,16 @@ public:
     bool Intersect( const RAYPACKET &aRayPacket, HITINFO_PACKET *aHitInfoPacket ) const override;
     bool IntersectP( const RAY &aRay, float aMaxDistance ) const override;
 
+    /**
+     * @brief UseWideBVH - Select the traversal of the 4-wide BVH (default) or of the
+     * binary one. The wide BVH tests 4 bounding boxes at once, using SSE when available.
+     * It is not available (and the binary BVH is always used) if the tree is too deep
+     * for the fixed size traversal stack.
+     */
+    void UseWideBVH( bool aUseWide ) { m_useWideBVH = aUseWide && !m_wideNodes.empty(); }
+
+    bool IsUsingWideBVH() const { return m_useWideBVH; }
+
 private:
 
     BVHBuildNode *recursiveBuild( std::vector<BVHPrimitiveInfo> &primitiveInfo,
@@ -153,12 +182,22 @@ private:
     int flattenBVHTree( BVHBuildNode *node,
                         uint32_t *offset );
 
+    void buildWideBVH();
+    int collapseBVHTree( int aNodeNum, int aDepth, int *aMaxDepth );
+
+    bool intersectWide( const RAY &aRay, HITINFO &aHitInfo ) const;
+    bool intersectWide( const RAYPACKET &aRayPacket, HITINFO_PACKET *aHitInfoPacket ) const;
+    bool intersectWideP( const RAY &aRay, float aMaxDistance ) const;
+
     // BVH Private Data
     const int           m_maxPrimsInNode;
     SPLITMETHOD         m_splitMethod;
     CONST_VECTOR_OBJECT m_primitives;
     LinearBVHNode       *m_nodes;
 
+    std::vector<WideBVHNode> m_wideNodes;
+    bool                     m_useWideBVH;
+
     std::list<void *> m_addresses_pointer_to_mm_free;
 
     // Partition traversal
@@ -0,0 +1,503 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  cbvh_wide_traversal.cpp
+ * @brief Construction and traversal of the 4-wide BVH, which is collapsed from the
+ * binary BVH built by CBVH_PBRT.
+ */
+
+#include "cbvh_pbrt.h"
+#include <wx/debug.h>
+#include <algorithm>
+#include <limits>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 1 )
+#define BVH_WIDE_SSE
+#include <xmmintrin.h>
+#endif
+
+
+// Each expanded node leaves at most 3 of its children on the stack, so a wide
+// tree of depth D needs up to 3 * D + 1 entries. Deeper trees are not traversed
+// with the wide BVH (see buildWideBVH).
+#define MAX_WIDE_TODOS 256
+#define MAX_WIDE_DEPTH ( ( MAX_WIDE_TODOS - 1 ) / 3 )
+
+
+struct WideStackNode
+{
+    int     node;   // wide node index, or ~index of a binary leaf node
+    float   t;      // distance to the node bounding box (single ray traversal)
+};
+
+
+struct WidePacketStackNode
+{
+    int             node;   // wide node index, or ~index of a binary leaf node
+    unsigned int    ia;     // Index to the first alive ray
+};
+
+
+// Leaves of the wide BVH are the leaves of the binary BVH, so the traversal
+// results (m_acc_node_info) are the same with both trees.
+
+void CBVH_PBRT::buildWideBVH()
+{
+    m_wideNodes.clear();
+    m_useWideBVH = false;
+
+    if( m_nodes[0].nPrimitives > 0 )
+    {
+        // The whole tree is a single leaf
+        WideBVHNode root;
+
+        for( unsigned int i = 0; i < 3; ++i )
+        {
+            root.bounds[0][i][0] = m_nodes[0].bounds.Min()[i];
+            root.bounds[1][i][0] = m_nodes[0].bounds.Max()[i];
+        }
+
+        root.child[0] = ~0;
+        root.nChildren = 1;
+        m_wideNodes.push_back( root );
+        m_useWideBVH = true;
+
+        return;
+    }
+
+    int depth = 0;
+
+    collapseBVHTree( 0, 1, &depth );
+
+    // The traversal stacks have a fixed size: a tree too deep for them is dropped
+    // and the binary BVH is traversed instead
+    if( depth > MAX_WIDE_DEPTH )
+    {
+        m_wideNodes.clear();
+        m_wideNodes.shrink_to_fit();
+
+        return;
+    }
+
+    m_useWideBVH = true;
+}
+
+
+int CBVH_PBRT::collapseBVHTree( int aNodeNum, int aDepth, int *aMaxDepth )
+{
+    *aMaxDepth = std::max( *aMaxDepth, aDepth );
+
+    const int wideNum = m_wideNodes.size();
+
+    m_wideNodes.push_back( WideBVHNode() );
+
+    // Gather up to 4 children, opening the interior child with the largest surface
+    int children[4];
+    int nChildren = 2;
+
+    children[0] = aNodeNum + 1;
+    children[1] = m_nodes[aNodeNum].secondChildOffset;
+
+    while( nChildren < 4 )
+    {
+        int best = -1;
+        float bestArea = -1.0f;
+
+        for( int i = 0; i < nChildren; ++i )
+        {
+            const LinearBVHNode &node = m_nodes[children[i]];
+
+            if( ( node.nPrimitives == 0 ) && ( node.bounds.SurfaceArea() > bestArea ) )
+            {
+                best = i;
+                bestArea = node.bounds.SurfaceArea();
+            }
+        }
+
+        if( best < 0 )
+            break;
+
+        const int opened = children[best];
+
+        children[best] = opened + 1;
+        children[nChildren++] = m_nodes[opened].secondChildOffset;
+    }
+
+    int wideChildren[4];
+
+    for( int i = 0; i < nChildren; ++i )
+    {
+        if( m_nodes[children[i]].nPrimitives > 0 )
+            wideChildren[i] = ~children[i];
+        else
+            wideChildren[i] = collapseBVHTree( children[i], aDepth + 1, aMaxDepth );
+    }
+
+    // The node is filled after the recursion, which may reallocate the vector
+    WideBVHNode &wideNode = m_wideNodes[wideNum];
+
+    for( int i = 0; i < 4; ++i )
+    {
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            if( i < nChildren )
+            {
+                wideNode.bounds[0][axis][i] = m_nodes[children[i]].bounds.Min()[axis];
+                wideNode.bounds[1][axis][i] = m_nodes[children[i]].bounds.Max()[axis];
+            }
+            else
+            {
+                wideNode.bounds[0][axis][i] = 0.0f;
+                wideNode.bounds[1][axis][i] = 0.0f;
+            }
+        }
+
+        wideNode.child[i] = ( i < nChildren ) ? wideChildren[i] : ~0;
+    }
+
+    wideNode.nChildren = nChildren;
+
+    return wideNum;
+}
+
+
+/**
+ * Intersects a ray with the bounding boxes of the children of a wide node.
+ * @param aOutTNear receives the entry distance of the ray in each box.
+ * @return the mask of the children hit closer than aMaxT.
+ */
+static inline unsigned int intersectChildren( const WideBVHNode &aNode,
+                                              const RAY &aRay,
+                                              float aMaxT,
+                                              float *aOutTNear )
+{
+    const unsigned int validMask = ( 1 << aNode.nChildren ) - 1;
+
+#ifdef BVH_WIDE_SSE
+    // The ray component goes second in min/max, so a NaN (from a ray parallel to a
+    // slab and starting on it) does not discard the result of other axes
+    __m128 tNear = _mm_set1_ps( -std::numeric_limits<float>::infinity() );
+    __m128 tFar  = _mm_set1_ps( aMaxT );
+
+    for( unsigned int axis = 0; axis < 3; ++axis )
+    {
+        const __m128 origin = _mm_set1_ps( aRay.m_Origin[axis] );
+        const __m128 invDir = _mm_set1_ps( aRay.m_InvDir[axis] );
+
+        const __m128 t0 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( aNode.bounds[0][axis] ),
+                                                  origin ), invDir );
+        const __m128 t1 = _mm_mul_ps( _mm_sub_ps( _mm_loadu_ps( aNode.bounds[1][axis] ),
+                                                  origin ), invDir );
+
+        tNear = _mm_max_ps( _mm_min_ps( t0, t1 ), tNear );
+        tFar  = _mm_min_ps( _mm_max_ps( t0, t1 ), tFar );
+    }
+
+    const __m128 hit = _mm_and_ps( _mm_cmple_ps( tNear, tFar ),
+                                   _mm_cmpge_ps( tFar, _mm_setzero_ps() ) );
+
+    _mm_storeu_ps( aOutTNear, tNear );
+
+    return _mm_movemask_ps( hit ) & validMask;
+#else
+    unsigned int mask = 0;
+
+    for( int i = 0; i < aNode.nChildren; ++i )
+    {
+        float tNear = -std::numeric_limits<float>::infinity();
+        float tFar  = aMaxT;
+
+        for( unsigned int axis = 0; axis < 3; ++axis )
+        {
+            const float t0 = ( aNode.bounds[0][axis][i] - aRay.m_Origin[axis] ) *
+                             aRay.m_InvDir[axis];
+            const float t1 = ( aNode.bounds[1][axis][i] - aRay.m_Origin[axis] ) *
+                             aRay.m_InvDir[axis];
+
+            const float tMin = std::min( t0, t1 );
+            const float tMax = std::max( t0, t1 );
+
+            if( tMin > tNear )
+                tNear = tMin;
+
+            if( tMax < tFar )
+                tFar = tMax;
+        }
+
+        aOutTNear[i] = tNear;
+
+        if( ( tNear <= tFar ) && ( tFar >= 0.0f ) )
+            mask |= 1 << i;
+    }
+
+    return mask & validMask;
+#endif
+}
+
+
+bool CBVH_PBRT::intersectWide( const RAY &aRay, HITINFO &aHitInfo ) const
+{
+    bool hit = false;
+
+    WideStackNode todo[MAX_WIDE_TODOS];
+    int todoOffset = 0;
+
+    todo[todoOffset].node = 0;
+    todo[todoOffset].t = -std::numeric_limits<float>::infinity();
+    todoOffset++;
+
+    while( todoOffset > 0 )
+    {
+        const WideStackNode item = todo[--todoOffset];
+
+        // A closer hit may have been found since the node was pushed
+        if( item.t >= aHitInfo.m_tHit )
+            continue;
+
+        if( item.node < 0 )
+        {
+            // Intersect ray with primitives in leaf BVH node
+            const int leafNum = ~item.node;
+            const LinearBVHNode &leaf = m_nodes[leafNum];
+
+            for( int i = 0; i < leaf.nPrimitives; ++i )
+            {
+                if( m_primitives[leaf.primitivesOffset + i]->Intersect( aRay, aHitInfo ) )
+                {
+                    aHitInfo.m_acc_node_info = leafNum;
+                    hit = true;
+                }
+            }
+
+            continue;
+        }
+
+        const WideBVHNode &node = m_wideNodes[item.node];
+
+        float tNear[4];
+        unsigned int mask = intersectChildren( node, aRay, aHitInfo.m_tHit, tNear );
+
+        // Push the children farthest first, so the nearest one is visited next
+        int order[4];
+        int nHits = 0;
+
+        for( int i = 0; i < 4; ++i )
+        {
+            if( mask & ( 1 << i ) )
+            {
+                int j = nHits++;
+
+                for( ; ( j > 0 ) && ( tNear[order[j - 1]] < tNear[i] ); --j )
+                    order[j] = order[j - 1];
+
+                order[j] = i;
+            }
+        }
+
+        wxASSERT( todoOffset + nHits <= MAX_WIDE_TODOS );
+
+        for( int i = 0; i < nHits; ++i )
+        {
+            todo[todoOffset].node = node.child[order[i]];
+            todo[todoOffset].t = tNear[order[i]];
+            todoOffset++;
+        }
+    }
+
+    return hit;
+}
+
+
+bool CBVH_PBRT::intersectWideP( const RAY &aRay, float aMaxDistance ) const
+{
+    int todo[MAX_WIDE_TODOS];
+    int todoOffset = 0;
+
+    todo[todoOffset++] = 0;
+
+    while( todoOffset > 0 )
+    {
+        const int nodeNum = todo[--todoOffset];
+
+        if( nodeNum < 0 )
+        {
+            // Intersect ray with primitives in leaf BVH node
+            const LinearBVHNode &leaf = m_nodes[~nodeNum];
+
+            for( int i = 0; i < leaf.nPrimitives; ++i )
+            {
+                const COBJECT *obj = m_primitives[leaf.primitivesOffset + i];
+
+                if( obj->GetMaterial()->GetCastShadows() )
+                    if( obj->IntersectP( aRay, aMaxDistance ) )
+                        return true;
+            }
+
+            continue;
+        }
+
+        const WideBVHNode &node = m_wideNodes[nodeNum];
+
+        float tNear[4];
+        const unsigned int mask = intersectChildren( node, aRay, aMaxDistance, tNear );
+
+        wxASSERT( todoOffset + 4 <= MAX_WIDE_TODOS );
+
+        for( int i = 0; i < 4; ++i )
+        {
+            if( mask & ( 1 << i ) )
+                todo[todoOffset++] = node.child[i];
+        }
+    }
+
+    return false;
+}
+
+
+static inline unsigned int getLastHit( const RAYPACKET &aRayPacket,
+                                       const CBBOX &aBBox,
+                                       unsigned int ia,
+                                       HITINFO_PACKET *aHitInfoPacket )
+{
+    for( unsigned int ie = (RAYPACKET_RAYS_PER_PACKET - 1); ie > ia; --ie )
+    {
+        float hitT;
+
+        if( aBBox.Intersect( aRayPacket.m_ray[ie], &hitT ) )
+            if( hitT < aHitInfoPacket[ie].m_HitInfo.m_tHit )
+                return ie + 1;
+    }
+
+    return ia + 1;
+}
+
+
+// Ranged traversal, as in cbvh_packet_traversal.cpp, but the first alive ray of
+// the 4 children of a node is searched at once.
+bool CBVH_PBRT::intersectWide( const RAYPACKET &aRayPacket,
+                               HITINFO_PACKET *aHitInfoPacket ) const
+{
+    bool anyHitted = false;
+
+    WidePacketStackNode todo[MAX_WIDE_TODOS];
+    int todoOffset = 0;
+
+    todo[todoOffset].node = 0;
+    todo[todoOffset].ia = 0;
+    todoOffset++;
+
+    while( todoOffset > 0 )
+    {
+        const WidePacketStackNode item = todo[--todoOffset];
+
+        if( item.node < 0 )
+        {
+            const int leafNum = ~item.node;
+            const LinearBVHNode &leaf = m_nodes[leafNum];
+
+            const unsigned int ia = item.ia;
+            const unsigned int ie = getLastHit( aRayPacket, leaf.bounds, ia, aHitInfoPacket );
+
+            for( int j = 0; j < leaf.nPrimitives; ++j )
+            {
+                const COBJECT *obj = m_primitives[leaf.primitivesOffset + j];
+
+                if( aRayPacket.m_Frustum.Intersect( obj->GetBBox() ) )
+                {
+                    for( unsigned int i = ia; i < ie; ++i )
+                    {
+                        const bool hitted = obj->Intersect( aRayPacket.m_ray[i],
+                                                            aHitInfoPacket[i].m_HitInfo );
+
+                        if( hitted )
+                        {
+                            anyHitted |= hitted;
+                            aHitInfoPacket[i].m_hitresult |= hitted;
+                            aHitInfoPacket[i].m_HitInfo.m_acc_node_info = leafNum;
+                        }
+                    }
+                }
+            }
+
+            continue;
+        }
+
+        const WideBVHNode &node = m_wideNodes[item.node];
+
+        unsigned int firstHit[4] = { RAYPACKET_RAYS_PER_PACKET, RAYPACKET_RAYS_PER_PACKET,
+                                     RAYPACKET_RAYS_PER_PACKET, RAYPACKET_RAYS_PER_PACKET };
+        unsigned int pending = ( 1 << node.nChildren ) - 1;
+
+        for( unsigned int i = item.ia; ( i < RAYPACKET_RAYS_PER_PACKET ) && pending; ++i )
+        {
+            float tNear[4];
+            const unsigned int mask = intersectChildren( node, aRayPacket.m_ray[i],
+                                                         aHitInfoPacket[i].m_HitInfo.m_tHit,
+                                                         tNear ) & pending;
+
+            for( int c = 0; c < 4; ++c )
+            {
+                if( mask & ( 1 << c ) )
+                    firstHit[c] = i;
+            }
+
+            pending &= ~mask;
+
+            // Children missed by the first ray are skipped if out of the packet frustum
+            if( ( i == item.ia ) && pending )
+            {
+                for( int c = 0; c < node.nChildren; ++c )
+                {
+                    if( pending & ( 1 << c ) )
+                    {
+                        const CBBOX childBBox( SFVEC3F( node.bounds[0][0][c],
+                                                        node.bounds[0][1][c],
+                                                        node.bounds[0][2][c] ),
+                                               SFVEC3F( node.bounds[1][0][c],
+                                                        node.bounds[1][1][c],
+                                                        node.bounds[1][2][c] ) );
+
+                        if( !aRayPacket.m_Frustum.Intersect( childBBox ) )
+                            pending &= ~( 1 << c );
+                    }
+                }
+            }
+        }
+
+        wxASSERT( todoOffset + 4 <= MAX_WIDE_TODOS );
+
+        // Push in reverse order, so the children are visited in the tree order
+        for( int c = node.nChildren - 1; c >= 0; --c )
+        {
+            if( firstHit[c] < RAYPACKET_RAYS_PER_PACKET )
+            {
+                todo[todoOffset].node = node.child[c];
+                todo[todoOffset].ia = firstHit[c];
+                todoOffset++;
+            }
+        }
+    }
+
+    return anyHitted;
+}
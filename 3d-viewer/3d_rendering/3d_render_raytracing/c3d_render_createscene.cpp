@@ -34,6 +34,7 @@
 #include "shapes3D/clayeritem.h"
 #include "shapes3D/ccylinder.h"
 #include "shapes3D/ctriangle.h"
+#include "shapes3D/cinstance.h"
 #include "shapes2D/citemlayercsg2d.h"
 #include "shapes2D/cring2d.h"
 #include "shapes2D/cpolygon2d.h"
@@ -251,6 +252,7 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
     m_reloadRequested = false;
 
     m_model_materials.clear();
+    free_3D_model_geometry();
 
     COBJECT2D_STATS::Instance().ResetStats();
     COBJECT3D_STATS::Instance().ResetStats();
@@ -908,9 +910,7 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
     // Create an accelerator
     // /////////////////////////////////////////////////////////////////////////
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_startAcceleratorTime = GetRunningMicroSecs();
-#endif
 
     if( m_accelerator )
     {
@@ -921,9 +921,12 @@ void C3D_RENDER_RAYTRACING::reload( REPORTER *aStatusTextReporter )
     //m_accelerator = new CGRID( m_object_container );
     m_accelerator = new CBVH_PBRT( m_object_container );
 
-#ifdef PRINT_STATISTICS_3D_VIEWER
     unsigned stats_endAcceleratorTime = GetRunningMicroSecs();
-#endif
+
+    m_stats_times.m_sceneBuild = (float)( stats_startAcceleratorTime -
+                                          stats_startReloadTime ) / 1000.0f;
+    m_stats_times.m_acceleratorBuild = (float)( stats_endAcceleratorTime -
+                                                stats_startAcceleratorTime ) / 1000.0f;
 
     setupMaterials();
 
@@ -1197,8 +1200,26 @@ void C3D_RENDER_RAYTRACING::add_3D_vias_and_pads_to_container()
 }
 
 
+/// Models used at least this number of times are instanced, instead of adding their
+/// triangles to the scene for each footprint
+#define MIN_3D_MODEL_INSTANCES 2
+
 void C3D_RENDER_RAYTRACING::load_3D_models()
 {
+    // Models are not loaded if there is no cache manager (e.g. headless rendering)
+    if( !m_settings.Get3DCacheManager() )
+        return;
+
+    // The models loaded in the background are needed for the whole render
+    m_settings.Get3DCacheManager()->WaitForPrefetch();
+
+    const float modelunit_to_3d_units_factor = m_settings.BiuTo3Dunits() *
+                                               UNITS3D_TO_UNITSPCB;
+
+    // The models are collected first, to know which ones are used many times
+    std::vector< std::pair< const S3DMODEL *, glm::mat4 > > models;
+    std::map< const S3DMODEL *, unsigned int > instancesCount;
+
     // Go for all modules
     for( const MODULE* module = m_settings.GetBoard()->m_Modules;
          module;
@@ -1238,9 +1259,6 @@ void C3D_RENDER_RAYTRACING::load_3D_models()
                                             SFVEC3F( 0.0f, 0.0f, 1.0f ) );
             }
 
-            const double modelunit_to_3d_units_factor = m_settings.BiuTo3Dunits() *
-                                                        UNITS3D_TO_UNITSPCB;
-
             moduleMatrix = glm::scale( moduleMatrix,
                                        SFVEC3F( modelunit_to_3d_units_factor,
                                                 modelunit_to_3d_units_factor,
@@ -1253,9 +1271,10 @@ void C3D_RENDER_RAYTRACING::load_3D_models()
 
             while( sM != eM )
             {
-                // get it from cache
+                // get it from cache, simplified to the chosen quality
                 const S3DMODEL *modelPtr =
-                        m_settings.Get3DCacheManager()->GetModel( sM->m_Filename );
+                        m_settings.Get3DCacheManager()->GetModel( sM->m_Filename,
+                                                                  m_settings.ModelQualityGet() );
 
                 // only add it if the return is not NULL
                 if( modelPtr )
@@ -1287,17 +1306,81 @@ void C3D_RENDER_RAYTRACING::load_3D_models()
                                                        sM->m_Scale.y,
                                                        sM->m_Scale.z ) );
 
-                    add_3D_models( modelPtr, modelMatrix );
+                    models.push_back( std::make_pair( modelPtr, modelMatrix ) );
+                    instancesCount[modelPtr]++;
                 }
 
                 ++sM;
             }
         }
     }
+
+    for( unsigned int i = 0; i < models.size(); ++i )
+    {
+        const S3DMODEL *modelPtr = models[i].first;
+        const glm::mat4 &modelMatrix = models[i].second;
+
+        // A mirrored instance would flip the orientation of the shared triangles,
+        // these are added as independent triangles
+        if( ( instancesCount[modelPtr] >= MIN_3D_MODEL_INSTANCES ) &&
+            ( glm::determinant( glm::mat3( modelMatrix ) ) > 0.0f ) )
+            add_3D_model_instance( modelPtr, modelMatrix, modelunit_to_3d_units_factor );
+        else
+            add_3D_models( m_object_container, modelPtr, modelMatrix );
+    }
+}
+
+
+void C3D_RENDER_RAYTRACING::add_3D_model_instance( const S3DMODEL *a3DModel,
+                                                   const glm::mat4 &aModelMatrix,
+                                                   float aModelUnitTo3DUnits )
+{
+    // The shared triangles are scaled to the 3D units, so the normal perturbators give
+    // the same result as for triangles added directly to the scene
+    const glm::mat4 sharedMatrix = glm::scale( glm::mat4( 1.0f ),
+                                               SFVEC3F( aModelUnitTo3DUnits ) );
+
+    MODEL_GEOMETRY *geometry;
+
+    MAP_MODEL_GEOMETRY::iterator it = m_model_geometry.find( a3DModel );
+
+    if( it != m_model_geometry.end() )
+    {
+        geometry = it->second;
+    }
+    else
+    {
+        geometry = new MODEL_GEOMETRY;
+        m_model_geometry[a3DModel] = geometry;
+
+        add_3D_models( geometry->m_triangles, a3DModel, sharedMatrix );
+
+        if( !geometry->m_triangles.GetList().empty() )
+            geometry->m_accelerator = new CBVH_PBRT( geometry->m_triangles );
+    }
+
+    if( !geometry->m_accelerator )
+        return;
+
+    m_object_container.Add( new CINSTANCE( geometry->m_accelerator,
+                                           geometry->m_triangles.GetBBox(),
+                                           aModelMatrix * glm::inverse( sharedMatrix ) ) );
+}
+
+
+void C3D_RENDER_RAYTRACING::free_3D_model_geometry()
+{
+    for( MAP_MODEL_GEOMETRY::iterator it = m_model_geometry.begin();
+         it != m_model_geometry.end();
+         ++it )
+        delete it->second;
+
+    m_model_geometry.clear();
 }
 
 
-void C3D_RENDER_RAYTRACING::add_3D_models( const S3DMODEL *a3DModel,
+void C3D_RENDER_RAYTRACING::add_3D_models( CCONTAINER &aDstContainer,
+                                           const S3DMODEL *a3DModel,
                                            const glm::mat4 &aModelMatrix )
 {
 
@@ -1509,7 +1592,7 @@ void C3D_RENDER_RAYTRACING::add_3D_models( const S3DMODEL *a3DModel,
 
 
 
-                        m_object_container.Add( newTriangle );
+                        aDstContainer.Add( newTriangle );
                         newTriangle->SetMaterial( (const CMATERIAL *)&blinn_material );
 
                         if( mesh.m_Color == NULL )
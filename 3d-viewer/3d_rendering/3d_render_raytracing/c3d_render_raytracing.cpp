@@ -32,6 +32,8 @@
 #include <atomic>
 #include <thread>
 #include <chrono>
+#include <vector>
+#include <wx/image.h>
 
 #include "c3d_render_raytracing.h"
 #include "mortoncodes.h"
@@ -71,6 +73,8 @@ C3D_RENDER_RAYTRACING::C3D_RENDER_RAYTRACING( CINFO3D_VISU &aSettings ) :
     m_rt_render_state = RT_RENDER_STATE_MAX; // Set to an initial invalid state
     m_stats_start_rendering_time = 0;
     m_nrBlocksRenderProgress = 0;
+    m_blockNextToTrace = 0;
+    m_tracingRefinement = false;
 }
 
 
@@ -81,6 +85,8 @@ C3D_RENDER_RAYTRACING::~C3D_RENDER_RAYTRACING()
     delete m_accelerator;
     m_accelerator = NULL;
 
+    free_3D_model_geometry();
+
     delete m_outlineBoard2dObjects;
     m_outlineBoard2dObjects = NULL;
 
@@ -128,15 +134,11 @@ void C3D_RENDER_RAYTRACING::restart_render_state()
 
     m_rt_render_state = RT_RENDER_STATE_TRACING;
     m_nrBlocksRenderProgress = 0;
+    m_blockNextToTrace = 0;
+    m_tracingRefinement = false;
+    m_blocksToRefine.clear();
 
     m_postshader_ssao.InitFrame();
-
-    m_blockPositionsWasProcessed.resize( m_blockPositions.size() );
-
-    // Mark the blocks not processed yet
-    std::fill( m_blockPositionsWasProcessed.begin(),
-               m_blockPositionsWasProcessed.end(),
-               0 );
 }
 
 
@@ -297,6 +299,104 @@ bool C3D_RENDER_RAYTRACING::Redraw( bool aIsMoving, REPORTER *aStatusTextReporte
 }
 
 
+bool C3D_RENDER_RAYTRACING::RenderToImage( const wxSize &aSize, wxImage &aImage,
+                                           RT_RENDER_TIMES *aTimes,
+                                           REPORTER *aStatusTextReporter )
+{
+    // The block positions need some room around the rendered area
+    if( ( aSize.x <= (int)( 4 * RAYPACKET_DIM + 4 ) ) ||
+        ( aSize.y <= (int)( 4 * RAYPACKET_DIM + 4 ) ) )
+        return false;
+
+    m_settings.CameraGet().SetCurWindowSize( aSize );
+
+    if( ( m_windowSize != aSize ) || m_blockPositions.empty() )
+    {
+        m_windowSize = aSize;
+        m_oldWindowsSize = aSize;
+        initialize_block_positions();
+    }
+
+    if( m_reloadRequested )
+        reload( aStatusTextReporter );
+
+    if( !m_accelerator )
+        return false;
+
+    // Render in system memory, the buffer has the same layout as the PBO
+    std::vector<GLubyte> buffer( m_realBufferSize.x * m_realBufferSize.y * 4 );
+
+    restart_render_state();
+
+    if( m_camera_light )
+        m_camera_light->SetDirection( -m_settings.CameraGet().GetDir() );
+
+    m_BgColorTop_LinearRGB = ConvertSRGBToLinear( (SFVEC3F)m_settings.m_BgColorTop );
+    m_BgColorBot_LinearRGB = ConvertSRGBToLinear( (SFVEC3F)m_settings.m_BgColorBot );
+
+    const unsigned stats_startTracingTime = GetRunningMicroSecs();
+
+    // Tracing returns from time to time to report the progress
+    while( m_rt_render_state == RT_RENDER_STATE_TRACING )
+        rt_render_tracing( buffer.data(), aStatusTextReporter );
+
+    const unsigned stats_endTracingTime = GetRunningMicroSecs();
+
+    if( m_rt_render_state == RT_RENDER_STATE_POST_PROCESS_SHADE )
+        rt_render_post_process_shade( buffer.data(), aStatusTextReporter );
+
+    if( m_rt_render_state == RT_RENDER_STATE_POST_PROCESS_BLUR_AND_FINISH )
+        rt_render_post_process_blur_finish( buffer.data(), aStatusTextReporter );
+
+    const unsigned stats_endPostProcessingTime = GetRunningMicroSecs();
+
+    if( aTimes )
+    {
+        *aTimes = m_stats_times;
+        aTimes->m_tracing = (float)( stats_endTracingTime - stats_startTracingTime ) / 1e3f;
+        aTimes->m_postProcessing = (float)( stats_endPostProcessingTime -
+                                            stats_endTracingTime ) / 1e3f;
+    }
+
+    // Copy the buffer to the image. The buffer rows start at the bottom, as for
+    // glDrawPixels(), and the area not covered by the buffer gets the background
+    // gradient that the viewer draws with OGL_DrawBackground().
+    aImage.Create( aSize.x, aSize.y, false );
+
+    unsigned char *dst = aImage.GetData();
+
+    for( int y = 0; y < aSize.y; ++y )
+    {
+        const unsigned int bufY = aSize.y - 1 - y - m_yoffset;
+        const float posYfactor = (float)( aSize.y - 1 - y ) / (float)aSize.y;
+        const SFVEC3F bgColor = (SFVEC3F)m_settings.m_BgColorTop * posYfactor +
+                                (SFVEC3F)m_settings.m_BgColorBot * ( 1.0f - posYfactor );
+
+        for( int x = 0; x < aSize.x; ++x, dst += 3 )
+        {
+            const unsigned int bufX = x - m_xoffset;
+
+            if( ( bufX < m_realBufferSize.x ) && ( bufY < m_realBufferSize.y ) )
+            {
+                const GLubyte *src = &buffer[( bufY * m_realBufferSize.x + bufX ) * 4];
+
+                dst[0] = src[0];
+                dst[1] = src[1];
+                dst[2] = src[2];
+            }
+            else
+            {
+                dst[0] = (unsigned char)glm::clamp( (int)( bgColor.r * 255 ), 0, 255 );
+                dst[1] = (unsigned char)glm::clamp( (int)( bgColor.g * 255 ), 0, 255 );
+                dst[2] = (unsigned char)glm::clamp( (int)( bgColor.b * 255 ), 0, 255 );
+            }
+        }
+    }
+
+    return true;
+}
+
+
 void C3D_RENDER_RAYTRACING::render( GLubyte *ptrPBO , REPORTER *aStatusTextReporter )
 {
     if( (m_rt_render_state == RT_RENDER_STATE_FINISH) ||
@@ -364,36 +464,51 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
 {
     m_isPreview = false;
 
+    // The first pass traces one sample per pixel in all the blocks, so a complete image
+    // is displayed early. The refinement pass then traces the anti-aliasing samples, only
+    // in the pixels that differ from their neighbours.
+    const bool isRefining = m_tracingRefinement;
+    const size_t nrBlocks = isRefining ? m_blocksToRefine.size() : m_blockPositions.size();
+
     auto startTime = std::chrono::steady_clock::now();
-    bool breakLoop = false;
+    std::atomic<bool> breakLoop( false );
 
     std::atomic<size_t> numBlocksRendered( 0 );
-    std::atomic<size_t> currentBlock( 0 );
+    std::atomic<size_t> currentBlock( m_blockNextToTrace );
     std::atomic<size_t> threadsFinished( 0 );
 
     size_t parallelThreadCount = std::min<size_t>(
             std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
-            m_blockPositions.size() );
+            nrBlocks - m_blockNextToTrace );
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
         std::thread t = std::thread( [&]()
         {
-            for( size_t iBlock = currentBlock.fetch_add( 1 );
-                        iBlock < m_blockPositions.size() && !breakLoop;
-                        iBlock = currentBlock.fetch_add( 1 ) )
+            // A block is only taken from the queue if it will be traced, so the tracing
+            // continues from currentBlock on the next call
+            while( !breakLoop )
             {
-                if( !m_blockPositionsWasProcessed[iBlock] )
+                const size_t iQueue = currentBlock.fetch_add( 1 );
+
+                if( iQueue >= nrBlocks )
+                    break;
+
+                if( isRefining )
                 {
-                    rt_render_trace_block( ptrPBO, iBlock );
-                    numBlocksRendered++;
-                    m_blockPositionsWasProcessed[iBlock] = 1;
-
-                    // Check if it spend already some time render and request to exit
-                    // to display the progress
-                    if( std::chrono::duration_cast<std::chrono::milliseconds>(
-                            std::chrono::steady_clock::now() - startTime ).count() > 150 )
-                        breakLoop = true;
+                    const size_t iBlock = m_blocksToRefine[iQueue];
+
+                    rt_render_refine_block( ptrPBO, iBlock, m_blockRefineMask[iBlock] );
                 }
+                else
+                    rt_render_trace_block( ptrPBO, iQueue );
+
+                numBlocksRendered++;
+
+                // Check if it spend already some time render and request to exit
+                // to display the progress
+                if( std::chrono::duration_cast<std::chrono::milliseconds>(
+                        std::chrono::steady_clock::now() - startTime ).count() > 150 )
+                    breakLoop = true;
             }
 
             threadsFinished++;
@@ -405,23 +520,97 @@ void C3D_RENDER_RAYTRACING::rt_render_tracing( GLubyte *ptrPBO ,
     while( threadsFinished < parallelThreadCount )
         std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
 
+    m_blockNextToTrace = std::min<size_t>( currentBlock, nrBlocks );
     m_nrBlocksRenderProgress += numBlocksRendered;
 
-    if( aStatusTextReporter )
-        aStatusTextReporter->Report( wxString::Format( _( "Rendering: %.0f %%" ),
-                                                       (float)(m_nrBlocksRenderProgress * 100) /
-                                                       (float)m_blockPositions.size() ) );
+    if( aStatusTextReporter && nrBlocks )
+    {
+        const float progress = (float)(m_nrBlocksRenderProgress * 100) / (float)nrBlocks;
+
+        if( isRefining )
+            aStatusTextReporter->Report(
+                    wxString::Format( _( "Rendering: anti-aliasing %.0f %%" ), progress ) );
+        else
+            aStatusTextReporter->Report(
+                    wxString::Format( _( "Rendering: %.0f %%" ), progress ) );
+    }
+
+    if( m_blockNextToTrace < nrBlocks )
+        return;
+
+    // Check if it finish the first pass and should continue with the anti-aliasing
+    if( !isRefining && m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING ) )
+    {
+        rt_find_blocks_to_refine();
+
+        m_tracingRefinement = true;
+        m_blockNextToTrace = 0;
+        m_nrBlocksRenderProgress = 0;
+
+        return;
+    }
 
     // Check if it finish the rendering and if should continue to a post processing
     // or mark it as finished
-    if( m_nrBlocksRenderProgress >= m_blockPositions.size() )
+    if( m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING ) )
+        m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_SHADE;
+    else
     {
-        if( m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING ) )
-            m_rt_render_state = RT_RENDER_STATE_POST_PROCESS_SHADE;
-        else
+        m_rt_render_state = RT_RENDER_STATE_FINISH;
+    }
+}
+
+
+/// Minimum difference (sum of the linear RGB components) between a pixel and one of its
+/// neighbours for the pixel to get anti-aliasing samples
+#define AA_CONTRAST_THRESHOLD 0.08f
+
+static inline bool hasContrast( const SFVEC3F &aColorA, const SFVEC3F &aColorB )
+{
+    const SFVEC3F diff = glm::abs( aColorA - aColorB );
+
+    return ( diff.r + diff.g + diff.b ) > AA_CONTRAST_THRESHOLD;
+}
+
+
+void C3D_RENDER_RAYTRACING::rt_find_blocks_to_refine()
+{
+    // The first pass stored its (linear) colors in m_shaderBuffer, which is only used
+    // again by the post processing
+    const int width = m_realBufferSize.x;
+    const int height = m_realBufferSize.y;
+
+    m_blockRefineMask.resize( m_blockPositions.size() );
+    m_blocksToRefine.clear();
+
+    for( size_t iBlock = 0; iBlock < m_blockPositions.size(); ++iBlock )
+    {
+        const SFVEC2UI &blockPos = m_blockPositions[iBlock];
+        uint64_t mask = 0;
+
+        for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
         {
-            m_rt_render_state = RT_RENDER_STATE_FINISH;
+            const int py = blockPos.y + y;
+
+            for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
+            {
+                const int px = blockPos.x + x;
+                const SFVEC3F *pixel = &m_shaderBuffer[ py * width + px ];
+
+                if( ( ( px > 0 )            && hasContrast( pixel[0], pixel[-1] ) ) ||
+                    ( ( px < width - 1 )    && hasContrast( pixel[0], pixel[1] ) ) ||
+                    ( ( py > 0 )            && hasContrast( pixel[0], pixel[-width] ) ) ||
+                    ( ( py < height - 1 )   && hasContrast( pixel[0], pixel[width] ) ) )
+                    mask |= (uint64_t)1 << i;
+            }
         }
+
+        // Blocks are kept in Morton order.  The blocks whose first samples all missed the
+        // scene get no more samples.
+        m_blockRefineMask[iBlock] = mask;
+
+        if( mask && m_blockFirstPassHit[iBlock] )
+            m_blocksToRefine.push_back( iBlock );
     }
 }
 
@@ -531,6 +720,7 @@ void C3D_RENDER_RAYTRACING::rt_trace_AA_packet( const SFVEC3F *aBgColorY,
                                                 const HITINFO_PACKET *aHitPck_X0Y0,
                                                 const HITINFO_PACKET *aHitPck_AA_X1Y1,
                                                 const RAY *aRayPck,
+                                                uint64_t aRefineMask,
                                                 SFVEC3F *aOutHitColor )
 {
     const bool is_testShadow =  m_settings.GetFlag( FL_RENDER_RAYTRACING_SHADOWS );
@@ -539,6 +729,10 @@ void C3D_RENDER_RAYTRACING::rt_trace_AA_packet( const SFVEC3F *aBgColorY,
     {
         for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
         {
+            // Pixels without contrast keep the color they already have
+            if( !( aRefineMask & ( (uint64_t)1 << i ) ) )
+                continue;
+
             const RAY &rayAA = aRayPck[i];
 
             HITINFO hitAA;
@@ -654,6 +848,19 @@ void C3D_RENDER_RAYTRACING::rt_trace_AA_packet( const SFVEC3F *aBgColorY,
 
 #define DISP_FACTOR 0.075f
 
+void C3D_RENDER_RAYTRACING::rt_block_background( const SFVEC2I &aBlockPosI,
+                                                 SFVEC3F *aBgColorY ) const
+{
+    for( unsigned int y = 0; y < RAYPACKET_DIM; ++y )
+    {
+        const float posYfactor = (float)(aBlockPosI.y + y) / (float)m_windowSize.y;
+
+        aBgColorY[y] = m_BgColorTop_LinearRGB * SFVEC3F(posYfactor) +
+                       m_BgColorBot_LinearRGB * ( SFVEC3F(1.0f) - SFVEC3F(posYfactor) );
+    }
+}
+
+
 void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
                                                    signed int iBlock )
 {
@@ -676,17 +883,13 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
     // /////////////////////////////////////////////////////////////////////////
     SFVEC3F bgColor[RAYPACKET_DIM];// Store a vertical gradient color
 
-    for( unsigned int y = 0; y < RAYPACKET_DIM; ++y )
-    {
-        const float posYfactor = (float)(blockPosI.y + y) / (float)m_windowSize.y;
-
-        bgColor[y] = m_BgColorTop_LinearRGB * SFVEC3F(posYfactor) +
-                     m_BgColorBot_LinearRGB * ( SFVEC3F(1.0f) - SFVEC3F(posYfactor) );
-    }
+    rt_block_background( blockPosI, bgColor );
 
     // Intersect ray packets (calculate the intersection with rays and objects)
     // /////////////////////////////////////////////////////////////////////////
-    if( !m_accelerator->Intersect( blockPacket, hitPacket_X0Y0 ) )
+    m_blockFirstPassHit[iBlock] = m_accelerator->Intersect( blockPacket, hitPacket_X0Y0 );
+
+    if( !m_blockFirstPassHit[iBlock] )
     {
 
         // If block is empty then set shades and continue
@@ -730,6 +933,7 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
                 GLubyte *ptr = &ptrPBO[ (yConst + x) * 4 ];
 
                 rt_final_color( ptr, outColor, isFinalColor );
+                m_shaderBuffer[yConst + x] = outColor;
             }
         }
 
@@ -749,102 +953,15 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
                       m_settings.GetFlag( FL_RENDER_RAYTRACING_SHADOWS ),
                       hitColor_X0Y0 );
 
-    if( m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING ) )
-    {
-        SFVEC3F hitColor_AA_X1Y1[RAYPACKET_RAYS_PER_PACKET];
-
-
-        // Intersect one blockPosI + (0.5, 0.5) used for anti aliasing calculation
-        // /////////////////////////////////////////////////////////////////////////
-        HITINFO_PACKET hitPacket_AA_X1Y1[RAYPACKET_RAYS_PER_PACKET];
-        HITINFO_PACKET_init( hitPacket_AA_X1Y1 );
-
-        RAYPACKET blockPacket_AA_X1Y1( m_settings.CameraGet(),
-                                       (SFVEC2F)blockPosI + SFVEC2F(0.5f, 0.5f),
-                                       SFVEC2F(DISP_FACTOR, DISP_FACTOR) // Displacement random factor
-                                       );
-
-        if( !m_accelerator->Intersect( blockPacket_AA_X1Y1, hitPacket_AA_X1Y1 ) )
-        {
-            // Missed all the package
-            for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
-            {
-                const SFVEC3F &outColor = bgColor[y];
+    // Keep the nodes hit by the first samples: the refinement pass starts from them
+    const unsigned int firstPixel = blockPos.x + blockPos.y * m_realBufferSize.x;
 
-                for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
-                {
-                    hitColor_AA_X1Y1[i] = outColor;
-                }
-            }
-        }
-        else
-        {
-            rt_shades_packet( bgColor,
-                              blockPacket_AA_X1Y1.m_ray,
-                              hitPacket_AA_X1Y1,
-                              m_settings.GetFlag( FL_RENDER_RAYTRACING_SHADOWS ),
-                              hitColor_AA_X1Y1
-                              );
-        }
-
-        SFVEC3F hitColor_AA_X1Y0[RAYPACKET_RAYS_PER_PACKET];
-        SFVEC3F hitColor_AA_X0Y1[RAYPACKET_RAYS_PER_PACKET];
-        SFVEC3F hitColor_AA_X0Y1_half[RAYPACKET_RAYS_PER_PACKET];
-
-        for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
-        {
-            const SFVEC3F color_average = ( hitColor_X0Y0[i] +
-                                            hitColor_AA_X1Y1[i] ) * SFVEC3F(0.5f);
-
-            hitColor_AA_X1Y0[i] = color_average;
-            hitColor_AA_X0Y1[i] = color_average;
-            hitColor_AA_X0Y1_half[i] = color_average;
-        }
+    for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
+    {
+        unsigned int *nodes = &m_firstPassHitNodes[ firstPixel + y * m_realBufferSize.x ];
 
-        RAY blockRayPck_AA_X1Y0[RAYPACKET_RAYS_PER_PACKET];
-        RAY blockRayPck_AA_X0Y1[RAYPACKET_RAYS_PER_PACKET];
-        RAY blockRayPck_AA_X1Y1_half[RAYPACKET_RAYS_PER_PACKET];
-
-        RAYPACKET_InitRays_with2DDisplacement( m_settings.CameraGet(),
-                                               (SFVEC2F)blockPosI + SFVEC2F(0.5f - DISP_FACTOR, DISP_FACTOR),
-                                               SFVEC2F(DISP_FACTOR, DISP_FACTOR), // Displacement random factor
-                                               blockRayPck_AA_X1Y0 );
-
-        RAYPACKET_InitRays_with2DDisplacement( m_settings.CameraGet(),
-                                               (SFVEC2F)blockPosI + SFVEC2F(DISP_FACTOR, 0.5f - DISP_FACTOR),
-                                               SFVEC2F(DISP_FACTOR, DISP_FACTOR), // Displacement random factor
-                                               blockRayPck_AA_X0Y1 );
-
-        RAYPACKET_InitRays_with2DDisplacement( m_settings.CameraGet(),
-                                               (SFVEC2F)blockPosI + SFVEC2F(0.25f - DISP_FACTOR, 0.25f - DISP_FACTOR),
-                                               SFVEC2F(DISP_FACTOR, DISP_FACTOR), // Displacement random factor
-                                               blockRayPck_AA_X1Y1_half );
-
-        rt_trace_AA_packet( bgColor,
-                            hitPacket_X0Y0, hitPacket_AA_X1Y1,
-                            blockRayPck_AA_X1Y0,
-                            hitColor_AA_X1Y0 );
-
-        rt_trace_AA_packet( bgColor,
-                            hitPacket_X0Y0, hitPacket_AA_X1Y1,
-                            blockRayPck_AA_X0Y1,
-                            hitColor_AA_X0Y1 );
-
-        rt_trace_AA_packet( bgColor,
-                            hitPacket_X0Y0, hitPacket_AA_X1Y1,
-                            blockRayPck_AA_X1Y1_half,
-                            hitColor_AA_X0Y1_half );
-
-        // Average the result
-        for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
-        {
-            hitColor_X0Y0[i] = ( hitColor_X0Y0[i] +
-                                 hitColor_AA_X1Y1[i] +
-                                 hitColor_AA_X1Y0[i] +
-                                 hitColor_AA_X0Y1[i] +
-                                 hitColor_AA_X0Y1_half[i]
-                                 ) * SFVEC3F(1.0f / 5.0f);
-        }
+        for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
+            nodes[x] = hitPacket_X0Y0[i].m_HitInfo.m_acc_node_info;
     }
 
 
@@ -886,6 +1003,7 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
                                                     1.0f );
 
                 rt_final_color( ptr, hColor, false );
+                m_shaderBuffer[ bPos.x + bPos.y * m_realBufferSize.x ] = hColor;
 
                 bPos.x++;
                 ptr += 4;
@@ -897,15 +1015,176 @@ void C3D_RENDER_RAYTRACING::rt_render_trace_block( GLubyte *ptrPBO ,
     }
     else
     {
+        SFVEC3F *ptrShader = &m_shaderBuffer[ blockPos.x + blockPos.y * m_realBufferSize.x ];
+
         for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
         {
             for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
             {
                 rt_final_color( ptr, hitColor_X0Y0[i], true );
+                *ptrShader++ = hitColor_X0Y0[i];
                 ptr += 4;
             }
 
             ptr += ptrInc;
+            ptrShader += m_realBufferSize.x - RAYPACKET_DIM;
+        }
+    }
+}
+
+
+void C3D_RENDER_RAYTRACING::rt_render_refine_block( GLubyte *ptrPBO,
+                                                    signed int iBlock,
+                                                    uint64_t aRefineMask )
+{
+    const SFVEC2UI &blockPos = m_blockPositions[iBlock];
+    const SFVEC2I blockPosI = SFVEC2I( blockPos.x + m_xoffset,
+                                       blockPos.y + m_yoffset );
+
+    SFVEC3F bgColor[RAYPACKET_DIM];
+
+    rt_block_background( blockPosI, bgColor );
+
+    // The first samples are not traced again: their color and the node they hit are
+    // the ones of the first pass
+    // /////////////////////////////////////////////////////////////////////////
+    const unsigned int firstPixel = blockPos.x + blockPos.y * m_realBufferSize.x;
+
+    HITINFO_PACKET hitPacket_X0Y0[RAYPACKET_RAYS_PER_PACKET];
+    SFVEC3F hitColor_X0Y0[RAYPACKET_RAYS_PER_PACKET];
+
+    HITINFO_PACKET_init( hitPacket_X0Y0 );
+
+    for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
+    {
+        const unsigned int rowPixel = firstPixel + y * m_realBufferSize.x;
+
+        for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
+        {
+            hitPacket_X0Y0[i].m_HitInfo.m_acc_node_info = m_firstPassHitNodes[rowPixel + x];
+            hitColor_X0Y0[i] = m_shaderBuffer[rowPixel + x];
+        }
+    }
+
+    SFVEC3F hitColor_AA_X1Y1[RAYPACKET_RAYS_PER_PACKET];
+
+
+    // Intersect one blockPosI + (0.5, 0.5) used for anti aliasing calculation
+    // /////////////////////////////////////////////////////////////////////////
+    HITINFO_PACKET hitPacket_AA_X1Y1[RAYPACKET_RAYS_PER_PACKET];
+    HITINFO_PACKET_init( hitPacket_AA_X1Y1 );
+
+    RAYPACKET blockPacket_AA_X1Y1( m_settings.CameraGet(),
+                                   (SFVEC2F)blockPosI + SFVEC2F(0.5f, 0.5f),
+                                   SFVEC2F(DISP_FACTOR, DISP_FACTOR) // Displacement random factor
+                                   );
+
+    if( !m_accelerator->Intersect( blockPacket_AA_X1Y1, hitPacket_AA_X1Y1 ) )
+    {
+        // Missed all the package
+        for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
+        {
+            const SFVEC3F &outColor = bgColor[y];
+
+            for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
+            {
+                hitColor_AA_X1Y1[i] = outColor;
+            }
+        }
+    }
+    else
+    {
+        rt_shades_packet( bgColor,
+                          blockPacket_AA_X1Y1.m_ray,
+                          hitPacket_AA_X1Y1,
+                          m_settings.GetFlag( FL_RENDER_RAYTRACING_SHADOWS ),
+                          hitColor_AA_X1Y1
+                          );
+    }
+
+    SFVEC3F hitColor_AA_X1Y0[RAYPACKET_RAYS_PER_PACKET];
+    SFVEC3F hitColor_AA_X0Y1[RAYPACKET_RAYS_PER_PACKET];
+    SFVEC3F hitColor_AA_X0Y1_half[RAYPACKET_RAYS_PER_PACKET];
+
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    {
+        const SFVEC3F color_average = ( hitColor_X0Y0[i] +
+                                        hitColor_AA_X1Y1[i] ) * SFVEC3F(0.5f);
+
+        hitColor_AA_X1Y0[i] = color_average;
+        hitColor_AA_X0Y1[i] = color_average;
+        hitColor_AA_X0Y1_half[i] = color_average;
+    }
+
+    RAY blockRayPck_AA_X1Y0[RAYPACKET_RAYS_PER_PACKET];
+    RAY blockRayPck_AA_X0Y1[RAYPACKET_RAYS_PER_PACKET];
+    RAY blockRayPck_AA_X1Y1_half[RAYPACKET_RAYS_PER_PACKET];
+
+    RAYPACKET_InitRays_with2DDisplacement( m_settings.CameraGet(),
+                                           (SFVEC2F)blockPosI + SFVEC2F(0.5f - DISP_FACTOR, DISP_FACTOR),
+                                           SFVEC2F(DISP_FACTOR, DISP_FACTOR), // Displacement random factor
+                                           blockRayPck_AA_X1Y0 );
+
+    RAYPACKET_InitRays_with2DDisplacement( m_settings.CameraGet(),
+                                           (SFVEC2F)blockPosI + SFVEC2F(DISP_FACTOR, 0.5f - DISP_FACTOR),
+                                           SFVEC2F(DISP_FACTOR, DISP_FACTOR), // Displacement random factor
+                                           blockRayPck_AA_X0Y1 );
+
+    RAYPACKET_InitRays_with2DDisplacement( m_settings.CameraGet(),
+                                           (SFVEC2F)blockPosI + SFVEC2F(0.25f - DISP_FACTOR, 0.25f - DISP_FACTOR),
+                                           SFVEC2F(DISP_FACTOR, DISP_FACTOR), // Displacement random factor
+                                           blockRayPck_AA_X1Y1_half );
+
+    rt_trace_AA_packet( bgColor,
+                        hitPacket_X0Y0, hitPacket_AA_X1Y1,
+                        blockRayPck_AA_X1Y0,
+                        aRefineMask,
+                        hitColor_AA_X1Y0 );
+
+    rt_trace_AA_packet( bgColor,
+                        hitPacket_X0Y0, hitPacket_AA_X1Y1,
+                        blockRayPck_AA_X0Y1,
+                        aRefineMask,
+                        hitColor_AA_X0Y1 );
+
+    rt_trace_AA_packet( bgColor,
+                        hitPacket_X0Y0, hitPacket_AA_X1Y1,
+                        blockRayPck_AA_X1Y1_half,
+                        aRefineMask,
+                        hitColor_AA_X0Y1_half );
+
+    // Average the result
+    for( unsigned int i = 0; i < RAYPACKET_RAYS_PER_PACKET; ++i )
+    {
+        if( aRefineMask & ( (uint64_t)1 << i ) )
+            hitColor_X0Y0[i] = ( hitColor_X0Y0[i] +
+                                 hitColor_AA_X1Y1[i] +
+                                 hitColor_AA_X1Y0[i] +
+                                 hitColor_AA_X0Y1[i] +
+                                 hitColor_AA_X0Y1_half[i]
+                                 ) * SFVEC3F(1.0f / 5.0f);
+        else
+            hitColor_X0Y0[i] = ( hitColor_X0Y0[i] +
+                                 hitColor_AA_X1Y1[i] ) * SFVEC3F(0.5f);
+    }
+
+    // Copy results to the next stage.  Only the color changes: the post processing keeps
+    // the normals and depths of the first samples.
+    // /////////////////////////////////////////////////////////////////////////
+    const bool isPostProcessing = m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING );
+
+    for( unsigned int y = 0, i = 0; y < RAYPACKET_DIM; ++y )
+    {
+        const unsigned int rowPixel = firstPixel + y * m_realBufferSize.x;
+
+        for( unsigned int x = 0; x < RAYPACKET_DIM; ++x, ++i )
+        {
+            if( isPostProcessing )
+                m_postshader_ssao.SetPixelColor( blockPos.x + x, blockPos.y + y,
+                                                 hitColor_X0Y0[i] );
+
+            rt_final_color( &ptrPBO[ (rowPixel + x) * 4 ], hitColor_X0Y0[i], !isPostProcessing );
+            m_shaderBuffer[rowPixel + x] = hitColor_X0Y0[i];
         }
     }
 }
@@ -2148,5 +2427,10 @@ void C3D_RENDER_RAYTRACING::initialize_block_positions()
     delete[] m_shaderBuffer;
     m_shaderBuffer = new SFVEC3F[m_realBufferSize.x * m_realBufferSize.y];
 
-    opengl_init_pbo();
+    m_firstPassHitNodes.resize( m_realBufferSize.x * m_realBufferSize.y );
+    m_blockFirstPassHit.assign( m_blockPositions.size(), 0 );
+
+    // There is no PBO when rendering without a graphics context
+    if( m_is_opengl_initialized )
+        opengl_init_pbo();
 }
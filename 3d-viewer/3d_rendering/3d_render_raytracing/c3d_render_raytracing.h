@@ -40,6 +40,9 @@
 #include <plugins/3dapi/c3dmodel.h>
 
 #include <map>
+#include <stdint.h>
+
+class wxImage;
 
 /// Vector of materials
 typedef std::vector< CBLINN_PHONG_MATERIAL > MODEL_MATERIALS;
@@ -47,6 +50,19 @@ typedef std::vector< CBLINN_PHONG_MATERIAL > MODEL_MATERIALS;
 /// Maps a S3DMODEL pointer with a created CBLINN_PHONG_MATERIAL vector
 typedef std::map< const S3DMODEL * , MODEL_MATERIALS > MAP_MODEL_MATERIALS;
 
+/// Triangles of a 3D model and their accelerator, shared by the instances of the model
+struct MODEL_GEOMETRY
+{
+    MODEL_GEOMETRY() : m_accelerator( NULL ) {}
+    ~MODEL_GEOMETRY() { delete m_accelerator; }
+
+    CCONTAINER           m_triangles;
+    CGENERICACCELERATOR *m_accelerator;
+};
+
+/// Maps a S3DMODEL pointer with the geometry shared by its instances
+typedef std::map< const S3DMODEL * , MODEL_GEOMETRY * > MAP_MODEL_GEOMETRY;
+
 typedef enum
 {
     RT_RENDER_STATE_TRACING = 0,
@@ -56,6 +72,22 @@ typedef enum
     RT_RENDER_STATE_MAX
 }RT_RENDER_STATE;
 
+/// Time spent on each phase of a render, in milliseconds
+struct RT_RENDER_TIMES
+{
+    float m_sceneBuild;         ///< conversion of the board to 3D objects and models loading
+    float m_acceleratorBuild;   ///< BVH construction
+    float m_tracing;            ///< ray tracing of all the blocks
+    float m_postProcessing;     ///< ambient occlusion shader and final blur
+
+    RT_RENDER_TIMES() :
+        m_sceneBuild( 0.0f ),
+        m_acceleratorBuild( 0.0f ),
+        m_tracing( 0.0f ),
+        m_postProcessing( 0.0f )
+    {}
+};
+
 class C3D_RENDER_RAYTRACING : public C3D_RENDER_BASE
 {
 public:
@@ -69,6 +101,22 @@ public:
 
     int GetWaitForEditingTimeOut() override;
 
+    /**
+     * @brief RenderToImage - Render the scene on the CPU, without using OpenGL.
+     * It does not need a window nor a graphics context, so it may be used to render
+     * boards on headless machines. The board is loaded if a reload was requested.
+     * The camera is set to the image size, other camera settings are used as they are.
+     * @param aSize: the size of the image in pixels
+     * @param aImage: receives the rendered image
+     * @param aTimes: if not NULL, receives the time spent on each phase. Scene and
+     * BVH construction times refer to the last board reload.
+     * @param aStatusTextReporter: a pointer to the status progress reporter
+     * @return false if the scene could not be rendered
+     */
+    bool RenderToImage( const wxSize &aSize, wxImage &aImage,
+                        RT_RENDER_TIMES *aTimes = NULL,
+                        REPORTER *aStatusTextReporter = NULL );
+
 private:
     bool initializeOpenGL();
     void initializeNewWindowSize();
@@ -81,6 +129,9 @@ private:
     void rt_render_post_process_shade( GLubyte *ptrPBO , REPORTER *aStatusTextReporter );
     void rt_render_post_process_blur_finish( GLubyte *ptrPBO , REPORTER *aStatusTextReporter );
     void rt_render_trace_block( GLubyte *ptrPBO , signed int iBlock );
+    void rt_render_refine_block( GLubyte *ptrPBO, signed int iBlock, uint64_t aRefineMask );
+    void rt_block_background( const SFVEC2I &aBlockPosI, SFVEC3F *aBgColorY ) const;
+    void rt_find_blocks_to_refine();
     void rt_final_color( GLubyte *ptrPBO, const SFVEC3F &rgbColor, bool applyColorSpaceConversion );
 
     void rt_shades_packet( const SFVEC3F *bgColorY,
@@ -93,6 +144,7 @@ private:
                              const HITINFO_PACKET *aHitPck_X0Y0,
                              const HITINFO_PACKET *aHitPck_AA_X1Y1,
                              const RAY *aRayPck,
+                             uint64_t aRefineMask,
                              SFVEC3F *aOutHitColor );
 
     // Materials
@@ -164,8 +216,24 @@ private:
     /// this encodes the Morton code positions
     std::vector< SFVEC2UI > m_blockPositions;
 
-    /// this flags if a position was already processed (cleared each new render)
-    std::vector< int > m_blockPositionsWasProcessed;
+    /// index of the next block to trace in the current pass (blocks are queued in Morton order)
+    size_t m_blockNextToTrace;
+
+    /// true when tracing the anti-aliasing pass, after all the blocks got a first sample
+    bool m_tracingRefinement;
+
+    /// pixels of each block that get anti-aliasing samples, one bit per packet ray
+    std::vector< uint64_t > m_blockRefineMask;
+
+    /// blocks traced in the anti-aliasing pass (the ones with a non zero refine mask)
+    std::vector< size_t > m_blocksToRefine;
+
+    /// accelerator node hit by the first sample of each pixel, reused by the anti-aliasing pass
+    std::vector< unsigned int > m_firstPassHitNodes;
+
+    /// non zero for the blocks whose first samples hit something (one byte per block, so
+    /// the tracing threads write different memory locations)
+    std::vector< unsigned char > m_blockFirstPassHit;
 
     /// this encodes the Morton code positions (on fast preview mode)
     std::vector< SFVEC2UI > m_blockPositionsFast;
@@ -185,6 +253,9 @@ private:
     unsigned int m_stats_converted_dummy_to_plane;
     unsigned int m_stats_converted_roundsegment2d_to_roundsegment;
 
+    /// Scene and accelerator construction times of the last reload
+    RT_RENDER_TIMES m_stats_times;
+
     void create_3d_object_from( CCONTAINER &aDstContainer,
                                 const COBJECT2D *aObject2D,
                                 float aZMin, float aZMax,
@@ -195,12 +266,20 @@ private:
     void insert3DViaHole( const VIA* aVia );
     void insert3DPadHole( const D_PAD* aPad );
     void load_3D_models();
-    void add_3D_models( const S3DMODEL *a3DModel,
+    void add_3D_models( CCONTAINER &aDstContainer,
+                        const S3DMODEL *a3DModel,
                         const glm::mat4 &aModelMatrix );
+    void add_3D_model_instance( const S3DMODEL *a3DModel,
+                                const glm::mat4 &aModelMatrix,
+                                float aModelUnitTo3DUnits );
+    void free_3D_model_geometry();
 
     /// Stores materials of the 3D models
     MAP_MODEL_MATERIALS m_model_materials;
 
+    /// Stores the geometry of the 3D models used by several footprints
+    MAP_MODEL_GEOMETRY m_model_geometry;
+
     void initialize_block_positions();
 
     void render( GLubyte *ptrPBO, REPORTER *aStatusTextReporter );
@@ -0,0 +1,99 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  cinstance.cpp
+ * @brief
+ */
+
+#include "cinstance.h"
+
+
+CINSTANCE::CINSTANCE( const CGENERICACCELERATOR *aAccelerator,
+                      const CBBOX &aObjectsBBox,
+                      const glm::mat4 &aTransformMatrix ) : COBJECT( OBJ3D_INSTANCE )
+{
+    m_accelerator = aAccelerator;
+    m_invTransform = glm::inverse( aTransformMatrix );
+    m_normalMatrix = glm::transpose( glm::inverse( glm::mat3( aTransformMatrix ) ) );
+
+    m_bbox.Reset();
+    m_bbox.Set( aObjectsBBox );
+    m_bbox.ApplyTransformationAA( aTransformMatrix );
+    m_bbox.ScaleNextUp();
+    m_centroid = m_bbox.GetCenter();
+}
+
+
+RAY CINSTANCE::toObjectSpace( const RAY &aRay ) const
+{
+    RAY objRay;
+
+    // The direction is not normalized, so a distance along the ray is the same in both
+    // spaces
+    objRay.Init( SFVEC3F( m_invTransform * glm::vec4( aRay.m_Origin, 1.0f ) ),
+                 SFVEC3F( m_invTransform * glm::vec4( aRay.m_Dir, 0.0f ) ) );
+
+    return objRay;
+}
+
+
+bool CINSTANCE::Intersect( const RAY &aRay, HITINFO &aHitInfo ) const
+{
+    float t;
+
+    if( !m_bbox.Intersect( aRay, &t ) || ( t >= aHitInfo.m_tHit ) )
+        return false;
+
+    if( !m_accelerator->Intersect( toObjectSpace( aRay ), aHitInfo ) )
+        return false;
+
+    aHitInfo.m_HitPoint = aRay.at( aHitInfo.m_tHit );
+    aHitInfo.m_HitNormal = glm::normalize( m_normalMatrix * aHitInfo.m_HitNormal );
+
+    return true;
+}
+
+
+bool CINSTANCE::IntersectP( const RAY &aRay, float aMaxDistance ) const
+{
+    float t;
+
+    if( !m_bbox.Intersect( aRay, &t ) || ( t >= aMaxDistance ) )
+        return false;
+
+    return m_accelerator->IntersectP( toObjectSpace( aRay ), aMaxDistance );
+}
+
+
+bool CINSTANCE::Intersects( const CBBOX &aBBox ) const
+{
+    return m_bbox.Intersects( aBBox );
+}
+
+
+SFVEC3F CINSTANCE::GetDiffuseColor( const HITINFO &aHitInfo ) const
+{
+    // The hit object is the shared object, this is not expected to be called
+    return aHitInfo.pHitObject->GetDiffuseColor( aHitInfo );
+}
@@ -0,0 +1,74 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file  cinstance.h
+ * @brief
+ */
+
+#ifndef _CINSTANCE_H_
+#define _CINSTANCE_H_
+
+#include "cobject.h"
+#include "../accelerators/caccelerator.h"
+
+/**
+ * An instance of objects shared by several parts of the scene (e.g. the triangles
+ * of a 3D model used by many footprints). The objects are stored once, with their
+ * own accelerator, and each instance places them in the scene with a transformation.
+ *
+ * Rays are transformed to the space of the shared objects, the distances along the
+ * rays are the same in both spaces. The hit point and normal are returned in world
+ * space, the hit object is the shared object, so it provides the material and color.
+ */
+class  CINSTANCE : public COBJECT
+{
+
+public:
+    /**
+     * @param aAccelerator the accelerator of the shared objects, it must outlive the
+     * instance.
+     * @param aObjectsBBox the bounding box of the shared objects.
+     * @param aTransformMatrix the transformation from the space of the shared objects
+     * to world space.
+     */
+    CINSTANCE( const CGENERICACCELERATOR *aAccelerator,
+               const CBBOX &aObjectsBBox,
+               const glm::mat4 &aTransformMatrix );
+
+// Imported from COBJECT
+    bool Intersect( const RAY &aRay, HITINFO &aHitInfo ) const override;
+    bool IntersectP(const RAY &aRay , float aMaxDistance ) const override;
+    bool Intersects( const CBBOX &aBBox ) const override;
+    SFVEC3F GetDiffuseColor( const HITINFO &aHitInfo ) const override;
+
+private:
+    RAY toObjectSpace( const RAY &aRay ) const;
+
+    const CGENERICACCELERATOR *m_accelerator;
+    glm::mat4 m_invTransform;
+    glm::mat3 m_normalMatrix;
+};
+
+
+#endif // _CINSTANCE_H_
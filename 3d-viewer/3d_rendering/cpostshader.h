@@ -61,6 +61,12 @@ public:
                        float aDepth,
                        float aShadowAttFactor );
 
+    /// Changes the color of a pixel, keeping its other data (e.g. after anti-aliasing)
+    void SetPixelColor( unsigned int x, unsigned int y, const SFVEC3F &aColor )
+    {
+        m_color[ x + y * m_size.x ] = aColor;
+    }
+
     const SFVEC3F &GetColorAtNotProtected( const SFVEC2I &aPos ) const;
 
     void DebugBuffersOutputAsImages() const;
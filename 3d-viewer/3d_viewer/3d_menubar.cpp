@@ -196,6 +196,11 @@ void EDA_3D_VIEWER::CreateMenuBar()
                 _( "Show Model Bounding Boxes" ),
                 KiBitmap( ortho_xpm ), wxITEM_CHECK );
 
+    AddMenuItem( renderOptionsMenu_OPENGL, ID_MENU3D_FL_OPENGL_RENDER_MODEL_LOD,
+                _( "Simplify Distant Models" ),
+                _( "Draw simplified versions of the heavy 3D models when they are small on screen" ),
+                KiBitmap( tools_xpm ), wxITEM_CHECK );
+
 
     // Add specific preferences for Raytracing
     // /////////////////////////////////////////////////////////////////////////
@@ -237,6 +242,27 @@ void EDA_3D_VIEWER::CreateMenuBar()
                  _( "Apply Screen Space Ambient Occlusion and Global Illumination reflections on final render (slow)"),
                  KiBitmap( green_xpm ), wxITEM_CHECK );
 
+    wxMenu * modelQualityList = new wxMenu;
+    AddMenuItem( renderOptionsMenu_RAYTRACING, modelQualityList,
+                 ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY,
+                 _( "3D Model Quality" ), KiBitmap( tools_xpm ) );
+
+    modelQualityList->AppendRadioItem( ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_FULL,
+                                       _( "Full" ),
+                                       _( "Render the 3D models as loaded" ) );
+
+    modelQualityList->AppendRadioItem( ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_HIGH,
+                                       _( "High" ),
+                                       _( "Render simplified versions of the heavy 3D models" ) );
+
+    modelQualityList->AppendRadioItem( ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_MEDIUM,
+                                       _( "Medium" ),
+                                       _( "Render simplified versions of the heavy 3D models" ) );
+
+    modelQualityList->AppendRadioItem( ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_LOW,
+                                       _( "Low" ),
+                                       _( "Render coarse versions of the heavy 3D models (fast)" ) );
+
     prefsMenu->AppendSeparator();
 
 
@@ -384,6 +410,9 @@ void EDA_3D_VIEWER::SetMenuBarOptionsState()
     item = menuBar->FindItem( ID_MENU3D_FL_OPENGL_RENDER_SHOW_MODEL_BBOX );
     item->Check( m_settings.GetFlag( FL_RENDER_OPENGL_SHOW_MODEL_BBOX ) );
 
+    item = menuBar->FindItem( ID_MENU3D_FL_OPENGL_RENDER_MODEL_LOD );
+    item->Check( m_settings.GetFlag( FL_RENDER_OPENGL_MODEL_LOD ) );
+
     // Raytracing
     item = menuBar->FindItem( ID_MENU3D_FL_RAYTRACING_RENDER_SHADOWS );
     item->Check( m_settings.GetFlag( FL_RENDER_RAYTRACING_SHADOWS ) );
@@ -406,6 +435,18 @@ void EDA_3D_VIEWER::SetMenuBarOptionsState()
     item = menuBar->FindItem( ID_MENU3D_FL_RAYTRACING_PROCEDURAL_TEXTURES );
     item->Check( m_settings.GetFlag( FL_RENDER_RAYTRACING_PROCEDURAL_TEXTURES ) );
 
+    item = menuBar->FindItem( ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_FULL );
+    item->Check( m_settings.ModelQualityGet() == MODEL_QUALITY_FULL );
+
+    item = menuBar->FindItem( ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_HIGH );
+    item->Check( m_settings.ModelQualityGet() == MODEL_QUALITY_HIGH );
+
+    item = menuBar->FindItem( ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_MEDIUM );
+    item->Check( m_settings.ModelQualityGet() == MODEL_QUALITY_MEDIUM );
+
+    item = menuBar->FindItem( ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_LOW );
+    item->Check( m_settings.ModelQualityGet() == MODEL_QUALITY_LOW );
+
 
     item = menuBar->FindItem( ID_MENU3D_AXIS_ONOFF );
     item->Check( m_settings.GetFlag( FL_AXIS ) );
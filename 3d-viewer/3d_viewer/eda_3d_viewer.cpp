@@ -88,6 +88,7 @@ static const wxChar keyRenderMaterial[]         = wxT( "Render_Material" );
 
 static const wxChar keyRenderOGL_ShowCopperTck[]= wxT( "Render_OGL_ShowCopperThickness" );
 static const wxChar keyRenderOGL_ShowModelBBox[]= wxT( "Render_OGL_ShowModelBoudingBoxes" );
+static const wxChar keyRenderOGL_ModelLOD[]     = wxT( "Render_OGL_ModelLOD" );
 
 static const wxChar keyRenderRAY_Shadows[]      = wxT( "Render_RAY_Shadows" );
 static const wxChar keyRenderRAY_Backfloor[]    = wxT( "Render_RAY_Backfloor" );
@@ -96,6 +97,7 @@ static const wxChar keyRenderRAY_Reflections[]  = wxT( "Render_RAY_Reflections"
 static const wxChar keyRenderRAY_PostProcess[]  = wxT( "Render_RAY_PostProcess" );
 static const wxChar keyRenderRAY_AAliasing[]    = wxT( "Render_RAY_AntiAliasing" );
 static const wxChar keyRenderRAY_ProceduralT[]  = wxT( "Render_RAY_ProceduralTextures" );
+static const wxChar keyRenderRAY_ModelQuality[] = wxT( "Render_RAY_ModelQuality" );
 
 static const wxChar keyShowAxis[]               = wxT( "ShowAxis" );
 static const wxChar keyShowGrid[]               = wxT( "ShowGrid3D" );
@@ -410,6 +412,11 @@ void EDA_3D_VIEWER::Process_Special_Functions( wxCommandEvent &event )
         m_canvas->Request_refresh();
         return;
 
+    case ID_MENU3D_FL_OPENGL_RENDER_MODEL_LOD:
+        m_settings.SetFlag( FL_RENDER_OPENGL_MODEL_LOD, isChecked );
+        NewDisplay( true );
+        return;
+
     case ID_MENU3D_FL_RAYTRACING_RENDER_SHADOWS:
         m_settings.SetFlag( FL_RENDER_RAYTRACING_SHADOWS, isChecked );
         m_canvas->Request_refresh();
@@ -445,6 +452,26 @@ void EDA_3D_VIEWER::Process_Special_Functions( wxCommandEvent &event )
         m_canvas->Request_refresh();
         return;
 
+    case ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_FULL:
+        m_settings.ModelQualitySet( MODEL_QUALITY_FULL );
+        NewDisplay( true );
+        return;
+
+    case ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_HIGH:
+        m_settings.ModelQualitySet( MODEL_QUALITY_HIGH );
+        NewDisplay( true );
+        return;
+
+    case ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_MEDIUM:
+        m_settings.ModelQualitySet( MODEL_QUALITY_MEDIUM );
+        NewDisplay( true );
+        return;
+
+    case ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_LOW:
+        m_settings.ModelQualitySet( MODEL_QUALITY_LOW );
+        NewDisplay( true );
+        return;
+
     case ID_MENU3D_SHOW_BOARD_BODY:
         m_settings.SetFlag( FL_SHOW_BOARD_BODY, isChecked );
         NewDisplay( true );
@@ -735,6 +762,9 @@ void EDA_3D_VIEWER::LoadSettings( wxConfigBase *aCfg )
     aCfg->Read( keyRenderOGL_ShowModelBBox, &tmp, false );
     m_settings.SetFlag( FL_RENDER_OPENGL_SHOW_MODEL_BBOX, tmp );
 
+    aCfg->Read( keyRenderOGL_ModelLOD, &tmp, true );
+    m_settings.SetFlag( FL_RENDER_OPENGL_MODEL_LOD, tmp );
+
     // Raytracing options
     aCfg->Read( keyRenderRAY_Shadows, &tmp, true );
     m_settings.SetFlag( FL_RENDER_RAYTRACING_SHADOWS, tmp );
@@ -802,6 +832,9 @@ void EDA_3D_VIEWER::LoadSettings( wxConfigBase *aCfg )
 
     aCfg->Read( keyRenderMaterial, &tmpi, (int)MATERIAL_MODE_NORMAL );
     m_settings.MaterialModeSet( (MATERIAL_MODE)tmpi );
+
+    aCfg->Read( keyRenderRAY_ModelQuality, &tmpi, (int)MODEL_QUALITY_FULL );
+    m_settings.ModelQualitySet( (MODEL_QUALITY)tmpi );
 }
 
 
@@ -848,6 +881,7 @@ void EDA_3D_VIEWER::SaveSettings( wxConfigBase *aCfg )
     // OpenGL options
     aCfg->Write( keyRenderOGL_ShowCopperTck,m_settings.GetFlag( FL_RENDER_OPENGL_COPPER_THICKNESS ) );
     aCfg->Write( keyRenderOGL_ShowModelBBox,m_settings.GetFlag( FL_RENDER_OPENGL_SHOW_MODEL_BBOX ) );
+    aCfg->Write( keyRenderOGL_ModelLOD,     m_settings.GetFlag( FL_RENDER_OPENGL_MODEL_LOD ) );
 
     // Raytracing options
     aCfg->Write( keyRenderRAY_Shadows,      m_settings.GetFlag( FL_RENDER_RAYTRACING_SHADOWS ) );
@@ -857,6 +891,7 @@ void EDA_3D_VIEWER::SaveSettings( wxConfigBase *aCfg )
     aCfg->Write( keyRenderRAY_PostProcess,  m_settings.GetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING ) );
     aCfg->Write( keyRenderRAY_AAliasing,    m_settings.GetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING ) );
     aCfg->Write( keyRenderRAY_ProceduralT,  m_settings.GetFlag( FL_RENDER_RAYTRACING_PROCEDURAL_TEXTURES ) );
+    aCfg->Write( keyRenderRAY_ModelQuality, (int)m_settings.ModelQualityGet() );
 
     aCfg->Write( keyShowAxis,               m_settings.GetFlag( FL_AXIS ) );
     aCfg->Write( keyShowGrid,               (int)m_settings.GridGet() );
@@ -68,6 +68,7 @@ enum id_3dview_frm
     ID_MENU3D_FL_OPENGL,
     ID_MENU3D_FL_OPENGL_RENDER_COPPER_THICKNESS,
     ID_MENU3D_FL_OPENGL_RENDER_SHOW_MODEL_BBOX,
+    ID_MENU3D_FL_OPENGL_RENDER_MODEL_LOD,
 
     ID_MENU3D_FL_RAYTRACING,
     ID_MENU3D_FL_RAYTRACING_RENDER_SHADOWS,
@@ -77,6 +78,11 @@ enum id_3dview_frm
     ID_MENU3D_FL_RAYTRACING_POST_PROCESSING,
     ID_MENU3D_FL_RAYTRACING_ANTI_ALIASING,
     ID_MENU3D_FL_RAYTRACING_PROCEDURAL_TEXTURES,
+    ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY,
+    ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_FULL,
+    ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_HIGH,
+    ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_MEDIUM,
+    ID_MENU3D_FL_RAYTRACING_MODEL_QUALITY_LOW,
 
     ID_RENDER_CURRENT_VIEW,
 
@@ -41,6 +41,8 @@
 #include <wx/stdpaths.h>
 #include <wx/url.h>
 
+#include <atomic>
+
 #include <pgm_base.h>
 
 using KIGFX::COLOR4D;
@@ -158,15 +160,19 @@ int ProcessExecute( const wxString& aCommandLine, int aFlags, wxProcess *callbac
 
 timestamp_t GetNewTimeStamp()
 {
-    static timestamp_t oldTimeStamp;
+    // Items are also created by the plot worker threads: keep the time stamps
+    // unique without a lock
+    static std::atomic<timestamp_t> oldTimeStamp( 0 );
+    timestamp_t previous = oldTimeStamp.load();
     timestamp_t newTimeStamp;
 
-    newTimeStamp = time( NULL );
-
-    if( newTimeStamp <= oldTimeStamp )
-        newTimeStamp = oldTimeStamp + 1;
+    do
+    {
+        newTimeStamp = time( NULL );
 
-    oldTimeStamp = newTimeStamp;
+        if( newTimeStamp <= previous )
+            newTimeStamp = previous + 1;
+    } while( !oldTimeStamp.compare_exchange_weak( previous, newTimeStamp ) );
 
     return newTimeStamp;
 }
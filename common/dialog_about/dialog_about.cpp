@@ -581,6 +581,13 @@ void DIALOG_ABOUT::buildVersionInfoData( wxString& aMsg, bool aFormatHtml )
 #else
     aMsg << OFF;
 #endif
+
+    aMsg << indent4 << "KICAD_ARENA_STATS=";
+#ifdef KICAD_ARENA_STATS
+    aMsg << ON;
+#else
+    aMsg << OFF;
+#endif
 }
 
 
@@ -202,6 +202,22 @@ void GAL::ComputeWorldScreenMatrix()
 }
 
 
+void GAL::CopyViewSettings( const GAL& aOther )
+{
+    screenSize          = aOther.screenSize;
+    worldUnitLength     = aOther.worldUnitLength;
+    screenDPI           = aOther.screenDPI;
+    lookAtPoint         = aOther.lookAtPoint;
+    zoomFactor          = aOther.zoomFactor;
+    worldScreenMatrix   = aOther.worldScreenMatrix;
+    screenWorldMatrix   = aOther.screenWorldMatrix;
+    worldScale          = aOther.worldScale;
+    globalFlipX         = aOther.globalFlipX;
+    globalFlipY         = aOther.globalFlipY;
+    depthRange          = aOther.depthRange;
+}
+
+
 double GAL::computeMinGridSpacing() const
 {
     // just return the current value. This could be cleverer and take
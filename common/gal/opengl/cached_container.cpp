@@ -30,25 +30,28 @@
  */
 
 #include <gal/opengl/cached_container.h>
+#include <gal/graphics_abstraction_layer.h>
 #include <gal/opengl/vertex_manager.h>
 #include <gal/opengl/vertex_item.h>
 #include <gal/opengl/utils.h>
 
-#include <list>
 #include <cassert>
+#include <cstring>
+#include <iterator>
 
 #ifdef __WXDEBUG__
 #include <wx/log.h>
-#include <profile.h>
 #endif /* __WXDEBUG__ */
 
 using namespace KIGFX;
 
 CACHED_CONTAINER::CACHED_CONTAINER( unsigned int aSize ) :
-    VERTEX_CONTAINER( aSize ), m_item( NULL ), m_chunkSize( 0 ), m_chunkOffset( 0 ), m_maxIndex( 0 )
+    VERTEX_CONTAINER( aSize ), m_item( NULL ), m_chunkSize( 0 ), m_chunkOffset( 0 ), m_maxIndex( 0 ),
+    m_uploadedBytes( 0 ), m_uploadedLastFrame( 0 )
 {
     // In the beginning there is only free space
     m_freeChunks.insert( std::make_pair( aSize, 0 ) );
+    m_freeChunkOffsets.insert( std::make_pair( 0, aSize ) );
 }
 
 
@@ -63,6 +66,10 @@ void CACHED_CONTAINER::SetItem( VERTEX_ITEM* aItem )
     // Get the previously set offset if the item was stored previously
     m_chunkOffset = itemSize > 0 ? aItem->GetOffset() : -1;
 
+    // The item may be moved while it is edited, so it is indexed again in FinishItem()
+    if( itemSize > 0 )
+        m_items.erase( m_chunkOffset );
+
 #if CACHED_CONTAINER_TEST > 1
     wxLogDebug( wxT( "Adding/editing item 0x%08lx (size %d)" ), (long) m_item, itemSize );
 #endif
@@ -83,13 +90,13 @@ void CACHED_CONTAINER::FinishItem()
 
         // Add the not used memory back to the pool
         addFreeChunk( itemOffset + itemSize, m_chunkSize - itemSize );
-        // mergeFreeChunks();   // veery slow and buggy
-
-        m_maxIndex = std::max( itemOffset + itemSize, m_maxIndex );
     }
 
     if( itemSize > 0 )
-        m_items.insert( m_item );
+    {
+        m_items[m_item->GetOffset()] = m_item;
+        m_maxIndex = std::max( m_item->GetOffset() + itemSize, m_maxIndex );
+    }
 
     m_item = NULL;
     m_chunkSize = 0;
@@ -129,7 +136,7 @@ VERTEX* CACHED_CONTAINER::Allocate( unsigned int aSize )
     m_item->setSize( newSize );
 
     // The content has to be updated
-    m_dirty = true;
+    SetDirty( m_chunkOffset + itemSize, aSize );
 
 #if CACHED_CONTAINER_TEST > 0
     test();
@@ -146,7 +153,7 @@ VERTEX* CACHED_CONTAINER::Allocate( unsigned int aSize )
 void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
 {
     assert( aItem != NULL );
-    assert( m_items.find( aItem ) != m_items.end() || aItem->GetSize() == 0 );
+    assert( m_items.count( aItem->GetOffset() ) || aItem->GetSize() == 0 );
 
     int size = aItem->GetSize();
 
@@ -165,26 +172,14 @@ void CACHED_CONTAINER::Delete( VERTEX_ITEM* aItem )
     // Indicate that the item is not stored in the container anymore
     aItem->setSize( 0 );
 
-    m_items.erase( aItem );
+    m_items.erase( offset );
+
+    if( (unsigned int) ( offset + size ) == m_maxIndex )
+        updateMaxIndex();
 
 #if CACHED_CONTAINER_TEST > 0
     test();
 #endif
-
-    // This dynamic memory freeing optimize memory usage, but in fact can create
-    // out of memory issues because freeing and reallocation large chuncks of memory
-    // can create memory fragmentation and no room to reallocate large chuncks
-    // after many free/reallocate cycles during a session using the same complex board
-    // So it can be disable.
-    // Currently: it is disable to avoid "out of memory" issues
-#if 0
-    // Dynamic memory freeing, there is no point in holding
-    // a large amount of memory when there is no use for it
-    if( m_freeSpace > ( 0.75 * m_currentSize ) && m_currentSize > m_initialSize )
-    {
-        defragmentResize( 0.5 * m_currentSize );
-    }
-#endif
 }
 
 
@@ -196,14 +191,86 @@ void CACHED_CONTAINER::Clear()
 
     // Set the size of all the stored VERTEX_ITEMs to 0, so it is clear that they are not held
     // in the container anymore
-    for( ITEMS::iterator it = m_items.begin(); it != m_items.end(); ++it )
-        ( *it )->setSize( 0 );
+    for( const auto& item : m_items )
+        item.second->setSize( 0 );
 
     m_items.clear();
 
     // Now there is only free space left
     m_freeChunks.clear();
+    m_freeChunkOffsets.clear();
     m_freeChunks.insert( std::make_pair( m_freeSpace, 0 ) );
+    m_freeChunkOffsets.insert( std::make_pair( 0, m_freeSpace ) );
+}
+
+
+void CACHED_CONTAINER::Compact( unsigned int aMaxVertices )
+{
+    assert( m_item == NULL );
+    assert( IsMapped() );
+
+    // Number of free chunks to look at when searching for a place for an item
+    const int MAX_SEARCH = 32;
+    unsigned int moved = 0;
+
+    while( moved < aMaxVertices && !m_items.empty() && m_freeChunkOffsets.size() > 1 )
+    {
+        // Move the last item to the first free chunk that fits it
+        VERTEX_ITEM* item = m_items.rbegin()->second;
+        unsigned int itemOffset = item->GetOffset();
+        unsigned int itemSize = item->GetSize();
+
+        FREE_CHUNK_OFFSETS::iterator chunk = m_freeChunkOffsets.begin();
+        int searched = 0;
+
+        while( chunk != m_freeChunkOffsets.end() && chunk->first < itemOffset
+                && chunk->second < itemSize && searched++ < MAX_SEARCH )
+            ++chunk;
+
+        if( chunk == m_freeChunkOffsets.end() || chunk->first > itemOffset
+                || chunk->second < itemSize )
+            break;
+
+        unsigned int chunkOffset = chunk->first;
+        unsigned int chunkSize = chunk->second;
+
+        memcpy( &m_vertices[chunkOffset], &m_vertices[itemOffset], itemSize * VERTEX_SIZE );
+
+        removeFreeChunk( chunkOffset, chunkSize );
+        m_freeSpace -= chunkSize;
+
+        if( chunkSize > itemSize )
+            addFreeChunk( chunkOffset + itemSize, chunkSize - itemSize );
+
+        m_items.erase( itemOffset );
+        item->setOffset( chunkOffset );
+        m_items[chunkOffset] = item;
+
+        addFreeChunk( itemOffset, itemSize );
+        SetDirty( chunkOffset, itemSize );
+
+        moved += itemSize;
+    }
+
+    if( moved > 0 )
+    {
+        updateMaxIndex();
+
+        wxLogTrace( "GAL_CACHED_CONTAINER",
+                    wxT( "Compacted %u vertices, %u free chunks left" ),
+                    moved, (unsigned int) m_freeChunkOffsets.size() );
+    }
+}
+
+
+void CACHED_CONTAINER::GetStatistics( GAL_CACHE_STATISTICS& aStats ) const
+{
+    aStats.capacity = (size_t) m_currentSize * VERTEX_SIZE;
+    aStats.used = (size_t) usedSpace() * VERTEX_SIZE;
+    aStats.freeChunks = m_freeChunks.size();
+    aStats.largestFreeChunk = m_freeChunks.empty() ? 0
+                              : (size_t) m_freeChunks.rbegin()->first * VERTEX_SIZE;
+    aStats.uploadedLastFrame = m_uploadedLastFrame;
 }
 
 
@@ -218,6 +285,23 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
     wxLogDebug( wxT( "Resize %p from %d to %d" ), m_item, itemSize, aSize );
 #endif
 
+    // Grow the chunk in place if it is followed by enough free space
+    if( m_chunkSize > 0 )
+    {
+        FREE_CHUNK_OFFSETS::iterator next = m_freeChunkOffsets.find( m_chunkOffset + m_chunkSize );
+
+        if( next != m_freeChunkOffsets.end() && m_chunkSize + next->second >= aSize )
+        {
+            unsigned int nextSize = next->second;
+
+            removeFreeChunk( next->first, nextSize );
+            m_freeSpace -= nextSize;
+            m_chunkSize += nextSize;
+
+            return true;
+        }
+    }
+
     // Find a free space chunk >= aSize
     FREE_CHUNK_MAP::iterator newChunk = m_freeChunks.lower_bound( aSize );
 
@@ -226,8 +310,15 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
     {
         bool result;
 
+        // Is the container mostly empty? Free chunks are merged, so it is rare that none of
+        // them fits, but it might happen after many edits.
+        if( usedSpace() + aSize <= m_currentSize / 2 )
+        {
+            // Yes: defragment without growing
+            result = defragmentResize( m_currentSize );
+        }
         // Would it be enough to double the current space?
-        if( aSize < m_freeSpace + m_currentSize )
+        else if( aSize < m_freeSpace + m_currentSize )
         {
             // Yes: exponential growing
             result = defragmentResize( m_currentSize * 2 );
@@ -252,6 +343,10 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
     assert( newChunkSize >= aSize );
     assert( newChunkOffset < m_currentSize );
 
+    // Remove the new allocated chunk from the free space pool
+    removeFreeChunk( newChunkOffset, newChunkSize );
+    m_freeSpace -= newChunkSize;
+
     // Check if the item was previously stored in the container
     if( itemSize > 0 )
     {
@@ -261,15 +356,12 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
 #endif
         // The item was reallocated, so we have to copy all the old data to the new place
         memcpy( &m_vertices[newChunkOffset], &m_vertices[m_chunkOffset], itemSize * VERTEX_SIZE );
+        SetDirty( newChunkOffset, itemSize );
 
         // Free the space used by the previous chunk
         addFreeChunk( m_chunkOffset, m_chunkSize );
     }
 
-    // Remove the new allocated chunk from the free space pool
-    m_freeChunks.erase( newChunk );
-    m_freeSpace -= newChunkSize;
-
     m_chunkSize = newChunkSize;
     m_chunkOffset = newChunkOffset;
 
@@ -282,11 +374,11 @@ bool CACHED_CONTAINER::reallocate( unsigned int aSize )
 void CACHED_CONTAINER::defragment( VERTEX* aTarget )
 {
     // Defragmentation
-    ITEMS::iterator it, it_end;
     int newOffset = 0;
 
-    for( VERTEX_ITEM* item : m_items )
+    for( const auto& stored : m_items )
     {
+        VERTEX_ITEM* item = stored.second;
         int itemOffset    = item->GetOffset();
         int itemSize      = item->GetSize();
 
@@ -308,77 +400,112 @@ void CACHED_CONTAINER::defragment( VERTEX* aTarget )
         m_item->setOffset( newOffset );
         m_chunkOffset = newOffset;
     }
-
-    m_maxIndex = usedSpace();
 }
 
 
-void CACHED_CONTAINER::mergeFreeChunks()
+void CACHED_CONTAINER::finishDefragmentation( unsigned int aNewSize )
 {
-    if( m_freeChunks.size() <= 1 ) // There are no chunks that can be merged
-        return;
+    // Items have new offsets, but they are stored in the same order
+    ITEMS items;
 
-#ifdef __WXDEBUG__
-    PROF_COUNTER totalTime;
-#endif /* __WXDEBUG__ */
+    for( const auto& stored : m_items )
+        items.emplace_hint( items.end(), stored.second->GetOffset(), stored.second );
 
-    // Reversed free chunks map - this one stores chunk size with its offset as the key
-    std::list<CHUNK> freeChunks;
+    m_items.swap( items );
 
-    FREE_CHUNK_MAP::const_iterator it, it_end;
+    m_freeSpace = aNewSize - usedSpace();
+    m_currentSize = aNewSize;
+    m_maxIndex = usedSpace();
 
-    for( it = m_freeChunks.begin(), it_end = m_freeChunks.end(); it != it_end; ++it )
+    // Now there is only one big chunk of free memory
+    m_freeChunks.clear();
+    m_freeChunkOffsets.clear();
+
+    if( m_freeSpace > 0 )
     {
-        freeChunks.push_back( std::make_pair( it->second, it->first ) );
+        m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+        m_freeChunkOffsets.insert( std::make_pair( m_currentSize - m_freeSpace, m_freeSpace ) );
     }
 
-    m_freeChunks.clear();
-    freeChunks.sort();
+    // All the stored data has been moved
+    SetDirty();
+}
+
+
+void CACHED_CONTAINER::addFreeChunk( unsigned int aOffset, unsigned int aSize )
+{
+    assert( aOffset + aSize <= m_currentSize );
+    assert( aSize > 0 );
 
-    std::list<CHUNK>::const_iterator itf, itf_end;
-    unsigned int offset = freeChunks.front().first;
-    unsigned int size   = freeChunks.front().second;
-    freeChunks.pop_front();
+    m_freeSpace += aSize;
+
+    // Merge with the following chunk
+    FREE_CHUNK_OFFSETS::iterator next = m_freeChunkOffsets.lower_bound( aOffset );
 
-    for( itf = freeChunks.begin(), itf_end = freeChunks.end(); itf != itf_end; ++itf )
+    if( next != m_freeChunkOffsets.end() && next->first == aOffset + aSize )
     {
-        if( itf->first == offset + size )
+        unsigned int nextSize = next->second;
+        removeFreeChunk( next->first, nextSize );
+        aSize += nextSize;
+        next = m_freeChunkOffsets.lower_bound( aOffset );
+    }
+
+    // Merge with the preceding chunk
+    if( next != m_freeChunkOffsets.begin() )
+    {
+        FREE_CHUNK_OFFSETS::iterator prev = std::prev( next );
+
+        if( prev->first + prev->second == aOffset )
         {
-            // These chunks can be merged, so just increase the current chunk size and go on
-            size += itf->second;
+            unsigned int prevOffset = prev->first;
+            unsigned int prevSize = prev->second;
+            removeFreeChunk( prevOffset, prevSize );
+            aOffset = prevOffset;
+            aSize += prevSize;
         }
-        else
-        {
-            // These chunks cannot be merged
-            // So store the previous one
-            m_freeChunks.insert( std::make_pair( size, offset ) );
-            // and let's check the next chunk
-            offset = itf->first;
-            size   = itf->second;
+    }
 
+    m_freeChunks.insert( std::make_pair( aSize, aOffset ) );
+    m_freeChunkOffsets.insert( std::make_pair( aOffset, aSize ) );
+}
+
+
+void CACHED_CONTAINER::removeFreeChunk( unsigned int aOffset, unsigned int aSize )
+{
+    auto range = m_freeChunks.equal_range( aSize );
+
+    for( auto it = range.first; it != range.second; ++it )
+    {
+        if( it->second == aOffset )
+        {
+            m_freeChunks.erase( it );
+            break;
         }
     }
 
-    // Add the last one
-    m_freeChunks.insert( std::make_pair( size, offset ) );
+    m_freeChunkOffsets.erase( aOffset );
+}
 
-#ifdef __WXDEBUG__
-    totalTime.Stop();
-    wxLogDebug( "Merged free chunks / %.1f ms", totalTime.msecs() );
-#endif /* __WXDEBUG__ */
-#if CACHED_CONTAINER_TEST > 0
-    test();
-#endif
+
+void CACHED_CONTAINER::updateMaxIndex()
+{
+    if( m_items.empty() )
+        m_maxIndex = 0;
+    else
+        m_maxIndex = m_items.rbegin()->first + m_items.rbegin()->second->GetSize();
 }
 
 
-void CACHED_CONTAINER::addFreeChunk( unsigned int aOffset, unsigned int aSize )
+unsigned int CACHED_CONTAINER::takeDirtyRange( unsigned int& aOffset )
 {
-    assert( aOffset + aSize <= m_currentSize );
-    assert( aSize > 0 );
+    unsigned int end = std::min( m_dirtyEnd, m_maxIndex );
+    unsigned int size = m_dirtyBegin < end ? end - m_dirtyBegin : 0;
 
-    m_freeChunks.insert( std::make_pair( aSize, aOffset ) );
-    m_freeSpace += aSize;
+    aOffset = m_dirtyBegin;
+    m_dirtyBegin = 0;
+    m_dirtyEnd = 0;
+
+    return size;
 }
 
 
@@ -405,13 +532,11 @@ void CACHED_CONTAINER::showFreeChunks()
 void CACHED_CONTAINER::showUsedChunks()
 {
 #ifdef __WXDEBUG__
-    ITEMS::iterator it;
-
     wxLogDebug( wxT( "Used chunks:" ) );
 
-    for( it = m_items.begin(); it != m_items.end(); ++it )
+    for( const auto& stored : m_items )
     {
-        VERTEX_ITEM* item   = *it;
+        VERTEX_ITEM* item   = stored.second;
         unsigned int offset = item->GetOffset();
         unsigned int size   = item->GetSize();
         assert( size > 0 );
@@ -435,11 +560,13 @@ void CACHED_CONTAINER::test()
 
     assert( freeSpace == m_freeSpace );
 
+    assert( m_freeChunks.size() == m_freeChunkOffsets.size() );
+
     // Used space check
     unsigned int used_space = 0;
-    ITEMS::iterator itr;
-    for( itr = m_items.begin(); itr != m_items.end(); ++itr )
-        used_space += ( *itr )->GetSize();
+
+    for( const auto& stored : m_items )
+        used_space += stored.second->GetSize();
 
     // If we have a chunk assigned, then there must be an item edited
     assert( m_chunkSize == 0 || m_item );
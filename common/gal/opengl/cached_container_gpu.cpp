@@ -85,6 +85,10 @@ void CACHED_CONTAINER_GPU::Unmap()
 {
     wxCHECK( IsMapped(), /*void*/ );
 
+    // Data modified in the mapped buffer is transferred by the driver
+    unsigned int dirtyOffset;
+    m_uploadedBytes += (size_t) takeDirtyRange( dirtyOffset ) * VERTEX_SIZE;
+
     glUnmapBuffer( GL_ARRAY_BUFFER );
     checkGlError( "unmapping vertices buffer" );
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
@@ -132,13 +136,12 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
     glBufferData( GL_ELEMENT_ARRAY_BUFFER, aNewSize * VERTEX_SIZE, NULL, GL_DYNAMIC_DRAW );
     checkGlError( "creating buffer during defragmentation" );
 
-    ITEMS::iterator it, it_end;
     int newOffset = 0;
 
     // Defragmentation
-    for( it = m_items.begin(), it_end = m_items.end(); it != it_end; ++it )
+    for( const auto& stored : m_items )
     {
-        VERTEX_ITEM* item = *it;
+        VERTEX_ITEM* item = stored.second;
         int itemOffset    = item->GetOffset();
         int itemSize      = item->GetSize();
 
@@ -186,12 +189,7 @@ bool CACHED_CONTAINER_GPU::defragmentResize( unsigned int aNewSize )
                 m_currentSize - m_freeSpace, totalTime.msecs() );
 #endif /* __WXDEBUG__ */
 
-    m_freeSpace += ( aNewSize - m_currentSize );
-    m_currentSize = aNewSize;
-
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    finishDefragmentation( aNewSize );
 
     return true;
 }
@@ -252,12 +250,7 @@ bool CACHED_CONTAINER_GPU::defragmentResizeMemcpy( unsigned int aNewSize )
                 m_currentSize - m_freeSpace, totalTime.msecs() );
 #endif /* __WXDEBUG__ */
 
-    m_freeSpace += ( aNewSize - m_currentSize );
-    m_currentSize = aNewSize;
-
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
+    finishDefragmentation( aNewSize );
 
     return true;
 }
@@ -40,7 +40,7 @@
 using namespace KIGFX;
 
 CACHED_CONTAINER_RAM::CACHED_CONTAINER_RAM( unsigned int aSize ) :
-    CACHED_CONTAINER( aSize ), m_verticesBuffer( 0 )
+    CACHED_CONTAINER( aSize ), m_verticesBuffer( 0 ), m_bufferSize( 0 )
 {
     glGenBuffers( 1, &m_verticesBuffer );
     checkGlError( "generating vertices buffer" );
@@ -58,16 +58,34 @@ CACHED_CONTAINER_RAM::~CACHED_CONTAINER_RAM()
 
 void CACHED_CONTAINER_RAM::Unmap()
 {
-    if( !m_dirty )
+    unsigned int offset;
+    unsigned int size = takeDirtyRange( offset );
+
+    if( size == 0 )
         return;
 
     // Upload vertices coordinates and shader types to GPU memory
     glBindBuffer( GL_ARRAY_BUFFER, m_verticesBuffer );
     checkGlError( "binding vertices buffer" );
-    glBufferData( GL_ARRAY_BUFFER, m_maxIndex * VERTEX_SIZE, m_vertices, GL_STREAM_DRAW );
+
+    if( m_bufferSize < m_maxIndex )
+    {
+        // The buffer is too small, reserve space for the whole container and upload everything
+        m_bufferSize = m_currentSize;
+        offset = 0;
+        size = m_maxIndex;
+        glBufferData( GL_ARRAY_BUFFER, m_bufferSize * VERTEX_SIZE, NULL, GL_DYNAMIC_DRAW );
+        checkGlError( "allocating vertices buffer" );
+    }
+
+    // Only the modified range is transferred
+    glBufferSubData( GL_ARRAY_BUFFER, offset * VERTEX_SIZE, size * VERTEX_SIZE,
+                     &m_vertices[offset] );
     checkGlError( "transferring vertices" );
     glBindBuffer( GL_ARRAY_BUFFER, 0 );
     checkGlError( "unbinding vertices buffer" );
+
+    m_uploadedBytes += (size_t) size * VERTEX_SIZE;
 }
 
 
@@ -104,13 +122,7 @@ bool CACHED_CONTAINER_RAM::defragmentResize( unsigned int aNewSize )
                 m_currentSize - m_freeSpace, totalTime.msecs() );
 #endif /* __WXDEBUG__ */
 
-    m_freeSpace += ( aNewSize - m_currentSize );
-    m_currentSize = aNewSize;
-
-    // Now there is only one big chunk of free memory
-    m_freeChunks.clear();
-    m_freeChunks.insert( std::make_pair( m_freeSpace, m_currentSize - m_freeSpace ) );
-    m_dirty = true;
+    finishDefragmentation( aNewSize );
 
     return true;
 }
@@ -148,6 +148,8 @@ void GPU_CACHED_MANAGER::EndDrawing()
     if( cached->IsMapped() )
         cached->Unmap();
 
+    cached->FinishFrame();
+
     if( m_indicesSize == 0 )
     {
         m_isDrawing = false;
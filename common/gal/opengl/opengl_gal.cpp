@@ -30,8 +30,6 @@
 #include <gal/opengl/utils.h>
 #include <gal/definitions.h>
 #include <gl_context_mgr.h>
-#include <geometry/shape_poly_set.h>
-#include <text_utils.h>
 #include <bitmap_base.h>
 
 #include <macros.h>
@@ -55,7 +53,6 @@ using namespace KIGFX;
 #include "gl_builtin_shaders.h"
 using namespace KIGFX::BUILTIN_FONT;
 
-static void InitTesselatorCallbacks( GLUtesselator* aTesselator );
 static const int glAttributes[] = { WX_GL_RGBA, WX_GL_DOUBLEBUFFER, WX_GL_DEPTH_SIZE, 8, 0 };
 
 wxGLContext* OPENGL_GAL::glMainContext = NULL;
@@ -165,10 +162,10 @@ GLuint GL_BITMAP_CACHE::cacheBitmap( const BITMAP_BASE* aBitmap )
 OPENGL_GAL::OPENGL_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions, wxWindow* aParent,
                         wxEvtHandler* aMouseListener, wxEvtHandler* aPaintListener,
                         const wxString& aName ) :
-    GAL( aDisplayOptions ),
+    OPENGL_GEOMETRY_GAL( aDisplayOptions ),
     HIDPI_GL_CANVAS( aParent, wxID_ANY, (int*) glAttributes, wxDefaultPosition, wxDefaultSize,
                 wxEXPAND, aName ),
-    mouseListener( aMouseListener ), paintListener( aPaintListener ), currentManager( nullptr ),
+    mouseListener( aMouseListener ), paintListener( aPaintListener ),
     cachedManager( nullptr ), nonCachedManager( nullptr ), overlayManager( nullptr ), mainBuffer( 0 ), overlayBuffer( 0 )
 {
 // IsDisplayAttr() handles WX_GL_{MAJOR,MINOR}_VERSION correctly only in 3.0.4
@@ -241,15 +238,6 @@ OPENGL_GAL::OPENGL_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions, wxWindow* aParent,
     SetGridColor( COLOR4D( 0.8, 0.8, 0.8, 0.1 ) );
     SetAxesColor( COLOR4D( BLUE ) );
 
-    // Tesselator initialization
-    tesselator = gluNewTess();
-    InitTesselatorCallbacks( tesselator );
-
-    if( tesselator == NULL )
-        throw std::runtime_error( "Could not create the tesselator" );
-
-    gluTessProperty( tesselator, GLU_TESS_WINDING_RULE, GLU_TESS_WINDING_POSITIVE );
-
     SetTarget( TARGET_NONCACHED );
 }
 
@@ -260,7 +248,6 @@ OPENGL_GAL::~OPENGL_GAL()
 
     --instanceCounter;
     glFlush();
-    gluDeleteTess( tesselator );
     ClearCache();
 
     delete compositor;
@@ -525,471 +512,6 @@ void OPENGL_GAL::EndUpdate()
 }
 
 
-void OPENGL_GAL::DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
-{
-    currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-
-    drawLineQuad( aStartPoint, aEndPoint );
-}
-
-
-void OPENGL_GAL::DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
-                              double aWidth )
-{
-    if( isFillEnabled || aWidth == 1.0 )
-    {
-        currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-
-        SetLineWidth( aWidth );
-        drawLineQuad( aStartPoint, aEndPoint );
-    }
-    else
-    {
-        auto startEndVector = aEndPoint - aStartPoint;
-        auto lineAngle      = startEndVector.Angle();
-        // Outlined tracks
-        double lineLength = startEndVector.EuclideanNorm();
-
-        currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-
-        Save();
-
-        currentManager->Translate( aStartPoint.x, aStartPoint.y, 0.0 );
-        currentManager->Rotate( lineAngle, 0.0f, 0.0f, 1.0f );
-
-        drawLineQuad( VECTOR2D( 0.0,         aWidth / 2.0 ),
-                      VECTOR2D( lineLength,  aWidth / 2.0 ) );
-
-        drawLineQuad( VECTOR2D( 0.0,        -aWidth / 2.0 ),
-                      VECTOR2D( lineLength, -aWidth / 2.0 ) );
-
-        // Draw line caps
-        drawStrokedSemiCircle( VECTOR2D( 0.0, 0.0 ), aWidth / 2, M_PI / 2 );
-        drawStrokedSemiCircle( VECTOR2D( lineLength, 0.0 ), aWidth / 2, -M_PI / 2 );
-
-        Restore();
-    }
-}
-
-
-void OPENGL_GAL::DrawCircle( const VECTOR2D& aCenterPoint, double aRadius )
-{
-    if( isFillEnabled )
-    {
-        currentManager->Reserve( 3 );
-        currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-
-        /* Draw a triangle that contains the circle, then shade it leaving only the circle.
-         *  Parameters given to Shader() are indices of the triangle's vertices
-         *  (if you want to understand more, check the vertex shader source [shader.vert]).
-         *  Shader uses this coordinates to determine if fragments are inside the circle or not.
-         *       v2
-         *       /\
-         *      //\\
-         *  v0 /_\/_\ v1
-         */
-        currentManager->Shader( SHADER_FILLED_CIRCLE, 1.0 );
-        currentManager->Vertex( aCenterPoint.x - aRadius * sqrt( 3.0f ),            // v0
-                                aCenterPoint.y - aRadius, layerDepth );
-
-        currentManager->Shader( SHADER_FILLED_CIRCLE, 2.0 );
-        currentManager->Vertex( aCenterPoint.x + aRadius * sqrt( 3.0f),             // v1
-                                aCenterPoint.y - aRadius, layerDepth );
-
-        currentManager->Shader( SHADER_FILLED_CIRCLE, 3.0 );
-        currentManager->Vertex( aCenterPoint.x, aCenterPoint.y + aRadius * 2.0f,    // v2
-                                layerDepth );
-    }
-
-    if( isStrokeEnabled )
-    {
-        currentManager->Reserve( 3 );
-        currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-
-        /* Draw a triangle that contains the circle, then shade it leaving only the circle.
-         *  Parameters given to Shader() are indices of the triangle's vertices
-         *  (if you want to understand more, check the vertex shader source [shader.vert]).
-         *  and the line width. Shader uses this coordinates to determine if fragments are
-         *  inside the circle or not.
-         *       v2
-         *       /\
-         *      //\\
-         *  v0 /_\/_\ v1
-         */
-        double outerRadius = aRadius + ( lineWidth / 2 );
-        currentManager->Shader( SHADER_STROKED_CIRCLE, 1.0, aRadius, lineWidth );
-        currentManager->Vertex( aCenterPoint.x - outerRadius * sqrt( 3.0f ),            // v0
-                                aCenterPoint.y - outerRadius, layerDepth );
-
-        currentManager->Shader( SHADER_STROKED_CIRCLE, 2.0, aRadius, lineWidth );
-        currentManager->Vertex( aCenterPoint.x + outerRadius * sqrt( 3.0f ),            // v1
-                                aCenterPoint.y - outerRadius, layerDepth );
-
-        currentManager->Shader( SHADER_STROKED_CIRCLE, 3.0, aRadius, lineWidth );
-        currentManager->Vertex( aCenterPoint.x, aCenterPoint.y + outerRadius * 2.0f,    // v2
-                                layerDepth );
-    }
-}
-
-
-void OPENGL_GAL::DrawArc( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
-                          double aEndAngle )
-{
-    if( aRadius <= 0 )
-        return;
-
-    // Swap the angles, if start angle is greater than end angle
-    SWAP( aStartAngle, >, aEndAngle );
-
-    const double alphaIncrement = calcAngleStep( aRadius );
-
-    Save();
-    currentManager->Translate( aCenterPoint.x, aCenterPoint.y, 0.0 );
-
-    if( isFillEnabled )
-    {
-        double alpha;
-        currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-        currentManager->Shader( SHADER_NONE );
-
-        // Triangle fan
-        for( alpha = aStartAngle; ( alpha + alphaIncrement ) < aEndAngle; )
-        {
-            currentManager->Reserve( 3 );
-            currentManager->Vertex( 0.0, 0.0, 0.0 );
-            currentManager->Vertex( cos( alpha ) * aRadius, sin( alpha ) * aRadius, 0.0 );
-            alpha += alphaIncrement;
-            currentManager->Vertex( cos( alpha ) * aRadius, sin( alpha ) * aRadius, 0.0 );
-        }
-
-        // The last missing triangle
-        const VECTOR2D endPoint( cos( aEndAngle ) * aRadius, sin( aEndAngle ) * aRadius );
-
-        currentManager->Reserve( 3 );
-        currentManager->Vertex( 0.0, 0.0, 0.0 );
-        currentManager->Vertex( cos( alpha ) * aRadius, sin( alpha ) * aRadius, 0.0 );
-        currentManager->Vertex( endPoint.x,    endPoint.y,     0.0 );
-    }
-
-    if( isStrokeEnabled )
-    {
-        currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-
-        VECTOR2D p( cos( aStartAngle ) * aRadius, sin( aStartAngle ) * aRadius );
-        double alpha;
-
-        for( alpha = aStartAngle + alphaIncrement; alpha <= aEndAngle; alpha += alphaIncrement )
-        {
-            VECTOR2D p_next( cos( alpha ) * aRadius, sin( alpha ) * aRadius );
-            DrawLine( p, p_next );
-
-            p = p_next;
-        }
-
-        // Draw the last missing part
-        if( alpha != aEndAngle )
-        {
-            VECTOR2D p_last( cos( aEndAngle ) * aRadius, sin( aEndAngle ) * aRadius );
-            DrawLine( p, p_last );
-        }
-    }
-
-    Restore();
-}
-
-
-void OPENGL_GAL::DrawArcSegment( const VECTOR2D& aCenterPoint, double aRadius, double aStartAngle,
-                                 double aEndAngle, double aWidth )
-{
-    if( aRadius <= 0 )
-    {
-        // Arcs of zero radius are a circle of aWidth diameter
-        if( aWidth > 0 )
-            DrawCircle( aCenterPoint, aWidth / 2.0 );
-
-        return;
-    }
-
-    // Swap the angles, if start angle is greater than end angle
-    SWAP( aStartAngle, >, aEndAngle );
-
-    const double alphaIncrement = calcAngleStep( aRadius );
-
-    Save();
-    currentManager->Translate( aCenterPoint.x, aCenterPoint.y, 0.0 );
-
-    if( isStrokeEnabled )
-    {
-        currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-
-        double width = aWidth / 2.0;
-        VECTOR2D startPoint( cos( aStartAngle ) * aRadius,
-                             sin( aStartAngle ) * aRadius );
-        VECTOR2D endPoint( cos( aEndAngle ) * aRadius,
-                           sin( aEndAngle ) * aRadius );
-
-        drawStrokedSemiCircle( startPoint, width, aStartAngle + M_PI );
-        drawStrokedSemiCircle( endPoint, width, aEndAngle );
-
-        VECTOR2D pOuter( cos( aStartAngle ) * ( aRadius + width ),
-                         sin( aStartAngle ) * ( aRadius + width ) );
-
-        VECTOR2D pInner( cos( aStartAngle ) * ( aRadius - width ),
-                         sin( aStartAngle ) * ( aRadius - width ) );
-
-        double alpha;
-
-        for( alpha = aStartAngle + alphaIncrement; alpha <= aEndAngle; alpha += alphaIncrement )
-        {
-            VECTOR2D pNextOuter( cos( alpha ) * ( aRadius + width ),
-                                 sin( alpha ) * ( aRadius + width ) );
-            VECTOR2D pNextInner( cos( alpha ) * ( aRadius - width ),
-                                 sin( alpha ) * ( aRadius - width ) );
-
-            DrawLine( pOuter, pNextOuter );
-            DrawLine( pInner, pNextInner );
-
-            pOuter = pNextOuter;
-            pInner = pNextInner;
-        }
-
-        // Draw the last missing part
-        if( alpha != aEndAngle )
-        {
-            VECTOR2D pLastOuter( cos( aEndAngle ) * ( aRadius + width ),
-                                 sin( aEndAngle ) * ( aRadius + width ) );
-            VECTOR2D pLastInner( cos( aEndAngle ) * ( aRadius - width ),
-                                 sin( aEndAngle ) * ( aRadius - width ) );
-
-            DrawLine( pOuter, pLastOuter );
-            DrawLine( pInner, pLastInner );
-        }
-    }
-
-    if( isFillEnabled )
-    {
-        currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-        SetLineWidth( aWidth );
-
-        VECTOR2D p( cos( aStartAngle ) * aRadius, sin( aStartAngle ) * aRadius );
-        double alpha;
-
-        for( alpha = aStartAngle + alphaIncrement; alpha <= aEndAngle; alpha += alphaIncrement )
-        {
-            VECTOR2D p_next( cos( alpha ) * aRadius, sin( alpha ) * aRadius );
-            DrawLine( p, p_next );
-
-            p = p_next;
-        }
-
-        // Draw the last missing part
-        if( alpha != aEndAngle )
-        {
-            VECTOR2D p_last( cos( aEndAngle ) * aRadius, sin( aEndAngle ) * aRadius );
-            DrawLine( p, p_last );
-        }
-    }
-
-    Restore();
-}
-
-
-void OPENGL_GAL::DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
-{
-    // Compute the diagonal points of the rectangle
-    VECTOR2D diagonalPointA( aEndPoint.x, aStartPoint.y );
-    VECTOR2D diagonalPointB( aStartPoint.x, aEndPoint.y );
-
-    // Fill the rectangle
-    if( isFillEnabled )
-    {
-        currentManager->Reserve( 6 );
-        currentManager->Shader( SHADER_NONE );
-        currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-
-        currentManager->Vertex( aStartPoint.x, aStartPoint.y, layerDepth );
-        currentManager->Vertex( diagonalPointA.x, diagonalPointA.y, layerDepth );
-        currentManager->Vertex( aEndPoint.x, aEndPoint.y, layerDepth );
-
-        currentManager->Vertex( aStartPoint.x, aStartPoint.y, layerDepth );
-        currentManager->Vertex( aEndPoint.x, aEndPoint.y, layerDepth );
-        currentManager->Vertex( diagonalPointB.x, diagonalPointB.y, layerDepth );
-    }
-
-    // Stroke the outline
-    if( isStrokeEnabled )
-    {
-        currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-
-        std::deque<VECTOR2D> pointList;
-        pointList.push_back( aStartPoint );
-        pointList.push_back( diagonalPointA );
-        pointList.push_back( aEndPoint );
-        pointList.push_back( diagonalPointB );
-        pointList.push_back( aStartPoint );
-        DrawPolyline( pointList );
-    }
-}
-
-
-void OPENGL_GAL::DrawPolyline( const std::deque<VECTOR2D>& aPointList )
-{
-    drawPolyline( [&](int idx) { return aPointList[idx]; }, aPointList.size() );
-}
-
-
-void OPENGL_GAL::DrawPolyline( const VECTOR2D aPointList[], int aListSize )
-{
-    drawPolyline( [&](int idx) { return aPointList[idx]; }, aListSize );
-}
-
-
-void OPENGL_GAL::DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain )
-{
-    auto numPoints = aLineChain.PointCount();
-
-    if( aLineChain.IsClosed() )
-        numPoints += 1;
-
-    drawPolyline( [&](int idx) { return aLineChain.CPoint(idx); }, numPoints );
-}
-
-
-void OPENGL_GAL::DrawPolygon( const std::deque<VECTOR2D>& aPointList )
-{
-    auto points = std::unique_ptr<GLdouble[]>( new GLdouble[3 * aPointList.size()] );
-    GLdouble* ptr = points.get();
-
-    for( const VECTOR2D& p : aPointList )
-    {
-        *ptr++ = p.x;
-        *ptr++ = p.y;
-        *ptr++ = layerDepth;
-    }
-
-    drawPolygon( points.get(), aPointList.size() );
-}
-
-
-void OPENGL_GAL::DrawPolygon( const VECTOR2D aPointList[], int aListSize )
-{
-    auto points = std::unique_ptr<GLdouble[]>( new GLdouble[3 * aListSize] );
-    GLdouble* target = points.get();
-    const VECTOR2D* src = aPointList;
-
-    for( int i = 0; i < aListSize; ++i )
-    {
-        *target++ = src->x;
-        *target++ = src->y;
-        *target++ = layerDepth;
-        ++src;
-    }
-
-    drawPolygon( points.get(), aListSize );
-}
-
-
-void OPENGL_GAL::drawTriangulatedPolyset( const SHAPE_POLY_SET& aPolySet )
-{
-    currentManager->Shader( SHADER_NONE );
-    currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-
-    if( isFillEnabled )
-    {
-        for( unsigned int j = 0; j < aPolySet.TriangulatedPolyCount(); ++j )
-        {
-            auto triPoly = aPolySet.TriangulatedPolygon( j );
-
-            for( size_t i = 0; i < triPoly->GetTriangleCount(); i++ )
-            {
-                VECTOR2I a, b, c;
-                triPoly->GetTriangle( i, a, b, c );
-                currentManager->Vertex( a.x, a.y, layerDepth );
-                currentManager->Vertex( b.x, b.y, layerDepth );
-                currentManager->Vertex( c.x, c.y, layerDepth );
-            }
-        }
-    }
-
-    if( isStrokeEnabled )
-    {
-        for( int j = 0; j < aPolySet.OutlineCount(); ++j )
-        {
-            const auto& poly = aPolySet.Polygon( j );
-
-            for( const auto& lc : poly )
-            {
-                DrawPolyline( lc );
-            }
-        }
-    }
-}
-
-
-void OPENGL_GAL::DrawPolygon( const SHAPE_POLY_SET& aPolySet )
-{
-    if ( aPolySet.IsTriangulationUpToDate() )
-    {
-        drawTriangulatedPolyset( aPolySet );
-        return;
-    }
-
-    for( int j = 0; j < aPolySet.OutlineCount(); ++j )
-    {
-        const SHAPE_LINE_CHAIN& outline = aPolySet.COutline( j );
-
-        if( outline.SegmentCount() == 0 )
-            continue;
-
-        const int pointCount = outline.SegmentCount() + 1;
-        std::unique_ptr<GLdouble[]> points( new GLdouble[3 * pointCount] );
-        GLdouble* ptr = points.get();
-
-        for( int i = 0; i < pointCount; ++i )
-        {
-            const VECTOR2I& p = outline.CPoint( i );
-            *ptr++ = p.x;
-            *ptr++ = p.y;
-            *ptr++ = layerDepth;
-        }
-
-        drawPolygon( points.get(), pointCount );
-    }
-}
-
-
-void OPENGL_GAL::DrawCurve( const VECTOR2D& aStartPoint, const VECTOR2D& aControlPointA,
-                            const VECTOR2D& aControlPointB, const VECTOR2D& aEndPoint )
-{
-    // FIXME The drawing quality needs to be improved
-    // FIXME Perhaps choose a quad/triangle strip instead?
-    // FIXME Brute force method, use a better (recursive?) algorithm
-
-    std::deque<VECTOR2D> pointList;
-
-    double t  = 0.0;
-    double dt = 1.0 / (double) CURVE_POINTS;
-
-    for( int i = 0; i <= CURVE_POINTS; i++ )
-    {
-        double omt  = 1.0 - t;
-        double omt2 = omt * omt;
-        double omt3 = omt * omt2;
-        double t2   = t * t;
-        double t3   = t * t2;
-
-        VECTOR2D vertex = omt3 * aStartPoint + 3.0 * t * omt2 * aControlPointA
-                          + 3.0 * t2 * omt * aControlPointB + t3 * aEndPoint;
-
-        pointList.push_back( vertex );
-
-        t += dt;
-    }
-
-    DrawPolyline( pointList );
-}
-
-
 void OPENGL_GAL::DrawBitmap( const BITMAP_BASE& aBitmap )
 {
     int ppi = aBitmap.GetPPI();
@@ -1044,108 +566,6 @@ void OPENGL_GAL::DrawBitmap( const BITMAP_BASE& aBitmap )
 }
 
 
-void OPENGL_GAL::BitmapText( const wxString& aText, const VECTOR2D& aPosition,
-                             double aRotationAngle )
-{
-    wxASSERT_MSG( !IsTextMirrored(), "No support for mirrored text using bitmap fonts." );
-
-    auto processedText = ProcessOverbars( aText );
-    const auto& text = processedText.first;
-    const auto& overbars = processedText.second;
-
-    // Compute text size, so it can be properly justified
-    VECTOR2D textSize;
-    float commonOffset;
-    std::tie( textSize, commonOffset ) = computeBitmapTextSize( text );
-
-    const double SCALE = 1.4 * GetGlyphSize().y / textSize.y;
-    bool overbar = false;
-
-    int overbarLength = 0;
-    double overbarHeight = textSize.y;
-
-    Save();
-
-    currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-    currentManager->Translate( aPosition.x, aPosition.y, layerDepth );
-    currentManager->Rotate( aRotationAngle, 0.0f, 0.0f, -1.0f );
-
-    double sx = SCALE * ( globalFlipX ? -1.0 : 1.0 );
-    double sy = SCALE * ( globalFlipY ? -1.0 : 1.0 );
-
-    currentManager->Scale( sx, sy, 0 );
-    currentManager->Translate( 0, -commonOffset, 0 );
-
-    switch( GetHorizontalJustify() )
-    {
-    case GR_TEXT_HJUSTIFY_CENTER:
-        Translate( VECTOR2D( -textSize.x / 2.0, 0 ) );
-        break;
-
-    case GR_TEXT_HJUSTIFY_RIGHT:
-        //if( !IsTextMirrored() )
-            Translate( VECTOR2D( -textSize.x, 0 ) );
-        break;
-
-    case GR_TEXT_HJUSTIFY_LEFT:
-        //if( IsTextMirrored() )
-            //Translate( VECTOR2D( -textSize.x, 0 ) );
-        break;
-    }
-
-    switch( GetVerticalJustify() )
-    {
-    case GR_TEXT_VJUSTIFY_TOP:
-        Translate( VECTOR2D( 0, -textSize.y ) );
-        overbarHeight = -textSize.y / 2.0;
-        break;
-
-    case GR_TEXT_VJUSTIFY_CENTER:
-        Translate( VECTOR2D( 0, -textSize.y / 2.0 ) );
-        overbarHeight = 0;
-        break;
-
-    case GR_TEXT_VJUSTIFY_BOTTOM:
-        break;
-    }
-
-    int i = 0;
-
-    for( UTF8::uni_iter chIt = text.ubegin(), end = text.uend(); chIt < end; ++chIt )
-    {
-        unsigned int c = *chIt;
-        wxASSERT_MSG( c != '\n' && c != '\r', wxT( "No support for multiline bitmap text yet" ) );
-
-        // Handle overbar
-        if( overbars[i] && !overbar )
-        {
-            overbar = true;     // beginning of an overbar
-        }
-        else if( overbar && !overbars[i] )
-        {
-            overbar = false;    // end of an overbar
-            drawBitmapOverbar( overbarLength, overbarHeight );
-            overbarLength = 0;
-        }
-
-        if( overbar )
-            overbarLength += drawBitmapChar( c );
-        else
-            drawBitmapChar( c );
-
-        ++i;
-    }
-
-    // Handle the case when overbar is active till the end of the drawn text
-    currentManager->Translate( 0, commonOffset, 0 );
-
-    if( overbar && overbarLength > 0 )
-        drawBitmapOverbar( overbarLength, overbarHeight );
-
-    Restore();
-}
-
-
 void OPENGL_GAL::DrawGrid()
 {
     SetTarget( TARGET_NONCACHED );
@@ -1380,55 +800,44 @@ void OPENGL_GAL::Transform( const MATRIX3x3D& aTransformation )
 }
 
 
-void OPENGL_GAL::Rotate( double aAngle )
+int OPENGL_GAL::BeginGroup()
 {
-    currentManager->Rotate( aAngle, 0.0f, 0.0f, 1.0f );
-}
+    isGrouping = true;
 
+    std::shared_ptr<VERTEX_ITEM> newItem = std::make_shared<VERTEX_ITEM>( *cachedManager );
+    int groupNumber = getNewGroupNumber();
+    groups.insert( std::make_pair( groupNumber, newItem ) );
 
-void OPENGL_GAL::Translate( const VECTOR2D& aVector )
-{
-    currentManager->Translate( aVector.x, aVector.y, 0.0f );
+    return groupNumber;
 }
 
 
-void OPENGL_GAL::Scale( const VECTOR2D& aScale )
+void OPENGL_GAL::EndGroup()
 {
-    currentManager->Scale( aScale.x, aScale.y, 0.0f );
+    cachedManager->FinishItem();
+    isGrouping = false;
 }
 
 
-void OPENGL_GAL::Save()
+int OPENGL_GAL::UploadGroup( GAL* aRecorder, int aRecordedGroup )
 {
-    currentManager->PushMatrix();
-}
+    OPENGL_RECORDING_GAL* recorder = dynamic_cast<OPENGL_RECORDING_GAL*>( aRecorder );
+    wxCHECK( recorder, -1 );
 
+    unsigned int size;
+    const VERTEX* vertices = recorder->GetGroupVertices( aRecordedGroup, size );
 
-void OPENGL_GAL::Restore()
-{
-    currentManager->PopMatrix();
-}
-
+    int groupNumber = BeginGroup();
 
-int OPENGL_GAL::BeginGroup()
-{
-    isGrouping = true;
+    if( size > 0 )
+        cachedManager->CopyVertices( vertices, size );
 
-    std::shared_ptr<VERTEX_ITEM> newItem = std::make_shared<VERTEX_ITEM>( *cachedManager );
-    int groupNumber = getNewGroupNumber();
-    groups.insert( std::make_pair( groupNumber, newItem ) );
+    EndGroup();
 
     return groupNumber;
 }
 
 
-void OPENGL_GAL::EndGroup()
-{
-    cachedManager->FinishItem();
-    isGrouping = false;
-}
-
-
 void OPENGL_GAL::DrawGroup( int aGroupNumber )
 {
     if( groups[aGroupNumber] )
@@ -1468,6 +877,23 @@ void OPENGL_GAL::ClearCache()
 }
 
 
+GAL* OPENGL_GAL::CreateGroupRecorder()
+{
+    return new OPENGL_RECORDING_GAL( options );
+}
+
+
+GAL_CACHE_STATISTICS OPENGL_GAL::GetCacheStatistics() const
+{
+    GAL_CACHE_STATISTICS stats;
+
+    if( cachedManager )
+        cachedManager->GetCacheStatistics( stats );
+
+    return stats;
+}
+
+
 void OPENGL_GAL::SaveScreen()
 {
     wxASSERT_MSG( false, wxT( "Not implemented yet" ) );
@@ -1548,345 +974,6 @@ void OPENGL_GAL::DrawCursor( const VECTOR2D& aCursorPosition )
 }
 
 
-void OPENGL_GAL::drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint )
-{
-    /* Helper drawing:                   ____--- v3       ^
-     *                           ____---- ...   \          \
-     *                   ____----      ...       \   end    \
-     *     v1    ____----           ...    ____----          \ width
-     *       ----                ...___----        \          \
-     *       \             ___...--                 \          v
-     *        \    ____----...                ____---- v2
-     *         ----     ...           ____----
-     *  start   \    ...      ____----
-     *           \... ____----
-     *            ----
-     *            v0
-     * dots mark triangles' hypotenuses
-     */
-
-    auto v1  = currentManager->GetTransformation() * glm::vec4( aStartPoint.x, aStartPoint.y, 0.0, 0.0 );
-    auto v2  = currentManager->GetTransformation() * glm::vec4( aEndPoint.x, aEndPoint.y, 0.0, 0.0 );
-
-    VECTOR2D startEndVector( v2.x - v1.x, v2.y - v1.y );
-
-    double lineLength     = startEndVector.EuclideanNorm();
-
-    VECTOR2D vs ( startEndVector );
-    float aspect;
-
-    if ( lineWidth == 0.0 ) // pixel-width line
-    {
-        vs = vs.Resize( 0.5 );
-        aspect = ( lineLength + 1.0 );
-    }
-    else
-    {
-        vs = vs.Resize( 0.5 * lineWidth );
-        aspect = ( lineLength + lineWidth ) / lineWidth;
-    }
-
-    currentManager->Reserve( 6 );
-
-    // Line width is maintained by the vertex shader
-    currentManager->Shader( SHADER_LINE_A, aspect, vs.x, vs.y );
-    currentManager->Vertex( aStartPoint, layerDepth );
-
-    currentManager->Shader( SHADER_LINE_B, aspect, vs.x, vs.y );
-    currentManager->Vertex( aStartPoint, layerDepth );
-
-    currentManager->Shader( SHADER_LINE_C, aspect, vs.x, vs.y );
-    currentManager->Vertex( aEndPoint, layerDepth );
-
-    currentManager->Shader( SHADER_LINE_D, aspect, vs.x, vs.y );
-    currentManager->Vertex( aEndPoint, layerDepth );
-
-    currentManager->Shader( SHADER_LINE_E, aspect, vs.x, vs.y );
-    currentManager->Vertex( aEndPoint, layerDepth );
-
-    currentManager->Shader( SHADER_LINE_F, aspect, vs.x, vs.y );
-    currentManager->Vertex( aStartPoint, layerDepth );
-}
-
-
-void OPENGL_GAL::drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle )
-{
-    if( isFillEnabled )
-    {
-        currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-        drawFilledSemiCircle( aCenterPoint, aRadius, aAngle );
-    }
-
-    if( isStrokeEnabled )
-    {
-        currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-        drawStrokedSemiCircle( aCenterPoint, aRadius, aAngle );
-    }
-}
-
-
-void OPENGL_GAL::drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
-                                       double aAngle )
-{
-    Save();
-
-    currentManager->Reserve( 3 );
-    currentManager->Translate( aCenterPoint.x, aCenterPoint.y, 0.0f );
-    currentManager->Rotate( aAngle, 0.0f, 0.0f, 1.0f );
-
-    /* Draw a triangle that contains the semicircle, then shade it to leave only
-     * the semicircle. Parameters given to Shader() are indices of the triangle's vertices
-     * (if you want to understand more, check the vertex shader source [shader.vert]).
-     * Shader uses these coordinates to determine if fragments are inside the semicircle or not.
-     *       v2
-     *       /\
-     *      /__\
-     *  v0 //__\\ v1
-     */
-    currentManager->Shader( SHADER_FILLED_CIRCLE, 4.0f );
-    currentManager->Vertex( -aRadius * 3.0f / sqrt( 3.0f ), 0.0f, layerDepth );     // v0
-
-    currentManager->Shader( SHADER_FILLED_CIRCLE, 5.0f );
-    currentManager->Vertex( aRadius * 3.0f / sqrt( 3.0f ), 0.0f, layerDepth );      // v1
-
-    currentManager->Shader( SHADER_FILLED_CIRCLE, 6.0f );
-    currentManager->Vertex( 0.0f, aRadius * 2.0f, layerDepth );                     // v2
-
-    Restore();
-}
-
-
-void OPENGL_GAL::drawStrokedSemiCircle( const VECTOR2D& aCenterPoint, double aRadius,
-                                        double aAngle )
-{
-    double outerRadius = aRadius + ( lineWidth / 2 );
-
-    Save();
-
-    currentManager->Reserve( 3 );
-    currentManager->Translate( aCenterPoint.x, aCenterPoint.y, 0.0f );
-    currentManager->Rotate( aAngle, 0.0f, 0.0f, 1.0f );
-
-    /* Draw a triangle that contains the semicircle, then shade it to leave only
-     * the semicircle. Parameters given to Shader() are indices of the triangle's vertices
-     * (if you want to understand more, check the vertex shader source [shader.vert]), the
-     * radius and the line width. Shader uses these coordinates to determine if fragments are
-     * inside the semicircle or not.
-     *       v2
-     *       /\
-     *      /__\
-     *  v0 //__\\ v1
-     */
-    currentManager->Shader( SHADER_STROKED_CIRCLE, 4.0f, aRadius, lineWidth );
-    currentManager->Vertex( -outerRadius * 3.0f / sqrt( 3.0f ), 0.0f, layerDepth );     // v0
-
-    currentManager->Shader( SHADER_STROKED_CIRCLE, 5.0f, aRadius, lineWidth );
-    currentManager->Vertex( outerRadius * 3.0f / sqrt( 3.0f ), 0.0f, layerDepth );      // v1
-
-    currentManager->Shader( SHADER_STROKED_CIRCLE, 6.0f, aRadius, lineWidth );
-    currentManager->Vertex( 0.0f, outerRadius * 2.0f, layerDepth );                     // v2
-
-    Restore();
-}
-
-
-void OPENGL_GAL::drawPolygon( GLdouble* aPoints, int aPointCount )
-{
-    if( isFillEnabled )
-    {
-        currentManager->Shader( SHADER_NONE );
-        currentManager->Color( fillColor.r, fillColor.g, fillColor.b, fillColor.a );
-
-        // Any non convex polygon needs to be tesselated
-        // for this purpose the GLU standard functions are used
-        TessParams params = { currentManager, tessIntersects };
-        gluTessBeginPolygon( tesselator, &params );
-        gluTessBeginContour( tesselator );
-
-        GLdouble* point = aPoints;
-
-        for( int i = 0; i < aPointCount; ++i )
-        {
-            gluTessVertex( tesselator, point, point );
-            point += 3;     // 3 coordinates
-        }
-
-        gluTessEndContour( tesselator );
-        gluTessEndPolygon( tesselator );
-
-        // Free allocated intersecting points
-        tessIntersects.clear();
-    }
-
-    if( isStrokeEnabled )
-    {
-        drawPolyline( [&](int idx) { return VECTOR2D( aPoints[idx * 3], aPoints[idx * 3 + 1] ); },
-                aPointCount );
-    }
-}
-
-
-void OPENGL_GAL::drawPolyline( const std::function<VECTOR2D (int)>& aPointGetter, int aPointCount )
-{
-    if( aPointCount < 2 )
-        return;
-
-    currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, strokeColor.a );
-    int i;
-
-    for( i = 1; i < aPointCount; ++i )
-    {
-        auto start = aPointGetter( i - 1 );
-        auto end = aPointGetter( i );
-        const VECTOR2D startEndVector = ( end - start );
-        double lineAngle = startEndVector.Angle();
-
-        drawLineQuad( start, end );
-
-        // There is no need to draw line caps on both ends of polyline's segments
-        drawFilledSemiCircle( start, lineWidth / 2, lineAngle + M_PI / 2 );
-    }
-
-    // ..and now - draw the ending cap
-    auto start = aPointGetter( i - 2 );
-    auto end = aPointGetter( i - 1 );
-    const VECTOR2D startEndVector = ( end - start );
-    double lineAngle = startEndVector.Angle();
-    drawFilledSemiCircle( end, lineWidth / 2, lineAngle - M_PI / 2 );
-}
-
-
-int OPENGL_GAL::drawBitmapChar( unsigned long aChar )
-{
-    const float TEX_X = font_image.width;
-    const float TEX_Y = font_image.height;
-
-    // handle space
-    if( aChar == ' ' )
-    {
-        const FONT_GLYPH_TYPE* g = LookupGlyph( 'x' );
-        wxASSERT( g );
-        Translate( VECTOR2D( g->advance, 0 ) );
-        return g->advance;
-    }
-
-    const FONT_GLYPH_TYPE* glyph = LookupGlyph( aChar );
-    wxASSERT( glyph );
-
-    if( !glyph )
-        return 0;
-
-    const float X = glyph->atlas_x + font_information.smooth_pixels;
-    const float Y = glyph->atlas_y + font_information.smooth_pixels;
-    const float XOFF =  glyph->minx;
-
-    // adjust for height rounding
-    const float round_adjust =   ( glyph->maxy - glyph->miny )
-                               - float( glyph->atlas_h - font_information.smooth_pixels * 2 );
-    const float top_adjust   = font_information.max_y - glyph->maxy;
-    const float YOFF = round_adjust + top_adjust;
-    const float W    = glyph->atlas_w  - font_information.smooth_pixels *2;
-    const float H    = glyph->atlas_h  - font_information.smooth_pixels *2;
-    const float B    = 0;
-
-    currentManager->Reserve( 6 );
-    Translate( VECTOR2D( XOFF, YOFF ) );
-    /* Glyph:
-    * v0    v1
-    *   +--+
-    *   | /|
-    *   |/ |
-    *   +--+
-    * v2    v3
-    */
-    currentManager->Shader( SHADER_FONT, X / TEX_X, ( Y + H ) / TEX_Y );
-    currentManager->Vertex( -B,      -B, 0 );             // v0
-
-    currentManager->Shader( SHADER_FONT, ( X + W ) / TEX_X, ( Y + H ) / TEX_Y );
-    currentManager->Vertex( W + B,   -B, 0 );             // v1
-
-    currentManager->Shader( SHADER_FONT, X / TEX_X, Y / TEX_Y );
-    currentManager->Vertex( -B,   H + B, 0 );             // v2
-
-
-    currentManager->Shader( SHADER_FONT, ( X + W ) / TEX_X, ( Y + H ) / TEX_Y );
-    currentManager->Vertex( W + B, -B, 0 );               // v1
-
-    currentManager->Shader( SHADER_FONT, X / TEX_X, Y / TEX_Y );
-    currentManager->Vertex( -B,  H + B, 0 );              // v2
-
-    currentManager->Shader( SHADER_FONT, ( X + W ) / TEX_X, Y / TEX_Y );
-    currentManager->Vertex( W + B,  H + B, 0 );           // v3
-
-    Translate( VECTOR2D( -XOFF + glyph->advance, -YOFF ) );
-
-    return glyph->advance;
-}
-
-
-void OPENGL_GAL::drawBitmapOverbar( double aLength, double aHeight )
-{
-    // To draw an overbar, simply draw an overbar
-    const FONT_GLYPH_TYPE* glyph = LookupGlyph( '_' );
-    wxCHECK( glyph, /* void */ );
-
-    const float H = glyph->maxy - glyph->miny;
-
-    Save();
-
-    Translate( VECTOR2D( -aLength, -aHeight-1.5*H ) );
-
-    currentManager->Reserve( 6 );
-    currentManager->Color( strokeColor.r, strokeColor.g, strokeColor.b, 1 );
-
-    currentManager->Shader( 0 );
-
-    currentManager->Vertex( 0, 0, 0 );          // v0
-    currentManager->Vertex( aLength, 0, 0 );    // v1
-    currentManager->Vertex( 0, H, 0 );          // v2
-
-    currentManager->Vertex( aLength, 0, 0 );    // v1
-    currentManager->Vertex( 0, H, 0 );          // v2
-    currentManager->Vertex( aLength, H, 0 );    // v3
-
-    Restore();
-}
-
-
-std::pair<VECTOR2D, float> OPENGL_GAL::computeBitmapTextSize( const UTF8& aText ) const
-{
-    VECTOR2D textSize( 0, 0 );
-    float commonOffset = std::numeric_limits<float>::max();
-    static const auto defaultGlyph = LookupGlyph( '(' ); // for strange chars
-
-    for( UTF8::uni_iter chIt = aText.ubegin(), end = aText.uend(); chIt < end; ++chIt )
-    {
-        unsigned int c = *chIt;
-
-        const FONT_GLYPH_TYPE* glyph = LookupGlyph( c );
-        // Debug: show not coded char in the atlas
-        wxASSERT_MSG( glyph, wxString::Format( "missing char in font: code 0x%x <%c>", c, c ) );
-
-        if( !glyph || // Not coded in font
-            c == '-' || c == '_' )     // Strange size of these 2 chars
-        {
-            glyph = defaultGlyph;
-        }
-
-        if( glyph )
-        {
-            textSize.x  += glyph->advance;
-        }
-    }
-
-    textSize.y   = std::max<float>( textSize.y, font_information.max_y - defaultGlyph->miny );
-    commonOffset = std::min<float>( font_information.max_y - defaultGlyph->maxy, commonOffset );
-    textSize.y -= commonOffset;
-
-    return std::make_pair( textSize, commonOffset );
-}
-
-
 void OPENGL_GAL::onPaint( wxPaintEvent& WXUNUSED( aEvent ) )
 {
     PostPaint();
@@ -2020,55 +1107,6 @@ void OPENGL_GAL::init()
 }
 
 
-// ------------------------------------- // Callback functions for the tesselator // ------------------------------------- // Compare Redbook Chapter 11
-void CALLBACK VertexCallback( GLvoid* aVertexPtr, void* aData )
-{
-    GLdouble* vertex = static_cast<GLdouble*>( aVertexPtr );
-    OPENGL_GAL::TessParams* param = static_cast<OPENGL_GAL::TessParams*>( aData );
-    VERTEX_MANAGER* vboManager = param->vboManager;
-
-    assert( vboManager );
-    vboManager->Vertex( vertex[0], vertex[1], vertex[2] );
-}
-
-
-void CALLBACK CombineCallback( GLdouble coords[3],
-                               GLdouble* vertex_data[4],
-                               GLfloat weight[4], GLdouble** dataOut, void* aData )
-{
-    GLdouble* vertex = new GLdouble[3];
-    OPENGL_GAL::TessParams* param = static_cast<OPENGL_GAL::TessParams*>( aData );
-
-    // Save the pointer so we can delete it later
-    param->intersectPoints.push_back( boost::shared_array<GLdouble>( vertex ) );
-
-    memcpy( vertex, coords, 3 * sizeof(GLdouble) );
-
-    *dataOut = vertex;
-}
-
-
-void CALLBACK EdgeCallback( GLboolean aEdgeFlag )
-{
-    // This callback is needed to force GLU tesselator to use triangles only
-}
-
-
-void CALLBACK ErrorCallback( GLenum aErrorCode )
-{
-    //throw std::runtime_error( std::string( "Tessellation error: " ) +
-                              //std::string( (const char*) gluErrorString( aErrorCode ) );
-}
-
-
-static void InitTesselatorCallbacks( GLUtesselator* aTesselator )
-{
-    gluTessCallback( aTesselator, GLU_TESS_VERTEX_DATA,  ( void (CALLBACK*)() )VertexCallback );
-    gluTessCallback( aTesselator, GLU_TESS_COMBINE_DATA, ( void (CALLBACK*)() )CombineCallback );
-    gluTessCallback( aTesselator, GLU_TESS_EDGE_FLAG,    ( void (CALLBACK*)() )EdgeCallback );
-    gluTessCallback( aTesselator, GLU_TESS_ERROR,        ( void (CALLBACK*)() )ErrorCallback );
-}
-
 void OPENGL_GAL::EnableDepthTest( bool aEnabled )
 {
     if( aEnabled )
@@ -57,7 +57,7 @@ VERTEX_CONTAINER* VERTEX_CONTAINER::MakeContainer( bool aCached )
 
 VERTEX_CONTAINER::VERTEX_CONTAINER( unsigned int aSize ) :
     m_freeSpace( aSize ), m_currentSize( aSize ), m_initialSize( aSize ),
-    m_vertices( NULL ), m_failed( false ), m_dirty( true )
+    m_vertices( NULL ), m_failed( false ), m_dirty( true ), m_dirtyBegin( 0 ), m_dirtyEnd( 0 )
 {
 }
 
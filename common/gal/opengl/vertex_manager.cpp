@@ -35,12 +35,18 @@
 #include <gal/opengl/vertex_item.h>
 #include <confirm.h>
 
+#include <cstring>
+
 using namespace KIGFX;
 
-VERTEX_MANAGER::VERTEX_MANAGER( bool aCached ) :
+VERTEX_MANAGER::VERTEX_MANAGER( bool aCached, unsigned int aInitialSize ) :
     m_noTransform( true ), m_transform( 1.0f ), m_reserved( NULL ), m_reservedSpace( 0 )
 {
-    m_container.reset( VERTEX_CONTAINER::MakeContainer( aCached ) );
+    if( !aCached && aInitialSize > 0 )
+        m_container.reset( new NONCACHED_CONTAINER( aInitialSize ) );
+    else
+        m_container.reset( VERTEX_CONTAINER::MakeContainer( aCached ) );
+
     m_gpu.reset( GPU_MANAGER::MakeManager( m_container.get() ) );
 
     // There is no shader used by default
@@ -57,6 +63,9 @@ void VERTEX_MANAGER::Map()
 
 void VERTEX_MANAGER::Unmap()
 {
+    if( m_container->IsCached() )
+        static_cast<CACHED_CONTAINER*>( m_container.get() )->Compact( COMPACTION_STEP );
+
     m_container->Unmap();
 }
 
@@ -154,6 +163,30 @@ bool VERTEX_MANAGER::Vertices( const VERTEX aVertices[], unsigned int aSize )
 }
 
 
+bool VERTEX_MANAGER::CopyVertices( const VERTEX aVertices[], unsigned int aSize )
+{
+    // flag to avoid hanging by calling DisplayError too many times:
+    static bool show_err = true;
+
+    VERTEX* newVertex = m_container->Allocate( aSize );
+
+    if( newVertex == NULL )
+    {
+        if( show_err )
+        {
+            DisplayError( NULL, wxT( "VERTEX_MANAGER::CopyVertices: Vertex allocation error" ) );
+            show_err = false;
+        }
+
+        return false;
+    }
+
+    memcpy( newVertex, aVertices, aSize * VERTEX_SIZE );
+
+    return true;
+}
+
+
 void VERTEX_MANAGER::SetItem( VERTEX_ITEM& aItem ) const
 {
     m_container->SetItem( &aItem );
@@ -188,7 +221,7 @@ void VERTEX_MANAGER::ChangeItemColor( const VERTEX_ITEM& aItem, const COLOR4D& a
         vertex++;
     }
 
-    m_container->SetDirty();
+    m_container->SetDirty( offset, size );
 }
 
 
@@ -205,7 +238,7 @@ void VERTEX_MANAGER::ChangeItemDepth( const VERTEX_ITEM& aItem, GLfloat aDepth )
         vertex++;
     }
 
-    m_container->SetDirty();
+    m_container->SetDirty( offset, size );
 }
 
 
@@ -218,6 +251,28 @@ VERTEX* VERTEX_MANAGER::GetVertices( const VERTEX_ITEM& aItem ) const
 }
 
 
+VERTEX* VERTEX_MANAGER::GetVertices( unsigned int aOffset ) const
+{
+    return m_container->GetVertices( aOffset );
+}
+
+
+unsigned int VERTEX_MANAGER::GetSize() const
+{
+    return m_container->GetSize();
+}
+
+
+bool VERTEX_MANAGER::GetCacheStatistics( GAL_CACHE_STATISTICS& aStats ) const
+{
+    if( !m_container->IsCached() )
+        return false;
+
+    static_cast<const CACHED_CONTAINER*>( m_container.get() )->GetStatistics( aStats );
+    return true;
+}
+
+
 void VERTEX_MANAGER::SetShader( SHADER& aShader ) const
 {
     m_gpu->SetShader( aShader );
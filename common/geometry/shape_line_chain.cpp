@@ -56,7 +56,7 @@ bool SHAPE_LINE_CHAIN::Collide( const VECTOR2I& aP, int aClearance ) const
 
 void SHAPE_LINE_CHAIN::Rotate( double aAngle, const VECTOR2I& aCenter )
 {
-    for( std::vector<VECTOR2I>::iterator i = m_points.begin(); i != m_points.end(); ++i )
+    for( point_iter i = m_points.begin(); i != m_points.end(); ++i )
     {
         (*i) -= aCenter;
         (*i) = (*i).Rotate( aAngle );
@@ -481,7 +481,7 @@ const OPT<SHAPE_LINE_CHAIN::INTERSECTION> SHAPE_LINE_CHAIN::SelfIntersecting() c
 
 SHAPE_LINE_CHAIN& SHAPE_LINE_CHAIN::Simplify()
 {
-    std::vector<VECTOR2I> pts_unique;
+    POINT_VECTOR pts_unique;
 
     if( PointCount() < 2 )
     {
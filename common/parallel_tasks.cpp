@@ -0,0 +1,102 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <parallel_tasks.h>
+
+#include <common.h>
+
+#include <algorithm>
+
+
+PARALLEL_TASKS::PARALLEL_TASKS( size_t aTaskCount, const std::function<void( size_t )>& aTask,
+                                bool aCLocale, size_t aThreadCount ) :
+    m_task( aTask ),
+    m_taskCount( aTaskCount ),
+    m_nextTask( 0 ),
+    m_finishedThreads( 0 ),
+    m_cancelled( false )
+{
+    if( aCLocale )
+        m_locale.reset( new LOCALE_IO );
+
+    size_t threadCount = std::min( aThreadCount ? aThreadCount : DefaultThreadCount(),
+                                   aTaskCount );
+
+    for( size_t ii = 0; ii < threadCount; ++ii )
+        m_threads.push_back( std::thread( &PARALLEL_TASKS::runTasks, this ) );
+}
+
+
+PARALLEL_TASKS::~PARALLEL_TASKS()
+{
+    Wait();
+}
+
+
+void PARALLEL_TASKS::Run( size_t aTaskCount, const std::function<void( size_t )>& aTask,
+                          bool aCLocale, size_t aThreadCount )
+{
+    if( aTaskCount <= 1 || aThreadCount == 1 )
+    {
+        std::unique_ptr<LOCALE_IO> locale( aCLocale ? new LOCALE_IO : nullptr );
+
+        for( size_t ii = 0; ii < aTaskCount; ++ii )
+            aTask( ii );
+
+        return;
+    }
+
+    PARALLEL_TASKS tasks( aTaskCount, aTask, aCLocale, aThreadCount );
+    tasks.Wait();
+}
+
+
+size_t PARALLEL_TASKS::DefaultThreadCount()
+{
+    return std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+}
+
+
+void PARALLEL_TASKS::Wait()
+{
+    for( std::thread& thread : m_threads )
+    {
+        if( thread.joinable() )
+            thread.join();
+    }
+
+    m_locale.reset();
+}
+
+
+void PARALLEL_TASKS::runTasks()
+{
+    for( size_t i = m_nextTask.fetch_add( 1 );
+                i < m_taskCount && !m_cancelled;
+                i = m_nextTask.fetch_add( 1 ) )
+    {
+        m_task( i );
+    }
+
+    m_finishedThreads.fetch_add( 1 );
+}
@@ -47,6 +47,7 @@ GERBER_PLOTTER::GERBER_PLOTTER()
 {
     workFile  = NULL;
     finalFile = NULL;
+    m_apertureListPosition = 0;
     currentAperture = apertures.end();
     m_apertureAttribute = 0;
 
@@ -174,14 +175,18 @@ bool GERBER_PLOTTER::StartPlot()
 
     // Create a temporary filename to store gerber file
     // note tmpfile() does not work under Vista and W7 in user mode
+    // It is opened in binary mode: EndPlot() copies it in blocks, and the final
+    // file does the end of line conversion
     m_workFilename = filename + wxT(".tmp");
-    workFile   = wxFopen( m_workFilename, wxT( "wt" ));
+    workFile   = wxFopen( m_workFilename, wxT( "wb" ));
     outputFile = workFile;
     wxASSERT( outputFile );
 
     if( outputFile == NULL )
         return false;
 
+    setvbuf( outputFile, NULL, _IOFBF, PLOT_FILE_BUFFER_SIZE );
+
     for( unsigned ii = 0; ii < m_headerExtraLines.GetCount(); ii++ )
     {
         if( ! m_headerExtraLines[ii].IsEmpty() )
@@ -219,6 +224,7 @@ bool GERBER_PLOTTER::StartPlot()
     fputs( "G01*\n", outputFile );
 
     fputs( "G04 APERTURE LIST*\n", outputFile );
+    m_apertureListPosition = ftell( outputFile );
 
     return true;
 }
@@ -226,8 +232,9 @@ bool GERBER_PLOTTER::StartPlot()
 
 bool GERBER_PLOTTER::EndPlot()
 {
-    char     line[1024];
-    wxString msg;
+    char     buffer[16384];
+    size_t   count;
+    long     remaining;
 
     wxASSERT( outputFile );
 
@@ -236,22 +243,29 @@ bool GERBER_PLOTTER::EndPlot()
     fflush( outputFile );
 
     fclose( workFile );
-    workFile   = wxFopen( m_workFilename, wxT( "rt" ));
+    workFile   = wxFopen( m_workFilename, wxT( "rb" ));
     wxASSERT( workFile );
     outputFile = finalFile;
 
-    // Placement of apertures in RS274X
-    while( fgets( line, 1024, workFile ) )
+    // Copy the header, up to the aperture list
+    for( remaining = m_apertureListPosition; remaining > 0; remaining -= count )
     {
-        fputs( line, outputFile );
+        count = fread( buffer, 1, std::min<long>( remaining, sizeof( buffer ) ), workFile );
 
-        if( strcmp( strtok( line, "\n\r" ), "G04 APERTURE LIST*" ) == 0 )
-        {
-            writeApertureList();
-            fputs( "G04 APERTURE END LIST*\n", outputFile );
-        }
+        if( count == 0 )
+            break;
+
+        fwrite( buffer, 1, count, outputFile );
     }
 
+    // Placement of apertures in RS274X
+    writeApertureList();
+    fputs( "G04 APERTURE END LIST*\n", outputFile );
+
+    // Copy the plotted items
+    while( ( count = fread( buffer, 1, sizeof( buffer ), workFile ) ) > 0 )
+        fwrite( buffer, 1, count, outputFile );
+
     fclose( workFile );
     fclose( finalFile );
     ::wxRemoveFile( m_workFilename );
@@ -289,7 +303,8 @@ void GERBER_PLOTTER::SetCurrentLineWidth( int width, void* aData )
 
 
 std::vector<APERTURE>::iterator GERBER_PLOTTER::getAperture( const wxSize& aSize,
-                        APERTURE::APERTURE_TYPE aType, int aApertureAttribute )
+                        APERTURE::APERTURE_TYPE aType, int aApertureAttribute,
+                        int aMacroId, double aRotation )
 {
     int last_D_code = 9;
 
@@ -301,7 +316,8 @@ std::vector<APERTURE>::iterator GERBER_PLOTTER::getAperture( const wxSize& aSize
         last_D_code = tool->m_DCode;
 
         if( (tool->m_Type == aType) && (tool->m_Size == aSize) &&
-            (tool->m_ApertureAttribute == aApertureAttribute) )
+            (tool->m_ApertureAttribute == aApertureAttribute) &&
+            (tool->m_MacroId == aMacroId) && (tool->m_Rotation == aRotation) )
             return tool;
 
         ++tool;
@@ -313,6 +329,8 @@ std::vector<APERTURE>::iterator GERBER_PLOTTER::getAperture( const wxSize& aSize
     new_tool.m_Type  = aType;
     new_tool.m_DCode = last_D_code + 1;
     new_tool.m_ApertureAttribute = aApertureAttribute;
+    new_tool.m_MacroId = aMacroId;
+    new_tool.m_Rotation = aRotation;
 
     apertures.push_back( new_tool );
 
@@ -322,11 +340,14 @@ std::vector<APERTURE>::iterator GERBER_PLOTTER::getAperture( const wxSize& aSize
 
 void GERBER_PLOTTER::selectAperture( const wxSize&           aSize,
                                      APERTURE::APERTURE_TYPE aType,
-                                     int aApertureAttribute )
+                                     int aApertureAttribute,
+                                     int aMacroId, double aRotation )
 {
     bool change = ( currentAperture == apertures.end() ) ||
                   ( currentAperture->m_Type != aType ) ||
-                  ( currentAperture->m_Size != aSize );
+                  ( currentAperture->m_Size != aSize ) ||
+                  ( currentAperture->m_MacroId != aMacroId ) ||
+                  ( currentAperture->m_Rotation != aRotation );
 
     if( m_useX2Attributes && !m_useNetAttributes )
         aApertureAttribute = 0;
@@ -336,12 +357,70 @@ void GERBER_PLOTTER::selectAperture( const wxSize&           aSize,
     if( change )
     {
         // Pick an existing aperture or create a new one
-        currentAperture = getAperture( aSize, aType, aApertureAttribute );
+        currentAperture = getAperture( aSize, aType, aApertureAttribute, aMacroId, aRotation );
         fprintf( outputFile, "D%d*\n", currentAperture->m_DCode );
     }
 }
 
 
+int GERBER_PLOTTER::getApertureMacro( const std::vector< std::vector<wxPoint> >& aOutlines )
+{
+    size_t hash = aOutlines.size();
+
+    for( const std::vector<wxPoint>& outline : aOutlines )
+    {
+        for( const wxPoint& corner : outline )
+        {
+            hash = hash * 31 + std::hash<int>()( corner.x );
+            hash = hash * 31 + std::hash<int>()( corner.y );
+        }
+    }
+
+    auto range = m_apertureMacroIndex.equal_range( hash );
+
+    for( auto it = range.first; it != range.second; ++it )
+    {
+        if( m_apertureMacros[it->second].m_Outlines == aOutlines )
+            return it->second;
+    }
+
+    GBR_APERTURE_MACRO macro;
+    macro.m_Outlines = aOutlines;
+    m_apertureMacros.push_back( macro );
+
+    int macroId = m_apertureMacros.size() - 1;
+    m_apertureMacroIndex.insert( std::make_pair( hash, macroId ) );
+
+    return macroId;
+}
+
+
+void GERBER_PLOTTER::flashPadMacro( const wxPoint& aPadPos,
+                                    const std::vector< std::vector<wxPoint> >& aOutlines,
+                                    double aOrient, void* aData )
+{
+    GBR_METADATA* gbr_metadata = static_cast<GBR_METADATA*>( aData );
+    DPOINT pos_dev = userToDeviceCoordinates( aPadPos );
+    int aperture_attrib = gbr_metadata ? gbr_metadata->GetApertureAttrib() : 0;
+
+    // The Y axis of the Gerber files is bottom to top, so a counterclockwise
+    // rotation on the board is a counterclockwise rotation in the file
+    NORMALIZE_ANGLE_POS( aOrient );
+    double rotation = ( m_yaxisReversed ? 3600.0 - aOrient : aOrient ) / 10.0;
+
+    if( rotation >= 360.0 )
+        rotation -= 360.0;
+
+    selectAperture( wxSize( 0, 0 ), APERTURE::Macro, aperture_attrib,
+                    getApertureMacro( aOutlines ), rotation );
+
+    if( gbr_metadata )
+        formatNetAttribute( &gbr_metadata->m_NetlistMetadata );
+
+    emitDcode( pos_dev, 3 );
+}
+
+
 void GERBER_PLOTTER::writeApertureList()
 {
     wxASSERT( outputFile );
@@ -352,6 +431,37 @@ void GERBER_PLOTTER::writeApertureList()
     if( !m_useX2Attributes )
         useX1StructuredComment = true;
 
+    // The pad shapes: one outline primitive by polygon, rotated by the
+    // first parameter of the aperture
+    double macroScale = 0.0001 * plotScale / m_IUsPerDecimil;
+
+    if( !m_gerberUnitInch )
+        macroScale *= 25.4;
+
+    double macroScaleY = m_yaxisReversed ? macroScale : -macroScale;
+
+    for( unsigned ii = 0; ii < m_apertureMacros.size(); ++ii )
+    {
+        fprintf( outputFile, "%%AMKiPadShape%u*\n", ii );
+
+        for( const std::vector<wxPoint>& outline : m_apertureMacros[ii].m_Outlines )
+        {
+            // The outline must be closed: the first corner is repeated
+            fprintf( outputFile, "4,1,%u,", (unsigned) outline.size() );
+
+            for( unsigned jj = 0; jj <= outline.size(); ++jj )
+            {
+                const wxPoint& corner = outline[ jj % outline.size() ];
+                fprintf( outputFile, "\n%#f,%#f,",
+                         corner.x * macroScale, corner.y * macroScaleY );
+            }
+
+            fputs( "\n$1*\n", outputFile );
+        }
+
+        fputs( "%\n", outputFile );
+    }
+
     // Init
     for( std::vector<APERTURE>::iterator tool = apertures.begin();
          tool != apertures.end(); ++tool )
@@ -402,6 +512,10 @@ void GERBER_PLOTTER::writeApertureList()
 	            tool->m_Size.x * fscale,
 		    tool->m_Size.y * fscale );
             break;
+
+        case APERTURE::Macro:
+            sprintf( text, "KiPadShape%d,%#f*%%\n", tool->m_MacroId, tool->m_Rotation );
+            break;
         }
 
         fputs( cbuf, outputFile );
@@ -790,9 +904,8 @@ void GERBER_PLOTTER::FlashPadRect( const wxPoint& pos, const wxSize& aSize,
         }
         break;
 
-    default: // plot pad shape as polygon
+    default: // plot pad shape as trapezoid (flashed with an aperture macro)
 	{
-	    // XXX to do: use an aperture macro to declare the rotated pad
 	    wxPoint coord[4];
 	    // coord[0] is assumed the lower left
 	    // coord[1] is assumed the upper left
@@ -820,6 +933,27 @@ void GERBER_PLOTTER::FlashPadRoundRect( const wxPoint& aPadPos, const wxSize& aS
                                      EDA_DRAW_MODE_T aTraceMode, void* aData )
 
 {
+    const int segmentToCircleCount = 64;
+
+    if( aTraceMode == FILLED )
+    {
+        // Flash the not rotated shape, built around the pad position
+        SHAPE_POLY_SET outline;
+        TransformRoundRectToPolygon( outline, wxPoint( 0, 0 ), aSize, 0.0,
+                                     aCornerRadius, segmentToCircleCount );
+
+        // TransformRoundRectToPolygon creates only one convex polygon
+        SHAPE_LINE_CHAIN& poly = outline.Outline( 0 );
+        std::vector< std::vector<wxPoint> > shape( 1 );
+        shape[0].reserve( poly.PointCount() );
+
+        for( int ii = 0; ii < poly.PointCount(); ++ii )
+            shape[0].push_back( wxPoint( poly.Point( ii ).x, poly.Point( ii ).y ) );
+
+        flashPadMacro( aPadPos, shape, aOrient, aData );
+        return;
+    }
+
     GBR_METADATA gbr_metadata;
 
     if( aData )
@@ -834,18 +968,13 @@ void GERBER_PLOTTER::FlashPadRoundRect( const wxPoint& aPadPos, const wxSize& aS
         gbr_metadata.m_NetlistMetadata.ClearAttribute( &attrname );   // not allowed on inner layers
     }
 
-    if( aTraceMode != FILLED )
-        SetCurrentLineWidth( USE_DEFAULT_LINE_WIDTH, &gbr_metadata );
+    SetCurrentLineWidth( USE_DEFAULT_LINE_WIDTH, &gbr_metadata );
 
-    // Currently, a Pad RoundRect is plotted as polygon.
-    // TODO: use Aperture macro and flash it
     SHAPE_POLY_SET outline;
-    const int segmentToCircleCount = 64;
     TransformRoundRectToPolygon( outline, aPadPos, aSize, aOrient,
                                  aCornerRadius, segmentToCircleCount );
 
-    if( aTraceMode != FILLED )
-        outline.Inflate( -GetCurrentLineWidth()/2, 16 );
+    outline.Inflate( -GetCurrentLineWidth()/2, 16 );
 
     std::vector< wxPoint > cornerList;
     // TransformRoundRectToPolygon creates only one convex polygon
@@ -858,16 +987,7 @@ void GERBER_PLOTTER::FlashPadRoundRect( const wxPoint& aPadPos, const wxSize& aS
     // Close polygon
     cornerList.push_back( cornerList[0] );
 
-    PlotPoly( cornerList, aTraceMode == FILLED ? FILLED_SHAPE : NO_FILL,
-              aTraceMode == FILLED ? 0 : GetCurrentLineWidth(), &gbr_metadata );
-
-    // Now, flash a pad anchor, if a netlist attribute is set
-    // (remove me when a Aperture macro will be used)
-    if( aData && aTraceMode == FILLED )
-    {
-        int diameter = std::min( aSize.x, aSize.y );
-        FlashPadCircle( aPadPos, diameter, aTraceMode , aData );
-    }
+    PlotPoly( cornerList, NO_FILL, GetCurrentLineWidth(), &gbr_metadata );
 }
 
 void GERBER_PLOTTER::FlashPadCustom( const wxPoint& aPadPos, const wxSize& aSize,
@@ -875,9 +995,37 @@ void GERBER_PLOTTER::FlashPadCustom( const wxPoint& aPadPos, const wxSize& aSize
                                      EDA_DRAW_MODE_T aTraceMode, void* aData )
 
 {
-    // A Pad custom is plotted as polygon.
+    // The outline primitive of the aperture macros has a limited number of vertices:
+    // pads having a larger polygon are plotted as regions.
+    bool fitsMacro = true;
+
+    for( int cnt = 0; cnt < aPolygons->OutlineCount(); ++cnt )
+    {
+        if( aPolygons->COutline( cnt ).PointCount() > GBR_MACRO_OUTLINE_MAX_VERTICES )
+            fitsMacro = false;
+    }
+
+    if( aTraceMode == FILLED && fitsMacro )
+    {
+        // aPolygons is already rotated: the shape is flashed without rotation,
+        // so only the pads having the same orientation share the same macro
+        std::vector< std::vector<wxPoint> > shape( aPolygons->OutlineCount() );
+
+        for( int cnt = 0; cnt < aPolygons->OutlineCount(); ++cnt )
+        {
+            const SHAPE_LINE_CHAIN& poly = aPolygons->COutline( cnt );
+            shape[cnt].reserve( poly.PointCount() );
+
+            for( int ii = 0; ii < poly.PointCount(); ++ii )
+                shape[cnt].push_back( wxPoint( poly.CPoint( ii ).x, poly.CPoint( ii ).y )
+                                      - aPadPos );
+        }
 
-    // A flashed circle @aPadPos is added (anchor pad)
+        flashPadMacro( aPadPos, shape, 0.0, aData );
+        return;
+    }
+
+    // A flashed circle @aPadPos is added to the regions (anchor pad)
     // However, because the anchor pad can be circle or rect, we use only
     // a circle not bigger than the rect.
     // the main purpose is to print a flashed DCode as pad anchor
@@ -931,35 +1079,17 @@ void GERBER_PLOTTER::FlashPadTrapez( const wxPoint& aPadPos,  const wxPoint* aCo
                                      double aPadOrient, EDA_DRAW_MODE_T aTrace_Mode, void* aData )
 
 {
-    // Currently, a Pad Trapezoid is plotted as polygon.
-    // TODO: use Aperture macro and flash it
-
     // polygon corners list
-    std::vector< wxPoint > cornerList;
-
-    for( int ii = 0; ii < 4; ii++ )
-        cornerList.push_back( aCorners[ii] );
+    std::vector< wxPoint > cornerList( aCorners, aCorners + 4 );
 
-    // Now, flash a pad anchor, if a netlist attribute is set
-    // (remove me when a Aperture macro will be used)
-    if( aData && ( aTrace_Mode == FILLED ) )
+    if( aTrace_Mode == FILLED )
     {
-        // Calculate the radius of the circle inside the shape
-        // It is the smaller dist from shape pos to edges
-        int radius = INT_MAX;
-
-        for( unsigned ii = 0, jj = cornerList.size()-1; ii < cornerList.size();
-             jj = ii, ii++ )
-        {
-            SEG segment( aCorners[ii], aCorners[jj] );
-            int dist = segment.LineDistance( VECTOR2I( 0, 0) );
-            radius = std::min( radius, dist );
-        }
-
-        FlashPadCircle( aPadPos, radius*2, aTrace_Mode, aData );
+        flashPadMacro( aPadPos, std::vector< std::vector<wxPoint> >( 1, cornerList ),
+                       aPadOrient, aData );
+        return;
     }
 
-    // Draw the polygon and fill the interior as required
+    // Draw the outline
     for( unsigned ii = 0; ii < 4; ii++ )
     {
         RotatePoint( &cornerList[ii], aPadOrient );
@@ -985,9 +1115,7 @@ void GERBER_PLOTTER::FlashPadTrapez( const wxPoint& aPadPos,  const wxPoint* aCo
     }
 
     SetCurrentLineWidth( USE_DEFAULT_LINE_WIDTH, &metadata );
-    PlotPoly( cornerList, aTrace_Mode == FILLED ? FILLED_SHAPE : NO_FILL,
-              aTrace_Mode == FILLED ? 0 : GetCurrentLineWidth(),
-              &metadata );
+    PlotPoly( cornerList, NO_FILL, GetCurrentLineWidth(), &metadata );
 }
 
 
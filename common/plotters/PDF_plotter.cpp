@@ -58,6 +58,8 @@ bool PDF_PLOTTER::OpenFile( const wxString& aFullFilename )
     if( outputFile == NULL )
         return false ;
 
+    setvbuf( outputFile, NULL, _IOFBF, PLOT_FILE_BUFFER_SIZE );
+
     return true;
 }
 
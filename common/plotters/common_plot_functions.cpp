@@ -38,6 +38,8 @@
 #include "worksheet_dataitem.h"
 #include <wx/filename.h>
 
+#include <mutex>
+
 
 
 wxString GetDefaultPlotExtension( PlotFormat aFormat )
@@ -75,6 +77,13 @@ void PlotWorkSheet( PLOTTER* plotter, const TITLE_BLOCK& aTitleBlock,
                     int aSheetNumber, int aNumberOfSheets,
                     const wxString &aSheetDesc, const wxString &aFilename )
 {
+    // The draw list is built from the items of the global WORKSHEET_LAYOUT and the
+    // static WORKSHEET_DATAITEM parameters, which it modifies, and the bitmaps are
+    // plotted from the layout items: plots running in worker threads draw their
+    // worksheet one at a time
+    static std::mutex worksheetMutex;
+    std::lock_guard<std::mutex> lock( worksheetMutex );
+
     /* Note: Page sizes values are given in mils
      */
     double   iusPerMil = plotter->GetIUsPerDecimil() * 10.0;
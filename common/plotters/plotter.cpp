@@ -89,6 +89,8 @@ bool PLOTTER::OpenFile( const wxString& aFullFilename )
     if( outputFile == NULL )
         return false ;
 
+    setvbuf( outputFile, NULL, _IOFBF, PLOT_FILE_BUFFER_SIZE );
+
     return true;
 }
 
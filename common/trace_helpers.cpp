@@ -46,6 +46,7 @@ const wxChar* const traceKicadPcbPlugin = wxT( "KICAD_PCB_PLUGIN" );
 const wxChar* const tracePrinting = wxT( "KICAD_PRINT" );
 const wxChar* const traceAutoSave = wxT( "KICAD_AUTOSAVE" );
 const wxChar* const tracePathsAndFiles = wxT( "KICAD_PATHS_AND_FILES" );
+const wxChar* const traceArenaStats = wxT( "KICAD_ARENA_STATS" );
 
 
 wxString dump( const wxArrayString& aArray )
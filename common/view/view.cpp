@@ -41,6 +41,10 @@
 #include <profile.h>
 #endif /* __WXDEBUG__  */
 
+#include <atomic>
+#include <cmath>
+#include <thread>
+
 namespace KIGFX {
 
 class VIEW;
@@ -177,6 +181,65 @@ private:
         delete[] m_groups;
         m_groups = nullptr;
         m_groupsSize = 0;
+        m_proxyGroups.clear();
+    }
+
+
+    ///> Special proxy group ids
+    enum PROXY_STATE
+    {
+        PROXY_PENDING = -2,     ///< The group is to be created by VIEW::UpdateItems()
+        PROXY_NONE    = -3      ///< The painter has no proxy for the layer
+    };
+
+    ///> Cached GAL display lists of the simplified representations of the item (see
+    ///> VIEW_ITEM::ViewGetProxyLOD()), with the same layout as m_groups.  The group id can also
+    ///> be PROXY_PENDING or PROXY_NONE.
+    std::vector<GroupPair> m_proxyGroups;
+
+    /**
+     * Function getProxyGroup()
+     * Returns the proxy group id for the given layer, or -1 if the proxy was never drawn.
+     */
+    int getProxyGroup( int aLayer ) const
+    {
+        for( const GroupPair& proxy : m_proxyGroups )
+        {
+            if( proxy.first == aLayer )
+                return proxy.second;
+        }
+
+        return -1;
+    }
+
+    void setProxyGroup( int aLayer, int aGroup )
+    {
+        for( GroupPair& proxy : m_proxyGroups )
+        {
+            if( proxy.first == aLayer )
+            {
+                proxy.second = aGroup;
+                return;
+            }
+        }
+
+        m_proxyGroups.emplace_back( aLayer, aGroup );
+    }
+
+    /**
+     * Function deleteProxyGroups()
+     * Removes the proxy groups of all the layers, so they are drawn again when needed.
+     * Proxies depend on the item geometry, color and layer depth.
+     */
+    void deleteProxyGroups( GAL* aGal )
+    {
+        for( const GroupPair& proxy : m_proxyGroups )
+        {
+            if( proxy.second >= 0 )
+                aGal->DeleteGroup( proxy.second );
+        }
+
+        m_proxyGroups.clear();
     }
 
 
@@ -213,6 +276,14 @@ private:
 
             m_groups[i].first = new_layer;
         }
+
+        for( GroupPair& proxy : m_proxyGroups )
+        {
+            auto it = aReorderMap.find( proxy.first );
+
+            if( it != aReorderMap.end() )
+                proxy.first = it->second;
+        }
     }
 
 
@@ -285,10 +356,14 @@ void VIEW::OnDestroy( VIEW_ITEM* aItem )
 VIEW::VIEW( bool aIsDynamic ) :
     m_enableOrderModifier( true ),
     m_scale( 4.0 ),
+    m_proxyThreshold( 3.0 ),
+    m_pendingProxies( false ),
+    m_proxyScaleLevel( 2 ),
     m_minScale( 4.0 ), m_maxScale( 75000.0 ),
     m_mirrorX( false ), m_mirrorY( false ),
     m_painter( NULL ),
     m_gal( NULL ),
+    m_useGeometryWorkers( true ),
     m_dynamic( aIsDynamic ),
     m_useDrawPriority( false ),
     m_nextDrawPriority( 0 ),
@@ -398,6 +473,7 @@ void VIEW::Remove( VIEW_ITEM* aItem )
             m_gal->DeleteGroup( prevGroup );
     }
 
+    viewData->deleteProxyGroups( m_gal );
     viewData->deleteGroups();
     viewData->m_view = nullptr;
 }
@@ -510,6 +586,10 @@ void VIEW::SetGAL( GAL* aGal )
 {
     m_gal = aGal;
 
+    // worker GALs are created by the GAL they upload to
+    m_geometryWorkers.clear();
+    m_useGeometryWorkers = true;
+
     // clear group numbers, so everything is going to be recached
     clearGroupCache();
 
@@ -523,6 +603,15 @@ void VIEW::SetGAL( GAL* aGal )
 }
 
 
+void VIEW::SetPainter( PAINTER* aPainter )
+{
+    m_painter = aPainter;
+
+    m_geometryWorkers.clear();
+    m_useGeometryWorkers = true;
+}
+
+
 BOX2D VIEW::GetViewport() const
 {
     BOX2D    rect;
@@ -581,11 +670,38 @@ void VIEW::SetScale( double aScale, const VECTOR2D& aAnchor )
 
     SetCenter( m_center - delta );
 
+    // Proxies may be simplified for the scale (e.g. zone fills): they are drawn again each
+    // time the scale doubles or halves
+    int proxyScaleLevel = (int) std::floor( std::log2( m_scale ) );
+
+    if( proxyScaleLevel != m_proxyScaleLevel )
+    {
+        m_proxyScaleLevel = proxyScaleLevel;
+
+        for( VIEW_ITEM* item : m_allItems )
+        {
+            if( item->viewPrivData() )
+                item->viewPrivData()->deleteProxyGroups( m_gal );
+        }
+    }
+
     // Redraw everything after the viewport has changed
     MarkDirty();
 }
 
 
+double VIEW::GetProxyScale( double aSize ) const
+{
+    if( m_proxyThreshold <= 0.0 || aSize <= 0.0 || !m_gal )
+        return 0.0;
+
+    // GAL world scale is proportional to the zoom factor, which is the VIEW scale
+    double pixelsPerUnit = m_gal->GetWorldScale() / m_gal->GetZoomFactor();
+
+    return m_proxyThreshold / ( pixelsPerUnit * aSize );
+}
+
+
 void VIEW::SetCenter( const VECTOR2D& aCenter )
 {
     m_center = aCenter;
@@ -752,6 +868,8 @@ struct VIEW::updateItemsColor
         if( group >= 0 )
             gal->ChangeGroupColor( group, color );
 
+        aItem->viewPrivData()->deleteProxyGroups( gal );
+
         return true;
     }
 
@@ -801,6 +919,8 @@ void VIEW::UpdateAllLayersColor()
             if( group >= 0 )
                 m_gal->ChangeGroupColor( group, color );
         }
+
+        viewData->deleteProxyGroups( m_gal );
     }
 
     m_gal->EndUpdate();
@@ -822,6 +942,8 @@ struct VIEW::changeItemsDepth
         if( group >= 0 )
             gal->ChangeGroupDepth( group, depth );
 
+        aItem->viewPrivData()->deleteProxyGroups( gal );
+
         return true;
     }
 
@@ -928,6 +1050,8 @@ void VIEW::UpdateAllLayersOrder()
             if( group >= 0 )
                 m_gal->ChangeGroupDepth( group, m_layers[layers[i]].renderingOrder );
         }
+
+        viewData->deleteProxyGroups( m_gal );
     }
 
     m_gal->EndUpdate();
@@ -1012,6 +1136,10 @@ void VIEW::draw( VIEW_ITEM* aItem, int aLayer, bool aImmediate )
     if( !viewData )
         return;
 
+    // Items too small to show their details are drawn as proxies
+    if( aItem->ViewGetProxyLOD( aLayer, this ) > m_scale && drawProxy( aItem, aLayer, aImmediate ) )
+        return;
+
     if( IsCached( aLayer ) && !aImmediate )
     {
         // Draw using cached information or create one
@@ -1031,6 +1159,82 @@ void VIEW::draw( VIEW_ITEM* aItem, int aLayer, bool aImmediate )
 }
 
 
+bool VIEW::drawProxy( VIEW_ITEM* aItem, int aLayer, bool aImmediate )
+{
+    auto viewData = aItem->viewPrivData();
+
+    if( !IsCached( aLayer ) || aImmediate )
+        return m_painter->DrawProxy( aItem, aLayer );
+
+    int group = viewData->getProxyGroup( aLayer );
+
+    if( group >= 0 )
+    {
+        m_gal->DrawGroup( group );
+        return true;
+    }
+
+    if( group == VIEW_ITEM_DATA::PROXY_NONE )
+        return false;
+
+    if( group == -1 )
+    {
+        // Groups cannot be created while drawing: the proxy is drawn without caching this
+        // time, and its group is created by the next UpdateItems()
+        RENDER_TARGET target = m_gal->GetTarget();
+
+        m_gal->SetTarget( TARGET_NONCACHED );
+        bool drawn = m_painter->DrawProxy( aItem, aLayer );
+        m_gal->SetTarget( target );
+
+        viewData->setProxyGroup( aLayer, drawn ? VIEW_ITEM_DATA::PROXY_PENDING
+                                               : VIEW_ITEM_DATA::PROXY_NONE );
+        m_pendingProxies |= drawn;
+
+        return drawn;
+    }
+
+    // Pending: the item was drawn as a proxy in an earlier frame, but not updated since
+    RENDER_TARGET target = m_gal->GetTarget();
+
+    m_gal->SetTarget( TARGET_NONCACHED );
+    m_painter->DrawProxy( aItem, aLayer );
+    m_gal->SetTarget( target );
+    m_pendingProxies = true;
+
+    return true;
+}
+
+
+void VIEW::updateProxyGroups( VIEW_ITEM* aItem )
+{
+    auto viewData = aItem->viewPrivData();
+
+    for( auto& proxy : viewData->m_proxyGroups )
+    {
+        if( proxy.second != VIEW_ITEM_DATA::PROXY_PENDING )
+            continue;
+
+        VIEW_LAYER& l = m_layers.at( proxy.first );
+
+        m_gal->SetTarget( l.target );
+        m_gal->SetLayerDepth( l.renderingOrder );
+
+        int group = m_gal->BeginGroup();
+        bool drawn = m_painter->DrawProxy( aItem, proxy.first );
+        m_gal->EndGroup();
+
+        if( !drawn )
+        {
+            m_gal->DeleteGroup( group );
+            group = VIEW_ITEM_DATA::PROXY_NONE;
+        }
+
+        proxy.second = group;
+    }
+}
+
+
 void VIEW::draw( VIEW_ITEM* aItem, bool aImmediate )
 {
     int layers[VIEW_MAX_LAYERS], layers_count;
@@ -1076,6 +1280,10 @@ struct VIEW::recacheItem
             gal->DeleteGroup( group );
 
         viewData->setGroup( layer, -1 );
+        viewData->deleteProxyGroups( gal );
+
+        // The geometry is not drawn here: UpdateItems() queues the item layers and draws
+        // them at once, in the geometry workers when there are enough of them
         view->Update( aItem );
 
         return true;
@@ -1206,6 +1414,10 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
         }
     }
 
+    // Proxies are drawn again from the new geometry when needed
+    if( aUpdateFlags & ( GEOMETRY | LAYERS | REPAINT | COLOR ) )
+        aItem->viewPrivData()->deleteProxyGroups( m_gal );
+
     int layers[VIEW_MAX_LAYERS], layers_count;
     aItem->ViewGetLayers( layers, layers_count );
 
@@ -1216,8 +1428,9 @@ void VIEW::invalidateItem( VIEW_ITEM* aItem, int aUpdateFlags )
 
         if( IsCached( layerId ) )
         {
+            // Geometry is regenerated for all the invalidated items at once
             if( aUpdateFlags & ( GEOMETRY | LAYERS | REPAINT ) )
-                updateItemGeometry( aItem, layerId );
+                m_pendingGeometry.emplace_back( aItem, layerId );
             else if( aUpdateFlags & COLOR )
                 updateItemColor( aItem, layerId );
         }
@@ -1294,6 +1507,124 @@ void VIEW::updateItemGeometry( VIEW_ITEM* aItem, int aLayer )
 }
 
 
+/// Number of item layers to update above which generating geometry in worker threads pays off
+static const size_t MIN_PARALLEL_GEOMETRY_UPDATES = 512;
+
+
+void VIEW::updatePendingGeometry()
+{
+    if( m_pendingGeometry.size() < MIN_PARALLEL_GEOMETRY_UPDATES || !prepareGeometryWorkers() )
+    {
+        for( const auto& pending : m_pendingGeometry )
+            updateItemGeometry( pending.first, pending.second );
+
+        m_pendingGeometry.clear();
+        return;
+    }
+
+    // Worker index and recorded group number for each pending item layer. Group number is -1
+    // if the painter could not draw the item.
+    std::vector<std::pair<size_t, int>> recorded( m_pendingGeometry.size() );
+    std::atomic<size_t> nextItem( 0 );
+    std::vector<std::thread> threads;
+
+    for( size_t ii = 0; ii < m_geometryWorkers.size(); ++ii )
+    {
+        threads.emplace_back( [ &, ii ]()
+        {
+            GAL*     gal = m_geometryWorkers[ii].gal.get();
+            PAINTER* painter = m_geometryWorkers[ii].painter.get();
+
+            for( size_t i = nextItem.fetch_add( 1 );
+                    i < m_pendingGeometry.size();
+                    i = nextItem.fetch_add( 1 ) )
+            {
+                VIEW_ITEM* item = m_pendingGeometry[i].first;
+                int layer = m_pendingGeometry[i].second;
+
+                gal->SetLayerDepth( m_layers.at( layer ).renderingOrder );
+
+                int group = gal->BeginGroup();
+                bool drawn = painter->Draw( static_cast<EDA_ITEM*>( item ), layer );
+                gal->EndGroup();
+
+                recorded[i] = std::make_pair( ii, drawn ? group : -1 );
+            }
+        } );
+    }
+
+    for( std::thread& thread : threads )
+        thread.join();
+
+    // Only the thread owning the GAL may upload the geometry
+    for( size_t i = 0; i < m_pendingGeometry.size(); ++i )
+    {
+        VIEW_ITEM* item = m_pendingGeometry[i].first;
+        int layer = m_pendingGeometry[i].second;
+
+        if( recorded[i].second < 0 )
+        {
+            // Alternative drawing method (VIEW_ITEM::ViewDraw()) may use the VIEW
+            updateItemGeometry( item, layer );
+            continue;
+        }
+
+        auto viewData = item->viewPrivData();
+        int group = viewData->getGroup( layer );
+
+        if( group >= 0 )
+            m_gal->DeleteGroup( group );
+
+        GAL* recorder = m_geometryWorkers[recorded[i].first].gal.get();
+        viewData->setGroup( layer, m_gal->UploadGroup( recorder, recorded[i].second ) );
+    }
+
+    for( GEOMETRY_WORKER& worker : m_geometryWorkers )
+        worker.gal->ClearCache();
+
+    m_pendingGeometry.clear();
+}
+
+
+bool VIEW::prepareGeometryWorkers()
+{
+    if( !m_useGeometryWorkers || !m_gal || !m_painter )
+        return false;
+
+    if( m_geometryWorkers.empty() )
+    {
+        size_t workerCount = std::max<size_t>( std::thread::hardware_concurrency(), 2 );
+
+        for( size_t ii = 0; ii < workerCount; ++ii )
+        {
+            GEOMETRY_WORKER worker;
+            worker.gal.reset( m_gal->CreateGroupRecorder() );
+
+            if( worker.gal )
+                worker.painter.reset( m_painter->Clone( worker.gal.get() ) );
+
+            if( !worker.painter )
+            {
+                // The GAL or the painter may be used only by the main thread
+                m_geometryWorkers.clear();
+                m_useGeometryWorkers = false;
+                return false;
+            }
+
+            m_geometryWorkers.push_back( std::move( worker ) );
+        }
+    }
+
+    for( GEOMETRY_WORKER& worker : m_geometryWorkers )
+    {
+        worker.gal->CopyViewSettings( *m_gal );
+        worker.painter->ApplySettings( m_painter->GetSettings() );
+    }
+
+    return true;
+}
+
+
 void VIEW::updateBbox( VIEW_ITEM* aItem )
 {
     int layers[VIEW_MAX_LAYERS], layers_count;
@@ -1406,8 +1737,15 @@ void VIEW::UpdateItems()
             invalidateItem( item, viewData->m_requiredUpdate );
             viewData->m_requiredUpdate = NONE;
         }
+
+        if( m_pendingProxies )
+            updateProxyGroups( item );
     }
 
+    m_pendingProxies = false;
+
+    updatePendingGeometry();
+
     m_gal->EndUpdate();
 }
 
@@ -140,6 +140,7 @@ void SCH_EDIT_FRAME::HandleBlockPlace( wxDC* DC )
         {
             SCH_ITEM* item = dynamic_cast<SCH_ITEM*>( block->GetItems().GetPickedItem( ii ) );
             item->Move( block->GetMoveVector() );
+            GetScreen()->UpdateItem( item );
             GetCanvas()->GetView()->Update( item, KIGFX::GEOMETRY );
         }
         break;
@@ -479,7 +479,7 @@ void SCH_EDIT_FRAME::SaveWireImage()
 
             SCH_ITEM* item_copy = static_cast<SCH_ITEM*>( item->Clone() );
 
-            GetScreen()->GetDrawList().Insert( item_copy, next_item );
+            GetScreen()->Insert( item_copy, next_item );
             GetCanvas()->GetView()->Add( item_copy );
         }
     }
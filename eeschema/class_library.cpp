@@ -158,6 +158,15 @@ void PART_LIB::GetAliases( std::vector<LIB_ALIAS*>& aAliases ) const
 {
     m_plugin->EnumerateSymbolLib( aAliases, fileName.GetFullPath(), m_properties.get() );
 
+    // Set the LIB_PART m_library member, it will only be used when loading legacy
+    // libraries.  Once the symbols in the schematic have a full #LIB_ID, this will
+    // not get called.
+    for( LIB_ALIAS* alias : aAliases )
+    {
+        if( alias->GetPart() && !alias->GetPart()->GetLib() )
+            alias->GetPart()->SetLib( const_cast<PART_LIB*>( this ) );
+    }
+
     std::sort( aAliases.begin(), aAliases.end(),
             [](LIB_ALIAS *lhs, LIB_ALIAS *rhs) -> bool
                 { return lhs->GetName() < rhs->GetName(); });
@@ -299,20 +308,9 @@ PART_LIB* PART_LIB::LoadLibrary( const wxString& aFileName )
 {
     std::unique_ptr<PART_LIB> lib( new PART_LIB( LIBRARY_TYPE_EESCHEMA, aFileName ) );
 
-    std::vector<LIB_ALIAS*> aliases;
-    // This loads the library.
-    lib->GetAliases( aliases );
-
-    // Now, set the LIB_PART m_library member but it will only be used
-    // when loading legacy libraries in the future. Once the symbols in the
-    // schematic have a full #LIB_ID, this will not get called.
-    for( size_t ii = 0; ii < aliases.size(); ii++ )
-    {
-        LIB_ALIAS* alias = aliases[ii];
-
-        if( alias->GetPart() )
-            alias->GetPart()->SetLib( lib.get() );
-    }
+    // This loads the library index.  The parts are read when they are used, and
+    // FindAlias() and GetAliases() set their LIB_PART m_library member.
+    lib->GetCount();
 
     PART_LIB* ret = lib.release();
     return ret;
@@ -481,7 +479,7 @@ void PART_LIBS::FindLibraryNearEntries( std::vector<LIB_ALIAS*>& aCandidates,
 }
 
 
-int PART_LIBS::s_modify_generation = 1;     // starts at 1 and goes up
+std::atomic<int> PART_LIBS::s_modify_generation( 1 );     // starts at 1 and goes up
 
 
 int PART_LIBS::GetModifyHash()
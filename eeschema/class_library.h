@@ -39,6 +39,7 @@
 #include <project.h>
 
 #include <map>
+#include <atomic>
 
 class LIB_ID;
 class LINE_READER;
@@ -191,7 +192,9 @@ class PART_LIBS : public PART_LIBS_BASE, public PROJECT::_ELEM
 public:
     KICAD_T Type() override { return PART_LIBS_T; }
 
-    static int s_modify_generation;         ///< helper for GetModifyHash()
+    /// helper for GetModifyHash(), atomic because the symbol libraries are read by
+    /// worker threads
+    static std::atomic<int> s_modify_generation;
 
     PART_LIBS()
     {
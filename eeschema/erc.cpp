@@ -39,10 +39,15 @@
 #include <erc.h>
 #include <sch_marker.h>
 #include <sch_sheet.h>
+#include <sch_component.h>
 #include <sch_reference_list.h>
+#include <parallel_tasks.h>
 
 #include <wx/ffile.h>
 
+#include <algorithm>
+#include <unordered_map>
+
 
 /* ERC tests :
  *  1 - conflicts between connected pins ( example: 2 connected outputs )
@@ -291,8 +296,17 @@ int TestMultiunitFootprints( SCH_SHEET_LIST& aSheetList )
 }
 
 
+void ERC_MARKER_LIST::AppendToScreens()
+{
+    for( auto& marker : m_markers )
+        marker.first->Append( marker.second );
+
+    m_markers.clear();
+}
+
+
 void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst,
-               int aMinConn, int aDiag )
+               int aMinConn, int aDiag, ERC_MARKER_LIST* aMarkers )
 {
     SCH_MARKER*     marker = NULL;
     SCH_SCREEN*     screen;
@@ -308,7 +322,11 @@ void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst,
     marker->SetMarkerType( MARKER_BASE::MARKER_ERC );
     marker->SetErrorLevel( MARKER_BASE::MARKER_SEVERITY_WARNING );
     screen = aNetItemRef->m_SheetPath.LastScreen();
-    screen->Append( marker );
+
+    if( aMarkers )
+        aMarkers->Add( screen, marker );
+    else
+        screen->Append( marker );
 
     wxString msg;
 
@@ -429,7 +447,7 @@ void Diagnose( NETLIST_OBJECT* aNetItemRef, NETLIST_OBJECT* aNetItemTst,
 
 void TestOthersItems( NETLIST_OBJECT_LIST* aList,
                       unsigned aNetItemRef, unsigned aNetStart,
-                      int* aMinConnexion )
+                      int* aMinConnexion, ERC_MARKER_LIST* aMarkers )
 {
     unsigned netItemTst = aNetStart;
     ELECTRICAL_PINTYPE jj;
@@ -504,7 +522,8 @@ void TestOthersItems( NETLIST_OBJECT_LIST* aList,
                 }
 
                 if( seterr )
-                    Diagnose( aList->GetItem( aNetItemRef ), NULL, local_minconn, WAR );
+                    Diagnose( aList->GetItem( aNetItemRef ), NULL, local_minconn, WAR,
+                              aMarkers );
 
                 *aMinConnexion = DRV;   // inhibiting other messages of this
                                        // type for the net.
@@ -550,7 +569,7 @@ void TestOthersItems( NETLIST_OBJECT_LIST* aList,
                     {
                         Diagnose( aList->GetItem( aNetItemRef ),
                                   aList->GetItem( netItemTst ),
-                                  0, erc );
+                                  0, erc, aMarkers );
                         aList->SetConnectionType( netItemTst, NOCONNECT_SYMBOL_PRESENT );
                     }
                 }
@@ -561,6 +580,166 @@ void TestOthersItems( NETLIST_OBJECT_LIST* aList,
     }
 }
 
+/**
+ * Performs the ERC tests of the items of the net aNetStart to aNetEnd (excluded).
+ * @param aPinNets = the first net of the pins connected to several nets, by item
+ */
+static void testNet( NETLIST_OBJECT_LIST* aList, unsigned aNetStart, unsigned aNetEnd,
+                     const std::unordered_map<unsigned, wxString>& aPinNets,
+                     bool aTestUniqueGlobalLabels, ERC_MARKER_LIST* aMarkers )
+{
+    int MinConn = NOC;
+
+    for( unsigned itemIdx = aNetStart; itemIdx < aNetEnd; itemIdx++ )
+    {
+        NETLIST_OBJECT* item = aList->GetItem( itemIdx );
+
+        switch( item->m_Type )
+        {
+        // These items do not create erc problems
+        case NET_ITEM_UNSPECIFIED:
+        case NET_SEGMENT:
+        case NET_BUS:
+        case NET_JUNCTION:
+        case NET_LABEL:
+        case NET_BUSLABELMEMBER:
+        case NET_PINLABEL:
+        case NET_GLOBBUSLABELMEMBER:
+            break;
+
+        case NET_HIERLABEL:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_SHEETLABEL:
+        case NET_SHEETBUSLABELMEMBER:
+            // ERC problems when pin sheets do not match hierarchical labels.
+            // Each pin sheet must match a hierarchical label
+            // Each hierarchical label must match a pin sheet
+            aList->TestforNonOrphanLabel( itemIdx, aNetStart, aMarkers );
+            break;
+
+        case NET_GLOBLABEL:
+            if( aTestUniqueGlobalLabels )
+                aList->TestforNonOrphanLabel( itemIdx, aNetStart, aMarkers );
+            break;
+
+        case NET_NOCONNECT:
+
+            // ERC problems when a noconnect symbol is connected to more than one pin.
+            MinConn = NET_NC;
+
+            if( aList->CountPinsInNet( aNetStart ) > 1 )
+                Diagnose( item, NULL, MinConn, UNC, aMarkers );
+
+            break;
+
+        case NET_PIN:
+        {
+            // Check if this pin has appeared before on a different net
+            auto pinNet = aPinNets.find( itemIdx );
+
+            if( pinNet != aPinNets.end() )
+            {
+                auto ref = item->GetComponentParent()->GetRef( &item->m_SheetPath );
+
+                SCH_MARKER* marker = new SCH_MARKER();
+
+                marker->SetTimeStamp( GetNewTimeStamp() );
+                marker->SetData( ERCE_DIFFERENT_UNIT_NET, item->m_Start,
+                    wxString::Format( _( "Pin %s on %s is connected to both %s and %s" ),
+                    item->m_PinNum, ref, pinNet->second, item->GetNetName() ),
+                    item->m_Start );
+                marker->SetMarkerType( MARKER_BASE::MARKER_ERC );
+                marker->SetErrorLevel( MARKER_BASE::MARKER_SEVERITY_ERROR );
+
+                aMarkers->Add( item->m_SheetPath.LastScreen(), marker );
+            }
+
+            // Look for ERC problems between pins:
+            TestOthersItems( aList, itemIdx, aNetStart, &MinConn, aMarkers );
+            break;
+        }
+        }
+    }
+}
+
+
+void TestConnections( NETLIST_OBJECT_LIST* aList, bool aTestUniqueGlobalLabels,
+                      bool aTestSimilarLabels, int aThreadCount )
+{
+    // Reset the connection type indicator
+    aList->ResetConnectionsType();
+
+    /* Check that a pin appears in only one net.  This check is necessary
+     * because multi-unit components that have shared pins can be wired to
+     * different nets.  The first net found for a pin is the reference, so this
+     * is done here, in the list order.  This also gets the reference of all the
+     * components before the worker threads read them (GetRef() sets the missing
+     * references).
+     */
+    std::unordered_map<wxString, wxString> pin_to_net_map;
+    std::unordered_map<unsigned, wxString> pinNets;
+
+    /* The netlist generated by SCH_EDIT_FRAME::BuildNetListBase is sorted
+     * by net number, which means we can group netlist items into ranges
+     * that live in the same net.  Each net is tested by a task.
+     */
+    std::vector<unsigned> netStarts;
+
+    for( unsigned itemIdx = 0; itemIdx < aList->size(); itemIdx++ )
+    {
+        NETLIST_OBJECT* item = aList->GetItem( itemIdx );
+
+        if( itemIdx == 0 || aList->GetItemNet( itemIdx - 1 ) != item->GetNet() )
+        {
+            wxASSERT_MSG( itemIdx == 0 || aList->GetItemNet( itemIdx - 1 ) < item->GetNet(),
+                          wxT( "Netlist not correctly ordered" ) );
+            netStarts.push_back( itemIdx );
+        }
+
+        if( item->m_Type != NET_PIN || !item->m_Link )
+            continue;
+
+        auto ref = item->GetComponentParent()->GetRef( &item->m_SheetPath );
+        wxString pin_name = ref + "_" + item->m_PinNum;
+        auto pinNet = pin_to_net_map.find( pin_name );
+
+        if( pinNet == pin_to_net_map.end() )
+            pin_to_net_map[pin_name] = item->GetNetName();
+        else if( pinNet->second != item->GetNetName() )
+            pinNets[itemIdx] = pinNet->second;
+    }
+
+    netStarts.push_back( aList->size() );
+
+    // Task 0 tests the similar labels, which takes the longest: it is started first
+    size_t netCount = netStarts.size() - 1;
+    size_t taskCount = netCount + 1;
+    std::vector<ERC_MARKER_LIST> netMarkers( netCount );
+    ERC_MARKER_LIST labelMarkers;
+
+    PARALLEL_TASKS::Run( taskCount, [&]( size_t i )
+    {
+        if( i == 0 )
+        {
+            // Test similar labels (i;e. labels which are identical when
+            // using case insensitive comparisons)
+            if( aTestSimilarLabels )
+                aList->TestforSimilarLabels( &labelMarkers );
+
+            return;
+        }
+
+        testNet( aList, netStarts[i - 1], netStarts[i], pinNets,
+                 aTestUniqueGlobalLabels, &netMarkers[i - 1] );
+    }, false, std::max( aThreadCount, 0 ) );
+
+    for( ERC_MARKER_LIST& markers : netMarkers )
+        markers.AppendToScreens();
+
+    labelMarkers.AppendToScreens();
+}
+
+
 int NETLIST_OBJECT_LIST::CountPinsInNet( unsigned aNetStart )
 {
     int count = 0;
@@ -639,7 +818,8 @@ bool WriteDiagnosticERC( EDA_UNITS_T aUnits, const wxString& aFullFileName )
 }
 
 
-void NETLIST_OBJECT_LIST::TestforNonOrphanLabel( unsigned aNetItemRef, unsigned aStartNet )
+void NETLIST_OBJECT_LIST::TestforNonOrphanLabel( unsigned aNetItemRef, unsigned aStartNet,
+                                                 ERC_MARKER_LIST* aMarkers )
 {
     unsigned netItemTst = aStartNet;
     int      erc = 1;
@@ -658,7 +838,7 @@ void NETLIST_OBJECT_LIST::TestforNonOrphanLabel( unsigned aNetItemRef, unsigned
             if( erc )
             {
                 /* Glabel or SheetLabel orphaned. */
-                Diagnose( GetItem( aNetItemRef ), NULL, -1, WAR );
+                Diagnose( GetItem( aNetItemRef ), NULL, -1, WAR, aMarkers );
             }
 
             return;
@@ -710,10 +890,11 @@ struct compare_paths
 
 // Helper functions to build the warning messages about Similar Labels:
 static int countIndenticalLabels( std::vector<NETLIST_OBJECT*>& aList, NETLIST_OBJECT* aLabel );
-static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB );
+static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB,
+                                   ERC_MARKER_LIST* aMarkers );
 
 
-void NETLIST_OBJECT_LIST::TestforSimilarLabels()
+void NETLIST_OBJECT_LIST::TestforSimilarLabels( ERC_MARKER_LIST* aMarkers )
 {
     // Similar labels which are different when using case sensitive comparisons
     // but are equal when using case insensitive comparisons
@@ -777,9 +958,9 @@ void NETLIST_OBJECT_LIST::TestforSimilarLabels()
                 int cntB = countIndenticalLabels( fullLabelList, *it_aux );
 
                 if( cntA <= cntB )
-                    SimilarLabelsDiagnose( (*it), (*it_aux) );
+                    SimilarLabelsDiagnose( (*it), (*it_aux), aMarkers );
                 else
-                    SimilarLabelsDiagnose( (*it_aux), (*it) );
+                    SimilarLabelsDiagnose( (*it_aux), (*it), aMarkers );
             }
         }
     }
@@ -826,9 +1007,9 @@ void NETLIST_OBJECT_LIST::TestforSimilarLabels()
                     int cntB = countIndenticalLabels( fullLabelList, *it_aux );
 
                     if( cntA <= cntB )
-                        SimilarLabelsDiagnose( ref_item, (*it_aux) );
+                        SimilarLabelsDiagnose( ref_item, (*it_aux), aMarkers );
                     else
-                        SimilarLabelsDiagnose( (*it_aux), ref_item );
+                        SimilarLabelsDiagnose( (*it_aux), ref_item, aMarkers );
                 }
             }
         }
@@ -868,7 +1049,8 @@ static int countIndenticalLabels( std::vector<NETLIST_OBJECT*>& aList, NETLIST_O
 }
 
 // Helper function: creates a marker for similar labels ERC warning
-static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB )
+static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItemB,
+                                   ERC_MARKER_LIST* aMarkers )
 {
     // Create new marker for ERC.
     SCH_MARKER* marker = new SCH_MARKER();
@@ -877,7 +1059,11 @@ static void SimilarLabelsDiagnose( NETLIST_OBJECT* aItemA, NETLIST_OBJECT* aItem
     marker->SetMarkerType( MARKER_BASE::MARKER_ERC );
     marker->SetErrorLevel( MARKER_BASE::MARKER_SEVERITY_WARNING );
     SCH_SCREEN* screen = aItemA->m_SheetPath.LastScreen();
-    screen->Append( marker );
+
+    if( aMarkers )
+        aMarkers->Add( screen, marker );
+    else
+        screen->Append( marker );
 
     wxString fmt = aItemA->IsLabelGlobal() ?
                             _( "Global label \"%s\" (sheet \"%s\") looks like:" ) :
@@ -30,10 +30,15 @@
 #ifndef _ERC_H
 #define _ERC_H
 
+#include <vector>
+#include <utility>
+
 
 class NETLIST_OBJECT;
 class NETLIST_OBJECT_LIST;
 class SCH_SHEET_LIST;
+class SCH_SCREEN;
+class SCH_MARKER;
 
 /* For ERC markers: error types (used in diags, and to set the color):
 */
@@ -73,6 +78,32 @@ extern const wxString CommentERC_V[];
 #define NOC    0  // initial state of a net: no connection
 
 
+/**
+ * Class ERC_MARKER_LIST
+ * holds the ERC markers created by a worker thread, with the screens they belong to.
+ * The screens are not modified by the worker threads: the markers are appended to
+ * the screens by the main thread, once all the tests are done.
+ */
+class ERC_MARKER_LIST
+{
+public:
+    void Add( SCH_SCREEN* aScreen, SCH_MARKER* aMarker )
+    {
+        m_markers.push_back( std::make_pair( aScreen, aMarker ) );
+    }
+
+    /**
+     * Function AppendToScreens
+     * appends the markers to their screens, in the order they were added, and
+     * clears the list.
+     */
+    void AppendToScreens();
+
+private:
+    std::vector< std::pair<SCH_SCREEN*, SCH_MARKER*> > m_markers;
+};
+
+
 /**
  * Function WriteDiagnosticERC
  * save the ERC errors to \a aFullFileName.
@@ -85,9 +116,11 @@ bool WriteDiagnosticERC( EDA_UNITS_T aUnits, const wxString& aFullFileName );
  * Performs ERC testing and creates an ERC marker to show the ERC problem for aNetItemRef
  * or between aNetItemRef and aNetItemTst.
  *  if MinConn < 0: this is an error on labels
+ * The marker is added to aMarkers, or appended to the screen of aNetItemRef if aMarkers
+ * is NULL.
  */
 void Diagnose( NETLIST_OBJECT* NetItemRef, NETLIST_OBJECT* NetItemTst,
-                      int MinConnexion, int Diag );
+                      int MinConnexion, int Diag, ERC_MARKER_LIST* aMarkers = NULL );
 
 /**
  * Perform ERC testing for electrical conflicts between \a NetItemRef and other items
@@ -97,10 +130,32 @@ void Diagnose( NETLIST_OBJECT* NetItemRef, NETLIST_OBJECT* NetItemTst,
  * @param aNetStart = index in list of net objects of the first item
  * @param aMinConnexion = a pointer to a variable to store the minimal connection
  * found( NOD, DRV, NPI, NET_NC)
+ * @param aMarkers = the list receiving the markers (NULL to append them to the screens)
  */
 void TestOthersItems( NETLIST_OBJECT_LIST* aList,
                              unsigned aNetItemRef, unsigned aNetStart,
-                             int* aMinConnexion );
+                             int* aMinConnexion, ERC_MARKER_LIST* aMarkers = NULL );
+
+/**
+ * Function TestConnections
+ * performs the ERC tests of the connected items of \a aList: conflicts between pins,
+ * pins not connected or not driven, no connect symbols connected to several pins,
+ * orphan hierarchical (and global) labels, similar labels and pins of multi-unit
+ * components connected to different nets.
+ * <p>
+ * The nets are tested in parallel by a pool of threads.  The markers are appended to
+ * the screens in the net order, so they do not depend on the thread count.  Must be
+ * called from the main thread.
+ * </p>
+ * @param aList = the connected items, sorted by net (see BuildNetListInfo())
+ * @param aTestUniqueGlobalLabels = true to report the global labels connected to no
+ * other global label
+ * @param aTestSimilarLabels = true to report the labels differing only by their case
+ * @param aThreadCount = the number of threads, 0 for one per core.  With 1, the tests
+ * run in the calling thread.
+ */
+void TestConnections( NETLIST_OBJECT_LIST* aList, bool aTestUniqueGlobalLabels,
+                      bool aTestSimilarLabels, int aThreadCount = 0 );
 
 /**
  * Function TestDuplicateSheetNames( )
@@ -242,7 +242,8 @@ NETLIST_OBJECT_LIST* SCH_EDIT_FRAME::BuildNetListBase( bool updateStatusText )
     SCH_SHEET_LIST aSheets( g_RootSheet );
 
     // Build netlist info
-    bool success = ret->BuildNetListInfo( aSheets );
+    // Only the sheets changed since the previous netlist are searched for connections
+    bool success = ret->BuildNetListInfo( aSheets, m_netlistConnections );
 
     if( !success )
     {
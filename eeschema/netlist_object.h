@@ -32,12 +32,18 @@
 #define NETLIST_OBJECT_H
 
 
+#include <map>
+#include <vector>
+
 #include <sch_sheet_path.h>
 #include <lib_pin.h>
 #include <sch_item_struct.h>
 
 class NETLIST_OBJECT_LIST;
+class NETLIST_UNION_FIND;
 class SCH_COMPONENT;
+class SCH_SCREEN;
+class ERC_MARKER_LIST;
 
 
 /* Type of Net objects (wires, labels, pins...) */
@@ -276,6 +282,48 @@ public:
 typedef std::vector<NETLIST_OBJECT*>    NETLIST_OBJECTS;
 
 
+/**
+ * Class NETLIST_CONNECTIONS_CACHE
+ * keeps the connections found inside each screen of the hierarchy by the last
+ * NETLIST_OBJECT_LIST::BuildNetListInfo().
+ *
+ * The connections between the items of a screen (wires, buses, pins, junctions ...)
+ * depend only on the type and the position of these items.  They are searched again
+ * only in the screens whose items changed since the last netlist, so after an edit
+ * only the edited screen is searched, and the sheets sharing a screen are searched
+ * once.
+ *
+ * The net items themselves are still created for the whole hierarchy by each
+ * netlist: label texts, pin numbers and library pins change without any edit of
+ * the screen, and the ERC and the netlist exporters modify the items.
+ */
+class NETLIST_CONNECTIONS_CACHE
+{
+public:
+    /// The part of a NETLIST_OBJECT used to find its connections in a sheet
+    struct ITEM_KEY
+    {
+        NETLIST_ITEM_T m_Type;
+        wxPoint        m_Start;
+        wxPoint        m_End;
+    };
+
+    /// The connections of the items of a screen, the items being in the order they
+    /// were created by SCH_ITEM::GetNetListItem()
+    struct SHEET_CONNECTIONS
+    {
+        std::vector<ITEM_KEY> m_Items;
+        std::vector<int>      m_NetRoot;    ///< for each item, the index of an item of its net
+        std::vector<int>      m_BusRoot;    ///< for each item, the index of an item of its bus
+        bool                  m_Used;       ///< false for a screen removed from the hierarchy
+    };
+
+    /// The connections of each screen.  The screen is only a key: the items are
+    /// compared to the cached ones before the connections are used
+    std::map<const SCH_SCREEN*, SHEET_CONNECTIONS> m_Sheets;
+};
+
+
 /**
  * Class NETLIST_OBJECT_LIST
  * is a container holding and _owning_ NETLIST_OBJECTs, which are connected items
@@ -283,10 +331,6 @@ typedef std::vector<NETLIST_OBJECT*>    NETLIST_OBJECTS;
  */
 class NETLIST_OBJECT_LIST : public NETLIST_OBJECTS
 {
-    int m_lastNetCode;      // Used in intermediate calculation: last net code created
-    int m_lastBusNetCode;   // Used in intermediate calculation:
-                            // last net code created for bus members
-
 public:
     /**
      * Constructor.
@@ -295,9 +339,6 @@ public:
      */
     NETLIST_OBJECT_LIST()
     {
-        // Do not leave some members uninitialized:
-        m_lastNetCode = 0;
-        m_lastBusNetCode = 0;
     }
 
     ~NETLIST_OBJECT_LIST();
@@ -308,9 +349,11 @@ public:
      * Build the list of connected objects (pins, labels ...) and
      * all info to generate netlists or run ERC diags
      * @param aSheets = the flattened sheet list
+     * @param aCache = the connections found inside each sheet by the previous call,
+     * updated by this call (can be NULL)
      * @return true if OK, false is not item found
      */
-    bool BuildNetListInfo( SCH_SHEET_LIST& aSheets );
+    bool BuildNetListInfo( SCH_SHEET_LIST& aSheets, NETLIST_CONNECTIONS_CACHE* aCache = NULL );
 
     /**
      * Acces to an item in list
@@ -392,8 +435,10 @@ public:
      * Global labels are expected to be not orphan (connected to at least one
      * other global label.
      * This function tests the connection to another suitable label.
+     * @param aMarkers = the list receiving the markers (NULL to append them to the screens)
      */
-    void TestforNonOrphanLabel( unsigned aNetItemRef, unsigned aStartNet );
+    void TestforNonOrphanLabel( unsigned aNetItemRef, unsigned aStartNet,
+                                ERC_MARKER_LIST* aMarkers = NULL );
 
     /**
      * Function TestforSimilarLabels
@@ -401,8 +446,9 @@ public:
      * but are equal when using case insensitive comparisons
      * It can be due to a mistake from designer, so this kind of labels
      * is reported by TestforSimilarLabels
+     * @param aMarkers = the list receiving the markers (NULL to append them to the screens)
      */
-    void TestforSimilarLabels();
+    void TestforSimilarLabels( ERC_MARKER_LIST* aMarkers = NULL );
 
     #if defined(DEBUG)
     void DumpNetTable()
@@ -416,19 +462,37 @@ public:
     #endif
 
 private:
-    /*
-     * Propagate aNewNetCode to items having an internal netcode aOldNetCode
-     * used to interconnect group of items already physically connected,
-     * when a new connection is found between aOldNetCode and aNewNetCode
+    /**
+     * Function connectSheetItems
+     * searches the connections between the items aStart to aEnd - 1 of the list, which
+     * are the items of one sheet: the wires, pins, labels ... having a common end point,
+     * the junctions and labels on wires, and the same for buses.
+     * @param aConnections = the connections found, by index in the sheet
      */
-    void propagateNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus );
+    void connectSheetItems( unsigned aStart, unsigned aEnd,
+                            NETLIST_CONNECTIONS_CACHE::SHEET_CONNECTIONS& aConnections );
 
-    /*
-     * This function merges the net codes of groups of objects already connected
-     * to labels (wires, bus, pins ... ) when 2 labels are equivalents
-     * (i.e. group objects connected by labels)
+    /**
+     * Function connectBusLabels
+     * merges the nets of the bus label members connected to the same bus and having
+     * the same member number
      */
-    void labelConnect( NETLIST_OBJECT* aLabelRef );
+    void connectBusLabels( NETLIST_UNION_FIND& aNets, NETLIST_UNION_FIND& aBuses );
+
+    /**
+     * Function connectLabels
+     * merges the nets of the labels having the same name: the labels of a sheet,
+     * the global labels and the power pins of the whole hierarchy
+     * @param aItemSheets = the index of the sheet of each item
+     */
+    void connectLabels( NETLIST_UNION_FIND& aNets, const std::vector<int>& aItemSheets );
+
+    /**
+     * Function connectSheetLabels
+     * merges the nets of the sheet pins and of the hierarchical labels having the same
+     * name in the sub sheet
+     */
+    void connectSheetLabels( NETLIST_UNION_FIND& aNets );
 
     /* Comparison function to sort by increasing Netcode the list of connected items
      */
@@ -444,32 +508,6 @@ private:
         return Objet1->m_SheetPath.Cmp( Objet2->m_SheetPath ) < 0;
     }
 
-    /**
-     * Propagate net codes from a parent sheet to an include sheet,
-     * from a pin sheet connection
-     */
-    void sheetLabelConnect( NETLIST_OBJECT* aSheetLabel );
-
-    void pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start );
-
-    /**
-     * Search connections between a junction and segments
-     * Propagate the junction net code to objects connected by this junction.
-     * The junction must have a valid net code
-     * The list of objects is expected sorted by sheets.
-     * Search is done from index aIdxStart to the last element of list
-     */
-    void segmentToPointConnect( NETLIST_OBJECT* aJonction, bool aIsBus, int aIdxStart );
-
-
-    /**
-     * Function connectBusLabels
-     * Propagate the net code (and create it, if not yet existing) between
-     * all bus label member objects connected by they name.
-     * Search is done in the entire list
-     */
-    void connectBusLabels();
-
     /**
      * Set the m_FlagOfConnection member of items in list
      * depending on the connection type:
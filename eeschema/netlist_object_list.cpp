@@ -38,10 +38,9 @@
 #include <sch_text.h>
 #include <sch_sheet.h>
 #include <sch_screen.h>
+#include <trigo.h>
 #include <algorithm>
-
-#define IS_WIRE false
-#define IS_BUS true
+#include <climits>
 
 //#define NETLIST_DEBUG
 
@@ -77,209 +76,442 @@ void NETLIST_OBJECT_LIST::SortListbySheet()
 }
 
 
-bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets )
+/**
+ * Class NETLIST_UNION_FIND
+ * gives the net (or the bus) of the items of a NETLIST_OBJECT_LIST, by index.
+ * Two nets are merged in almost constant time, instead of renumbering all the items
+ * of one of them.
+ */
+class NETLIST_UNION_FIND
 {
-    SCH_SHEET_PATH* sheet;
-
-    // Fill list with connected items from the flattened sheet list
-    for( unsigned i = 0; i < aSheets.size();  i++ )
+public:
+    NETLIST_UNION_FIND( unsigned aCount ) :
+        m_parent( aCount )
     {
-        sheet = &aSheets[i];
+        for( unsigned ii = 0; ii < aCount; ii++ )
+            m_parent[ii] = ii;
+    }
 
-        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
+    /// @return the item representing the net of aItem
+    int Find( int aItem )
+    {
+        while( m_parent[aItem] != aItem )
         {
-            item->GetNetListItem( *this, sheet );
+            m_parent[aItem] = m_parent[ m_parent[aItem] ];
+            aItem = m_parent[aItem];
         }
+
+        return aItem;
     }
 
-    if( size() == 0 )
+    /// Merges the nets of aFirst and aSecond
+    void Union( int aFirst, int aSecond )
+    {
+        aFirst = Find( aFirst );
+        aSecond = Find( aSecond );
+
+        if( aFirst < aSecond )
+            m_parent[aSecond] = aFirst;
+        else if( aSecond < aFirst )
+            m_parent[aFirst] = aSecond;
+    }
+
+private:
+    std::vector<int> m_parent;
+};
+
+
+// Items connected to the wires (all the items, except the buses)
+static bool isNetItem( NETLIST_ITEM_T aType )
+{
+    return aType != NET_BUS && aType != NET_ITEM_UNSPECIFIED;
+}
+
+
+// Items connected to the buses
+static bool isBusItem( NETLIST_ITEM_T aType )
+{
+    switch( aType )
+    {
+    case NET_BUS:
+    case NET_JUNCTION:
+    case NET_BUSLABELMEMBER:
+    case NET_SHEETBUSLABELMEMBER:
+    case NET_HIERBUSLABELMEMBER:
+    case NET_GLOBBUSLABELMEMBER:
+        return true;
+
+    default:
         return false;
+    }
+}
+
+
+// Items connected by their end points to the wires, pins ... having the same end point.
+// The labels and junctions are connected only to the items of this list.
+static bool isWireEndItem( NETLIST_ITEM_T aType )
+{
+    return aType == NET_SEGMENT || aType == NET_PIN || aType == NET_PINLABEL
+           || aType == NET_SHEETLABEL || aType == NET_NOCONNECT;
+}
+
+
+// Items connected by their end points to the buses or bus labels having the same end point
+static bool isBusEndItem( NETLIST_ITEM_T aType )
+{
+    return aType == NET_BUS || aType == NET_SHEETBUSLABELMEMBER;
+}
+
+
+// Items connected to the wires or the buses which they are on
+static bool isLabelOnWire( NETLIST_ITEM_T aType )
+{
+    return aType == NET_LABEL || aType == NET_HIERLABEL || aType == NET_GLOBLABEL
+           || aType == NET_JUNCTION;
+}
+
+
+static bool isLabelOnBus( NETLIST_ITEM_T aType )
+{
+    return aType == NET_BUSLABELMEMBER || aType == NET_HIERBUSLABELMEMBER
+           || aType == NET_GLOBBUSLABELMEMBER || aType == NET_JUNCTION;
+}
 
-    // Sort objects by Sheet
-    SortListbySheet();
 
-    sheet = &(GetItem( 0 )->m_SheetPath);
-    m_lastNetCode = m_lastBusNetCode = 1;
+/**
+ * The horizontal, vertical and other segments (wires or buses) of a sheet, to find
+ * quickly the segments a point is on.
+ */
+class SHEET_SEGMENTS
+{
+public:
+    void Add( const wxPoint& aStart, const wxPoint& aEnd, int aIndex )
+    {
+        if( aStart.y == aEnd.y )
+            m_horizontal.push_back( { aStart.y, std::min( aStart.x, aEnd.x ),
+                                      std::max( aStart.x, aEnd.x ), aIndex } );
+        else if( aStart.x == aEnd.x )
+            m_vertical.push_back( { aStart.x, std::min( aStart.y, aEnd.y ),
+                                    std::max( aStart.y, aEnd.y ), aIndex } );
+        else
+            m_other.push_back( { aStart, aEnd, aIndex } );
+    }
 
-    for( unsigned ii = 0, istart = 0; ii < size(); ii++ )
+    void Sort()
     {
-        NETLIST_OBJECT* net_item = GetItem( ii );
+        std::sort( m_horizontal.begin(), m_horizontal.end() );
+        std::sort( m_vertical.begin(), m_vertical.end() );
+    }
 
-        if( net_item->m_SheetPath != *sheet )   // Sheet change
+    /// Calls aFunction( index ) for each segment aPoint is on
+    template <typename FUNCTION>
+    void ForEachSegmentAt( const wxPoint& aPoint, FUNCTION aFunction ) const
+    {
+        forEachAlignedSegment( m_horizontal, aPoint.y, aPoint.x, aFunction );
+        forEachAlignedSegment( m_vertical, aPoint.x, aPoint.y, aFunction );
+
+        for( const OTHER_SEGMENT& segment : m_other )
         {
-            sheet  = &(net_item->m_SheetPath);
-            istart = ii;
+            if( IsPointOnSegment( segment.m_start, segment.m_end, aPoint ) )
+                aFunction( segment.m_index );
         }
+    }
+
+private:
+    /// A horizontal (or vertical) segment, from m_min to m_max on the line m_line
+    struct ALIGNED_SEGMENT
+    {
+        int m_line;
+        int m_min;
+        int m_max;
+        int m_index;
 
-        switch( net_item->m_Type )
+        bool operator<( const ALIGNED_SEGMENT& aOther ) const
         {
-        case NET_ITEM_UNSPECIFIED:
-            wxMessageBox( wxT( "BuildNetListInfo() error" ) );
-            break;
+            if( m_line != aOther.m_line )
+                return m_line < aOther.m_line;
 
-        case NET_PIN:
-        case NET_PINLABEL:
-        case NET_SHEETLABEL:
-        case NET_NOCONNECT:
-            if( net_item->GetNet() != 0 )
-                break;
+            return m_min < aOther.m_min;
+        }
+    };
 
-        case NET_SEGMENT:
-            // Test connections point to point type without bus.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+    struct OTHER_SEGMENT
+    {
+        wxPoint m_start;
+        wxPoint m_end;
+        int     m_index;
+    };
+
+    template <typename FUNCTION>
+    static void forEachAlignedSegment( const std::vector<ALIGNED_SEGMENT>& aSegments,
+                                       int aLine, int aPos, FUNCTION& aFunction )
+    {
+        ALIGNED_SEGMENT first = { aLine, INT_MIN, INT_MIN, 0 };
 
-            pointToPointConnect( net_item, IS_WIRE, istart );
-            break;
+        for( auto it = std::lower_bound( aSegments.begin(), aSegments.end(), first );
+             it != aSegments.end() && it->m_line == aLine && it->m_min <= aPos; ++it )
+        {
+            if( it->m_max >= aPos )
+                aFunction( it->m_index );
+        }
+    }
 
-        case NET_JUNCTION:
-            // Control of the junction outside BUS.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+    std::vector<ALIGNED_SEGMENT> m_horizontal;
+    std::vector<ALIGNED_SEGMENT> m_vertical;
+    std::vector<OTHER_SEGMENT>   m_other;
+};
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
 
-            // Control of the junction, on BUS.
-            if( net_item->m_BusNetCode == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+bool NETLIST_OBJECT_LIST::BuildNetListInfo( SCH_SHEET_LIST& aSheets,
+                                            NETLIST_CONNECTIONS_CACHE* aCache )
+{
+    NETLIST_CONNECTIONS_CACHE localCache;
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
-            break;
+    if( !aCache )
+        aCache = &localCache;
 
-        case NET_LABEL:
-        case NET_HIERLABEL:
-        case NET_GLOBLABEL:
-            // Test connections type junction without bus.
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
+    for( auto& cached : aCache->m_Sheets )
+        cached.second.m_Used = false;
 
-            segmentToPointConnect( net_item, IS_WIRE, istart );
-            break;
+    // Fill list with connected items from the flattened sheet list.
+    // The items of a sheet are consecutive in the list
+    std::vector<unsigned> sheetStarts;
 
-        case NET_SHEETBUSLABELMEMBER:
-            if( net_item->m_BusNetCode != 0 )
-                break;
+    for( unsigned i = 0; i < aSheets.size();  i++ )
+    {
+        SCH_SHEET_PATH* sheet = &aSheets[i];
 
-        case NET_BUS:
-            // Control type connections point to point mode bus
-            if( net_item->m_BusNetCode == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+        sheetStarts.push_back( size() );
 
-            pointToPointConnect( net_item, IS_BUS, istart );
-            break;
+        for( SCH_ITEM* item = sheet->LastScreen()->GetDrawItems(); item; item = item->Next() )
+        {
+            item->GetNetListItem( *this, sheet );
+        }
+    }
 
-        case NET_BUSLABELMEMBER:
-        case NET_HIERBUSLABELMEMBER:
-        case NET_GLOBBUSLABELMEMBER:
-            // Control connections similar has on BUS
-            if( net_item->GetNet() == 0 )
-            {
-                net_item->m_BusNetCode = m_lastBusNetCode;
-                m_lastBusNetCode++;
-            }
+    sheetStarts.push_back( size() );
 
-            segmentToPointConnect( net_item, IS_BUS, istart );
-            break;
+    if( size() == 0 )
+    {
+        aCache->m_Sheets.clear();
+        return false;
+    }
+
+    NETLIST_UNION_FIND nets( size() );
+    NETLIST_UNION_FIND buses( size() );
+    std::vector<int>   itemSheets( size() );
+
+    // Connect the items of each sheet.  The connections are searched again only if the
+    // items of the screen changed since the previous netlist, or since the previous
+    // sheet using the same screen.
+    for( unsigned i = 0; i < aSheets.size(); i++ )
+    {
+        unsigned start = sheetStarts[i];
+        unsigned end = sheetStarts[i + 1];
+
+        NETLIST_CONNECTIONS_CACHE::SHEET_CONNECTIONS& connections =
+                aCache->m_Sheets[ aSheets[i].LastScreen() ];
+        bool changed = connections.m_Items.size() != end - start;
+
+        for( unsigned ii = start; ii < end && !changed; ii++ )
+        {
+            const NETLIST_CONNECTIONS_CACHE::ITEM_KEY& key = connections.m_Items[ii - start];
+            NETLIST_OBJECT* item = GetItem( ii );
+
+            changed = key.m_Type != item->m_Type || key.m_Start != item->m_Start
+                      || key.m_End != item->m_End;
+        }
+
+        if( changed )
+            connectSheetItems( start, end, connections );
+
+        connections.m_Used = true;
+
+        for( unsigned ii = start; ii < end; ii++ )
+        {
+            itemSheets[ii] = i;
+
+            if( GetItem( ii )->m_Type == NET_ITEM_UNSPECIFIED )
+                wxMessageBox( wxT( "BuildNetListInfo() error" ) );
+
+            nets.Union( ii, start + connections.m_NetRoot[ii - start] );
+            buses.Union( ii, start + connections.m_BusRoot[ii - start] );
         }
     }
 
-#if defined(NETLIST_DEBUG) && defined(DEBUG)
-    std::cout << "\n\nafter sheet local\n\n";
-    DumpNetTable();
-#endif
+    // Forget the screens removed from the hierarchy
+    for( auto it = aCache->m_Sheets.begin(); it != aCache->m_Sheets.end(); )
+    {
+        if( it->second.m_Used )
+            ++it;
+        else
+            it = aCache->m_Sheets.erase( it );
+    }
 
     // Updating the Bus Labels Netcode connected by Bus
-    connectBusLabels();
+    connectBusLabels( nets, buses );
 
     // Group objects by label.
+    connectLabels( nets, itemSheets );
+
+    // Connection between hierarchy sheets
+    connectSheetLabels( nets );
+
+    // Give consecutive net codes to the nets, in the order of the sheets.
+    // The buses have no net code, and the wires have no bus net code
+    std::vector<int> netCodes( size(), 0 );
+    std::vector<int> busNetCodes( size(), 0 );
+    int lastNetCode = 0;
+    int lastBusNetCode = 0;
+
     for( unsigned ii = 0; ii < size(); ii++ )
     {
-        switch( GetItem( ii )->m_Type )
+        NETLIST_OBJECT* item = GetItem( ii );
+
+        if( isNetItem( item->m_Type ) )
         {
-        case NET_PIN:
-        case NET_SHEETLABEL:
-        case NET_SEGMENT:
-        case NET_JUNCTION:
-        case NET_BUS:
-        case NET_NOCONNECT:
-            break;
+            int& netCode = netCodes[ nets.Find( ii ) ];
 
-        case NET_LABEL:
-        case NET_GLOBLABEL:
-        case NET_PINLABEL:
-        case NET_BUSLABELMEMBER:
-        case NET_GLOBBUSLABELMEMBER:
-            labelConnect( GetItem( ii ) );
-            break;
+            if( netCode == 0 )
+                netCode = ++lastNetCode;
 
-        case NET_SHEETBUSLABELMEMBER:
-        case NET_HIERLABEL:
-        case NET_HIERBUSLABELMEMBER:
-            break;
+            item->SetNet( netCode );
+        }
 
-        case NET_ITEM_UNSPECIFIED:
-            break;
+        if( isBusItem( item->m_Type ) )
+        {
+            int& busNetCode = busNetCodes[ buses.Find( ii ) ];
+
+            if( busNetCode == 0 )
+                busNetCode = ++lastBusNetCode;
+
+            item->m_BusNetCode = busNetCode;
         }
     }
 
 #if defined(NETLIST_DEBUG) && defined(DEBUG)
-    std::cout << "\n\nafter sheet global\n\n";
+    std::cout << "\n\nafter connections\n\n";
     DumpNetTable();
 #endif
 
-    // Connection between hierarchy sheets
-    for( unsigned ii = 0; ii < size(); ii++ )
-    {
-        if( GetItem( ii )->m_Type == NET_SHEETLABEL
-            || GetItem( ii )->m_Type == NET_SHEETBUSLABELMEMBER )
-            sheetLabelConnect( GetItem( ii ) );
-    }
-
     // Sort objects by NetCode
     SortListbyNetcode();
 
-#if defined(NETLIST_DEBUG) && defined(DEBUG)
-    std::cout << "\n\nafter qsort()\n";
-    DumpNetTable();
-#endif
+    // Set the minimal connection info:
+    setUnconnectedFlag();
 
-    // Compress numbers of Netcode having consecutive values.
-    int NetCode = 0;
-    m_lastNetCode = 0;
+    // find the best label object to give the best net name to each net
+    findBestNetNameForEachNet();
 
-    for( unsigned ii = 0; ii < size(); ii++ )
+    return true;
+}
+
+
+void NETLIST_OBJECT_LIST::connectSheetItems( unsigned aStart, unsigned aEnd,
+                        NETLIST_CONNECTIONS_CACHE::SHEET_CONNECTIONS& aConnections )
+{
+    unsigned           count = aEnd - aStart;
+    NETLIST_UNION_FIND nets( count );
+    NETLIST_UNION_FIND buses( count );
+
+    // Connect the items having a common end point: sort the end points, then
+    // connect the items at the same point
+    std::vector<std::pair<wxPoint, int>> ends;
+    SHEET_SEGMENTS wires;
+    SHEET_SEGMENTS busSegments;
+
+    auto pointLess = []( const std::pair<wxPoint, int>& aFirst,
+                         const std::pair<wxPoint, int>& aSecond )
+    {
+        if( aFirst.first.x != aSecond.first.x )
+            return aFirst.first.x < aSecond.first.x;
+
+        if( aFirst.first.y != aSecond.first.y )
+            return aFirst.first.y < aSecond.first.y;
+
+        return aFirst.second < aSecond.second;
+    };
+
+    for( unsigned ii = 0; ii < count; ii++ )
     {
-        if( GetItem( ii )->GetNet() != m_lastNetCode )
+        NETLIST_OBJECT* item = GetItem( aStart + ii );
+
+        ends.emplace_back( item->m_Start, ii );
+
+        if( item->m_End != item->m_Start )
+            ends.emplace_back( item->m_End, ii );
+
+        if( item->m_Type == NET_SEGMENT )
+            wires.Add( item->m_Start, item->m_End, ii );
+        else if( item->m_Type == NET_BUS )
+            busSegments.Add( item->m_Start, item->m_End, ii );
+    }
+
+    std::sort( ends.begin(), ends.end(), pointLess );
+
+    for( size_t first = 0, last; first < ends.size(); first = last )
+    {
+        int wireEnd = -1;
+        int busEnd = -1;
+
+        for( last = first; last < ends.size() && ends[last].first == ends[first].first; last++ )
         {
-            NetCode++;
-            m_lastNetCode = GetItem( ii )->GetNet();
+            NETLIST_ITEM_T type = GetItem( aStart + ends[last].second )->m_Type;
+
+            if( wireEnd < 0 && isWireEndItem( type ) )
+                wireEnd = ends[last].second;
+
+            if( busEnd < 0 && isBusEndItem( type ) )
+                busEnd = ends[last].second;
+        }
+
+        // All the items at this point are connected to a wire end (or a pin ...),
+        // but two labels at the same point are not connected
+        for( size_t ii = first; ii < last; ii++ )
+        {
+            NETLIST_ITEM_T type = GetItem( aStart + ends[ii].second )->m_Type;
+
+            if( wireEnd >= 0 && ( isWireEndItem( type ) || isLabelOnWire( type ) ) )
+                nets.Union( wireEnd, ends[ii].second );
+
+            if( busEnd >= 0 && ( isBusEndItem( type ) || isLabelOnBus( type ) ) )
+                buses.Union( busEnd, ends[ii].second );
         }
+    }
+
+    // Connect the junctions and labels to the wires and buses they are on
+    wires.Sort();
+    busSegments.Sort();
 
-        GetItem( ii )->SetNet( NetCode );
+    for( unsigned ii = 0; ii < count; ii++ )
+    {
+        NETLIST_OBJECT* item = GetItem( aStart + ii );
+
+        if( isLabelOnWire( item->m_Type ) )
+            wires.ForEachSegmentAt( item->m_Start, [&]( int aSegment )
+                                    {
+                                        nets.Union( ii, aSegment );
+                                    } );
+
+        if( isLabelOnBus( item->m_Type ) )
+            busSegments.ForEachSegmentAt( item->m_Start, [&]( int aSegment )
+                                          {
+                                              buses.Union( ii, aSegment );
+                                          } );
     }
 
-    // Set the minimal connection info:
-    setUnconnectedFlag();
+    aConnections.m_Items.resize( count );
+    aConnections.m_NetRoot.resize( count );
+    aConnections.m_BusRoot.resize( count );
 
-    // find the best label object to give the best net name to each net
-    findBestNetNameForEachNet();
+    for( unsigned ii = 0; ii < count; ii++ )
+    {
+        NETLIST_OBJECT* item = GetItem( aStart + ii );
 
-    return true;
+        aConnections.m_Items[ii] = { item->m_Type, item->m_Start, item->m_End };
+        aConnections.m_NetRoot[ii] = nets.Find( ii );
+        aConnections.m_BusRoot[ii] = buses.Find( ii );
+    }
 }
 
 // Helper function to give a priority to sort labels:
@@ -497,285 +729,146 @@ void NETLIST_OBJECT_LIST::findBestNetNameForEachNet()
 }
 
 
-void NETLIST_OBJECT_LIST::sheetLabelConnect( NETLIST_OBJECT* SheetLabel )
+void NETLIST_OBJECT_LIST::connectBusLabels( NETLIST_UNION_FIND& aNets,
+                                            NETLIST_UNION_FIND& aBuses )
 {
-    if( SheetLabel->GetNet() == 0 )
-        return;
+    // Two bus label members are connected if they are connected to the same bus
+    // and have the same member number
+    std::map<std::pair<int, int>, int> busMembers;
 
     for( unsigned ii = 0; ii < size(); ii++ )
     {
-        NETLIST_OBJECT* ObjetNet = GetItem( ii );
-
-        if( ObjetNet->m_SheetPath != SheetLabel->m_SheetPathInclude )
-            continue;  //use SheetInclude, not the sheet!!
+        NETLIST_OBJECT* label = GetItem( ii );
 
-        if( (ObjetNet->m_Type != NET_HIERLABEL ) && (ObjetNet->m_Type != NET_HIERBUSLABELMEMBER ) )
+        if( !label->IsLabelBusMemberType() )
             continue;
 
-        if( ObjetNet->GetNet() == SheetLabel->GetNet() )
-            continue;  //already connected.
+        auto inserted = busMembers.emplace( std::make_pair( aBuses.Find( ii ), label->m_Member ),
+                                            ii );
 
-        if( ObjetNet->m_Label != SheetLabel->m_Label )
-            continue;  //different names.
-
-        // Propagate Netcode having all the objects of the same Netcode.
-        if( ObjetNet->GetNet() )
-            propagateNetCode( ObjetNet->GetNet(), SheetLabel->GetNet(), IS_WIRE );
-        else
-            ObjetNet->SetNet( SheetLabel->GetNet() );
+        if( !inserted.second )
+            aNets.Union( inserted.first->second, ii );
     }
 }
 
 
-void NETLIST_OBJECT_LIST::connectBusLabels()
+void NETLIST_OBJECT_LIST::connectLabels( NETLIST_UNION_FIND& aNets,
+                                         const std::vector<int>& aItemSheets )
 {
-    // Propagate the net code between all bus label member objects connected by they name.
-    // If the net code is not yet existing, a new one is created
-    // Search is done in the entire list
+    // NET_HIERLABEL are used to connect sheets.
+    // NET_LABEL are local to a sheet
+    // NET_GLOBLABEL are global.
+    // NET_PINLABEL is a kind of global label (generated by a power pin invisible)
+    std::map<wxString, std::vector<int>> labels;
+
     for( unsigned ii = 0; ii < size(); ii++ )
     {
-        NETLIST_OBJECT* Label = GetItem( ii );
-
-        if( Label->IsLabelBusMemberType() )
-        {
-            if( Label->GetNet() == 0 )
-            {
-                // Not yet existiing net code: create a new one.
-                Label->SetNet( m_lastNetCode );
-                m_lastNetCode++;
-            }
-
-            for( unsigned jj = ii + 1; jj < size(); jj++ )
-            {
-                NETLIST_OBJECT* LabelInTst =  GetItem( jj );
-
-                if( LabelInTst->IsLabelBusMemberType() )
-                {
-                    if( LabelInTst->m_BusNetCode != Label->m_BusNetCode )
-                        continue;
-
-                    if( LabelInTst->m_Member != Label->m_Member )
-                        continue;
-
-                    if( LabelInTst->GetNet() == 0 )
-                        // Append this object to the current net
-                        LabelInTst->SetNet( Label->GetNet() );
-                    else
-                        // Merge the 2 net codes, they are connected.
-                        propagateNetCode( LabelInTst->GetNet(), Label->GetNet(), IS_WIRE );
-                }
-            }
-        }
+        if( GetItem( ii )->IsLabelType() )
+            labels[ GetItem( ii )->m_Label ].push_back( ii );
     }
-}
-
 
-void NETLIST_OBJECT_LIST::propagateNetCode( int aOldNetCode, int aNewNetCode, bool aIsBus )
-{
-    if( aOldNetCode == aNewNetCode )
-        return;
-
-    if( aIsBus == false )    // Propagate NetCode
+    auto connectsLabels = []( NETLIST_ITEM_T aType )
     {
-        for( unsigned jj = 0; jj < size(); jj++ )
-        {
-            NETLIST_OBJECT* object = GetItem( jj );
+        // The hierarchical labels are connected only to the labels of their sheet
+        return aType != NET_HIERLABEL && aType != NET_HIERBUSLABELMEMBER;
+    };
 
-            if( object->GetNet() == aOldNetCode )
-                object->SetNet( aNewNetCode );
-        }
-    }
-    else               // Propagate BusNetCode
+    for( const auto& name : labels )
     {
-        for( unsigned jj = 0; jj < size(); jj++ )
+        const std::vector<int>& items = name.second;
+        int firstPinLabel = -1;
+        int firstGlobLabel = -1;
+        int firstGlobBusLabel = -1;
+
+        // In a sheet, all the labels having the same name are connected (the items of
+        // a sheet are consecutive in the list)
+        for( size_t first = 0, last; first < items.size(); first = last )
         {
-            NETLIST_OBJECT* object = GetItem( jj );
-
-            if( object->m_BusNetCode == aOldNetCode )
-                object->m_BusNetCode = aNewNetCode;
-        }
-    }
-}
-
-
-void NETLIST_OBJECT_LIST::pointToPointConnect( NETLIST_OBJECT* aRef, bool aIsBus, int start )
-{
-    int netCode;
-
-    if( aIsBus == false )    // Objects other than BUS and BUSLABELS
-    {
-        netCode = aRef->GetNet();
+            int sheetLabel = -1;
 
-        for( unsigned i = start; i < size(); i++ )
-        {
-            NETLIST_OBJECT* item = GetItem( i );
+            for( last = first; last < items.size()
+                     && aItemSheets[ items[last] ] == aItemSheets[ items[first] ]; last++ )
+            {
+                if( sheetLabel < 0 && connectsLabels( GetItem( items[last] )->m_Type ) )
+                    sheetLabel = items[last];
+            }
 
-            if( item->m_SheetPath != aRef->m_SheetPath )  //used to be > (why?)
+            if( sheetLabel < 0 )
                 continue;
 
-            switch( item->m_Type )
-            {
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_JUNCTION:
-            case NET_NOCONNECT:
-                if( aRef->m_Start == item->m_Start
-                    || aRef->m_Start == item->m_End
-                    || aRef->m_End   == item->m_Start
-                    || aRef->m_End   == item->m_End )
-                {
-                    if( item->GetNet() == 0 )
-                        item->SetNet( netCode );
-                    else
-                        propagateNetCode( item->GetNet(), netCode, IS_WIRE );
-                }
-                break;
-
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_ITEM_UNSPECIFIED:
-                break;
-            }
+            for( size_t ii = first; ii < last; ii++ )
+                aNets.Union( sheetLabel, items[ii] );
         }
-    }
-    else    // Object type BUS, BUSLABELS, and junctions.
-    {
-        netCode = aRef->m_BusNetCode;
 
-        for( unsigned i = start; i < size(); i++ )
+        // In the whole hierarchy, the global labels are connected to the global labels
+        // and the power pins are connected to the labels other than hierarchical ones
+        for( int item : items )
         {
-            NETLIST_OBJECT* item = GetItem( i );
+            NETLIST_ITEM_T type = GetItem( item )->m_Type;
 
-            if( item->m_SheetPath != aRef->m_SheetPath )
-                continue;
-
-            switch( item->m_Type )
+            if( type == NET_GLOBLABEL )
             {
-            case NET_ITEM_UNSPECIFIED:
-            case NET_SEGMENT:
-            case NET_PIN:
-            case NET_LABEL:
-            case NET_HIERLABEL:
-            case NET_GLOBLABEL:
-            case NET_SHEETLABEL:
-            case NET_PINLABEL:
-            case NET_NOCONNECT:
-                break;
+                if( firstGlobLabel < 0 )
+                    firstGlobLabel = item;
 
-            case NET_BUS:
-            case NET_BUSLABELMEMBER:
-            case NET_SHEETBUSLABELMEMBER:
-            case NET_HIERBUSLABELMEMBER:
-            case NET_GLOBBUSLABELMEMBER:
-            case NET_JUNCTION:
-                if(  aRef->m_Start == item->m_Start
-                  || aRef->m_Start == item->m_End
-                  || aRef->m_End   == item->m_Start
-                  || aRef->m_End   == item->m_End )
-                {
-                    if( item->m_BusNetCode == 0 )
-                        item->m_BusNetCode = netCode;
-                    else
-                        propagateNetCode( item->m_BusNetCode, netCode, IS_BUS );
-                }
-                break;
+                aNets.Union( firstGlobLabel, item );
             }
-        }
-    }
-}
+            else if( type == NET_GLOBBUSLABELMEMBER )
+            {
+                if( firstGlobBusLabel < 0 )
+                    firstGlobBusLabel = item;
 
+                aNets.Union( firstGlobBusLabel, item );
+            }
 
-void NETLIST_OBJECT_LIST::segmentToPointConnect( NETLIST_OBJECT* aJonction,
-                                                 bool aIsBus, int aIdxStart )
-{
-    for( unsigned i = aIdxStart; i < size(); i++ )
-    {
-        NETLIST_OBJECT* segment = GetItem( i );
+            if( type == NET_PINLABEL && firstPinLabel < 0 )
+                firstPinLabel = item;
+        }
 
-        // if different sheets, obviously no physical connection between elements.
-        if( segment->m_SheetPath != aJonction->m_SheetPath )
+        if( firstPinLabel < 0 )
             continue;
 
-        if( aIsBus == IS_WIRE )
+        for( int item : items )
         {
-            if( segment->m_Type != NET_SEGMENT )
-                continue;
-        }
-        else
-        {
-            if( segment->m_Type != NET_BUS )
-                continue;
-        }
-
-        if( IsPointOnSegment( segment->m_Start, segment->m_End, aJonction->m_Start ) )
-        {
-            // Propagation Netcode has all the objects of the same Netcode.
-            if( aIsBus == IS_WIRE )
-            {
-                if( segment->GetNet() )
-                    propagateNetCode( segment->GetNet(), aJonction->GetNet(), aIsBus );
-                else
-                    segment->SetNet( aJonction->GetNet() );
-            }
-            else
-            {
-                if( segment->m_BusNetCode )
-                    propagateNetCode( segment->m_BusNetCode, aJonction->m_BusNetCode, aIsBus );
-                else
-                    segment->m_BusNetCode = aJonction->m_BusNetCode;
-            }
+            if( connectsLabels( GetItem( item )->m_Type ) )
+                aNets.Union( firstPinLabel, item );
         }
     }
 }
 
 
-void NETLIST_OBJECT_LIST::labelConnect( NETLIST_OBJECT* aLabelRef )
+void NETLIST_OBJECT_LIST::connectSheetLabels( NETLIST_UNION_FIND& aNets )
 {
-    if( aLabelRef->GetNet() == 0 )
-        return;
+    // The hierarchical labels of each sub sheet, by sheet path and label name
+    std::map<std::pair<wxString, wxString>, std::vector<int>> hierLabels;
 
-    for( unsigned i = 0; i < size(); i++ )
+    for( unsigned ii = 0; ii < size(); ii++ )
     {
-        NETLIST_OBJECT* item = GetItem( i );
+        NETLIST_OBJECT* label = GetItem( ii );
 
-        if( item->GetNet() == aLabelRef->GetNet() )
+        if( label->m_Type != NET_HIERLABEL && label->m_Type != NET_HIERBUSLABELMEMBER )
             continue;
 
-        if( item->m_SheetPath != aLabelRef->m_SheetPath )
-        {
-            if( item->m_Type != NET_PINLABEL && item->m_Type != NET_GLOBLABEL
-                && item->m_Type != NET_GLOBBUSLABELMEMBER )
-                continue;
+        hierLabels[ std::make_pair( label->m_SheetPath.Path(), label->m_Label ) ].push_back( ii );
+    }
 
-            if( (item->m_Type == NET_GLOBLABEL
-                 || item->m_Type == NET_GLOBBUSLABELMEMBER)
-               && item->m_Type != aLabelRef->m_Type )
-                //global labels only connect other global labels.
-                continue;
-        }
+    for( unsigned ii = 0; ii < size(); ii++ )
+    {
+        NETLIST_OBJECT* sheetLabel = GetItem( ii );
 
-        // NET_HIERLABEL are used to connect sheets.
-        // NET_LABEL are local to a sheet
-        // NET_GLOBLABEL are global.
-        // NET_PINLABEL is a kind of global label (generated by a power pin invisible)
-        if( item->IsLabelType() )
-        {
-            if( item->m_Label != aLabelRef->m_Label )
-                continue;
+        if( sheetLabel->m_Type != NET_SHEETLABEL
+                && sheetLabel->m_Type != NET_SHEETBUSLABELMEMBER )
+            continue;
 
-            if( item->GetNet() )
-                propagateNetCode( item->GetNet(), aLabelRef->GetNet(), IS_WIRE );
-            else
-                item->SetNet( aLabelRef->GetNet() );
-        }
+        // Use SheetInclude, not the sheet!!
+        auto it = hierLabels.find( std::make_pair( sheetLabel->m_SheetPathInclude.Path(),
+                                                   sheetLabel->m_Label ) );
+
+        if( it == hierLabels.end() )
+            continue;
+
+        for( int hierLabel : it->second )
+            aNets.Union( ii, hierLabel );
     }
 }
 
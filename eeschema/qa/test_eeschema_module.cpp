@@ -0,0 +1,85 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * Main file for the eeschema unit tests to be compiled
+ */
+
+#define BOOST_TEST_MODULE "Eeschema module tests"
+
+#include <boost/test/unit_test.hpp>
+
+#include <wx/init.h>
+#include <wx/filename.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <kiway.h>
+
+#include <eeschema_test_utils.h>
+
+
+static struct PGM_QA_EESCHEMA : public PGM_BASE
+{
+    void MacOpenFile( const wxString& aFileName ) override {}
+}
+program;
+
+
+/**
+ * Initializes wxWidgets and the eeschema kiface once for all the tests.
+ */
+struct EESCHEMA_TEST_SETUP
+{
+    EESCHEMA_TEST_SETUP()
+    {
+        wxInitialize();
+
+        // The eeschema code gets the program object from the kiface getter
+        int kifaceVersion;
+        KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+    }
+
+    ~EESCHEMA_TEST_SETUP()
+    {
+        wxUninitialize();
+    }
+};
+
+BOOST_GLOBAL_FIXTURE( EESCHEMA_TEST_SETUP );
+
+
+KIWAY& TestKiway()
+{
+    static KIWAY kiway( &program, KFCTL_STANDALONE );
+    return kiway;
+}
+
+
+wxString TestDataFile( const wxString& aFileName )
+{
+    wxFileName fn( wxString( QA_EESCHEMA_DATA_DIR ) + wxT( "/" ) + aFileName );
+    fn.Normalize();
+
+    return fn.GetFullPath();
+}
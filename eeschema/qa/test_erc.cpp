@@ -0,0 +1,346 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <class_libentry.h>
+#include <lib_pin.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <sch_line.h>
+#include <sch_junction.h>
+#include <sch_no_connect.h>
+#include <sch_text.h>
+#include <sch_component.h>
+#include <sch_marker.h>
+#include <netlist_object.h>
+#include <erc.h>
+
+#include <eeschema_test_utils.h>
+
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+
+extern int DiagErc[PINTYPE_COUNT][PINTYPE_COUNT];
+extern int DefaultDiagErc[PINTYPE_COUNT][PINTYPE_COUNT];
+
+
+/// Size of the area holding the random items
+static const int AREA_SIZE = 2000;
+
+/// Grid of the item positions
+static const int GRID = 50;
+
+
+/**
+ * The connection tests of DIALOG_ERC::TestErc(), as they were before they moved to
+ * TestConnections(): the items are tested one after the other, in the list order, and
+ * the markers are appended to the screens as they are found.
+ */
+static void testConnectionsInOrder( NETLIST_OBJECT_LIST* aList )
+{
+    aList->ResetConnectionsType();
+
+    unsigned lastItemIdx;
+    unsigned nextItemIdx = lastItemIdx = 0;
+    int MinConn    = NOC;
+
+    std::unordered_map<wxString, wxString> pin_to_net_map;
+
+    for( unsigned itemIdx = 0; itemIdx < aList->size(); itemIdx++ )
+    {
+        auto item = aList->GetItem( itemIdx );
+        auto lastItem = aList->GetItem( lastItemIdx );
+
+        if( lastItem->GetNet() != item->GetNet() )
+        {
+            // New net found:
+            MinConn      = NOC;
+            nextItemIdx = itemIdx;
+        }
+
+        switch( item->m_Type )
+        {
+        case NET_HIERLABEL:
+        case NET_HIERBUSLABELMEMBER:
+        case NET_SHEETLABEL:
+        case NET_SHEETBUSLABELMEMBER:
+        case NET_GLOBLABEL:     // the unique global labels are tested
+            aList->TestforNonOrphanLabel( itemIdx, nextItemIdx );
+            break;
+
+        case NET_NOCONNECT:
+            MinConn = NET_NC;
+
+            if( aList->CountPinsInNet( nextItemIdx ) > 1 )
+                Diagnose( item, NULL, MinConn, UNC );
+
+            break;
+
+        case NET_PIN:
+        {
+            if( item->m_Link )
+            {
+                auto ref = item->GetComponentParent()->GetRef( &item->m_SheetPath );
+                wxString pin_name = ref + "_" + item->m_PinNum;
+
+                if( pin_to_net_map.count( pin_name ) == 0 )
+                {
+                    pin_to_net_map[pin_name] = item->GetNetName();
+                }
+                else if( pin_to_net_map[pin_name] != item->GetNetName() )
+                {
+                    SCH_MARKER* marker = new SCH_MARKER();
+
+                    marker->SetTimeStamp( GetNewTimeStamp() );
+                    marker->SetData( ERCE_DIFFERENT_UNIT_NET, item->m_Start,
+                        wxString::Format( _( "Pin %s on %s is connected to both %s and %s" ),
+                        item->m_PinNum, ref, pin_to_net_map[pin_name], item->GetNetName() ),
+                        item->m_Start );
+                    marker->SetMarkerType( MARKER_BASE::MARKER_ERC );
+                    marker->SetErrorLevel( MARKER_BASE::MARKER_SEVERITY_ERROR );
+
+                    item->m_SheetPath.LastScreen()->Append( marker );
+                }
+            }
+
+            TestOthersItems( aList, itemIdx, nextItemIdx, &MinConn );
+            break;
+        }
+
+        default:
+            break;
+        }
+
+        lastItemIdx = itemIdx;
+    }
+
+    aList->TestforSimilarLabels();
+}
+
+
+/**
+ * A screen of random wires, junctions, labels, no connects and components whose pins
+ * conflict, and the ERC markers found in this screen.
+ */
+struct ErcFixture
+{
+    ErcFixture() :
+        m_rng( 4321 )
+    {
+        memcpy( DiagErc, DefaultDiagErc, sizeof( DiagErc ) );
+
+        m_rootSheet.SetScreen( new SCH_SCREEN( &TestKiway() ) );
+        m_screen = m_rootSheet.GetScreen();
+
+        addPart( wxT( "DRV" ), PIN_OUTPUT, wxT( "OUT" ), PIN_POWER_IN, wxT( "VCC" ) );
+        addPart( wxT( "RCV" ), PIN_INPUT, wxT( "IN" ), PIN_UNSPECIFIED, wxT( "X" ) );
+        addPart( wxT( "BUF" ), PIN_POWER_OUT, wxT( "PWR" ), PIN_OPENCOLLECTOR, wxT( "OC" ) );
+    }
+
+    /**
+     * Adds a part of two pins.  A power input pin is invisible, and connects the nets of
+     * its name.
+     */
+    void addPart( const wxString& aName, ELECTRICAL_PINTYPE aType1, const wxString& aName1,
+                  ELECTRICAL_PINTYPE aType2, const wxString& aName2 )
+    {
+        const wxPoint            pinPositions[2] = { wxPoint( 0, 150 ), wxPoint( 0, -150 ) };
+        const int                orientations[2] = { PIN_DOWN, PIN_UP };
+        const ELECTRICAL_PINTYPE types[2] = { aType1, aType2 };
+        const wxString           names[2] = { aName1, aName2 };
+
+        LIB_PART* part = new LIB_PART( aName );
+
+        for( int ii = 0; ii < 2; ii++ )
+        {
+            LIB_PIN* pin = new LIB_PIN( part );
+            pin->Move( pinPositions[ii] );
+            pin->SetOrientation( orientations[ii], false );
+            pin->SetLength( 50, false );
+            pin->SetNumber( wxString::Format( wxT( "%d" ), ii + 1 ) );
+            pin->SetName( names[ii], false );
+            pin->SetType( types[ii], false );
+            pin->SetVisible( types[ii] != PIN_POWER_IN );
+            part->AddDrawItem( pin );
+        }
+
+        m_parts.emplace_back( part );
+    }
+
+    int randomCoord()
+    {
+        return (int)( m_rng() % ( AREA_SIZE / GRID + 1 ) ) * GRID;
+    }
+
+    wxPoint randomPoint()
+    {
+        int x = randomCoord();
+        return wxPoint( x, randomCoord() );
+    }
+
+    SCH_ITEM* newRandomItem()
+    {
+        // Labels differing by their case are reported
+        static const wxChar* labels[] = { wxT( "A" ), wxT( "a" ), wxT( "CLK" ), wxT( "Clk" ),
+                                          wxT( "VCC" ), wxT( "D" ) };
+        wxPoint pos = randomPoint();
+
+        switch( m_rng() % 10 )
+        {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+        {
+            SCH_LINE* line = new SCH_LINE( pos, LAYER_WIRE );
+            int length = (int)( 1 + m_rng() % 10 ) * GRID;
+
+            if( m_rng() % 2 )
+                line->SetEndPoint( pos + wxPoint( length, 0 ) );
+            else
+                line->SetEndPoint( pos + wxPoint( 0, length ) );
+
+            return line;
+        }
+
+        case 4:
+            return new SCH_JUNCTION( pos );
+
+        case 5:
+            return new SCH_LABEL( pos, labels[ m_rng() % 6 ] );
+
+        case 6:
+            switch( m_rng() % 3 )
+            {
+            case 0:  return new SCH_GLOBALLABEL( pos, labels[ m_rng() % 6 ] );
+            case 1:  return new SCH_HIERLABEL( pos, wxT( "H" ) );
+            default: return new SCH_NO_CONNECT( pos );
+            }
+
+        default:
+        {
+            SCH_COMPONENT* component = new SCH_COMPONENT( pos );
+            component->GetPartRef() = m_parts[ m_rng() % m_parts.size() ]->SharedPtr();
+            component->UpdatePinCache();
+
+            // Components sharing a reference are units of a same part
+            component->GetField( REFERENCE )->SetText(
+                    wxString::Format( wxT( "U%d" ), (int)( 1 + m_rng() % 20 ) ) );
+
+            if( m_rng() % 2 )
+                component->SetOrientation( CMP_ROTATE_CLOCKWISE );
+
+            return component;
+        }
+        }
+    }
+
+    void addRandomItems( int aCount )
+    {
+        for( int ii = 0; ii < aCount; ii++ )
+            m_screen->Append( newRandomItem() );
+    }
+
+    /**
+     * Runs the connection tests of the ERC with aThreadCount threads, or in order
+     * with testConnectionsInOrder() if aThreadCount is negative.
+     * @return the description of the markers found, in the order of the screen
+     */
+    std::vector<wxString> runErc( int aThreadCount )
+    {
+        SCH_SHEET_LIST      sheets( &m_rootSheet );
+        NETLIST_OBJECT_LIST netlist;
+
+        netlist.BuildNetListInfo( sheets );
+
+        if( aThreadCount < 0 )
+            testConnectionsInOrder( &netlist );
+        else
+            TestConnections( &netlist, true, true, aThreadCount );
+
+        std::vector<wxString> markers;
+
+        for( SCH_ITEM* item = m_screen->GetDrawItems(); item; item = item->Next() )
+        {
+            if( item->Type() != SCH_MARKER_T )
+                continue;
+
+            SCH_MARKER*     marker = static_cast<SCH_MARKER*>( item );
+            const DRC_ITEM& report = marker->GetReporter();
+
+            markers.push_back( wxString::Format( wxT( "%d %d (%d, %d) %s %s" ),
+                                                 report.GetErrorCode(),
+                                                 (int) marker->GetErrorLevel(),
+                                                 marker->GetPos().x, marker->GetPos().y,
+                                                 report.GetMainText(),
+                                                 report.GetAuxiliaryText() ) );
+        }
+
+        m_screen->DeleteAllMarkers( MARKER_BASE::MARKER_ERC );
+
+        return markers;
+    }
+
+    std::vector<std::unique_ptr<LIB_PART>> m_parts;     ///< must outlive the components
+    SCH_SHEET       m_rootSheet;
+    SCH_SCREEN*     m_screen;
+    std::mt19937    m_rng;
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( Erc, ErcFixture )
+
+
+/**
+ * Check the connection tests find the markers found by testing the items in order,
+ * whatever the thread count
+ */
+BOOST_AUTO_TEST_CASE( SameMarkers )
+{
+    for( int round = 0; round < 4; round++ )
+    {
+        addRandomItems( 150 );
+
+        std::vector<wxString> expected = runErc( -1 );
+
+        // The scene must give markers for the check to mean anything
+        BOOST_CHECK( !expected.empty() );
+
+        BOOST_CHECK( runErc( 1 ) == expected );
+        BOOST_CHECK( runErc( 2 ) == expected );
+        BOOST_CHECK( runErc( 8 ) == expected );
+        BOOST_CHECK( runErc( 0 ) == expected );
+    }
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,234 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <properties.h>
+#include <class_libentry.h>
+#include <lib_pin.h>
+#include <lib_field.h>
+#include <sch_io_mgr.h>
+#include <symbol_lib_table.h>
+
+#include <eeschema_test_utils.h>
+
+#include <map>
+#include <vector>
+
+
+/// The symbols of a library, by alias name
+typedef std::map<wxString, wxString> SYMBOL_DESCRIPTIONS;
+
+
+/**
+ * @return a description of \a aAlias, its documentation and everything parsed in the
+ * DEF entry of its symbol
+ */
+static wxString describeAlias( LIB_ALIAS* aAlias )
+{
+    LIB_PART* part = aAlias->GetPart();
+    wxString  desc;
+
+    desc << aAlias->GetName() << wxT( "|" ) << aAlias->GetDescription() << wxT( "|" )
+         << aAlias->GetKeyWords() << wxT( "|" ) << aAlias->GetDocFileName() << wxT( "\n" );
+
+    desc << part->GetName() << wxT( " units " ) << part->GetUnitCount()
+         << wxT( " convert " ) << part->HasConversion()
+         << wxT( " power " ) << part->IsPower()
+         << wxT( " offset " ) << part->GetPinNameOffset()
+         << wxT( " names " ) << part->ShowPinNames() << wxT( "\n" );
+
+    for( const wxString& name : part->GetAliasNames() )
+        desc << wxT( "alias " ) << name << wxT( "\n" );
+
+    for( const wxString& footprint : part->GetFootprints() )
+        desc << wxT( "footprint " ) << footprint << wxT( "\n" );
+
+    for( LIB_ITEM& item : part->GetDrawItems() )
+    {
+        desc << item.GetSelectMenuText( MILLIMETRES )
+             << wxT( " unit " ) << item.GetUnit() << wxT( " convert " ) << item.GetConvert()
+             << wxT( " at " ) << item.GetPosition().x << wxT( "," ) << item.GetPosition().y;
+
+        if( item.Type() == LIB_PIN_T )
+        {
+            LIB_PIN& pin = static_cast<LIB_PIN&>( item );
+
+            desc << wxT( " pin " ) << pin.GetNumber() << wxT( " " ) << pin.GetName()
+                 << wxT( " " ) << (int) pin.GetType() << wxT( " " ) << pin.GetOrientation()
+                 << wxT( " " ) << pin.GetLength();
+        }
+        else if( item.Type() == LIB_FIELD_T )
+        {
+            LIB_FIELD& field = static_cast<LIB_FIELD&>( item );
+
+            desc << wxT( " field " ) << field.GetName( false ) << wxT( "=" ) << field.GetText();
+        }
+
+        desc << wxT( "\n" );
+    }
+
+    return desc;
+}
+
+
+/**
+ * A legacy library of symbols with aliases, documentation, footprint filters, units and
+ * power symbols, and an alias name used twice, loaded by new plugins.
+ */
+struct LegacyLibraryFixture
+{
+    LegacyLibraryFixture() :
+        m_libPath( TestDataFile( wxT( "legacy_library.lib" ) ) )
+    {
+    }
+
+    SCH_PLUGIN* newPlugin()
+    {
+        return SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_LEGACY );
+    }
+
+    /**
+     * @return the symbols of the library listed with their LIB_ALIAS, which parses all
+     * the symbols in the file order as the library used to be loaded
+     */
+    SYMBOL_DESCRIPTIONS parseAll( const PROPERTIES* aProperties = NULL )
+    {
+        SCH_PLUGIN::SCH_PLUGIN_RELEASER plugin( newPlugin() );
+        std::vector<LIB_ALIAS*>         aliases;
+        SYMBOL_DESCRIPTIONS             symbols;
+
+        plugin->EnumerateSymbolLib( aliases, m_libPath, aProperties );
+
+        for( LIB_ALIAS* alias : aliases )
+            symbols[ alias->GetName() ] = describeAlias( alias );
+
+        return symbols;
+    }
+
+    wxString m_libPath;
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( LegacyLibrary, LegacyLibraryFixture )
+
+
+/**
+ * Check the symbols parsed on first access, in the reverse order of the file, are the
+ * symbols parsed all at once
+ */
+BOOST_AUTO_TEST_CASE( LazyParsing )
+{
+    SYMBOL_DESCRIPTIONS expected = parseAll();
+
+    BOOST_REQUIRE( expected.size() > 30 );
+
+    // The duplicated alias is renamed
+    BOOST_CHECK( expected.count( wxT( "CAPAPOL" ) ) == 1 );
+    BOOST_CHECK( expected.at( wxT( "R" ) ).StartsWith( wxT( "R|Resistor|" ) ) );
+    BOOST_CHECK( expected.at( wxT( "24C512" ) ).Contains( wxT( "Serial EEPROM" ) ) );
+
+    SCH_PLUGIN::SCH_PLUGIN_RELEASER plugin( newPlugin() );
+    wxArrayString                   names;
+    SYMBOL_DESCRIPTIONS             symbols;
+
+    // Listing the names does not need the symbols
+    plugin->EnumerateSymbolLib( names, m_libPath );
+    BOOST_CHECK_EQUAL( names.size(), expected.size() );
+
+    for( int ii = (int) names.size() - 1; ii >= 0; ii-- )
+    {
+        LIB_ALIAS* alias = plugin->LoadSymbol( m_libPath, names[ii] );
+
+        BOOST_REQUIRE( alias );
+        symbols[ names[ii] ] = describeAlias( alias );
+    }
+
+    BOOST_CHECK( symbols == expected );
+}
+
+
+/**
+ * Check the symbols parsed all at once after some symbols were parsed on first access
+ * (the reader skips them) are the symbols of a library parsed all at once
+ */
+BOOST_AUTO_TEST_CASE( PartlyParsed )
+{
+    SYMBOL_DESCRIPTIONS expected = parseAll();
+
+    SCH_PLUGIN::SCH_PLUGIN_RELEASER plugin( newPlugin() );
+    wxArrayString                   names;
+    std::vector<LIB_ALIAS*>         aliases;
+    SYMBOL_DESCRIPTIONS             symbols;
+
+    plugin->EnumerateSymbolLib( names, m_libPath );
+
+    for( size_t ii = 1; ii < names.size(); ii += 3 )
+        BOOST_REQUIRE( plugin->LoadSymbol( m_libPath, names[ii] ) );
+
+    plugin->EnumerateSymbolLib( aliases, m_libPath );
+
+    for( LIB_ALIAS* alias : aliases )
+        symbols[ alias->GetName() ] = describeAlias( alias );
+
+    BOOST_CHECK( symbols == expected );
+}
+
+
+/**
+ * Check the power symbols listed without parsing the other symbols are the power
+ * symbols of the fully parsed library
+ */
+BOOST_AUTO_TEST_CASE( PowerSymbols )
+{
+    PROPERTIES powerOnly;
+    powerOnly[ SYMBOL_LIB_TABLE::PropPowerSymsOnly ] = "";
+
+    SYMBOL_DESCRIPTIONS expected;
+
+    for( const auto& symbol : parseAll() )
+    {
+        if( symbol.second.Contains( wxT( " power 1 " ) ) )
+            expected.insert( symbol );
+    }
+
+    BOOST_CHECK_EQUAL( expected.size(), 3u );
+
+    SCH_PLUGIN::SCH_PLUGIN_RELEASER plugin( newPlugin() );
+    wxArrayString                   names;
+
+    plugin->EnumerateSymbolLib( names, m_libPath, &powerOnly );
+    BOOST_CHECK_EQUAL( names.size(), expected.size() );
+
+    for( const wxString& name : names )
+        BOOST_CHECK( expected.count( name ) == 1 );
+
+    BOOST_CHECK( parseAll( &powerOnly ) == expected );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,272 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <sch_screen.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <sch_line.h>
+#include <sch_junction.h>
+#include <sch_text.h>
+#include <netlist_object.h>
+
+#include <eeschema_test_utils.h>
+
+#include <map>
+#include <set>
+
+
+/// The nets of a netlist, each net given by the names of its labels and sheet pins
+typedef std::set<std::set<wxString>> NET_GROUPS;
+
+
+/**
+ * A hierarchy of three sub sheets, two of them sharing a screen, connected by wires,
+ * junctions, buses, local, global and hierarchical labels, and sheet pins.
+ */
+struct NetlistFixture
+{
+    NetlistFixture()
+    {
+        m_rootSheet.SetScreen( new SCH_SCREEN( &TestKiway() ) );
+        m_rootScreen = m_rootSheet.GetScreen();
+
+        // The screen shared by two sheets: its hierarchical label goes to a local label,
+        // and a global label
+        m_sharedScreen = new SCH_SCREEN( &TestKiway() );
+        m_sharedScreen->Append( new SCH_HIERLABEL( wxPoint( 1000, 1000 ), wxT( "IN" ) ) );
+        m_localWire = addWire( m_sharedScreen, wxPoint( 1000, 1000 ), wxPoint( 2000, 1000 ) );
+        m_sharedScreen->Append( new SCH_LABEL( wxPoint( 2000, 1000 ), wxT( "LOCAL" ) ) );
+        addWire( m_sharedScreen, wxPoint( 1000, 2000 ), wxPoint( 2000, 2000 ) );
+        m_sharedScreen->Append( new SCH_GLOBALLABEL( wxPoint( 1000, 2000 ), wxT( "G" ) ) );
+
+        // A local label of the same name as a label of the root sheet
+        SCH_SCREEN* screen = new SCH_SCREEN( &TestKiway() );
+        screen->Append( new SCH_HIERLABEL( wxPoint( 1000, 1000 ), wxT( "X" ) ) );
+        addWire( screen, wxPoint( 1000, 1000 ), wxPoint( 2000, 1000 ) );
+        screen->Append( new SCH_LABEL( wxPoint( 2000, 1000 ), wxT( "L" ) ) );
+
+        addSheet( wxT( "Sub1" ), 0x1001, wxPoint( 3000, 1000 ), m_sharedScreen, wxT( "IN" ),
+                  new SCH_LABEL( wxPoint( 1000, 1500 ), wxT( "N1" ) ) );
+        addSheet( wxT( "Sub2" ), 0x1002, wxPoint( 3000, 3000 ), m_sharedScreen, wxT( "IN" ),
+                  new SCH_LABEL( wxPoint( 1000, 3500 ), wxT( "N2" ) ) );
+        m_sheet3 = addSheet( wxT( "Sub3" ), 0x1003, wxPoint( 6000, 1000 ), screen, wxT( "X" ),
+                             new SCH_GLOBALLABEL( wxPoint( 4500, 1500 ), wxT( "G" ) ) );
+
+        // Two wires crossing without a junction
+        addWire( m_rootScreen, wxPoint( 1000, 5000 ), wxPoint( 2000, 5000 ) );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 1000, 5000 ), wxT( "C1" ) ) );
+        addWire( m_rootScreen, wxPoint( 1500, 4500 ), wxPoint( 1500, 5500 ) );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 1500, 4500 ), wxT( "C2" ) ) );
+
+        // Two wires crossing at a junction
+        addWire( m_rootScreen, wxPoint( 3000, 6000 ), wxPoint( 4000, 6000 ) );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 3000, 6000 ), wxT( "J1" ) ) );
+        addWire( m_rootScreen, wxPoint( 3500, 5500 ), wxPoint( 3500, 6500 ) );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 3500, 5500 ), wxT( "J2" ) ) );
+        m_rootScreen->Append( new SCH_JUNCTION( wxPoint( 3500, 6000 ) ) );
+
+        // Two wires connected by their label names
+        addWire( m_rootScreen, wxPoint( 1000, 7000 ), wxPoint( 1500, 7000 ) );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 1000, 7000 ), wxT( "L" ) ) );
+        addWire( m_rootScreen, wxPoint( 3000, 7000 ), wxPoint( 3500, 7000 ) );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 3000, 7000 ), wxT( "L" ) ) );
+
+        // Two bus labels on a bus, and a wire connected to a bus member by its name
+        SCH_LINE* bus = new SCH_LINE( wxPoint( 1000, 8000 ), LAYER_BUS );
+        bus->SetEndPoint( wxPoint( 3000, 8000 ) );
+        m_rootScreen->Append( bus );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 1000, 8000 ), wxT( "D[0..1]" ) ) );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 3000, 8000 ), wxT( "E[0..1]" ) ) );
+        addWire( m_rootScreen, wxPoint( 1000, 9000 ), wxPoint( 1500, 9000 ) );
+        m_rootScreen->Append( new SCH_LABEL( wxPoint( 1000, 9000 ), wxT( "D0" ) ) );
+    }
+
+    SCH_LINE* addWire( SCH_SCREEN* aScreen, const wxPoint& aStart, const wxPoint& aEnd )
+    {
+        SCH_LINE* wire = new SCH_LINE( aStart, LAYER_WIRE );
+        wire->SetEndPoint( aEnd );
+        aScreen->Append( wire );
+        return wire;
+    }
+
+    /**
+     * Adds a sheet to the root sheet, with a sheet pin wired to \a aLabel.
+     */
+    SCH_SHEET* addSheet( const wxString& aName, timestamp_t aTimeStamp, const wxPoint& aPos,
+                         SCH_SCREEN* aScreen, const wxString& aPinName, SCH_TEXT* aLabel )
+    {
+        SCH_SHEET* sheet = new SCH_SHEET( aPos );
+        sheet->SetSize( wxSize( 1000, 1000 ) );
+        sheet->SetName( aName );
+        sheet->SetTimeStamp( aTimeStamp );
+        sheet->SetScreen( aScreen );
+
+        SCH_SHEET_PIN* pin = new SCH_SHEET_PIN( sheet, aPos + wxPoint( 0, 500 ), aPinName );
+        sheet->AddPin( pin );
+        m_rootScreen->Append( sheet );
+
+        addWire( m_rootScreen, aLabel->GetTextPos(), pin->GetPosition() );
+        m_rootScreen->Append( aLabel );
+
+        return sheet;
+    }
+
+    /**
+     * @return the nets found by NETLIST_OBJECT_LIST::BuildNetListInfo() in the hierarchy
+     */
+    NET_GROUPS buildNets( NETLIST_CONNECTIONS_CACHE* aCache )
+    {
+        SCH_SHEET_LIST      sheets( &m_rootSheet );
+        NETLIST_OBJECT_LIST netlist;
+        std::map<int, std::set<wxString>> nets;
+
+        BOOST_REQUIRE( netlist.BuildNetListInfo( sheets, aCache ) );
+
+        for( unsigned ii = 0; ii < netlist.size(); ii++ )
+        {
+            NETLIST_OBJECT* item = netlist.GetItem( ii );
+            wxString        kind;
+
+            switch( item->m_Type )
+            {
+            case NET_LABEL:                 kind = wxT( "L" ); break;
+            case NET_GLOBLABEL:             kind = wxT( "G" ); break;
+            case NET_HIERLABEL:             kind = wxT( "H" ); break;
+            case NET_BUSLABELMEMBER:        kind = wxT( "B" ); break;
+            case NET_SHEETLABEL:            kind = wxT( "S" ); break;
+            default:                        continue;
+            }
+
+            // The sheet pins are named in the sheet they go to, not in the sheet they
+            // are drawn in
+            const SCH_SHEET_PATH& path = ( item->m_Type == NET_SHEETLABEL ) ?
+                                         item->m_SheetPathInclude : item->m_SheetPath;
+
+            nets[ item->GetNet() ].insert( path.PathHumanReadable() + kind + wxT( ":" )
+                                           + item->m_Label );
+        }
+
+        NET_GROUPS groups;
+
+        for( const auto& net : nets )
+            groups.insert( net.second );
+
+        return groups;
+    }
+
+    /**
+     * Checks the nets found with aCache, after an edit, are the nets found without a cache.
+     */
+    void checkSameNets( NETLIST_CONNECTIONS_CACHE& aCache )
+    {
+        NET_GROUPS cached = buildNets( &aCache );
+
+        BOOST_CHECK( cached == buildNets( NULL ) );
+    }
+
+    SCH_SHEET       m_rootSheet;
+    SCH_SCREEN*     m_rootScreen;
+    SCH_SCREEN*     m_sharedScreen;     ///< the screen of Sub1 and Sub2
+    SCH_SHEET*      m_sheet3;
+    SCH_LINE*       m_localWire;        ///< the wire of the label LOCAL in m_sharedScreen
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( Netlist, NetlistFixture )
+
+
+/**
+ * Check the nets of the hierarchy
+ */
+BOOST_AUTO_TEST_CASE( HierarchyNets )
+{
+    const NET_GROUPS expected = {
+        { "/L:N1", "/Sub1/S:IN", "/Sub1/H:IN", "/Sub1/L:LOCAL" },
+        { "/L:N2", "/Sub2/S:IN", "/Sub2/H:IN", "/Sub2/L:LOCAL" },
+        { "/G:G", "/Sub1/G:G", "/Sub2/G:G", "/Sub3/S:X", "/Sub3/H:X", "/Sub3/L:L" },
+        { "/L:C1" },
+        { "/L:C2" },
+        { "/L:J1", "/L:J2" },
+        { "/L:L" },
+        { "/B:D0", "/B:E0", "/L:D0" },
+        { "/B:D1", "/B:E1" },
+    };
+
+    BOOST_CHECK( buildNets( NULL ) == expected );
+}
+
+
+/**
+ * Check the nets found with the connections of a previous netlist are the nets found
+ * from scratch, with the sheets sharing a screen searched once
+ */
+BOOST_AUTO_TEST_CASE( CachedNets )
+{
+    NETLIST_CONNECTIONS_CACHE cache;
+    NET_GROUPS fresh = buildNets( NULL );
+
+    BOOST_CHECK( buildNets( &cache ) == fresh );
+    BOOST_CHECK_EQUAL( cache.m_Sheets.size(), 3u );
+
+    BOOST_CHECK( buildNets( &cache ) == fresh );
+}
+
+
+/**
+ * Check the nets found with the connections of a previous netlist follow the edits of
+ * the shared screen, of the root screen and of the hierarchy
+ */
+BOOST_AUTO_TEST_CASE( EditedNets )
+{
+    NETLIST_CONNECTIONS_CACHE cache;
+    NET_GROUPS before = buildNets( &cache );
+
+    // Disconnect the local label of both sheets using the shared screen
+    m_localWire->SetEndPoint( wxPoint( 1900, 1000 ) );
+    checkSameNets( cache );
+
+    NET_GROUPS groups = buildNets( &cache );
+    BOOST_CHECK( groups != before );
+    BOOST_CHECK( groups.count( { "/Sub1/L:LOCAL" } ) == 1 );
+    BOOST_CHECK( groups.count( { "/Sub2/L:LOCAL" } ) == 1 );
+
+    // Connect the crossing wires
+    m_rootScreen->Append( new SCH_JUNCTION( wxPoint( 1500, 5000 ) ) );
+    checkSameNets( cache );
+    BOOST_CHECK( buildNets( &cache ).count( { "/L:C1", "/L:C2" } ) == 1 );
+
+    // Remove a sheet from the hierarchy
+    m_rootScreen->Remove( m_sheet3 );
+    delete m_sheet3;
+    checkSameNets( cache );
+    BOOST_CHECK_EQUAL( cache.m_Sheets.size(), 2u );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,339 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <fctsys.h>
+#include <class_libentry.h>
+#include <lib_pin.h>
+#include <sch_screen.h>
+#include <sch_line.h>
+#include <sch_junction.h>
+#include <sch_no_connect.h>
+#include <sch_text.h>
+#include <sch_component.h>
+#include <sch_edit_frame.h>
+
+#include <eeschema_test_utils.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+
+/// Size of the area holding the random items
+static const int AREA_SIZE = 2500;
+
+/// Grid of the item positions
+static const int GRID = 50;
+
+
+/**
+ * A screen of random wires, buses, junctions, labels, no connects and two-pin
+ * components, and the position queries of SCH_SCREEN run over the whole area with
+ * and without the item index.
+ */
+struct ItemIndexFixture
+{
+    ItemIndexFixture() :
+        m_part( wxT( "R" ) ),
+        m_screen( &TestKiway() ),
+        m_rng( 1234 )
+    {
+        const wxPoint pinPositions[2] = { wxPoint( 0, 150 ), wxPoint( 0, -150 ) };
+        const int     orientations[2] = { PIN_DOWN, PIN_UP };
+
+        for( int ii = 0; ii < 2; ii++ )
+        {
+            LIB_PIN* pin = new LIB_PIN( &m_part );
+            pin->Move( pinPositions[ii] );
+            pin->SetOrientation( orientations[ii], false );
+            pin->SetLength( 50, false );
+            pin->SetNumber( wxString::Format( wxT( "%d" ), ii + 1 ) );
+            m_part.AddDrawItem( pin );
+        }
+    }
+
+    int randomCoord()
+    {
+        return (int)( m_rng() % ( AREA_SIZE / GRID + 1 ) ) * GRID;
+    }
+
+    wxPoint randomPoint()
+    {
+        int x = randomCoord();
+        return wxPoint( x, randomCoord() );
+    }
+
+    SCH_ITEM* newRandomItem()
+    {
+        wxPoint pos = randomPoint();
+
+        switch( m_rng() % 8 )
+        {
+        case 0:
+        case 1:
+        case 2:
+        case 3:
+        {
+            SCH_LINE* line = new SCH_LINE( pos, ( m_rng() % 4 ) ? LAYER_WIRE : LAYER_BUS );
+            int length = (int)( 1 + m_rng() % 20 ) * GRID;
+
+            if( m_rng() % 2 )
+                line->SetEndPoint( pos + wxPoint( length, 0 ) );
+            else
+                line->SetEndPoint( pos + wxPoint( 0, length ) );
+
+            return line;
+        }
+
+        case 4:
+            return new SCH_JUNCTION( pos );
+
+        case 5:
+            return new SCH_LABEL( pos, wxT( "NET" ) );
+
+        case 6:
+            if( m_rng() % 2 )
+                return new SCH_GLOBALLABEL( pos, wxT( "GLOBAL" ) );
+            else
+                return new SCH_NO_CONNECT( pos );
+
+        default:
+        {
+            SCH_COMPONENT* component = new SCH_COMPONENT( pos );
+            component->GetPartRef() = m_part.SharedPtr();
+            component->UpdatePinCache();
+            component->GetField( REFERENCE )->SetText( wxT( "R1" ) );
+
+            if( m_rng() % 2 )
+                component->SetOrientation( CMP_ROTATE_CLOCKWISE );
+
+            return component;
+        }
+        }
+    }
+
+    void addRandomItems( int aCount )
+    {
+        for( int ii = 0; ii < aCount; ii++ )
+            m_screen.Append( newRandomItem() );
+    }
+
+    std::vector<SCH_ITEM*> items() const
+    {
+        std::vector<SCH_ITEM*> list;
+
+        for( SCH_ITEM* item = m_screen.GetDrawItems(); item; item = item->Next() )
+            list.push_back( item );
+
+        return list;
+    }
+
+    /**
+     * Runs the position queries on the half grid of the area.  The items found are
+     * stored in aHits, the other results in aValues.
+     */
+    void runQueries( std::vector<const void*>& aHits, std::vector<int>& aValues )
+    {
+        aHits.clear();
+        aValues.clear();
+
+        for( int x = -GRID; x <= AREA_SIZE + GRID; x += GRID / 2 )
+        {
+            for( int y = -GRID; y <= AREA_SIZE + GRID; y += GRID / 2 )
+            {
+                wxPoint        pos( x, y );
+                SCH_COMPONENT* component = NULL;
+
+                aHits.push_back( m_screen.GetItem( pos ) );
+                aHits.push_back( m_screen.GetItem( pos, 20, SCH_LINE_T ) );
+                aHits.push_back( m_screen.GetItem( pos, 0, SCH_JUNCTION_T ) );
+                aHits.push_back( m_screen.GetItem( pos, 0, SCH_LABEL_T ) );
+                aHits.push_back( m_screen.GetItem( pos, 5, SCH_FIELD_T ) );
+                aHits.push_back( m_screen.GetPin( pos, &component ) );
+                aHits.push_back( component );
+                aHits.push_back( m_screen.GetPin( pos, NULL, true ) );
+                aHits.push_back( m_screen.GetLabel( pos ) );
+                aHits.push_back( m_screen.GetLabel( pos, 10 ) );
+                aHits.push_back( m_screen.GetWireOrBus( pos ) );
+                aHits.push_back( m_screen.GetLine( pos, 0, LAYER_WIRE, END_POINTS_ONLY_T ) );
+
+                aValues.push_back( m_screen.IsJunctionNeeded( pos ) );
+                aValues.push_back( m_screen.IsJunctionNeeded( pos, true ) );
+                aValues.push_back( m_screen.IsTerminalPoint( pos, LAYER_WIRE ) );
+                aValues.push_back( m_screen.IsTerminalPoint( pos, LAYER_BUS ) );
+                aValues.push_back( m_screen.CountConnectedItems( pos, false ) );
+                aValues.push_back( m_screen.CountConnectedItems( pos, true ) );
+            }
+        }
+    }
+
+    /**
+     * Checks the queries give the same results with the item index as with a walk of the
+     * whole draw list.
+     */
+    void checkSameResults()
+    {
+        std::vector<const void*> indexedHits, linearHits;
+        std::vector<int>         indexedValues, linearValues;
+
+        BOOST_REQUIRE( m_screen.IsItemIndexEnabled() );
+        runQueries( indexedHits, indexedValues );
+
+        m_screen.EnableItemIndex( false );
+        runQueries( linearHits, linearValues );
+        m_screen.EnableItemIndex( true );
+
+        BOOST_CHECK( indexedHits == linearHits );
+        BOOST_CHECK( indexedValues == linearValues );
+
+        // The scene must give some hits for the check to mean anything
+        BOOST_CHECK( std::count( linearHits.begin(), linearHits.end(), nullptr )
+                     < (long) linearHits.size() );
+    }
+
+    LIB_PART        m_part;         ///< must outlive the components of m_screen
+    SCH_SCREEN      m_screen;
+    std::mt19937    m_rng;
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( SchItemIndex, ItemIndexFixture )
+
+
+/**
+ * Check the queries of a freshly loaded screen
+ */
+BOOST_AUTO_TEST_CASE( Queries )
+{
+    addRandomItems( 400 );
+    checkSameResults();
+}
+
+
+/**
+ * Check the index follows the items added, inserted, removed and moved through the
+ * screen
+ */
+BOOST_AUTO_TEST_CASE( Edits )
+{
+    addRandomItems( 400 );
+
+    std::vector<SCH_ITEM*> list = items();
+
+    for( size_t ii = 0; ii < list.size(); ii++ )
+    {
+        SCH_ITEM* item = list[ii];
+
+        switch( ii % 8 )
+        {
+        case 0:
+            m_screen.Remove( item );
+            delete item;
+            break;
+
+        case 1:
+            item->Move( wxPoint( GRID * 3, -GRID ) );
+            m_screen.UpdateItem( item );
+            break;
+
+        case 2:
+            item->Rotate( wxPoint( AREA_SIZE / 2, AREA_SIZE / 2 ) );
+            m_screen.UpdateItem( item );
+            break;
+
+        case 3:
+            if( item->Type() == SCH_COMPONENT_T )
+            {
+                SCH_FIELD* field = static_cast<SCH_COMPONENT*>( item )->GetField( REFERENCE );
+                field->Move( wxPoint( GRID * 4, GRID * 4 ) );
+                m_screen.UpdateItem( field );
+            }
+            break;
+
+        case 4:
+            // Inserted items are found before the items following them in the list
+            m_screen.Insert( new SCH_JUNCTION( item->GetPosition() ), item );
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    addRandomItems( 100 );
+    checkSameResults();
+}
+
+
+/**
+ * Check the batch operations bring the index up to date with the items changed without
+ * telling the screen
+ */
+BOOST_AUTO_TEST_CASE( UntrackedMoves )
+{
+    addRandomItems( 400 );
+
+    std::vector<SCH_ITEM*> list = items();
+
+    for( size_t ii = 0; ii < list.size(); ii += 3 )
+        list[ii]->Move( wxPoint( -GRID * 2, GRID * 5 ) );
+
+    m_screen.TestDanglingEnds();
+    checkSameResults();
+}
+
+
+/**
+ * Check the dangling end states found with the index are the states found by testing
+ * each item with the end points of all the items
+ */
+BOOST_AUTO_TEST_CASE( DanglingEnds )
+{
+    addRandomItems( 400 );
+
+    m_screen.TestDanglingEnds();
+
+    std::vector<SCH_ITEM*> list = items();
+    std::vector<bool>      indexedStates;
+
+    for( SCH_ITEM* item : list )
+        indexedStates.push_back( item->IsDangling() );
+
+    m_screen.EnableItemIndex( false );
+
+    // Nothing changes when the items are tested with all the end points
+    BOOST_CHECK( !m_screen.TestDanglingEnds() );
+
+    for( size_t ii = 0; ii < list.size(); ii++ )
+        BOOST_CHECK_EQUAL( list[ii]->IsDangling(), indexedStates[ii] );
+
+    BOOST_CHECK( std::count( indexedStates.begin(), indexedStates.end(), true ) > 0 );
+    BOOST_CHECK( std::count( indexedStates.begin(), indexedStates.end(), false ) > 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
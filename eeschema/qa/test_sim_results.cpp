@@ -0,0 +1,445 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <sim/sim_results.h>
+#include <sim/sim_plot_panel.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+
+/// Points plotted by a trace, as (x, y) pairs
+typedef std::vector<std::pair<double, double>> PLOTTED_POINTS;
+
+
+/// A view of the plot area, as given by mpWindow to TRACE::decimate()
+struct PLOT_VIEW
+{
+    double  m_posX;
+    double  m_scaleX;
+    wxCoord m_startPx;
+    wxCoord m_endPx;
+};
+
+
+/**
+ * A trace whose decimation can be run without a plot window
+ */
+class TEST_TRACE : public TRACE
+{
+public:
+    TEST_TRACE() :
+        TRACE( wxT( "test" ) )
+    {
+    }
+
+    /**
+     * @return the points plotted for \a aView, decimated from the streamed points
+     */
+    PLOTTED_POINTS Decimate( const PLOT_VIEW& aView )
+    {
+        decimate( aView.m_posX, aView.m_scaleX, aView.m_startPx, aView.m_endPx );
+
+        PLOTTED_POINTS points;
+
+        for( size_t i = 0; i < m_xs.size(); ++i )
+            points.emplace_back( m_xs[i], m_ys[i] );
+
+        return points;
+    }
+};
+
+
+/**
+ * The decimation of the streamed points as it was before the blocks of points: all the
+ * points are read, and the first, the lowest, the highest and the last point of each pixel
+ * column are kept.
+ */
+static PLOTTED_POINTS decimatePointByPoint( const TRACE& aTrace, const PLOT_VIEW& aView )
+{
+    PLOTTED_POINTS points;
+    const size_t   count = aTrace.GetPointCount();
+
+    auto column = [&]( size_t aPoint ) -> wxCoord
+    {
+        double px = ( aTrace.x2s( aTrace.GetX( aPoint ) ) - aView.m_posX ) * aView.m_scaleX;
+
+        if( !( px >= aView.m_startPx - 1 ) )
+            return aView.m_startPx - 1;
+
+        if( px > aView.m_endPx + 1 )
+            return aView.m_endPx + 1;
+
+        return (wxCoord) px;
+    };
+
+    size_t i = 0;
+
+    while( i < count )
+    {
+        const wxCoord col = column( i );
+        size_t first = i, last = i, minIdx = i, maxIdx = i;
+        double minY = aTrace.GetY( i ), maxY = minY;
+
+        for( ++i; i < count && column( i ) == col; ++i )
+        {
+            double y = aTrace.GetY( i );
+
+            if( y < minY )
+            {
+                minY = y;
+                minIdx = i;
+            }
+
+            if( y > maxY )
+            {
+                maxY = y;
+                maxIdx = i;
+            }
+
+            last = i;
+        }
+
+        const size_t kept[] = { first, std::min( minIdx, maxIdx ), std::max( minIdx, maxIdx ),
+                                last };
+
+        for( size_t k = 0; k < 4; ++k )
+        {
+            if( k > 0 && kept[k] == kept[k - 1] )
+                continue;
+
+            points.emplace_back( aTrace.GetX( kept[k] ), aTrace.GetY( kept[k] ) );
+        }
+    }
+
+    return points;
+}
+
+
+/**
+ * Simulation results of a vector of X values, a real vector and a complex vector, the
+ * values of each point being computed from the point index.
+ */
+struct SimResultsFixture
+{
+    SimResultsFixture() :
+        m_results( std::make_shared<SIM_RESULTS>(
+                std::vector<std::string>( { "time", "V(out)", "I(R1)" } ),
+                std::vector<bool>( { false, false, true } ) ) ),
+        m_rng( 1234 )
+    {
+    }
+
+    static double realValue( size_t aPoint )
+    {
+        return std::sin( aPoint * 0.001 ) * 5.0 - 1.0;
+    }
+
+    static double imagValue( size_t aPoint )
+    {
+        return std::cos( aPoint * 0.003 ) * 0.5;
+    }
+
+    bool appendPoint( size_t aPoint )
+    {
+        const double values[] = { aPoint * 1e-6, realValue( aPoint ),
+                                  realValue( aPoint ) * 0.1, imagValue( aPoint ) };
+
+        return m_results->AppendPoint( values );
+    }
+
+    /**
+     * Checks a point as it was read from the simulator with SPICE_SIMULATOR::GetMagPlot()
+     * and SPICE_SIMULATOR::GetPhasePlot()
+     */
+    void checkPoint( size_t aPoint )
+    {
+        const double re = realValue( aPoint ) * 0.1, im = imagValue( aPoint );
+
+        BOOST_CHECK_EQUAL( m_results->GetMag( 0, aPoint ), aPoint * 1e-6 );
+        BOOST_CHECK_EQUAL( m_results->GetMag( 1, aPoint ), realValue( aPoint ) );
+        BOOST_CHECK_EQUAL( m_results->GetPhase( 1, aPoint ), 0.0 );
+        BOOST_CHECK_EQUAL( m_results->GetMag( 2, aPoint ), hypot( re, im ) );
+        BOOST_CHECK_EQUAL( m_results->GetPhase( 2, aPoint ), atan2( im, re ) );
+    }
+
+    /**
+     * Appends aCount points of a random walk, rounded so several points have the same value
+     * @param aSweepX makes the X values go back and forth, as in a DC sweep of two sources
+     */
+    void appendRandomWalk( size_t aCount, bool aSweepX = false )
+    {
+        std::uniform_real_distribution<double> step( -1.0, 1.0 );
+
+        for( size_t ii = 0; ii < aCount; ++ii )
+        {
+            size_t point = m_results->GetPointCount();
+            double x = aSweepX ? (double) ( point % 2000 ) - 1000.0 + ( point / 2000 ) * 0.5
+                               : ( point + 1 ) * 1e-3;
+
+            m_walk += step( m_rng );
+            m_walkIm += step( m_rng ) * 0.1;
+
+            const double values[] = { x, std::round( m_walk * 4.0 ) / 4.0,
+                                      1.0 + std::fabs( m_walk ), m_walkIm };
+
+            BOOST_REQUIRE( m_results->AppendPoint( values ) );
+        }
+    }
+
+    /**
+     * Checks the points plotted by aTrace are the points kept by decimatePointByPoint(),
+     * for a view of the whole trace, zoomed views, a view out of the trace and a view where
+     * the trace fits in a single column
+     */
+    void checkDecimation( TEST_TRACE& aTrace )
+    {
+        const wxCoord startPx = 80, endPx = 720;
+        const double  first = aTrace.x2s( aTrace.GetMinX() );
+        const double  last = aTrace.x2s( aTrace.GetMaxX() );
+        const double  range = last > first ? last - first : 1.0;
+        const double  fitScale = ( endPx - startPx ) / range;
+
+        const PLOT_VIEW views[] = {
+            { first - startPx / fitScale, fitScale, startPx, endPx },
+            { first, fitScale * 2.5, 0, 800 },
+            { first + range * 0.3, fitScale * 37.0, startPx, endPx },
+            { first + range * 0.9 - startPx / ( fitScale * 1000.0 ), fitScale * 1000.0,
+              startPx, endPx },
+            { last + range, fitScale, startPx, endPx },
+            { first - range * 2.0, fitScale, startPx, endPx },
+            { first - startPx * range, 1.0 / range, startPx, endPx }
+        };
+
+        for( const PLOT_VIEW& view : views )
+        {
+            PLOTTED_POINTS expected = decimatePointByPoint( aTrace, view );
+
+            BOOST_CHECK( aTrace.Decimate( view ) == expected );
+        }
+    }
+
+    /**
+     * Checks the decimation while the points are streamed to aTrace, in batches of various
+     * sizes so the last blocks of points are partially filled
+     */
+    void checkStreamedDecimation( TEST_TRACE& aTrace, bool aSweepX = false )
+    {
+        const size_t batches[] = { 1, 1, 14, 17, 256, 1000, 3, 4096, 20000, 37 };
+
+        for( size_t count : batches )
+        {
+            appendRandomWalk( count, aSweepX );
+
+            BOOST_CHECK( aTrace.UpdateStreamedData() );
+            BOOST_CHECK_EQUAL( aTrace.GetPointCount(), m_results->GetPointCount() );
+
+            checkDecimation( aTrace );
+        }
+    }
+
+    std::shared_ptr<SIM_RESULTS> m_results;
+    std::mt19937                 m_rng;
+    double                       m_walk = 0.0;
+    double                       m_walkIm = 0.0;
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( SimResults, SimResultsFixture )
+
+
+/**
+ * Check the vectors are found by their Spice names
+ */
+BOOST_AUTO_TEST_CASE( VectorNames )
+{
+    BOOST_CHECK_EQUAL( m_results->GetVectorCount(), 3 );
+    BOOST_CHECK_EQUAL( m_results->GetPointWidth(), 4 );
+
+    BOOST_CHECK_EQUAL( m_results->FindVector( "time" ), 0 );
+    BOOST_CHECK_EQUAL( m_results->FindVector( "V(out)" ), 1 );
+    BOOST_CHECK_EQUAL( m_results->FindVector( "v(OUT)" ), 1 );
+    BOOST_CHECK_EQUAL( m_results->FindVector( "out" ), 1 );
+    BOOST_CHECK_EQUAL( m_results->FindVector( "i(r1)" ), 2 );
+    BOOST_CHECK_EQUAL( m_results->FindVector( "V(in)" ), -1 );
+    BOOST_CHECK_EQUAL( m_results->FindVector( "R1" ), -1 );
+
+    BOOST_CHECK( !m_results->IsComplex( 1 ) );
+    BOOST_CHECK( m_results->IsComplex( 2 ) );
+}
+
+
+/**
+ * Check the streamed values are the values given by the simulator, across several chunks
+ * of points
+ */
+BOOST_AUTO_TEST_CASE( StreamedValues )
+{
+    const size_t count = 150000;
+
+    BOOST_CHECK_EQUAL( m_results->GetPointCount(), 0u );
+
+    for( size_t ii = 0; ii < count; ++ii )
+        BOOST_REQUIRE( appendPoint( ii ) );
+
+    BOOST_CHECK_EQUAL( m_results->GetPointCount(), count );
+
+    for( size_t ii = 0; ii < count; ii += 97 )
+        checkPoint( ii );
+
+    checkPoint( 65535 );
+    checkPoint( 65536 );
+    checkPoint( count - 1 );
+}
+
+
+/**
+ * Check the points read while the simulator thread appends other points are the points
+ * appended
+ */
+BOOST_AUTO_TEST_CASE( ConcurrentReading )
+{
+    const size_t count = 200000;
+    bool         appended = true;
+
+    std::thread simulator( [&]()
+            {
+                for( size_t ii = 0; ii < count; ++ii )
+                    appended = appended && appendPoint( ii );
+            } );
+
+    size_t read = 0;
+
+    while( read < count )
+    {
+        size_t available = m_results->GetPointCount();
+
+        BOOST_REQUIRE( available >= read );
+
+        // The last published point and a few earlier ones are complete
+        for( size_t ii = read; ii < available; ii += 1 + ( available - read ) / 16 )
+            checkPoint( ii );
+
+        if( available > 0 )
+            checkPoint( available - 1 );
+
+        read = available;
+        std::this_thread::yield();
+    }
+
+    simulator.join();
+
+    BOOST_CHECK( appended );
+    BOOST_CHECK_EQUAL( m_results->GetPointCount(), count );
+}
+
+
+/**
+ * Check a transient trace plots the points kept by the point by point decimation while
+ * the points are streamed
+ */
+BOOST_AUTO_TEST_CASE( TransientDecimation )
+{
+    mpScaleX   scaleX;
+    mpScaleY   scaleY;
+    TEST_TRACE trace;
+
+    trace.SetData( m_results, 0, 1, (SIM_PLOT_TYPE) ( SPT_VOLTAGE | SPT_TIME ) );
+    trace.SetScale( &scaleX, &scaleY );
+
+    BOOST_CHECK( trace.Decimate( { 0.0, 1.0, 0, 800 } ).empty() );
+
+    checkStreamedDecimation( trace );
+
+    // At most 4 points are kept for each column, and for a column on each side
+    BOOST_CHECK( trace.Decimate( { 0.0, 20.0, 0, 800 } ).size() <= 4 * 803u );
+}
+
+
+/**
+ * Check a DC sweep trace, whose X values go back and forth, plots the points kept by the
+ * point by point decimation
+ */
+BOOST_AUTO_TEST_CASE( SweepDecimation )
+{
+    mpScaleX   scaleX;
+    mpScaleY   scaleY;
+    TEST_TRACE trace;
+
+    trace.SetData( m_results, 0, 1, (SIM_PLOT_TYPE) ( SPT_VOLTAGE | SPT_SWEEP ) );
+    trace.SetScale( &scaleX, &scaleY );
+
+    checkStreamedDecimation( trace, true );
+}
+
+
+/**
+ * Check the magnitude and phase traces of an AC analysis, on a logarithmic frequency
+ * scale, plot the points kept by the point by point decimation
+ */
+BOOST_AUTO_TEST_CASE( AcDecimation )
+{
+    mpScaleXLog scaleX;
+    mpScaleY    scaleY;
+    TEST_TRACE  magTrace, phaseTrace;
+
+    magTrace.SetData( m_results, 0, 2, SPT_AC_MAG );
+    magTrace.SetScale( &scaleX, &scaleY );
+    phaseTrace.SetData( m_results, 0, 2, SPT_AC_PHASE );
+    phaseTrace.SetScale( &scaleX, &scaleY );
+
+    scaleX.SetDataRange( 1e-3, 100.0 );
+
+    const size_t batches[] = { 1, 30, 500, 4096, 15000 };
+
+    for( size_t count : batches )
+    {
+        appendRandomWalk( count );
+
+        magTrace.UpdateStreamedData();
+        phaseTrace.UpdateStreamedData();
+
+        checkDecimation( magTrace );
+        checkDecimation( phaseTrace );
+    }
+
+    // The trace values are converted to dB and degrees
+    size_t last = m_results->GetPointCount() - 1;
+
+    BOOST_CHECK_CLOSE( magTrace.GetY( last ), 20 * log10( m_results->GetMag( 2, last ) ),
+                       1e-9 );
+    BOOST_CHECK_CLOSE( phaseTrace.GetY( last ), m_results->GetPhase( 2, last ) * 180.0 / M_PI,
+                       1e-9 );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
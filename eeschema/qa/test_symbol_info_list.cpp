@@ -0,0 +1,213 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <wx/filename.h>
+#include <wx/textfile.h>
+
+#include <fctsys.h>
+#include <class_libentry.h>
+#include <symbol_lib_table.h>
+#include <symbol_info_list.h>
+
+#include <eeschema_test_utils.h>
+
+#include <map>
+#include <vector>
+
+
+/// The symbols of each library, by nickname, each symbol given by all its chooser data
+typedef std::map<wxString, std::vector<wxString>> LIBRARY_SYMBOLS;
+
+
+static wxString describeSymbol( SYMBOL_INFO& aSymbol )
+{
+    return aSymbol.GetLibNickname() + wxT( ":" ) + aSymbol.GetName() + wxT( "|" )
+           + aSymbol.GetDescription() + wxT( "|" ) + aSymbol.GetKeywords() + wxT( "|" )
+           + aSymbol.GetFootprint() + wxT( "|" )
+           + wxString::Format( wxT( "%d %d %d|" ), (int) aSymbol.IsRoot(),
+                               (int) aSymbol.IsPower(), aSymbol.GetUnitCount() )
+           + aSymbol.GetSearchText();
+}
+
+
+/**
+ * A symbol library table of several libraries, and a library whose file is missing.
+ * The libraries loaded one after the other are loaded from a second table, so the
+ * libraries of the first one are still to be parsed by the worker threads.
+ */
+struct SymbolInfoListFixture
+{
+    SymbolInfoListFixture()
+    {
+        for( int ii = 0; ii < 8; ii++ )
+            m_nicknames.push_back( wxString::Format( wxT( "lib%d" ), ii ) );
+
+        addRows( m_table );
+        addRows( m_serialTable );
+    }
+
+    void addRows( SYMBOL_LIB_TABLE& aTable )
+    {
+        wxString libPath = TestDataFile( wxT( "legacy_library.lib" ) );
+
+        for( const wxString& nickname : m_nicknames )
+            aTable.InsertRow( new SYMBOL_LIB_TABLE_ROW( nickname, libPath, wxT( "Legacy" ) ) );
+
+        aTable.InsertRow( new SYMBOL_LIB_TABLE_ROW( wxT( "missing" ),
+                                                    TestDataFile( wxT( "missing.lib" ) ),
+                                                    wxT( "Legacy" ) ) );
+    }
+
+    /**
+     * @return the symbols of the libraries loaded one after the other, as the symbol
+     * chooser used to load them
+     */
+    LIBRARY_SYMBOLS loadInOrder()
+    {
+        LIBRARY_SYMBOLS libraries;
+
+        for( const wxString& nickname : m_nicknames )
+        {
+            std::vector<LIB_ALIAS*> aliases;
+
+            m_serialTable.LoadSymbolLib( aliases, nickname );
+
+            for( LIB_ALIAS* alias : aliases )
+            {
+                SYMBOL_INFO symbol( nickname, alias );
+                libraries[nickname].push_back( describeSymbol( symbol ) );
+            }
+        }
+
+        return libraries;
+    }
+
+    LIBRARY_SYMBOLS listedSymbols( const SYMBOL_INFO_LIST& aList )
+    {
+        LIBRARY_SYMBOLS libraries;
+
+        for( const wxString& nickname : m_nicknames )
+        {
+            const SYMBOL_INFO_LIST::SYMBOLS* symbols = aList.GetSymbols( nickname );
+
+            BOOST_REQUIRE( symbols );
+
+            for( auto& symbol : *symbols )
+                libraries[nickname].push_back( describeSymbol( *symbol ) );
+        }
+
+        return libraries;
+    }
+
+    SYMBOL_LIB_TABLE      m_table;
+    SYMBOL_LIB_TABLE      m_serialTable;
+    std::vector<wxString> m_nicknames;      ///< the libraries which can be read
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( SymbolInfoList, SymbolInfoListFixture )
+
+
+/**
+ * Check the libraries read by the worker threads give the symbols of the libraries
+ * loaded one after the other
+ */
+BOOST_AUTO_TEST_CASE( ThreadedRead )
+{
+    LIBRARY_SYMBOLS  expected = loadInOrder();
+    SYMBOL_INFO_LIST list;
+    LIBRARY_SYMBOLS  handedOver;
+
+    BOOST_REQUIRE( expected.size() == m_nicknames.size() );
+
+    bool ok = list.ReadSymbolLibs( &m_table, m_nicknames, NULL,
+            [&]( const wxString& aNickname, const SYMBOL_INFO_LIST::SYMBOLS& aSymbols )
+            {
+                for( auto& symbol : aSymbols )
+                    handedOver[aNickname].push_back( describeSymbol( *symbol ) );
+            } );
+
+    BOOST_CHECK( ok );
+    BOOST_CHECK( handedOver == expected );
+    BOOST_CHECK( listedSymbols( list ) == expected );
+    BOOST_CHECK( list.GetChangedLibs( &m_table, m_nicknames ).empty() );
+}
+
+
+/**
+ * Check a library which cannot be read gives an error and does not stop the reading of
+ * the others
+ */
+BOOST_AUTO_TEST_CASE( MissingLibrary )
+{
+    LIBRARY_SYMBOLS       expected = loadInOrder();
+    SYMBOL_INFO_LIST      list;
+    std::vector<wxString> nicknames = m_nicknames;
+
+    nicknames.insert( nicknames.begin() + 3, wxT( "missing" ) );
+
+    bool ok = list.ReadSymbolLibs( &m_table, nicknames, NULL,
+            []( const wxString&, const SYMBOL_INFO_LIST::SYMBOLS& ) {} );
+
+    BOOST_CHECK( !ok );
+    BOOST_CHECK_EQUAL( list.GetErrorCount(), 1u );
+    BOOST_CHECK( list.GetSymbols( wxT( "missing" ) ) == NULL );
+    BOOST_CHECK( listedSymbols( list ) == expected );
+
+    std::vector<wxString> changed = list.GetChangedLibs( &m_table, nicknames );
+    BOOST_CHECK( changed == std::vector<wxString>( { wxT( "missing" ) } ) );
+}
+
+
+/**
+ * Check the symbols read back from the symbol info cache file are the symbols read from
+ * the libraries
+ */
+BOOST_AUTO_TEST_CASE( CacheFile )
+{
+    SYMBOL_INFO_LIST list;
+
+    list.ReadSymbolLibs( &m_table, m_nicknames, NULL,
+                         []( const wxString&, const SYMBOL_INFO_LIST::SYMBOLS& ) {} );
+
+    wxString   cacheFileName = wxFileName::CreateTempFileName( wxT( "sym-info-cache" ) );
+    wxTextFile cacheFile( cacheFileName );
+
+    list.WriteCacheToFile( &cacheFile );
+
+    SYMBOL_INFO_LIST cachedList;
+    cachedList.ReadCacheFromFile( &cacheFile );
+
+    wxRemoveFile( cacheFileName );
+
+    BOOST_CHECK( listedSymbols( cachedList ) == listedSymbols( list ) );
+    BOOST_CHECK( cachedList.GetChangedLibs( &m_table, m_nicknames ).empty() );
+}
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -601,6 +601,9 @@ void SCH_BASE_FRAME::RefreshItem( SCH_ITEM* aItem, bool isAddOrDelete )
 {
     EDA_ITEM* parent = aItem->GetParent();
 
+    if( !isAddOrDelete )
+        GetScreen()->UpdateItem( aItem );
+
     if( aItem->Type() == SCH_SHEET_PIN_T )
     {
         // Sheet pins aren't in the view.  Refresh their parent.
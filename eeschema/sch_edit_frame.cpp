@@ -385,6 +385,7 @@ SCH_EDIT_FRAME::SCH_EDIT_FRAME( KIWAY* aKiway, wxWindow* aParent ):
     m_findReplaceData = new wxFindReplaceData( wxFR_DOWN );
     m_findReplaceStatus = new wxString( wxEmptyString );
     m_undoItem = NULL;
+    m_netlistConnections = new NETLIST_CONNECTIONS_CACHE;
     m_hasAutoSave = true;
 
     m_toolManager = new TOOL_MANAGER;
@@ -457,6 +458,7 @@ SCH_EDIT_FRAME::~SCH_EDIT_FRAME()
 
     delete m_CurrentSheet;          // a SCH_SHEET_PATH, on the heap.
     delete m_undoItem;
+    delete m_netlistConnections;
     delete m_findReplaceData;
     delete m_findReplaceStatus;
 
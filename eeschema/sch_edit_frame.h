@@ -66,6 +66,7 @@ class wxFindDialogEvent;
 class wxFindReplaceData;
 class SCHLIB_FILTER;
 class RESCUER;
+class NETLIST_CONNECTIONS_CACHE;
 
 
 /// enum used in RotationMiroir()
@@ -137,6 +138,8 @@ private:
     SCH_COLLECTOR           m_collectedItems;     ///< List of collected items.
     SCH_FIND_COLLECTOR      m_foundItems;         ///< List of find/replace items.
     SCH_ITEM*               m_undoItem;           ///< Copy of the current item being edited.
+    NETLIST_CONNECTIONS_CACHE* m_netlistConnections; ///< Connections found in each sheet by
+                                                     ///< the last BuildNetListBase().
     wxString                m_simulatorCommand;   ///< Command line used to call the circuit
                                                   ///< simulator (gnucap, spice, ...)
     wxString                m_netListerCommand;   ///< Command line to call a custom net list
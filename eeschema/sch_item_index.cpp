@@ -0,0 +1,298 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_item_index.cpp
+ */
+
+#include <algorithm>
+
+#include <sch_item_index.h>
+#include <sch_item_struct.h>
+#include <sch_sheet.h>
+
+
+/// Spacing of the order keys, so items can be inserted in the middle of the list
+static const uint64_t ORDER_STEP = 1 << 20;
+
+
+static bool sameArea( const EDA_RECT& aFirst, const EDA_RECT& aSecond )
+{
+    return aFirst.GetOrigin() == aSecond.GetOrigin() && aFirst.GetEnd() == aSecond.GetEnd();
+}
+
+
+SCH_ITEM_INDEX::SCH_ITEM_INDEX()
+{
+    m_tree = new RTree<SCH_ITEM*, int, 2, double>();
+    m_lastOrder = 0;
+    m_syncMark = 0;
+}
+
+
+SCH_ITEM_INDEX::~SCH_ITEM_INDEX()
+{
+    delete m_tree;
+}
+
+
+EDA_RECT SCH_ITEM_INDEX::itemArea( SCH_ITEM* aItem )
+{
+    EDA_RECT area = aItem->GetBoundingBox();
+
+    // Labels are connected at their anchor, which is not always inside their text
+    std::vector< wxPoint > connections;
+    aItem->GetConnectionPoints( connections );
+
+    for( const wxPoint& point : connections )
+        area.Merge( point );
+
+    // The sheet pins are drawn outside the sheet
+    if( aItem->Type() == SCH_SHEET_T )
+    {
+        for( SCH_SHEET_PIN& pin : ( (SCH_SHEET*) aItem )->GetPins() )
+            area.Merge( pin.GetBoundingBox() );
+    }
+
+    area.Normalize();
+    return area;
+}
+
+
+void SCH_ITEM_INDEX::insertArea( SCH_ITEM* aItem, const EDA_RECT& aArea )
+{
+    const int mmin[2] = { aArea.GetX(), aArea.GetY() };
+    const int mmax[2] = { aArea.GetRight(), aArea.GetBottom() };
+
+    m_tree->Insert( mmin, mmax, aItem );
+}
+
+
+void SCH_ITEM_INDEX::removeArea( SCH_ITEM* aItem, const EDA_RECT& aArea )
+{
+    const int mmin[2] = { aArea.GetX(), aArea.GetY() };
+    const int mmax[2] = { aArea.GetRight(), aArea.GetBottom() };
+
+    m_tree->Remove( mmin, mmax, aItem );
+}
+
+
+void SCH_ITEM_INDEX::Insert( SCH_ITEM* aItem )
+{
+    Insert( aItem, NULL );
+}
+
+
+void SCH_ITEM_INDEX::Insert( SCH_ITEM* aItem, SCH_ITEM* aBefore )
+{
+    if( Contains( aItem ) )
+    {
+        Update( aItem );
+        return;
+    }
+
+    ENTRY entry;
+    entry.m_area = itemArea( aItem );
+    entry.m_syncMark = m_syncMark;
+
+    auto next = aBefore ? m_entries.find( aBefore ) : m_entries.end();
+    bool renumberList = false;
+
+    if( next == m_entries.end() )
+    {
+        m_lastOrder += ORDER_STEP;
+        entry.m_order = m_lastOrder;
+    }
+    else
+    {
+        auto back = aItem->Back() ? m_entries.find( aItem->Back() ) : m_entries.end();
+        uint64_t low = ( back == m_entries.end() ) ? 0 : back->second.m_order;
+        uint64_t high = next->second.m_order;
+
+        entry.m_order = low + ( high - low ) / 2;
+
+        // No free key between the neighbours, or a neighbour missing from the index
+        renumberList = ( high - low < 2 ) || ( aItem->Back() && back == m_entries.end() );
+    }
+
+    m_entries[aItem] = entry;
+    insertArea( aItem, entry.m_area );
+
+    if( renumberList )
+        renumber( aItem );
+}
+
+
+void SCH_ITEM_INDEX::Remove( SCH_ITEM* aItem )
+{
+    auto it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return;
+
+    removeArea( aItem, it->second.m_area );
+    m_entries.erase( it );
+}
+
+
+void SCH_ITEM_INDEX::Update( SCH_ITEM* aItem )
+{
+    auto it = m_entries.find( aItem );
+
+    if( it == m_entries.end() )
+        return;
+
+    EDA_RECT area = itemArea( aItem );
+
+    if( sameArea( area, it->second.m_area ) )
+        return;
+
+    removeArea( aItem, it->second.m_area );
+    it->second.m_area = area;
+    insertArea( aItem, area );
+}
+
+
+void SCH_ITEM_INDEX::Sync( SCH_ITEM* aFirstItem )
+{
+    ++m_syncMark;
+    uint64_t order = 0;
+
+    for( SCH_ITEM* item = aFirstItem; item; item = item->Next() )
+    {
+        order += ORDER_STEP;
+
+        auto it = m_entries.find( item );
+
+        if( it == m_entries.end() )
+        {
+            ENTRY entry;
+            entry.m_area = itemArea( item );
+            entry.m_order = order;
+            entry.m_syncMark = m_syncMark;
+
+            m_entries[item] = entry;
+            insertArea( item, entry.m_area );
+            continue;
+        }
+
+        EDA_RECT area = itemArea( item );
+
+        if( !sameArea( area, it->second.m_area ) )
+        {
+            removeArea( item, it->second.m_area );
+            it->second.m_area = area;
+            insertArea( item, area );
+        }
+
+        it->second.m_order = order;
+        it->second.m_syncMark = m_syncMark;
+    }
+
+    m_lastOrder = order;
+
+    // The items left with an older mark are no longer in the list.  They are not read,
+    // they may have been deleted.
+    for( auto it = m_entries.begin(); it != m_entries.end(); )
+    {
+        if( it->second.m_syncMark != m_syncMark )
+        {
+            removeArea( it->first, it->second.m_area );
+            it = m_entries.erase( it );
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+
+void SCH_ITEM_INDEX::Clear()
+{
+    m_tree->RemoveAll();
+    m_entries.clear();
+    m_lastOrder = 0;
+}
+
+
+void SCH_ITEM_INDEX::renumber( SCH_ITEM* aItem )
+{
+    SCH_ITEM* first = aItem;
+
+    while( first->Back() )
+        first = first->Back();
+
+    uint64_t order = 0;
+
+    for( SCH_ITEM* item = first; item; item = item->Next() )
+    {
+        auto it = m_entries.find( item );
+
+        if( it != m_entries.end() )
+        {
+            order += ORDER_STEP;
+            it->second.m_order = order;
+        }
+    }
+
+    m_lastOrder = order;
+}
+
+
+void SCH_ITEM_INDEX::Query( const EDA_RECT& aArea, std::vector<SCH_ITEM*>& aItems ) const
+{
+    EDA_RECT area = aArea;
+    area.Normalize();
+
+    const int mmin[2] = { area.GetX(), area.GetY() };
+    const int mmax[2] = { area.GetRight(), area.GetBottom() };
+
+    std::vector< std::pair<uint64_t, SCH_ITEM*> > found;
+
+    m_tree->Search( mmin, mmax, [this, &found]( SCH_ITEM* const& aItem ) -> bool
+    {
+        found.emplace_back( m_entries.at( aItem ).m_order, aItem );
+        return true;
+    } );
+
+    // The queries return the first item found in the draw list, which is the item
+    // drawn below the others
+    std::sort( found.begin(), found.end() );
+
+    aItems.clear();
+
+    for( const auto& candidate : found )
+        aItems.push_back( candidate.second );
+}
+
+
+void SCH_ITEM_INDEX::Query( const wxPoint& aPosition, int aAccuracy,
+                            std::vector<SCH_ITEM*>& aItems ) const
+{
+    // One more unit, for the hit tests rounding their distances
+    EDA_RECT area( aPosition, wxSize( 0, 0 ) );
+    area.Inflate( std::max( aAccuracy, 0 ) + 1 );
+
+    Query( area, aItems );
+}
@@ -0,0 +1,144 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file sch_item_index.h
+ */
+
+#ifndef SCH_ITEM_INDEX_H
+#define SCH_ITEM_INDEX_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <eda_rect.h>
+#include <geometry/rtree.h>
+
+class SCH_ITEM;
+
+
+/**
+ * Class SCH_ITEM_INDEX
+ * is an R-tree of the items of a schematic draw list, to find the items near a position
+ * without testing all the items of the screen.
+ *
+ * The area of an item is its bounding box, merged with its connection points and, for
+ * sheets, with the bounding boxes of the sheet pins.  Each item also has an order key,
+ * increasing along the draw list, so the candidates of a query are given back in the draw
+ * list order.
+ *
+ * The index is kept by the screen owning the draw list: the items are inserted and removed
+ * with the list, and Update() must be called when an item is moved or resized.  Sync()
+ * checks the whole list, for the code which changes items without telling the screen.
+ */
+class SCH_ITEM_INDEX
+{
+public:
+    SCH_ITEM_INDEX();
+
+    ~SCH_ITEM_INDEX();
+
+    int GetCount() const { return (int) m_entries.size(); }
+
+    bool Contains( SCH_ITEM* aItem ) const { return m_entries.count( aItem ) != 0; }
+
+    /**
+     * @return the indexed area of \a aItem, which must be in the index
+     */
+    const EDA_RECT& GetArea( SCH_ITEM* aItem ) const { return m_entries.at( aItem ).m_area; }
+
+    /**
+     * Function Insert
+     * adds \a aItem, which was appended to the end of the draw list.
+     */
+    void Insert( SCH_ITEM* aItem );
+
+    /**
+     * Function Insert
+     * adds \a aItem, which was linked in the draw list before \a aBefore.  Its order key
+     * is taken between the keys of its neighbours.
+     */
+    void Insert( SCH_ITEM* aItem, SCH_ITEM* aBefore );
+
+    /**
+     * Function Remove
+     * removes \a aItem.  The item is not read, it can be removed after being unlinked.
+     */
+    void Remove( SCH_ITEM* aItem );
+
+    /**
+     * Function Update
+     * re-reads the area of \a aItem after it was moved or changed size.  Items which are
+     * not in the index are ignored.
+     */
+    void Update( SCH_ITEM* aItem );
+
+    /**
+     * Function Sync
+     * makes the index match the draw list starting at \a aFirstItem: the items missing
+     * from the index are inserted, the items no longer in the list are removed, the areas
+     * which changed are updated and the order keys follow the list.
+     */
+    void Sync( SCH_ITEM* aFirstItem );
+
+    void Clear();
+
+    /**
+     * Function Query
+     * fills aItems with the items whose area intersects aArea, sorted in the draw list
+     * order
+     */
+    void Query( const EDA_RECT& aArea, std::vector<SCH_ITEM*>& aItems ) const;
+
+    /**
+     * Function Query
+     * fills aItems with the items which can be hit at aPosition with aAccuracy, sorted
+     * in the draw list order
+     */
+    void Query( const wxPoint& aPosition, int aAccuracy, std::vector<SCH_ITEM*>& aItems ) const;
+
+private:
+    struct ENTRY
+    {
+        EDA_RECT m_area;
+        uint64_t m_order;           ///< increasing along the draw list
+        unsigned m_syncMark;        ///< last Sync() which found the item in the list
+    };
+
+    static EDA_RECT itemArea( SCH_ITEM* aItem );
+
+    void insertArea( SCH_ITEM* aItem, const EDA_RECT& aArea );
+    void removeArea( SCH_ITEM* aItem, const EDA_RECT& aArea );
+
+    /// Give new order keys to the draw list holding aItem, when no key is free between
+    /// two neighbours
+    void renumber( SCH_ITEM* aItem );
+
+    RTree<SCH_ITEM*, int, 2, double>*       m_tree;
+    std::unordered_map<SCH_ITEM*, ENTRY>    m_entries;
+    uint64_t                                m_lastOrder;
+    unsigned                                m_syncMark;
+};
+
+#endif  // SCH_ITEM_INDEX_H
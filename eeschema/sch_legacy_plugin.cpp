@@ -22,6 +22,7 @@
 
 #include <ctype.h>
 #include <algorithm>
+#include <atomic>
 
 #include <wx/mstream.h>
 #include <wx/filename.h>
@@ -96,6 +97,51 @@ static bool is_eol( char c )
 }
 
 
+/**
+ * A FILE_LINE_READER for library files opened in binary mode, so the file offsets
+ * of the lines are the same on all platforms.  The "\r\n" line endings are returned
+ * as "\n", like a file opened in text mode on Windows.
+ */
+class BINARY_FILE_LINE_READER : public FILE_LINE_READER
+{
+public:
+    BINARY_FILE_LINE_READER( FILE* aFile, const wxString& aFileName,
+                             unsigned aStartingLineNumber = 0 ) :
+        FILE_LINE_READER( aFile, aFileName, true, aStartingLineNumber )
+    {
+    }
+
+    char* ReadLine() override
+    {
+        char* ret = FILE_LINE_READER::ReadLine();
+
+        if( ret && m_length >= 2 && m_line[m_length - 2] == '\r'
+                && m_line[m_length - 1] == '\n' )
+        {
+            m_line[m_length - 2] = '\n';
+            m_line[--m_length] = 0;
+        }
+
+        return ret;
+    }
+
+    /**
+     * Reads the line starting at \a aOffset in the file.  The file is not moved when
+     * the line is the next one.
+     * @param aLineNumber is the line number of the line, for the error messages
+     * @return false if the line cannot be read
+     */
+    bool SeekLine( long aOffset, unsigned aLineNumber )
+    {
+        if( ftell( m_fp ) != aOffset && fseek( m_fp, aOffset, SEEK_SET ) != 0 )
+            return false;
+
+        m_lineNum = aLineNumber - 1;
+        return ReadLine() != NULL;
+    }
+};
+
+
 /**
  * Compare \a aString to the string starting at \a aLine and advances the character point to
  * the end of \a String and returns the new pointer position in \a aOutput if it is not NULL.
@@ -464,7 +510,30 @@ static void parseQuotedString( wxString& aString, FILE_LINE_READER& aReader,
  */
 class SCH_LEGACY_PLUGIN_CACHE
 {
-    static int      m_modHash;      // Keep track of the modification status of the library.
+    /**
+     * The position in the library file of a symbol which is not parsed yet.
+     */
+    struct PART_INDEX
+    {
+        long                  m_offset;         ///< File offset of the DEF line.
+        int                   m_lineNumber;     ///< Line number of the DEF line.
+        bool                  m_isPower;        ///< Power flag of the DEF line.
+        bool                  m_isParsed;
+        std::vector<wxString> m_aliasNames;     ///< Root alias first, duplicates renamed.
+    };
+
+    /**
+     * An alias of a symbol which is not parsed yet, with its documentation.
+     */
+    struct ALIAS_INDEX
+    {
+        int      m_part;                        ///< Index of the symbol in m_partIndex.
+        wxString m_description;
+        wxString m_keyWords;
+        wxString m_docFileName;
+    };
+
+    static std::atomic<int> m_modHash;  // Keep track of the modification status of the library.
 
     wxString        m_fileName;     // Absolute path and file name.
     wxFileName      m_libFileName;  // Absolute path and file name is required here.
@@ -476,7 +545,20 @@ class SCH_LEGACY_PLUGIN_CACHE
     int             m_versionMinor;
     int             m_libType;      // Is this cache a component or symbol library.
 
+    // The symbols are parsed on first access: Load() only finds the DEF lines and the
+    // aliases of the symbols, and the aliases which are not parsed yet are in m_aliasIndex.
+    wxString                        m_indexedFileName;  // The file m_partIndex points to.
+    std::vector<PART_INDEX>         m_partIndex;        // The symbols, in the file order.
+    std::map<wxString, ALIAS_INDEX> m_aliasIndex;       // Map of names of the aliases not
+                                                        // parsed yet.
+
     LIB_PART*       loadPart( FILE_LINE_READER& aReader );
+    void            indexPart( FILE_LINE_READER& aReader, long aOffset );
+    FILE*           openIndexedFile() const;
+    void            parseIndexedPart( int aPart, BINARY_FILE_LINE_READER& aReader );
+    void            loadIndexedPart( int aPart );
+    void            loadAllParts( bool aPowerSymbolsOnly = false );
+    bool            hasAlias( const wxString& aAliasName ) const;
     void            loadHeader( FILE_LINE_READER& aReader );
     void            loadAliases( std::unique_ptr< LIB_PART >& aPart, FILE_LINE_READER& aReader );
     void            loadField( std::unique_ptr< LIB_PART >& aPart, FILE_LINE_READER& aReader );
@@ -533,6 +615,30 @@ public:
 
     void Load();
 
+    /**
+     * @return the number of aliases in the library, parsed or not.
+     */
+    size_t GetAliasCount() const { return m_aliases.size() + m_aliasIndex.size(); }
+
+    /**
+     * Find the alias \a aAliasName, parsing its symbol if it was not parsed yet.
+     *
+     * @return the alias or NULL if the library does not contain \a aAliasName.
+     */
+    LIB_ALIAS* FindAlias( const wxString& aAliasName );
+
+    /**
+     * Add the names of the aliases of the library to \a aAliasNameList, sorted by name,
+     * without parsing the symbols.
+     */
+    void GetAliasNames( wxArrayString& aAliasNameList, bool aPowerSymbolsOnly );
+
+    /**
+     * Add the aliases of the library to \a aAliasList, sorted by name, parsing the symbols
+     * not parsed yet.
+     */
+    void GetAliases( std::vector<LIB_ALIAS*>& aAliasList, bool aPowerSymbolsOnly );
+
     void AddSymbol( const LIB_PART* aPart );
 
     void DeleteAlias( const wxString& aAliasName );
@@ -2176,7 +2282,7 @@ void SCH_LEGACY_PLUGIN::saveText( SCH_TEXT* aText )
 }
 
 
-int SCH_LEGACY_PLUGIN_CACHE::m_modHash = 1;     // starts at 1 and goes up
+std::atomic<int> SCH_LEGACY_PLUGIN_CACHE::m_modHash( 1 );     // starts at 1 and goes up
 
 
 SCH_LEGACY_PLUGIN_CACHE::SCH_LEGACY_PLUGIN_CACHE( const wxString& aFullPathAndFileName ) :
@@ -2310,6 +2416,9 @@ LIB_ALIAS* SCH_LEGACY_PLUGIN_CACHE::removeAlias( LIB_ALIAS* aAlias )
 
 void SCH_LEGACY_PLUGIN_CACHE::AddSymbol( const LIB_PART* aPart )
 {
+    // The library is modified: all of its symbols are needed to save it.
+    loadAllParts();
+
     // aPart is cloned in PART_LIB::AddPart().  The cache takes ownership of aPart.
     wxArrayString aliasNames = aPart->GetAliasNames();
 
@@ -2354,7 +2463,16 @@ void SCH_LEGACY_PLUGIN_CACHE::Load()
     wxLogTrace( traceSchLegacyPlugin, "Loading legacy symbol file \"%s\"",
                 m_libFileName.GetFullPath() );
 
-    FILE_LINE_READER reader( m_libFileName.GetFullPath() );
+    // The file is opened here to know the offsets of the symbols.  It is opened in binary
+    // mode: ftell() offsets of a file opened in text mode cannot be used with fseek().
+    m_indexedFileName = m_libFileName.GetFullPath();
+    FILE* fp = wxFopen( m_indexedFileName, wxT( "rb" ) );
+
+    if( !fp )
+        THROW_IO_ERROR( wxString::Format( _( "Unable to open filename \"%s\" for reading" ),
+                                          m_indexedFileName ) );
+
+    BINARY_FILE_LINE_READER reader( fp, m_indexedFileName );
 
     if( !reader.ReadLine() )
         THROW_IO_ERROR( _( "unexpected end of file" ) );
@@ -2395,7 +2513,9 @@ void SCH_LEGACY_PLUGIN_CACHE::Load()
         m_libType = LIBRARY_TYPE_EESCHEMA;
     }
 
-    while( reader.ReadLine() )
+    // FILE_LINE_READER reads the file one character at a time, so the file position is
+    // the offset of the next line.
+    for( long offset = ftell( fp ); reader.ReadLine(); offset = ftell( fp ) )
     {
         line = reader.Line();
 
@@ -2408,8 +2528,9 @@ void SCH_LEGACY_PLUGIN_CACHE::Load()
 
         if( strCompare( "DEF", line ) )
         {
-            // Read one DEF/ENDDEF part entry from library:
-            loadPart( reader );
+            // Find the aliases and the end of one DEF/ENDDEF part entry.  The part is
+            // parsed when it is used.
+            indexPart( reader, offset );
         }
     }
 
@@ -2431,7 +2552,7 @@ void SCH_LEGACY_PLUGIN_CACHE::loadDocs()
     wxString    text;
     wxString    aliasName;
     wxFileName  fn = m_libFileName;
-    LIB_ALIAS*  alias = NULL;;
+    ALIAS_INDEX* alias = NULL;
 
     fn.SetExt( DOC_EXT );
 
@@ -2466,14 +2587,17 @@ void SCH_LEGACY_PLUGIN_CACHE::loadDocs()
 
         parseUnquotedString( aliasName, reader, line, &line );    // Alias name.
         aliasName = LIB_ID::FixIllegalChars( aliasName, LIB_ID::ID_SCH );
-        LIB_ALIAS_MAP::iterator it = m_aliases.find( aliasName );
 
-        if( it == m_aliases.end() )
+        // The documentation is read by Load(), before any part is parsed: it is given
+        // to the aliases when their part is parsed.
+        auto it = m_aliasIndex.find( aliasName );
+
+        if( it == m_aliasIndex.end() )
             wxLogWarning( "Alias '%s' not found in library:\n\n"
                           "'%s'\n\nat line %d offset %d", aliasName, fn.GetFullPath(),
                           reader.LineNumber(), (int) (line - reader.Line() ) );
         else
-            alias = it->second;
+            alias = &it->second;
 
         // Read the curent alias associated doc.
         // if the alias does not exist, just skip the description
@@ -2496,17 +2620,17 @@ void SCH_LEGACY_PLUGIN_CACHE::loadDocs()
             {
             case 'D':
                 if( alias )
-                    alias->SetDescription( text );
+                    alias->m_description = text;
                 break;
 
             case 'K':
                 if( alias )
-                    alias->SetKeyWords( text );
+                    alias->m_keyWords = text;
                 break;
 
             case 'F':
                 if( alias )
-                    alias->SetDocFileName( text );
+                    alias->m_docFileName = text;
                 break;
 
             case 0:
@@ -2673,61 +2797,300 @@ LIB_PART* SCH_LEGACY_PLUGIN_CACHE::loadPart( FILE_LINE_READER& aReader )
             loadFootprintFilters( part, aReader );
         else if( strCompare( "ENDDEF", line, &line ) )   // End of part description
         {
-            // Add aliases
-            for( size_t ii = 0; ii < part->GetAliasCount(); ++ii )
+            // The aliases are added to the library by parseIndexedPart()
+            return part.release();
+        }
+
+        line = aReader.ReadLine();
+    }
+
+    SCH_PARSE_ERROR( "missing ENDDEF", aReader, line );
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::indexPart( FILE_LINE_READER& aReader, long aOffset )
+{
+    const char* line = aReader.Line();
+
+    wxCHECK_RET( strCompare( "DEF", line, &line ), "Invalid DEF section" );
+
+    PART_INDEX index;
+
+    index.m_offset = aOffset;
+    index.m_lineNumber = aReader.LineNumber();
+    index.m_isPower = false;
+    index.m_isParsed = false;
+
+    // Read the part name and the power flag of the DEF line, like loadPart() does.
+    wxString name, prefix;
+
+    parseUnquotedString( name, aReader, line, &line );           // Part name.
+    parseUnquotedString( prefix, aReader, line, &line );         // Prefix name
+    parseInt( aReader, line, &line );                            // NumOfPins.
+    parseInt( aReader, line, &line );                            // Pin name offset.
+    parseChar( aReader, line, &line );                           // Show pin numbers.
+    parseChar( aReader, line, &line );                           // Show pin names.
+    parseInt( aReader, line, &line );                            // Number of units.
+
+    if( LIB_VERSION( m_versionMajor, m_versionMinor ) <= LIB_VERSION( 2, 2 ) )
+        parseInt( aReader, line, &line );
+    else
+        parseChar( aReader, line, &line );                       // Units locked.
+
+    if( *line )
+        index.m_isPower = parseChar( aReader, line, &line ) == 'P';
+
+    if( name.IsEmpty() )
+        index.m_aliasNames.push_back( "~" );
+    else if( name[0] != '~' )
+        index.m_aliasNames.push_back( name );
+    else
+        index.m_aliasNames.push_back( name.Right( name.Length() - 1 ) );
+
+    // Find the aliases and the end of the part.  The drawings and the footprint filters
+    // are skipped.
+    while( ( line = aReader.ReadLine() ) != NULL )
+    {
+        if( strCompare( "DRAW", line, &line ) )
+        {
+            while( ( line = aReader.ReadLine() ) != NULL && !strCompare( "ENDDRAW", line ) )
+                ;
+        }
+        else if( strCompare( "$FPLIST", line, &line ) )
+        {
+            while( ( line = aReader.ReadLine() ) != NULL && !strCompare( "$ENDFPLIST", line ) )
+                ;
+        }
+        else if( strCompare( "ALIAS", line, &line ) )
+        {
+            wxString alias;
+            parseUnquotedString( alias, aReader, line, &line );
+
+            while( !alias.IsEmpty() )
             {
-                LIB_ALIAS* alias = part->GetAlias( ii );
-                const wxString& aliasName = alias->GetName();
-                auto it = m_aliases.find( aliasName );
+                wxString newAlias = alias;
+                checkForDuplicates( newAlias );
+                index.m_aliasNames.push_back( newAlias );
+                alias.clear();
+                parseUnquotedString( alias, aReader, line, &line, true );
+            }
+        }
+        else if( strCompare( "ENDDEF", line, &line ) )
+        {
+            int part = (int) m_partIndex.size();
 
-                if( it != m_aliases.end() )
+            // Add aliases
+            for( wxString& aliasName : index.m_aliasNames )
+            {
+                if( hasAlias( aliasName ) )
                 {
                     // Find a new name for the alias
                     wxString newName;
                     int idx = 0;
-                    LIB_ALIAS_MAP::const_iterator jt;
 
                     do
                     {
                         newName = wxString::Format( "%s_%d", aliasName, idx );
-                        jt = m_aliases.find( newName );
                         ++idx;
                     }
-                    while( jt != m_aliases.end() );
+                    while( hasAlias( newName ) );
 
                     wxLogWarning( "Symbol name conflict in library:\n%s\n"
                                   "'%s' has been renamed to '%s'",
                                   m_fileName, aliasName, newName );
 
-                    if( alias->IsRoot() )
-                        part->SetName( newName );
-                    else
-                        alias->SetName( newName );
-
-                    m_aliases[newName] = alias;
-                }
-                else
-                {
-                    m_aliases[aliasName] = alias;
+                    aliasName = newName;
                 }
+
+                m_aliasIndex[aliasName].m_part = part;
             }
 
-            return part.release();
+            m_partIndex.push_back( index );
+            return;
         }
 
-        line = aReader.ReadLine();
+        if( !line )
+            break;
     }
 
     SCH_PARSE_ERROR( "missing ENDDEF", aReader, line );
 }
 
 
+FILE* SCH_LEGACY_PLUGIN_CACHE::openIndexedFile() const
+{
+    FILE* fp = wxFopen( m_indexedFileName, wxT( "rb" ) );
+
+    if( !fp )
+        THROW_IO_ERROR( wxString::Format( _( "Unable to open filename \"%s\" for reading" ),
+                                          m_indexedFileName ) );
+
+    return fp;
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::parseIndexedPart( int aPart, BINARY_FILE_LINE_READER& aReader )
+{
+    PART_INDEX& index = m_partIndex[aPart];
+
+    if( !aReader.SeekLine( index.m_offset, index.m_lineNumber ) )
+        THROW_IO_ERROR( wxString::Format( _( "Unable to read library file \"%s\"" ),
+                                          m_indexedFileName ) );
+
+    const char* line = aReader.Line();
+
+    // The file is checked for changes before each access to the cache, but it could
+    // be replaced by another one having the same date.
+    if( !strCompare( "DEF", line ) )
+        SCH_PARSE_ERROR( "symbol definition expected, the library was modified", aReader, line );
+
+    std::unique_ptr< LIB_PART > part( loadPart( aReader ) );
+
+    if( part->GetAliasCount() != index.m_aliasNames.size() )
+        SCH_PARSE_ERROR( "symbol aliases changed, the library was modified", aReader, line );
+
+    index.m_isParsed = true;
+
+    // Add the aliases, with the names given by Load(), and their documentation.
+    for( size_t ii = 0; ii < part->GetAliasCount(); ++ii )
+    {
+        LIB_ALIAS* alias = part->GetAlias( ii );
+        const wxString& aliasName = index.m_aliasNames[ii];
+
+        if( alias->GetName() != aliasName )
+        {
+            if( alias->IsRoot() )
+                part->SetName( aliasName );
+            else
+                alias->SetName( aliasName );
+        }
+
+        auto it = m_aliasIndex.find( aliasName );
+
+        if( it != m_aliasIndex.end() )
+        {
+            if( !it->second.m_description.IsEmpty() )
+                alias->SetDescription( it->second.m_description );
+
+            if( !it->second.m_keyWords.IsEmpty() )
+                alias->SetKeyWords( it->second.m_keyWords );
+
+            if( !it->second.m_docFileName.IsEmpty() )
+                alias->SetDocFileName( it->second.m_docFileName );
+
+            m_aliasIndex.erase( it );
+        }
+
+        m_aliases[aliasName] = alias;
+    }
+
+    part.release();
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::loadIndexedPart( int aPart )
+{
+    if( m_partIndex[aPart].m_isParsed )
+        return;
+
+    BINARY_FILE_LINE_READER reader( openIndexedFile(), m_indexedFileName );
+
+    parseIndexedPart( aPart, reader );
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::loadAllParts( bool aPowerSymbolsOnly )
+{
+    // The file is opened once and the symbols are parsed in the file order, so the
+    // reader only moves in the file to skip the symbols already parsed.
+    std::unique_ptr< BINARY_FILE_LINE_READER > reader;
+
+    for( size_t ii = 0; ii < m_partIndex.size(); ++ii )
+    {
+        const PART_INDEX& index = m_partIndex[ii];
+
+        if( index.m_isParsed || ( aPowerSymbolsOnly && !index.m_isPower ) )
+            continue;
+
+        if( !reader )
+            reader.reset( new BINARY_FILE_LINE_READER( openIndexedFile(), m_indexedFileName ) );
+
+        parseIndexedPart( (int) ii, *reader );
+    }
+}
+
+
+bool SCH_LEGACY_PLUGIN_CACHE::hasAlias( const wxString& aAliasName ) const
+{
+    return m_aliases.find( aAliasName ) != m_aliases.end()
+            || m_aliasIndex.find( aAliasName ) != m_aliasIndex.end();
+}
+
+
+LIB_ALIAS* SCH_LEGACY_PLUGIN_CACHE::FindAlias( const wxString& aAliasName )
+{
+    auto indexIt = m_aliasIndex.find( aAliasName );
+
+    if( indexIt != m_aliasIndex.end() )
+        loadIndexedPart( indexIt->second.m_part );
+
+    LIB_ALIAS_MAP::const_iterator it = m_aliases.find( aAliasName );
+
+    if( it == m_aliases.end() )
+        return NULL;
+
+    return it->second;
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::GetAliasNames( wxArrayString& aAliasNameList,
+                                             bool aPowerSymbolsOnly )
+{
+    // Both maps are sorted by name: merge them
+    auto it = m_aliases.begin();
+    auto indexIt = m_aliasIndex.begin();
+
+    while( it != m_aliases.end() || indexIt != m_aliasIndex.end() )
+    {
+        if( indexIt == m_aliasIndex.end()
+                || ( it != m_aliases.end() && it->first < indexIt->first ) )
+        {
+            if( !aPowerSymbolsOnly || it->second->GetPart()->IsPower() )
+                aAliasNameList.Add( it->first );
+
+            ++it;
+        }
+        else
+        {
+            if( !aPowerSymbolsOnly || m_partIndex[indexIt->second.m_part].m_isPower )
+                aAliasNameList.Add( indexIt->first );
+
+            ++indexIt;
+        }
+    }
+}
+
+
+void SCH_LEGACY_PLUGIN_CACHE::GetAliases( std::vector<LIB_ALIAS*>& aAliasList,
+                                          bool aPowerSymbolsOnly )
+{
+    // Only the power symbols are parsed when only the power symbols are listed
+    loadAllParts( aPowerSymbolsOnly );
+
+    for( LIB_ALIAS_MAP::const_iterator it = m_aliases.begin();  it != m_aliases.end();  ++it )
+    {
+        if( !aPowerSymbolsOnly || it->second->GetPart()->IsPower() )
+            aAliasList.push_back( it->second );
+    }
+}
+
+
 bool SCH_LEGACY_PLUGIN_CACHE::checkForDuplicates( wxString& aAliasName )
 {
     wxCHECK_MSG( !aAliasName.IsEmpty(), false, "alias name cannot be empty" );
 
     // The alias name is not a duplicate so don't change it.
-    if( m_aliases.find( aAliasName ) == m_aliases.end() )
+    if( !hasAlias( aAliasName ) )
         return false;
 
     int dupCounter = 1;
@@ -2736,7 +3099,7 @@ bool SCH_LEGACY_PLUGIN_CACHE::checkForDuplicates( wxString& aAliasName )
     // If the alias is already loaded, the library is broken.  It may have been possible in
     // the past that this could happen so we assign a new alias name to prevent any conflicts
     // rather than throw an exception.
-    while( m_aliases.find( newAlias ) != m_aliases.end() )
+    while( hasAlias( newAlias ) )
     {
         newAlias = aAliasName << dupCounter;
         dupCounter++;
@@ -2760,10 +3123,10 @@ void SCH_LEGACY_PLUGIN_CACHE::loadAliases( std::unique_ptr< LIB_PART >& aPart,
     wxString alias;
     parseUnquotedString( alias, aReader, line, &line );
 
+    // The duplicated alias names are renamed by Load(), when the library is indexed.
     while( !alias.IsEmpty() )
     {
         newAlias = alias;
-        checkForDuplicates( newAlias );
         aPart->AddAlias( newAlias );
         alias.clear();
         parseUnquotedString( alias, aReader, line, &line, true );
@@ -3391,6 +3754,8 @@ void SCH_LEGACY_PLUGIN_CACHE::Save( bool aSaveDocFile )
     if( !m_isModified )
         return;
 
+    loadAllParts();
+
     // Write through symlinks, don't replace them
     wxFileName fn = GetRealFile();
 
@@ -3915,6 +4280,9 @@ void SCH_LEGACY_PLUGIN_CACHE::saveDocFile()
 
 void SCH_LEGACY_PLUGIN_CACHE::DeleteAlias( const wxString& aAliasName )
 {
+    // The library is modified: all of its symbols are needed to save it.
+    loadAllParts();
+
     LIB_ALIAS_MAP::iterator it = m_aliases.find( aAliasName );
 
     if( it == m_aliases.end() )
@@ -3950,6 +4318,8 @@ void SCH_LEGACY_PLUGIN_CACHE::DeleteAlias( const wxString& aAliasName )
 
 void SCH_LEGACY_PLUGIN_CACHE::DeleteSymbol( const wxString& aAliasName )
 {
+    loadAllParts();
+
     LIB_ALIAS_MAP::iterator it = m_aliases.find( aAliasName );
 
     if( it == m_aliases.end() )
@@ -4022,7 +4392,7 @@ size_t SCH_LEGACY_PLUGIN::GetSymbolLibCount( const wxString&   aLibraryPath,
 
     cacheLib( aLibraryPath );
 
-    return m_cache->m_aliases.size();
+    return m_cache->GetAliasCount();
 }
 
 
@@ -4038,13 +4408,7 @@ void SCH_LEGACY_PLUGIN::EnumerateSymbolLib( wxArrayString&    aAliasNameList,
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
     cacheLib( aLibraryPath );
 
-    const LIB_ALIAS_MAP& aliases = m_cache->m_aliases;
-
-    for( LIB_ALIAS_MAP::const_iterator it = aliases.begin();  it != aliases.end();  ++it )
-    {
-        if( !powerSymbolsOnly || it->second->GetPart()->IsPower() )
-            aAliasNameList.Add( it->first );
-    }
+    m_cache->GetAliasNames( aAliasNameList, powerSymbolsOnly );
 }
 
 
@@ -4060,13 +4424,7 @@ void SCH_LEGACY_PLUGIN::EnumerateSymbolLib( std::vector<LIB_ALIAS*>& aAliasList,
                               aProperties->find( SYMBOL_LIB_TABLE::PropPowerSymsOnly ) != aProperties->end() );
     cacheLib( aLibraryPath );
 
-    const LIB_ALIAS_MAP& aliases = m_cache->m_aliases;
-
-    for( LIB_ALIAS_MAP::const_iterator it = aliases.begin();  it != aliases.end();  ++it )
-    {
-        if( !powerSymbolsOnly || it->second->GetPart()->IsPower() )
-            aAliasList.push_back( it->second );
-    }
+    m_cache->GetAliases( aAliasList, powerSymbolsOnly );
 }
 
 
@@ -4079,12 +4437,7 @@ LIB_ALIAS* SCH_LEGACY_PLUGIN::LoadSymbol( const wxString& aLibraryPath, const wx
 
     cacheLib( aLibraryPath );
 
-    LIB_ALIAS_MAP::const_iterator it = m_cache->m_aliases.find( aAliasName );
-
-    if( it == m_cache->m_aliases.end() )
-        return NULL;
-
-    return it->second;
+    return m_cache->FindAlias( aAliasName );
 }
 
 
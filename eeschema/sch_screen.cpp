@@ -52,10 +52,13 @@
 #include <sch_sheet.h>
 #include <sch_component.h>
 #include <sch_text.h>
+#include <sch_item_index.h>
 #include <lib_pin.h>
 #include <symbol_lib_table.h>
 #include <tool/common_tools.h>
 
+#include <unordered_map>
+
 #define EESCHEMA_FILE_STAMP   "EESchema"
 
 /* Default zoom values. Limited to these values to keep a decent size
@@ -96,6 +99,7 @@ SCH_SCREEN::SCH_SCREEN( KIWAY* aKiway ) :
     m_paper( wxT( "A4" ) )
 {
     m_modification_sync = 0;
+    m_itemIndex = new SCH_ITEM_INDEX();
 
     SetZoom( 32 );
 
@@ -125,6 +129,88 @@ SCH_SCREEN::~SCH_SCREEN()
     // FreeDrawList() with m_drawList.meOwner == false will generate a debug alert in debug mode
     if( GetDrawItems() )
         FreeDrawList();
+
+    delete m_itemIndex;
+}
+
+
+void SCH_SCREEN::syncItemIndex()
+{
+    if( m_itemIndex )
+        m_itemIndex->Sync( m_drawList.begin() );
+}
+
+
+void SCH_SCREEN::EnableItemIndex( bool aEnable )
+{
+    if( aEnable && !m_itemIndex )
+    {
+        m_itemIndex = new SCH_ITEM_INDEX();
+        syncItemIndex();
+    }
+    else if( !aEnable )
+    {
+        delete m_itemIndex;
+        m_itemIndex = NULL;
+    }
+}
+
+
+void SCH_SCREEN::UpdateItem( SCH_ITEM* aItem )
+{
+    wxCHECK_RET( aItem, wxT( "Cannot update invalid item." ) );
+
+    if( !m_itemIndex )
+        return;
+
+    // Sheet pins and component fields are indexed with their parent
+    if( aItem->Type() == SCH_SHEET_PIN_T || aItem->Type() == SCH_FIELD_T )
+    {
+        EDA_ITEM* parent = aItem->GetParent();
+
+        if( parent && ( parent->Type() == SCH_SHEET_T || parent->Type() == SCH_COMPONENT_T ) )
+            m_itemIndex->Update( (SCH_ITEM*) parent );
+
+        return;
+    }
+
+    m_itemIndex->Update( aItem );
+}
+
+
+void SCH_SCREEN::visitItems( const EDA_RECT& aArea,
+                             std::function<bool( SCH_ITEM* )> aVisitor ) const
+{
+    if( m_itemIndex )
+    {
+        std::vector<SCH_ITEM*> candidates;
+        m_itemIndex->Query( aArea, candidates );
+
+        for( SCH_ITEM* item : candidates )
+        {
+            if( !aVisitor( item ) )
+                return;
+        }
+
+        return;
+    }
+
+    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    {
+        if( !aVisitor( item ) )
+            return;
+    }
+}
+
+
+void SCH_SCREEN::visitItems( const wxPoint& aPosition, int aAccuracy,
+                             std::function<bool( SCH_ITEM* )> aVisitor ) const
+{
+    // One more unit, for the hit tests rounding their distances
+    EDA_RECT area( aPosition, wxSize( 0, 0 ) );
+    area.Inflate( std::max( aAccuracy, 0 ) + 1 );
+
+    visitItems( area, aVisitor );
 }
 
 
@@ -146,16 +232,55 @@ void SCH_SCREEN::Append( SCH_SCREEN* aScreen )
 {
     wxCHECK_RET( aScreen, "Invalid screen object." );
 
+    SCH_ITEM* first = aScreen->m_drawList.begin();
+
     // No need to decend the hierarchy.  Once the top level screen is copied, all of it's
     // children are copied as well.
     m_drawList.Append( aScreen->m_drawList );
 
+    if( aScreen->m_itemIndex )
+        aScreen->m_itemIndex->Clear();
+
+    for( SCH_ITEM* item = first; item && m_itemIndex; item = item->Next() )
+        m_itemIndex->Insert( item );
+
     // This screen owns the objects now.  This prevents the object from being delete when
     // aSheet is deleted.
     aScreen->m_drawList.SetOwnership( false );
 }
 
 
+void SCH_SCREEN::Append( SCH_ITEM* aItem )
+{
+    m_drawList.Append( aItem );
+    --m_modification_sync;
+
+    if( m_itemIndex )
+        m_itemIndex->Insert( aItem );
+}
+
+
+void SCH_SCREEN::Append( DLIST< SCH_ITEM >& aList )
+{
+    SCH_ITEM* first = aList.begin();
+
+    m_drawList.Append( aList );
+    --m_modification_sync;
+
+    for( SCH_ITEM* item = first; item && m_itemIndex; item = item->Next() )
+        m_itemIndex->Insert( item );
+}
+
+
+void SCH_SCREEN::Insert( SCH_ITEM* aItem, SCH_ITEM* aBefore )
+{
+    m_drawList.Insert( aItem, aBefore );
+
+    if( m_itemIndex )
+        m_itemIndex->Insert( aItem, aBefore );
+}
+
+
 void SCH_SCREEN::Clear()
 {
     FreeDrawList();
@@ -169,12 +294,18 @@ void SCH_SCREEN::Clear()
 
 void SCH_SCREEN::FreeDrawList()
 {
+    if( m_itemIndex )
+        m_itemIndex->Clear();
+
     m_drawList.DeleteAll();
 }
 
 
 void SCH_SCREEN::Remove( SCH_ITEM* aItem )
 {
+    if( m_itemIndex )
+        m_itemIndex->Remove( aItem );
+
     m_drawList.Remove( aItem );
 }
 
@@ -197,6 +328,9 @@ void SCH_SCREEN::DeleteItem( SCH_ITEM* aItem )
     }
     else
     {
+        if( m_itemIndex )
+            m_itemIndex->Remove( aItem );
+
         delete m_drawList.Remove( aItem );
     }
 }
@@ -220,7 +354,9 @@ bool SCH_SCREEN::CheckIfOnDrawList( SCH_ITEM* aItem )
 
 SCH_ITEM* SCH_SCREEN::GetItem( const wxPoint& aPosition, int aAccuracy, KICAD_T aType ) const
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    SCH_ITEM* found = NULL;
+
+    visitItems( aPosition, aAccuracy, [&]( SCH_ITEM* item ) -> bool
     {
         if( (aType == SCH_FIELD_T) && (item->Type() == SCH_COMPONENT_T) )
         {
@@ -231,7 +367,10 @@ SCH_ITEM* SCH_SCREEN::GetItem( const wxPoint& aPosition, int aAccuracy, KICAD_T
                 SCH_FIELD* field = component->GetField( i );
 
                 if( field->HitTest( aPosition, aAccuracy ) )
-                    return (SCH_ITEM*) field;
+                {
+                    found = (SCH_ITEM*) field;
+                    return false;
+                }
             }
         }
         else if( (aType == SCH_SHEET_PIN_T) && (item->Type() == SCH_SHEET_T) )
@@ -241,16 +380,22 @@ SCH_ITEM* SCH_SCREEN::GetItem( const wxPoint& aPosition, int aAccuracy, KICAD_T
             SCH_SHEET_PIN* label = sheet->GetPin( aPosition );
 
             if( label )
-                return (SCH_ITEM*) label;
+            {
+                found = (SCH_ITEM*) label;
+                return false;
+            }
         }
         else if( ( ( item->Type() == aType ) || ( aType == NOT_USED ) )
                 && item->HitTest( aPosition, aAccuracy ) )
         {
-            return item;
+            found = item;
+            return false;
         }
-    }
 
-    return NULL;
+        return true;
+    } );
+
+    return found;
 }
 
 
@@ -276,7 +421,12 @@ void SCH_SCREEN::ReplaceWires( DLIST< SCH_ITEM >& aWireList )
         }
     }
 
+    SCH_ITEM* first = aWireList.begin();
+
     m_drawList.Append( aWireList );
+
+    for( item = first; item && m_itemIndex; item = item->Next() )
+        m_itemIndex->Insert( item );
 }
 
 
@@ -285,39 +435,47 @@ void SCH_SCREEN::MarkConnections( SCH_LINE* aSegment )
     wxCHECK_RET( (aSegment) && (aSegment->Type() == SCH_LINE_T),
                  wxT( "Invalid object pointer." ) );
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
-    {
-        if( item->GetFlags() & CANDIDATE )
-            continue;
+    // The junctions and segments connected to aSegment are at one of its ends
+    const wxPoint ends[2] = { aSegment->GetStartPoint(), aSegment->GetEndPoint() };
 
-        if( item->Type() == SCH_JUNCTION_T )
+    for( const wxPoint& end : ends )
+    {
+        visitItems( end, 0, [&]( SCH_ITEM* item ) -> bool
         {
-            SCH_JUNCTION* junction = (SCH_JUNCTION*) item;
+            if( item->GetFlags() & CANDIDATE )
+                return true;
 
-            if( aSegment->IsEndPoint( junction->GetPosition() ) )
-                item->SetFlags( CANDIDATE );
+            if( item->Type() == SCH_JUNCTION_T )
+            {
+                SCH_JUNCTION* junction = (SCH_JUNCTION*) item;
 
-            continue;
-        }
+                if( aSegment->IsEndPoint( junction->GetPosition() ) )
+                    item->SetFlags( CANDIDATE );
 
-        if( item->Type() != SCH_LINE_T )
-            continue;
+                return true;
+            }
 
-        SCH_LINE* segment = (SCH_LINE*) item;
+            if( item->Type() != SCH_LINE_T )
+                return true;
 
-        if( aSegment->IsEndPoint( segment->GetStartPoint() )
-            && !GetPin( segment->GetStartPoint(), NULL, true ) )
-        {
-            item->SetFlags( CANDIDATE );
-            MarkConnections( segment );
-        }
+            SCH_LINE* segment = (SCH_LINE*) item;
 
-        if( aSegment->IsEndPoint( segment->GetEndPoint() )
-            && !GetPin( segment->GetEndPoint(), NULL, true ) )
-        {
-            item->SetFlags( CANDIDATE );
-            MarkConnections( segment );
-        }
+            if( aSegment->IsEndPoint( segment->GetStartPoint() )
+                && !GetPin( segment->GetStartPoint(), NULL, true ) )
+            {
+                item->SetFlags( CANDIDATE );
+                MarkConnections( segment );
+            }
+
+            if( aSegment->IsEndPoint( segment->GetEndPoint() )
+                && !GetPin( segment->GetEndPoint(), NULL, true ) )
+            {
+                item->SetFlags( CANDIDATE );
+                MarkConnections( segment );
+            }
+
+            return true;
+        } );
     }
 }
 
@@ -328,15 +486,20 @@ bool SCH_SCREEN::IsJunctionNeeded( const wxPoint& aPosition, bool aNew )
     int     end_count[2] = { 0 };
     int     pin_count = 0;
 
+    bool    has_junction = false;
+
     std::vector<SCH_LINE*> lines[2];
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    visitItems( aPosition, 0, [&]( SCH_ITEM* item ) -> bool
     {
         if( item->GetFlags() & STRUCT_DELETED )
-            continue;
+            return true;
 
         if( aNew && ( item->Type() == SCH_JUNCTION_T ) && ( item->HitTest( aPosition ) ) )
+        {
+            has_junction = true;
             return false;
+        }
 
         if( ( item->Type() == SCH_LINE_T )
             && ( item->HitTest( aPosition, 0 ) ) )
@@ -350,7 +513,12 @@ bool SCH_SCREEN::IsJunctionNeeded( const wxPoint& aPosition, bool aNew )
         if( ( item->Type() == SCH_COMPONENT_T )
                 && ( item->IsConnected( aPosition ) ) )
             pin_count++;
-    }
+
+        return true;
+    } );
+
+    if( has_junction )
+        return false;
 
     for( int i = 0; i < 2; i++ )
     {
@@ -492,6 +660,9 @@ void SCH_SCREEN::UpdateSymbolLinks( bool aForce )
             SCH_COMPONENT::ResolveAll( c, *libs, Prj().SchLibs()->GetCacheLibrary() );
 
             m_modification_sync = mod_hash;     // note the last mod_hash
+
+            // The component bounding boxes come from their library symbols
+            syncItemIndex();
         }
         // Resolving will update the pin caches but we must ensure that this happens
         // even if the libraries don't change.
@@ -568,14 +739,13 @@ void SCH_SCREEN::ClearDrawingState()
 LIB_PIN* SCH_SCREEN::GetPin( const wxPoint& aPosition, SCH_COMPONENT** aComponent,
                              bool aEndPointOnly ) const
 {
-    SCH_ITEM*       item;
     SCH_COMPONENT*  component = NULL;
     LIB_PIN*        pin = NULL;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    visitItems( aPosition, 0, [&]( SCH_ITEM* item ) -> bool
     {
         if( item->Type() != SCH_COMPONENT_T )
-            continue;
+            return true;
 
         component = (SCH_COMPONENT*) item;
 
@@ -586,7 +756,7 @@ LIB_PIN* SCH_SCREEN::GetPin( const wxPoint& aPosition, SCH_COMPONENT** aComponen
             auto part = component->GetPartRef().lock();
 
             if( !part )
-                continue;
+                return true;
 
             for( pin = part->GetNextPin(); pin; pin = part->GetNextPin( pin ) )
             {
@@ -603,16 +773,18 @@ LIB_PIN* SCH_SCREEN::GetPin( const wxPoint& aPosition, SCH_COMPONENT** aComponen
                     break;
             }
             if( pin )
-                break;
+                return false;
         }
         else
         {
             pin = (LIB_PIN*) component->GetDrawItem( aPosition, LIB_PIN_T );
 
             if( pin )
-                break;
+                return false;
         }
-    }
+
+        return true;
+    } );
 
     if( pin && aComponent )
         *aComponent = component;
@@ -642,17 +814,16 @@ SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 {
     SCH_SHEET_PIN* sheetPin = NULL;
 
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    visitItems( aPosition, 0, [&]( SCH_ITEM* item ) -> bool
     {
         if( item->Type() != SCH_SHEET_T )
-            continue;
+            return true;
 
         SCH_SHEET* sheet = (SCH_SHEET*) item;
         sheetPin = sheet->GetPin( aPosition );
 
-        if( sheetPin )
-            break;
-    }
+        return sheetPin == NULL;
+    } );
 
     return sheetPin;
 }
@@ -660,17 +831,18 @@ SCH_SHEET_PIN* SCH_SCREEN::GetSheetLabel( const wxPoint& aPosition )
 
 int SCH_SCREEN::CountConnectedItems( const wxPoint& aPos, bool aTestJunctions ) const
 {
-    SCH_ITEM* item;
     int       count = 0;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    visitItems( aPos, 0, [&]( SCH_ITEM* item ) -> bool
     {
         if( item->Type() == SCH_JUNCTION_T  && !aTestJunctions )
-            continue;
+            return true;
 
         if( item->IsConnected( aPos ) )
             count++;
-    }
+
+        return true;
+    } );
 
     return count;
 }
@@ -754,6 +926,7 @@ void SCH_SCREEN::SelectBlockItems()
 
     // Select all the items in the screen connected to the items in the block.
     // be sure end lines that are on the block limits are seen inside this block
+    syncItemIndex();
     m_BlockLocate.Inflate( 1 );
     unsigned last_select_id = pickedlist->GetCount();
 
@@ -807,15 +980,20 @@ void SCH_SCREEN::SelectBlockItems()
 
 void SCH_SCREEN::addConnectedItemsToBlock( const SCH_ITEM* aItem, const wxPoint& position )
 {
-    SCH_ITEM* item;
     ITEM_PICKER picker;
+    EDA_RECT    area( position, wxSize( 0, 0 ) );
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
-    {
+    // The items connected to the middle of a moved line can be anywhere on the line
+    if( aItem->Type() == SCH_LINE_T && !( aItem->GetFlags() & ( ENDPOINT | STARTPOINT ) ) )
+        area.Merge( aItem->GetBoundingBox() );
 
+    area.Inflate( 1 );
+
+    visitItems( area, [&]( SCH_ITEM* item ) -> bool
+    {
         if( !item->IsConnectable() || ( item->GetFlags() & SKIP_STRUCT )
                 || !item->CanConnect( aItem ) || item == aItem )
-            continue;
+            return true;
 
         // A line having 2 ends, it can be tested twice: one time per end
         if( item->Type() == SCH_LINE_T )
@@ -823,7 +1001,7 @@ void SCH_SCREEN::addConnectedItemsToBlock( const SCH_ITEM* aItem, const wxPoint&
             SCH_LINE* line = (SCH_LINE*) item;
 
             if( !item->HitTest( position ) )
-                continue;
+                return true;
 
             // First time through.  Flags set to denote an end that is not moving
             if( !item->IsSelected() )
@@ -856,7 +1034,7 @@ void SCH_SCREEN::addConnectedItemsToBlock( const SCH_ITEM* aItem, const wxPoint&
         }
 
         if( item->IsSelected() )
-            continue;
+            return true;
 
         if( ( item->GetFlags() & CANDIDATE ) || item->IsConnected( position ) ) // Deal with all non-line items
         {
@@ -866,7 +1044,9 @@ void SCH_SCREEN::addConnectedItemsToBlock( const SCH_ITEM* aItem, const wxPoint&
             picker.SetFlags( item->GetFlags() );
             m_BlockLocate.GetItems().PushItem( picker );
         }
-    }
+
+        return true;
+    } );
 }
 
 
@@ -909,19 +1089,58 @@ int SCH_SCREEN::UpdatePickList()
 
 bool SCH_SCREEN::TestDanglingEnds()
 {
-    SCH_ITEM* item;
+    syncItemIndex();
+
+    std::vector< SCH_ITEM* > items;
+    std::unordered_map< SCH_ITEM*, size_t > ordinals;
     std::vector< DANGLING_END_ITEM > endPoints;
+    std::vector< size_t > firstEndPoint;
     bool hasStateChanged = false;
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    // The end points of the item ii are endPoints[firstEndPoint[ii]] to
+    // endPoints[firstEndPoint[ii + 1] - 1]
+    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    {
+        ordinals[item] = items.size();
+        items.push_back( item );
+        firstEndPoint.push_back( endPoints.size() );
         item->GetEndPoints( endPoints );
+    }
 
-    for( item = m_drawList.begin(); item; item = item->Next() )
+    firstEndPoint.push_back( endPoints.size() );
+
+    // Each item is tested with the end points of the items near it only.  The end points
+    // are given in the draw list order, because the text items read the wires end points
+    // by pairs
+    std::vector< DANGLING_END_ITEM > nearEndPoints;
+
+    for( size_t ii = 0; ii < items.size(); ii++ )
     {
-        if( item->IsDanglingStateChanged( endPoints ) )
+        if( !m_itemIndex )
         {
-            hasStateChanged = true;
+            if( items[ii]->IsDanglingStateChanged( endPoints ) )
+                hasStateChanged = true;
+
+            continue;
         }
+
+        EDA_RECT area = m_itemIndex->GetArea( items[ii] );
+        area.Inflate( 1 );
+
+        nearEndPoints.clear();
+
+        visitItems( area, [&]( SCH_ITEM* candidate ) -> bool
+        {
+            size_t ordinal = ordinals[candidate];
+
+            nearEndPoints.insert( nearEndPoints.end(),
+                                  endPoints.begin() + firstEndPoint[ordinal],
+                                  endPoints.begin() + firstEndPoint[ordinal + 1] );
+            return true;
+        } );
+
+        if( items[ii]->IsDanglingStateChanged( nearEndPoints ) )
+            hasStateChanged = true;
     }
 
     return hasStateChanged;
@@ -930,7 +1149,7 @@ bool SCH_SCREEN::TestDanglingEnds()
 
 int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    visitItems( aPosition, 0, [&]( SCH_ITEM* item ) -> bool
     {
         if( item->Type() == SCH_LINE_T && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
@@ -941,7 +1160,9 @@ int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
         {
             aList.push_back( item );
         }
-    }
+
+        return true;
+    } );
 
     return (int) aList.size();
 }
@@ -949,56 +1170,68 @@ int SCH_SCREEN::GetNode( const wxPoint& aPosition, EDA_ITEMS& aList )
 
 SCH_LINE* SCH_SCREEN::GetWireOrBus( const wxPoint& aPosition )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    SCH_LINE* found = NULL;
+
+    visitItems( aPosition, 0, [&]( SCH_ITEM* item ) -> bool
     {
         if( (item->Type() == SCH_LINE_T) && item->HitTest( aPosition )
             && (item->GetLayer() == LAYER_BUS || item->GetLayer() == LAYER_WIRE) )
         {
-            return (SCH_LINE*) item;
+            found = (SCH_LINE*) item;
+            return false;
         }
-    }
 
-    return NULL;
+        return true;
+    } );
+
+    return found;
 }
 
 
 SCH_LINE* SCH_SCREEN::GetLine( const wxPoint& aPosition, int aAccuracy, int aLayer,
                                SCH_LINE_TEST_T aSearchType )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    SCH_LINE* found = NULL;
+
+    visitItems( aPosition, aAccuracy, [&]( SCH_ITEM* item ) -> bool
     {
         if( item->Type() != SCH_LINE_T )
-            continue;
+            return true;
 
         if( item->GetLayer() != aLayer )
-            continue;
+            return true;
 
         if( !item->HitTest( aPosition, aAccuracy ) )
-            continue;
+            return true;
 
         switch( aSearchType )
         {
         case ENTIRE_LENGTH_T:
-            return (SCH_LINE*) item;
+            found = (SCH_LINE*) item;
+            break;
 
         case EXCLUDE_END_POINTS_T:
             if( !( (SCH_LINE*) item )->IsEndPoint( aPosition ) )
-                return (SCH_LINE*) item;
+                found = (SCH_LINE*) item;
             break;
 
         case END_POINTS_ONLY_T:
             if( ( (SCH_LINE*) item )->IsEndPoint( aPosition ) )
-                return (SCH_LINE*) item;
+                found = (SCH_LINE*) item;
         }
-    }
 
-    return NULL;
+        return found == NULL;
+    } );
+
+    return found;
 }
 
 
 SCH_TEXT* SCH_SCREEN::GetLabel( const wxPoint& aPosition, int aAccuracy )
 {
-    for( SCH_ITEM* item = m_drawList.begin(); item; item = item->Next() )
+    SCH_TEXT* found = NULL;
+
+    visitItems( aPosition, aAccuracy, [&]( SCH_ITEM* item ) -> bool
     {
         switch( item->Type() )
         {
@@ -1006,14 +1239,16 @@ SCH_TEXT* SCH_SCREEN::GetLabel( const wxPoint& aPosition, int aAccuracy )
         case SCH_GLOBAL_LABEL_T:
         case SCH_HIERARCHICAL_LABEL_T:
             if( item->HitTest( aPosition, aAccuracy ) )
-                return (SCH_TEXT*) item;
+                found = (SCH_TEXT*) item;
 
         default:
             ;
         }
-    }
 
-    return NULL;
+        return found == NULL;
+    } );
+
+    return found;
 }
 
 
@@ -1067,12 +1302,13 @@ int SCH_SCREEN::GetConnection( const wxPoint& aPosition, PICKED_ITEMS_LIST& aLis
                                bool aFullConnection )
 {
     SCH_ITEM* item;
-    EDA_ITEM* tmp;
     EDA_ITEMS list;
 
     // Clear flags member for all items.
     ClearDrawingState();
 
+    syncItemIndex();
+
     if( GetNode( aPosition, list ) == 0 )
         return 0;
 
@@ -1091,6 +1327,29 @@ int SCH_SCREEN::GetConnection( const wxPoint& aPosition, PICKED_ITEMS_LIST& aLis
     {
         SCH_LINE* segment;
 
+        // Test for a segment connected at aPoint to a previously deleted segment
+        auto isDeletedSegmentEnd = [this]( const wxPoint& aPoint ) -> bool
+        {
+            bool found = false;
+
+            visitItems( aPoint, 0, [&]( SCH_ITEM* tmp ) -> bool
+            {
+                // Ensure tmp is a previously deleted segment:
+                if( ( tmp->GetFlags() & STRUCT_DELETED ) == 0 )
+                    return true;
+
+                if( tmp->Type() != SCH_LINE_T )
+                    return true;
+
+                SCH_LINE* testSegment = (SCH_LINE*) tmp;
+
+                found = testSegment->IsEndPoint( aPoint );
+                return !found;
+            } );
+
+            return found;
+        };
+
         for( item = m_drawList.begin(); item; item = item->Next() )
         {
             if( !(item->GetFlags() & SELECTEDNODE) )
@@ -1121,51 +1380,17 @@ int SCH_SCREEN::GetConnection( const wxPoint& aPosition, PICKED_ITEMS_LIST& aLis
             segment = (SCH_LINE*) item;
 
             /* If the wire start point is connected to a wire that was already found
-             * and now is not connected, add the wire to the list. */
-            for( tmp = m_drawList.begin(); tmp; tmp = tmp->Next() )
-            {
-                // Ensure tmp is a previously deleted segment:
-                if( ( tmp->GetFlags() & STRUCT_DELETED ) == 0 )
-                    continue;
-
-                if( tmp->Type() != SCH_LINE_T )
-                    continue;
-
-                SCH_LINE* testSegment = (SCH_LINE*) tmp;
-
-               // Test for segment connected to the previously deleted segment:
-                if( testSegment->IsEndPoint( segment->GetStartPoint() ) )
-                    break;
-            }
-
-            // when tmp != NULL, segment is a new candidate:
-            // put it in deleted list if
-            // the start point is not connected to another item (like pin)
-            if( tmp && !CountConnectedItems( segment->GetStartPoint(), true ) )
+             * and now is not connected, segment is a new candidate: put it in deleted
+             * list if the start point is not connected to another item (like pin). */
+            if( isDeletedSegmentEnd( segment->GetStartPoint() )
+                && !CountConnectedItems( segment->GetStartPoint(), true ) )
                 noconnect = true;
 
             /* If the wire end point is connected to a wire that has already been found
-             * and now is not connected, add the wire to the list. */
-            for( tmp = m_drawList.begin(); tmp; tmp = tmp->Next() )
-            {
-                // Ensure tmp is a previously deleted segment:
-                if( ( tmp->GetFlags() & STRUCT_DELETED ) == 0 )
-                    continue;
-
-                if( tmp->Type() != SCH_LINE_T )
-                    continue;
-
-                SCH_LINE* testSegment = (SCH_LINE*) tmp;
-
-                // Test for segment connected to the previously deleted segment:
-                if( testSegment->IsEndPoint( segment->GetEndPoint() ) )
-                    break;
-            }
-
-            // when tmp != NULL, segment is a new candidate:
-            // put it in deleted list if
-            // the end point is not connected to another item (like pin)
-            if( tmp && !CountConnectedItems( segment->GetEndPoint(), true ) )
+             * and now is not connected, segment is a new candidate: put it in deleted
+             * list if the end point is not connected to another item (like pin). */
+            if( isDeletedSegmentEnd( segment->GetEndPoint() )
+                && !CountConnectedItems( segment->GetEndPoint(), true ) )
                 noconnect = true;
 
             item->ClearFlags( SKIP_STRUCT );
@@ -1189,7 +1414,7 @@ int SCH_SCREEN::GetConnection( const wxPoint& aPosition, PICKED_ITEMS_LIST& aLis
             if( item->Type() != SCH_LABEL_T )
                 continue;
 
-            tmp = GetWireOrBus( ( (SCH_TEXT*) item )->GetPosition() );
+            SCH_LINE* tmp = GetWireOrBus( ( (SCH_TEXT*) item )->GetPosition() );
 
             if( tmp && ( tmp->GetFlags() & STRUCT_DELETED ) )
             {
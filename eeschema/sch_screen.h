@@ -30,6 +30,8 @@
 #ifndef SCREEN_H
 #define SCREEN_H
 
+#include <functional>
+
 #include <macros.h>
 #include <dlist.h>
 #include <sch_item_struct.h>
@@ -51,6 +53,7 @@ class SCH_LINE;
 class SCH_TEXT;
 class PLOTTER;
 class SCH_SHEET_LIST;
+class SCH_ITEM_INDEX;
 
 
 enum SCH_LINE_TEST_T
@@ -95,6 +98,33 @@ private:
     int     m_modification_sync;        ///< inequality with PART_LIBS::GetModificationHash()
                                         ///< will trigger ResolveAll().
 
+    /// Spatial index of m_drawList, kept up to date with the list, or NULL when disabled
+    /// (see EnableItemIndex()).
+    SCH_ITEM_INDEX* m_itemIndex;
+
+    /**
+     * Bring the item index up to date with the draw list, before an operation testing all
+     * the items of the screen.  The cost is the same as walking the list once.
+     */
+    void syncItemIndex();
+
+    /**
+     * Call \a aVisitor for the items whose area intersects \a aArea, in the draw list
+     * order, until it returns false.
+     * <p>
+     * The items are found with the item index if it is enabled, otherwise all the items of
+     * the draw list are visited.  \a aVisitor must test the items itself.
+     * </p>
+     */
+    void visitItems( const EDA_RECT& aArea, std::function<bool( SCH_ITEM* )> aVisitor ) const;
+
+    /**
+     * Call \a aVisitor for the items which can be hit at \a aPosition with \a aAccuracy,
+     * like the EDA_RECT version.
+     */
+    void visitItems( const wxPoint& aPosition, int aAccuracy,
+                     std::function<bool( SCH_ITEM* )> aVisitor ) const;
+
     /**
      * Add items connected at \a aPosition to the block pick list.
      * <p>
@@ -159,11 +189,12 @@ public:
      */
     SCH_ITEM* GetDrawItems() const                          { return m_drawList.begin(); }
 
-    void Append( SCH_ITEM* aItem )
-    {
-        m_drawList.Append( aItem );
-        --m_modification_sync;
-    }
+    void Append( SCH_ITEM* aItem );
+
+    /**
+     * Insert \a aItem in the draw list before \a aBefore, or at the end if \a aBefore is NULL.
+     */
+    void Insert( SCH_ITEM* aItem, SCH_ITEM* aBefore );
 
     /**
      * Copy the contents of \a aScreen into this #SCH_SCREEN object.
@@ -182,11 +213,25 @@ public:
      *
      * @param aList A reference to a #DLIST containing the #SCH_ITEM to add to the sheet.
      */
-    void Append( DLIST< SCH_ITEM >& aList )
-    {
-        m_drawList.Append( aList );
-        --m_modification_sync;
-    }
+    void Append( DLIST< SCH_ITEM >& aList );
+
+    /**
+     * Update the position of \a aItem in the item index, after it was moved, rotated,
+     * mirrored or resized.  For a sheet pin or a component field, its parent is updated.
+     *
+     * The batch operations (TestDanglingEnds(), SelectBlockItems(), GetConnection())
+     * also bring the whole index up to date when they start.
+     */
+    void UpdateItem( SCH_ITEM* aItem );
+
+    /**
+     * Enable or disable the item index.  Without the index, the position queries test all
+     * the items of the draw list.  The index is enabled by default; disabling it is only
+     * useful to compare the results of both ways.
+     */
+    void EnableItemIndex( bool aEnable );
+
+    bool IsItemIndexEnabled() const { return m_itemIndex != NULL; }
 
     /**
      * Return the currently selected SCH_ITEM, overriding BASE_SCREEN::GetCurItem().
@@ -379,6 +379,9 @@ void SCH_EDIT_FRAME::PutDataInPreviousState( PICKED_ITEMS_LIST* aList, bool aRed
                                           aList->GetPickedItemStatus( (unsigned) ii ) ) );
             break;
         }
+
+        // The changed items may have moved.  The removed items are not in the index.
+        GetScreen()->UpdateItem( item );
     }
 
     // Bitmaps are cached in Opengl: clear the cache, because
@@ -299,6 +299,7 @@ bool SCH_EDIT_FRAME::EditSheet( SCH_SHEET* aSheet, SCH_SHEET_PATH* aHierarchy, b
     m_canvas->MoveCursorToCrossHair();
     m_canvas->SetIgnoreMouseEvents( false );
 
+    GetScreen()->UpdateItem( aSheet );
     GetCanvas()->GetView()->Update( aSheet );
 
     OnModify();
@@ -479,6 +480,7 @@ void SCH_EDIT_FRAME::RotateHierarchicalSheet( SCH_SHEET* aSheet, bool aRotCCW )
         aSheet->Rotate( rotPoint );
     }
 
+    GetScreen()->UpdateItem( aSheet );
     GetCanvas()->GetView()->Update( aSheet );
     OnModify();
 }
@@ -502,6 +504,7 @@ void SCH_EDIT_FRAME::MirrorSheet( SCH_SHEET* aSheet, bool aFromXaxis )
     else                // Mirror relative to vertical axis
         aSheet->MirrorY( mirrorPoint.x );
 
+    GetScreen()->UpdateItem( aSheet );
     GetCanvas()->GetView()->Update( aSheet );
     OnModify();
 }
@@ -27,6 +27,7 @@
 
 #include "ngspice.h"
 #include "spice_reporter.h"
+#include "sim_results.h"
 
 #include <common.h>     // LOCALE_IO
 #include <wx/stdpaths.h>
@@ -222,6 +223,13 @@ bool NGSPICE::LoadNetlist( const string& aNetlist )
 
 bool NGSPICE::Run()
 {
+    // The results of the previous run must not be shown if this one fails before
+    // sending its vectors
+    {
+        std::lock_guard<std::mutex> lock( m_resultsMutex );
+        m_results.reset();
+    }
+
     LOCALE_IO c_locale;               // ngspice works correctly only with C locale
     return Command( "bg_run" );     // bg_* commands execute in a separate thread
 }
@@ -335,7 +343,8 @@ void NGSPICE::init_dll()
     m_ngSpice_AllVecs = (ngSpice_AllVecs) m_dll.GetSymbol( "ngSpice_AllVecs" );
     m_ngSpice_Running = (ngSpice_Running) m_dll.GetSymbol( "ngSpice_running" ); // it is not a typo
 
-    m_ngSpice_Init( &cbSendChar, &cbSendStat, &cbControlledExit, NULL, NULL, &cbBGThreadRunning, this );
+    m_ngSpice_Init( &cbSendChar, &cbSendStat, &cbControlledExit, &cbSendData, &cbSendInitData,
+                    &cbBGThreadRunning, this );
 
     // Load a custom spinit file, to fix the problem with loading .cm files
     // Switch to the executable directory, so the relative paths are correct
@@ -496,6 +505,68 @@ int NGSPICE::cbBGThreadRunning( bool is_running, int id, void* user )
 }
 
 
+int NGSPICE::cbSendInitData( pvecinfoall init, int id, void* user )
+{
+    NGSPICE* sim = reinterpret_cast<NGSPICE*>( user );
+    std::vector<std::string> names;
+    std::vector<bool> isComplex;
+
+    for( int i = 0; i < init->veccount; i++ )
+    {
+        names.push_back( init->vecs[i]->vecname );
+        isComplex.push_back( !init->vecs[i]->is_real );
+    }
+
+    // The previous results stay valid for the GUI thread until it releases them
+    std::shared_ptr<SIM_RESULTS> results = std::make_shared<SIM_RESULTS>( names, isComplex );
+
+    sim->m_point.resize( results->GetPointWidth() );
+
+    std::lock_guard<std::mutex> lock( sim->m_resultsMutex );
+    sim->m_results = results;
+
+    return 0;
+}
+
+
+int NGSPICE::cbSendData( pvecvaluesall values, int count, int id, void* user )
+{
+    NGSPICE* sim = reinterpret_cast<NGSPICE*>( user );
+
+    // m_results is replaced by this thread in cbSendInitData(), and cleared by Run()
+    std::shared_ptr<SIM_RESULTS> results;
+
+    {
+        std::lock_guard<std::mutex> lock( sim->m_resultsMutex );
+        results = sim->m_results;
+    }
+
+    if( !results || values->veccount != results->GetVectorCount() )
+        return 0;
+
+    double* point = sim->m_point.data();
+
+    for( int i = 0; i < values->veccount; i++ )
+    {
+        *point++ = values->vecsa[i]->creal;
+
+        if( results->IsComplex( i ) )
+            *point++ = values->vecsa[i]->cimag;
+    }
+
+    results->AppendPoint( sim->m_point.data() );
+
+    return 0;
+}
+
+
+std::shared_ptr<SIM_RESULTS> NGSPICE::GetResults() const
+{
+    std::lock_guard<std::mutex> lock( m_resultsMutex );
+    return m_results;
+}
+
+
 int NGSPICE::cbControlledExit( int status, bool immediate, bool exit_upon_quit, int id, void* user )
 {
     // Something went wrong, reload the dll
@@ -30,6 +30,8 @@
 #include <wx/dynlib.h>
 #include <ngspice/sharedspice.h>
 
+#include <mutex>
+
 class wxDynamicLibrary;
 
 class NGSPICE : public SPICE_SIMULATOR {
@@ -74,6 +76,9 @@ public:
     ///> @copydoc SPICE_SIMULATOR::GetPhasePlot()
     std::vector<double> GetPhasePlot( const std::string& aName, int aMaxLen = -1 ) override;
 
+    ///> @copydoc SPICE_SIMULATOR::GetResults()
+    std::shared_ptr<SIM_RESULTS> GetResults() const override;
+
     ///> @copydoc SPICE_SIMULATOR::GetNetlist()
     virtual const std::string GetNetlist() const override;
 
@@ -118,6 +123,8 @@ private:
     static int cbSendChar( char* what, int id, void* user );
     static int cbSendStat( char* what, int id, void* user );
     static int cbBGThreadRunning( bool is_running, int id, void* user );
+    static int cbSendInitData( pvecinfoall init, int id, void* user );
+    static int cbSendData( pvecvaluesall values, int count, int id, void* user );
     static int cbControlledExit( int status, bool immediate, bool exit_upon_quit, int id, void* user );
 
     // Assures ngspice is in a valid state and reinitializes it if need be
@@ -131,6 +138,15 @@ private:
 
     ///> current netlist
     std::string m_netlist;
+
+    ///> Vectors of the current simulation run, filled by the ngspice background thread
+    std::shared_ptr<SIM_RESULTS> m_results;
+
+    ///> Protects m_results against the GUI thread
+    mutable std::mutex m_resultsMutex;
+
+    ///> Values of the point being received, in the SIM_RESULTS layout
+    std::vector<double> m_point;
 };
 
 #endif /* NGSPICE_H */
@@ -41,6 +41,7 @@
 #include "sim_plot_frame.h"
 #include "sim_plot_panel.h"
 #include "spice_simulator.h"
+#include "sim_results.h"
 #include "spice_reporter.h"
 
 #include <menus_helpers.h>
@@ -166,6 +167,9 @@ SIM_PLOT_FRAME::SIM_PLOT_FRAME( KIWAY* aKiway, wxWindow* aParent )
     Connect( EVT_SIM_FINISHED, wxCommandEventHandler( SIM_PLOT_FRAME::onSimFinished ), NULL, this );
     Connect( EVT_SIM_CURSOR_UPDATE, wxCommandEventHandler( SIM_PLOT_FRAME::onCursorUpdate ), NULL, this );
 
+    m_plotUpdateTimer.SetOwner( this );
+    Bind( wxEVT_TIMER, &SIM_PLOT_FRAME::onPlotUpdateTimer, this, m_plotUpdateTimer.GetId() );
+
     // Toolbar buttons
     m_toolSimulate = m_toolBar->AddTool( ID_SIM_RUN, _( "Run/Stop Simulation" ),
             KiBitmap( sim_run_xpm ), _( "Run Simulation" ), wxITEM_NORMAL );
@@ -218,6 +222,7 @@ SIM_PLOT_FRAME::SIM_PLOT_FRAME( KIWAY* aKiway, wxWindow* aParent )
 
 SIM_PLOT_FRAME::~SIM_PLOT_FRAME()
 {
+    m_plotUpdateTimer.Stop();
     m_simulator->SetReporter( nullptr );
     delete m_reporter;
     delete m_signalsIconColorList;
@@ -499,6 +504,10 @@ bool SIM_PLOT_FRAME::updatePlot( const TRACE_DESC& aDescriptor, SIM_PLOT_PANEL*
         return false;
     }
 
+    // The results streamed by the simulator do not need to be copied
+    if( updateStreamedPlot( aDescriptor, aPanel ) )
+        return true;
+
     // First, handle the x axis
     wxString xAxisName( m_simulator->GetXAxis( simType ) );
 
@@ -557,6 +566,47 @@ bool SIM_PLOT_FRAME::updatePlot( const TRACE_DESC& aDescriptor, SIM_PLOT_PANEL*
 }
 
 
+bool SIM_PLOT_FRAME::updateStreamedPlot( const TRACE_DESC& aDescriptor, SIM_PLOT_PANEL* aPanel )
+{
+    std::shared_ptr<SIM_RESULTS> results = m_simulator->GetResults();
+
+    if( !results || results->GetPointCount() == 0 )
+        return false;
+
+    SIM_TYPE simType = m_exporter->GetSimType();
+    wxString xAxisName( m_simulator->GetXAxis( simType ) );
+
+    if( xAxisName.IsEmpty() )
+        return false;
+
+    wxString spiceVector = m_exporter->GetSpiceVector( aDescriptor.GetName(),
+            aDescriptor.GetType(), aDescriptor.GetParam() );
+
+    int vectorX = results->FindVector( (const char*) xAxisName.c_str() );
+    int vectorY = results->FindVector( (const char*) spiceVector.c_str() );
+
+    if( vectorX < 0 || vectorY < 0 )
+        return false;
+
+    TRACE* trace = aPanel->GetTrace( aDescriptor.GetTitle() );
+
+    // The trace already shows these results, only the new points are to be added
+    if( trace && trace->GetResults() == results )
+    {
+        trace->UpdateStreamedData();
+        return true;
+    }
+
+    if( aPanel->AddTrace( aDescriptor.GetTitle(), results, vectorX, vectorY,
+                aDescriptor.GetType() ) )
+    {
+        m_plots[aPanel].m_traces.insert( std::make_pair( aDescriptor.GetTitle(), aDescriptor ) );
+    }
+
+    return true;
+}
+
+
 void SIM_PLOT_FRAME::updateSignalList()
 {
     SIM_PLOT_PANEL* plotPanel = CurrentPlot();
@@ -883,8 +933,9 @@ void SIM_PLOT_FRAME::menuSaveCsv( wxCommandEvent& event )
         {
             out.Write( wxString::Format( "Time%c", SEPARATOR ) );
 
-            for( double v : trace->GetDataX() )
-                out.Write( wxString::Format( "%f%c", v, SEPARATOR ) );
+            // All the points, not only the plotted ones
+            for( size_t i = 0; i < trace->GetPointCount(); ++i )
+                out.Write( wxString::Format( "%f%c", trace->GetX( i ), SEPARATOR ) );
 
             out.Write( "\r\n" );
             timeWritten = true;
@@ -892,8 +943,8 @@ void SIM_PLOT_FRAME::menuSaveCsv( wxCommandEvent& event )
 
         out.Write( wxString::Format( "%s%c", t.first, SEPARATOR ) );
 
-        for( double v : trace->GetDataY() )
-            out.Write( wxString::Format( "%f%c", v, SEPARATOR ) );
+        for( size_t i = 0; i < trace->GetPointCount(); ++i )
+            out.Write( wxString::Format( "%f%c", trace->GetY( i ), SEPARATOR ) );
 
         out.Write( "\r\n" );
     }
@@ -1201,11 +1252,15 @@ void SIM_PLOT_FRAME::onSimStarted( wxCommandEvent& aEvent )
 {
     m_toolBar->SetToolNormalBitmap( ID_SIM_RUN, KiBitmap( sim_stop_xpm ) );
     SetCursor( wxCURSOR_ARROWWAIT );
+
+    m_plotUpdateTimer.Start( 200 );
 }
 
 
 void SIM_PLOT_FRAME::onSimFinished( wxCommandEvent& aEvent )
 {
+    m_plotUpdateTimer.Stop();
+
     m_toolBar->SetToolNormalBitmap( ID_SIM_RUN, KiBitmap( sim_run_xpm ) );
     SetCursor( wxCURSOR_ARROW );
 
@@ -1258,6 +1313,24 @@ void SIM_PLOT_FRAME::onSimFinished( wxCommandEvent& aEvent )
 }
 
 
+void SIM_PLOT_FRAME::onPlotUpdateTimer( wxTimerEvent& aEvent )
+{
+    SIM_TYPE simType = m_exporter->GetSimType();
+    SIM_PLOT_PANEL* plotPanel = CurrentPlot();
+
+    // The traces of the other panels are updated when the simulation finishes
+    if( !plotPanel || plotPanel->GetType() != simType || !SIM_PLOT_PANEL::IsPlottable( simType ) )
+        return;
+
+    for( const auto& trace : m_plots[plotPanel].m_traces )
+        updateStreamedPlot( trace.second, plotPanel );
+
+    // Follow the new points, unless the user is looking at a part of the traces
+    plotPanel->AutoScale();
+    plotPanel->UpdateAll();
+}
+
+
 void SIM_PLOT_FRAME::onSimUpdate( wxCommandEvent& aEvent )
 {
     if( IsSimulationRunning() )
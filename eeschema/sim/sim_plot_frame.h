@@ -41,6 +41,7 @@
 #include <dialogs/dialog_sim_settings.h>
 
 #include <wx/event.h>
+#include <wx/timer.h>
 
 #include <list>
 #include <memory>
@@ -194,6 +195,15 @@ private:
      */
     bool updatePlot( const TRACE_DESC& aDescriptor, SIM_PLOT_PANEL* aPanel );
 
+    /**
+     * @brief Updates a plot with the results streamed by the simulator, which are available
+     * while the simulation runs.
+     * @param aDescriptor contains the plot description.
+     * @param aPanel is the panel that should receive the update.
+     * @return True if the simulator streams the results and the plot was added/updated.
+     */
+    bool updateStreamedPlot( const TRACE_DESC& aDescriptor, SIM_PLOT_PANEL* aPanel );
+
     /**
      * @brief Updates the list of currently plotted signals.
      */
@@ -276,6 +286,9 @@ private:
     void onSimStarted( wxCommandEvent& aEvent );
     void onSimFinished( wxCommandEvent& aEvent );
 
+    ///> Shows the results streamed by the running simulation
+    void onPlotUpdateTimer( wxTimerEvent& aEvent );
+
     // adjust the sash dimension of splitter windows after reading
     // the config settings
     // must be called after the config settings are read, and once the
@@ -337,6 +350,9 @@ private:
             };
     };
 
+    ///> Refreshes the plots while the simulation runs
+    wxTimer m_plotUpdateTimer;
+
     ///> Panel that was used as the most recent one for simulations
     SIM_PLOT_PANEL* m_lastSimPlot;
 
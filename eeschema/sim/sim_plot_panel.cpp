@@ -24,8 +24,11 @@
  */
 
 #include "sim_plot_panel.h"
+#include "sim_results.h"
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include <limits>
 
 static wxString formatFloat( double x, int nDigits )
@@ -270,10 +273,10 @@ void CURSOR::Plot( wxDC& aDC, mpWindow& aWindow )
     if( !m_visible )
         return;
 
-    const auto& dataX = m_trace->GetDataX();
-    const auto& dataY = m_trace->GetDataY();
+    // The cursor uses all the points of the trace, not only the plotted ones
+    const size_t pointCount = m_trace->GetPointCount();
 
-    if( dataX.size() <= 1 )
+    if( pointCount <= 1 )
         return;
 
     if( m_updateRequired )
@@ -281,8 +284,7 @@ void CURSOR::Plot( wxDC& aDC, mpWindow& aWindow )
         m_coords.x = m_trace->s2x( aWindow.p2x( m_dim.x ) );
 
         // Find the closest point coordinates
-        auto maxXIt = std::upper_bound( dataX.begin(), dataX.end(), m_coords.x );
-        int maxIdx = maxXIt - dataX.begin();
+        int maxIdx = m_trace->FindUpperBound( m_coords.x );
         int minIdx = maxIdx - 1;
 
         // Out of bounds checks
@@ -290,19 +292,19 @@ void CURSOR::Plot( wxDC& aDC, mpWindow& aWindow )
         {
             minIdx = 0;
             maxIdx = 1;
-            m_coords.x = dataX[0];
+            m_coords.x = m_trace->GetX( 0 );
         }
-        else if( maxIdx >= (int) dataX.size() )
+        else if( maxIdx >= (int) pointCount )
         {
-            maxIdx = dataX.size() - 1;
+            maxIdx = pointCount - 1;
             minIdx = maxIdx - 1;
-            m_coords.x = dataX[maxIdx];
+            m_coords.x = m_trace->GetX( maxIdx );
         }
 
-        const double leftX = dataX[minIdx];
-        const double rightX = dataX[maxIdx];
-        const double leftY = dataY[minIdx];
-        const double rightY = dataY[maxIdx];
+        const double leftX = m_trace->GetX( minIdx );
+        const double rightX = m_trace->GetX( maxIdx );
+        const double leftY = m_trace->GetY( minIdx );
+        const double rightY = m_trace->GetY( maxIdx );
 
         // Linear interpolation
         m_coords.y = leftY + ( rightY - leftY ) / ( rightX - leftX ) * ( m_coords.x - leftX );
@@ -361,10 +363,365 @@ void CURSOR::UpdateReference()
 }
 
 
+void TRACE::SetData( const std::shared_ptr<SIM_RESULTS>& aResults, int aVectorX, int aVectorY,
+                     SIM_PLOT_TYPE aFlags )
+{
+    if( m_cursor )
+        m_cursor->Update();
+
+    m_xs.clear();
+    m_ys.clear();
+
+    m_results = aResults;
+    m_vectorX = aVectorX;
+    m_vectorY = aVectorY;
+    m_flags = aFlags;
+    m_pointCount = 0;
+    m_blocks.clear();
+
+    // Null scale: does not match any view, so the points are decimated on the next plot
+    m_decimationView = DECIMATION_VIEW();
+
+    m_minX = -1;
+    m_maxX = 1;
+    m_minY = -1;
+    m_maxY = 1;
+
+    UpdateStreamedData();
+}
+
+
+bool TRACE::UpdateStreamedData()
+{
+    if( !m_results )
+        return false;
+
+    const size_t count = m_results->GetPointCount();
+
+    if( count == m_pointCount )
+        return false;
+
+    // Only the new points are needed to update the bounding box
+    for( size_t i = m_pointCount; i < count; ++i )
+    {
+        double x = streamedX( i );
+        double y = streamedY( i );
+
+        if( i == 0 )
+        {
+            m_minX = m_maxX = x;
+            m_minY = m_maxY = y;
+            continue;
+        }
+
+        m_minX = std::min( m_minX, x );
+        m_maxX = std::max( m_maxX, x );
+        m_minY = std::min( m_minY, y );
+        m_maxY = std::max( m_maxY, y );
+    }
+
+    const size_t firstNewPoint = m_pointCount;
+    m_pointCount = count;
+    updateBlocks( firstNewPoint );
+
+    if( m_cursor )
+        m_cursor->Update();
+
+    return true;
+}
+
+
+size_t TRACE::FindUpperBound( double aX ) const
+{
+    size_t first = 0;
+    size_t count = GetPointCount();
+
+    while( count > 0 )
+    {
+        size_t step = count / 2;
+
+        if( GetX( first + step ) <= aX )
+        {
+            first += step + 1;
+            count -= step + 1;
+        }
+        else
+        {
+            count = step;
+        }
+    }
+
+    return first;
+}
+
+
+void TRACE::Plot( wxDC& aDC, mpWindow& aWindow )
+{
+    if( m_results && m_visible )
+        decimate( aWindow );
+
+    mpFXYVector::Plot( aDC, aWindow );
+}
+
+
+double TRACE::streamedX( size_t aPoint ) const
+{
+    return m_results->GetMag( m_vectorX, aPoint );
+}
+
+
+double TRACE::streamedY( size_t aPoint ) const
+{
+    if( m_flags & SPT_AC_PHASE )
+        return m_results->GetPhase( m_vectorY, aPoint ) * 180.0 / M_PI;    // convert to degrees
+
+    if( m_flags & SPT_AC_MAG )
+        return 20 * log10( m_results->GetMag( m_vectorY, aPoint ) );       // convert to dB
+
+    return m_results->GetMag( m_vectorY, aPoint );
+}
+
+
+void TRACE::updateBlocks( size_t aFirstPoint )
+{
+    // Only the blocks holding the new points are updated: the last block of each level
+    // is usually the only one
+    size_t span = 1;                    // count of points of a block of the previous level
+
+    for( size_t level = 0; ; ++level )
+    {
+        const size_t childSpan = span;
+        span *= DECIMATION_BLOCK;
+
+        if( level == m_blocks.size() )
+            m_blocks.emplace_back();
+
+        std::vector<POINT_BLOCK>& blocks = m_blocks[level];
+        const size_t firstBlock = aFirstPoint / span;
+        const size_t blockCount = ( m_pointCount + span - 1 ) / span;
+
+        blocks.resize( blockCount );
+
+        for( size_t b = firstBlock; b < blockCount; ++b )
+        {
+            const size_t first = b * DECIMATION_BLOCK;
+            const size_t last = std::min<size_t>( first + DECIMATION_BLOCK,
+                                                  ( m_pointCount + childSpan - 1 ) / childSpan );
+            POINT_BLOCK block;
+
+            if( level == 0 )
+                block.m_minX = block.m_maxX = block.m_minY = block.m_maxY = first;
+            else
+                block = m_blocks[level - 1][first];
+
+            double minX = GetX( block.m_minX ), maxX = GetX( block.m_maxX );
+            double minY = GetY( block.m_minY ), maxY = GetY( block.m_maxY );
+
+            // Keep the first point having the lowest or highest value, as decimate() does
+            for( size_t c = first + 1; c < last; ++c )
+            {
+                const POINT_BLOCK child = level == 0 ? POINT_BLOCK{ c, c, c, c }
+                                                     : m_blocks[level - 1][c];
+                double x = GetX( child.m_minX );
+
+                if( x < minX )
+                {
+                    minX = x;
+                    block.m_minX = child.m_minX;
+                }
+
+                x = GetX( child.m_maxX );
+
+                if( x > maxX )
+                {
+                    maxX = x;
+                    block.m_maxX = child.m_maxX;
+                }
+
+                double y = GetY( child.m_minY );
+
+                if( y < minY )
+                {
+                    minY = y;
+                    block.m_minY = child.m_minY;
+                }
+
+                y = GetY( child.m_maxY );
+
+                if( y > maxY )
+                {
+                    maxY = y;
+                    block.m_maxY = child.m_maxY;
+                }
+            }
+
+            blocks[b] = block;
+        }
+
+        if( blockCount <= 1 )
+        {
+            m_blocks.resize( level + 1 );
+            break;
+        }
+    }
+}
+
+
+void TRACE::decimate( mpWindow& aWindow )
+{
+    wxCoord startPx = m_drawOutsideMargins ? 0 : aWindow.GetMarginLeft();
+    wxCoord endPx = m_drawOutsideMargins ? aWindow.GetScrX()
+                                         : aWindow.GetScrX() - aWindow.GetMarginRight();
+
+    decimate( aWindow.GetXpos(), aWindow.GetScaleX(), startPx, endPx );
+}
+
+
+void TRACE::decimate( double aPosX, double aScaleX, wxCoord aStartPx, wxCoord aEndPx )
+{
+    DECIMATION_VIEW view;
+    view.m_posX = aPosX;
+    view.m_scaleX = aScaleX;
+    view.m_startPx = aStartPx;
+    view.m_endPx = aEndPx;
+    view.m_pointCount = m_pointCount;
+
+    // The X scale transform depends on the range of the data (e.g. logarithmic scale)
+    view.m_firstX = m_pointCount ? x2s( GetX( 0 ) ) : 0.0;
+    view.m_lastX = m_pointCount ? x2s( GetX( m_pointCount - 1 ) ) : 0.0;
+
+    if( view == m_decimationView )
+        return;
+
+    m_decimationView = view;
+    m_xs.clear();
+    m_ys.clear();
+
+    if( m_pointCount == 0 )
+        return;
+
+    // Pixel column of a point; the points outside of the plot area are gathered in a column
+    // on each side, so the lines entering and leaving the plot area are kept.
+    auto column = [&]( size_t aPoint ) -> wxCoord
+    {
+        double px = ( x2s( GetX( aPoint ) ) - view.m_posX ) * view.m_scaleX;
+
+        if( !( px >= view.m_startPx - 1 ) )
+            return view.m_startPx - 1;
+
+        if( px > view.m_endPx + 1 )
+            return view.m_endPx + 1;
+
+        return (wxCoord) px;
+    };
+
+    // Keep the first, the lowest, the highest and the last point of each column, in their
+    // order: the drawn line looks the same as with all the points.
+    struct COLUMN
+    {
+        wxCoord m_px;
+        size_t  m_first, m_last, m_minIdx, m_maxIdx;
+        double  m_minY, m_maxY;
+    } current = { 0, 0, 0, 0, 0, 0.0, 0.0 };
+
+    bool started = false;
+
+    auto flush = [&]()
+    {
+        const size_t kept[] = { current.m_first,
+                                std::min( current.m_minIdx, current.m_maxIdx ),
+                                std::max( current.m_minIdx, current.m_maxIdx ),
+                                current.m_last };
+
+        for( size_t k = 0; k < 4; ++k )
+        {
+            if( k > 0 && kept[k] == kept[k - 1] )
+                continue;
+
+            m_xs.push_back( GetX( kept[k] ) );
+            m_ys.push_back( GetY( kept[k] ) );
+        }
+    };
+
+    // Adds the points aFirst to aLast, lying in the column aPx and having their lowest
+    // and highest values at aMinIdx and aMaxIdx
+    auto add = [&]( wxCoord aPx, size_t aFirst, size_t aLast, size_t aMinIdx, size_t aMaxIdx )
+    {
+        if( started && aPx == current.m_px )
+        {
+            double y = GetY( aMinIdx );
+
+            if( y < current.m_minY )
+            {
+                current.m_minY = y;
+                current.m_minIdx = aMinIdx;
+            }
+
+            y = GetY( aMaxIdx );
+
+            if( y > current.m_maxY )
+            {
+                current.m_maxY = y;
+                current.m_maxIdx = aMaxIdx;
+            }
+
+            current.m_last = aLast;
+            return;
+        }
+
+        if( started )
+            flush();
+
+        current = { aPx, aFirst, aLast, aMinIdx, aMaxIdx, GetY( aMinIdx ), GetY( aMaxIdx ) };
+        started = true;
+    };
+
+    // The blocks are opened only when their points are not in a single column
+    std::function<void( size_t, size_t, size_t )> addBlock =
+            [&]( size_t aLevel, size_t aBlock, size_t aSpan )
+    {
+        const POINT_BLOCK& block = m_blocks[aLevel][aBlock];
+        const size_t first = aBlock * aSpan;
+        const size_t last = std::min( first + aSpan, m_pointCount ) - 1;
+        const wxCoord px = column( block.m_minX );
+
+        if( px == column( block.m_maxX ) )
+        {
+            add( px, first, last, block.m_minY, block.m_maxY );
+        }
+        else if( aLevel == 0 )
+        {
+            for( size_t i = first; i <= last; ++i )
+                add( column( i ), i, i, i, i );
+        }
+        else
+        {
+            const size_t childSpan = aSpan / DECIMATION_BLOCK;
+            const size_t lastChild = std::min( ( aBlock + 1 ) * DECIMATION_BLOCK,
+                                               m_blocks[aLevel - 1].size() );
+
+            for( size_t c = aBlock * DECIMATION_BLOCK; c < lastChild; ++c )
+                addBlock( aLevel - 1, c, childSpan );
+        }
+    };
+
+    size_t topSpan = 1;
+
+    for( size_t level = 0; level < m_blocks.size(); ++level )
+        topSpan *= DECIMATION_BLOCK;
+
+    for( size_t b = 0; b < m_blocks.back().size(); ++b )
+        addBlock( m_blocks.size() - 1, b, topSpan );
+
+    flush();
+}
+
+
 SIM_PLOT_PANEL::SIM_PLOT_PANEL( SIM_TYPE aType, wxWindow* parent, wxWindowID id, const wxPoint& pos,
                 const wxSize& size, long style, const wxString& name )
     : mpWindow( parent, id, pos, size, style ), m_colorIdx( 0 ),
-        m_axis_x( nullptr ), m_axis_y1( nullptr ), m_axis_y2( nullptr ), m_type( aType )
+        m_axis_x( nullptr ), m_axis_y1( nullptr ), m_axis_y2( nullptr ), m_type( aType ),
+        m_fitXmin( 0.0 ), m_fitXmax( 0.0 ), m_fitYmin( 0.0 ), m_fitYmax( 0.0 )
 {
     LimitView( true );
     SetMargins( 50, 80, 50, 80 );
@@ -460,55 +817,69 @@ bool SIM_PLOT_PANEL::IsPlottable( SIM_TYPE aSimType )
 }
 
 
-bool SIM_PLOT_PANEL::AddTrace( const wxString& aName, int aPoints,
-        const double* aX, const double* aY, SIM_PLOT_TYPE aFlags )
+TRACE* SIM_PLOT_PANEL::getTrace( const wxString& aName, bool& aAddedNewEntry )
 {
-    TRACE* trace = NULL;
-
     // Find previous entry, if there is one
     auto prev = m_traces.find( aName );
-    bool addedNewEntry = ( prev == m_traces.end() );
+    aAddedNewEntry = ( prev == m_traces.end() );
+
+    if( !aAddedNewEntry )
+        return prev->second;
 
-    if( addedNewEntry )
+    if( m_type == ST_TRANSIENT )
     {
-        if( m_type == ST_TRANSIENT )
-        {
-            bool hasVoltageTraces = false;
+        bool hasVoltageTraces = false;
 
-            for( auto tr : m_traces )
+        for( auto tr : m_traces )
+        {
+            if( !( tr.second->GetFlags() & SPT_CURRENT ) )
             {
-                if( !( tr.second->GetFlags() & SPT_CURRENT ) )
-                {
-                    hasVoltageTraces = true;
-                    break;
-                }
+                hasVoltageTraces = true;
+                break;
             }
-
-            if( !hasVoltageTraces )
-                m_axis_y2->SetMasterScale( nullptr );
-            else
-                m_axis_y2->SetMasterScale( m_axis_y1 );
         }
 
-        // New entry
-        trace = new TRACE( aName );
-        trace->SetTraceColour( generateColor() );
-        trace->SetPen( wxPen( trace->GetTraceColour(), 2, wxPENSTYLE_SOLID ) );
-        m_traces[aName] = trace;
+        if( !hasVoltageTraces )
+            m_axis_y2->SetMasterScale( nullptr );
+        else
+            m_axis_y2->SetMasterScale( m_axis_y1 );
+    }
+
+    // New entry
+    TRACE* trace = new TRACE( aName );
+    trace->SetTraceColour( generateColor() );
+    trace->SetPen( wxPen( trace->GetTraceColour(), 2, wxPENSTYLE_SOLID ) );
+    m_traces[aName] = trace;
 
-        // It is a trick to keep legend & coords always on the top
-        for( mpLayer* l : m_topLevel )
-            DelLayer( l );
+    // It is a trick to keep legend & coords always on the top
+    for( mpLayer* l : m_topLevel )
+        DelLayer( l );
 
-        AddLayer( (mpLayer*) trace );
+    AddLayer( (mpLayer*) trace );
 
-        for( mpLayer* l : m_topLevel )
-            AddLayer( l );
-    }
+    for( mpLayer* l : m_topLevel )
+        AddLayer( l );
+
+    return trace;
+}
+
+
+void SIM_PLOT_PANEL::setTraceScale( TRACE* aTrace, SIM_PLOT_TYPE aFlags )
+{
+    if( aFlags & SPT_AC_PHASE || aFlags & SPT_CURRENT )
+        aTrace->SetScale( m_axis_x, m_axis_y2 );
     else
-    {
-        trace = prev->second;
-    }
+        aTrace->SetScale( m_axis_x, m_axis_y1 );
+
+    aTrace->SetFlags( aFlags );
+}
+
+
+bool SIM_PLOT_PANEL::AddTrace( const wxString& aName, int aPoints,
+        const double* aX, const double* aY, SIM_PLOT_TYPE aFlags )
+{
+    bool addedNewEntry;
+    TRACE* trace = getTrace( aName, addedNewEntry );
 
     std::vector<double> tmp( aY, aY + aPoints );
 
@@ -527,13 +898,26 @@ bool SIM_PLOT_PANEL::AddTrace( const wxString& aName, int aPoints,
     }
 
     trace->SetData( std::vector<double>( aX, aX + aPoints ), tmp );
+    setTraceScale( trace, aFlags );
 
-    if( aFlags & SPT_AC_PHASE || aFlags & SPT_CURRENT )
-        trace->SetScale( m_axis_x, m_axis_y2 );
-    else
-        trace->SetScale( m_axis_x, m_axis_y1 );
+    UpdateAll();
+
+    return addedNewEntry;
+}
+
+
+bool SIM_PLOT_PANEL::AddTrace( const wxString& aName, const std::shared_ptr<SIM_RESULTS>& aResults,
+        int aVectorX, int aVectorY, SIM_PLOT_TYPE aFlags )
+{
+    bool addedNewEntry;
+    TRACE* trace = getTrace( aName, addedNewEntry );
 
-    trace->SetFlags( aFlags );
+    // Only the AC traces are converted to dB or degrees, as in the other AddTrace()
+    if( m_type != ST_AC )
+        aFlags = (SIM_PLOT_TYPE) ( aFlags & ~( SPT_AC_PHASE | SPT_AC_MAG ) );
+
+    trace->SetData( aResults, aVectorX, aVectorY, aFlags );
+    setTraceScale( trace, aFlags );
 
     UpdateAll();
 
@@ -626,6 +1010,29 @@ void SIM_PLOT_PANEL::ResetScales()
 }
 
 
+void SIM_PLOT_PANEL::Fit()
+{
+    mpWindow::Fit();
+
+    m_fitXmin = GetDesiredXmin();
+    m_fitXmax = GetDesiredXmax();
+    m_fitYmin = GetDesiredYmin();
+    m_fitYmax = GetDesiredYmax();
+}
+
+
+void SIM_PLOT_PANEL::AutoScale()
+{
+    // Zooming and panning change the desired view, resizing the window does not
+    if( GetDesiredXmin() != m_fitXmin || GetDesiredXmax() != m_fitXmax
+            || GetDesiredYmin() != m_fitYmin || GetDesiredYmax() != m_fitYmax )
+        return;
+
+    ResetScales();
+    Fit();
+}
+
+
 wxColour SIM_PLOT_PANEL::generateColor()
 {
     /// @todo have a look at:
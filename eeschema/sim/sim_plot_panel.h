@@ -29,9 +29,11 @@
 
 #include <widgets/mathplot.h>
 #include <map>
+#include <memory>
 #include "sim_types.h"
 
 class TRACE;
+class SIM_RESULTS;
 
 ///> Cursor attached to a trace to follow its values:
 class CURSOR : public mpInfoLayer
@@ -88,7 +90,8 @@ class TRACE : public mpFXYVector
 {
 public:
     TRACE( const wxString& aName ) :
-        mpFXYVector( aName ), m_cursor( nullptr ), m_flags( 0 )
+        mpFXYVector( aName ), m_cursor( nullptr ), m_flags( 0 ),
+        m_vectorX( -1 ), m_vectorY( -1 ), m_pointCount( 0 ), m_decimationView()
     {
         SetContinuity( true );
         SetDrawOutsideMargins( false );
@@ -105,19 +108,55 @@ public:
         if( m_cursor )
             m_cursor->Update();
 
+        m_results.reset();
         mpFXYVector::SetData( aX, aY );
     }
 
-    const std::vector<double>& GetDataX() const
+    /**
+     * @brief Assigns simulation results streamed by the simulator to the trace. The points
+     * are not copied: the trace draws the points available when it is plotted, reduced to
+     * the minimum and maximum values of each pixel column.
+     * @param aResults are the results of a simulation run.
+     * @param aVectorX is the index of the X axis vector in aResults.
+     * @param aVectorY is the index of the Y axis vector in aResults.
+     * @param aFlags tells how to convert the Y values (AC magnitude in dB, AC phase in degrees).
+     */
+    void SetData( const std::shared_ptr<SIM_RESULTS>& aResults, int aVectorX, int aVectorY,
+                  SIM_PLOT_TYPE aFlags );
+
+    /**
+     * @brief Takes into account the points streamed since the last call.
+     * @return True if there are new points.
+     */
+    bool UpdateStreamedData();
+
+    ///> Returns the streamed results shown by the trace, NULL if the trace has its own data
+    const std::shared_ptr<SIM_RESULTS>& GetResults() const
     {
-        return m_xs;
+        return m_results;
     }
 
-    const std::vector<double>& GetDataY() const
+    ///> Returns the count of points of the trace (all of them, not only the plotted ones)
+    size_t GetPointCount() const
     {
-        return m_ys;
+        return m_results ? m_pointCount : m_xs.size();
     }
 
+    double GetX( size_t aPoint ) const
+    {
+        return m_results ? streamedX( aPoint ) : m_xs[aPoint];
+    }
+
+    double GetY( size_t aPoint ) const
+    {
+        return m_results ? streamedY( aPoint ) : m_ys[aPoint];
+    }
+
+    ///> Returns the index of the first point whose X value is greater than aX
+    size_t FindUpperBound( double aX ) const;
+
+    void Plot( wxDC& aDC, mpWindow& aWindow ) override;
+
     bool HasCursor() const
     {
         return m_cursor != nullptr;
@@ -154,9 +193,64 @@ public:
     }
 
 protected:
+    double streamedX( size_t aPoint ) const;
+    double streamedY( size_t aPoint ) const;
+
+    ///> Fills the plotted points with the streamed points, decimated for the current view
+    void decimate( mpWindow& aWindow );
+
+    /**
+     * @brief Fills the plotted points with the streamed points, decimated for a view.
+     * @param aPosX and aScaleX give the pixel column of a point (see mpWindow::x2p()).
+     * @param aStartPx and aEndPx are the first and last pixel columns of the plot area.
+     */
+    void decimate( double aPosX, double aScaleX, wxCoord aStartPx, wxCoord aEndPx );
+
+    ///> Updates the blocks of the streamed points from aFirstPoint to the last one
+    void updateBlocks( size_t aFirstPoint );
+
     CURSOR* m_cursor;
     int m_flags;
     wxColour m_traceColour;
+
+    ///> Streamed simulation results shown by the trace (optional)
+    std::shared_ptr<SIM_RESULTS> m_results;
+    int m_vectorX, m_vectorY;
+
+    ///> Count of streamed points taken into account in the bounding box
+    size_t m_pointCount;
+
+    ///> Points of a block of consecutive streamed points having the lowest and highest
+    ///> X and Y values (the first ones if several points have the same value)
+    struct POINT_BLOCK
+    {
+        size_t  m_minX, m_maxX;
+        size_t  m_minY, m_maxY;
+    };
+
+    ///> Blocks of DECIMATION_BLOCK streamed points (first level), then of DECIMATION_BLOCK
+    ///> blocks of the previous level, up to a single block.  The blocks lying in a single
+    ///> pixel column are decimated without reading their points.
+    std::vector<std::vector<POINT_BLOCK>> m_blocks;
+
+    static constexpr size_t DECIMATION_BLOCK = 16;
+
+    ///> View for which the plotted points were decimated
+    struct DECIMATION_VIEW
+    {
+        double  m_posX, m_scaleX;
+        double  m_firstX, m_lastX;
+        wxCoord m_startPx, m_endPx;
+        size_t  m_pointCount;
+
+        bool operator==( const DECIMATION_VIEW& aOther ) const
+        {
+            return m_posX == aOther.m_posX && m_scaleX == aOther.m_scaleX
+                    && m_firstX == aOther.m_firstX && m_lastX == aOther.m_lastX
+                    && m_startPx == aOther.m_startPx && m_endPx == aOther.m_endPx
+                    && m_pointCount == aOther.m_pointCount;
+        }
+    } m_decimationView;
 };
 
 
@@ -193,6 +287,13 @@ public:
     bool AddTrace( const wxString& aName, int aPoints,
             const double* aX, const double* aY, SIM_PLOT_TYPE aFlags );
 
+    /**
+     * @brief Adds or updates a trace showing streamed simulation results.
+     * @return True if a new trace was added.
+     */
+    bool AddTrace( const wxString& aName, const std::shared_ptr<SIM_RESULTS>& aResults,
+            int aVectorX, int aVectorY, SIM_PLOT_TYPE aFlags );
+
     bool DeleteTrace( const wxString& aName );
 
     void DeleteAllTraces();
@@ -251,7 +352,22 @@ public:
     ///> Resets scale ranges to fit the current traces
     void ResetScales();
 
+    ///> Fits the view to the traces
+    void Fit() override;
+
+    using mpWindow::Fit;
+
+    ///> Resets the scales and fits the view to the traces, unless the view was zoomed
+    ///> or moved since the last fit
+    void AutoScale();
+
 private:
+    ///> Returns the trace named aName, created if it does not exist
+    TRACE* getTrace( const wxString& aName, bool& aAddedNewEntry );
+
+    ///> Assigns the axes of a trace according to its type
+    void setTraceScale( TRACE* aTrace, SIM_PLOT_TYPE aFlags );
+
     ///> Returns a new color from the palette
     wxColour generateColor();
 
@@ -269,6 +385,9 @@ private:
     std::vector<mpLayer*> m_topLevel;
 
     const SIM_TYPE m_type;
+
+    // View set by the last Fit(), to know if the user has zoomed since
+    double m_fitXmin, m_fitXmax, m_fitYmin, m_fitYmax;
 };
 
 wxDECLARE_EVENT( EVT_SIM_CURSOR_UPDATE, wxCommandEvent );
@@ -0,0 +1,320 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * https://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include "sim_results.h"
+
+#include <wx/filename.h>
+#include <wx/log.h>
+
+#ifdef __WINDOWS__
+#include <wx/msw/wrapwin.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <new>
+
+static const wxChar* const traceSimResults = wxT( "KICAD_SIM_RESULTS" );
+
+
+/**
+ * @brief Temporary file holding the chunks of points which do not fit in the memory budget.
+ *
+ * Each chunk is a separate mapping of the file, so the chunks handed out stay valid when the
+ * file grows.  The file is deleted when it is closed.
+ */
+class SIM_SPILL_FILE
+{
+public:
+    SIM_SPILL_FILE();
+    ~SIM_SPILL_FILE();
+
+    bool IsOpened() const;
+
+    /**
+     * @brief Grows the file and maps the new part.
+     * @param aBytes is the size of the chunk, a multiple of the mapping granularity.
+     * @return the mapped chunk, or NULL in case of error.
+     */
+    void* MapChunk( size_t aBytes );
+
+private:
+#ifdef __WINDOWS__
+    HANDLE m_file;
+    std::vector<HANDLE> m_mappings;
+#else
+    int m_file;
+    std::vector<size_t> m_sizes;
+#endif
+    std::vector<void*> m_views;
+    unsigned long long m_fileSize;
+};
+
+
+SIM_SPILL_FILE::SIM_SPILL_FILE() :
+    m_fileSize( 0 )
+{
+    wxString path = wxFileName::CreateTempFileName( "kicad-sim" );
+
+#ifdef __WINDOWS__
+    m_file = CreateFileW( path.wc_str(), GENERIC_READ | GENERIC_WRITE, 0, NULL, CREATE_ALWAYS,
+                          FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, NULL );
+#else
+    m_file = open( path.fn_str(), O_RDWR );
+
+    // The file is removed now, and freed when it is closed
+    if( !path.IsEmpty() )
+        wxRemoveFile( path );
+#endif
+
+    if( !IsOpened() )
+        wxLogTrace( traceSimResults, "Cannot create the spill file %s", path );
+}
+
+
+SIM_SPILL_FILE::~SIM_SPILL_FILE()
+{
+#ifdef __WINDOWS__
+    for( void* view : m_views )
+        UnmapViewOfFile( view );
+
+    for( HANDLE mapping : m_mappings )
+        CloseHandle( mapping );
+
+    if( IsOpened() )
+        CloseHandle( m_file );
+#else
+    for( size_t i = 0; i < m_views.size(); ++i )
+        munmap( m_views[i], m_sizes[i] );
+
+    if( IsOpened() )
+        close( m_file );
+#endif
+}
+
+
+bool SIM_SPILL_FILE::IsOpened() const
+{
+#ifdef __WINDOWS__
+    return m_file != INVALID_HANDLE_VALUE;
+#else
+    return m_file >= 0;
+#endif
+}
+
+
+void* SIM_SPILL_FILE::MapChunk( size_t aBytes )
+{
+    if( !IsOpened() )
+        return nullptr;
+
+    unsigned long long offset = m_fileSize;
+    unsigned long long size = m_fileSize + aBytes;
+
+#ifdef __WINDOWS__
+    // Creating a mapping larger than the file grows the file
+    HANDLE mapping = CreateFileMappingW( m_file, NULL, PAGE_READWRITE, (DWORD)( size >> 32 ),
+                                         (DWORD)( size & 0xFFFFFFFF ), NULL );
+
+    if( !mapping )
+        return nullptr;
+
+    void* view = MapViewOfFile( mapping, FILE_MAP_WRITE, (DWORD)( offset >> 32 ),
+                                (DWORD)( offset & 0xFFFFFFFF ), aBytes );
+
+    if( !view )
+    {
+        CloseHandle( mapping );
+        return nullptr;
+    }
+
+    m_mappings.push_back( mapping );
+#else
+    if( ftruncate( m_file, (off_t) size ) != 0 )
+        return nullptr;
+
+    void* view = mmap( NULL, aBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_file, (off_t) offset );
+
+    if( view == MAP_FAILED )
+        return nullptr;
+
+    m_sizes.push_back( aBytes );
+#endif
+
+    m_views.push_back( view );
+    m_fileSize = size;
+
+    return view;
+}
+
+
+/**
+ * @brief Returns the name of a vector to be compared: lower case, and without V() around the
+ * node names.
+ */
+static std::string normalizeVectorName( const std::string& aName )
+{
+    std::string name( aName );
+
+    std::transform( name.begin(), name.end(), name.begin(),
+                    []( unsigned char c ) { return (char) std::tolower( c ); } );
+
+    if( name.size() > 3 && name.compare( 0, 2, "v(" ) == 0 && name.back() == ')' )
+        name = name.substr( 2, name.size() - 3 );
+
+    return name;
+}
+
+
+SIM_RESULTS::SIM_RESULTS( const std::vector<std::string>& aNames,
+                          const std::vector<bool>& aComplex ) :
+    m_names( aNames ),
+    m_complex( aComplex ),
+    m_width( 0 ),
+    m_chunks( new std::atomic<double*>[MAX_CHUNKS] ),
+    m_chunkCount( 0 ),
+    m_pointCount( 0 )
+{
+    for( bool isComplex : m_complex )
+    {
+        m_offsets.push_back( m_width );
+        m_width += isComplex ? 2 : 1;
+    }
+
+    size_t chunkBytes = POINTS_PER_CHUNK * std::max( m_width, 1 ) * sizeof( double );
+    m_memoryChunkCount = std::max<size_t>( MEMORY_BUDGET / chunkBytes, 1 );
+
+    for( size_t i = 0; i < MAX_CHUNKS; ++i )
+        m_chunks[i].store( nullptr, std::memory_order_relaxed );
+}
+
+
+SIM_RESULTS::~SIM_RESULTS()
+{
+}
+
+
+int SIM_RESULTS::FindVector( const std::string& aName ) const
+{
+    std::string name = normalizeVectorName( aName );
+
+    for( size_t i = 0; i < m_names.size(); ++i )
+    {
+        if( normalizeVectorName( m_names[i] ) == name )
+            return (int) i;
+    }
+
+    return -1;
+}
+
+
+double SIM_RESULTS::GetMag( int aVector, size_t aPoint ) const
+{
+    const double* value = point( aPoint ) + m_offsets[aVector];
+
+    if( m_complex[aVector] )
+        return hypot( value[0], value[1] );
+
+    return value[0];
+}
+
+
+double SIM_RESULTS::GetPhase( int aVector, size_t aPoint ) const
+{
+    const double* value = point( aPoint ) + m_offsets[aVector];
+
+    if( m_complex[aVector] )
+        return atan2( value[1], value[0] );
+
+    return 0.0;      // well, that's life
+}
+
+
+double* SIM_RESULTS::allocChunk()
+{
+    size_t chunkValues = POINTS_PER_CHUNK * m_width;
+
+    if( m_chunkCount < m_memoryChunkCount )
+    {
+        double* chunk = new (std::nothrow) double[chunkValues];
+
+        if( chunk )
+            m_memoryChunks.emplace_back( chunk );
+
+        return chunk;
+    }
+
+    if( !m_spillFile )
+        m_spillFile.reset( new SIM_SPILL_FILE );
+
+    // Fall back to the memory if the file cannot be used
+    double* chunk = (double*) m_spillFile->MapChunk( chunkValues * sizeof( double ) );
+
+    if( !chunk )
+    {
+        chunk = new (std::nothrow) double[chunkValues];
+
+        if( chunk )
+            m_memoryChunks.emplace_back( chunk );
+    }
+
+    return chunk;
+}
+
+
+bool SIM_RESULTS::AppendPoint( const double* aValues )
+{
+    // Only the simulator thread modifies the count
+    size_t count = m_pointCount.load( std::memory_order_relaxed );
+    size_t chunkIdx = count / POINTS_PER_CHUNK;
+
+    if( m_width == 0 || chunkIdx >= MAX_CHUNKS )
+        return false;
+
+    if( chunkIdx == m_chunkCount )
+    {
+        double* chunk = allocChunk();
+
+        if( !chunk )
+            return false;
+
+        m_chunks[chunkIdx].store( chunk, std::memory_order_relaxed );
+        m_chunkCount++;
+    }
+
+    double* dest = m_chunks[chunkIdx].load( std::memory_order_relaxed )
+                   + ( count % POINTS_PER_CHUNK ) * m_width;
+
+    memcpy( dest, aValues, m_width * sizeof( double ) );
+
+    // Publishes the values (and the chunk) to the GUI thread
+    m_pointCount.store( count + 1, std::memory_order_release );
+
+    return true;
+}
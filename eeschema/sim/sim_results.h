@@ -0,0 +1,138 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * https://www.gnu.org/licenses/gpl-3.0.html
+ * or you may search the http://www.gnu.org website for the version 3 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef SIM_RESULTS_H
+#define SIM_RESULTS_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+class SIM_SPILL_FILE;
+
+/**
+ * @brief Vectors of one simulation run, streamed from the simulator thread while the
+ * simulation runs.
+ *
+ * The simulator thread appends the values of all the vectors at each simulation point, and
+ * the GUI thread reads the points appended so far without locking: the points are stored in
+ * chunks which are never moved nor freed before the results are destroyed.  The first chunks
+ * are allocated in memory, the next ones are mapped from a temporary file, so a very long run
+ * does not use all the memory.
+ */
+class SIM_RESULTS
+{
+public:
+    /**
+     * @param aNames are the names of the vectors, in the order of the values of the points.
+     * @param aComplex tells for each vector if its values are complex.
+     */
+    SIM_RESULTS( const std::vector<std::string>& aNames, const std::vector<bool>& aComplex );
+    ~SIM_RESULTS();
+
+    /**
+     * @brief Returns the index of a vector, or -1 if there is no such vector.
+     * @param aName is the vector named in Spice convention (e.g. V(3), I(R1)); the case is
+     * ignored, and the node voltages may be named with or without V().
+     */
+    int FindVector( const std::string& aName ) const;
+
+    ///> Returns the count of vectors of the simulation
+    int GetVectorCount() const
+    {
+        return (int) m_names.size();
+    }
+
+    bool IsComplex( int aVector ) const
+    {
+        return m_complex[aVector];
+    }
+
+    ///> Returns the count of points available to the GUI thread
+    size_t GetPointCount() const
+    {
+        return m_pointCount.load( std::memory_order_acquire );
+    }
+
+    /**
+     * @brief Returns the magnitude of a value, as SPICE_SIMULATOR::GetMagPlot(): the value
+     * itself for the real vectors.
+     */
+    double GetMag( int aVector, size_t aPoint ) const;
+
+    /**
+     * @brief Returns the phase of a value, as SPICE_SIMULATOR::GetPhasePlot(): 0 for the
+     * real vectors.
+     */
+    double GetPhase( int aVector, size_t aPoint ) const;
+
+    /**
+     * @brief Appends a simulation point.  To be called from the simulator thread only.
+     * @param aValues are the values of all the vectors, the real and imaginary parts of the
+     * complex vectors following each other.
+     * @return false if the point could not be stored (out of memory and disk space).
+     */
+    bool AppendPoint( const double* aValues );
+
+    ///> Returns the count of values of a point
+    int GetPointWidth() const
+    {
+        return m_width;
+    }
+
+private:
+    ///> Returns the values of a point appended before
+    const double* point( size_t aPoint ) const
+    {
+        const double* chunk = m_chunks[aPoint / POINTS_PER_CHUNK].load( std::memory_order_relaxed );
+
+        return chunk + ( aPoint % POINTS_PER_CHUNK ) * m_width;
+    }
+
+    ///> Allocates the next chunk of points, in memory or in the spill file
+    double* allocChunk();
+
+    static constexpr size_t POINTS_PER_CHUNK = 65536;
+    static constexpr size_t MAX_CHUNKS = 65536;
+
+    ///> Size of the chunks kept in memory, the next ones are spilled to a file
+    static constexpr size_t MEMORY_BUDGET = 256 * 1024 * 1024;
+
+    std::vector<std::string> m_names;
+    std::vector<bool> m_complex;
+
+    ///> Offset of the first value of each vector in a point
+    std::vector<int> m_offsets;
+    int m_width;
+
+    std::unique_ptr<std::atomic<double*>[]> m_chunks;
+    size_t m_chunkCount;
+    size_t m_memoryChunkCount;
+    std::vector<std::unique_ptr<double[]>> m_memoryChunks;
+    std::unique_ptr<SIM_SPILL_FILE> m_spillFile;
+
+    std::atomic<size_t> m_pointCount;
+};
+
+#endif /* SIM_RESULTS_H */
@@ -34,6 +34,7 @@
 
 class SPICE_REPORTER;
 class SPICE_SIMULATOR;
+class SIM_RESULTS;
 
 typedef std::complex<double> COMPLEX;
 
@@ -136,6 +137,17 @@ public:
      */
     virtual std::vector<double> GetPhasePlot( const std::string& aName, int aMaxLen = -1 ) = 0;
 
+    /**
+     * @brief Returns the vectors of the current (or last) simulation run, which are
+     * streamed by the simulator while it runs.
+     * @return The results. It might be NULL if no simulation has been run, or if the
+     * simulator does not stream its results.
+     */
+    virtual std::shared_ptr<SIM_RESULTS> GetResults() const
+    {
+        return nullptr;
+    }
+
     /**
      * @brief Returns current SPICE netlist used by the simulator.
      * @return The netlist.
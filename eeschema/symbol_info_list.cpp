@@ -0,0 +1,336 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file symbol_info_list.cpp
+ */
+
+#include <wx/filename.h>
+#include <wx/hash.h>
+#include <wx/textfile.h>
+
+#include <common.h>
+#include <project.h>
+#include <class_libentry.h>
+#include <class_library.h>
+#include <symbol_lib_table.h>
+#include <parallel_tasks.h>
+#include <widgets/progress_reporter.h>
+
+#include <symbol_info_list.h>
+
+#include <algorithm>
+
+
+SYMBOL_INFO::SYMBOL_INFO( const wxString& aNickname, LIB_ALIAS* aAlias ) :
+    m_nickname( aNickname ),
+    m_name( aAlias->GetName() ),
+    m_description( aAlias->GetDescription() ),
+    m_keywords( aAlias->GetKeyWords() ),
+    m_isRoot( aAlias->IsRoot() ),
+    m_isPower( false ),
+    m_unitCount( aAlias->GetUnitCount() )
+{
+    LIB_PART* part = aAlias->GetPart();
+
+    if( part )
+    {
+        m_footprint = part->GetFootprintField().GetText();
+        m_isPower = part->IsPower();
+    }
+}
+
+
+wxString SYMBOL_INFO::GetSearchText()
+{
+    // Matches are scored by offset from front of string, so inclusion of this spacer
+    // discounts matches found after it.
+    static const wxString discount( wxT( "        " ) );
+
+    wxString text = m_keywords + discount + m_description;
+
+    if( !m_footprint.IsEmpty() )
+        text += discount + m_footprint;
+
+    return text;
+}
+
+
+wxString SYMBOL_INFO::GetUnitReference( int aUnit )
+{
+    return LIB_PART::SubReference( aUnit, false );
+}
+
+
+SYMBOL_INFO_LIST& SYMBOL_INFO_LIST::GetInstance( PROJECT& aProject )
+{
+    static SYMBOL_INFO_LIST symbolInfoList;
+
+    wxString cacheFileName = aProject.GetProjectPath() + "sym-info-cache";
+
+    if( symbolInfoList.m_cacheFileName != cacheFileName )
+    {
+        wxTextFile symbolInfoCache( cacheFileName );
+        symbolInfoList.ReadCacheFromFile( &symbolInfoCache );
+        symbolInfoList.m_cacheFileName = cacheFileName;
+    }
+
+    return symbolInfoList;
+}
+
+
+long long SYMBOL_INFO_LIST::libTimestamp( SYMBOL_LIB_TABLE* aTable, const wxString& aNickname )
+{
+    wxFileName fn;
+
+    try
+    {
+        // Also instantiates the plugin of the row, which cannot be done by the workers
+        fn = aTable->FindRow( aNickname )->GetFullURI( true );
+    }
+    catch( const IO_ERROR& )
+    {
+        return 0;
+    }
+
+    long long timestamp = wxHashTable::MakeKey( fn.GetFullPath() );
+
+    if( fn.FileExists() )
+        timestamp += fn.GetModificationTime().GetValue().GetValue();
+
+    fn.SetExt( DOC_EXT );
+
+    if( fn.FileExists() )
+        timestamp += fn.GetModificationTime().GetValue().GetValue();
+
+    return timestamp;
+}
+
+
+std::vector<wxString> SYMBOL_INFO_LIST::GetChangedLibs( SYMBOL_LIB_TABLE* aTable,
+                                                        const std::vector<wxString>& aNicknames )
+{
+    std::vector<wxString> changedLibs;
+
+    for( const wxString& nickname : aNicknames )
+    {
+        auto it = m_libraries.find( nickname );
+
+        if( it == m_libraries.end() || it->second.m_timestamp != libTimestamp( aTable, nickname ) )
+            changedLibs.push_back( nickname );
+    }
+
+    return changedLibs;
+}
+
+
+bool SYMBOL_INFO_LIST::ReadSymbolLibs( SYMBOL_LIB_TABLE* aTable,
+                                       const std::vector<wxString>& aNicknames,
+                                       PROGRESS_REPORTER* aProgressReporter,
+                                       const LIBRARY_HANDLER& aOnLibraryRead )
+{
+    m_errors.clear();
+
+    // The timestamps are taken before reading, so a library changed while it is read is
+    // read again next time.
+    std::vector<LIBRARY> libraries( aNicknames.size() );
+
+    for( size_t ii = 0; ii < aNicknames.size(); ++ii )
+        libraries[ii].m_timestamp = libTimestamp( aTable, aNicknames[ii] );
+
+    if( aProgressReporter )
+    {
+        aProgressReporter->SetMaxProgress( aNicknames.size() );
+        aProgressReporter->Report( _( "Loading Symbol Libraries" ) );
+    }
+
+    SYNC_QUEUE<size_t> queue_read;
+
+    // Read the libraries in parallel, with the C locale.  The main (GUI) thread only
+    // refreshes the progress reporter and hands over the libraries while they are read.
+    PARALLEL_TASKS tasks( aNicknames.size(), [&]( size_t libIdx )
+    {
+        const wxString&         nickname = aNicknames[libIdx];
+        std::vector<LIB_ALIAS*> aliases;
+
+        try
+        {
+            aTable->LoadSymbolLib( aliases, nickname );
+
+            for( LIB_ALIAS* alias : aliases )
+            {
+                libraries[libIdx].m_symbols.push_back(
+                        std::unique_ptr<SYMBOL_INFO>( new SYMBOL_INFO( nickname, alias ) ) );
+            }
+
+            queue_read.push( libIdx );
+        }
+        catch( const IO_ERROR& ioe )
+        {
+            m_errors.push( wxString::Format( _( "Error loading symbol library %s.\n\n%s" ),
+                                             nickname, ioe.What() ) );
+        }
+        catch( const std::exception& se )
+        {
+            m_errors.push( wxString::Format( _( "Error loading symbol library %s.\n\n%s" ),
+                                             nickname, se.what() ) );
+        }
+
+        if( aProgressReporter )
+            aProgressReporter->AdvanceProgress();
+    }, true );
+
+    // Hand over the libraries as they are read
+    auto handOver = [&]()
+    {
+        size_t libIdx;
+
+        while( queue_read.pop( libIdx ) )
+        {
+            LIBRARY& library = m_libraries[ aNicknames[libIdx] ];
+
+            library = std::move( libraries[libIdx] );
+            aOnLibraryRead( aNicknames[libIdx], library.m_symbols );
+        }
+    };
+
+    while( !tasks.IsDone() )
+    {
+        handOver();
+
+        if( aProgressReporter && !aProgressReporter->KeepRefreshing() )
+            tasks.Cancel();
+
+        wxMilliSleep( 20 );
+    }
+
+    tasks.Wait();
+
+    handOver();
+
+    return m_errors.empty();
+}
+
+
+const SYMBOL_INFO_LIST::SYMBOLS* SYMBOL_INFO_LIST::GetSymbols( const wxString& aNickname ) const
+{
+    auto it = m_libraries.find( aNickname );
+
+    if( it == m_libraries.end() )
+        return NULL;
+
+    return &it->second.m_symbols;
+}
+
+
+void SYMBOL_INFO_LIST::WriteCacheToFile( wxTextFile* aCacheFile )
+{
+    if( aCacheFile->Exists() )
+    {
+        aCacheFile->Open();
+        aCacheFile->Clear();
+    }
+    else
+    {
+        aCacheFile->Create();
+    }
+
+    for( auto& library : m_libraries )
+    {
+        aCacheFile->AddLine( library.first );
+        aCacheFile->AddLine( wxString::Format( "%lld", library.second.m_timestamp ) );
+        aCacheFile->AddLine( wxString::Format( "%u",
+                                               (unsigned) library.second.m_symbols.size() ) );
+
+        for( auto& symbol : library.second.m_symbols )
+        {
+            aCacheFile->AddLine( symbol->GetName() );
+            aCacheFile->AddLine( symbol->GetDescription() );
+            aCacheFile->AddLine( symbol->GetKeywords() );
+            aCacheFile->AddLine( symbol->GetFootprint() );
+            aCacheFile->AddLine( symbol->IsRoot() ? "1" : "0" );
+            aCacheFile->AddLine( symbol->IsPower() ? "1" : "0" );
+            aCacheFile->AddLine( wxString::Format( "%d", symbol->GetUnitCount() ) );
+        }
+    }
+
+    aCacheFile->Write();
+    aCacheFile->Close();
+}
+
+
+void SYMBOL_INFO_LIST::ReadCacheFromFile( wxTextFile* aCacheFile )
+{
+    m_libraries.clear();
+
+    try
+    {
+        if( aCacheFile->Exists() )
+            aCacheFile->Open();
+        else
+            return;
+
+        // A library whose lines are missing (truncated file) is not added, and so read
+        // again from its file.
+        size_t lineCount = aCacheFile->GetLineCount();
+        size_t line = 0;
+
+        while( line + 3 <= lineCount )
+        {
+            wxString      nickname = aCacheFile->GetLine( line++ );
+            LIBRARY       library;
+            unsigned long count = 0;
+
+            aCacheFile->GetLine( line++ ).ToLongLong( &library.m_timestamp );
+            aCacheFile->GetLine( line++ ).ToULong( &count );
+
+            if( line + 7 * count > lineCount )
+                break;
+
+            for( unsigned long ii = 0; ii < count; ++ii )
+            {
+                wxString name = aCacheFile->GetLine( line++ );
+                wxString description = aCacheFile->GetLine( line++ );
+                wxString keywords = aCacheFile->GetLine( line++ );
+                wxString footprint = aCacheFile->GetLine( line++ );
+                bool     isRoot = wxAtoi( aCacheFile->GetLine( line++ ) ) != 0;
+                bool     isPower = wxAtoi( aCacheFile->GetLine( line++ ) ) != 0;
+                int      unitCount = wxAtoi( aCacheFile->GetLine( line++ ) );
+
+                library.m_symbols.push_back( std::unique_ptr<SYMBOL_INFO>(
+                        new SYMBOL_INFO( nickname, name, description, keywords, footprint,
+                                         isRoot, isPower, unitCount ) ) );
+            }
+
+            m_libraries[nickname] = std::move( library );
+        }
+    }
+    catch( ... )
+    {
+        // whatever went wrong, invalidate the cache
+        m_libraries.clear();
+    }
+
+    if( aCacheFile->IsOpened() )
+        aCacheFile->Close();
+}
@@ -0,0 +1,196 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file symbol_info_list.h
+ */
+
+#ifndef SYMBOL_INFO_LIST_H
+#define SYMBOL_INFO_LIST_H
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <lib_tree_item.h>
+#include <sync_queue.h>
+
+class wxTextFile;
+class LIB_ALIAS;
+class PROJECT;
+class PROGRESS_REPORTER;
+class SYMBOL_LIB_TABLE;
+
+
+/**
+ * Class SYMBOL_INFO
+ * is what the symbol chooser shows of a library symbol (or alias): its name and its
+ * search text.  It is read from the library, or from the symbol info cache file, so the
+ * chooser can be filled without loading the libraries.
+ */
+class SYMBOL_INFO : public LIB_TREE_ITEM
+{
+public:
+    SYMBOL_INFO( const wxString& aNickname, LIB_ALIAS* aAlias );
+
+    SYMBOL_INFO( const wxString& aNickname, const wxString& aName,
+                 const wxString& aDescription, const wxString& aKeywords,
+                 const wxString& aFootprint, bool aIsRoot, bool aIsPower, int aUnitCount ) :
+        m_nickname( aNickname ),
+        m_name( aName ),
+        m_description( aDescription ),
+        m_keywords( aKeywords ),
+        m_footprint( aFootprint ),
+        m_isRoot( aIsRoot ),
+        m_isPower( aIsPower ),
+        m_unitCount( aUnitCount )
+    {}
+
+    LIB_ID GetLibId() const override { return LIB_ID( m_nickname, m_name ); }
+
+    const wxString& GetName() const override { return m_name; }
+
+    wxString GetLibNickname() const override { return m_nickname; }
+
+    const wxString& GetDescription() override { return m_description; }
+
+    const wxString& GetKeywords() const { return m_keywords; }
+
+    /// The footprint field of the symbol
+    const wxString& GetFootprint() const { return m_footprint; }
+
+    /**
+     * Same text as LIB_ALIAS::GetSearchText(), so the matches are scored the same way.
+     */
+    wxString GetSearchText() override;
+
+    bool IsRoot() const override { return m_isRoot; }
+
+    bool IsPower() const { return m_isPower; }
+
+    int GetUnitCount() override { return m_unitCount; }
+
+    wxString GetUnitReference( int aUnit ) override;
+
+private:
+    wxString m_nickname;
+    wxString m_name;
+    wxString m_description;
+    wxString m_keywords;
+    wxString m_footprint;
+    bool     m_isRoot;
+    bool     m_isPower;
+    int      m_unitCount;
+};
+
+
+/**
+ * Class SYMBOL_INFO_LIST
+ * holds the SYMBOL_INFO of the symbol libraries, library by library.  A library is read
+ * again only if its file or its documentation file changed since it was read.
+ *
+ * The libraries are read by worker threads, in the same way as the footprint libraries
+ * (see FOOTPRINT_LIST_IMPL), and the list is kept between the symbol chooser openings
+ * and in the "sym-info-cache" file of the project.
+ */
+class SYMBOL_INFO_LIST
+{
+public:
+    typedef std::vector<std::unique_ptr<SYMBOL_INFO>> SYMBOLS;
+
+    /**
+     * Called on the thread calling ReadSymbolLibs() when a library was read.
+     */
+    typedef std::function<void( const wxString& aNickname, const SYMBOLS& aSymbols )>
+            LIBRARY_HANDLER;
+
+    /**
+     * @return the list of the symbol libraries, after reading the symbol info cache file of
+     * aProject if the list was not read for this project
+     */
+    static SYMBOL_INFO_LIST& GetInstance( PROJECT& aProject );
+
+    /**
+     * @return the nicknames of aNicknames which must be read: the libraries not read yet,
+     * or whose file changed since they were read
+     */
+    std::vector<wxString> GetChangedLibs( SYMBOL_LIB_TABLE* aTable,
+                                          const std::vector<wxString>& aNicknames );
+
+    /**
+     * Function ReadSymbolLibs
+     * reads the libraries aNicknames on worker threads.  aOnLibraryRead is called for
+     * each library as soon as it is read, in the order they finish, so the libraries can
+     * be shown before all of them are read.  The libraries read before a cancellation
+     * of the progress reporter are kept.
+     *
+     * @return true if all the libraries were read without error (see PopError())
+     */
+    bool ReadSymbolLibs( SYMBOL_LIB_TABLE* aTable, const std::vector<wxString>& aNicknames,
+                         PROGRESS_REPORTER* aProgressReporter,
+                         const LIBRARY_HANDLER& aOnLibraryRead );
+
+    /**
+     * @return the symbols of the library aNickname, or NULL if it was not read
+     */
+    const SYMBOLS* GetSymbols( const wxString& aNickname ) const;
+
+    unsigned GetErrorCount() const
+    {
+        return m_errors.size();
+    }
+
+    /**
+     * @return the message of the next error of ReadSymbolLibs(), or an empty string
+     */
+    wxString PopError()
+    {
+        wxString error;
+
+        m_errors.pop( error );
+        return error;
+    }
+
+    void WriteCacheToFile( wxTextFile* aCacheFile );
+    void ReadCacheFromFile( wxTextFile* aCacheFile );
+
+private:
+    struct LIBRARY
+    {
+        long long m_timestamp;
+        SYMBOLS   m_symbols;
+    };
+
+    /**
+     * @return the modification times of the library file of aNickname and of its
+     * documentation file, plus a hash of its path
+     */
+    static long long libTimestamp( SYMBOL_LIB_TABLE* aTable, const wxString& aNickname );
+
+    std::map<wxString, LIBRARY> m_libraries;
+    wxString                    m_cacheFileName;   ///< Cache file the list was read from
+    SYNC_QUEUE<wxString>        m_errors;
+};
+
+#endif  // SYMBOL_INFO_LIST_H
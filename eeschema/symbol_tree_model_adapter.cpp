@@ -20,19 +20,19 @@
  */
 
 #include <wx/tokenzr.h>
-#include <wx/progdlg.h>
+#include <wx/textfile.h>
 
 #include <eda_pattern_match.h>
 #include <symbol_lib_table.h>
 #include <class_libentry.h>
 #include <generate_alias_info.h>
+#include <sch_base_frame.h>
+#include <symbol_info_list.h>
+#include <widgets/progress_reporter.h>
 
 #include <symbol_tree_model_adapter.h>
 
-
-bool SYMBOL_TREE_MODEL_ADAPTER::m_show_progress = true;
-
-#define PROGRESS_INTERVAL_MILLIS 66
+#include <algorithm>
 
 
 SYMBOL_TREE_MODEL_ADAPTER::PTR SYMBOL_TREE_MODEL_ADAPTER::Create( LIB_TABLE* aLibs )
@@ -51,38 +51,57 @@ SYMBOL_TREE_MODEL_ADAPTER::~SYMBOL_TREE_MODEL_ADAPTER()
 
 
 void SYMBOL_TREE_MODEL_ADAPTER::AddLibraries( const std::vector<wxString>& aNicknames,
-                                              wxWindow* aParent )
+                                              SCH_BASE_FRAME* aParent )
 {
-    wxProgressDialog* prg = nullptr;
-    wxLongLong        nextUpdate = wxGetUTCTimeMillis() + (PROGRESS_INTERVAL_MILLIS / 2);
+    SYMBOL_INFO_LIST&     symbolInfoList = SYMBOL_INFO_LIST::GetInstance( aParent->Prj() );
+    std::vector<wxString> changedLibs = symbolInfoList.GetChangedLibs( m_libs, aNicknames );
 
-    if( m_show_progress )
+    // The libraries not changed since they were read are shown from the list, without
+    // loading them
+    for( const auto& nickname : aNicknames )
     {
-        prg = new wxProgressDialog( _( "Loading Symbol Libraries" ), wxEmptyString,
-                                    aNicknames.size(), aParent );
+        if( std::find( changedLibs.begin(), changedLibs.end(), nickname ) == changedLibs.end() )
+            addSymbols( nickname, *symbolInfoList.GetSymbols( nickname ) );
     }
 
-    unsigned int ii = 0;
-
-    for( const auto& nickname : aNicknames )
+    if( !changedLibs.empty() )
     {
-        if( prg && wxGetUTCTimeMillis() > nextUpdate )
-        {
-            prg->Update( ii, wxString::Format( _( "Loading library \"%s\"" ), nickname ) );
-            nextUpdate = wxGetUTCTimeMillis() + PROGRESS_INTERVAL_MILLIS;
-        }
-
-        AddLibrary( nickname );
-        ii++;
+        std::unique_ptr<WX_PROGRESS_REPORTER> progressReporter(
+                new WX_PROGRESS_REPORTER( aParent, _( "Loading Symbol Libraries" ), 1 ) );
+
+        symbolInfoList.ReadSymbolLibs( m_libs, changedLibs, progressReporter.get(),
+                [this]( const wxString& aNickname, const SYMBOL_INFO_LIST::SYMBOLS& aSymbols )
+                {
+                    addSymbols( aNickname, aSymbols );
+                } );
+
+        progressReporter.reset();
+
+        while( symbolInfoList.GetErrorCount() )
+            wxLogError( "%s", symbolInfoList.PopError() );
+
+        wxTextFile symbolInfoCache( aParent->Prj().GetProjectPath() + "sym-info-cache" );
+        symbolInfoList.WriteCacheToFile( &symbolInfoCache );
     }
 
     m_tree.AssignIntrinsicRanks();
+}
+
+
+void SYMBOL_TREE_MODEL_ADAPTER::addSymbols( const wxString& aLibNickname,
+                                            const SYMBOL_INFO_LIST::SYMBOLS& aSymbols )
+{
+    bool                        onlyPowerSymbols = ( GetFilter() == CMP_FILTER_POWER );
+    std::vector<LIB_TREE_ITEM*> comp_list;
 
-    if( prg )
+    for( const auto& symbol : aSymbols )
     {
-        prg->Destroy();
-        m_show_progress = false;
+        if( !onlyPowerSymbols || symbol->IsPower() )
+            comp_list.push_back( symbol.get() );
     }
+
+    if( comp_list.size() > 0 )
+        DoAddLibrary( aLibNickname, m_libs->GetDescription( aLibNickname ), comp_list, false );
 }
 
 
@@ -23,9 +23,11 @@
 #define SYMBOL_TREE_MODEL_ADAPTER_H
 
 #include <lib_tree_model_adapter.h>
+#include <symbol_info_list.h>
 
 class LIB_TABLE;
 class SYMBOL_LIB_TABLE;
+class SCH_BASE_FRAME;
 
 class SYMBOL_TREE_MODEL_ADAPTER : public LIB_TREE_MODEL_ADAPTER
 {
@@ -44,12 +46,14 @@ public:
 
     /**
      * Add all the libraries in a SYMBOL_LIB_TABLE to the model.
-     * Displays a progress dialog attached to the parent frame the first time it is run.
+     * The symbols are taken from the SYMBOL_INFO_LIST of the project, and only the libraries
+     * changed since they were read are loaded, in parallel, with a progress dialog attached
+     * to the parent frame.  Each library is added to the model as soon as it is loaded.
      *
      * @param aNicknames is the list of library nicknames
-     * @param aParent is the parent window to display the progress dialog
+     * @param aParent is the parent frame to display the progress dialog
      */
-    void AddLibraries( const std::vector<wxString>& aNicknames, wxWindow* aParent );
+    void AddLibraries( const std::vector<wxString>& aNicknames, SCH_BASE_FRAME* aParent );
 
     void AddLibrary( wxString const& aLibNickname );
 
@@ -63,9 +67,9 @@ protected:
 
 private:
     /**
-     * Flag to only show the symbol library table load progress dialog the first time.
+     * Add the symbols of a library, only its power symbols if the power filter is set.
      */
-    static bool        m_show_progress;
+    void addSymbols( const wxString& aLibNickname, const SYMBOL_INFO_LIST::SYMBOLS& aSymbols );
 
     SYMBOL_LIB_TABLE*  m_libs;
 };
@@ -37,6 +37,8 @@
 #include <gerbview.h>
 #include <gerber_file_image.h>
 
+#include <algorithm>
+
 
 
 /**
@@ -104,8 +106,8 @@ void AM_PRIMITIVE::DrawBasicShape( const GERBER_DRAW_ITEM* aParent,
                             aShapeBuffer.Append( polybuffer[0].x, polybuffer[0].y );}
 
     // Draw the primitive shape for flashed items.
-    static std::vector<wxPoint> polybuffer;     // create a static buffer to avoid a lot of memory reallocation
-    polybuffer.clear();
+    // Not static: the shapes of several Gerber files can be built at the same time
+    std::vector<wxPoint> polybuffer;
 
     wxPoint curPos = aShapePos;
     D_CODE* tool   = aParent->GetDcodeDescr();
@@ -773,13 +775,13 @@ int AM_PRIMITIVE::GetShapeDim( const GERBER_DRAW_ITEM* aParent )
 }
 
 
-SHAPE_POLY_SET* APERTURE_MACRO::GetApertureMacroShape( const GERBER_DRAW_ITEM* aParent,
-                                                       wxPoint aShapePos )
+void APERTURE_MACRO::buildShape( const GERBER_DRAW_ITEM* aParent, wxPoint aShapePos,
+                                 SHAPE_POLY_SET& aShape )
 {
     SHAPE_POLY_SET holeBuffer;
     bool hasHole = false;
 
-    m_shape.RemoveAllContours();
+    aShape.RemoveAllContours();
 
     for( AM_PRIMITIVES::iterator prim_macro = primitives.begin();
          prim_macro != primitives.end(); ++prim_macro )
@@ -788,14 +790,14 @@ SHAPE_POLY_SET* APERTURE_MACRO::GetApertureMacroShape( const GERBER_DRAW_ITEM* a
             continue;
 
         if( prim_macro->IsAMPrimitiveExposureOn( aParent ) )
-            prim_macro->DrawBasicShape( aParent, m_shape, aShapePos );
+            prim_macro->DrawBasicShape( aParent, aShape, aShapePos );
         else
         {
             prim_macro->DrawBasicShape( aParent, holeBuffer, aShapePos );
 
             if( holeBuffer.OutlineCount() )     // we have a new hole in shape: remove the hole
             {
-                m_shape.BooleanSubtract( holeBuffer, SHAPE_POLY_SET::PM_FAST );
+                aShape.BooleanSubtract( holeBuffer, SHAPE_POLY_SET::PM_FAST );
                 holeBuffer.RemoveAllContours();
                 hasHole = true;
             }
@@ -805,13 +807,52 @@ SHAPE_POLY_SET* APERTURE_MACRO::GetApertureMacroShape( const GERBER_DRAW_ITEM* a
     // If a hole is defined inside a polygon, we must fracture the polygon
     // to be able to drawn it (i.e link holes by overlapping edges)
     if( hasHole )
-        m_shape.Fracture( SHAPE_POLY_SET::PM_FAST );
+        aShape.Fracture( SHAPE_POLY_SET::PM_FAST );
+}
+
+
+const SHAPE_POLY_SET& APERTURE_MACRO::GetCachedShape( const GERBER_DRAW_ITEM* aParent,
+                                                      wxPoint aShapePos, VECTOR2I& aOffset )
+{
+    APERTURE_MACRO_SHAPE& cache = aParent->GetDcodeDescr()->m_MacroShape;
+
+    // The layer transform (offset, scale, rotation, mirror) is an affine transform,
+    // known from the position of 3 reference points.  The shape flashed at aShapePos
+    // is therefore the shape flashed at (0,0), moved by the transform of aShapePos.
+    const int refDist = 1000000;
+
+    wxPoint transform[3] =
+    {
+        aParent->GetABPosition( wxPoint( 0, 0 ) ),
+        aParent->GetABPosition( wxPoint( refDist, 0 ) ),
+        aParent->GetABPosition( wxPoint( 0, refDist ) )
+    };
+
+    if( !cache.m_Valid || !std::equal( transform, transform + 3, cache.m_Transform ) )
+    {
+        buildShape( aParent, wxPoint( 0, 0 ), cache.m_Shape );
+        cache.m_BBox = cache.m_Shape.BBox();
+        std::copy( transform, transform + 3, cache.m_Transform );
+        cache.m_Valid = true;
+    }
+
+    aOffset = VECTOR2I( aParent->GetABPosition( aShapePos ) - transform[0] );
+
+    m_boundingBox = EDA_RECT( wxPoint( cache.m_BBox.GetX() + aOffset.x,
+                                       cache.m_BBox.GetY() + aOffset.y ),
+                              wxSize( cache.m_BBox.GetWidth(), cache.m_BBox.GetHeight() ) );
+
+    return cache.m_Shape;
+}
+
+
+SHAPE_POLY_SET* APERTURE_MACRO::GetApertureMacroShape( const GERBER_DRAW_ITEM* aParent,
+                                                       wxPoint aShapePos )
+{
+    VECTOR2I offset;
 
-    m_boundingBox = EDA_RECT( wxPoint( 0, 0 ), wxSize( 1, 1 ) );
-    auto bb = m_shape.BBox();
-    wxPoint center( bb.Centre().x, bb.Centre().y );
-    m_boundingBox.Move( aParent->GetABPosition( center ) );
-    m_boundingBox.Inflate( bb.GetWidth() / 2, bb.GetHeight() / 2 );
+    m_shape = GetCachedShape( aParent, aShapePos, offset );
+    m_shape.Move( offset );
 
     return &m_shape;
 }
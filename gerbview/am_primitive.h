@@ -199,6 +199,20 @@ struct APERTURE_MACRO
      */
     SHAPE_POLY_SET* GetApertureMacroShape( const GERBER_DRAW_ITEM* aParent, wxPoint aShapePos );
 
+    /**
+     * Function GetCachedShape
+     * returns the shape of the D_CODE of aParent flashed at (0,0), without copying it.
+     * The shape is built only once for a D_CODE (i.e. for a set of macro parameters)
+     * and a layer transform, and shared by all the items flashed with this D_CODE.
+     * Also updates the bounding box (see GetBoundingBox()).
+     * @param aParent = the parent GERBER_DRAW_ITEM which is actually drawn
+     * @param aShapePos = the actual shape position
+     * @param aOffset = the offset moving the returned shape to aShapePos
+     * @return The shape of the item, once moved by aOffset
+     */
+    const SHAPE_POLY_SET& GetCachedShape( const GERBER_DRAW_ITEM* aParent, wxPoint aShapePos,
+                                          VECTOR2I& aOffset );
+
    /**
      * Function DrawApertureMacroShape
      * Draw the primitive shape for flashed items.
@@ -232,6 +246,13 @@ struct APERTURE_MACRO
     {
         return m_boundingBox;
     }
+
+private:
+    /**
+     * Function buildShape
+     * builds in aShape the shape of aParent flashed at aShapePos, from the macro primitives
+     */
+    void buildShape( const GERBER_DRAW_ITEM* aParent, wxPoint aShapePos, SHAPE_POLY_SET& aShape );
 };
 
 
@@ -31,6 +31,7 @@
 #include <fctsys.h>
 #include <common.h>
 #include <class_drawpanel.h>
+#include <class_draw_panel_gal.h>
 #include <gerbview_frame.h>
 #include <gerber_draw_item.h>
 #include <gerber_file_image.h>
@@ -200,6 +201,7 @@ void GERBVIEW_FRAME::Block_Move()
     /* Calculate displacement vectors. */
     delta = GetScreen()->m_BlockLocate.GetMoveVector();
     GERBER_FILE_IMAGE_LIST* images = GetGerberLayout()->GetImagesList();
+    KIGFX::VIEW* view = GetGalCanvas() ? GetGalCanvas()->GetView() : NULL;
 
     for( unsigned layer = 0; layer < images->ImagesMaxCount(); ++layer )
     {
@@ -209,12 +211,17 @@ void GERBVIEW_FRAME::Block_Move()
             continue;
 
         /* Move items in block */
-        for( GERBER_DRAW_ITEM* item = gerber->GetItemsList(); item; item = item->Next() )
+        GERBER_DRAW_ITEM gerb_item( gerber );
+
+        for( unsigned ii = 0; ii < gerber->GetItemsCount(); ++ii )
         {
-            GERBER_DRAW_ITEM* gerb_item = item;
+            gerber->LoadItem( ii, gerb_item );
 
-            if( gerb_item->HitTest( GetScreen()->m_BlockLocate ) )
-                gerb_item->MoveAB( delta );
+            if( gerb_item.HitTest( GetScreen()->m_BlockLocate ) )
+            {
+                gerb_item.MoveAB( delta );
+                gerber->SetItem( ii, gerb_item, view );
+            }
         }
     }
 
@@ -89,6 +89,8 @@ void D_CODE::Clear_D_CODE_Data()
     m_Rotation   = 0.0;
     m_EdgesCount = 0;
     m_Polygon.RemoveAllContours();
+    m_MacroShape.m_Valid = false;
+    m_MacroShape.m_Shape.RemoveAllContours();
 }
 
 
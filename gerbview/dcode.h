@@ -75,6 +75,24 @@ enum APERTURE_DEF_HOLETYPE {
 struct APERTURE_MACRO;
 
 
+/**
+ * Struct APERTURE_MACRO_SHAPE
+ * is the shape of an aperture macro customized by the parameters of a D_CODE,
+ * flashed at (0,0) with a given layer transform.
+ * It is built once by APERTURE_MACRO::GetCachedShape(), and only moved
+ * to the position of each flashed item.
+ */
+struct APERTURE_MACRO_SHAPE
+{
+    bool           m_Valid;         ///< false if the shape must be (re)built
+    wxPoint        m_Transform[3];  ///< the layer transform of 3 reference points, when built
+    SHAPE_POLY_SET m_Shape;         ///< the shape, in absolute coordinates
+    BOX2I          m_BBox;          ///< the bounding box of m_Shape
+
+    APERTURE_MACRO_SHAPE() : m_Valid( false ) {}
+};
+
+
 /**
  * Class D_CODE
  * holds a gerber DCODE (also called Aperture) definition.
@@ -108,6 +126,7 @@ public:
                                              * complex shapes which are converted to polygon
                                              * (shapes with hole )
                                              */
+    APERTURE_MACRO_SHAPE  m_MacroShape;     ///< the cached shape of m_Macro for this D_CODE
 
 public:
     D_CODE( int num_dcode );
@@ -122,6 +141,7 @@ public:
     void AppendParam( double aValue )
     {
         m_am_params.push_back( aValue );
+        m_MacroShape.m_Valid = false;
     }
 
     /**
@@ -151,6 +171,7 @@ public:
     void SetMacro( APERTURE_MACRO* aMacro )
     {
         m_Macro = aMacro;
+        m_MacroShape.m_Valid = false;
     }
 
 
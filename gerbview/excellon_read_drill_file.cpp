@@ -245,21 +245,6 @@ bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
 {
     wxString msg;
     int layerId = GetActiveLayer();      // current layer used in GerbView
-    GERBER_FILE_IMAGE_LIST* images = GetGerberLayout()->GetImagesList();
-    auto gerber_layer = images->GetGbrImage( layerId );
-    auto drill_layer = dynamic_cast<EXCELLON_IMAGE*>( gerber_layer );
-
-    if( gerber_layer && !drill_layer )
-    {
-        // The active layer contains old gerber data we have to clear
-        Erase_Current_DrawLayer( false );
-    }
-
-    if( drill_layer == nullptr )
-    {
-        drill_layer = new EXCELLON_IMAGE( layerId );
-        layerId = images->AddGbrImage( drill_layer, layerId );
-    }
 
     if( layerId < 0 )
     {
@@ -267,40 +252,21 @@ bool GERBVIEW_FRAME::Read_EXCELLON_File( const wxString& aFullFileName )
         return false;
     }
 
-    // Read the Excellon drill file:
-    bool success = drill_layer->LoadFile( aFullFileName );
+    EXCELLON_IMAGE* drill_layer = new EXCELLON_IMAGE( layerId );
 
-    if( !success )
+    // Read the Excellon drill file:
+    if( !drill_layer->LoadFile( aFullFileName ) )
     {
+        delete drill_layer;
         msg.Printf( _( "File %s not found" ), GetChars( aFullFileName ) );
         DisplayError( this, msg );
         return false;
     }
 
-    // Display errors list
-    if( drill_layer->GetMessages().size() > 0 )
-    {
-        HTML_MESSAGE_BOX dlg( this, _( "Error reading EXCELLON drill file" ) );
-        dlg.ListSet( drill_layer->GetMessages() );
-        dlg.ShowModal();
-    }
-
-    if( success )
-    {
-        EDA_DRAW_PANEL_GAL* canvas = GetGalCanvas();
-
-        if( canvas )
-        {
-            KIGFX::VIEW* view = canvas->GetView();
-
-            for( GERBER_DRAW_ITEM* item = drill_layer->GetItemsList(); item; item = item->Next() )
-            {
-                view->Add( (KIGFX::VIEW_ITEM*) item );
-            }
-        }
-    }
+    // The active layer is cleared if it contains old data
+    attachImage( drill_layer );
 
-    return success;
+    return true;
 }
 
 /*
@@ -568,11 +534,11 @@ bool EXCELLON_IMAGE::Execute_HEADER_And_M_Command( char*& text )
 
         for( size_t ii = 1; ii < m_RoutePositions.size(); ii++ )
         {
-            GERBER_DRAW_ITEM* gbritem = new GERBER_DRAW_ITEM( this );
+            GERBER_DRAW_ITEM gbritem( this );
 
             if( m_RoutePositions[ii].m_rmode == 0 )     // linear routing
             {
-            fillLineGBRITEM( gbritem, tool->m_Num_Dcode,
+            fillLineGBRITEM( &gbritem, tool->m_Num_Dcode,
                             m_RoutePositions[ii-1].GetPos(), m_RoutePositions[ii].GetPos(),
                             tool->m_Size, false );
             }
@@ -588,16 +554,16 @@ bool EXCELLON_IMAGE::Execute_HEADER_And_M_Command( char*& text )
                 center = computeCenter( m_RoutePositions[ii-1].GetPos(),
                                         m_RoutePositions[ii].GetPos(), radius, rot_ccw );
 
-            fillArcGBRITEM( gbritem, tool->m_Num_Dcode,
+            fillArcGBRITEM( &gbritem, tool->m_Num_Dcode,
                              m_RoutePositions[ii-1].GetPos(), m_RoutePositions[ii].GetPos(),
                              center - m_RoutePositions[ii-1].GetPos(),
                              tool->m_Size, not rot_ccw , true,
                              false );
             }
 
-            m_Drawings.Append( gbritem );
+            AddItem( gbritem );
 
-            StepAndRepeatItem( *gbritem );
+            StepAndRepeatItem( gbritem );
         }
 
         m_RoutePositions.clear();
@@ -668,7 +634,6 @@ bool EXCELLON_IMAGE::readToolInformation( char*& aText )
 bool EXCELLON_IMAGE::Execute_Drill_Command( char*& text )
 {
     D_CODE*  tool;
-    GERBER_DRAW_ITEM * gbritem;
 
     while( true )
     {
@@ -689,6 +654,7 @@ bool EXCELLON_IMAGE::Execute_Drill_Command( char*& text )
                 break;
 
             case 0:     // E.O.L: execute command
+            {
                 if( m_RouteModeOn )
                 {
                     // We are in routing mode, and this is an intermediate point.
@@ -722,12 +688,11 @@ bool EXCELLON_IMAGE::Execute_Drill_Command( char*& text )
                     return false;
                 }
 
-                gbritem = new GERBER_DRAW_ITEM( this );
-                m_Drawings.Append( gbritem );
+                GERBER_DRAW_ITEM gbritem( this );
 
                 if( m_SlotOn )  // Oblong hole
                 {
-                    fillLineGBRITEM( gbritem, tool->m_Num_Dcode,
+                    fillLineGBRITEM( &gbritem, tool->m_Num_Dcode,
                                     m_PreviousPos, m_CurrentPos,
                                     tool->m_Size, false );
                     // the hole is made: reset the slot on command (G85)
@@ -736,14 +701,15 @@ bool EXCELLON_IMAGE::Execute_Drill_Command( char*& text )
                 }
                 else
                 {
-                    fillFlashedGBRITEM( gbritem, tool->m_Shape, tool->m_Num_Dcode,
+                    fillFlashedGBRITEM( &gbritem, tool->m_Shape, tool->m_Num_Dcode,
                                     m_CurrentPos, tool->m_Size, false );
                 }
 
-                StepAndRepeatItem( *gbritem );
+                AddItem( gbritem );
+                StepAndRepeatItem( gbritem );
                 m_PreviousPos = m_CurrentPos;
                 return true;
-                break;
+            }
 
             default:
                 text++;
@@ -245,10 +245,13 @@ bool GBR_TO_PCB_EXPORTER::ExportPcb( LAYER_NUM* aLayerLookUpTable, int aCopperLa
         if( pcb_layer_number <= pcbCopperLayerMax ) // copper layer
             continue;
 
-        GERBER_DRAW_ITEM* gerb_item = gerber->GetItemsList();
+        GERBER_DRAW_ITEM gerb_item( gerber );
 
-        for( ; gerb_item; gerb_item = gerb_item->Next() )
-            export_non_copper_item( gerb_item, pcb_layer_number );
+        for( unsigned ii = 0; ii < gerber->GetItemsCount(); ++ii )
+        {
+            gerber->LoadItem( ii, gerb_item );
+            export_non_copper_item( &gerb_item, pcb_layer_number );
+        }
     }
 
     // Copper layers
@@ -264,10 +267,13 @@ bool GBR_TO_PCB_EXPORTER::ExportPcb( LAYER_NUM* aLayerLookUpTable, int aCopperLa
         if( pcb_layer_number < 0 || pcb_layer_number > pcbCopperLayerMax )
             continue;
 
-        GERBER_DRAW_ITEM* gerb_item = gerber->GetItemsList();
+        GERBER_DRAW_ITEM gerb_item( gerber );
 
-        for( ; gerb_item; gerb_item = gerb_item->Next() )
-            export_copper_item( gerb_item, pcb_layer_number );
+        for( unsigned ii = 0; ii < gerber->GetItemsCount(); ++ii )
+        {
+            gerber->LoadItem( ii, gerb_item );
+            export_copper_item( &gerb_item, pcb_layer_number );
+        }
     }
 
     fprintf( m_fp, ")\n" );
@@ -43,6 +43,13 @@
 #include <gerbview_layer_widget.h>
 #include <wildcards_and_files_ext.h>
 #include <widgets/progress_reporter.h>
+#include <excellon_image.h>
+#include <confirm.h>
+#include <parallel_tasks.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
 
 // HTML Messages used more than one time:
 #define MSG_NO_MORE_LAYER\
@@ -249,19 +256,14 @@ bool GERBVIEW_FRAME::LoadGerberFiles( const wxString& aFullFileName )
 }
 
 
-bool GERBVIEW_FRAME::loadListOfGerberFiles( const wxString& aPath,
-                                            const wxArrayString& aFilenameList )
+std::vector<GERBER_FILE_IMAGE*> GERBVIEW_FRAME::readFiles( const wxArrayString& aFullFilenames,
+                                                           bool aExcellon,
+                                                           const wxString& aProgressTitle )
 {
-    wxFileName filename;
+    std::vector<GERBER_FILE_IMAGE*> images( aFullFilenames.GetCount(), nullptr );
 
-    // Read gerber files: each file is loaded on a new GerbView layer
-    bool success = true;
-    int layer = GetActiveLayer();
-    int visibility = GetVisibleLayers();
-
-    // Manage errors when loading files
-    wxString msg;
-    WX_STRING_REPORTER reporter( &msg );
+    if( images.empty() )
+        return images;
 
     // Show progress dialog after 1 second of loading
     static const long long progressShowDelay = 1000;
@@ -269,47 +271,117 @@ bool GERBVIEW_FRAME::loadListOfGerberFiles( const wxString& aPath,
     auto startTime = wxGetUTCTimeMillis();
     std::unique_ptr<WX_PROGRESS_REPORTER> progress = nullptr;
 
-    for( unsigned ii = 0; ii < aFilenameList.GetCount(); ii++ )
+    std::atomic<size_t> filesRead( 0 );
+
+    // The numbers are read with the C locale
+    PARALLEL_TASKS tasks( images.size(), [&]( size_t i )
+    {
+        // The graphic layer is set when the image is attached to a layer
+        GERBER_FILE_IMAGE* image;
+        bool success;
+
+        if( aExcellon )
+        {
+            EXCELLON_IMAGE* drill_image = new EXCELLON_IMAGE( 0 );
+            success = drill_image->LoadFile( aFullFilenames[i] );
+            image = drill_image;
+        }
+        else
+        {
+            image = new GERBER_FILE_IMAGE( 0 );
+            success = image->LoadGerberFile( aFullFilenames[i] );
+        }
+
+        if( success )
+            images[i] = image;
+        else
+            delete image;
+
+        filesRead++;
+    }, true );
+
+    size_t filesReported = 0;
+
+    while( !tasks.IsDone() )
     {
         if( !progress && wxGetUTCTimeMillis() - startTime > progressShowDelay )
         {
-            progress = std::make_unique<WX_PROGRESS_REPORTER>( this,
-                            _( "Loading Gerber files..." ), 1, false );
-            progress->SetMaxProgress( aFilenameList.GetCount() - 1 );
-            progress->Report( _("Loading Gerber files..." ) );
+            progress = std::make_unique<WX_PROGRESS_REPORTER>( this, aProgressTitle, 1, false );
+            progress->SetMaxProgress( images.size() );
+            progress->Report( aProgressTitle );
         }
-        else if( progress )
+
+        if( progress )
         {
+            for( ; filesReported < filesRead; filesReported++ )
+                progress->AdvanceProgress();
+
             progress->KeepRefreshing();
         }
 
+        std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+    }
+
+    return images;
+}
+
+
+bool GERBVIEW_FRAME::loadListOfGerberFiles( const wxString& aPath,
+                                            const wxArrayString& aFilenameList )
+{
+    wxFileName filename;
+    wxArrayString fullFilenames;
+
+    for( unsigned ii = 0; ii < aFilenameList.GetCount(); ii++ )
+    {
         filename = aFilenameList[ii];
 
         if( !filename.IsAbsolute() )
             filename.SetPath( aPath );
 
-        m_lastFileName = filename.GetFullPath();
+        fullFilenames.Add( filename.GetFullPath() );
+    }
+
+    // Read all the files at the same time, then attach them to the layers
+    // in the order of the list
+    std::vector<GERBER_FILE_IMAGE*> images = readFiles( fullFilenames, false,
+                                                        _( "Loading Gerber files..." ) );
+
+    // Read gerber files: each file is loaded on a new GerbView layer
+    bool success = true;
+    int layer = GetActiveLayer();
+    int visibility = GetVisibleLayers();
+
+    // Manage errors when loading files
+    wxString msg;
+    WX_STRING_REPORTER reporter( &msg );
+
+    for( unsigned ii = 0; ii < fullFilenames.GetCount(); ii++ )
+    {
+        m_lastFileName = fullFilenames[ii];
 
         SetActiveLayer( layer, false );
 
         visibility |= ( 1 << layer );
 
-        if( Read_GERBER_File( filename.GetFullPath() ) )
+        if( images[ii] )
         {
+            attachImage( images[ii] );
             UpdateFileHistory( m_lastFileName );
 
             layer = getNextAvailableLayer( layer );
 
-            if( layer == NO_AVAILABLE_LAYERS && ii < aFilenameList.GetCount()-1 )
+            if( layer == NO_AVAILABLE_LAYERS && ii < fullFilenames.GetCount()-1 )
             {
                 success = false;
                 reporter.Report( MSG_NO_MORE_LAYER, REPORTER::RPT_ERROR );
 
                 // Report the name of not loaded files:
                 ii += 1;
-                while( ii < aFilenameList.GetCount() )
+                while( ii < fullFilenames.GetCount() )
                 {
-                    filename = aFilenameList[ii++];
+                    delete images[ii];
+                    filename = fullFilenames[ii++];
                     wxString txt;
                     txt.Printf( MSG_NOT_LOADED,
                                 GetChars( filename.GetFullName() ) );
@@ -320,9 +392,12 @@ bool GERBVIEW_FRAME::loadListOfGerberFiles( const wxString& aPath,
 
             SetActiveLayer( layer, false );
         }
-
-        if( progress )
-            progress->AdvanceProgress();
+        else
+        {
+            wxString txt;
+            txt.Printf( _( "File \"%s\" not found" ), GetChars( m_lastFileName ) );
+            DisplayError( this, txt, 10 );
+        }
     }
 
     if( !success )
@@ -396,6 +471,26 @@ bool GERBVIEW_FRAME::LoadExcellonFiles( const wxString& aFullFileName )
         m_mruPath = currentPath;
     }
 
+    wxArrayString fullFilenames;
+
+    for( unsigned ii = 0; ii < filenamesList.GetCount(); ii++ )
+    {
+        filename = filenamesList[ii];
+
+        if( !filename.IsAbsolute() )
+            filename.SetPath( currentPath );
+
+        fullFilenames.Add( filename.GetFullPath() );
+    }
+
+    // Set the busy cursor
+    wxBusyCursor wait;
+
+    // Read all the files at the same time, then attach them to the layers
+    // in the order of the list
+    std::vector<GERBER_FILE_IMAGE*> images = readFiles( fullFilenames, true,
+                                                        _( "Loading drill files..." ) );
+
     // Read Excellon drill files: each file is loaded on a new GerbView layer
     bool success = true;
     int layer = GetActiveLayer();
@@ -404,34 +499,38 @@ bool GERBVIEW_FRAME::LoadExcellonFiles( const wxString& aFullFileName )
     wxString msg;
     WX_STRING_REPORTER reporter( &msg );
 
-    for( unsigned ii = 0; ii < filenamesList.GetCount(); ii++ )
+    for( unsigned ii = 0; ii < fullFilenames.GetCount(); ii++ )
     {
-        filename = filenamesList[ii];
-
-        if( !filename.IsAbsolute() )
-            filename.SetPath( currentPath );
-
-        m_lastFileName = filename.GetFullPath();
+        m_lastFileName = fullFilenames[ii];
 
         SetActiveLayer( layer, false );
 
-        if( Read_EXCELLON_File( filename.GetFullPath() ) )
+        if( !images[ii] )
         {
+            wxString txt;
+            txt.Printf( _( "File %s not found" ), GetChars( m_lastFileName ) );
+            DisplayError( this, txt );
+        }
+        else
+        {
+            attachImage( images[ii] );
+
             // Update the list of recent drill files.
-            UpdateFileHistory( filename.GetFullPath(),  &m_drillFileHistory );
+            UpdateFileHistory( m_lastFileName,  &m_drillFileHistory );
 
             layer = getNextAvailableLayer( layer );
 
-            if( layer == NO_AVAILABLE_LAYERS && ii < filenamesList.GetCount()-1 )
+            if( layer == NO_AVAILABLE_LAYERS && ii < fullFilenames.GetCount()-1 )
             {
                 success = false;
                 reporter.Report( MSG_NO_MORE_LAYER, REPORTER::RPT_ERROR );
 
                 // Report the name of not loaded files:
                 ii += 1;
-                while( ii < filenamesList.GetCount() )
+                while( ii < fullFilenames.GetCount() )
                 {
-                    filename = filenamesList[ii++];
+                    delete images[ii];
+                    filename = fullFilenames[ii++];
                     wxString txt;
                     txt.Printf( MSG_NOT_LOADED,
                                 GetChars( filename.GetFullName() ) );
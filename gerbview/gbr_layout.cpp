@@ -74,19 +74,16 @@ EDA_RECT GBR_LAYOUT::ComputeBoundingBox() const
     {
         GERBER_FILE_IMAGE* gerber = GetImagesList()->GetGbrImage( layer );
 
-        if( gerber == NULL )    // Graphic layer not yet used
+        if( gerber == NULL || gerber->GetItemsCount() == 0 )    // Graphic layer not yet used
             continue;
 
-        for( GERBER_DRAW_ITEM* item = gerber->GetItemsList(); item; item = item->Next() )
+        if( first_item )
         {
-            if( first_item )
-            {
-                bbox = item->GetBoundingBox();
-                first_item = false;
-            }
-            else
-                bbox.Merge( item->GetBoundingBox() );
+            bbox = gerber->GetBoundingBox();
+            first_item = false;
         }
+        else
+            bbox.Merge( gerber->GetBoundingBox() );
     }
 
     bbox.Normalize();
@@ -290,10 +287,12 @@ void GBR_LAYOUT::Draw( EDA_DRAW_PANEL* aPanel, wxDC* aDC, GR_DRAWMODE aDrawMode,
 
         // Now we can draw the current layer to the bitmap buffer
         // When needed, the previous bitmap is already copied to the screen buffer.
-        for( GERBER_DRAW_ITEM* item = gerber->GetItemsList(); item; item = item->Next() )
+        GERBER_DRAW_ITEM  drawItem( gerber );
+        GERBER_DRAW_ITEM* item = &drawItem;
+
+        for( unsigned ii = 0; ii < gerber->GetItemsCount(); ++ii )
         {
-            if( item->GetLayer() != layer )
-                continue;
+            gerber->LoadItem( ii, drawItem );
 
             GR_DRAWMODE drawMode = layerdrawMode;
 
@@ -383,16 +382,20 @@ void GBR_LAYOUT::DrawItemsDCodeID( EDA_DRAW_PANEL* aPanel, wxDC* aDC,
         if( ! gerber->m_IsVisible )
             continue;
 
-        for( GERBER_DRAW_ITEM* item = gerber->GetItemsList(); item != NULL; item = item->Next() )
+        GERBER_DRAW_ITEM item( gerber );
+
+        for( unsigned ii = 0; ii < gerber->GetItemsCount(); ++ii )
         {
             wxPoint pos;
             int     size;
             double  orient;
 
-            if( ! item->GetTextD_CodePrms( size, pos, orient ) )
+            gerber->LoadItem( ii, item );
+
+            if( ! item.GetTextD_CodePrms( size, pos, orient ) )
                 continue;
 
-            Line.Printf( wxT( "D%d" ), item->m_DCode );
+            Line.Printf( wxT( "D%d" ), item.m_DCode );
 
             // Avoid to draw text, if it is too small (size in pixel < 5 pixels)
             // to be readable:
@@ -18,11 +18,11 @@
  */
 
 #include "gerber_collectors.h"
+#include <gerber_file_image.h>
 
 const KICAD_T GERBER_COLLECTOR::AllItems[] = {
     GERBER_IMAGE_LIST_T,
-    GERBER_IMAGE_T,
-    GERBER_DRAW_ITEM_T,
+    GERBER_IMAGE_T,         // the items of the images are collected by the images
     EOT
 };
 
@@ -41,8 +41,29 @@ const KICAD_T GERBER_COLLECTOR::AllItems[] = {
  */
 SEARCH_RESULT GERBER_COLLECTOR::Inspect( EDA_ITEM* testItem, void* testData )
 {
-    if( testItem->HitTest( m_RefPos ) )
+    if( testItem->Type() == GERBER_IMAGE_T )
+    {
+        // Only the hit items of an image are created, so do not visit all of them
+        std::vector<GERBER_DRAW_ITEM*> items;
+
+        static_cast<GERBER_FILE_IMAGE*>( testItem )->HitTestItems( m_RefPos, items );
+
+        for( GERBER_DRAW_ITEM* item : items )
+            Append( item );
+    }
+    else if( testItem->HitTest( m_RefPos ) )
+    {
+        // The items visited by an image are temporary: keep the item owned by the image
+        if( testItem->Type() == GERBER_DRAW_ITEM_T )
+        {
+            auto item = static_cast<GERBER_DRAW_ITEM*>( testItem );
+
+            if( item->GetImageIndex() >= 0 )
+                testItem = item->m_GerberImageFile->GetItem( item->GetImageIndex() );
+        }
+
         Append( testItem );
+    }
 
     return SEARCH_CONTINUE;
 }
@@ -0,0 +1,460 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file gerber_diff.cpp
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <macros.h>
+#include <reporter.h>
+#include <convert_to_biu.h>
+#include <parallel_tasks.h>
+#include <wildcards_and_files_ext.h>
+
+#include <gerber_diff.h>
+#include <gerber_draw_item.h>
+#include <gerber_file_image.h>
+#include <excellon_image.h>
+
+#include <wx/filename.h>
+#include <wx/image.h>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+
+// Number of segments to approximate a circle (the same as the aperture shapes)
+static const int SEGS_CNT = 64;
+
+// The items of the same polarity are merged by batches of this many vertices
+static const int MAX_BATCH_VERTICES = 100000;
+
+// The largest width or height of a diff image, in pixels
+static const int MAX_IMAGE_SIZE = 8000;
+
+
+GERBER_DIFF::GERBER_DIFF( int aResolution ) :
+    m_resolution( aResolution )
+{
+}
+
+
+void GERBER_DIFF::BuildImageShape( GERBER_FILE_IMAGE* aImage, SHAPE_POLY_SET& aShape )
+{
+    GERBER_DRAW_ITEM item( aImage );
+    SHAPE_POLY_SET   itemShape;
+    SHAPE_POLY_SET   batch;             // the outlines of consecutive items of the same polarity
+    int              batchVertices = 0;
+    bool             batchNegative = false;
+
+    aShape.RemoveAllContours();
+
+    // A negative item removes the shapes drawn before it, so the items are merged in order
+    auto mergeBatch = [&]()
+    {
+        if( batch.OutlineCount() == 0 )
+            return;
+
+        if( batchNegative )
+            aShape.BooleanSubtract( batch, SHAPE_POLY_SET::PM_FAST );
+        else
+            aShape.BooleanAdd( batch, SHAPE_POLY_SET::PM_FAST );
+
+        batch.RemoveAllContours();
+        batchVertices = 0;
+    };
+
+    for( unsigned ii = 0; ii < aImage->GetItemsCount(); ++ii )
+    {
+        aImage->LoadItem( ii, item );
+
+        if( item.GetLayerPolarity() != batchNegative || batchVertices > MAX_BATCH_VERTICES )
+        {
+            mergeBatch();
+            batchNegative = item.GetLayerPolarity();
+        }
+
+        itemShape.RemoveAllContours();
+        item.TransformShapeToPolygon( itemShape, SEGS_CNT );
+
+        // The overlapping outlines of a batch are merged with the non-zero fill rule:
+        // the holes must be linked to their outline, and all the outlines must have
+        // the same orientation
+        if( itemShape.HasHoles() )
+            itemShape.Fracture( SHAPE_POLY_SET::PM_FAST );
+
+        for( int jj = 0; jj < itemShape.OutlineCount(); ++jj )
+        {
+            const SHAPE_LINE_CHAIN& outline = itemShape.COutline( jj );
+
+            batch.AddOutline( outline.Area() < 0 ? outline.Reverse() : outline );
+            batchVertices += outline.PointCount();
+        }
+    }
+
+    mergeBatch();
+}
+
+
+bool GERBER_DIFF::Compare( GERBER_FILE_IMAGE* aReference, GERBER_FILE_IMAGE* aCompared )
+{
+    BuildImageShape( aReference, m_reference );
+    BuildImageShape( aCompared, m_compared );
+
+    m_missing.BooleanSubtract( m_reference, m_compared, SHAPE_POLY_SET::PM_FAST );
+    m_extra.BooleanSubtract( m_compared, m_reference, SHAPE_POLY_SET::PM_FAST );
+
+    // Remove the differences narrower than the resolution: a deflate removes them,
+    // and the inflate gives back their size to the larger ones
+    int margin = m_resolution / 2;
+
+    if( margin > 0 )
+    {
+        m_missing.Inflate( -margin, SEGS_CNT );
+        m_missing.Inflate( margin, SEGS_CNT );
+        m_extra.Inflate( -margin, SEGS_CNT );
+        m_extra.Inflate( margin, SEGS_CNT );
+    }
+
+    m_regions.clear();
+
+    for( int pass = 0; pass < 2; ++pass )
+    {
+        const SHAPE_POLY_SET& diff = pass == 0 ? m_missing : m_extra;
+
+        for( int ii = 0; ii < diff.OutlineCount(); ++ii )
+        {
+            GERBER_DIFF_REGION region;
+
+            region.m_Missing = ( pass == 0 );
+            region.m_Area = std::fabs( diff.COutline( ii ).Area() );
+            region.m_BBox = diff.COutline( ii ).BBox();
+
+            for( int jj = 0; jj < diff.HoleCount( ii ); ++jj )
+                region.m_Area -= std::fabs( diff.CHole( ii, jj ).Area() );
+
+            m_regions.push_back( region );
+        }
+    }
+
+    return m_regions.empty();
+}
+
+
+double GERBER_DIFF::GetDiffArea() const
+{
+    double area = 0.0;
+
+    for( const GERBER_DIFF_REGION& region : m_regions )
+        area += region.m_Area;
+
+    return area;
+}
+
+
+/**
+ * Fills in aImage the polygons of aPolygons, with the even-odd rule (the polygons are
+ * built by boolean operations, so they do not overlap).  A pixel of the image is a
+ * square of aPixelSize internal units, and the pixel (0,0) is at aOrigin.
+ */
+static void fillPolygons( wxImage& aImage, const SHAPE_POLY_SET& aPolygons,
+                          const VECTOR2I& aOrigin, double aPixelSize,
+                          unsigned char aRed, unsigned char aGreen, unsigned char aBlue )
+{
+    struct EDGE
+    {
+        double m_yMin;      // the edge ends, in pixels
+        double m_yMax;
+        double m_xAtYMin;
+        double m_slope;     // dx/dy
+    };
+
+    std::vector<EDGE> edges;
+
+    auto addEdges = [&]( const SHAPE_LINE_CHAIN& aChain )
+    {
+        int count = aChain.PointCount();
+
+        for( int ii = 0; ii < count; ++ii )
+        {
+            VECTOR2D a = VECTOR2D( aChain.CPoint( ii ) - aOrigin ) / aPixelSize;
+            VECTOR2D b = VECTOR2D( aChain.CPoint( ( ii + 1 ) % count ) - aOrigin ) / aPixelSize;
+
+            if( a.y == b.y )
+                continue;
+
+            if( a.y > b.y )
+                std::swap( a, b );
+
+            edges.push_back( { a.y, b.y, a.x, ( b.x - a.x ) / ( b.y - a.y ) } );
+        }
+    };
+
+    for( int ii = 0; ii < aPolygons.OutlineCount(); ++ii )
+    {
+        addEdges( aPolygons.COutline( ii ) );
+
+        for( int jj = 0; jj < aPolygons.HoleCount( ii ); ++jj )
+            addEdges( aPolygons.CHole( ii, jj ) );
+    }
+
+    std::sort( edges.begin(), edges.end(),
+               []( const EDGE& aFirst, const EDGE& aSecond )
+               {
+                   return aFirst.m_yMin < aSecond.m_yMin;
+               } );
+
+    int                 width = aImage.GetWidth();
+    unsigned char*      data = aImage.GetData();
+    size_t              nextEdge = 0;
+    std::vector<size_t> active;
+    std::vector<double> crossings;
+
+    // Fill each row of pixels between the pairs of edges crossing its centre
+    for( int row = 0; row < aImage.GetHeight(); ++row )
+    {
+        double y = row + 0.5;
+
+        for( ; nextEdge < edges.size() && edges[nextEdge].m_yMin <= y; ++nextEdge )
+            active.push_back( nextEdge );
+
+        active.erase( std::remove_if( active.begin(), active.end(),
+                                      [&]( size_t aEdge ) { return edges[aEdge].m_yMax <= y; } ),
+                      active.end() );
+
+        crossings.clear();
+
+        for( size_t edge : active )
+            crossings.push_back( edges[edge].m_xAtYMin
+                                 + ( y - edges[edge].m_yMin ) * edges[edge].m_slope );
+
+        std::sort( crossings.begin(), crossings.end() );
+
+        for( size_t ii = 0; ii + 1 < crossings.size(); ii += 2 )
+        {
+            int first = std::max( 0, (int) std::ceil( crossings[ii] - 0.5 ) );
+            int last = std::min( width - 1, (int) std::floor( crossings[ii + 1] - 0.5 ) );
+
+            for( int col = first; col <= last; ++col )
+            {
+                unsigned char* pixel = data + ( (size_t) row * width + col ) * 3;
+                pixel[0] = aRed;
+                pixel[1] = aGreen;
+                pixel[2] = aBlue;
+            }
+        }
+    }
+}
+
+
+bool GERBER_DIFF::WriteDiffImage( const wxString& aFullFileName ) const
+{
+    BOX2I area;
+
+    if( m_reference.OutlineCount() == 0 )
+        area = m_compared.BBox();
+    else if( m_compared.OutlineCount() == 0 )
+        area = m_reference.BBox();
+    else
+        area = m_reference.BBox().Merge( m_compared.BBox() );
+
+    if( area.GetWidth() <= 0 || area.GetHeight() <= 0 )
+        return false;
+
+    // The pixels are larger than the resolution for very large images
+    double pixelSize = std::max( (double) std::max( m_resolution, 1 ),
+                                 (double) std::max( area.GetWidth(), area.GetHeight() )
+                                         / MAX_IMAGE_SIZE );
+
+    int width = std::max( 1, KiROUND( area.GetWidth() / pixelSize ) );
+    int height = std::max( 1, KiROUND( area.GetHeight() / pixelSize ) );
+
+    wxImage image( width, height, true );   // a black image
+
+    SHAPE_POLY_SET common;
+    common.BooleanIntersection( m_reference, m_compared, SHAPE_POLY_SET::PM_FAST );
+
+    fillPolygons( image, common, area.GetOrigin(), pixelSize, 128, 128, 128 );
+    fillPolygons( image, m_missing, area.GetOrigin(), pixelSize, 255, 0, 0 );
+    fillPolygons( image, m_extra, area.GetOrigin(), pixelSize, 0, 255, 0 );
+
+    return image.SaveFile( aFullFileName, wxBITMAP_TYPE_PNG );
+}
+
+
+/**
+ * Reads a gerber file, or an Excellon file if it has the drill file extension
+ * @return the image, or NULL if the file cannot be read
+ */
+static GERBER_FILE_IMAGE* loadImage( const wxString& aFullFileName )
+{
+    wxFileName fn( aFullFileName );
+    std::unique_ptr<GERBER_FILE_IMAGE> image;
+    bool success;
+
+    if( fn.GetExt().CmpNoCase( DrillFileExtension ) == 0 )
+    {
+        EXCELLON_IMAGE* drill_image = new EXCELLON_IMAGE( 0 );
+        image.reset( drill_image );
+        success = drill_image->LoadFile( aFullFileName );
+    }
+    else
+    {
+        image.reset( new GERBER_FILE_IMAGE( 0 ) );
+        success = image->LoadGerberFile( aFullFileName );
+    }
+
+    return success ? image.release() : NULL;
+}
+
+
+/// A pair of files of the job, and the result of its comparison
+struct DIFF_TASK
+{
+    bool        m_read;         // false if a file could not be read
+    bool        m_identical;
+    wxString    m_imageFilename;
+    GERBER_DIFF m_diff;
+
+    DIFF_TASK( int aResolution ) :
+        m_read( false ),
+        m_identical( false ),
+        m_diff( aResolution )
+    {
+    }
+};
+
+
+GERBER_DIFF_JOB::GERBER_DIFF_JOB( int aResolution ) :
+    m_resolution( aResolution ),
+    m_diffCount( 0 )
+{
+}
+
+
+void GERBER_DIFF_JOB::AddFiles( const wxString& aReference, const wxString& aCompared )
+{
+    FILE_PAIR pair;
+
+    pair.m_reference = aReference;
+    pair.m_compared = aCompared;
+    m_files.push_back( pair );
+}
+
+
+bool GERBER_DIFF_JOB::Run( REPORTER* aReporter )
+{
+    wxString msg;
+
+    std::vector<std::unique_ptr<DIFF_TASK>> tasks;
+
+    for( size_t ii = 0; ii < m_files.size(); ++ii )
+        tasks.emplace_back( new DIFF_TASK( m_resolution ) );
+
+    // The numbers are read with the C locale
+    PARALLEL_TASKS::Run( tasks.size(), [&]( size_t i )
+    {
+        DIFF_TASK& task = *tasks[i];
+        std::unique_ptr<GERBER_FILE_IMAGE> reference( loadImage( m_files[i].m_reference ) );
+        std::unique_ptr<GERBER_FILE_IMAGE> compared( loadImage( m_files[i].m_compared ) );
+
+        if( !reference || !compared )
+            return;
+
+        task.m_read = true;
+        task.m_identical = task.m_diff.Compare( reference.get(), compared.get() );
+
+        if( !task.m_identical && !m_imageDirectory.IsEmpty() )
+        {
+            wxFileName fn( m_files[i].m_reference );
+            fn.SetPath( m_imageDirectory );
+            fn.SetExt( wxT( "png" ) );
+
+            if( task.m_diff.WriteDiffImage( fn.GetFullPath() ) )
+                task.m_imageFilename = fn.GetFullPath();
+        }
+    }, true );
+
+    // Print the results, in the order of the files
+    const double iuPerMm2 = IU_PER_MM * IU_PER_MM;
+    m_diffCount = 0;
+
+    for( size_t ii = 0; ii < tasks.size(); ++ii )
+    {
+        const DIFF_TASK& task = *tasks[ii];
+        wxString filename = wxFileName( m_files[ii].m_reference ).GetFullName();
+
+        if( !task.m_identical )
+            m_diffCount++;
+
+        if( !aReporter )
+            continue;
+
+        if( !task.m_read )
+        {
+            msg.Printf( _( "Unable to read \"%s\" or \"%s\"." ),
+                        GetChars( m_files[ii].m_reference ), GetChars( m_files[ii].m_compared ) );
+            aReporter->Report( msg, REPORTER::RPT_ERROR );
+            continue;
+        }
+
+        if( task.m_identical )
+        {
+            msg.Printf( _( "%s: identical." ), GetChars( filename ) );
+            aReporter->Report( msg, REPORTER::RPT_INFO );
+            continue;
+        }
+
+        const std::vector<GERBER_DIFF_REGION>& regions = task.m_diff.GetRegions();
+
+        msg.Printf( _( "%s: %d differences, %.4f mm2." ), GetChars( filename ),
+                    (int) regions.size(), task.m_diff.GetDiffArea() / iuPerMm2 );
+        aReporter->Report( msg, REPORTER::RPT_WARNING );
+
+        // The Y axis of the draw coordinates is top to bottom: the positions are
+        // given in gerber coordinates
+        for( const GERBER_DIFF_REGION& region : regions )
+        {
+            VECTOR2I centre = region.m_BBox.Centre();
+
+            msg.Printf( _( "  %s at X %.4f Y %.4f mm, size %.4f x %.4f mm, area %.4f mm2" ),
+                        region.m_Missing ? _( "missing" ) : _( "extra" ),
+                        Iu2Millimeter( centre.x ), -Iu2Millimeter( centre.y ),
+                        Iu2Millimeter( region.m_BBox.GetWidth() ),
+                        Iu2Millimeter( region.m_BBox.GetHeight() ),
+                        region.m_Area / iuPerMm2 );
+            aReporter->Report( msg, REPORTER::RPT_WARNING );
+        }
+
+        if( !task.m_imageFilename.IsEmpty() )
+        {
+            msg.Printf( _( "  Diff image \"%s\" created." ), GetChars( task.m_imageFilename ) );
+            aReporter->Report( msg, REPORTER::RPT_ACTION );
+        }
+    }
+
+    return m_diffCount == 0;
+}
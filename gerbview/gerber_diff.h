@@ -0,0 +1,173 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file gerber_diff.h
+ */
+
+#ifndef GERBER_DIFF_H
+#define GERBER_DIFF_H
+
+#include <vector>
+
+#include <wx/string.h>
+#include <math/box2.h>
+#include <geometry/shape_poly_set.h>
+
+class GERBER_FILE_IMAGE;
+class REPORTER;
+
+
+/**
+ * Struct GERBER_DIFF_REGION
+ * is a region drawn by only one of two compared images.
+ */
+struct GERBER_DIFF_REGION
+{
+    bool   m_Missing;       ///< true if the region is drawn only by the reference image,
+                            ///< false if it is drawn only by the compared image
+    double m_Area;          ///< area of the region, in square internal units
+    BOX2I  m_BBox;          ///< bounding box of the region, in draw (A,B) coordinates
+};
+
+
+/**
+ * Class GERBER_DIFF
+ * compares the shapes drawn by two gerber (or drill) images.
+ *
+ * The items of each image are converted to polygons and merged, the negative items
+ * being removed from the items drawn before them.  Then each shape is subtracted from
+ * the other one.  The differences narrower than the resolution are ignored, so the
+ * rounding differences between two plots of the same board are not reported.
+ */
+class GERBER_DIFF
+{
+public:
+    /**
+     * @param aResolution = the width of the smallest difference to report, and the
+     * size of the pixels of the diff image, in internal units
+     */
+    GERBER_DIFF( int aResolution );
+
+    /**
+     * Function Compare
+     * compares the shapes of aCompared to the shapes of aReference.
+     * Two images can be compared by each thread, if an image is used by one thread only.
+     * @return true if the images draw the same shapes, at the resolution
+     */
+    bool Compare( GERBER_FILE_IMAGE* aReference, GERBER_FILE_IMAGE* aCompared );
+
+    /**
+     * @return the differences found by the last Compare(), the regions missing in the
+     * compared image first
+     */
+    const std::vector<GERBER_DIFF_REGION>& GetRegions() const { return m_regions; }
+
+    /**
+     * @return the total area of the differences, in square internal units
+     */
+    double GetDiffArea() const;
+
+    /**
+     * Function WriteDiffImage
+     * writes a PNG image of the last compared images: the shapes drawn by both images
+     * are gray, the shapes missing in the compared image are red, and the shapes drawn
+     * only by the compared image are green.
+     * A PNG image handler must be installed (see wxImage::AddHandler()).
+     * @return true if the file was written
+     */
+    bool WriteDiffImage( const wxString& aFullFileName ) const;
+
+    /**
+     * Function BuildImageShape
+     * converts all the items of aImage to polygons, and merges them in aShape
+     * (in draw (A,B) coordinates)
+     */
+    static void BuildImageShape( GERBER_FILE_IMAGE* aImage, SHAPE_POLY_SET& aShape );
+
+private:
+    int            m_resolution;
+    SHAPE_POLY_SET m_reference;     ///< the shape of the reference image
+    SHAPE_POLY_SET m_compared;      ///< the shape of the compared image
+    SHAPE_POLY_SET m_missing;       ///< the shapes drawn only by the reference image
+    SHAPE_POLY_SET m_extra;         ///< the shapes drawn only by the compared image
+
+    std::vector<GERBER_DIFF_REGION> m_regions;
+};
+
+
+/**
+ * Compares pairs of gerber or drill files in one go, for instance the fabrication
+ * files of a board plotted by two versions of KiCad.
+ *
+ * Each pair of files is read and compared by a worker thread of a pool.
+ */
+class GERBER_DIFF_JOB
+{
+public:
+    /**
+     * @param aResolution = the width of the smallest difference to report, in internal units
+     */
+    GERBER_DIFF_JOB( int aResolution );
+
+    /**
+     * Function AddFiles
+     * adds a pair of files to compare.  The files having the drill file extension are
+     * read as Excellon files
+     */
+    void AddFiles( const wxString& aReference, const wxString& aCompared );
+
+    /**
+     * Write a PNG diff image of each pair of files having differences in aDirectory
+     * (no image if empty).  The image is named like the reference file, with a png extension
+     */
+    void SetDiffImageDirectory( const wxString& aDirectory ) { m_imageDirectory = aDirectory; }
+
+    /**
+     * Compares all the pairs of files.  Must be called from the main thread.
+     * @param aReporter receives the differences of each pair, in the order the pairs
+     * were added (can be NULL)
+     * @return true if all the files were read and have no difference
+     */
+    bool Run( REPORTER* aReporter = NULL );
+
+    /**
+     * @return the count of pairs of files which have differences, or which could not
+     * be read, in the last Run()
+     */
+    int GetDiffCount() const { return m_diffCount; }
+
+private:
+    struct FILE_PAIR
+    {
+        wxString m_reference;
+        wxString m_compared;
+    };
+
+    int                    m_resolution;
+    wxString               m_imageDirectory;
+    std::vector<FILE_PAIR> m_files;
+    int                    m_diffCount;
+};
+
+#endif  // GERBER_DIFF_H
@@ -55,6 +55,7 @@ GERBER_DRAW_ITEM::GERBER_DRAW_ITEM( GERBER_FILE_IMAGE* aGerberImageFile ) :
     m_mirrorB       = false;
     m_drawScale.x   = m_drawScale.y = 1.0;
     m_lyrRotation   = 0;
+    m_imageIndex    = -1;
 
     if( m_GerberImageFile )
         SetLayerParameters();
@@ -359,8 +360,9 @@ const EDA_RECT GERBER_DRAW_ITEM::GetBoundingBox() const
     {
         if( code )
         {
-            // Update the shape drawings and the bounding box coordiantes:
-            code->GetMacro()->GetApertureMacroShape( this, m_Start );
+            // Update the bounding box coordinates (the shape itself is cached):
+            VECTOR2I offset;
+            code->GetMacro()->GetCachedShape( this, m_Start, offset );
             // now the bounding box is valid:
             bbox = code->GetMacro()->GetBoundingBox();
         }
@@ -660,6 +662,132 @@ void GERBER_DRAW_ITEM::ConvertSegmentToPolygon()
 }
 
 
+void GERBER_DRAW_ITEM::TransformShapeToPolygon( SHAPE_POLY_SET& aCornerBuffer,
+                                                int aCircleToSegmentsCount )
+{
+    D_CODE*        code = GetDcodeDescr();
+    SHAPE_POLY_SET shape;       // The shape in X,Y coordinates
+
+    switch( m_Shape )
+    {
+    case GBR_POLYGON:
+        shape = m_Polygon;
+        break;
+
+    case GBR_CIRCLE:
+        TransformRingToPolygon( shape, m_Start, KiROUND( GetLineLength( m_Start, m_End ) ),
+                                aCircleToSegmentsCount, m_Size.x );
+        break;
+
+    case GBR_ARC:
+    {
+        // Arcs are counter-clockwise from m_Start to m_End, in X,Y coordinates
+        // (see GERBVIEW_PAINTER::draw()).  360 degrees arcs have m_Start == m_End
+        double angle = 3600;
+
+        if( m_Start != m_End )
+        {
+            wxPoint start = m_Start - m_ArcCentre;
+            wxPoint end = m_End - m_ArcCentre;
+
+            angle = ArcTangente( end.y, end.x ) - ArcTangente( start.y, start.x );
+
+            if( angle <= 0 )
+                angle += 3600;
+        }
+
+        TransformArcToPolygon( shape, m_ArcCentre, m_Start, angle,
+                               aCircleToSegmentsCount, m_Size.x );
+        break;
+    }
+
+    case GBR_SEGMENT:
+        if( code && code->m_Shape == APT_RECT )
+        {
+            if( m_Polygon.OutlineCount() == 0 )
+                ConvertSegmentToPolygon();
+
+            shape = m_Polygon;
+        }
+        else
+        {
+            TransformRoundedEndsSegmentToPolygon( shape, m_Start, m_End,
+                                                  aCircleToSegmentsCount, m_Size.x );
+        }
+        break;
+
+    case GBR_SPOT_MACRO:
+    {
+        if( !code )
+            return;
+
+        // Aperture macro shapes are already in A,B coordinates
+        VECTOR2I offset;
+        SHAPE_POLY_SET macroShape = code->GetMacro()->GetCachedShape( this, m_Start, offset );
+
+        macroShape.Move( offset );
+        aCornerBuffer.Append( macroShape );
+        return;
+    }
+
+    case GBR_SPOT_CIRCLE:
+    case GBR_SPOT_RECT:
+    case GBR_SPOT_OVAL:
+    case GBR_SPOT_POLY:
+        if( !code )
+            return;
+
+        if( m_Shape == GBR_SPOT_CIRCLE && code->m_DrillShape == APT_DEF_NO_HOLE )
+        {
+            TransformCircleToPolygon( shape, m_Start, code->m_Size.x / 2,
+                                      aCircleToSegmentsCount );
+        }
+        else if( m_Shape == GBR_SPOT_RECT && code->m_DrillShape == APT_DEF_NO_HOLE )
+        {
+            wxPoint corner = m_Start - wxPoint( code->m_Size.x / 2, code->m_Size.y / 2 );
+
+            shape.NewOutline();
+            shape.Append( VECTOR2I( corner ) );
+            shape.Append( VECTOR2I( corner.x + code->m_Size.x, corner.y ) );
+            shape.Append( VECTOR2I( corner.x + code->m_Size.x, corner.y + code->m_Size.y ) );
+            shape.Append( VECTOR2I( corner.x, corner.y + code->m_Size.y ) );
+        }
+        else if( m_Shape == GBR_SPOT_OVAL && code->m_DrillShape == APT_DEF_NO_HOLE )
+        {
+            wxPoint delta;
+            int     width = std::min( code->m_Size.x, code->m_Size.y );
+
+            if( code->m_Size.x > code->m_Size.y )   // horizontal oval
+                delta.x = ( code->m_Size.x - code->m_Size.y ) / 2;
+            else                                    // vertical oval
+                delta.y = ( code->m_Size.y - code->m_Size.x ) / 2;
+
+            TransformRoundedEndsSegmentToPolygon( shape, m_Start - delta, m_Start + delta,
+                                                  aCircleToSegmentsCount, width );
+        }
+        else
+        {
+            // Polygons and shapes with holes
+            if( code->m_Polygon.OutlineCount() == 0 )
+                code->ConvertShapeToPolygon();
+
+            shape = code->m_Polygon;
+            shape.Move( VECTOR2I( m_Start ) );
+        }
+        break;
+
+    default:
+        wxASSERT_MSG( false, wxT( "GERBER_DRAW_ITEM shape is unknown!" ) );
+        return;
+    }
+
+    for( auto it = shape.IterateWithHoles(); it; ++it )
+        *it = GetABPosition( *it );
+
+    aCornerBuffer.Append( shape );
+}
+
+
 void GERBER_DRAW_ITEM::DrawGbrPoly( EDA_RECT*      aClipBox,
                                     wxDC*          aDC,
                                     COLOR4D        aColor,
@@ -855,15 +983,19 @@ bool GERBER_DRAW_ITEM::HitTest( const wxPoint& aRefPos ) const
         }
 
     case GBR_SPOT_MACRO:
-        // Aperture macro polygons are already in absolute coordinates
-        auto p = GetDcodeDescr()->GetMacro()->GetApertureMacroShape( this, m_Start );
-        for( int i = 0; i < p->OutlineCount(); ++i )
+    {
+        // Aperture macro polygons are in absolute coordinates, once moved by offset
+        VECTOR2I offset;
+        const SHAPE_POLY_SET& p = GetDcodeDescr()->GetMacro()->GetCachedShape( this, m_Start,
+                                                                                offset );
+        for( int i = 0; i < p.OutlineCount(); ++i )
         {
-            if( p->Contains( VECTOR2I( aRefPos ), i ) )
+            if( p.Contains( VECTOR2I( aRefPos ) - offset, i ) )
                 return true;
         }
         return false;
     }
+    }
 
     // TODO: a better analyze of the shape (perhaps create a D_CODE::HitTest for flashed items)
     int radius = std::min( m_Size.x, m_Size.y ) >> 1;
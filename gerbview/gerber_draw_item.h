@@ -67,12 +67,8 @@ enum Gbr_Basic_Shapes {
 
 class GERBER_DRAW_ITEM : public EDA_ITEM
 {
-    // make SetNext() and SetBack() private so that they may not be called from anywhere.
-    // list management is done on GERBER_DRAW_ITEMs using DLIST<GERBER_DRAW_ITEM> only.
-private:
-    void SetNext( EDA_ITEM* aNext )       { Pnext = aNext; }
-    void SetBack( EDA_ITEM* aBack )       { Pback = aBack; }
-
+    // The items of a gerber image are stored in a compact form by GERBER_PRIMITIVE_STORE
+    friend class GERBER_PRIMITIVE_STORE;
 
 public:
     bool    m_UnitsMetric;                  /* store here the gerber units (inch/mm).  Used
@@ -113,13 +109,19 @@ private:
     GBR_NETLIST_METADATA m_netAttributes;   ///< the string given by a %TO attribute set in aperture
                                             ///< (dcode). Stored in each item, because %TO is
                                             ///< a dynamic object attribute
+    int         m_imageIndex;               ///< index of the item in the primitives of its image
+                                            ///< (set when loaded from the image), or -1
 
 public:
     GERBER_DRAW_ITEM( GERBER_FILE_IMAGE* aGerberparams );
     ~GERBER_DRAW_ITEM();
 
-    GERBER_DRAW_ITEM* Next() const { return static_cast<GERBER_DRAW_ITEM*>( Pnext ); }
-    GERBER_DRAW_ITEM* Back() const { return static_cast<GERBER_DRAW_ITEM*>( Pback ); }
+    /**
+     * Function GetImageIndex
+     * @return the index of the item in its GERBER_FILE_IMAGE, if the item was loaded
+     * from the image, or -1
+     */
+    int GetImageIndex() const { return m_imageIndex; }
 
     void SetNetAttributes( const GBR_NETLIST_METADATA& aNetAttributes );
     const GBR_NETLIST_METADATA& GetNetAttributes() const { return m_netAttributes; }
@@ -243,6 +245,16 @@ public:
      */
     void ConvertSegmentToPolygon();
 
+    /**
+     * Function TransformShapeToPolygon
+     * appends to aCornerBuffer the shape of the item, as drawn in filled mode.
+     * The polygons are in draw (A,B) coordinates, like GetABPosition().
+     * Arcs and circles are approximated by segments.
+     * @param aCornerBuffer = the buffer to store the polygons
+     * @param aCircleToSegmentsCount = the number of segments to approximate a circle
+     */
+    void TransformShapeToPolygon( SHAPE_POLY_SET& aCornerBuffer, int aCircleToSegmentsCount );
+
     /**
      * Function DrawGbrPoly
      * a helper function used to draw the polygon stored in m_PolyCorners
@@ -284,28 +296,6 @@ public:
         return wxT( "GERBER_DRAW_ITEM" );
     }
 
-    /**
-     * Function UnLink
-     * detaches this object from its owner.
-     */
-    void UnLink()
-    {
-        DLIST<GERBER_DRAW_ITEM>* list = (DLIST<GERBER_DRAW_ITEM>*) GetList();
-        wxASSERT( list );
-
-        if( list )
-            list->Remove( this );
-    }
-
-    /**
-     * Function DeleteStructure
-     * deletes this object after UnLink()ing it from its owner.
-     */
-    void DeleteStructure()
-    {
-        UnLink();
-        delete this;
-    }
 #if defined(DEBUG)
     void Show( int nestLevel, std::ostream& os ) const override;
 #endif
@@ -32,11 +32,13 @@
 #include <class_drawpanel.h>
 #include <macros.h>
 #include <convert_to_biu.h>
+#include <trigo.h>
 
 #include <gerbview.h>
 #include <gerbview_frame.h>
 #include <gerber_file_image.h>
 #include <X2_gerber_attributes.h>
+#include <view/view.h>
 
 #include <algorithm>
 #include <map>
@@ -89,6 +91,75 @@ void GERBER_LAYER::ResetDefaultValues()
 }
 
 
+/* A run holds at most MAX_RUN_LENGTH primitives: the runs are the items culled by the
+ * VIEW, so they must not cover too large areas of large images
+ */
+static const unsigned MAX_RUN_LENGTH = 1000;
+
+
+GERBER_PRIMITIVE_RUN::GERBER_PRIMITIVE_RUN( GERBER_FILE_IMAGE* aImage, unsigned aFirst ) :
+    EDA_ITEM( (EDA_ITEM*)NULL, GERBER_PRIMITIVE_RUN_T )
+{
+    m_image  = aImage;
+    m_first  = aFirst;
+    m_count  = 0;
+    m_shapes = 0;
+    m_dcodeTextSize = 0;
+}
+
+
+bool GERBER_PRIMITIVE_RUN::GetLayerPolarity() const
+{
+    return m_image->GetPrimitives().GetLayerPolarity( m_first );
+}
+
+
+const GBR_NETLIST_METADATA& GERBER_PRIMITIVE_RUN::GetNetAttributes() const
+{
+    return m_image->GetPrimitives().GetNetAttributes( m_first );
+}
+
+
+D_CODE* GERBER_PRIMITIVE_RUN::GetDcodeDescr() const
+{
+    int dcode = m_image->GetPrimitives().GetDCode( m_first );
+
+    if( dcode < FIRST_DCODE || dcode > LAST_DCODE )
+        return NULL;
+
+    return m_image->GetDCODE( dcode );
+}
+
+
+void GERBER_PRIMITIVE_RUN::ViewGetLayers( int aLayers[], int& aCount ) const
+{
+    aCount = 2;
+
+    aLayers[0] = GERBER_DRAW_LAYER( m_image->m_GraphicLayer );
+    aLayers[1] = GERBER_DCODE_LAYER( aLayers[0] );
+}
+
+
+const BOX2I GERBER_PRIMITIVE_RUN::ViewBBox() const
+{
+    return BOX2I( VECTOR2I( m_bbox.GetOrigin() ), VECTOR2I( m_bbox.GetSize() ) );
+}
+
+
+unsigned int GERBER_PRIMITIVE_RUN::ViewGetLOD( int aLayer, KIGFX::VIEW* aView ) const
+{
+    // DCodes are shown only if the zoom is large enough to read them on the largest
+    // primitive of the run (see GERBER_DRAW_ITEM::ViewGetLOD())
+    if( IsDCodeLayer( aLayer ) )
+    {
+        const int level = Millimeter2iu( 500 );
+        return ( level / ( m_dcodeTextSize + 1 ) );
+    }
+
+    return 0;
+}
+
+
 GERBER_FILE_IMAGE::GERBER_FILE_IMAGE( int aLayer ) :
     EDA_ITEM( (EDA_ITEM*)NULL, GERBER_IMAGE_T )
 {
@@ -108,7 +179,10 @@ GERBER_FILE_IMAGE::GERBER_FILE_IMAGE( int aLayer ) :
 
 GERBER_FILE_IMAGE::~GERBER_FILE_IMAGE()
 {
-    m_Drawings.DeleteAll();
+    // The runs and the items are deleted before the D_CODEs they use
+    m_runs.clear();
+    m_drawItems.clear();
+    m_regionItem.reset();
 
     for( unsigned ii = 0; ii < DIM( m_Aperture_List ); ii++ )
     {
@@ -118,13 +192,213 @@ GERBER_FILE_IMAGE::~GERBER_FILE_IMAGE()
     delete m_FileFunction;
 }
 
-/*
- * Function GetItemsList
- * returns the first GERBER_DRAW_ITEM * item of the items list
- */
-GERBER_DRAW_ITEM * GERBER_FILE_IMAGE::GetItemsList()
+void GERBER_FILE_IMAGE::AddItem( const GERBER_DRAW_ITEM& aItem )
+{
+    unsigned index = m_primitives.GetCount();
+    m_primitives.Append( aItem );
+
+    // Segments drawn with a rectangular aperture have their polygon (and therefore their
+    // bounding box) only once converted
+    EDA_RECT bbox;
+    D_CODE*  code = aItem.GetDcodeDescr();
+
+    if( aItem.m_Shape == GBR_SEGMENT && code && code->m_Shape == APT_RECT
+            && aItem.m_Polygon.OutlineCount() == 0 )
+    {
+        GERBER_DRAW_ITEM segment( aItem );
+        segment.ConvertSegmentToPolygon();
+        bbox = segment.GetBoundingBox();
+    }
+    else
+    {
+        bbox = aItem.GetBoundingBox();
+    }
+
+    // Start a new run if the item is not drawn with the color of the current run
+    GERBER_PRIMITIVE_RUN* run = m_runs.empty() ? NULL : m_runs.back().get();
+    bool newRun = !run || run->m_count >= MAX_RUN_LENGTH;
+
+    if( !newRun )
+    {
+        const GBR_NETLIST_METADATA& runAttributes = run->GetNetAttributes();
+        D_CODE* runCode = run->GetDcodeDescr();
+
+        if( run->GetLayerPolarity() != aItem.GetLayerPolarity() )
+            newRun = true;
+        else if( runAttributes.m_Netname != aItem.GetNetAttributes().m_Netname
+                 || runAttributes.m_Cmpref != aItem.GetNetAttributes().m_Cmpref )
+            newRun = true;
+        else if( runCode != code
+                 && ( runCode ? runCode->m_AperFunction : wxString() )
+                    != ( code ? code->m_AperFunction : wxString() ) )
+            newRun = true;
+    }
+
+    if( newRun )
+    {
+        m_runs.push_back( std::unique_ptr<GERBER_PRIMITIVE_RUN>(
+                new GERBER_PRIMITIVE_RUN( this, index ) ) );
+        run = m_runs.back().get();
+        run->m_bbox = bbox;
+    }
+    else
+    {
+        run->m_bbox.Merge( bbox );
+    }
+
+    int textSize;
+
+    switch( aItem.m_Shape )
+    {
+    case GBR_SPOT_MACRO:
+        textSize = bbox.GetWidth();
+        break;
+
+    case GBR_ARC:
+        textSize = GetLineLength( aItem.m_Start, aItem.m_ArcCentre );
+        break;
+
+    default:
+        textSize = aItem.m_Size.x;
+    }
+
+    run->m_count++;
+    run->m_shapes |= 1 << aItem.m_Shape;
+    run->m_dcodeTextSize = std::max( run->m_dcodeTextSize, textSize );
+
+    m_hasNegativeItems = -1;
+}
+
+
+GERBER_DRAW_ITEM* GERBER_FILE_IMAGE::GetItem( unsigned aIndex )
+{
+    std::unique_ptr<GERBER_DRAW_ITEM>& item = m_drawItems[aIndex];
+
+    if( !item )
+    {
+        item.reset( new GERBER_DRAW_ITEM( this ) );
+        LoadItem( aIndex, *item );
+    }
+
+    return item.get();
+}
+
+
+GERBER_DRAW_ITEM* GERBER_FILE_IMAGE::FindItem( unsigned aIndex ) const
+{
+    auto item = m_drawItems.find( aIndex );
+
+    return item != m_drawItems.end() ? item->second.get() : NULL;
+}
+
+
+void GERBER_FILE_IMAGE::SetItem( unsigned aIndex, const GERBER_DRAW_ITEM& aItem,
+                                 KIGFX::VIEW* aView )
+{
+    m_primitives.Replace( aIndex, aItem );
+
+    GERBER_DRAW_ITEM* item = FindItem( aIndex );
+
+    if( item )
+        LoadItem( aIndex, *item );
+
+    GERBER_PRIMITIVE_RUN* run = GetRun( aIndex );
+
+    if( run )
+    {
+        run->m_bbox.Merge( aItem.GetBoundingBox() );
+        run->m_shapes |= 1 << aItem.m_Shape;
+
+        // The run is cached by the view: redraw it, with its new bounding box
+        if( aView )
+            aView->Update( run, KIGFX::GEOMETRY );
+    }
+
+    m_hasNegativeItems = -1;
+}
+
+
+GERBER_PRIMITIVE_RUN* GERBER_FILE_IMAGE::GetRun( unsigned aIndex ) const
+{
+    if( aIndex >= GetItemsCount() )
+        return NULL;
+
+    // Find the last run starting before aIndex
+    auto run = std::upper_bound( m_runs.begin(), m_runs.end(), aIndex,
+            []( unsigned aIdx, const std::unique_ptr<GERBER_PRIMITIVE_RUN>& aRun )
+            {
+                return aIdx < aRun->m_first;
+            } );
+
+    if( run == m_runs.begin() )
+        return NULL;
+
+    return ( --run )->get();
+}
+
+
+void GERBER_FILE_IMAGE::HitTestItems( const wxPoint& aRefPos,
+                                      std::vector<GERBER_DRAW_ITEM*>& aItems )
+{
+    // Tiny items can be hit slightly outside of their bounding box
+    // (see GERBER_DRAW_ITEM::HitTest())
+    const int MIN_HIT_TEST_RADIUS = Millimeter2iu( 0.01 );
+
+    GERBER_DRAW_ITEM item( this );
+
+    for( const auto& run : m_runs )
+    {
+        EDA_RECT bbox = run->m_bbox;
+        bbox.Inflate( MIN_HIT_TEST_RADIUS );
+
+        if( !bbox.Contains( aRefPos ) )
+            continue;
+
+        for( unsigned ii = run->m_first; ii < run->m_first + run->m_count; ++ii )
+        {
+            LoadItem( ii, item );
+
+            if( item.HitTest( aRefPos ) )
+                aItems.push_back( GetItem( ii ) );
+        }
+    }
+}
+
+
+void GERBER_FILE_IMAGE::HitTestItems( const EDA_RECT& aRefArea,
+                                      std::vector<GERBER_DRAW_ITEM*>& aItems )
+{
+    GERBER_DRAW_ITEM item( this );
+
+    for( const auto& run : m_runs )
+    {
+        if( !run->m_bbox.Intersects( aRefArea ) )
+            continue;
+
+        for( unsigned ii = run->m_first; ii < run->m_first + run->m_count; ++ii )
+        {
+            LoadItem( ii, item );
+
+            if( item.GetBoundingBox().Intersects( aRefArea ) )
+                aItems.push_back( GetItem( ii ) );
+        }
+    }
+}
+
+
+const EDA_RECT GERBER_FILE_IMAGE::GetBoundingBox() const
 {
-    return m_Drawings;
+    EDA_RECT bbox;
+
+    for( unsigned ii = 0; ii < m_runs.size(); ++ii )
+    {
+        if( ii == 0 )
+            bbox = m_runs[ii]->m_bbox;
+        else
+            bbox.Merge( m_runs[ii]->m_bbox );
+    }
+
+    return bbox;
 }
 
 
@@ -246,11 +520,11 @@ bool GERBER_FILE_IMAGE::HasNegativeItems()
         else
         {
             m_hasNegativeItems = 0;
-            for( GERBER_DRAW_ITEM* item = GetItemsList(); item; item = item->Next() )
+
+            // The polarity is the same for all the items of a run
+            for( const auto& run : m_runs )
             {
-                if( item->GetLayer() != m_GraphicLayer )
-                    continue;
-                if( item->HasNegativeItems() )
+                if( run->GetLayerPolarity() )
                 {
                     m_hasNegativeItems = 1;
                     break;
@@ -314,14 +588,14 @@ void GERBER_FILE_IMAGE::StepAndRepeatItem( const GERBER_DRAW_ITEM& aItem )
             // create duplicate only if ii or jj > 0
             if( jj == 0 && ii == 0 )
                 continue;
-            GERBER_DRAW_ITEM* dupItem = new GERBER_DRAW_ITEM( aItem );
-            wxPoint           move_vector;
+            GERBER_DRAW_ITEM dupItem( aItem );
+            wxPoint          move_vector;
             move_vector.x = scaletoIU( ii * GetLayerParams().m_StepForRepeat.x,
                                    GetLayerParams().m_StepForRepeatMetric );
             move_vector.y = scaletoIU( jj * GetLayerParams().m_StepForRepeat.y,
                                    GetLayerParams().m_StepForRepeatMetric );
-            dupItem->MoveXY( move_vector );
-            m_Drawings.Append( dupItem );
+            dupItem.MoveXY( move_vector );
+            AddItem( dupItem );
         }
     }
 }
@@ -409,14 +683,32 @@ SEARCH_RESULT GERBER_FILE_IMAGE::Visit( INSPECTOR inspector, void* testData, con
         switch( stype )
         {
         case GERBER_IMAGE_T:
+            result = inspector( this, testData );
+            ++p;
+            break;
+
         case GERBER_IMAGE_LIST_T:
             ++p;
             break;
 
         case GERBER_DRAW_ITEM_T:
-            result = IterateForward( &m_Drawings[0], inspector, testData, p );
+        {
+            // The items are loaded one after the other in the same temporary item.
+            // An inspector keeping an item must keep GetItem( item->GetImageIndex() )
+            GERBER_DRAW_ITEM item( this );
+
+            for( unsigned ii = 0; ii < GetItemsCount(); ++ii )
+            {
+                LoadItem( ii, item );
+                result = inspector( &item, testData );
+
+                if( result == SEARCH_QUIT )
+                    break;
+            }
+
             ++p;
             break;
+        }
 
         default:        // catch EOT or ANY OTHER type here and return.
             done = true;
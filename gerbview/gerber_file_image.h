@@ -27,9 +27,12 @@
 
 #include <vector>
 #include <set>
+#include <map>
+#include <memory>
 
 #include <dcode.h>
 #include <gerber_draw_item.h>
+#include <gerber_primitive_store.h>
 #include <am_primitive.h>
 #include <gbr_netlist_metadata.h>
 
@@ -40,6 +43,11 @@
 class GERBVIEW_FRAME;
 class D_CODE;
 
+namespace KIGFX
+{
+    class VIEW;
+}
+
 /* gerber files have different parameters to define units and how items must be plotted.
  *  some are for the entire file, and other can change along a file.
  *  In Gerber world:
@@ -99,6 +107,71 @@ private:
     void ResetDefaultValues();
 };
 
+/**
+ * Class GERBER_PRIMITIVE_RUN
+ * is the VIEW item of a run of consecutive primitives of a gerber image.
+ *
+ * The primitives of a run have the same polarity, net attributes and aperture function,
+ * so they are drawn with the same color, and the colors of a run can be changed
+ * without redrawing it.  The length of a run is limited, to keep the view culling
+ * efficient on large images.
+ */
+class GERBER_PRIMITIVE_RUN : public EDA_ITEM
+{
+    friend class GERBER_FILE_IMAGE;
+
+public:
+    GERBER_PRIMITIVE_RUN( GERBER_FILE_IMAGE* aImage, unsigned aFirst );
+
+    wxString GetClass() const override
+    {
+        return wxT( "GERBER_PRIMITIVE_RUN" );
+    }
+
+    GERBER_FILE_IMAGE* GetImage() const { return m_image; }
+
+    /// @return the index of the first primitive of the run in its image
+    unsigned GetFirst() const { return m_first; }
+
+    /// @return the count of primitives in the run
+    unsigned GetCount() const { return m_count; }
+
+    /// @return true if at least one primitive of the run has the shape aShape
+    bool HasShape( int aShape ) const { return m_shapes & ( 1 << aShape ); }
+
+    bool GetLayerPolarity() const;
+
+    const GBR_NETLIST_METADATA& GetNetAttributes() const;
+
+    /// @return the D_CODE of the first primitive (the aperture function is the same
+    /// for all the primitives of the run), or NULL
+    D_CODE* GetDcodeDescr() const;
+
+    const EDA_RECT GetBoundingBox() const override { return m_bbox; }
+
+    /// @copydoc VIEW_ITEM::ViewGetLayers()
+    virtual void ViewGetLayers( int aLayers[], int& aCount ) const override;
+
+    /// @copydoc VIEW_ITEM::ViewBBox()
+    virtual const BOX2I ViewBBox() const override;
+
+    /// @copydoc VIEW_ITEM::ViewGetLOD()
+    virtual unsigned int ViewGetLOD( int aLayer, KIGFX::VIEW* aView ) const override;
+
+#if defined(DEBUG)
+    void Show( int nestLevel, std::ostream& os ) const override { ShowDummy( os ); }
+#endif
+
+private:
+    GERBER_FILE_IMAGE* m_image;
+    unsigned           m_first;
+    unsigned           m_count;
+    unsigned           m_shapes;        // a bit (1 << shape) for each shape used in the run
+    EDA_RECT           m_bbox;
+    int                m_dcodeTextSize; // size of the largest primitive, for the D_Code LOD
+};
+
+
 /**
  * Class GERBER_FILE_IMAGE
  * holds the Image data and parameters for one gerber file
@@ -111,9 +184,15 @@ class GERBER_FILE_IMAGE : public EDA_ITEM
 
     GERBER_LAYER       m_GBRLayerParams; // hold params for the current gerber layer
 
-public:
-    DLIST<GERBER_DRAW_ITEM> m_Drawings;                         // linked list of Gerber Items to draw
+    GERBER_PRIMITIVE_STORE m_primitives;                        ///< the items to draw, in a compact form
+
+    std::vector<std::unique_ptr<GERBER_PRIMITIVE_RUN>> m_runs;  ///< the VIEW items of m_primitives
 
+    std::map<unsigned, std::unique_ptr<GERBER_DRAW_ITEM>> m_drawItems;  ///< items given by GetItem()
+
+    std::unique_ptr<GERBER_DRAW_ITEM> m_regionItem;            ///< the region (G36 to G37) being read
+
+public:
     bool               m_InUse;                                 // true if this image is currently in use
                                                                 // (a file is loaded in it)
     bool               m_IsVisible;                             // true if the draw layer is visible and must be drawn
@@ -237,6 +316,13 @@ private:
     bool    Execute_G_Command( char*& text, int G_command );
     bool    Execute_DCODE_Command( char*& text, int D_command );
 
+    /**
+     * Function CloseRegion
+     * closes the outline of the region being read (if any) and adds the region
+     * to the items of the image
+     */
+    void    CloseRegion();
+
 public:
     GERBER_FILE_IMAGE( int layer );
     virtual ~GERBER_FILE_IMAGE();
@@ -269,10 +355,84 @@ public:
     COLOR4D GetPositiveDrawColor() const { return m_PositiveDrawColor; }
 
     /**
-     * Function GetItemsList
-     * @return the first GERBER_DRAW_ITEM * item of the items list
+     * @return the count of items (flashes, lines, arcs, regions) of the image
+     */
+    unsigned GetItemsCount() const { return m_primitives.GetCount(); }
+
+    /**
+     * Function AddItem
+     * adds a copy of aItem at the end of the items of the image
+     */
+    void AddItem( const GERBER_DRAW_ITEM& aItem );
+
+    /**
+     * Function LoadItem
+     * initializes aItem from the item aIndex of the image, without creating anything.
+     * Use it to read all the items of the image.
+     * @param aItem must be an item created for this image
+     */
+    void LoadItem( unsigned aIndex, GERBER_DRAW_ITEM& aItem ) const
+    {
+        m_primitives.Get( aIndex, aItem );
+    }
+
+    /**
+     * Function GetItem
+     * returns the item aIndex of the image as a GERBER_DRAW_ITEM owned by the image,
+     * created on the first call and valid until the image is deleted.
+     * Use it for the items that are selected or displayed in the message panel.
+     */
+    GERBER_DRAW_ITEM* GetItem( unsigned aIndex );
+
+    /**
+     * Function FindItem
+     * @return the item aIndex if it was created by GetItem(), or NULL
+     */
+    GERBER_DRAW_ITEM* FindItem( unsigned aIndex ) const;
+
+    /**
+     * @return the items created by GetItem(), sorted by index
      */
-    GERBER_DRAW_ITEM * GetItemsList();
+    const std::map<unsigned, std::unique_ptr<GERBER_DRAW_ITEM>>& GetCreatedItems() const
+    {
+        return m_drawItems;
+    }
+
+    /**
+     * Function SetItem
+     * replaces the item aIndex of the image by aItem (for instance once moved)
+     * @param aView is the view drawing the image, if any: the run of the item is
+     * updated in the view
+     */
+    void SetItem( unsigned aIndex, const GERBER_DRAW_ITEM& aItem, KIGFX::VIEW* aView );
+
+    /**
+     * Function GetRun
+     * @return the VIEW item drawing the item aIndex, or NULL
+     */
+    GERBER_PRIMITIVE_RUN* GetRun( unsigned aIndex ) const;
+
+    /**
+     * Function HitTestItems
+     * appends to aItems the items (given by GetItem()) hit by aRefPos
+     */
+    void HitTestItems( const wxPoint& aRefPos, std::vector<GERBER_DRAW_ITEM*>& aItems );
+
+    /**
+     * Function HitTestItems
+     * appends to aItems the items (given by GetItem()) having a bounding box
+     * intersecting aRefArea
+     */
+    void HitTestItems( const EDA_RECT& aRefArea, std::vector<GERBER_DRAW_ITEM*>& aItems );
+
+    const GERBER_PRIMITIVE_STORE& GetPrimitives() const { return m_primitives; }
+
+    /**
+     * @return the VIEW items drawing the image
+     */
+    const std::vector<std::unique_ptr<GERBER_PRIMITIVE_RUN>>& GetRuns() const { return m_runs; }
+
+    const EDA_RECT GetBoundingBox() const override;
 
     /**
      * Function GetLayerParams
@@ -0,0 +1,209 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file gerber_primitive_store.cpp
+ */
+
+#include <gerber_primitive_store.h>
+#include <gerber_draw_item.h>
+
+
+// Arcs and circles are the only primitives using the arc centre
+static bool hasArcCentre( int aShape )
+{
+    return aShape == GBR_ARC || aShape == GBR_CIRCLE;
+}
+
+
+bool GERBER_PRIMITIVE_STORE::PRIMITIVE_PARAMS::operator==( const PRIMITIVE_PARAMS& aOther ) const
+{
+    return m_swapAxis == aOther.m_swapAxis
+        && m_mirrorA == aOther.m_mirrorA
+        && m_mirrorB == aOther.m_mirrorB
+        && m_drawScale == aOther.m_drawScale
+        && m_layerOffset == aOther.m_layerOffset
+        && m_lyrRotation == aOther.m_lyrRotation
+        && m_netAttributes.m_NetAttribType == aOther.m_netAttributes.m_NetAttribType
+        && m_netAttributes.m_NotInNet == aOther.m_netAttributes.m_NotInNet
+        && m_netAttributes.m_Padname == aOther.m_netAttributes.m_Padname
+        && m_netAttributes.m_Cmpref == aOther.m_netAttributes.m_Cmpref
+        && m_netAttributes.m_Netname == aOther.m_netAttributes.m_Netname;
+}
+
+
+void GERBER_PRIMITIVE_STORE::Clear()
+{
+    m_shape.clear();
+    m_flags.clear();
+    m_dcode.clear();
+    m_start.clear();
+    m_end.clear();
+    m_size.clear();
+    m_paramsIndex.clear();
+    m_dataIndex.clear();
+
+    m_params.clear();
+    m_arcCentres.clear();
+    m_polygons.clear();
+}
+
+
+uint32_t GERBER_PRIMITIVE_STORE::paramsIndex( const GERBER_DRAW_ITEM& aItem )
+{
+    PRIMITIVE_PARAMS params;
+
+    params.m_swapAxis      = aItem.m_swapAxis;
+    params.m_mirrorA       = aItem.m_mirrorA;
+    params.m_mirrorB       = aItem.m_mirrorB;
+    params.m_drawScale     = aItem.m_drawScale;
+    params.m_layerOffset   = aItem.m_layerOffset;
+    params.m_lyrRotation   = aItem.m_lyrRotation;
+    params.m_netAttributes = aItem.m_netAttributes;
+
+    // The parameters change only with some gerber commands, so the parameters of
+    // a new primitive are usually the parameters of the previous one
+    if( m_params.empty() || !( m_params.back() == params ) )
+        m_params.push_back( params );
+
+    return m_params.size() - 1;
+}
+
+
+uint32_t GERBER_PRIMITIVE_STORE::dataIndex( const GERBER_DRAW_ITEM& aItem, uint32_t aPrevious )
+{
+    if( hasArcCentre( aItem.m_Shape ) )
+    {
+        if( aPrevious != NO_DATA )
+        {
+            m_arcCentres[aPrevious] = aItem.m_ArcCentre;
+            return aPrevious;
+        }
+
+        m_arcCentres.push_back( aItem.m_ArcCentre );
+        return m_arcCentres.size() - 1;
+    }
+
+    if( aItem.m_Polygon.OutlineCount() == 0 )
+        return NO_DATA;
+
+    if( aPrevious != NO_DATA )
+    {
+        m_polygons[aPrevious] = aItem.m_Polygon;
+        return aPrevious;
+    }
+
+    m_polygons.push_back( aItem.m_Polygon );
+    return m_polygons.size() - 1;
+}
+
+
+void GERBER_PRIMITIVE_STORE::Append( const GERBER_DRAW_ITEM& aItem )
+{
+    uint8_t flags = 0;
+
+    if( aItem.m_Flashed )
+        flags |= PRIMITIVE_FLASHED;
+
+    if( aItem.m_LayerNegative )
+        flags |= PRIMITIVE_NEGATIVE;
+
+    if( aItem.m_UnitsMetric )
+        flags |= PRIMITIVE_METRIC;
+
+    m_shape.push_back( aItem.m_Shape );
+    m_flags.push_back( flags );
+    m_dcode.push_back( aItem.m_DCode );
+    m_start.push_back( aItem.m_Start );
+    m_end.push_back( aItem.m_End );
+    m_size.push_back( aItem.m_Size );
+    m_paramsIndex.push_back( paramsIndex( aItem ) );
+    m_dataIndex.push_back( dataIndex( aItem, NO_DATA ) );
+}
+
+
+void GERBER_PRIMITIVE_STORE::Replace( unsigned aIndex, const GERBER_DRAW_ITEM& aItem )
+{
+    // The previous arc centre or polygon slot is reused only if it is the same kind of data
+    uint32_t previous = m_dataIndex[aIndex];
+
+    if( hasArcCentre( m_shape[aIndex] ) != hasArcCentre( aItem.m_Shape ) )
+        previous = NO_DATA;
+
+    uint8_t flags = 0;
+
+    if( aItem.m_Flashed )
+        flags |= PRIMITIVE_FLASHED;
+
+    if( aItem.m_LayerNegative )
+        flags |= PRIMITIVE_NEGATIVE;
+
+    if( aItem.m_UnitsMetric )
+        flags |= PRIMITIVE_METRIC;
+
+    m_shape[aIndex]       = aItem.m_Shape;
+    m_flags[aIndex]       = flags;
+    m_dcode[aIndex]       = aItem.m_DCode;
+    m_start[aIndex]       = aItem.m_Start;
+    m_end[aIndex]         = aItem.m_End;
+    m_size[aIndex]        = aItem.m_Size;
+    m_paramsIndex[aIndex] = paramsIndex( aItem );
+    m_dataIndex[aIndex]   = dataIndex( aItem, previous );
+}
+
+
+void GERBER_PRIMITIVE_STORE::Get( unsigned aIndex, GERBER_DRAW_ITEM& aItem ) const
+{
+    const PRIMITIVE_PARAMS& params = m_params[ m_paramsIndex[aIndex] ];
+    uint8_t                 flags = m_flags[aIndex];
+    uint32_t                data = m_dataIndex[aIndex];
+
+    aItem.m_Shape         = m_shape[aIndex];
+    aItem.m_Flashed       = flags & PRIMITIVE_FLASHED;
+    aItem.m_LayerNegative = flags & PRIMITIVE_NEGATIVE;
+    aItem.m_UnitsMetric   = flags & PRIMITIVE_METRIC;
+    aItem.m_DCode         = m_dcode[aIndex];
+    aItem.m_Start         = m_start[aIndex];
+    aItem.m_End           = m_end[aIndex];
+    aItem.m_Size          = m_size[aIndex];
+
+    aItem.m_swapAxis      = params.m_swapAxis;
+    aItem.m_mirrorA       = params.m_mirrorA;
+    aItem.m_mirrorB       = params.m_mirrorB;
+    aItem.m_drawScale     = params.m_drawScale;
+    aItem.m_layerOffset   = params.m_layerOffset;
+    aItem.m_lyrRotation   = params.m_lyrRotation;
+    aItem.m_netAttributes = params.m_netAttributes;
+    aItem.m_imageIndex    = aIndex;
+
+    aItem.m_ArcCentre = wxPoint( 0, 0 );
+    aItem.m_Polygon.RemoveAllContours();
+
+    if( data != NO_DATA )
+    {
+        if( hasArcCentre( aItem.m_Shape ) )
+            aItem.m_ArcCentre = m_arcCentres[data];
+        else
+            aItem.m_Polygon = m_polygons[data];
+    }
+}
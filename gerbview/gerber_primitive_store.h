@@ -0,0 +1,141 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file gerber_primitive_store.h
+ */
+
+#ifndef GERBER_PRIMITIVE_STORE_H
+#define GERBER_PRIMITIVE_STORE_H
+
+#include <cstdint>
+#include <vector>
+
+#include <wx/gdicmn.h>
+#include <gbr_netlist_metadata.h>
+#include <geometry/shape_poly_set.h>
+
+class GERBER_DRAW_ITEM;
+
+
+/**
+ * Class GERBER_PRIMITIVE_STORE
+ * stores the graphic primitives (lines, arcs, flashes, regions) of a gerber image.
+ *
+ * Large copper layers have millions of primitives, so they are not stored as
+ * GERBER_DRAW_ITEMs but column by column: shape, flags, D_Code, coordinates and size.
+ * The parameters that are the same for long runs of primitives (layer parameters
+ * and net attributes) are stored once, and each primitive keeps only their index.
+ * Arc centres and region outlines are stored apart, for the primitives needing them.
+ *
+ * A primitive is given back as a GERBER_DRAW_ITEM by Get(), when it must be drawn,
+ * selected or displayed.
+ */
+class GERBER_PRIMITIVE_STORE
+{
+public:
+    GERBER_PRIMITIVE_STORE() {}
+
+    void Clear();
+
+    unsigned GetCount() const { return m_shape.size(); }
+
+    bool IsEmpty() const { return m_shape.empty(); }
+
+    /**
+     * Function Append
+     * adds the primitive described by aItem at the end of the store
+     */
+    void Append( const GERBER_DRAW_ITEM& aItem );
+
+    /**
+     * Function Replace
+     * replaces the primitive aIndex by aItem (for instance after it was moved)
+     */
+    void Replace( unsigned aIndex, const GERBER_DRAW_ITEM& aItem );
+
+    /**
+     * Function Get
+     * initializes aItem from the primitive aIndex.
+     * aItem must be an item of the gerber image owning this store
+     */
+    void Get( unsigned aIndex, GERBER_DRAW_ITEM& aItem ) const;
+
+    int GetShape( unsigned aIndex ) const { return m_shape[aIndex]; }
+
+    int GetDCode( unsigned aIndex ) const { return m_dcode[aIndex]; }
+
+    bool GetLayerPolarity( unsigned aIndex ) const
+    {
+        return m_flags[aIndex] & PRIMITIVE_NEGATIVE;
+    }
+
+    const GBR_NETLIST_METADATA& GetNetAttributes( unsigned aIndex ) const
+    {
+        return m_params[ m_paramsIndex[aIndex] ].m_netAttributes;
+    }
+
+private:
+    enum PRIMITIVE_FLAGS
+    {
+        PRIMITIVE_FLASHED  = 1,
+        PRIMITIVE_NEGATIVE = 2,
+        PRIMITIVE_METRIC   = 4
+    };
+
+    /// Marks a primitive without arc centre or polygon
+    static const uint32_t NO_DATA = UINT32_MAX;
+
+    /// The parameters shared by runs of primitives
+    struct PRIMITIVE_PARAMS
+    {
+        bool                 m_swapAxis;
+        bool                 m_mirrorA;
+        bool                 m_mirrorB;
+        wxRealPoint          m_drawScale;
+        wxPoint              m_layerOffset;
+        double               m_lyrRotation;
+        GBR_NETLIST_METADATA m_netAttributes;
+
+        bool operator==( const PRIMITIVE_PARAMS& aOther ) const;
+    };
+
+    uint32_t paramsIndex( const GERBER_DRAW_ITEM& aItem );
+    uint32_t dataIndex( const GERBER_DRAW_ITEM& aItem, uint32_t aPrevious );
+
+    // One entry per primitive
+    std::vector<uint8_t>    m_shape;
+    std::vector<uint8_t>    m_flags;
+    std::vector<int16_t>    m_dcode;
+    std::vector<wxPoint>    m_start;
+    std::vector<wxPoint>    m_end;
+    std::vector<wxSize>     m_size;
+    std::vector<uint32_t>   m_paramsIndex;
+    std::vector<uint32_t>   m_dataIndex;    // in m_arcCentres for arcs, in m_polygons else
+
+    std::vector<PRIMITIVE_PARAMS> m_params;
+    std::vector<wxPoint>          m_arcCentres;
+    std::vector<SHAPE_POLY_SET>   m_polygons;
+};
+
+#endif  // GERBER_PRIMITIVE_STORE_H
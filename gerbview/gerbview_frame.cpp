@@ -35,6 +35,7 @@
 #include <bitmaps.h>
 #include <wildcards_and_files_ext.h>
 #include <eda_dockart.h>
+#include <confirm.h>
 
 #include <gerbview.h>
 #include <gerbview_frame.h>
@@ -296,24 +297,73 @@ bool GERBVIEW_FRAME::OpenProjectFiles( const std::vector<wxString>& aFileSet, in
         const unsigned limit = std::min( unsigned( aFileSet.size() ),
                                          unsigned( GERBER_DRAWLAYERS_COUNT ) );
 
+        // Try to guess the type of file by its ext
+        // if it is .drl (Kicad files), it is a drill file
+        wxArrayString gerberFiles;
+        wxArrayString drillFiles;
+
+        for( unsigned i = 0; i < limit; ++i )
+        {
+            wxString ext = wxFileName( aFileSet[i] ).GetExt();
+
+            if( ext == DrillFileExtension )     // In Excellon format
+                drillFiles.Add( aFileSet[i] );
+            else if( ext != GerberJobFileExtension )
+                gerberFiles.Add( aFileSet[i] );
+        }
+
+        // Read the Gerber and drill files at the same time, then load each file
+        // on the layer of its rank in the set
+        std::vector<GERBER_FILE_IMAGE*> gerberImages =
+                readFiles( gerberFiles, false, _( "Loading Gerber files..." ) );
+        std::vector<GERBER_FILE_IMAGE*> drillImages =
+                readFiles( drillFiles, true, _( "Loading drill files..." ) );
+        unsigned gerberIdx = 0;
+        unsigned drillIdx = 0;
+        int visibility = GetVisibleLayers();
         int layer = 0;
 
         for( unsigned i = 0; i < limit; ++i, ++layer )
         {
-            SetActiveLayer( layer );
+            SetActiveLayer( layer, false );
 
-            // Try to guess the type of file by its ext
-            // if it is .drl (Kicad files), it is a drill file
-            wxFileName fn( aFileSet[i] );
-            wxString ext = fn.GetExt();
+            wxString ext = wxFileName( aFileSet[i] ).GetExt();
 
-            if( ext == DrillFileExtension )     // In Excellon format
-                LoadExcellonFiles( aFileSet[i] );
-            else if( ext == GerberJobFileExtension )
+            if( ext == GerberJobFileExtension )
+            {
                 LoadGerberJobFile( aFileSet[i] );
+                continue;
+            }
+
+            bool isDrillFile = ext == DrillFileExtension;
+            GERBER_FILE_IMAGE* image = isDrillFile ? drillImages[drillIdx++]
+                                                   : gerberImages[gerberIdx++];
+
+            if( !image )
+            {
+                wxString msg;
+                msg.Printf( _( "File \"%s\" not found" ), GetChars( aFileSet[i] ) );
+                DisplayError( this, msg, 10 );
+                continue;
+            }
+
+            attachImage( image );
+            visibility |= ( 1 << layer );
+            m_lastFileName = aFileSet[i];
+
+            if( isDrillFile )
+                UpdateFileHistory( aFileSet[i], &m_drillFileHistory );
             else
-                LoadGerberFiles( aFileSet[i] );
+                UpdateFileHistory( aFileSet[i] );
         }
+
+        SetVisibleLayers( visibility );
+
+        // Synchronize layers tools with actual active layer:
+        ReFillLayerWidget();
+        SetActiveLayer( GetActiveLayer(), true );
+        m_LayersManager->UpdateLayerIcons();
+        syncLayerBox( true );
     }
 
     Zoom_Automatique( true );        // Zoom fit in frame
@@ -459,10 +509,10 @@ void GERBVIEW_FRAME::SetElementVisibility( int aLayerID, bool aNewState )
 
         view->UpdateAllItemsConditionally( KIGFX::REPAINT, []( KIGFX::VIEW_ITEM* aItem )
         {
-            auto item = static_cast<GERBER_DRAW_ITEM*>( aItem );
+            auto run = dynamic_cast<GERBER_PRIMITIVE_RUN*>( aItem );
 
             // GetLayerPolarity() returns true for negative items
-            return item->GetLayerPolarity();
+            return run && run->GetLayerPolarity();
         } );
         break;
     }
@@ -662,47 +712,30 @@ void GERBVIEW_FRAME::UpdateDisplayOptions( const GBR_DISPLAY_OPTIONS& aOptions )
     {
         view->UpdateAllItemsConditionally( KIGFX::REPAINT,
                                            []( KIGFX::VIEW_ITEM* aItem ) {
-            auto item = static_cast<GERBER_DRAW_ITEM*>( aItem );
+            auto run = dynamic_cast<GERBER_PRIMITIVE_RUN*>( aItem );
 
-            switch( item->m_Shape )
-            {
-            case GBR_SPOT_CIRCLE:
-            case GBR_SPOT_RECT:
-            case GBR_SPOT_OVAL:
-            case GBR_SPOT_POLY:
-            case GBR_SPOT_MACRO:
-                return true;
-
-            default:
-                return false;
-            }
+            return run && ( run->HasShape( GBR_SPOT_CIRCLE ) || run->HasShape( GBR_SPOT_RECT )
+                            || run->HasShape( GBR_SPOT_OVAL ) || run->HasShape( GBR_SPOT_POLY )
+                            || run->HasShape( GBR_SPOT_MACRO ) );
         } );
     }
     else if( update_lines )
     {
         view->UpdateAllItemsConditionally( KIGFX::REPAINT,
                                            []( KIGFX::VIEW_ITEM* aItem ) {
-            auto item = static_cast<GERBER_DRAW_ITEM*>( aItem );
+            auto run = dynamic_cast<GERBER_PRIMITIVE_RUN*>( aItem );
 
-            switch( item->m_Shape )
-            {
-            case GBR_CIRCLE:
-            case GBR_ARC:
-            case GBR_SEGMENT:
-                return true;
-
-            default:
-                return false;
-            }
+            return run && ( run->HasShape( GBR_CIRCLE ) || run->HasShape( GBR_ARC )
+                            || run->HasShape( GBR_SEGMENT ) );
         } );
     }
     else if( update_polygons )
     {
         view->UpdateAllItemsConditionally( KIGFX::REPAINT,
                                            []( KIGFX::VIEW_ITEM* aItem ) {
-            auto item = static_cast<GERBER_DRAW_ITEM*>( aItem );
+            auto run = dynamic_cast<GERBER_PRIMITIVE_RUN*>( aItem );
 
-            return ( item->m_Shape == GBR_POLYGON );
+            return run && run->HasShape( GBR_POLYGON );
         } );
     }
 
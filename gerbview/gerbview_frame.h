@@ -39,6 +39,8 @@
 #include <gbr_display_options.h>
 #include <colors_design_settings.h>
 
+#include <vector>
+
 extern COLORS_DESIGN_SETTINGS g_ColorsSettings;
 
 #define NO_AVAILABLE_LAYERS UNDEFINED_LAYER
@@ -219,6 +221,26 @@ private:
      */
     bool loadListOfGerberFiles( const wxString& aPath, const wxArrayString& aFilenameList );
 
+    /**
+     * Reads a list of Gerber or Excellon files, several files at the same time.
+     * Each file is read in its own image, not yet attached to a layer.
+     * A progress dialog is shown if the files take more than one second to read.
+     * @param aFullFilenames is the list of files to read
+     * @param aExcellon is true to read Excellon drill files, false to read Gerber files
+     * @param aProgressTitle is the title of the progress dialog
+     * @return the images, in the order of aFullFilenames (NULL for the files which
+     * cannot be opened)
+     */
+    std::vector<GERBER_FILE_IMAGE*> readFiles( const wxArrayString& aFullFilenames,
+                                               bool aExcellon, const wxString& aProgressTitle );
+
+    /**
+     * Attaches an image to the active layer, in place of the current image of this layer,
+     * and adds its items to the view.  The messages of the image, if any, are displayed.
+     * @param aImage is the image of a file, now owned by the image list
+     */
+    void attachImage( GERBER_FILE_IMAGE* aImage );
+
 public:
     GERBVIEW_FRAME( KIWAY* aKiway, wxWindow* aParent );
     ~GERBVIEW_FRAME();
@@ -99,10 +99,25 @@ const COLOR4D& GERBVIEW_RENDER_SETTINGS::GetColor( const VIEW_ITEM* aItem, int a
 {
     const EDA_ITEM* item = static_cast<const EDA_ITEM*>( aItem );
     static const COLOR4D transparent = COLOR4D( 0, 0, 0, 0 );
-    const GERBER_DRAW_ITEM* gbrItem = nullptr;
+    bool isNegative = false;
+    const GBR_NETLIST_METADATA* netAttributes = nullptr;
+    D_CODE* dcode = nullptr;
 
+    // The items of a run have the same polarity, net attributes and aperture function
     if( item && item->Type() == GERBER_DRAW_ITEM_T )
-        gbrItem = static_cast<const GERBER_DRAW_ITEM*>( item );
+    {
+        auto gbrItem = static_cast<const GERBER_DRAW_ITEM*>( item );
+        isNegative = gbrItem->GetLayerPolarity();
+        netAttributes = &gbrItem->GetNetAttributes();
+        dcode = gbrItem->GetDcodeDescr();
+    }
+    else if( item && item->Type() == GERBER_PRIMITIVE_RUN_T )
+    {
+        auto run = static_cast<const GERBER_PRIMITIVE_RUN*>( item );
+        isNegative = run->GetLayerPolarity();
+        netAttributes = &run->GetNetAttributes();
+        dcode = run->GetDcodeDescr();
+    }
 
     // All DCODE layers stored under a single color setting
     if( IsDCodeLayer( aLayer ) )
@@ -111,7 +126,7 @@ const COLOR4D& GERBVIEW_RENDER_SETTINGS::GetColor( const VIEW_ITEM* aItem, int a
     if( item && item->IsSelected() )
         return m_layerColorsSel[aLayer];
 
-    if( gbrItem && gbrItem->GetLayerPolarity() )
+    if( isNegative )
     {
         if( m_showNegativeItems )
             return m_layerColors[LAYER_NEGATIVE_OBJECTS];
@@ -119,16 +134,16 @@ const COLOR4D& GERBVIEW_RENDER_SETTINGS::GetColor( const VIEW_ITEM* aItem, int a
             return transparent;
     }
 
-    if( !m_netHighlightString.IsEmpty() && gbrItem &&
-        m_netHighlightString == gbrItem->GetNetAttributes().m_Netname )
+    if( !m_netHighlightString.IsEmpty() && netAttributes &&
+        m_netHighlightString == netAttributes->m_Netname )
         return m_layerColorsHi[aLayer];
 
-    if( !m_componentHighlightString.IsEmpty() && gbrItem &&
-        m_componentHighlightString == gbrItem->GetNetAttributes().m_Cmpref )
+    if( !m_componentHighlightString.IsEmpty() && netAttributes &&
+        m_componentHighlightString == netAttributes->m_Cmpref )
         return m_layerColorsHi[aLayer];
 
-    if( !m_attributeHighlightString.IsEmpty() && gbrItem && gbrItem->GetDcodeDescr() &&
-        m_attributeHighlightString == gbrItem->GetDcodeDescr()->m_AperFunction )
+    if( !m_attributeHighlightString.IsEmpty() && dcode &&
+        m_attributeHighlightString == dcode->m_AperFunction )
         return m_layerColorsHi[aLayer];
 
     // Return grayish color for non-highlighted layers in the high contrast mode
@@ -175,6 +190,10 @@ bool GERBVIEW_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
         draw( static_cast<GERBER_DRAW_ITEM*>( const_cast<EDA_ITEM*>( item ) ), aLayer );
         break;
 
+    case GERBER_PRIMITIVE_RUN_T:
+        draw( static_cast<const GERBER_PRIMITIVE_RUN*>( item ), aLayer );
+        break;
+
     default:
         // Painter does not know how to draw the object
         return false;
@@ -184,6 +203,34 @@ bool GERBVIEW_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 }
 
 
+void GERBVIEW_PAINTER::draw( const GERBER_PRIMITIVE_RUN* aRun, int aLayer )
+{
+    // The primitives are not stored as GERBER_DRAW_ITEMs: each one is loaded
+    // in the same item to be drawn
+    GERBER_FILE_IMAGE* image = aRun->GetImage();
+    GERBER_DRAW_ITEM   item( image );
+    unsigned           last = aRun->GetFirst() + aRun->GetCount();
+
+    // The selected and brightened items are drawn on the overlay, not by their run
+    const auto& created = image->GetCreatedItems();
+    auto        next = created.lower_bound( aRun->GetFirst() );
+
+    for( unsigned ii = aRun->GetFirst(); ii < last; ++ii )
+    {
+        if( next != created.end() && next->first == ii )
+        {
+            const GERBER_DRAW_ITEM* createdItem = ( next++ )->second.get();
+
+            if( createdItem->IsSelected() || createdItem->IsBrightened() )
+                continue;
+        }
+
+        image->LoadItem( ii, item );
+        draw( &item, aLayer );
+    }
+}
+
+
 // TODO(JE) aItem can't be const because of GetDcodeDescr()
 // Probably that can be refactored in GERBER_DRAW_ITEM to allow const here.
 void GERBVIEW_PAINTER::draw( /*const*/ GERBER_DRAW_ITEM* aItem, int aLayer )
@@ -544,18 +591,26 @@ void GERBVIEW_PAINTER::drawApertureMacro( GERBER_DRAW_ITEM* aParent, bool aFille
     D_CODE* code = aParent->GetDcodeDescr();
     APERTURE_MACRO* macro = code->GetMacro();
 
-    SHAPE_POLY_SET* macroShape = macro->GetApertureMacroShape( aParent, aParent->m_Start );
+    // The shape is shared by all the items flashed with this D_CODE: it is drawn
+    // moved to the item position, not copied
+    VECTOR2I offset;
+    const SHAPE_POLY_SET& macroShape = macro->GetCachedShape( aParent, aParent->m_Start, offset );
 
     if( !m_gerbviewSettings.m_polygonFill )
         m_gal->SetLineWidth( m_gerbviewSettings.m_outlineWidth );
 
+    m_gal->Save();
+    m_gal->Translate( VECTOR2D( offset ) );
+
     if( !aFilled )
     {
-        for( int i = 0; i < macroShape->OutlineCount(); i++ )
-            m_gal->DrawPolyline( macroShape->COutline( i ) );
+        for( int i = 0; i < macroShape.OutlineCount(); i++ )
+            m_gal->DrawPolyline( macroShape.COutline( i ) );
     }
     else
-        m_gal->DrawPolygon( *macroShape );
+        m_gal->DrawPolygon( macroShape );
+
+    m_gal->Restore();
 }
 
 
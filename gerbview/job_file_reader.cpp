@@ -41,7 +41,7 @@
 #include <html_messagebox.h>
 #include <view/view.h>
 
-#include "json11.hpp"   // A light JSON parser
+#include <json11.hpp>     // A light JSON parser
 
 /**
  * this class read and parse a Gerber job file to extract useful info
@@ -52,19 +52,16 @@ GERBER_DRAW_ITEM* GERBVIEW_FRAME::Locate( const wxPoint& aPosition, int aTypeloc
     GERBER_FILE_IMAGE* gerber = GetGbrImage( layer );
 
     GERBER_DRAW_ITEM* gerb_item = nullptr;
+    std::vector<GERBER_DRAW_ITEM*> items;
 
     // Search first on active layer
     // A not used graphic layer can be selected. So gerber can be NULL
     if( gerber && gerber->m_IsVisible )
     {
-        for( auto item = gerber->GetItemsList(); item; item = item->Next() )
-        {
-            if( item->HitTest( ref ) )
-            {
-                gerb_item = item;
-                break;
-            }
-        }
+        gerber->HitTestItems( ref, items );
+
+        if( !items.empty() )
+            gerb_item = items[0];
     }
 
     if( gerb_item == nullptr ) // Search on all layers
@@ -82,17 +79,13 @@ GERBER_DRAW_ITEM* GERBVIEW_FRAME::Locate( const wxPoint& aPosition, int aTypeloc
             if( layer == GetActiveLayer() )
                 continue;
 
-            for( auto item = gerber->GetItemsList(); item; item = item->Next() )
-            {
-                if( item->HitTest( ref ) )
-                {
-                    gerb_item = item;
-                    break;
-                }
-            }
+            gerber->HitTestItems( ref, items );
 
-            if( gerb_item )
+            if( !items.empty() )
+            {
+                gerb_item = items[0];
                 break;
+            }
         }
     }
 
@@ -30,6 +30,7 @@
 #include <gerbview_frame.h>
 #include <gerber_file_image.h>
 #include <gerber_file_image_list.h>
+#include <excellon_image.h>
 #include <view/view.h>
 
 #include <html_messagebox.h>
@@ -41,40 +42,48 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName )
 {
     wxString msg;
 
-    int layer = GetActiveLayer();
-    GERBER_FILE_IMAGE_LIST* images = GetImagesList();
-    GERBER_FILE_IMAGE* gerber = GetGbrImage( layer );
-
-    if( gerber != NULL )
-    {
-        Erase_Current_DrawLayer( false );
-    }
-
-    gerber = new GERBER_FILE_IMAGE( layer );
-    images->AddGbrImage( gerber, layer );
+    GERBER_FILE_IMAGE* gerber = new GERBER_FILE_IMAGE( GetActiveLayer() );
 
     /* Read the gerber file */
-    bool success = gerber->LoadGerberFile( GERBER_FullFileName );
-
-    if( !success )
+    if( !gerber->LoadGerberFile( GERBER_FullFileName ) )
     {
+        delete gerber;
         msg.Printf( _( "File \"%s\" not found" ), GetChars( GERBER_FullFileName ) );
         DisplayError( this, msg, 10 );
         return false;
     }
 
+    attachImage( gerber );
+
+    return true;
+}
+
+
+void GERBVIEW_FRAME::attachImage( GERBER_FILE_IMAGE* aImage )
+{
+    wxString msg;
+    int layer = GetActiveLayer();
+    EXCELLON_IMAGE* drill_layer = dynamic_cast<EXCELLON_IMAGE*>( aImage );
+
+    if( GetGbrImage( layer ) != NULL )
+        Erase_Current_DrawLayer( false );
+
+    aImage->m_GraphicLayer = layer;
+    GetImagesList()->AddGbrImage( aImage, layer );
+
     // Display errors list
-    if( gerber->GetMessages().size() > 0 )
+    if( aImage->GetMessages().size() > 0 )
     {
-        HTML_MESSAGE_BOX dlg( this, _("Errors") );
-        dlg.ListSet(gerber->GetMessages());
+        HTML_MESSAGE_BOX dlg( this, drill_layer ? _( "Error reading EXCELLON drill file" )
+                                                : _( "Errors" ) );
+        dlg.ListSet( aImage->GetMessages() );
         dlg.ShowModal();
     }
 
     /* if the gerber file is only a RS274D file
      * (i.e. without any aperture information, but with items), warn the user:
      */
-    if( !gerber->m_Has_DCode && gerber->GetItemsList() )
+    if( !drill_layer && !aImage->m_Has_DCode && aImage->GetItemsCount() )
     {
         msg = _("Warning: this file has no D-Code definition\n"
                 "It is perhaps an old RS274D file\n"
@@ -88,19 +97,15 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName )
     {
         auto view = canvas->GetView();
 
-        if( gerber->m_ImageNegative )
+        if( aImage->m_ImageNegative )
         {
             // TODO: find a way to handle negative images
             // (maybe convert geometry into positives?)
         }
 
-        for( auto item = gerber->GetItemsList(); item; item = item->Next() )
-        {
-            view->Add( (KIGFX::VIEW_ITEM*) item );
-        }
+        for( const auto& run : aImage->GetRuns() )
+            view->Add( run.get() );
     }
-
-    return true;
 }
 
 
@@ -108,8 +113,6 @@ bool GERBVIEW_FRAME::Read_GERBER_File( const wxString& GERBER_FullFileName )
 // size of a single line of text from a gerber file.
 // warning: some files can have *very long* lines, so the buffer must be large.
 #define GERBER_BUFZ 1000000
-// A large buffer to store one line
-static char lineBuffer[GERBER_BUFZ+1];
 
 bool GERBER_FILE_IMAGE::LoadGerberFile( const wxString& aFullFileName )
 {
@@ -117,6 +120,11 @@ bool GERBER_FILE_IMAGE::LoadGerberFile( const wxString& aFullFileName )
     int      D_commande = 0;       // command number for D commands like D02
     char*    text;
 
+    // A large buffer to store one line.  Each file has its own buffer, so several
+    // files can be read at the same time
+    std::vector<char> lineBufferStorage( GERBER_BUFZ + 1 );
+    char* lineBuffer = lineBufferStorage.data();
+
     ClearMessageList( );
     ResetDefaultValues();
 
@@ -216,6 +224,9 @@ bool GERBER_FILE_IMAGE::LoadGerberFile( const wxString& aFullFileName )
 
     fclose( m_Current_File );
 
+    // A region not closed by a G37 command is kept
+    CloseRegion();
+
     m_InUse = true;
 
     return true;
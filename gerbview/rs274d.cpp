@@ -141,8 +141,11 @@ void fillFlashedGBRITEM(  GERBER_DRAW_ITEM* aGbrItem,
     case APT_MACRO:
         aGbrItem->m_Shape = GBR_SPOT_MACRO;
 
-        // Cache the bounding box for aperture macros
-        aGbrItem->GetDcodeDescr()->GetMacro()->GetApertureMacroShape( aGbrItem, aPos );
+        // Build the shape of the aperture macro, cached in the D_CODE
+        {
+            VECTOR2I offset;
+            aGbrItem->GetDcodeDescr()->GetMacro()->GetCachedShape( aGbrItem, aPos, offset );
+        }
         break;
     }
 }
@@ -344,7 +347,7 @@ static void fillArcPOLY(  GERBER_DRAW_ITEM* aGbrItem,
     /* in order to calculate arc parameters, we use fillArcGBRITEM
      * so we muse create a dummy track and use its geometric parameters
      */
-    static GERBER_DRAW_ITEM dummyGbrItem( NULL );
+    GERBER_DRAW_ITEM dummyGbrItem( NULL );
 
     aGbrItem->SetLayerPolarity( aLayerNegative );
 
@@ -565,12 +568,9 @@ bool GERBER_FILE_IMAGE::Execute_G_Command( char*& text, int G_command )
         break;
 
     case GC_TURN_OFF_POLY_FILL:
-        if( m_Exposure && GetItemsList() )    // End of polygon
-        {
-            GERBER_DRAW_ITEM * gbritem = m_Drawings.GetLast();
-            gbritem->m_Polygon.Append( gbritem->m_Polygon.Vertex( 0 ) );
-            StepAndRepeatItem( *gbritem );
-        }
+        if( m_Exposure )    // End of polygon
+            CloseRegion();
+
         m_Exposure = false;
         m_PolygonFillMode = false;
         m_PolygonFillModeState = 0;
@@ -591,6 +591,20 @@ bool GERBER_FILE_IMAGE::Execute_G_Command( char*& text, int G_command )
 }
 
 
+void GERBER_FILE_IMAGE::CloseRegion()
+{
+    if( !m_regionItem )
+        return;
+
+    if( m_regionItem->m_Polygon.OutlineCount() > 0 )
+        m_regionItem->m_Polygon.Append( m_regionItem->m_Polygon.Vertex( 0 ) );
+
+    AddItem( *m_regionItem );
+    StepAndRepeatItem( *m_regionItem );
+    m_regionItem.reset();
+}
+
+
 bool GERBER_FILE_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
 {
     wxSize            size( 15, 15 );
@@ -627,20 +641,20 @@ bool GERBER_FILE_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
         switch( D_commande )
         {
         case 1:     // code D01 Draw line, exposure ON
-            if( !m_Exposure )   // Start a new polygon outline:
+            if( !m_Exposure || !m_regionItem )   // Start a new polygon outline:
             {
                 m_Exposure = true;
-                gbritem    = new GERBER_DRAW_ITEM( this );
-                m_Drawings.Append( gbritem );
-                gbritem->m_Shape = GBR_POLYGON;
-                gbritem->m_Flashed = false;
+                m_regionItem.reset( new GERBER_DRAW_ITEM( this ) );
+                m_regionItem->m_Shape = GBR_POLYGON;
+                m_regionItem->m_Flashed = false;
             }
 
+            gbritem = m_regionItem.get();
+
             switch( m_Iterpolation )
             {
             case GERB_INTERPOL_ARC_NEG:
             case GERB_INTERPOL_ARC_POS:
-                gbritem = m_Drawings.GetLast();
 
                 fillArcPOLY( gbritem, m_PreviousPos,
                              m_CurrentPos, m_IJPos,
@@ -649,8 +663,6 @@ bool GERBER_FILE_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
                 break;
 
             default:
-                gbritem = m_Drawings.GetLast();
-
                 gbritem->m_Start = m_PreviousPos;       // m_Start is used as temporary storage
                 if( gbritem->m_Polygon.OutlineCount() == 0 )
                 {
@@ -668,12 +680,9 @@ bool GERBER_FILE_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             break;
 
         case 2:     // code D2: exposure OFF (i.e. "move to")
-            if( m_Exposure && GetItemsList() )    // End of polygon
-            {
-                gbritem = m_Drawings.GetLast();
-                gbritem->m_Polygon.Append( gbritem->m_Polygon.Vertex( 0 ) );
-                StepAndRepeatItem( *gbritem );
-            }
+            if( m_Exposure )    // End of polygon
+                CloseRegion();
+
             m_Exposure    = false;
             m_PreviousPos = m_CurrentPos;
             m_PolygonFillModeState = 0;
@@ -701,13 +710,15 @@ bool GERBER_FILE_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             switch( m_Iterpolation )
             {
             case GERB_INTERPOL_LINEAR_1X:
-                gbritem = new GERBER_DRAW_ITEM( this );
-                m_Drawings.Append( gbritem );
+            {
+                GERBER_DRAW_ITEM item( this );
 
-                fillLineGBRITEM( gbritem, dcode, m_PreviousPos,
+                fillLineGBRITEM( &item, dcode, m_PreviousPos,
                                  m_CurrentPos, size, GetLayerParams().m_LayerNegative );
-                StepAndRepeatItem( *gbritem );
+                AddItem( item );
+                StepAndRepeatItem( item );
                 break;
+            }
 
             case GERB_INTERPOL_LINEAR_01X:
             case GERB_INTERPOL_LINEAR_001X:
@@ -717,15 +728,17 @@ bool GERBER_FILE_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
 
             case GERB_INTERPOL_ARC_NEG:
             case GERB_INTERPOL_ARC_POS:
-                gbritem = new GERBER_DRAW_ITEM( this );
-                m_Drawings.Append( gbritem );
+            {
+                GERBER_DRAW_ITEM item( this );
 
-                fillArcGBRITEM( gbritem, dcode, m_PreviousPos,
+                fillArcGBRITEM( &item, dcode, m_PreviousPos,
                                 m_CurrentPos, m_IJPos, size,
                                 ( m_Iterpolation == GERB_INTERPOL_ARC_NEG ) ?
                                 false : true, m_360Arc_enbl, GetLayerParams().m_LayerNegative );
-                StepAndRepeatItem( *gbritem );
+                AddItem( item );
+                StepAndRepeatItem( item );
                 break;
+            }
 
             default:
                 msg.Printf( wxT( "RS274D: DCODE Command: interpol error (type %X)" ),
@@ -743,6 +756,7 @@ bool GERBER_FILE_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
             break;
 
         case 3:     // code D3: flash aperture
+        {
             tool = GetDCODE( m_Current_Tool );
             if( tool )
             {
@@ -751,13 +765,15 @@ bool GERBER_FILE_IMAGE::Execute_DCODE_Command( char*& text, int D_commande )
                 aperture = tool->m_Shape;
             }
 
-            gbritem = new GERBER_DRAW_ITEM( this );
-            m_Drawings.Append( gbritem );
-            fillFlashedGBRITEM( gbritem, aperture, dcode, m_CurrentPos,
+            GERBER_DRAW_ITEM item( this );
+
+            fillFlashedGBRITEM( &item, aperture, dcode, m_CurrentPos,
                                 size, GetLayerParams().m_LayerNegative );
-            StepAndRepeatItem( *gbritem );
+            AddItem( item );
+            StepAndRepeatItem( item );
             m_PreviousPos = m_CurrentPos;
             break;
+        }
 
         default:
             return false;
@@ -27,6 +27,8 @@ using namespace std::placeholders;
 #include <bitmaps.h>
 
 #include <gerber_collectors.h>
+#include <gerber_file_image.h>
+#include <gerber_file_image_list.h>
 
 #include <class_draw_panel_gal.h>
 #include <view/view.h>
@@ -396,13 +398,9 @@ bool GERBVIEW_SELECTION_TOOL::selectMultiple()
             view->SetVisible( &area, false );
 
             // Mark items within the selection box as selected
-            std::vector<KIGFX::VIEW::LAYER_ITEM_PAIR> selectedItems;
+            std::vector<GERBER_DRAW_ITEM*> selectedItems;
 
-            // Filter the view items based on the selection box
             BOX2I selectionBox = area.ViewBBox();
-            view->Query( selectionBox, selectedItems );         // Get the list of selected items
-
-            std::vector<KIGFX::VIEW::LAYER_ITEM_PAIR>::iterator it, it_end;
 
             int width = area.GetEnd().x - area.GetOrigin().x;
             int height = area.GetEnd().y - area.GetOrigin().y;
@@ -413,10 +411,20 @@ bool GERBVIEW_SELECTION_TOOL::selectMultiple()
 
             selectionRect.Normalize();
 
-            for( it = selectedItems.begin(), it_end = selectedItems.end(); it != it_end; ++it )
+            // The items are not in the view (the view draws runs of items), so they are
+            // found by the images, based on the selection box
+            GERBER_FILE_IMAGE_LIST* images = m_frame->GetGerberLayout()->GetImagesList();
+
+            for( unsigned layer = 0; layer < images->ImagesMaxCount(); ++layer )
             {
-                auto item = static_cast<GERBER_DRAW_ITEM*>( it->first );
+                GERBER_FILE_IMAGE* gerber = images->GetGbrImage( layer );
+
+                if( gerber )
+                    gerber->HitTestItems( selectionRect, selectedItems );
+            }
 
+            for( auto item : selectedItems )
+            {
                 if( !item || !selectable( item ) )
                     continue;
 
@@ -648,7 +656,7 @@ EDA_ITEM* GERBVIEW_SELECTION_TOOL::disambiguationMenu( GERBER_COLLECTOR* aCollec
             if( current )
             {
                 current->ClearBrightened();
-                getView()->Hide( current, false );
+                updateItemRun( current );
                 highlightGroup.Remove( current );
                 getView()->MarkTargetDirty( KIGFX::TARGET_OVERLAY );
             }
@@ -660,7 +668,7 @@ EDA_ITEM* GERBVIEW_SELECTION_TOOL::disambiguationMenu( GERBER_COLLECTOR* aCollec
             {
                 current = ( *aCollector )[id - 1];
                 current->SetBrightened();
-                getView()->Hide( current, true );
+                updateItemRun( current );
                 highlightGroup.Add( current );
                 getView()->MarkTargetDirty( KIGFX::TARGET_OVERLAY );
             }
@@ -686,7 +694,7 @@ EDA_ITEM* GERBVIEW_SELECTION_TOOL::disambiguationMenu( GERBER_COLLECTOR* aCollec
     if( current && current->IsBrightened() )
     {
         current->ClearBrightened();
-        getView()->Hide( current, false );
+        updateItemRun( current );
         getView()->MarkTargetDirty( KIGFX::TARGET_OVERLAY );
     }
 
@@ -760,7 +768,7 @@ void GERBVIEW_SELECTION_TOOL::selectVisually( EDA_ITEM* aItem )
 
     // Hide the original item, so it is shown only on overlay
     aItem->SetSelected();
-    getView()->Hide( aItem, true );
+    updateItemRun( aItem );
 
     getView()->Update( &m_selection );
 }
@@ -770,13 +778,28 @@ void GERBVIEW_SELECTION_TOOL::unselectVisually( EDA_ITEM* aItem )
 {
     // Restore original item visibility
     aItem->ClearSelected();
-    getView()->Hide( aItem, false );
-    getView()->Update( aItem, KIGFX::ALL );
+    updateItemRun( aItem );
 
     getView()->Update( &m_selection );
 }
 
 
+void GERBVIEW_SELECTION_TOOL::updateItemRun( EDA_ITEM* aItem )
+{
+    // The items are not in the view: they are drawn by a run of their image, which
+    // skips the selected and brightened items
+    auto item = static_cast<GERBER_DRAW_ITEM*>( aItem );
+
+    if( item->GetImageIndex() < 0 )
+        return;
+
+    GERBER_PRIMITIVE_RUN* run = item->m_GerberImageFile->GetRun( item->GetImageIndex() );
+
+    if( run )
+        getView()->Update( run, KIGFX::REPAINT );
+}
+
+
 bool GERBVIEW_SELECTION_TOOL::selectionContains( const VECTOR2I& aPoint ) const
 {
     const unsigned GRIP_MARGIN = 20;
@@ -206,6 +206,14 @@ private:
      */
     void unselectVisually( EDA_ITEM* aItem );
 
+    /**
+     * Function updateItemRun()
+     * Redraws the run of primitives drawing an item, after its selected or brightened
+     * state was changed.
+     * @param aItem is the item.
+     */
+    void updateItemRun( EDA_ITEM* aItem );
+
     /**
      * Function selectionContains()
      * Checks if the given point is placed within any of selected items' bounding box.
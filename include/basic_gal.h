@@ -31,6 +31,8 @@
 #include <gal/graphics_abstraction_layer.h>
 #include <newstroke_font.h>
 
+#include <mutex>
+
 class PLOTTER;
 
 
@@ -167,4 +169,8 @@ private:
 
 extern BASIC_GAL basic_gal;
 
+// basic_gal keeps the current text attributes: hold this lock while using them, texts
+// can be plotted from several threads
+extern std::mutex basic_gal_mutex;
+
 #endif      // define BASIC_GAL_H
@@ -0,0 +1,351 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#ifdef KICAD_ARENA_STATS
+#include <atomic>
+#endif
+
+/**
+ * Struct ARENA_STATS
+ *
+ * Allocation counters, only maintained in builds configured with KICAD_ARENA_STATS.
+ * They let us compare how many allocations a job serves from arenas versus the heap.
+ */
+struct ARENA_STATS
+{
+    size_t heapAllocs   = 0;    ///< allocations made by ARENA_ALLOCATOR outside an arena
+    size_t arenaAllocs  = 0;    ///< allocations served from an arena
+    size_t arenaBytes   = 0;    ///< bytes handed out by arenas
+    size_t arenaBlocks  = 0;    ///< blocks requested from the heap by arenas
+};
+
+
+/**
+ * Class MONOTONIC_ARENA
+ *
+ * A bump-pointer allocator for short-lived data.  Memory is carved from large blocks
+ * and never returned individually: everything is freed at once by Release() or by
+ * the destructor.  An arena is not thread safe; use one per worker thread.
+ *
+ * Containers pick up an arena through ARENA_ALLOCATOR, which binds to the arena made
+ * current on the calling thread by ARENA_SCOPE.
+ */
+class MONOTONIC_ARENA
+{
+public:
+    MONOTONIC_ARENA( size_t aBlockSize = 64 * 1024 ) :
+        m_blocks( nullptr ),
+        m_cursor( nullptr ),
+        m_end( nullptr ),
+        m_blockSize( aBlockSize )
+    {
+    }
+
+    ~MONOTONIC_ARENA()
+    {
+        freeBlocks( nullptr );
+    }
+
+    MONOTONIC_ARENA( const MONOTONIC_ARENA& ) = delete;
+    MONOTONIC_ARENA& operator=( const MONOTONIC_ARENA& ) = delete;
+
+    void* Allocate( size_t aSize, size_t aAlign = alignof( std::max_align_t ) )
+    {
+        uintptr_t p = ( reinterpret_cast<uintptr_t>( m_cursor ) + aAlign - 1 ) & ~( aAlign - 1 );
+
+        if( !m_cursor || p + aSize > reinterpret_cast<uintptr_t>( m_end ) )
+        {
+            newBlock( aSize + aAlign );
+            p = ( reinterpret_cast<uintptr_t>( m_cursor ) + aAlign - 1 ) & ~( aAlign - 1 );
+        }
+
+        m_cursor = reinterpret_cast<char*>( p + aSize );
+
+#ifdef KICAD_ARENA_STATS
+        Stats().arenaAllocs++;
+        Stats().arenaBytes += aSize;
+#endif
+
+        return reinterpret_cast<void*>( p );
+    }
+
+    /**
+     * Function Release
+     * frees all memory handed out by the arena at once.  The first block is kept
+     * so the arena can be reused for the next job without touching the heap.
+     * Nothing allocated from the arena may be used afterwards.
+     */
+    void Release()
+    {
+        if( !m_blocks )
+            return;
+
+        BLOCK* first = m_blocks;
+
+        while( first->next )
+            first = first->next;
+
+        freeBlocks( first );
+
+        m_blocks = first;
+        m_cursor = reinterpret_cast<char*>( first + 1 );
+        m_end    = m_cursor + first->size;
+    }
+
+    /**
+     * Function Current
+     * returns the arena made current on the calling thread by ARENA_SCOPE, or
+     * nullptr if there is none.
+     */
+    static MONOTONIC_ARENA*& Current()
+    {
+        static thread_local MONOTONIC_ARENA* s_current = nullptr;
+        return s_current;
+    }
+
+#ifdef KICAD_ARENA_STATS
+    struct ATOMIC_STATS
+    {
+        std::atomic<size_t> heapAllocs{ 0 };
+        std::atomic<size_t> arenaAllocs{ 0 };
+        std::atomic<size_t> arenaBytes{ 0 };
+        std::atomic<size_t> arenaBlocks{ 0 };
+    };
+
+    static ATOMIC_STATS& Stats()
+    {
+        static ATOMIC_STATS s_stats;
+        return s_stats;
+    }
+#endif
+
+    /**
+     * Function GetStats
+     * returns a snapshot of the process-wide allocation counters.  All counters are
+     * zero unless KiCad was built with KICAD_ARENA_STATS.
+     */
+    static ARENA_STATS GetStats()
+    {
+        ARENA_STATS stats;
+#ifdef KICAD_ARENA_STATS
+        stats.heapAllocs  = Stats().heapAllocs;
+        stats.arenaAllocs = Stats().arenaAllocs;
+        stats.arenaBytes  = Stats().arenaBytes;
+        stats.arenaBlocks = Stats().arenaBlocks;
+#endif
+        return stats;
+    }
+
+private:
+    struct alignas( std::max_align_t ) BLOCK
+    {
+        BLOCK* next;
+        size_t size;
+    };
+
+    void newBlock( size_t aMinSize )
+    {
+        size_t size  = std::max( m_blockSize, aMinSize );
+        BLOCK* block = static_cast<BLOCK*>( ::operator new( sizeof( BLOCK ) + size ) );
+
+        block->next = m_blocks;
+        block->size = size;
+        m_blocks = block;
+        m_cursor = reinterpret_cast<char*>( block + 1 );
+        m_end    = m_cursor + size;
+
+#ifdef KICAD_ARENA_STATS
+        Stats().arenaBlocks++;
+#endif
+    }
+
+    void freeBlocks( BLOCK* aKeep )
+    {
+        while( m_blocks && m_blocks != aKeep )
+        {
+            BLOCK* next = m_blocks->next;
+            ::operator delete( m_blocks );
+            m_blocks = next;
+        }
+
+        if( !aKeep )
+        {
+            m_cursor = nullptr;
+            m_end = nullptr;
+        }
+    }
+
+    BLOCK*  m_blocks;       ///< most recently allocated block first
+    char*   m_cursor;
+    char*   m_end;
+    size_t  m_blockSize;
+};
+
+
+/**
+ * Class ARENA_SCOPE
+ *
+ * Makes an arena current on the calling thread for the lifetime of the scope.
+ * Scopes nest; the previous arena is restored on exit.
+ *
+ * Every container that captures the arena while the scope is active (see
+ * ARENA_ALLOCATOR) must be destroyed, or copied into storage created outside the
+ * scope, before the arena is released.
+ */
+class ARENA_SCOPE
+{
+public:
+    ARENA_SCOPE( MONOTONIC_ARENA& aArena ) :
+        m_previous( MONOTONIC_ARENA::Current() )
+    {
+        MONOTONIC_ARENA::Current() = &aArena;
+    }
+
+    ~ARENA_SCOPE()
+    {
+        MONOTONIC_ARENA::Current() = m_previous;
+    }
+
+    ARENA_SCOPE( const ARENA_SCOPE& ) = delete;
+    ARENA_SCOPE& operator=( const ARENA_SCOPE& ) = delete;
+
+private:
+    MONOTONIC_ARENA* m_previous;
+};
+
+
+/**
+ * Class ARENA_ALLOCATOR
+ *
+ * A standard allocator in the spirit of std::pmr::polymorphic_allocator (which is
+ * not available in C++11).  It binds to the thread's current arena when constructed
+ * (and when a container is copy-constructed) and falls back to the heap otherwise.
+ * Deallocating arena memory is a no-op.
+ *
+ * The allocator never propagates on assignment or swap: a long-lived container must not
+ * take memory of an arena which is released before it.  Assigning a container of another
+ * arena copies or moves its elements; swapping containers of different arenas is not
+ * allowed (see SwapArenaContainers()).
+ */
+template <typename T>
+class ARENA_ALLOCATOR
+{
+public:
+    typedef T value_type;
+    typedef std::false_type propagate_on_container_copy_assignment;
+    typedef std::false_type propagate_on_container_move_assignment;
+    typedef std::false_type propagate_on_container_swap;
+
+    ARENA_ALLOCATOR() :
+        m_arena( MONOTONIC_ARENA::Current() )
+    {
+    }
+
+    explicit ARENA_ALLOCATOR( MONOTONIC_ARENA* aArena ) :
+        m_arena( aArena )
+    {
+    }
+
+    template <typename U>
+    ARENA_ALLOCATOR( const ARENA_ALLOCATOR<U>& aOther ) :
+        m_arena( aOther.Arena() )
+    {
+    }
+
+    T* allocate( size_t aCount )
+    {
+        if( m_arena )
+            return static_cast<T*>( m_arena->Allocate( aCount * sizeof( T ), alignof( T ) ) );
+
+#ifdef KICAD_ARENA_STATS
+        MONOTONIC_ARENA::Stats().heapAllocs++;
+#endif
+
+        return static_cast<T*>( ::operator new( aCount * sizeof( T ) ) );
+    }
+
+    void deallocate( T* aPtr, size_t aCount )
+    {
+        if( !m_arena )
+            ::operator delete( aPtr );
+    }
+
+    ARENA_ALLOCATOR select_on_container_copy_construction() const
+    {
+        return ARENA_ALLOCATOR();
+    }
+
+    MONOTONIC_ARENA* Arena() const
+    {
+        return m_arena;
+    }
+
+    template <typename U>
+    bool operator==( const ARENA_ALLOCATOR<U>& aOther ) const
+    {
+        return m_arena == aOther.Arena();
+    }
+
+    template <typename U>
+    bool operator!=( const ARENA_ALLOCATOR<U>& aOther ) const
+    {
+        return m_arena != aOther.Arena();
+    }
+
+private:
+    MONOTONIC_ARENA* m_arena;
+};
+
+
+/**
+ * Swaps two containers using an ARENA_ALLOCATOR.  The containers keep their allocators:
+ * if they do not use the same arena, their elements are exchanged by moves, as swapping
+ * the storage of containers of different arenas is undefined behaviour.
+ */
+template <typename CONTAINER>
+void SwapArenaContainers( CONTAINER& aFirst, CONTAINER& aSecond )
+{
+    if( aFirst.get_allocator() == aSecond.get_allocator() )
+    {
+        aFirst.swap( aSecond );
+        return;
+    }
+
+    typename CONTAINER::allocator_type firstAllocator = aFirst.get_allocator();
+    CONTAINER tmp( std::move( aFirst ), firstAllocator );
+
+    aFirst = std::move( aSecond );
+    aSecond = std::move( tmp );
+}
+
+#endif // __ARENA_H
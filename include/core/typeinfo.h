@@ -164,6 +164,7 @@ enum KICAD_T
     GERBER_DRAW_ITEM_T,
     GERBER_IMAGE_LIST_T,
     GERBER_IMAGE_T,
+    GERBER_PRIMITIVE_RUN_T,
 
     /*
      * for Pl_Editor, in undo/redo commands
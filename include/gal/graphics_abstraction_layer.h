@@ -46,6 +46,28 @@ class BITMAP_BASE;
 namespace KIGFX
 {
 
+/**
+ * @brief Statistics of the memory used to cache groups, see GAL::GetCacheStatistics().
+ *
+ * Sizes are expressed in bytes.
+ */
+struct GAL_CACHE_STATISTICS
+{
+    size_t capacity = 0;            ///< size of the cache
+    size_t used = 0;                ///< memory used by stored groups
+    size_t freeChunks = 0;          ///< number of free memory fragments
+    size_t largestFreeChunk = 0;    ///< size of the largest free fragment
+    size_t uploadedLastFrame = 0;   ///< data transferred to the cache during the last frame
+
+    /// Returns 0 if the free space is contiguous, and tends to 1 as it gets fragmented
+    double Fragmentation() const
+    {
+        size_t freeSpace = capacity - used;
+        return freeSpace > 0 ? 1.0 - (double) largestFreeChunk / freeSpace : 0.0;
+    }
+};
+
+
 /**
  * @brief Class GAL is the abstract interface for drawing on a 2D-surface.
  *
@@ -595,6 +617,33 @@ public:
      */
     virtual void ClearCache() {};
 
+    /**
+     * @brief Create a GAL that records groups in memory instead of caching them for drawing.
+     *
+     * A recorder needs neither a window nor a graphics context, so it may be used by a worker
+     * thread to generate the geometry of cached items. Recorded groups are transferred to this
+     * GAL with UploadGroup().
+     *
+     * @return a new recorder owned by the caller or nullptr if the backend cannot record groups.
+     */
+    virtual GAL* CreateGroupRecorder() { return nullptr; };
+
+    /**
+     * @brief Create a group containing the geometry of a group stored by a recorder.
+     *
+     * @param aRecorder is a GAL obtained with CreateGroupRecorder().
+     * @param aRecordedGroup is the group number returned by the recorder's BeginGroup().
+     * @return the number of the new group.
+     */
+    virtual int UploadGroup( GAL* aRecorder, int aRecordedGroup ) { return -1; };
+
+    /**
+     * @brief Return statistics of the memory used to cache groups.
+     *
+     * All values are zero if the backend does not keep cached groups in a dedicated memory.
+     */
+    virtual GAL_CACHE_STATISTICS GetCacheStatistics() const { return GAL_CACHE_STATISTICS(); };
+
     // --------------------------------------------------------
     // Handling the world <-> screen transformation
     // --------------------------------------------------------
@@ -602,6 +651,14 @@ public:
     /// @brief Compute the world <-> screen transformation matrix
     virtual void ComputeWorldScreenMatrix();
 
+    /**
+     * @brief Copy the world <-> screen transformation and the related settings (screen size,
+     * zoom, flipping, depth range) from another GAL.
+     *
+     * @param aOther is the GAL to take the settings from.
+     */
+    void CopyViewSettings( const GAL& aOther );
+
     /**
      * @brief Get the world <-> screen transformation matrix.
      *
@@ -27,12 +27,12 @@
 
 #include <gal/opengl/vertex_container.h>
 #include <map>
-#include <set>
 
 namespace KIGFX
 {
 class VERTEX_ITEM;
 class SHADER;
+struct GAL_CACHE_STATISTICS;
 
 /**
  * @brief Class to store VERTEX instances with caching. It associates VERTEX
@@ -82,17 +82,49 @@ public:
     ///> @copydoc VERTEX_CONTAINER::Unmap()
     virtual void Unmap() override = 0;
 
+    /**
+     * Moves items stored at the end of the container to free chunks closer to its beginning.
+     * It is meant to be called after every update, so the container is defragmented
+     * progressively instead of being copied at once when it runs out of continuous space.
+     * The container has to be mapped.
+     *
+     * @param aMaxVertices is the maximal number of vertices to be moved.
+     */
+    void Compact( unsigned int aMaxVertices );
+
+    /**
+     * Fills the memory usage statistics.
+     * @param aStats is the structure to be filled.
+     */
+    void GetStatistics( GAL_CACHE_STATISTICS& aStats ) const;
+
+    /**
+     * Marks the end of a frame for the statistics of uploaded data.
+     */
+    void FinishFrame()
+    {
+        m_uploadedLastFrame = m_uploadedBytes;
+        m_uploadedBytes = 0;
+    }
+
 protected:
     ///> Maps size of free memory chunks to their offsets
     typedef std::pair<unsigned int, unsigned int> CHUNK;
     typedef std::multimap<unsigned int, unsigned int> FREE_CHUNK_MAP;
 
-    /// List of all the stored items
-    typedef std::set<VERTEX_ITEM*> ITEMS;
+    ///> Maps offsets of free memory chunks to their sizes
+    typedef std::map<unsigned int, unsigned int> FREE_CHUNK_OFFSETS;
+
+    /// Stored items, indexed by their offsets
+    typedef std::map<unsigned int, VERTEX_ITEM*> ITEMS;
 
-    ///> Stores size & offset of free chunks.
+    ///> Stores size & offset of free chunks. Being sorted by size, it serves to find
+    ///> the smallest chunk that fits a request.
     FREE_CHUNK_MAP  m_freeChunks;
 
+    ///> Stores offset & size of free chunks, used to merge adjacent chunks.
+    FREE_CHUNK_OFFSETS m_freeChunkOffsets;
+
     ///> Stored VERTEX_ITEMs
     ITEMS m_items;
 
@@ -106,6 +138,10 @@ protected:
     ///> Maximal vertex index number stored in the container
     unsigned int m_maxIndex;
 
+    ///> Amount of data transferred to the GPU in the current and the last frame (in bytes)
+    size_t m_uploadedBytes;
+    size_t m_uploadedLastFrame;
+
     /**
      * Resizes the chunk that stores the current item to the given size. The current item has
      * its offset adjusted after the call, and the new chunk parameters are stored
@@ -133,10 +169,12 @@ protected:
     void defragment( VERTEX* aTarget );
 
     /**
-     * Looks for consecutive free memory chunks and merges them, decreasing fragmentation of
-     * memory.
+     * Updates the item offsets after they have been moved to continuous space at the beginning
+     * of a container of a new size.
+     *
+     * @param aNewSize is the new size of the container, expressed in number of vertices.
      */
-    void mergeFreeChunks();
+    void finishDefragmentation( unsigned int aNewSize );
 
     /**
      * Returns the size of a chunk.
@@ -159,10 +197,28 @@ protected:
     }
 
     /**
-     * Adds a chunk marked as a free space.
+     * Adds a chunk marked as a free space. It is merged with the adjacent free chunks.
      */
     void addFreeChunk( unsigned int aOffset, unsigned int aSize );
 
+    /**
+     * Removes a chunk from the free chunk maps. It does not update the free space counter.
+     */
+    void removeFreeChunk( unsigned int aOffset, unsigned int aSize );
+
+    /**
+     * Updates m_maxIndex after items were removed or moved.
+     */
+    void updateMaxIndex();
+
+    /**
+     * Returns the range of vertices modified since the previous call, limited to the used part
+     * of the container.
+     * @param aOffset is set to the offset of the first modified vertex.
+     * @return Number of modified vertices, 0 if there are none.
+     */
+    unsigned int takeDirtyRange( unsigned int& aOffset );
+
 private:
     /// Debug & test functions
     void showFreeChunks();
@@ -69,6 +69,9 @@ protected:
     ///> Handle to vertices buffer
     GLuint  m_verticesBuffer;
 
+    ///> Size of the vertices buffer, expressed in vertices
+    unsigned int m_bufferSize;
+
     /**
      * Defragments the currently stored data and resizes the buffer.
      * @param aNewSize is the new buffer vertex buffer size, expressed as the number of vertices.
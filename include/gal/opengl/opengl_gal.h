@@ -30,7 +30,7 @@
 #define OPENGLGAL_H_
 
 // GAL imports
-#include <gal/graphics_abstraction_layer.h>
+#include <gal/opengl/opengl_geometry_gal.h>
 #include <gal/gal_display_options.h>
 #include <gal/opengl/shader.h>
 #include <gal/opengl/vertex_manager.h>
@@ -41,15 +41,8 @@
 #include <gal/hidpi_gl_canvas.h>
 
 #include <unordered_map>
-#include <boost/smart_ptr/shared_array.hpp>
 #include <memory>
 
-#ifndef CALLBACK
-#define CALLBACK
-#endif
-
-struct bitmap_glyph;
-
 namespace KIGFX
 {
 class SHADER;
@@ -61,8 +54,10 @@ class GL_BITMAP_CACHE;
  * This is a direct OpenGL-implementation and uses low-level graphics primitives like triangles
  * and quads. The purpose is to provide a fast graphics interface, that takes advantage of modern
  * graphics card GPUs. All methods here benefit thus from the hardware acceleration.
+ *
+ * Drawing primitives are tessellated by OPENGL_GEOMETRY_GAL.
  */
-class OPENGL_GAL : public GAL, public HIDPI_GL_CANVAS
+class OPENGL_GAL : public OPENGL_GEOMETRY_GAL, public HIDPI_GL_CANVAS
 {
 public:
     /**
@@ -115,48 +110,9 @@ public:
     /// @copydoc GAL::EndUpdate()
     virtual void EndUpdate() override;
 
-    /// @copydoc GAL::DrawLine()
-    virtual void DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
-
-    /// @copydoc GAL::DrawSegment()
-    virtual void DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
-                              double aWidth ) override;
-
-    /// @copydoc GAL::DrawCircle()
-    virtual void DrawCircle( const VECTOR2D& aCenterPoint, double aRadius ) override;
-
-    /// @copydoc GAL::DrawArc()
-    virtual void DrawArc( const VECTOR2D& aCenterPoint, double aRadius,
-                          double aStartAngle, double aEndAngle ) override;
-
-    /// @copydoc GAL::DrawArcSegment()
-    virtual void DrawArcSegment( const VECTOR2D& aCenterPoint, double aRadius,
-                                 double aStartAngle, double aEndAngle, double aWidth ) override;
-
-    /// @copydoc GAL::DrawRectangle()
-    virtual void DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
-
-    /// @copydoc GAL::DrawPolyline()
-    virtual void DrawPolyline( const std::deque<VECTOR2D>& aPointList ) override;
-    virtual void DrawPolyline( const VECTOR2D aPointList[], int aListSize ) override;
-    virtual void DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain ) override;
-
-    /// @copydoc GAL::DrawPolygon()
-    virtual void DrawPolygon( const std::deque<VECTOR2D>& aPointList ) override;
-    virtual void DrawPolygon( const VECTOR2D aPointList[], int aListSize ) override;
-    virtual void DrawPolygon( const SHAPE_POLY_SET& aPolySet ) override;
-
-    /// @copydoc GAL::DrawCurve()
-    virtual void DrawCurve( const VECTOR2D& startPoint, const VECTOR2D& controlPointA,
-                            const VECTOR2D& controlPointB, const VECTOR2D& endPoint ) override;
-
     /// @copydoc GAL::DrawBitmap()
     virtual void DrawBitmap( const BITMAP_BASE& aBitmap ) override;
 
-    /// @copydoc GAL::BitmapText()
-    virtual void BitmapText( const wxString& aText, const VECTOR2D& aPosition,
-                             double aRotationAngle ) override;
-
     /// @copydoc GAL::DrawGrid()
     virtual void DrawGrid() override;
 
@@ -183,21 +139,6 @@ public:
     /// @copydoc GAL::Transform()
     virtual void Transform( const MATRIX3x3D& aTransformation ) override;
 
-    /// @copydoc GAL::Rotate()
-    virtual void Rotate( double aAngle ) override;
-
-    /// @copydoc GAL::Translate()
-    virtual void Translate( const VECTOR2D& aTranslation ) override;
-
-    /// @copydoc GAL::Scale()
-    virtual void Scale( const VECTOR2D& aScale ) override;
-
-    /// @copydoc GAL::Save()
-    virtual void Save() override;
-
-    /// @copydoc GAL::Restore()
-    virtual void Restore() override;
-
     // --------------------------------------------
     // Group methods
     // ---------------------------------------------
@@ -223,6 +164,15 @@ public:
     /// @copydoc GAL::ClearCache()
     virtual void ClearCache() override;
 
+    /// @copydoc GAL::CreateGroupRecorder()
+    virtual GAL* CreateGroupRecorder() override;
+
+    /// @copydoc GAL::UploadGroup()
+    virtual int UploadGroup( GAL* aRecorder, int aRecordedGroup ) override;
+
+    /// @copydoc GAL::GetCacheStatistics()
+    virtual GAL_CACHE_STATISTICS GetCacheStatistics() const override;
+
     // --------------------------------------------------------
     // Handling the world <-> screen transformation
     // --------------------------------------------------------
@@ -278,22 +228,9 @@ public:
 
     virtual void EnableDepthTest( bool aEnabled = false ) override;
 
-    ///< Parameters passed to the GLU tesselator
-    typedef struct
-    {
-        /// Manager used for storing new vertices
-        VERTEX_MANAGER* vboManager;
-
-        /// Intersect points, that have to be freed after tessellation
-        std::deque< boost::shared_array<GLdouble> >& intersectPoints;
-    } TessParams;
-
 private:
     /// Super class definition
-    typedef GAL super;
-
-    static const int    CIRCLE_POINTS   = 64;   ///< The number of points for circle approximation
-    static const int    CURVE_POINTS    = 32;   ///< The number of points for curve approximation
+    typedef OPENGL_GEOMETRY_GAL super;
 
     static wxGLContext*     glMainContext;      ///< Parent OpenGL context
     wxGLContext*            glPrivContext;      ///< Canvas-specific OpenGL context
@@ -307,7 +244,6 @@ private:
     typedef std::unordered_map< unsigned int, std::shared_ptr<VERTEX_ITEM> > GROUPS_MAP;
     GROUPS_MAP              groups;                 ///< Stores informations about VBO objects (groups)
     unsigned int            groupCounter;           ///< Counter used for generating keys for groups
-    VERTEX_MANAGER*         currentManager;         ///< Currently used VERTEX_MANAGER (for storing VERTEX_ITEMs)
     VERTEX_MANAGER*         cachedManager;          ///< Container for storing cached VERTEX_ITEMs
     VERTEX_MANAGER*         nonCachedManager;       ///< Container for storing non-cached VERTEX_ITEMs
     VERTEX_MANAGER*         overlayManager;         ///< Container for storing overlaid VERTEX_ITEMs
@@ -335,101 +271,6 @@ private:
     ///< Update handler for OpenGL settings
     bool updatedGalDisplayOptions( const GAL_DISPLAY_OPTIONS& aOptions ) override;
 
-    // Polygon tesselation
-    /// The tessellator
-    GLUtesselator*          tesselator;
-    /// Storage for intersecting points
-    std::deque< boost::shared_array<GLdouble> > tessIntersects;
-
-    /**
-     * @brief Draw a quad for the line.
-     *
-     * @param aStartPoint is the start point of the line.
-     * @param aEndPoint is the end point of the line.
-     */
-    void drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint );
-
-    /**
-     * @brief Draw a semicircle. Depending on settings (isStrokeEnabled & isFilledEnabled) it runs
-     * the proper function (drawStrokedSemiCircle or drawFilledSemiCircle).
-     *
-     * @param aCenterPoint is the center point.
-     * @param aRadius is the radius of the semicircle.
-     * @param aAngle is the angle of the semicircle.
-     *
-     */
-    void drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle );
-
-    /**
-     * @brief Draw a filled semicircle.
-     *
-     * @param aCenterPoint is the center point.
-     * @param aRadius is the radius of the semicircle.
-     * @param aAngle is the angle of the semicircle.
-     *
-     */
-    void drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle );
-
-    /**
-     * @brief Draw a stroked semicircle.
-     *
-     * @param aCenterPoint is the center point.
-     * @param aRadius is the radius of the semicircle.
-     * @param aAngle is the angle of the semicircle.
-     *
-     */
-    void drawStrokedSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle );
-
-    /**
-     * @brief Generic way of drawing a polyline stored in different containers.
-     * @param aPointGetter is a function to obtain coordinates of n-th vertex.
-     * @param aPointCount is the number of points to be drawn.
-     */
-    void drawPolyline( const std::function<VECTOR2D (int)>& aPointGetter, int aPointCount );
-
-    /**
-     * @brief Draws a filled polygon. It does not need the last point to have the same coordinates
-     * as the first one.
-     * @param aPoints is the vertices data (3 coordinates: x, y, z).
-     * @param aPointCount is the number of points.
-     */
-    void drawPolygon( GLdouble* aPoints, int aPointCount );
-
-    /**
-     * @brief Draws a set of polygons with a cached triangulation. Way faster than drawPolygon.
-     */
-    void drawTriangulatedPolyset( const SHAPE_POLY_SET& aPoly );
-
-
-    /**
-     * @brief Draws a single character using bitmap font.
-     * Its main purpose is to be used in BitmapText() function.
-     *
-     * @param aChar is the character to be drawn.
-     * @return Width of the drawn glyph.
-     */
-    int drawBitmapChar( unsigned long aChar );
-
-    /**
-     * @brief Draws an overbar over the currently drawn text.
-     * Its main purpose is to be used in BitmapText() function.
-     * This method requires appropriate scaling to be applied (as is done in BitmapText() function).
-     * The current X coordinate will be the overbar ending.
-     *
-     * @param aLength is the width of the overbar.
-     * @param aHeight is the height for the overbar.
-     */
-    void drawBitmapOverbar( double aLength, double aHeight );
-
-    /**
-     * @brief Computes a size of text drawn using bitmap font with current text setting applied.
-     *
-     * @param aText is the text to be drawn.
-     * @return Pair containing text bounding box and common Y axis offset. The values are expressed
-     * as a number of pixels on the bitmap font texture and need to be scaled before drawing.
-     */
-    std::pair<VECTOR2D, float> computeBitmapTextSize( const UTF8& aText ) const;
-
     // Event handling
     /**
      * @brief This is the OnPaint event handler.
@@ -457,15 +298,6 @@ private:
      */
     unsigned int getNewGroupNumber();
 
-    /**
-     * @brief Compute the angle step when drawing arcs/circles approximated with lines.
-     */
-    double calcAngleStep( double aRadius ) const
-    {
-        // Bigger arcs need smaller alpha increment to make them look smooth
-        return std::min( 1e6 / aRadius, 2.0 * M_PI / CIRCLE_POINTS );
-    }
-
     double getWorldPixelSize() const;
 
     /**
@@ -0,0 +1,292 @@
+/*
+ * This program source code file is part of KICAD, a free EDA CAD application.
+ *
+ * Copyright (C) 2012 Torsten Hueter, torstenhtr <at> gmx.de
+ * Copyright (C) 2013-2017 CERN
+ * @author Maciej Suminski <maciej.suminski@cern.ch>
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef OPENGL_GEOMETRY_GAL_H_
+#define OPENGL_GEOMETRY_GAL_H_
+
+#include <gal/graphics_abstraction_layer.h>
+#include <gal/opengl/vertex_manager.h>
+
+#include <GL/glew.h>
+
+#include <boost/smart_ptr/shared_array.hpp>
+#include <algorithm>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#ifndef CALLBACK
+#define CALLBACK
+#endif
+
+class UTF8;
+
+namespace KIGFX
+{
+
+/**
+ * @brief Class OPENGL_GEOMETRY_GAL converts the drawing primitives of the Graphics Abstraction
+ * Layer into OpenGL vertices.
+ *
+ * Vertices are stored in the VERTEX_MANAGER pointed by currentManager, which is provided by
+ * derived classes. Tessellation does not issue any OpenGL calls, so it does not need a window
+ * nor a graphics context.
+ */
+class OPENGL_GEOMETRY_GAL : public GAL
+{
+public:
+    OPENGL_GEOMETRY_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions );
+
+    virtual ~OPENGL_GEOMETRY_GAL();
+
+    // ---------------
+    // Drawing methods
+    // ---------------
+
+    /// @copydoc GAL::DrawLine()
+    virtual void DrawLine( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
+
+    /// @copydoc GAL::DrawSegment()
+    virtual void DrawSegment( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint,
+                              double aWidth ) override;
+
+    /// @copydoc GAL::DrawCircle()
+    virtual void DrawCircle( const VECTOR2D& aCenterPoint, double aRadius ) override;
+
+    /// @copydoc GAL::DrawArc()
+    virtual void DrawArc( const VECTOR2D& aCenterPoint, double aRadius,
+                          double aStartAngle, double aEndAngle ) override;
+
+    /// @copydoc GAL::DrawArcSegment()
+    virtual void DrawArcSegment( const VECTOR2D& aCenterPoint, double aRadius,
+                                 double aStartAngle, double aEndAngle, double aWidth ) override;
+
+    /// @copydoc GAL::DrawRectangle()
+    virtual void DrawRectangle( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint ) override;
+
+    /// @copydoc GAL::DrawPolyline()
+    virtual void DrawPolyline( const std::deque<VECTOR2D>& aPointList ) override;
+    virtual void DrawPolyline( const VECTOR2D aPointList[], int aListSize ) override;
+    virtual void DrawPolyline( const SHAPE_LINE_CHAIN& aLineChain ) override;
+
+    /// @copydoc GAL::DrawPolygon()
+    virtual void DrawPolygon( const std::deque<VECTOR2D>& aPointList ) override;
+    virtual void DrawPolygon( const VECTOR2D aPointList[], int aListSize ) override;
+    virtual void DrawPolygon( const SHAPE_POLY_SET& aPolySet ) override;
+
+    /// @copydoc GAL::DrawCurve()
+    virtual void DrawCurve( const VECTOR2D& startPoint, const VECTOR2D& controlPointA,
+                            const VECTOR2D& controlPointB, const VECTOR2D& endPoint ) override;
+
+    /// @copydoc GAL::BitmapText()
+    virtual void BitmapText( const wxString& aText, const VECTOR2D& aPosition,
+                             double aRotationAngle ) override;
+
+    // --------------
+    // Transformation
+    // --------------
+
+    /// @copydoc GAL::Rotate()
+    virtual void Rotate( double aAngle ) override;
+
+    /// @copydoc GAL::Translate()
+    virtual void Translate( const VECTOR2D& aTranslation ) override;
+
+    /// @copydoc GAL::Scale()
+    virtual void Scale( const VECTOR2D& aScale ) override;
+
+    /// @copydoc GAL::Save()
+    virtual void Save() override;
+
+    /// @copydoc GAL::Restore()
+    virtual void Restore() override;
+
+    ///< Parameters passed to the GLU tesselator
+    typedef struct
+    {
+        /// Manager used for storing new vertices
+        VERTEX_MANAGER* vboManager;
+
+        /// Intersect points, that have to be freed after tessellation
+        std::deque< boost::shared_array<GLdouble> >& intersectPoints;
+    } TessParams;
+
+protected:
+    static const int    CIRCLE_POINTS   = 64;   ///< The number of points for circle approximation
+    static const int    CURVE_POINTS    = 32;   ///< The number of points for curve approximation
+
+    VERTEX_MANAGER*         currentManager;     ///< Currently used VERTEX_MANAGER (for storing VERTEX_ITEMs)
+
+    // Polygon tesselation
+    /// The tessellator
+    GLUtesselator*          tesselator;
+    /// Storage for intersecting points
+    std::deque< boost::shared_array<GLdouble> > tessIntersects;
+
+    /**
+     * @brief Draw a quad for the line.
+     *
+     * @param aStartPoint is the start point of the line.
+     * @param aEndPoint is the end point of the line.
+     */
+    void drawLineQuad( const VECTOR2D& aStartPoint, const VECTOR2D& aEndPoint );
+
+    /**
+     * @brief Draw a semicircle. Depending on settings (isStrokeEnabled & isFilledEnabled) it runs
+     * the proper function (drawStrokedSemiCircle or drawFilledSemiCircle).
+     *
+     * @param aCenterPoint is the center point.
+     * @param aRadius is the radius of the semicircle.
+     * @param aAngle is the angle of the semicircle.
+     *
+     */
+    void drawSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle );
+
+    /**
+     * @brief Draw a filled semicircle.
+     *
+     * @param aCenterPoint is the center point.
+     * @param aRadius is the radius of the semicircle.
+     * @param aAngle is the angle of the semicircle.
+     *
+     */
+    void drawFilledSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle );
+
+    /**
+     * @brief Draw a stroked semicircle.
+     *
+     * @param aCenterPoint is the center point.
+     * @param aRadius is the radius of the semicircle.
+     * @param aAngle is the angle of the semicircle.
+     *
+     */
+    void drawStrokedSemiCircle( const VECTOR2D& aCenterPoint, double aRadius, double aAngle );
+
+    /**
+     * @brief Generic way of drawing a polyline stored in different containers.
+     * @param aPointGetter is a function to obtain coordinates of n-th vertex.
+     * @param aPointCount is the number of points to be drawn.
+     */
+    void drawPolyline( const std::function<VECTOR2D (int)>& aPointGetter, int aPointCount );
+
+    /**
+     * @brief Draws a filled polygon. It does not need the last point to have the same coordinates
+     * as the first one.
+     * @param aPoints is the vertices data (3 coordinates: x, y, z).
+     * @param aPointCount is the number of points.
+     */
+    void drawPolygon( GLdouble* aPoints, int aPointCount );
+
+    /**
+     * @brief Draws a set of polygons with a cached triangulation. Way faster than drawPolygon.
+     */
+    void drawTriangulatedPolyset( const SHAPE_POLY_SET& aPoly );
+
+
+    /**
+     * @brief Draws a single character using bitmap font.
+     * Its main purpose is to be used in BitmapText() function.
+     *
+     * @param aChar is the character to be drawn.
+     * @return Width of the drawn glyph.
+     */
+    int drawBitmapChar( unsigned long aChar );
+
+    /**
+     * @brief Draws an overbar over the currently drawn text.
+     * Its main purpose is to be used in BitmapText() function.
+     * This method requires appropriate scaling to be applied (as is done in BitmapText() function).
+     * The current X coordinate will be the overbar ending.
+     *
+     * @param aLength is the width of the overbar.
+     * @param aHeight is the height for the overbar.
+     */
+    void drawBitmapOverbar( double aLength, double aHeight );
+
+    /**
+     * @brief Computes a size of text drawn using bitmap font with current text setting applied.
+     *
+     * @param aText is the text to be drawn.
+     * @return Pair containing text bounding box and common Y axis offset. The values are expressed
+     * as a number of pixels on the bitmap font texture and need to be scaled before drawing.
+     */
+    std::pair<VECTOR2D, float> computeBitmapTextSize( const UTF8& aText ) const;
+
+    /**
+     * @brief Compute the angle step when drawing arcs/circles approximated with lines.
+     */
+    double calcAngleStep( double aRadius ) const
+    {
+        // Bigger arcs need smaller alpha increment to make them look smooth
+        return std::min( 1e6 / aRadius, 2.0 * M_PI / CIRCLE_POINTS );
+    }
+};
+
+
+/**
+ * @brief Class OPENGL_RECORDING_GAL tessellates groups into system memory.
+ *
+ * It is created by OPENGL_GAL::CreateGroupRecorder() and lets worker threads generate the
+ * geometry of cached items. Each group is a range of vertices that is copied to the GPU cache
+ * by OPENGL_GAL::UploadGroup(). Recorded groups are valid until ClearCache() is called.
+ */
+class OPENGL_RECORDING_GAL : public OPENGL_GEOMETRY_GAL
+{
+public:
+    OPENGL_RECORDING_GAL( GAL_DISPLAY_OPTIONS& aDisplayOptions );
+
+    /// @copydoc GAL::BeginGroup()
+    virtual int BeginGroup() override;
+
+    /// @copydoc GAL::EndGroup()
+    virtual void EndGroup() override;
+
+    /// @copydoc GAL::ClearCache()
+    virtual void ClearCache() override;
+
+    /**
+     * @brief Returns the vertices of a recorded group.
+     *
+     * @param aGroupNumber is the group number returned by BeginGroup().
+     * @param aSize is set to the number of vertices in the group.
+     * @return Pointer to the first vertex of the group.
+     */
+    const VERTEX* GetGroupVertices( int aGroupNumber, unsigned int& aSize ) const;
+
+private:
+    ///< Initial capacity of the recording container (expressed in vertices)
+    static const unsigned int RECORDER_INITIAL_SIZE = 65536;
+
+    std::unique_ptr<VERTEX_MANAGER> recordManager;
+
+    ///< Offset and size of recorded groups
+    std::vector< std::pair<unsigned int, unsigned int> > recordedGroups;
+};
+
+} // namespace KIGFX
+
+#endif  // OPENGL_GEOMETRY_GAL_H_
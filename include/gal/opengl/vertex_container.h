@@ -31,6 +31,7 @@
 #define VERTEX_CONTAINER_H_
 
 #include <gal/opengl/vertex_common.h>
+#include <algorithm>
 
 namespace KIGFX
 {
@@ -137,6 +138,30 @@ public:
     void SetDirty()
     {
         m_dirty = true;
+        m_dirtyBegin = 0;
+        m_dirtyEnd = m_currentSize;
+    }
+
+    /**
+     * Sets the dirty flag for a range of vertices, so only the range is going to be reuploaded
+     * to the GPU (if the container supports partial uploads).
+     * @param aOffset is the offset of the first modified vertex.
+     * @param aSize is the number of modified vertices.
+     */
+    void SetDirty( unsigned int aOffset, unsigned int aSize )
+    {
+        m_dirty = true;
+
+        if( m_dirtyBegin >= m_dirtyEnd )
+        {
+            m_dirtyBegin = aOffset;
+            m_dirtyEnd = aOffset + aSize;
+        }
+        else
+        {
+            m_dirtyBegin = std::min( m_dirtyBegin, aOffset );
+            m_dirtyEnd = std::max( m_dirtyEnd, aOffset + aSize );
+        }
     }
 
     /**
@@ -166,6 +191,10 @@ protected:
     bool            m_failed;
     bool            m_dirty;
 
+    ///> Range of vertices modified since the last upload (empty if m_dirtyBegin >= m_dirtyEnd)
+    unsigned int    m_dirtyBegin;
+    unsigned int    m_dirtyEnd;
+
     /**
      * Function usedSpace()
      * returns size of the used memory space.
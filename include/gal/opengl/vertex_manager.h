@@ -46,6 +46,7 @@ class SHADER;
 class VERTEX_ITEM;
 class VERTEX_CONTAINER;
 class GPU_MANAGER;
+struct GAL_CACHE_STATISTICS;
 
 class VERTEX_MANAGER
 {
@@ -55,8 +56,10 @@ public:
      *
      * @param aCached says if vertices should be cached in GPU or system memory. For data that
      * does not change every frame, it is better to store vertices in GPU memory.
+     * @param aInitialSize is the initial capacity (expressed in vertices) of a noncached
+     * container, 0 selects the default size. It is ignored for cached containers.
      */
-    VERTEX_MANAGER( bool aCached );
+    VERTEX_MANAGER( bool aCached, unsigned int aInitialSize = 0 );
 
     /**
      * Function Map()
@@ -66,7 +69,7 @@ public:
 
     /**
      * Function Unmap()
-     * unmaps vertex buffer.
+     * unmaps vertex buffer. Cached containers are also partially defragmented.
      */
     void Unmap();
 
@@ -134,6 +137,18 @@ public:
      */
     bool Vertices( const VERTEX aVertices[], unsigned int aSize );
 
+    /**
+     * Function CopyVertices()
+     * adds vertices to the currently set item exactly as they are given, including their color,
+     * shader parameters and depth. No transformation is applied. It is meant to move geometry
+     * recorded by another manager.
+     *
+     * @param aVertices contains vertices to be added
+     * @param aSize is the number of vertices to be added.
+     * @return True if successful, false otherwise.
+     */
+    bool CopyVertices( const VERTEX aVertices[], unsigned int aSize );
+
     /**
      * Function Color()
      * changes currently used color that will be applied to newly added vertices.
@@ -311,6 +326,30 @@ public:
      */
     VERTEX* GetVertices( const VERTEX_ITEM& aItem ) const;
 
+    /**
+     * Function GetVertices()
+     * returns a pointer to the vertices stored in the container at the given offset.
+     *
+     * @param aOffset is the offset of the first returned vertex.
+     */
+    VERTEX* GetVertices( unsigned int aOffset ) const;
+
+    /**
+     * Function GetSize()
+     * returns the size of the container. For noncached containers it is the number of vertices
+     * added since the last Clear().
+     */
+    unsigned int GetSize() const;
+
+    /**
+     * Function GetCacheStatistics()
+     * fills memory usage statistics of a cached container.
+     *
+     * @param aStats is the structure to be filled.
+     * @return false if the container is not cached.
+     */
+    bool GetCacheStatistics( GAL_CACHE_STATISTICS& aStats ) const;
+
     const glm::mat4& GetTransformation() const
     {
         return m_transform;
@@ -362,6 +401,9 @@ protected:
      */
     void putVertex( VERTEX& aTarget, GLfloat aX, GLfloat aY, GLfloat aZ ) const;
 
+    ///< Maximal number of vertices moved by a single defragmentation step
+    static constexpr unsigned int COMPACTION_STEP = 32768;
+
     /// Container for vertices, may be cached or noncached
     std::shared_ptr<VERTEX_CONTAINER> m_container;
     /// GPU manager for data transfers and drawing operations
@@ -382,6 +382,34 @@ public:
         build( aPolyOutline, gridSize );
     }
 
+    /**
+     * Constructor
+     * builds the partition with a grid resolution chosen from the edge count
+     * of the outline (see OptimalGridSize()).
+     */
+    POLY_GRID_PARTITION( const SHAPE_LINE_CHAIN& aPolyOutline )
+    {
+        build( aPolyOutline, OptimalGridSize( aPolyOutline ) );
+    }
+
+    /**
+     * Function OptimalGridSize
+     * returns a grid resolution adapted to the edge density of the outline: edges
+     * mostly fall into the cells along the outline perimeter, so the number of edges
+     * scanned per cell stays roughly constant when the grid grows linearly with
+     * the edge count.
+     */
+    static int OptimalGridSize( const SHAPE_LINE_CHAIN& aPolyOutline )
+    {
+        const int minGridSize = 16;
+        const int maxGridSize = 128;
+        const int edgesPerCell = 8;
+
+        int size = aPolyOutline.SegmentCount() / edgesPerCell;
+
+        return std::max( minGridSize, std::min( maxGridSize, size ) );
+    }
+
     int containsPoint( const VECTOR2I& aP, bool debug = false ) const
     {
         const auto gridPoint = poly2grid( aP );
@@ -450,7 +478,7 @@ public:
         }
     }
 
-    bool checkClearance( const VECTOR2I& aP, int aClearance )
+    bool checkClearance( const VECTOR2I& aP, int aClearance ) const
     {
         int gx0 = poly2gridX( aP.x - aClearance - 1);
         int gx1 = poly2gridX( aP.x + aClearance + 1);
@@ -482,7 +510,7 @@ public:
 
 
 
-    int ContainsPoint( const VECTOR2I& aP, int aClearance = 0 )    // const
+    int ContainsPoint( const VECTOR2I& aP, int aClearance = 0 ) const
     {
         if( containsPoint(aP) )
             return 1;
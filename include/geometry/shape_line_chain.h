@@ -30,6 +30,7 @@
 #include <sstream>
 
 #include <core/optional.h>
+#include <core/arena.h>
 
 #include <math/vector2d.h>
 #include <geometry/shape.h>
@@ -47,9 +48,13 @@
  */
 class SHAPE_LINE_CHAIN : public SHAPE
 {
+public:
+    /// Point storage.  Chains built while an ARENA_SCOPE is active allocate from its arena.
+    typedef std::vector<VECTOR2I, ARENA_ALLOCATOR<VECTOR2I>> POINT_VECTOR;
+
 private:
-    typedef std::vector<VECTOR2I>::iterator point_iter;
-    typedef std::vector<VECTOR2I>::const_iterator point_citer;
+    typedef POINT_VECTOR::iterator point_iter;
+    typedef POINT_VECTOR::const_iterator point_citer;
 
 public:
     /**
@@ -271,7 +276,7 @@ public:
         return m_points[aIndex];
     }
 
-    const std::vector<VECTOR2I>& CPoints() const
+    const POINT_VECTOR& CPoints() const
     {
         return m_points;
     }
@@ -646,7 +651,7 @@ public:
 
     void Move( const VECTOR2I& aVector ) override
     {
-        for( std::vector<VECTOR2I>::iterator i = m_points.begin(); i != m_points.end(); ++i )
+        for( point_iter i = m_points.begin(); i != m_points.end(); ++i )
             (*i) += aVector;
     }
 
@@ -669,7 +674,7 @@ public:
 
 private:
     /// array of vertices
-    std::vector<VECTOR2I> m_points;
+    POINT_VECTOR m_points;
 
     /// is the line chain closed?
     bool m_closed;
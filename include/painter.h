@@ -339,6 +339,37 @@ public:
      */
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) = 0;
 
+    /**
+     * Function DrawProxy
+     * Draws a simplified representation of an item that is too small on the screen to show
+     * its details (see VIEW_ITEM::ViewGetProxyLOD()), e.g. a box instead of a text.
+     * The proxy is cached in its own group, like the full geometry, so it may depend on the
+     * view scale only coarsely: the cached proxies are drawn again each time the scale
+     * doubles or halves.
+     * @param aItem is an item to be drawn.
+     * @param aLayer is the currently rendered layer.
+     * @return true if the item has been handled (drawing nothing skips the item), false if
+     * the full geometry should be drawn instead.
+     */
+    virtual bool DrawProxy( const VIEW_ITEM* aItem, int aLayer )
+    {
+        return false;
+    }
+
+    /**
+     * Function Clone
+     * Creates a painter with the same settings, drawing on another GAL. A painter that can be
+     * cloned guarantees that Draw() only reads the drawn items, so clones may draw from worker
+     * threads while the VIEW waits for them.
+     * @param aGal is the GAL the new painter draws on.
+     * @return New painter (owned by the caller) or nullptr if the painter may be used only by
+     * the main thread.
+     */
+    virtual PAINTER* Clone( GAL* aGal ) const
+    {
+        return nullptr;
+    }
+
 protected:
     /// Instance of graphic abstraction layer that gives an interface to call
     /// commands used to draw (eg. DrawLine, DrawCircle, etc.)
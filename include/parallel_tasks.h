@@ -0,0 +1,103 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#ifndef PARALLEL_TASKS_H
+#define PARALLEL_TASKS_H
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class LOCALE_IO;
+
+/**
+ * Runs independent tasks, numbered 0 to the task count - 1, on worker threads.
+ *
+ * The tasks are started in the order of their numbers, so the longest ones should come
+ * first.  The caller can wait for the tasks, or keep its thread (e.g. the GUI thread)
+ * busy and poll IsDone().  The object waits for the tasks when it is destroyed.
+ *
+ * Tasks reading or writing numbers need the C locale, but the locale is global: a
+ * LOCALE_IO created by a task would switch the locale of all the threads while the other
+ * tasks use it.  When the C locale is requested, the LOCALE_IO is created on the calling
+ * thread before the worker threads start, and destroyed after they finish: the LOCALE_IO
+ * created by the tasks then only increment the LOCALE_IO reference count.
+ */
+class PARALLEL_TASKS
+{
+public:
+    /**
+     * Starts the tasks.
+     * @param aTaskCount is the number of tasks
+     * @param aTask runs the task whose number is given, on a worker thread
+     * @param aCLocale switches to the C locale while the tasks run
+     * @param aThreadCount is the max number of worker threads, 0 for DefaultThreadCount()
+     */
+    PARALLEL_TASKS( size_t aTaskCount, const std::function<void( size_t )>& aTask,
+                    bool aCLocale = false, size_t aThreadCount = 0 );
+
+    ~PARALLEL_TASKS();
+
+    /**
+     * Runs the tasks and waits for them.  When one thread would be used, the tasks run
+     * on the calling thread.
+     * The parameters are the parameters of the constructor.
+     */
+    static void Run( size_t aTaskCount, const std::function<void( size_t )>& aTask,
+                     bool aCLocale = false, size_t aThreadCount = 0 );
+
+    /**
+     * @return the default number of worker threads: the number of cores, at least 2
+     */
+    static size_t DefaultThreadCount();
+
+    /**
+     * @return true when the tasks are finished (or skipped after Cancel())
+     */
+    bool IsDone() const { return m_finishedThreads.load() == m_threads.size(); }
+
+    /**
+     * Skips the tasks not started yet.  The running tasks are not stopped.
+     */
+    void Cancel() { m_cancelled = true; }
+
+    /**
+     * Waits until the tasks are finished, and restores the locale.
+     */
+    void Wait();
+
+private:
+    void runTasks();
+
+    std::function<void( size_t )> m_task;
+    size_t                        m_taskCount;
+    std::atomic<size_t>           m_nextTask;
+    std::atomic<size_t>           m_finishedThreads;
+    std::atomic<bool>             m_cancelled;
+    std::unique_ptr<LOCALE_IO>    m_locale;
+    std::vector<std::thread>      m_threads;
+};
+
+#endif    // PARALLEL_TASKS_H
@@ -33,6 +33,7 @@
 #define PLOT_COMMON_H_
 
 #include <vector>
+#include <unordered_map>
 #include <math/box2.h>
 #include <draw_graphic_text.h>
 #include <page_info.h>
@@ -59,6 +60,12 @@ enum PlotFormat {
     PLOT_LAST_FORMAT = PLOT_FORMAT_SVG
 };
 
+/**
+ * Size of the stdio buffer of the plot files: the plotters write a lot of short
+ * records, a large buffer avoids a system call for each of them
+ */
+#define PLOT_FILE_BUFFER_SIZE ( 256 * 1024 )
+
 /**
  * Enum for choosing which kind of text to output with the PSLIKE
  * plotters. You can:
@@ -993,7 +1000,8 @@ public:
         Circle   = 1,
         Rect     = 2,
         Plotting = 3,
-        Oval     = 4
+        Oval     = 4,
+        Macro    = 5      // Shape defined by an aperture macro
     };
 
     wxSize        m_Size;     // horiz and Vert size
@@ -1002,6 +1010,26 @@ public:
     int           m_ApertureAttribute;  // the attribute attached to this aperture
                                         // Only one attribute is allowed by aperture
                                         // 0 = no specific aperture attribute
+    int           m_MacroId;  // Macro apertures only: index of the aperture macro
+    double        m_Rotation; // Macro apertures only: rotation of the macro in degrees
+};
+
+
+/// Max number of vertices of an outline primitive of an aperture macro, as allowed
+/// by the Gerber specification.
+#define GBR_MACRO_OUTLINE_MAX_VERTICES 5000
+
+
+/**
+ * Shape of the flashed pads which have no standard aperture (rotated rect, trapezoid,
+ * round rect and custom pads): a set of polygons, relative to the pad position and
+ * not rotated.  All the pads having the same shape use the same aperture macro,
+ * the pad rotation is a parameter of the aperture.
+ */
+class GBR_APERTURE_MACRO
+{
+public:
+    std::vector< std::vector<wxPoint> > m_Outlines;
 };
 
 
@@ -1088,16 +1116,15 @@ public:
                                EDA_DRAW_MODE_T trace_mode, void* aData ) override;
     /**
      * Filled rect flashes are handled as aperture in the 0 90 180 or 270 degree orientation only
-     * and as polygon for other orientations
-     * TODO: always use flashed shapes (aperture macros)
+     * and as aperture macro for other orientations
      */
     virtual void FlashPadRect( const wxPoint& pos, const wxSize& size,
                                double orient, EDA_DRAW_MODE_T trace_mode, void* aData ) override;
 
     /**
-     * Roundrect pad at the moment are not handled as aperture, since
-     * they require aperture macros
-     * TODO: always use flashed shapes (aperture macros)
+     * Filled roundrect, custom and trapezoidal pads are flashed with aperture macros,
+     * shared by the pads having the same shape.  Custom pads having a polygon of more
+     * than GBR_MACRO_OUTLINE_MAX_VERTICES corners are plotted as regions
      */
     virtual void FlashPadRoundRect( const wxPoint& aPadPos, const wxSize& aSize,
                                     int aCornerRadius, double aOrient,
@@ -1105,11 +1132,6 @@ public:
     virtual void FlashPadCustom( const wxPoint& aPadPos, const wxSize& aSize,
                                  SHAPE_POLY_SET* aPolygons,
                                  EDA_DRAW_MODE_T aTraceMode, void* aData ) override;
-    /**
-     * Trapezoidal pad at the moment are *never* handled as aperture, since
-     * they require aperture macros
-     * TODO: always use flashed shapes (aperture macros)
-     */
     virtual void FlashPadTrapez( const wxPoint& aPadPos, const wxPoint *aCorners,
                                  double aPadOrient, EDA_DRAW_MODE_T aTraceMode, void* aData ) override;
 
@@ -1156,7 +1178,24 @@ protected:
      * write the DCode selection on gerber file
      */
     void selectAperture( const wxSize& aSize, APERTURE::APERTURE_TYPE aType,
-                         int aApertureAttribute );
+                         int aApertureAttribute, int aMacroId = -1, double aRotation = 0.0 );
+
+    /**
+     * Flash a pad using an aperture macro
+     * @param aPadPos = the pad position
+     * @param aOutlines = the pad shape, relative to aPadPos and not rotated
+     * @param aOrient = the pad rotation in 0.1 degrees
+     * @param aData = the GBR_METADATA of the pad, or NULL
+     */
+    void flashPadMacro( const wxPoint& aPadPos,
+                        const std::vector< std::vector<wxPoint> >& aOutlines,
+                        double aOrient, void* aData );
+
+    /**
+     * @return the index of the aperture macro of the shape aOutlines, created if
+     * this shape has no macro yet
+     */
+    int getApertureMacro( const std::vector< std::vector<wxPoint> >& aOutlines );
 
     /**
      * Emit a D-Code record, using proper conversions
@@ -1189,7 +1228,8 @@ protected:
      * 0 = no specific attribute
      */
     std::vector<APERTURE>::iterator getAperture( const wxSize& aSize,
-                    APERTURE::APERTURE_TYPE aType, int aApertureAttribute );
+                    APERTURE::APERTURE_TYPE aType, int aApertureAttribute,
+                    int aMacroId = -1, double aRotation = 0.0 );
 
     // the attributes dictionnary created/modifed by %TO, attached the objects, when they are created
     // by D01, D03 G36/G37 commands
@@ -1207,6 +1247,10 @@ protected:
     FILE* finalFile;
     wxString m_workFilename;
 
+    // Position in the work file of the end of the "G04 APERTURE LIST*" line,
+    // where the aperture list is inserted in the final file
+    long  m_apertureListPosition;
+
     /**
      * Generate the table of D codes
      */
@@ -1215,6 +1259,9 @@ protected:
     std::vector<APERTURE>           apertures;
     std::vector<APERTURE>::iterator currentAperture;
 
+    std::vector<GBR_APERTURE_MACRO>      m_apertureMacros;
+    std::unordered_multimap<size_t, int> m_apertureMacroIndex;  // shape hash -> macro index
+
     bool     m_gerberUnitInch;  // true if the gerber units are inches, false for mm
     int      m_gerberUnitFmt;   // number of digits in mantissa.
                                 // usually 6 in Inches and 5 or 6  in mm
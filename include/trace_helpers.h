@@ -99,6 +99,11 @@ extern const wxChar* const tracePrinting;
  */
 extern const wxChar* const tracePathsAndFiles;
 
+/**
+ * Flag to enable arena allocation statistics output (needs a KICAD_ARENA_STATS build).
+ */
+extern const wxChar* const traceArenaStats;
+
 ///@}
 
 /**
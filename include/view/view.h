@@ -188,10 +188,7 @@ public:
      * Function SetPainter()
      * Sets the painter object used by the view for drawing VIEW_ITEMS.
      */
-    inline void SetPainter( PAINTER* aPainter )
-    {
-        m_painter = aPainter;
-    }
+    void SetPainter( PAINTER* aPainter );
 
     /**
      * Function GetPainter()
@@ -272,6 +269,36 @@ public:
         return m_scale;
     }
 
+    /**
+     * Function SetProxyThreshold()
+     * Sets the on-screen size (in pixels) below which items are drawn as simplified proxies.
+     * @see VIEW_ITEM::ViewGetProxyLOD(), PAINTER::DrawProxy()
+     * @param aPixels is the threshold size, 0 disables proxies.
+     */
+    inline void SetProxyThreshold( double aPixels )
+    {
+        m_proxyThreshold = aPixels;
+        MarkDirty();
+    }
+
+    /**
+     * Function GetProxyThreshold()
+     * @return the on-screen size (in pixels) below which items are drawn as simplified proxies.
+     */
+    inline double GetProxyThreshold() const
+    {
+        return m_proxyThreshold;
+    }
+
+    /**
+     * Function GetProxyScale()
+     * Returns the VIEW scale at which a feature of a given size is displayed with the proxy
+     * threshold size. It is meant to be returned by VIEW_ITEM::ViewGetProxyLOD().
+     * @param aSize is the feature size, expressed in world units.
+     * @return the scale below which the feature is smaller than the proxy threshold.
+     */
+    double GetProxyScale( double aSize ) const;
+
     /**
      * Function SetBoundary()
      * Sets limits for view area.
@@ -551,7 +578,8 @@ public:
 
     /**
      * Function RecacheAllItems()
-     * Rebuilds GAL display lists.
+     * Rebuilds GAL display lists.  The cached groups are deleted now, and drawn again
+     * by the next UpdateItems() call, through the same worker threads as the other updates.
      */
     void RecacheAllItems();
 
@@ -641,6 +669,8 @@ public:
     /**
      * Function UpdateItems()
      * Iterates through the list of items that asked for updating and updates them.
+     * If both the GAL and the PAINTER support it, the geometry of cached items is generated
+     * by worker threads and only uploaded to the GAL by the calling thread.
      */
     void UpdateItems();
 
@@ -790,6 +820,20 @@ protected:
     /// Updates all informations needed to draw an item
     void updateItemGeometry( VIEW_ITEM* aItem, int aLayer );
 
+    /// Updates the geometry of items queued in m_pendingGeometry, using worker threads if possible
+    void updatePendingGeometry();
+
+    /// Creates (if needed) the worker GALs and painters, and syncs their settings with m_gal
+    /// and m_painter. Returns false if the geometry cannot be generated by worker threads.
+    bool prepareGeometryWorkers();
+
+    /// Draws a simplified representation of an item using PAINTER::DrawProxy(), from a cached
+    /// group on cached layers. Returns false if the painter does not provide one.
+    bool drawProxy( VIEW_ITEM* aItem, int aLayer, bool aImmediate );
+
+    /// Creates the cached groups of the proxies drawn since the last UpdateItems()
+    void updateProxyGroups( VIEW_ITEM* aItem );
+
     /// Updates bounding box of an item
     void updateBbox( VIEW_ITEM* aItem );
 
@@ -823,6 +867,15 @@ protected:
     /// Scale of displayed VIEW_ITEMs
     double m_scale;
 
+    /// On-screen size (in pixels) below which items are drawn as proxies
+    double m_proxyThreshold;
+
+    /// True if proxies were drawn without their cached group since the last UpdateItems()
+    bool m_pendingProxies;
+
+    /// Scale of the cached proxies, as a power of two (see SetScale())
+    int m_proxyScaleLevel;
+
     /// View boundaries
     BOX2D m_boundary;
 
@@ -844,6 +897,22 @@ protected:
     /// Gives interface to PAINTER, that is used to draw items
     GAL* m_gal;
 
+    /// Recording GAL and a PAINTER drawing on it, used by a thread generating item geometry
+    struct GEOMETRY_WORKER
+    {
+        std::unique_ptr<GAL>     gal;
+        std::unique_ptr<PAINTER> painter;
+    };
+
+    /// Workers generating the geometry of cached items in parallel
+    std::vector<GEOMETRY_WORKER> m_geometryWorkers;
+
+    /// False if m_gal or m_painter cannot be used with worker threads
+    bool m_useGeometryWorkers;
+
+    /// Items (and their layers) whose cached geometry has to be regenerated by UpdateItems()
+    std::vector<std::pair<VIEW_ITEM*, int>> m_pendingGeometry;
+
     /// Dynamic VIEW (eg. display PCB in window) allows changes once it is built,
     /// static (eg. image/PDF) - does not.
     bool m_dynamic;
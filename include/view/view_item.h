@@ -143,6 +143,22 @@ public:
         return 0;
     }
 
+    /**
+     * Function ViewGetProxyLOD()
+     * Returns the level of detail below which the item is drawn as a simplified proxy
+     * (see PAINTER::DrawProxy()) instead of its full geometry. Like ViewGetLOD(), it is
+     * the minimal VIEW scale for the full geometry to be shown on a given layer.
+     * VIEW::GetProxyScale() computes it from the size of the item details.
+     * @param aLayer: current drawing layer
+     * @param aView: pointer to the VIEW device we are drawing on
+     * @return the proxy level of detail. 0 always draws the full geometry.
+     */
+    virtual double ViewGetProxyLOD( int aLayer, VIEW* aView ) const
+    {
+        // By default never use a proxy
+        return 0.0;
+    }
+
 public:
 
     VIEW_ITEM_DATA* viewPrivData() const
@@ -109,6 +109,12 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
             }
         }
 
+        // Report the touched layers before the items may be deleted below
+        board->MarkItemLayersChanged( boardItem );
+
+        if( ent.m_copy )
+            board->MarkItemLayersChanged( static_cast<BOARD_ITEM*>( ent.m_copy ) );
+
         switch( changeType )
         {
             case CHT_ADD:
@@ -271,7 +277,13 @@ void BOARD_COMMIT::Push( const wxString& aMessage, bool aCreateUndoEntry, bool a
     }
 
     if( aSetDirtyBit )
+    {
+        // The changed layers are already known, the frame does not need to
+        // invalidate all of them
+        board->SetLayerChangesTracked( true );
         frame->OnModify();
+        board->SetLayerChangesTracked( false );
+    }
 
     frame->UpdateMsgPanel();
 
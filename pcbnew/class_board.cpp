@@ -33,6 +33,7 @@
 #include <limits.h>
 #include <algorithm>
 #include <iterator>
+#include <atomic>
 
 #include <fctsys.h>
 #include <common.h>
@@ -107,6 +108,10 @@ wxPoint BOARD_ITEM::ZeroOffset( 0, 0 );
 // so dummyColorsSettings provide this default initialization
 static COLORS_DESIGN_SETTINGS dummyColorsSettings( FRAME_PCB );
 
+// Source of the layer revisions, shared by all the boards so a revision is never
+// reused, even by a board allocated where a deleted one was
+static std::atomic<unsigned> s_layerRevisionCounter( 0 );
+
 BOARD::BOARD() :
     BOARD_ITEM_CONTAINER( (BOARD_ITEM*) NULL, PCB_T ),
         m_paper( PAGE_INFO::A4 ), m_NetInfo( this )
@@ -121,6 +126,9 @@ BOARD::BOARD() :
 
     BuildListOfNets();                      // prepare pad and netlist containers.
 
+    m_layerChangesTracked = false;
+    MarkLayersChanged( LSET::AllLayersMask() );
+
     for( LAYER_NUM layer = 0; layer < PCB_LAYER_ID_COUNT; ++layer )
     {
         m_Layer[layer].m_name = GetStandardLayerName( ToLAYER_ID( layer ) );
@@ -949,6 +957,9 @@ void BOARD::Add( BOARD_ITEM* aBoardItem, ADD_MODE aMode )
 
     aBoardItem->SetParent( this );
     m_connectivity->Add( aBoardItem );
+
+    if( aBoardItem->Type() != PCB_NETINFO_T && aBoardItem->Type() != PCB_MARKER_T )
+        MarkItemLayersChanged( aBoardItem );
 }
 
 
@@ -1018,6 +1029,38 @@ void BOARD::Remove( BOARD_ITEM* aBoardItem )
     }
 
     m_connectivity->Remove( aBoardItem );
+
+    if( aBoardItem->Type() != PCB_NETINFO_T && aBoardItem->Type() != PCB_MARKER_T )
+        MarkItemLayersChanged( aBoardItem );
+}
+
+
+void BOARD::MarkLayersChanged( LSET aLayers )
+{
+    for( LSEQ seq = aLayers.Seq(); seq; ++seq )
+        m_layerRevision[*seq] = ++s_layerRevisionCounter;
+}
+
+
+void BOARD::MarkItemLayersChanged( const BOARD_ITEM* aItem )
+{
+    LSET layers = aItem->GetLayerSet();
+
+    if( aItem->Type() == PCB_MODULE_T )
+    {
+        const MODULE* module = static_cast<const MODULE*>( aItem );
+
+        for( const D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            layers |= pad->GetLayerSet();
+
+        for( const BOARD_ITEM* item = module->GraphicalItemsList(); item; item = item->Next() )
+            layers |= item->GetLayerSet();
+
+        layers.set( module->Reference().GetLayer() );
+        layers.set( module->Value().GetLayer() );
+    }
+
+    MarkLayersChanged( layers );
 }
 
 
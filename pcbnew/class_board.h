@@ -189,6 +189,12 @@ private:
 
     int                     m_fileFormatVersionAtLoad;  ///< the version loaded from the file
 
+    /// revision of the items on each layer, see MarkLayersChanged()
+    unsigned                m_layerRevision[PCB_LAYER_ID_COUNT];
+
+    /// true while the layer changes are reported by the caller (see SetLayerChangesTracked())
+    bool                    m_layerChangesTracked;
+
     std::shared_ptr<CONNECTIVITY_DATA>      m_connectivity;
 
     BOARD_DESIGN_SETTINGS   m_designSettings;
@@ -284,6 +290,40 @@ public:
 
     void Remove( BOARD_ITEM* aBoardItem ) override;
 
+    /**
+     * Function MarkLayersChanged
+     * gives a new revision to each layer of \a aLayers.  It must be called when items
+     * are added to, removed from or modified on these layers, so the viewers which cache
+     * data built from the layers (e.g. the 3D viewer) rebuild only the changed layers.
+     * Revisions are unique among all the boards, a layer revision never comes back.
+     */
+    void MarkLayersChanged( LSET aLayers );
+
+    /**
+     * Function MarkItemLayersChanged
+     * calls MarkLayersChanged() for the layers used by \a aItem.  For a footprint, these
+     * are the layers of its pads, texts and graphic items.
+     */
+    void MarkItemLayersChanged( const BOARD_ITEM* aItem );
+
+    /**
+     * Function GetLayerRevision
+     * @return the current revision of the items on \a aLayer
+     */
+    unsigned GetLayerRevision( PCB_LAYER_ID aLayer ) const
+    {
+        return m_layerRevision[aLayer];
+    }
+
+    /**
+     * Function SetLayerChangesTracked
+     * tells the board the layers touched by the current change have already been
+     * reported with MarkLayersChanged().  When false (the default) a change notified to
+     * the frame (OnModify()) is assumed to touch every layer.
+     */
+    void SetLayerChangesTracked( bool aTracked ) { m_layerChangesTracked = aTracked; }
+    bool AreLayerChangesTracked() const { return m_layerChangesTracked; }
+
     BOARD_ITEM* GetItem( void* aWeakReference );
 
     BOARD_ITEM* Duplicate( const BOARD_ITEM* aItem, bool aAddToBoard = false );
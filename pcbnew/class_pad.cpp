@@ -1350,6 +1350,28 @@ unsigned int D_PAD::ViewGetLOD( int aLayer, KIGFX::VIEW* aView ) const
 }
 
 
+double D_PAD::ViewGetProxyLOD( int aLayer, KIGFX::VIEW* aView ) const
+{
+    // Circles, ovals and rectangles are as cheap to draw as their proxies
+    switch( GetShape() )
+    {
+    case PAD_SHAPE_TRAPEZOID:
+    case PAD_SHAPE_ROUNDRECT:
+    case PAD_SHAPE_CUSTOM:
+        break;
+
+    default:
+        return 0.0;
+    }
+
+    if( IsNetnameLayer( aLayer ) || aLayer == LAYER_PADS_PLATEDHOLES
+            || aLayer == LAYER_NON_PLATEDHOLES )
+        return 0.0;
+
+    return aView->GetProxyScale( std::max( m_Size.x, m_Size.y ) );
+}
+
+
 const BOX2I D_PAD::ViewBBox() const
 {
     // Bounding box includes soldermask too
@@ -742,6 +742,8 @@ public:
 
     virtual unsigned int ViewGetLOD( int aLayer, KIGFX::VIEW* aView ) const override;
 
+    virtual double ViewGetProxyLOD( int aLayer, KIGFX::VIEW* aView ) const override;
+
     virtual const BOX2I ViewBBox() const override;
 
     /**
@@ -44,6 +44,7 @@
 
 #include <class_board.h>
 #include <class_pcb_text.h>
+#include <view/view.h>
 
 
 TEXTE_PCB::TEXTE_PCB( BOARD_ITEM* parent ) :
@@ -157,6 +158,13 @@ const EDA_RECT TEXTE_PCB::GetBoundingBox() const
 }
 
 
+double TEXTE_PCB::ViewGetProxyLOD( int aLayer, KIGFX::VIEW* aView ) const
+{
+    // Text is drawn as a box when it is too small to be read
+    return aView->GetProxyScale( GetTextHeight() );
+}
+
+
 void TEXTE_PCB::Rotate( const wxPoint& aRotCentre, double aAngle )
 {
     wxPoint pt = GetTextPos();
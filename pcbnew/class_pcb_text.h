@@ -123,6 +123,8 @@ public:
     // Virtual function
     const EDA_RECT GetBoundingBox() const override;
 
+    virtual double ViewGetProxyLOD( int aLayer, KIGFX::VIEW* aView ) const override;
+
     EDA_ITEM* Clone() const override;
 
     virtual void SwapData( BOARD_ITEM* aImage ) override;
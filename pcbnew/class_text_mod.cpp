@@ -509,6 +509,13 @@ unsigned int TEXTE_MODULE::ViewGetLOD( int aLayer, KIGFX::VIEW* aView ) const
 }
 
 
+double TEXTE_MODULE::ViewGetProxyLOD( int aLayer, KIGFX::VIEW* aView ) const
+{
+    // Text is drawn as a box when it is too small to be read
+    return aView->GetProxyScale( GetTextHeight() );
+}
+
+
 wxString TEXTE_MODULE::GetShownText() const
 {
     /* First order optimization: no % means that no processing is
@@ -47,6 +47,8 @@
 #include <zones.h>
 #include <math_for_graphics.h>
 #include <polygon_test_point_inside.h>
+#include <geometry/poly_grid_partition.h>
+#include <view/view.h>
 
 
 ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
@@ -65,6 +67,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( BOARD* aBoard ) :
     SetDoNotAllowVias( true );                  // has meaning only if m_isKeepout == true
     SetDoNotAllowTracks( true );                // has meaning only if m_isKeepout == true
     m_cornerRadius = 0;
+    m_decimatedFillTolerance = 0;
     SetLocalFlags( 0 );                         // flags tempoarry used in zone calculations
     m_Poly = new SHAPE_POLY_SET();              // Outlines
     aBoard->GetZoneSettings().ExportSetting( *this );
@@ -92,6 +95,7 @@ ZONE_CONTAINER::ZONE_CONTAINER( const ZONE_CONTAINER& aZone ) :
     m_ThermalReliefCopperBridge = aZone.m_ThermalReliefCopperBridge;
     m_FilledPolysList.Append( aZone.m_FilledPolysList );
     m_FillSegmList = aZone.m_FillSegmList;      // vector <> copy
+    m_decimatedFillTolerance = 0;
 
     m_isKeepout = aZone.m_isKeepout;
     m_doNotAllowCopperPour = aZone.m_doNotAllowCopperPour;
@@ -133,6 +137,7 @@ ZONE_CONTAINER& ZONE_CONTAINER::operator=( const ZONE_CONTAINER& aOther )
     m_FilledPolysList.Append( aOther.m_FilledPolysList );
     m_FillSegmList.clear();
     m_FillSegmList = aOther.m_FillSegmList;
+    invalidateFilledPolyCaches();
 
     SetLayerSet( aOther.GetLayerSet() );
 
@@ -161,6 +166,7 @@ bool ZONE_CONTAINER::UnFill()
     m_FilledPolysList.RemoveAllContours();
     m_FillSegmList.clear();
     m_IsFilled = false;
+    invalidateFilledPolyCaches();
 
     return change;
 }
@@ -262,6 +268,16 @@ void ZONE_CONTAINER::ViewGetLayers( int aLayers[], int& aCount ) const
 }
 
 
+double ZONE_CONTAINER::ViewGetProxyLOD( int aLayer, KIGFX::VIEW* aView ) const
+{
+    if( GetIsKeepout() )
+        return 0.0;
+
+    // The fill is decimated when its thinnest parts are too small to be seen
+    return aView->GetProxyScale( m_ZoneMinThickness );
+}
+
+
 bool ZONE_CONTAINER::IsOnLayer( PCB_LAYER_ID aLayer ) const
 {
     if( GetIsKeepout() )
@@ -805,7 +821,132 @@ int ZONE_CONTAINER::GetClearance( BOARD_CONNECTED_ITEM* aItem ) const
 
 bool ZONE_CONTAINER::HitTestFilledArea( const wxPoint& aRefPos ) const
 {
-    return m_FilledPolysList.Contains( VECTOR2I( aRefPos.x, aRefPos.y ) );
+    VECTOR2I pos( aRefPos.x, aRefPos.y );
+
+    for( int ii = 0; ii < m_FilledPolysList.OutlineCount(); ii++ )
+    {
+        // Filled areas are normally fractured; fall back to the generic test for
+        // polygons still carrying holes, which the grid partition does not handle.
+        if( m_FilledPolysList.HoleCount( ii ) > 0 )
+        {
+            if( m_FilledPolysList.Contains( pos, ii ) )
+                return true;
+
+            continue;
+        }
+
+        if( !m_FilledPolysList.COutline( ii ).BBox().Contains( pos ) )
+            continue;
+
+        if( GetFilledPolyGrid( ii )->ContainsPoint( pos ) )
+            return true;
+    }
+
+    return false;
+}
+
+
+std::shared_ptr<POLY_GRID_PARTITION> ZONE_CONTAINER::GetFilledPolyGrid( int aOutline ) const
+{
+    std::lock_guard<std::mutex> lock( m_filledPolyCacheLock );
+
+    if( (int) m_filledPolyGrids.size() != m_FilledPolysList.OutlineCount() )
+    {
+        m_filledPolyGrids.clear();
+        m_filledPolyGrids.resize( m_FilledPolysList.OutlineCount() );
+    }
+
+    auto& grid = m_filledPolyGrids[aOutline];
+
+    if( !grid )
+    {
+        SHAPE_LINE_CHAIN outline = m_FilledPolysList.COutline( aOutline );
+
+        outline.SetClosed( true );
+        outline.Simplify();
+
+        grid = std::make_shared<POLY_GRID_PARTITION>( outline );
+    }
+
+    return grid;
+}
+
+
+void ZONE_CONTAINER::invalidateFilledPolyCaches()
+{
+    std::lock_guard<std::mutex> lock( m_filledPolyCacheLock );
+
+    m_filledPolyGrids.clear();
+    m_decimatedFill.reset();
+}
+
+
+/**
+ * Returns a copy of \a aChain without the vertices closer than \a aTolerance to the
+ * previously kept vertex.  Chains that would degenerate are returned unchanged.
+ */
+static SHAPE_LINE_CHAIN decimateChain( const SHAPE_LINE_CHAIN& aChain, int aTolerance )
+{
+    SHAPE_LINE_CHAIN decimated;
+    const VECTOR2I::extended_type toleranceSq = (VECTOR2I::extended_type) aTolerance * aTolerance;
+
+    for( int ii = 0; ii < aChain.PointCount(); ii++ )
+    {
+        const VECTOR2I& p = aChain.CPoint( ii );
+
+        if( decimated.PointCount() == 0
+                || ( p - decimated.CPoint( -1 ) ).SquaredEuclideanNorm() >= toleranceSq )
+            decimated.Append( p );
+    }
+
+    if( decimated.PointCount() < 3 )
+        return aChain;
+
+    decimated.SetClosed( true );
+
+    return decimated;
+}
+
+
+std::shared_ptr<const SHAPE_POLY_SET> ZONE_CONTAINER::GetDecimatedFilledPolysList(
+        int aTolerance ) const
+{
+    std::lock_guard<std::mutex> lock( m_filledPolyCacheLock );
+
+    int tolerance = 1;
+
+    while( tolerance <= aTolerance / 2 )
+        tolerance *= 2;
+
+    tolerance = std::max( tolerance, m_ZoneMinThickness / 2 );
+
+    if( !m_decimatedFill || m_decimatedFillTolerance != tolerance )
+    {
+        std::shared_ptr<SHAPE_POLY_SET> decimated = std::make_shared<SHAPE_POLY_SET>();
+
+        for( int ii = 0; ii < m_FilledPolysList.OutlineCount(); ii++ )
+        {
+            decimated->AddOutline( decimateChain( m_FilledPolysList.COutline( ii ), tolerance ) );
+
+            for( int jj = 0; jj < m_FilledPolysList.HoleCount( ii ); jj++ )
+                decimated->AddHole( decimateChain( m_FilledPolysList.CHole( ii, jj ), tolerance ) );
+        }
+
+        // Dropping vertices can make the outlines cross each other (e.g. both sides of a
+        // fracture bridge), which the triangulation does not accept: let Clipper repair
+        // them, as the zone filler does for the full fill.
+        decimated->Fracture( SHAPE_POLY_SET::PM_FAST );
+
+        if( decimated->OutlineCount() == 0 && m_FilledPolysList.OutlineCount() > 0 )
+            *decimated = m_FilledPolysList;
+
+        decimated->CacheTriangulation();
+
+        m_decimatedFill = decimated;
+        m_decimatedFillTolerance = tolerance;
+    }
+
+    return m_decimatedFill;
 }
 
 
@@ -901,6 +1042,7 @@ void ZONE_CONTAINER::Move( const wxPoint& offset )
     Hatch();
 
     m_FilledPolysList.Move( VECTOR2I( offset.x, offset.y ) );
+    invalidateFilledPolyCaches();
 
     for( unsigned ic = 0; ic < m_FillSegmList.size(); ic++ )
     {
@@ -941,6 +1083,8 @@ void ZONE_CONTAINER::Rotate( const wxPoint& centre, double angle )
     for( auto ic = m_FilledPolysList.Iterate(); ic; ++ic )
         RotatePoint( &ic->x, &ic->y, centre.x, centre.y, angle );
 
+    invalidateFilledPolyCaches();
+
     for( unsigned ic = 0; ic < m_FillSegmList.size(); ic++ )
     {
         wxPoint a( m_FillSegmList[ic].A );
@@ -985,6 +1129,8 @@ void ZONE_CONTAINER::Mirror( const wxPoint& mirror_ref )
         ic->y = py + mirror_ref.y;
     }
 
+    invalidateFilledPolyCaches();
+
     for( unsigned ic = 0; ic < m_FillSegmList.size(); ic++ )
     {
         MIRROR( m_FillSegmList[ic].A.y, mirror_ref.y );
@@ -1281,6 +1427,13 @@ void ZONE_CONTAINER::SwapData( BOARD_ITEM* aImage )
 void ZONE_CONTAINER::CacheTriangulation()
 {
     m_FilledPolysList.CacheTriangulation();
+
+    // Warm up the point-in-polygon partitions while we are in a worker thread anyway
+    for( int ii = 0; ii < m_FilledPolysList.OutlineCount(); ii++ )
+    {
+        if( m_FilledPolysList.HoleCount( ii ) == 0 )
+            GetFilledPolyGrid( ii );
+    }
 }
 
 
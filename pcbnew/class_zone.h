@@ -32,6 +32,8 @@
 
 
 #include <vector>
+#include <memory>
+#include <mutex>
 #include <gr_basic.h>
 #include <class_board_item.h>
 #include <board_connected_item.h>
@@ -48,6 +50,7 @@ class PCB_EDIT_FRAME;
 class BOARD;
 class ZONE_CONTAINER;
 class MSG_PANEL_ITEM;
+class POLY_GRID_PARTITION;
 
 typedef std::vector<SEG> ZONE_SEGMENT_FILL;
 
@@ -177,6 +180,8 @@ public:
 
     virtual void ViewGetLayers( int aLayers[], int& aCount ) const override;
 
+    virtual double ViewGetProxyLOD( int aLayer, KIGFX::VIEW* aView ) const override;
+
     void SetFillMode( ZONE_FILL_MODE aFillMode )                   { m_FillMode = aFillMode; }
     ZONE_FILL_MODE GetFillMode() const                             { return m_FillMode; }
 
@@ -527,6 +532,7 @@ public:
     void ClearFilledPolysList()
     {
         m_FilledPolysList.RemoveAllContours();
+        invalidateFilledPolyCaches();
     }
 
    /**
@@ -551,8 +557,30 @@ public:
     void SetFilledPolysList( SHAPE_POLY_SET& aPolysList )
     {
         m_FilledPolysList = aPolysList;
+        invalidateFilledPolyCaches();
     }
 
+    /**
+     * Function GetFilledPolyGrid
+     * returns the point-in-polygon accelerator for the filled outline \a aOutline.
+     * It is built on first request and kept until the fill changes, so connectivity,
+     * DRC and hit-testing share a single instance.  Safe to call from several threads.
+     * @param aOutline = index of the outline in GetFilledPolysList()
+     */
+    std::shared_ptr<POLY_GRID_PARTITION> GetFilledPolyGrid( int aOutline ) const;
+
+    /**
+     * Function GetDecimatedFilledPolysList
+     * returns a triangulated copy of the filled polygons with the details smaller than
+     * a tolerance removed.  It is used to draw the zone when it is zoomed out.
+     * It is built on first request and kept until the fill changes or another tolerance is
+     * requested; the returned copy stays valid after a refill.
+     * @param aTolerance = size of the removed details, usually the size of a pixel.  It is
+     * rounded down to a power of two, so close zoom levels share the same copy, and is never
+     * less than half of the minimum thickness, which the fill outline covers anyway.
+     */
+    std::shared_ptr<const SHAPE_POLY_SET> GetDecimatedFilledPolysList( int aTolerance ) const;
+
     /**
       * Function SetFilledPolysList
       * sets the list of filled polygons.
@@ -674,6 +702,12 @@ public:
     virtual void SwapData( BOARD_ITEM* aImage ) override;
 
 private:
+    /**
+     * Function invalidateFilledPolyCaches
+     * drops the cached point-in-polygon partitions and decimated fill; must be called
+     * whenever m_FilledPolysList changes.
+     */
+    void invalidateFilledPolyCaches();
 
     SHAPE_POLY_SET*       m_Poly;                ///< Outline of the zone.
     int                   m_cornerSmoothingType;
@@ -742,6 +776,14 @@ private:
     SHAPE_POLY_SET        m_FilledPolysList;
     SHAPE_POLY_SET        m_RawPolysList;
 
+    /// Lazily built point-in-polygon partitions, one per outline of m_FilledPolysList.
+    mutable std::vector<std::shared_ptr<POLY_GRID_PARTITION>> m_filledPolyGrids;
+
+    /// Lazily built decimated copy of m_FilledPolysList, and the tolerance used to build it.
+    mutable std::shared_ptr<const SHAPE_POLY_SET> m_decimatedFill;
+    mutable int           m_decimatedFillTolerance;
+    mutable std::mutex    m_filledPolyCacheLock;
+
     HATCH_STYLE           m_hatchStyle;     // hatch style, see enum above
     int                   m_hatchPitch;     // for DIAGONAL_EDGE, distance between 2 hatch lines
     std::vector<SEG>      m_HatchLines;     // hatch lines
@@ -459,12 +459,9 @@ public:
         CN_ITEM( aParent, aCanChangeNet ),
         m_subpolyIndex( aSubpolyIndex )
     {
-        SHAPE_LINE_CHAIN outline = aParent->GetFilledPolysList().COutline( aSubpolyIndex );
-
-        outline.SetClosed( true );
-        outline.Simplify();
-
-        m_cachedPoly.reset( new POLY_GRID_PARTITION( outline, 16 ) );
+        // The partition is owned by the zone and shared with DRC and hit-testing,
+        // so it is only rebuilt when the zone fill changes.
+        m_cachedPoly = aParent->GetFilledPolyGrid( aSubpolyIndex );
     }
 
     int SubpolyIndex() const
@@ -496,7 +493,7 @@ public:
 
 private:
     std::vector<VECTOR2I> m_testOutlinePoints;
-    std::unique_ptr<POLY_GRID_PARTITION> m_cachedPoly;
+    std::shared_ptr<POLY_GRID_PARTITION> m_cachedPoly;
     int m_subpolyIndex;
 };
 
@@ -47,15 +47,6 @@
 #include <wx/stdpaths.h>
 
 
-// Keywords for read and write config
-#define ZerosFormatKey          wxT( "DrillZerosFormat" )
-#define MirrorKey               wxT( "DrillMirrorYOpt" )
-#define MinimalHeaderKey        wxT( "DrillMinHeader" )
-#define MergePTHNPTHKey         wxT( "DrillMergePTHNPTH" )
-#define UnitDrillInchKey        wxT( "DrillUnit" )
-#define DrillMapFileTypeKey     wxT( "DrillMapFileType" )
-#define DrillFileFormatKey      wxT( "DrillFileType" )
-
 // list of allowed precision for EXCELLON files, for integer format:
 // Due to difference between inches and mm,
 // there are 2 precision values, one for inches and one for metric
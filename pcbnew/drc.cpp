@@ -57,6 +57,7 @@
 #include <board_commit.h>
 #include <geometry/shape_segment.h>
 #include <geometry/shape_arc.h>
+#include <core/arena.h>
 
 void DRC::ShowDRCDialog( wxWindow* aParent )
 {
@@ -694,6 +695,9 @@ void DRC::testPad2Pad()
     // Upper limit of pad list (limit not included)
     D_PAD** listEnd = &sortedPads[0] + sortedPads.size();
 
+    // The pad outlines built for the clearance tests of one pad are discarded together
+    MONOTONIC_ARENA arena;
+
     // Test the pads
     for( unsigned i = 0; i< sortedPads.size(); ++i )
     {
@@ -702,7 +706,16 @@ void DRC::testPad2Pad()
         int    x_limit = max_size + pad->GetClearance() +
                          pad->GetBoundingRadius() + pad->GetPosition().x;
 
-        if( !doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit ) )
+        bool   ok;
+
+        {
+            ARENA_SCOPE arenaScope( arena );
+            ok = doPadToPadsDrc( pad, &sortedPads[i], listEnd, x_limit );
+        }
+
+        arena.Release();
+
+        if( !ok )
         {
             wxASSERT( m_currentMarker );
             addMarkerToPcb ( m_currentMarker );
@@ -73,12 +73,13 @@ EXCELLON_WRITER::EXCELLON_WRITER( BOARD* aPcb )
 }
 
 
-void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
+bool EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                                                  bool aGenDrill, bool aGenMap,
                                                  REPORTER * aReporter )
 {
     wxFileName  fn;
     wxString    msg;
+    bool        success = true;
 
     std::vector<DRILL_LAYER_PAIR> hole_sets = getUniqueLayerPairs();
 
@@ -115,6 +116,8 @@ void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                         msg.Printf( _( "** Unable to create %s **\n" ), GetChars( fullFilename ) );
                         aReporter->Report( msg );
                     }
+
+                    success = false;
                     break;
                 }
                 else
@@ -133,6 +136,8 @@ void EXCELLON_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
 
     if( aGenMap )
         CreateMapFilesSet( aPlotDirectory, aReporter );
+
+    return success;
 }
 
 
@@ -101,8 +101,9 @@ public:
      * @param aGenDrill = true to generate the EXCELLON drill file
      * @param aGenMap = true to generate a drill map file
      * @param aReporter = a REPORTER to return activity or any message (can be NULL)
+     * @return false if a drill file could not be created
      */
-    void CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
+    bool CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                                     bool aGenDrill, bool aGenMap,
                                     REPORTER * aReporter = NULL );
 
@@ -33,6 +33,16 @@
 
 class BOARD_ITEM;
 
+// Keywords of the drill options in the pcbnew config, used by the drill dialog and
+// by the plot jobs creating drill files
+#define ZerosFormatKey          wxT( "DrillZerosFormat" )
+#define MirrorKey               wxT( "DrillMirrorYOpt" )
+#define MinimalHeaderKey        wxT( "DrillMinHeader" )
+#define MergePTHNPTHKey         wxT( "DrillMergePTHNPTH" )
+#define UnitDrillInchKey        wxT( "DrillUnit" )
+#define DrillMapFileTypeKey     wxT( "DrillMapFileType" )
+#define DrillFileFormatKey      wxT( "DrillFileType" )
+
 
 // the DRILL_TOOL class  handles tools used in the excellon drill file:
 class DRILL_TOOL
@@ -59,7 +59,7 @@ GERBER_WRITER::GERBER_WRITER( BOARD* aPcb )
 }
 
 
-void GERBER_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
+bool GERBER_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                                                  bool aGenDrill, bool aGenMap,
                                                  REPORTER * aReporter )
 {
@@ -68,6 +68,7 @@ void GERBER_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
 
     wxFileName  fn;
     wxString    msg;
+    bool        success = true;
 
     std::vector<DRILL_LAYER_PAIR> hole_sets = getUniqueLayerPairs();
 
@@ -104,6 +105,8 @@ void GERBER_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
                         msg.Printf( _( "** Unable to create %s **\n" ), GetChars( fullFilename ) );
                         aReporter->Report( msg );
                     }
+
+                    success = false;
                     break;
                 }
                 else
@@ -121,6 +124,8 @@ void GERBER_WRITER::CreateDrillandMapFilesSet( const wxString& aPlotDirectory,
 
     if( aGenMap )
         CreateMapFilesSet( aPlotDirectory, aReporter );
+
+    return success;
 }
 
 // A helper class to transform an oblong hole to a segment
@@ -1085,6 +1085,10 @@ void PCB_BASE_FRAME::OnModify()
     GetScreen()->SetModify();
     GetScreen()->SetSave();
 
+    // Changes not made through a BOARD_COMMIT do not tell which layers they touched
+    if( m_Pcb && !m_Pcb->AreLayerChangesTracked() )
+        m_Pcb->MarkLayersChanged( LSET::AllLayersMask() );
+
     if( IsGalCanvasActive() )
     {
         UpdateStatusBar();
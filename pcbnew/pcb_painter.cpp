@@ -266,6 +266,15 @@ PCB_PAINTER::PCB_PAINTER( GAL* aGal ) :
 }
 
 
+PCB_PAINTER* PCB_PAINTER::Clone( GAL* aGal ) const
+{
+    PCB_PAINTER* painter = new PCB_PAINTER( aGal );
+    painter->m_pcbSettings = m_pcbSettings;
+
+    return painter;
+}
+
+
 int PCB_PAINTER::getLineThickness( int aActualThickness ) const
 {
     // if items have 0 thickness, draw them with the outline
@@ -343,6 +352,83 @@ bool PCB_PAINTER::Draw( const VIEW_ITEM* aItem, int aLayer )
 }
 
 
+bool PCB_PAINTER::DrawProxy( const VIEW_ITEM* aItem, int aLayer )
+{
+    const EDA_ITEM* item = dynamic_cast<const EDA_ITEM*>( aItem );
+
+    if( !item )
+        return false;
+
+    switch( item->Type() )
+    {
+    case PCB_PAD_T:
+        drawProxy( static_cast<const D_PAD*>( item ), aLayer );
+        break;
+
+    case PCB_TEXT_T:
+    {
+        const TEXTE_PCB* text = static_cast<const TEXTE_PCB*>( item );
+        drawProxy( text, text->GetTextAngleRadians(), m_pcbSettings.GetColor( text, aLayer ) );
+        break;
+    }
+
+    case PCB_MODULE_TEXT_T:
+    {
+        const TEXTE_MODULE* text = static_cast<const TEXTE_MODULE*>( item );
+        drawProxy( text, text->GetDrawRotationRadians(), m_pcbSettings.GetColor( text, aLayer ) );
+        break;
+    }
+
+    case PCB_ZONE_AREA_T:
+        draw( static_cast<const ZONE_CONTAINER*>( item ), aLayer, true );
+        break;
+
+    default:
+        return false;
+    }
+
+    return true;
+}
+
+
+void PCB_PAINTER::drawProxy( const D_PAD* aPad, int aLayer )
+{
+    VECTOR2D size( aPad->GetSize() );
+
+    m_gal->SetIsFill( true );
+    m_gal->SetIsStroke( false );
+    m_gal->SetFillColor( m_pcbSettings.GetColor( aPad, aLayer ) );
+
+    m_gal->Save();
+    m_gal->Translate( VECTOR2D( aPad->ShapePos() ) );
+    m_gal->Rotate( -aPad->GetOrientationRadians() );
+    m_gal->DrawRectangle( -size / 2.0, size / 2.0 );
+    m_gal->Restore();
+}
+
+
+void PCB_PAINTER::drawProxy( const EDA_TEXT* aText, double aAngle, const COLOR4D& aColor )
+{
+    if( aText->GetShownText().Length() == 0 )
+        return;
+
+    EDA_RECT box = aText->GetTextBox( -1 );
+    VECTOR2D position( aText->GetTextPos() );
+
+    // Strokes cover only a part of the text box, so make the box lighter
+    m_gal->SetIsFill( true );
+    m_gal->SetIsStroke( false );
+    m_gal->SetFillColor( aColor.WithAlpha( aColor.a * 0.5 ) );
+
+    m_gal->Save();
+    m_gal->Translate( position );
+    m_gal->Rotate( -aAngle );
+    m_gal->DrawRectangle( VECTOR2D( box.GetOrigin() ) - position,
+                          VECTOR2D( box.GetEnd() ) - position );
+    m_gal->Restore();
+}
+
+
 void PCB_PAINTER::draw( const TRACK* aTrack, int aLayer )
 {
     VECTOR2D start( aTrack->GetStart() );
@@ -1074,7 +1160,7 @@ void PCB_PAINTER::draw( const MODULE* aModule, int aLayer )
 }
 
 
-void PCB_PAINTER::draw( const ZONE_CONTAINER* aZone, int aLayer )
+void PCB_PAINTER::draw( const ZONE_CONTAINER* aZone, int aLayer, bool aDecimated )
 {
     if( !aZone->IsOnLayer( (PCB_LAYER_ID) aLayer ) )
         return;
@@ -1118,7 +1204,17 @@ void PCB_PAINTER::draw( const ZONE_CONTAINER* aZone, int aLayer )
     // Draw the filling
     if( displayMode != PCB_RENDER_SETTINGS::DZ_HIDE_FILLED )
     {
-        const SHAPE_POLY_SET& polySet = aZone->GetFilledPolysList();
+        // Keeps the decimated fill alive while it is drawn
+        std::shared_ptr<const SHAPE_POLY_SET> decimated;
+
+        if( aDecimated )
+        {
+            // Remove the details smaller than a pixel at the current scale
+            int pixelSize = KiROUND( 1.0 / m_gal->GetWorldScale() );
+            decimated = aZone->GetDecimatedFilledPolysList( pixelSize );
+        }
+
+        const SHAPE_POLY_SET& polySet = aDecimated ? *decimated : aZone->GetFilledPolysList();
 
         if( polySet.OutlineCount() == 0 )  // Nothing to draw
             return;
@@ -33,6 +33,7 @@
 
 
 class EDA_ITEM;
+class EDA_TEXT;
 class COLORS_DESIGN_SETTINGS;
 class PCB_DISPLAY_OPTIONS;
 
@@ -212,6 +213,12 @@ public:
     /// @copydoc PAINTER::Draw()
     virtual bool Draw( const VIEW_ITEM* aItem, int aLayer ) override;
 
+    /// @copydoc PAINTER::DrawProxy()
+    virtual bool DrawProxy( const VIEW_ITEM* aItem, int aLayer ) override;
+
+    /// @copydoc PAINTER::Clone()
+    virtual PCB_PAINTER* Clone( GAL* aGal ) const override;
+
 protected:
     PCB_RENDER_SETTINGS m_pcbSettings;
 
@@ -223,11 +230,15 @@ protected:
     void draw( const TEXTE_PCB* aText, int aLayer );
     void draw( const TEXTE_MODULE* aText, int aLayer );
     void draw( const MODULE* aModule, int aLayer );
-    void draw( const ZONE_CONTAINER* aZone, int aLayer );
+    void draw( const ZONE_CONTAINER* aZone, int aLayer, bool aDecimated = false );
     void draw( const DIMENSION* aDimension, int aLayer );
     void draw( const PCB_TARGET* aTarget );
     void draw( const MARKER_PCB* aMarker );
 
+    // Simplified representations used when items are too small to show their details
+    void drawProxy( const D_PAD* aPad, int aLayer );
+    void drawProxy( const EDA_TEXT* aText, double aAngle, const COLOR4D& aColor );
+
     /**
      * Function getLineThickness()
      * Get the thickness to draw for a line (e.g. 0 thickness lines
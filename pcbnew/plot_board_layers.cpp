@@ -369,11 +369,13 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
 
             // Now offset the pad size by margin + width_adj
             // this is easy for most shapes, but not for a trapezoid or a custom shape
+            // The pad is plotted from a copy: the board pads are not modified, so several
+            // layers can be plotted at the same time
+            D_PAD plotPad( *pad );
             wxSize padPlotsSize;
             wxSize extraSize = margin * 2;
             extraSize.x += width_adj;
             extraSize.y += width_adj;
-            wxSize deltaSize = pad->GetDelta(); // has meaning only for trapezoidal pads
 
             if( pad->GetShape() == PAD_SHAPE_TRAPEZOID )
             {   // The easy way is to use BuildPadPolygon to calculate
@@ -406,7 +408,7 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
                 else
                     delta.y = coord[1].x - coord[0].x;
 
-                pad->SetDelta( delta );
+                plotPad.SetDelta( delta );
             }
             else
                 padPlotsSize = pad->GetSize() + extraSize;
@@ -423,28 +425,25 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
             if( pad->GetLayerSet()[F_Cu] )
                 color = color.LegacyMix( aBoard->Colors().GetItemColor( LAYER_PAD_FR ) );
 
-            // Temporary set the pad size to the required plot size:
-            wxSize tmppadsize = pad->GetSize();
-
             switch( pad->GetShape() )
             {
             case PAD_SHAPE_CIRCLE:
             case PAD_SHAPE_OVAL:
-                pad->SetSize( padPlotsSize );
+                plotPad.SetSize( padPlotsSize );
 
                 if( aPlotOpt.GetSkipPlotNPTH_Pads() &&
-                    ( pad->GetSize() == pad->GetDrillSize() ) &&
-                    ( pad->GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED ) )
+                    ( plotPad.GetSize() == plotPad.GetDrillSize() ) &&
+                    ( plotPad.GetAttribute() == PAD_ATTRIB_HOLE_NOT_PLATED ) )
                     break;
 
-                itemplotter.PlotPad( pad, color, plotMode );
+                itemplotter.PlotPad( &plotPad, color, plotMode );
                 break;
 
             case PAD_SHAPE_TRAPEZOID:
             case PAD_SHAPE_RECT:
             case PAD_SHAPE_ROUNDRECT:
-                pad->SetSize( padPlotsSize );
-                itemplotter.PlotPad( pad, color, plotMode );
+                plotPad.SetSize( padPlotsSize );
+                itemplotter.PlotPad( &plotPad, color, plotMode );
                 break;
 
             case PAD_SHAPE_CUSTOM:
@@ -456,23 +455,19 @@ void PlotStandardLayer( BOARD *aBoard, PLOTTER* aPlotter,
                     // be sure the anchor pad is not bigger than the deflated shape
                     // because this anchor will be added to the pad shape when plotting
                     // the pad
-                    pad->SetSize( padPlotsSize );
+                    plotPad.SetSize( padPlotsSize );
 
-                D_PAD dummy( *pad );
                 SHAPE_POLY_SET shape;
-                pad->MergePrimitivesAsPolygon( &shape, 64 );
+                plotPad.MergePrimitivesAsPolygon( &shape, 64 );
                 shape.Inflate( margin.x, 32 );
-                dummy.DeletePrimitivesList();
-                dummy.AddPrimitive( shape, 0 );
-                dummy.MergePrimitivesAsPolygon();
+                plotPad.DeletePrimitivesList();
+                plotPad.AddPrimitive( shape, 0 );
+                plotPad.MergePrimitivesAsPolygon();
 
-                itemplotter.PlotPad( &dummy, color, plotMode );
+                itemplotter.PlotPad( &plotPad, color, plotMode );
                 }
                 break;
             }
-
-            pad->SetSize( tmppadsize );     // Restore the pad size
-            pad->SetDelta( deltaSize );
         }
 
         aPlotter->EndBlock( NULL );
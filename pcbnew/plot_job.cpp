@@ -0,0 +1,287 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcbnew/plot_job.cpp
+ */
+
+#include <fctsys.h>
+#include <common.h>
+#include <plotter.h>
+#include <reporter.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <pcbplot.h>
+#include <plot_job.h>
+#include <parallel_tasks.h>
+#include <gendrill_Excellon_writer.h>
+#include <gendrill_gerber_writer.h>
+#include <gerber_jobfile_writer.h>
+#include <wildcards_and_files_ext.h>
+
+#include <wx/config.h>
+
+#include <utility>
+#include <vector>
+
+
+/**
+ * Keeps the messages of a task run by a worker thread, to give them to the
+ * reporter of the job from the main thread
+ */
+class TASK_REPORTER : public REPORTER
+{
+public:
+    REPORTER& Report( const wxString& aText, SEVERITY aSeverity = RPT_UNDEFINED ) override
+    {
+        m_messages.push_back( std::make_pair( aText, aSeverity ) );
+        return *this;
+    }
+
+    bool HasMessage() const override
+    {
+        return !m_messages.empty();
+    }
+
+    void CopyTo( REPORTER* aReporter ) const
+    {
+        for( const auto& message : m_messages )
+            aReporter->Report( message.first, message.second );
+    }
+
+private:
+    std::vector< std::pair< wxString, SEVERITY > > m_messages;
+};
+
+
+/// A file of the job: the plot of a layer, or the drill files if m_layer is UNDEFINED_LAYER
+struct PLOT_TASK
+{
+    PCB_LAYER_ID  m_layer;
+    wxString      m_fullFilename;
+    bool          m_success;
+    TASK_REPORTER m_reporter;
+};
+
+
+PLOT_JOB::PLOT_JOB( BOARD* aBoard, const PCB_PLOT_PARAMS& aPlotOptions ) :
+    m_board( aBoard ),
+    m_plotOptions( aPlotOptions ),
+    m_createDrillFiles( false ),
+    m_drillFileType( 0 ),
+    m_drillUnitIsInch( true ),
+    m_drillZerosFormat( EXCELLON_WRITER::DECIMAL_FORMAT ),
+    m_drillMirror( false ),
+    m_drillMinimalHeader( false ),
+    m_drillMergePTHNPTH( false )
+{
+}
+
+
+void PLOT_JOB::LoadDrillOptions( wxConfigBase* aConfig )
+{
+    if( !aConfig )
+        return;
+
+    aConfig->Read( DrillFileFormatKey, &m_drillFileType );
+    aConfig->Read( UnitDrillInchKey, &m_drillUnitIsInch );
+    aConfig->Read( ZerosFormatKey, &m_drillZerosFormat );
+    aConfig->Read( MirrorKey, &m_drillMirror );
+    aConfig->Read( MinimalHeaderKey, &m_drillMinimalHeader );
+    aConfig->Read( MergePTHNPTHKey, &m_drillMergePTHNPTH );
+}
+
+
+bool PLOT_JOB::createDrillFiles( const wxString& aDirectory, REPORTER* aReporter ) const
+{
+    wxPoint offset;
+
+    if( m_plotOptions.GetUseAuxOrigin() )
+        offset = m_board->GetAuxOrigin();
+
+    // Same settings as the drill dialog
+    if( m_drillFileType == 0 )
+    {
+        EXCELLON_WRITER drillWriter( m_board );
+
+        drillWriter.SetFormat( !m_drillUnitIsInch,
+                               (EXCELLON_WRITER::ZEROS_FMT) m_drillZerosFormat );
+        drillWriter.SetOptions( m_drillMirror, m_drillMinimalHeader, offset,
+                                m_drillMergePTHNPTH );
+
+        return drillWriter.CreateDrillandMapFilesSet( aDirectory, true, false, aReporter );
+    }
+    else
+    {
+        GERBER_WRITER drillWriter( m_board );
+
+        drillWriter.SetFormat( m_plotOptions.GetGerberPrecision() );
+        drillWriter.SetOptions( offset );
+
+        return drillWriter.CreateDrillandMapFilesSet( aDirectory, true, false, aReporter );
+    }
+}
+
+
+bool PLOT_JOB::Run( REPORTER* aReporter )
+{
+    wxString msg;
+
+    m_outputFiles.Clear();
+
+    // Create output directory if it does not exist (also transform it in
+    // absolute form)
+    wxFileName  outputDir = wxFileName::DirName( m_plotOptions.GetOutputDirectory() );
+    wxString    boardFilename = m_board->GetFileName();
+
+    if( !EnsureFileDirectoryExists( &outputDir, boardFilename, aReporter ) )
+    {
+        if( aReporter )
+        {
+            msg.Printf( _( "Could not write plot files to folder \"%s\"." ),
+                        GetChars( outputDir.GetPath() ) );
+            aReporter->Report( msg, REPORTER::RPT_ERROR );
+        }
+
+        return false;
+    }
+
+    GERBER_JOBFILE_WRITER jobfile_writer( m_board, aReporter );
+    std::vector<PLOT_TASK> tasks;
+    wxString file_ext( GetDefaultPlotExtension( m_plotOptions.GetFormat() ) );
+
+    for( LSEQ seq = m_plotOptions.GetLayerSelection().UIOrder();  seq;  ++seq )
+    {
+        PCB_LAYER_ID layer = *seq;
+
+        // All copper layers that are disabled are actually selected
+        // This is due to wonkyness in automatically selecting copper layers
+        // for plotting when adding more than two layers to a board.
+        // This skips a copper layer if it is actually disabled on the board.
+        if( ( LSET::AllCuMask() & ~m_board->GetEnabledLayers() )[layer] )
+            continue;
+
+        // Pick the basename from the board file
+        wxFileName fn( boardFilename );
+
+        // Use Gerber Extensions based on layer number
+        // (See http://en.wikipedia.org/wiki/Gerber_File)
+        if( m_plotOptions.GetFormat() == PLOT_FORMAT_GERBER
+                && m_plotOptions.GetUseGerberProtelExtensions() )
+            file_ext = GetGerberProtelExtension( layer );
+
+        BuildPlotFileName( &fn, outputDir.GetPath(), m_board->GetLayerName( layer ), file_ext );
+        wxString fullname = fn.GetFullName();
+        jobfile_writer.AddGbrFile( layer, fullname );
+
+        tasks.emplace_back();
+        tasks.back().m_layer = layer;
+        tasks.back().m_fullFilename = fn.GetFullPath();
+        tasks.back().m_success = false;
+    }
+
+    if( m_createDrillFiles )
+    {
+        tasks.emplace_back();
+        tasks.back().m_layer = UNDEFINED_LAYER;
+        tasks.back().m_success = false;
+    }
+
+    // The bounding radius of the pads is computed on demand: compute it before
+    // the pads are read by several threads
+    for( MODULE* module = m_board->m_Modules; module; module = module->Next() )
+    {
+        for( D_PAD* pad = module->PadsList(); pad; pad = pad->Next() )
+            pad->GetBoundingRadius();
+    }
+
+    // The numbers are written with the C locale
+    PARALLEL_TASKS::Run( tasks.size(), [&]( size_t i )
+    {
+        PLOT_TASK& task = tasks[i];
+
+        if( task.m_layer == UNDEFINED_LAYER )
+        {
+            task.m_success = createDrillFiles( outputDir.GetFullPath(), &task.m_reporter );
+            return;
+        }
+
+        // Each plot gets its own options: StartPlotBoard() may modify them
+        PCB_PLOT_PARAMS plotOpts = m_plotOptions;
+        PLOTTER* plotter = StartPlotBoard( m_board, &plotOpts, task.m_layer,
+                                           task.m_fullFilename, wxEmptyString );
+
+        if( plotter )
+        {
+            PlotOneBoardLayer( m_board, plotter, task.m_layer, plotOpts );
+            task.m_success = plotter->EndPlot();
+            delete plotter;
+        }
+    }, true );
+
+    // Print diags, in the layer order
+    bool success = true;
+
+    for( const PLOT_TASK& task : tasks )
+    {
+        if( task.m_layer == UNDEFINED_LAYER )
+        {
+            if( !task.m_success )
+                success = false;
+
+            if( aReporter )
+                task.m_reporter.CopyTo( aReporter );
+
+            continue;
+        }
+
+        if( task.m_success )
+        {
+            m_outputFiles.Add( task.m_fullFilename );
+            msg.Printf( _( "Plot file \"%s\" created." ), GetChars( task.m_fullFilename ) );
+        }
+        else
+        {
+            success = false;
+            msg.Printf( _( "Unable to create file \"%s\"." ), GetChars( task.m_fullFilename ) );
+        }
+
+        if( aReporter )
+            aReporter->Report( msg, task.m_success ? REPORTER::RPT_ACTION : REPORTER::RPT_ERROR );
+    }
+
+    if( m_plotOptions.GetFormat() == PLOT_FORMAT_GERBER && m_plotOptions.GetCreateGerberJobFile() )
+    {
+        // Pick the basename from the board file
+        wxFileName fn( boardFilename );
+        // Build gerber job file from basename
+        BuildPlotFileName( &fn, outputDir.GetPath(), "job", GerberJobFileExtension );
+
+        if( jobfile_writer.CreateJobFile( fn.GetFullPath() ) )
+            m_outputFiles.Add( fn.GetFullPath() );
+        else
+            success = false;
+    }
+
+    return success;
+}
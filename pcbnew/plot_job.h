@@ -0,0 +1,105 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/**
+ * @file pcbnew/plot_job.h
+ */
+
+#ifndef PLOT_JOB_H_
+#define PLOT_JOB_H_
+
+#include <wx/arrstr.h>
+#include <pcb_plot_params.h>
+
+class BOARD;
+class REPORTER;
+class wxConfigBase;
+
+
+/**
+ * Plots a set of layers of a board, and optionally the Excellon drill files, in one go.
+ *
+ * Each layer is plotted in its own file, so the files are created at the same time by
+ * a pool of worker threads.  The board must not be modified while the job runs.
+ * The files are named like the files of the plot dialog, and a Gerber job file is
+ * created when the Gerber format and the job file option are selected.
+ */
+class PLOT_JOB
+{
+public:
+    /**
+     * @param aBoard is the board to plot
+     * @param aPlotOptions are the plot options; the layers to plot are the layer
+     * selection of the options, and the files are created in their output directory
+     */
+    PLOT_JOB( BOARD* aBoard, const PCB_PLOT_PARAMS& aPlotOptions );
+
+    /**
+     * Also create the drill files, in the plot output directory.  The drill files use
+     * the options of the drill dialog, see LoadDrillOptions(), and the drill origin of
+     * the plot options.
+     */
+    void SetCreateDrillFiles( bool aCreate ) { m_createDrillFiles = aCreate; }
+
+    /**
+     * Reads the drill file options (file format, units, zeros format, mirror, minimal
+     * header and PTH/NPTH merge) saved by the drill dialog.  Without this call, the
+     * defaults of the drill dialog are used.
+     * @param aConfig is the pcbnew config (can be NULL)
+     */
+    void LoadDrillOptions( wxConfigBase* aConfig );
+
+    /**
+     * Plots all the files.  Must be called from the main thread.
+     * @param aReporter receives the messages of each file once it is created (can be NULL)
+     * @return true if all the files were created
+     */
+    bool Run( REPORTER* aReporter = NULL );
+
+    /**
+     * @return the full filenames of the plot files created by the last Run()
+     */
+    const wxArrayString& GetOutputFiles() const { return m_outputFiles; }
+
+private:
+    /**
+     * Creates the drill files in aDirectory
+     * @return false if a file could not be created
+     */
+    bool createDrillFiles( const wxString& aDirectory, REPORTER* aReporter ) const;
+
+    BOARD*          m_board;
+    PCB_PLOT_PARAMS m_plotOptions;
+    bool            m_createDrillFiles;
+    wxArrayString   m_outputFiles;
+
+    // Drill file options, see LoadDrillOptions()
+    int             m_drillFileType;        ///< 0 for Excellon, 1 for Gerber X2
+    int             m_drillUnitIsInch;      ///< Excellon only
+    int             m_drillZerosFormat;     ///< an EXCELLON_WRITER::ZEROS_FMT
+    bool            m_drillMirror;          ///< Excellon only
+    bool            m_drillMinimalHeader;   ///< Excellon only
+    bool            m_drillMergePTHNPTH;    ///< Excellon only
+};
+
+#endif  // PLOT_JOB_H_
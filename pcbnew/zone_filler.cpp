@@ -46,6 +46,8 @@
 #include <geometry/convex_hull.h>
 #include <geometry/geometry_utils.h>
 #include <confirm.h>
+#include <trace_helpers.h>
+#include <core/arena.h>
 
 #include "zone_filler.h"
 
@@ -116,21 +118,39 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
             std::max<size_t>( std::thread::hardware_concurrency(), 2 ),
             toFill.size() );
 
+#ifdef KICAD_ARENA_STATS
+    ARENA_STATS statsBefore = MONOTONIC_ARENA::GetStats();
+#endif
+
     for( size_t ii = 0; ii < parallelThreadCount; ++ii )
     {
         std::thread t = std::thread( [ & ]()
         {
+            // Temporary geometry of each zone is allocated from this arena and
+            // dropped in one go once the results have been copied into the zone.
+            MONOTONIC_ARENA arena;
+
             for( size_t i = nextItem.fetch_add( 1 );
                     i < toFill.size();
                     i = nextItem.fetch_add( 1 ) )
             {
-                SHAPE_POLY_SET rawPolys, finalPolys;
                 ZONE_CONTAINER* zone = toFill[i].m_zone;
-                fillSingleZone( zone, rawPolys, finalPolys );
 
-                zone->SetRawPolysList( rawPolys );
-                zone->SetFilledPolysList( finalPolys );
-                zone->SetIsFilled( true );
+                {
+                    SHAPE_POLY_SET rawPolys, finalPolys;
+
+                    {
+                        ARENA_SCOPE arenaScope( arena );
+                        fillSingleZone( zone, rawPolys, finalPolys );
+                    }
+
+                    // Copies made outside the scope are heap allocated
+                    zone->SetRawPolysList( rawPolys );
+                    zone->SetFilledPolysList( finalPolys );
+                    zone->SetIsFilled( true );
+                }
+
+                arena.Release();
 
                 if( m_progressReporter )
                     m_progressReporter->AdvanceProgress();
@@ -152,6 +172,17 @@ bool ZONE_FILLER::Fill( std::vector<ZONE_CONTAINER*> aZones, bool aCheck )
         std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
     }
 
+#ifdef KICAD_ARENA_STATS
+    ARENA_STATS statsAfter = MONOTONIC_ARENA::GetStats();
+
+    wxLogTrace( traceArenaStats, "Zone fill: %lu arena allocations (%lu bytes, %lu blocks), "
+                "%lu heap allocations",
+                (unsigned long) ( statsAfter.arenaAllocs - statsBefore.arenaAllocs ),
+                (unsigned long) ( statsAfter.arenaBytes - statsBefore.arenaBytes ),
+                (unsigned long) ( statsAfter.arenaBlocks - statsBefore.arenaBlocks ),
+                (unsigned long) ( statsAfter.heapAllocs - statsBefore.heapAllocs ) );
+#endif
+
     // Now update the connectivity to check for copper islands
     if( m_progressReporter )
     {
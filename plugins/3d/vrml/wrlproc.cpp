@@ -21,6 +21,10 @@
  * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
  */
 
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cctype>
 #include <iostream>
 #include <sstream>
 #include <wx/filename.h>
@@ -277,6 +281,227 @@ bool WRLPROC::ReadGlob( std::string& aGlob )
 }
 
 
+// Locale independent number parsers.  They read the value in place from the line
+// buffer, the arrays of large models hold millions of values and a temporary
+// string and stream per value dominated the parse time.
+
+static const double s_pow10[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+
+// true if the character can follow a number in a VRML file
+static inline bool isNumberEnd( char aChar )
+{
+    return aChar <= 0x20 || ',' == aChar || '[' == aChar || ']' == aChar
+           || '{' == aChar || '}' == aChar || '#' == aChar;
+}
+
+
+static bool parseFloat( const char*& aText, float& aValue )
+{
+    const char* cp = aText;
+    bool negative = false;
+
+    if( '-' == *cp || '+' == *cp )
+        negative = ( '-' == *cp++ );
+
+    uint64_t mantissa = 0;
+    int      exponent = 0;
+    int      digits = 0;
+
+    for( ; *cp >= '0' && *cp <= '9'; ++cp, ++digits )
+    {
+        // extra digits beyond the precision of a double only scale the value
+        if( mantissa < 1000000000000000000ULL )
+            mantissa = mantissa * 10 + ( *cp - '0' );
+        else
+            ++exponent;
+    }
+
+    if( '.' == *cp )
+    {
+        for( ++cp; *cp >= '0' && *cp <= '9'; ++cp, ++digits )
+        {
+            if( mantissa < 1000000000000000000ULL )
+            {
+                mantissa = mantissa * 10 + ( *cp - '0' );
+                --exponent;
+            }
+        }
+    }
+
+    if( 0 == digits )
+        return false;
+
+    if( 'e' == *cp || 'E' == *cp )
+    {
+        ++cp;
+        bool negExp = false;
+
+        if( '-' == *cp || '+' == *cp )
+            negExp = ( '-' == *cp++ );
+
+        if( *cp < '0' || *cp > '9' )
+            return false;
+
+        int exp = 0;
+
+        for( ; *cp >= '0' && *cp <= '9'; ++cp )
+        {
+            if( exp < 10000 )
+                exp = exp * 10 + ( *cp - '0' );
+        }
+
+        exponent += negExp ? -exp : exp;
+    }
+
+    double value = (double) mantissa;
+
+    if( exponent < 0 )
+    {
+        if( exponent >= -22 )
+            value /= s_pow10[-exponent];
+        else
+            value *= std::pow( 10.0, exponent );
+    }
+    else if( exponent > 0 )
+    {
+        if( exponent <= 22 )
+            value *= s_pow10[exponent];
+        else
+            value *= std::pow( 10.0, exponent );
+    }
+
+    aValue = (float)( negative ? -value : value );
+    aText = cp;
+    return true;
+}
+
+
+static bool parseInt( const char*& aText, int& aValue )
+{
+    const char* cp = aText;
+    bool negative = false;
+
+    if( '-' == *cp || '+' == *cp )
+        negative = ( '-' == *cp++ );
+
+    long long value = 0;
+
+    if( '0' == cp[0] && ( 'x' == cp[1] || 'X' == cp[1] ) )
+    {
+        // Rules: "0x" + "0-9, A-F" - VRML is case sensitive but in
+        // this instance we do no enforce case.
+        cp += 2;
+
+        if( !isxdigit( (unsigned char) *cp ) )
+            return false;
+
+        for( ; isxdigit( (unsigned char) *cp ); ++cp )
+        {
+            int digit = ( *cp <= '9' ) ? *cp - '0' : ( tolower( *cp ) - 'a' + 10 );
+            value = ( value << 4 ) | digit;
+
+            if( value > 0xFFFFFFFFLL )
+                return false;
+        }
+
+        // hexadecimal values are bit patterns (e.g. SFImage pixels)
+        aValue = (int)(uint32_t) value;
+    }
+    else
+    {
+        if( *cp < '0' || *cp > '9' )
+            return false;
+
+        for( ; *cp >= '0' && *cp <= '9'; ++cp )
+        {
+            value = value * 10 + ( *cp - '0' );
+
+            if( value > INT_MAX )
+                return false;
+        }
+
+        aValue = (int) value;
+    }
+
+    if( negative )
+        aValue = -aValue;
+
+    aText = cp;
+    return true;
+}
+
+
+bool WRLPROC::readFloat( float& aValue )
+{
+    while( true )
+    {
+        if( !EatSpace() )
+            return false;
+
+        // if the text is the start of a comment block, clear the buffer and loop
+        if( '#' == m_buf[m_bufpos] )
+            m_buf.clear();
+        else
+            break;
+    }
+
+    const char* start = m_buf.c_str() + m_bufpos;
+    const char* cp = start;
+
+    if( !parseFloat( cp, aValue ) || !isNumberEnd( *cp ) )
+    {
+        m_error = "invalid character in floating point value";
+        return false;
+    }
+
+    m_bufpos += cp - start;
+
+    // the comma is a special instance of blank space
+    if( m_bufpos < m_buf.size() && ',' == m_buf[m_bufpos] )
+        ++m_bufpos;
+
+    return true;
+}
+
+
+bool WRLPROC::readInt( int& aValue )
+{
+    while( true )
+    {
+        if( !EatSpace() )
+            return false;
+
+        // if the text is the start of a comment block, clear the buffer and loop
+        if( '#' == m_buf[m_bufpos] )
+            m_buf.clear();
+        else
+            break;
+    }
+
+    const char* start = m_buf.c_str() + m_bufpos;
+    const char* cp = start;
+
+    if( !parseInt( cp, aValue ) || !isNumberEnd( *cp ) )
+    {
+        m_error = "invalid character in integer value";
+        return false;
+    }
+
+    m_bufpos += cp - start;
+
+    // the comma is a special instance of blank space
+    if( m_bufpos < m_buf.size() && ',' == m_buf[m_bufpos] )
+        ++m_bufpos;
+
+    return true;
+}
+
+
 bool WRLPROC::ReadName( std::string& aName )
 {
     aName.clear();
@@ -799,21 +1024,7 @@ bool WRLPROC::ReadSFFloat( float& aSFFloat )
     size_t fileline = m_fileline;
     size_t linepos = m_bufpos;
 
-    while( true )
-    {
-        if( !EatSpace() )
-            return false;
-
-        // if the text is the start of a comment block, clear the buffer and loop
-        if( '#' == m_buf[m_bufpos] )
-            m_buf.clear();
-        else
-            break;
-    }
-
-    std::string tmp;
-
-    if( !ReadGlob( tmp ) )
+    if( !readFloat( aSFFloat ) )
     {
         std::ostringstream ostr;
         ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
@@ -826,23 +1037,6 @@ bool WRLPROC::ReadSFFloat( float& aSFFloat )
         return false;
     }
 
-    std::istringstream istr;
-    istr.str( tmp );
-    istr >> aSFFloat;
-
-    if( istr.fail() || !istr.eof() )
-    {
-        std::ostringstream ostr;
-        ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-        ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-        ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-        ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-        ostr << " * [INFO] invalid character in SFFloat";
-        m_error = ostr.str();
-
-        return false;
-    }
-
     return true;
 }
 
@@ -859,21 +1053,7 @@ bool WRLPROC::ReadSFInt( int& aSFInt32 )
     size_t fileline = m_fileline;
     size_t linepos = m_bufpos;
 
-    while( true )
-    {
-        if( !EatSpace() )
-            return false;
-
-        // if the text is the start of a comment block, clear the buffer and loop
-        if( '#' == m_buf[m_bufpos] )
-            m_buf.clear();
-        else
-            break;
-    }
-
-    std::string tmp;
-
-    if( !ReadGlob( tmp ) )
+    if( !readInt( aSFInt32 ) )
     {
         std::ostringstream ostr;
         ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
@@ -886,33 +1066,6 @@ bool WRLPROC::ReadSFInt( int& aSFInt32 )
         return false;
     }
 
-    if( std::string::npos != tmp.find( "0x" ) )
-    {
-        // Rules: "0x" + "0-9, A-F" - VRML is case sensitive but in
-        // this instance we do no enforce case.
-        std::stringstream sstr;
-        sstr << std::hex << tmp;
-        sstr >> aSFInt32;
-        return true;
-    }
-
-    std::istringstream istr;
-    istr.str( tmp );
-    istr >> aSFInt32;
-
-    if( istr.fail() || !istr.eof() )
-    {
-        std::ostringstream ostr;
-        ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-        ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-        ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-        ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-        ostr << " * [INFO] invalid character in SFInt";
-        m_error = ostr.str();
-
-        return false;
-    }
-
     return true;
 }
 
@@ -945,12 +1098,11 @@ bool WRLPROC::ReadSFRotation( WRLROTATION& aSFRotation )
             break;
     }
 
-    std::string tmp;
     float trot[4];
 
     for( int i = 0; i < 4; ++i )
     {
-        if( !ReadGlob( tmp ) )
+        if( !readFloat( trot[i] ) )
         {
             std::ostringstream ostr;
             ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
@@ -962,24 +1114,6 @@ bool WRLPROC::ReadSFRotation( WRLROTATION& aSFRotation )
 
             return false;
         }
-
-        std::istringstream istr;
-        istr.str( tmp );
-        istr >> trot[i];
-
-        if( istr.fail() || !istr.eof() )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] invalid character in space delimited quartet";
-            m_error = ostr.str();
-
-            return false;
-        }
-
     }
 
     aSFRotation.x = trot[0];
@@ -1017,13 +1151,11 @@ bool WRLPROC::ReadSFVec2f( WRLVEC2F& aSFVec2f )
             break;
     }
 
-    std::string tmp;
-
     float tcol[2];
 
     for( int i = 0; i < 2; ++i )
     {
-        if( !ReadGlob( tmp ) )
+        if( !readFloat( tcol[i] ) )
         {
             std::ostringstream ostr;
             ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
@@ -1035,24 +1167,6 @@ bool WRLPROC::ReadSFVec2f( WRLVEC2F& aSFVec2f )
 
             return false;
         }
-
-        std::istringstream istr;
-        istr.str( tmp );
-        istr >> tcol[i];
-
-        if( istr.fail() || !istr.eof() )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] invalid character in space delimited pair";
-            m_error = ostr.str();
-
-            return false;
-        }
-
     }
 
     aSFVec2f.x = tcol[0];
@@ -1089,13 +1203,11 @@ bool WRLPROC::ReadSFVec3f( WRLVEC3F& aSFVec3f )
             break;
     }
 
-    std::string tmp;
-
     float tcol[3];
 
     for( int i = 0; i < 3; ++i )
     {
-        if( !ReadGlob( tmp ) )
+        if( !readFloat( tcol[i] ) )
         {
             std::ostringstream ostr;
             ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
@@ -1114,24 +1226,6 @@ bool WRLPROC::ReadSFVec3f( WRLVEC3F& aSFVec3f )
 
         if( ',' == m_buf[m_bufpos] )
             Pop();
-
-        std::istringstream istr;
-        istr.str( tmp );
-        istr >> tcol[i];
-
-        if( istr.fail() || !istr.eof() )
-        {
-            std::ostringstream ostr;
-            ostr << __FILE__ << ":" << __FUNCTION__ << ":" << __LINE__ << "\n";
-            ostr << " * [INFO] failed on file '" << m_filename << "'\n";
-            ostr << " * [INFO] line " << fileline << ", char " << linepos << " -- ";
-            ostr << "line " << m_fileline << ", char " << m_bufpos << "\n";
-            ostr << " * [INFO] invalid character in space delimited triplet";
-            m_error = ostr.str();
-
-            return false;
-        }
-
     }
 
     aSFVec3f.x = tcol[0];
@@ -1369,6 +1463,10 @@ bool WRLPROC::ReadMFColor( std::vector< WRLVEC3F >& aMFColor )
     }
 
     ++m_bufpos;
+
+    // the node keeps the array until the model is translated, drop the spare capacity
+    aMFColor.shrink_to_fit();
+
     return true;
 }
 
@@ -1481,6 +1579,10 @@ bool WRLPROC::ReadMFFloat( std::vector< float >& aMFFloat )
     }
 
     ++m_bufpos;
+
+    // the node keeps the array until the model is translated, drop the spare capacity
+    aMFFloat.shrink_to_fit();
+
     return true;
 }
 
@@ -1593,6 +1695,10 @@ bool WRLPROC::ReadMFInt( std::vector< int >& aMFInt32 )
     }
 
     ++m_bufpos;
+
+    // the node keeps the array until the model is translated, drop the spare capacity
+    aMFInt32.shrink_to_fit();
+
     return true;
 }
 
@@ -1817,6 +1923,10 @@ bool WRLPROC::ReadMFVec2f( std::vector< WRLVEC2F >& aMFVec2f )
     }
 
     ++m_bufpos;
+
+    // the node keeps the array until the model is translated, drop the spare capacity
+    aMFVec2f.shrink_to_fit();
+
     return true;
 }
 
@@ -1932,6 +2042,10 @@ bool WRLPROC::ReadMFVec3f( std::vector< WRLVEC3F >& aMFVec3f )
     }
 
     ++m_bufpos;
+
+    // the node keeps the array until the model is translated, drop the spare capacity
+    aMFVec3f.shrink_to_fit();
+
     return true;
 }
 
@@ -58,6 +58,11 @@ private:
     // parameters are updated as appropriate.
     bool getRawLine( void );
 
+    // readFloat and readInt parse a single number in place from the line buffer,
+    // skipping the leading white space and comments and a trailing comma.
+    bool readFloat( float& aValue );
+    bool readInt( int& aValue );
+
 public:
     WRLPROC( LINE_READER* aLineReader );
     ~WRLPROC();
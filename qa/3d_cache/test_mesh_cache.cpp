@@ -0,0 +1,205 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+#include <vector>
+
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include "3d_mesh_cache.h"
+#include "plugins/3dapi/ifsg_api.h"
+#include "mesh_test_utils.h"
+
+
+/**
+ * Writes a grid model to a temporary mesh cache file and removes the files at the end
+ */
+struct MeshCacheFixture
+{
+    MeshCacheFixture()
+    {
+        m_model = MakeGridModel( 40, 0.127f );
+        m_fileName = wxFileName::CreateTempFileName( wxT( "qa_3d_cache" ) );
+    }
+
+    ~MeshCacheFixture()
+    {
+        S3D::Destroy3DModel( &m_model );
+        wxRemoveFile( m_fileName );
+    }
+
+    std::vector<char> ReadFile()
+    {
+        std::vector<char> buffer;
+        wxFFile file( m_fileName, "rb" );
+
+        buffer.resize( file.Length() );
+        file.Read( buffer.data(), buffer.size() );
+
+        return buffer;
+    }
+
+    void WriteFile( const std::vector<char>& aBuffer, size_t aSize )
+    {
+        wxFFile file( m_fileName, "wb" );
+
+        file.Write( aBuffer.data(), aSize );
+    }
+
+    S3DMODEL* m_model;
+    wxString  m_fileName;
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( MeshCache, MeshCacheFixture )
+
+
+/**
+ * Check a model read back from its cache file matches the model, within the
+ * quantization of the file
+ */
+BOOST_AUTO_TEST_CASE( RoundTrip )
+{
+    BOOST_REQUIRE( WriteMeshCache( m_fileName, *m_model ) );
+
+    S3DMODEL* model = ReadMeshCache( m_fileName );
+
+    BOOST_REQUIRE( model );
+    BOOST_REQUIRE_EQUAL( model->m_MaterialsSize, m_model->m_MaterialsSize );
+    BOOST_REQUIRE_EQUAL( model->m_MeshesSize, m_model->m_MeshesSize );
+
+    const SMESH& ref = m_model->m_Meshes[0];
+    const SMESH& mesh = model->m_Meshes[0];
+
+    BOOST_REQUIRE_EQUAL( mesh.m_VertexSize, ref.m_VertexSize );
+    BOOST_REQUIRE_EQUAL( mesh.m_FaceIdxSize, ref.m_FaceIdxSize );
+    BOOST_CHECK_EQUAL( mesh.m_MaterialIdx, ref.m_MaterialIdx );
+    BOOST_REQUIRE( mesh.m_Texcoords && mesh.m_Color );
+
+    for( unsigned int i = 0; i < ref.m_FaceIdxSize; ++i )
+        BOOST_CHECK_EQUAL( mesh.m_FaceIdx[i], ref.m_FaceIdx[i] );
+
+    SFVEC3F bmin = ref.m_Positions[0];
+    SFVEC3F bmax = ref.m_Positions[0];
+
+    for( unsigned int i = 1; i < ref.m_VertexSize; ++i )
+    {
+        bmin = glm::min( bmin, ref.m_Positions[i] );
+        bmax = glm::max( bmax, ref.m_Positions[i] );
+    }
+
+    // Positions are rounded to the nearest of 65536 steps of the mesh bounding box
+    const SFVEC3F maxError = ( bmax - bmin ) / ( 2.0f * 65535.0f ) + SFVEC3F( 1e-5f );
+
+    for( unsigned int i = 0; i < ref.m_VertexSize; ++i )
+    {
+        const SFVEC3F error = glm::abs( mesh.m_Positions[i] - ref.m_Positions[i] );
+
+        BOOST_CHECK_LE( error.x, maxError.x );
+        BOOST_CHECK_LE( error.y, maxError.y );
+        BOOST_CHECK_LE( error.z, maxError.z );
+
+        BOOST_CHECK_GE( glm::dot( mesh.m_Normals[i], ref.m_Normals[i] ), 0.9999f );
+
+        BOOST_CHECK_EQUAL( mesh.m_Texcoords[i].x, ref.m_Texcoords[i].x );
+        BOOST_CHECK_EQUAL( mesh.m_Texcoords[i].y, ref.m_Texcoords[i].y );
+
+        const SFVEC3F colorError = glm::abs( mesh.m_Color[i] - ref.m_Color[i] );
+
+        BOOST_CHECK_LE( std::max( colorError.r, std::max( colorError.g, colorError.b ) ),
+                        0.5f / 255.0f + 1e-6f );
+    }
+
+    S3D::Destroy3DModel( &model );
+}
+
+
+/**
+ * Check a file cut anywhere is rejected
+ */
+BOOST_AUTO_TEST_CASE( Truncated )
+{
+    BOOST_REQUIRE( WriteMeshCache( m_fileName, *m_model ) );
+
+    const std::vector<char> buffer = ReadFile();
+
+    BOOST_REQUIRE( buffer.size() > 64 );
+
+    for( size_t size = 0; size < buffer.size(); size += 1 + buffer.size() / 64 )
+    {
+        WriteFile( buffer, size );
+        BOOST_CHECK_MESSAGE( !ReadMeshCache( m_fileName ), "file cut at " << size );
+    }
+
+    WriteFile( buffer, buffer.size() - 1 );
+    BOOST_CHECK( !ReadMeshCache( m_fileName ) );
+}
+
+
+/**
+ * Check files with a bad header or with out of range data are rejected
+ */
+BOOST_AUTO_TEST_CASE( Corrupted )
+{
+    BOOST_REQUIRE( WriteMeshCache( m_fileName, *m_model ) );
+
+    const std::vector<char> buffer = ReadFile();
+    std::vector<char> corrupted = buffer;
+
+    corrupted[0] = 'X';
+    WriteFile( corrupted, corrupted.size() );
+    BOOST_CHECK( !ReadMeshCache( m_fileName ) );
+
+    // the version follows the magic
+    corrupted = buffer;
+    corrupted[4] ^= 0x7f;
+    WriteFile( corrupted, corrupted.size() );
+    BOOST_CHECK( !ReadMeshCache( m_fileName ) );
+
+    // the file ends with the 16 bit face indexes; the grid has an even number of
+    // triangles, so there is no padding after the last index
+    corrupted = buffer;
+    corrupted[corrupted.size() - 1] = (char) 0xff;
+    corrupted[corrupted.size() - 2] = (char) 0xff;
+    WriteFile( corrupted, corrupted.size() );
+    BOOST_CHECK( !ReadMeshCache( m_fileName ) );
+
+    // the unmodified file is still read
+    WriteFile( buffer, buffer.size() );
+
+    S3DMODEL* model = ReadMeshCache( m_fileName );
+
+    BOOST_CHECK( model );
+
+    if( model )
+        S3D::Destroy3DModel( &model );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
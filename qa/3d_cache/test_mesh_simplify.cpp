@@ -0,0 +1,158 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <vector>
+
+#include "3d_mesh_simplify.h"
+#include "plugins/3dapi/ifsg_api.h"
+#include "mesh_test_utils.h"
+
+
+/**
+ * @return the largest distance between a vertex of aFrom and the closest vertex of aTo.
+ * The vertexes of aTo are sorted in cells of size aRange, only the distances below
+ * aRange are exact.
+ */
+static float maxClosestDistance( const SMESH& aFrom, const SMESH& aTo, float aRange )
+{
+    typedef std::tuple<int, int, int> CELL;
+    std::map< CELL, std::vector<unsigned int> > cells;
+
+    auto cellOf = [&]( const SFVEC3F& aPoint, int aDx, int aDy, int aDz )
+    {
+        return CELL( (int) std::floor( aPoint.x / aRange ) + aDx,
+                     (int) std::floor( aPoint.y / aRange ) + aDy,
+                     (int) std::floor( aPoint.z / aRange ) + aDz );
+    };
+
+    for( unsigned int i = 0; i < aTo.m_VertexSize; ++i )
+        cells[cellOf( aTo.m_Positions[i], 0, 0, 0 )].push_back( i );
+
+    float maxDistance = 0.0f;
+
+    for( unsigned int i = 0; i < aFrom.m_VertexSize; ++i )
+    {
+        const SFVEC3F& point = aFrom.m_Positions[i];
+        float closest = FLT_MAX;
+
+        for( int dx = -1; dx <= 1; ++dx )
+        {
+            for( int dy = -1; dy <= 1; ++dy )
+            {
+                for( int dz = -1; dz <= 1; ++dz )
+                {
+                    auto it = cells.find( cellOf( point, dx, dy, dz ) );
+
+                    if( it == cells.end() )
+                        continue;
+
+                    for( unsigned int v : it->second )
+                        closest = std::min( closest, glm::length( aTo.m_Positions[v] - point ) );
+                }
+            }
+        }
+
+        maxDistance = std::max( maxDistance, closest );
+    }
+
+    return maxDistance;
+}
+
+
+BOOST_AUTO_TEST_SUITE( MeshSimplify )
+
+
+/**
+ * Check the simplified models are within the requested error of the model, for the
+ * error bounds of the levels of detail
+ */
+BOOST_AUTO_TEST_CASE( ErrorBound )
+{
+    S3DMODEL* model = MakeGridModel( 150, 0.1f );
+    const unsigned int nTriangles = GetModelTriangleCount( *model );
+
+    BOOST_REQUIRE_EQUAL( nTriangles, 2u * 150 * 150 );
+
+    for( float maxError : { 0.25f, 0.5f, 1.0f } )
+    {
+        S3DMODEL* simplified = SimplifyModel( *model, maxError );
+
+        BOOST_REQUIRE( simplified );
+        BOOST_REQUIRE_EQUAL( simplified->m_MeshesSize, 1u );
+        BOOST_CHECK_LT( GetModelTriangleCount( *simplified ), nTriangles );
+
+        const SMESH& mesh = model->m_Meshes[0];
+        const SMESH& result = simplified->m_Meshes[0];
+
+        // Every vertex is replaced by a vertex closer than the error, and every new
+        // vertex is close to the vertexes it replaces
+        BOOST_CHECK_LE( maxClosestDistance( mesh, result, maxError ), maxError * 1.0001f );
+        BOOST_CHECK_LE( maxClosestDistance( result, mesh, maxError ), maxError * 1.0001f );
+
+        for( unsigned int i = 0; i < result.m_FaceIdxSize; ++i )
+            BOOST_CHECK_LT( result.m_FaceIdx[i], result.m_VertexSize );
+
+        S3D::Destroy3DModel( &simplified );
+    }
+
+    S3D::Destroy3DModel( &model );
+}
+
+
+/**
+ * Check the models below MIN_LOD_TRIANGLES are not simplified, whatever the error
+ */
+BOOST_AUTO_TEST_CASE( LightModels )
+{
+    // the largest grid below the limit
+    const unsigned int cells = (unsigned int) std::sqrt( ( MIN_LOD_TRIANGLES - 1 ) / 2.0 );
+    S3DMODEL* model = MakeGridModel( cells, 0.1f );
+
+    BOOST_REQUIRE_LT( GetModelTriangleCount( *model ), (unsigned int) MIN_LOD_TRIANGLES );
+    BOOST_CHECK( !SimplifyModel( *model, 1.0f ) );
+
+    S3D::Destroy3DModel( &model );
+
+    // the smallest grid above the limit
+    model = MakeGridModel( cells + 1, 0.1f );
+
+    BOOST_REQUIRE_GE( GetModelTriangleCount( *model ), (unsigned int) MIN_LOD_TRIANGLES );
+
+    S3DMODEL* simplified = SimplifyModel( *model, 1.0f );
+
+    BOOST_CHECK( simplified );
+
+    if( simplified )
+        S3D::Destroy3DModel( &simplified );
+
+    S3D::Destroy3DModel( &model );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,109 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+/**
+ * Main file for the 3D model cache tests to be compiled
+ */
+
+#define BOOST_TEST_MAIN
+#define BOOST_TEST_MODULE "3D model cache tests"
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <cmath>
+
+#include "plugins/3dapi/ifsg_api.h"
+#include "mesh_test_utils.h"
+
+
+S3DMODEL* MakeGridModel( unsigned int aCells, float aSpacing )
+{
+    const unsigned int side = aCells + 1;
+    const unsigned int nv = side * side;
+    const unsigned int ni = 6 * aCells * aCells;
+
+    S3DMODEL* model = S3D::New3DModel();
+
+    model->m_MaterialsSize = 1;
+    model->m_Materials = new SMATERIAL[1];
+    S3D::Init3DMaterial( model->m_Materials[0] );
+
+    model->m_MeshesSize = 1;
+    model->m_Meshes = new SMESH[1];
+
+    SMESH& mesh = model->m_Meshes[0];
+    S3D::Init3DMesh( mesh );
+
+    mesh.m_VertexSize = nv;
+    mesh.m_Positions = new SFVEC3F[nv];
+    mesh.m_Normals = new SFVEC3F[nv];
+    mesh.m_Texcoords = new SFVEC2F[nv];
+    mesh.m_Color = new SFVEC3F[nv];
+
+    // A gently waving sheet, away from the origin
+    for( unsigned int y = 0; y < side; ++y )
+    {
+        for( unsigned int x = 0; x < side; ++x )
+        {
+            const unsigned int i = y * side + x;
+            const float px = -1.3f + x * aSpacing;
+            const float py = 2.7f + y * aSpacing;
+            const float pz = 0.1f * std::sin( 0.7f * px ) * std::cos( 0.3f * py );
+
+            const float dzdx = 0.07f * std::cos( 0.7f * px ) * std::cos( 0.3f * py );
+            const float dzdy = -0.03f * std::sin( 0.7f * px ) * std::sin( 0.3f * py );
+
+            mesh.m_Positions[i] = SFVEC3F( px, py, pz );
+            mesh.m_Normals[i] = glm::normalize( SFVEC3F( -dzdx, -dzdy, 1.0f ) );
+            mesh.m_Texcoords[i] = SFVEC2F( (float) x / aCells, (float) y / aCells );
+            mesh.m_Color[i] = SFVEC3F( (float) x / aCells, (float) y / aCells, 0.5f );
+        }
+    }
+
+    mesh.m_FaceIdxSize = ni;
+    mesh.m_FaceIdx = new unsigned int[ni];
+
+    unsigned int* idx = mesh.m_FaceIdx;
+
+    for( unsigned int y = 0; y < aCells; ++y )
+    {
+        for( unsigned int x = 0; x < aCells; ++x )
+        {
+            const unsigned int i = y * side + x;
+
+            *idx++ = i;
+            *idx++ = i + 1;
+            *idx++ = i + side;
+
+            *idx++ = i + 1;
+            *idx++ = i + side + 1;
+            *idx++ = i + side;
+        }
+    }
+
+    mesh.m_MaterialIdx = 0;
+
+    return model;
+}
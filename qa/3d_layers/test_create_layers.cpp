@@ -0,0 +1,237 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+#include <boost/test/unit_test.hpp>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <fctsys.h>
+#include <class_board.h>
+#include <class_module.h>
+#include <class_pcb_text.h>
+#include <class_track.h>
+#include <kicad_plugin.h>
+
+#include <3d_canvas/cinfo3d_visu.h>
+
+
+/**
+ * Loads a board and builds its 3D layers, to compare an incremental rebuild after
+ * changes with a full build of the changed board
+ */
+struct CreateLayersFixture
+{
+    CreateLayersFixture()
+    {
+        PLUGIN::RELEASER pi( new PCB_IO );
+        m_board.reset( pi->Load( QA_DATA_DIR "/complex_hierarchy.kicad_pcb", NULL, NULL ) );
+
+        Setup( m_settings );
+        m_settings.InitSettings( NULL );
+    }
+
+    void Setup( CINFO3D_VISU& aSettings )
+    {
+        aSettings.SetBoard( m_board.get() );
+        aSettings.SetFlag( FL_ZONE, true );
+        aSettings.SetFlag( FL_SILKSCREEN, true );
+        aSettings.SetFlag( FL_SOLDERMASK, true );
+        aSettings.SetFlag( FL_SOLDERPASTE, true );
+        aSettings.SetFlag( FL_ADHESIVE, true );
+    }
+
+    /**
+     * Reports a modified item to the board, like BOARD_COMMIT::Push() does.  The
+     * commit itself needs an edit frame; the added and removed items are reported
+     * by BOARD::Add() and BOARD::Remove().
+     */
+    void CommitModify( BOARD_ITEM* aItem, BOARD_ITEM* aCopy )
+    {
+        m_board->MarkItemLayersChanged( aItem );
+        m_board->MarkItemLayersChanged( aCopy );
+    }
+
+    std::unique_ptr<BOARD> m_board;
+    CINFO3D_VISU           m_settings;  ///< settings built before the changes
+};
+
+
+/// The bounding boxes of the objects of a container, in a stable order
+static std::vector< std::array<float, 4> > objectBoxes( const CBVHCONTAINER2D* aContainer )
+{
+    std::vector< std::array<float, 4> > boxes;
+
+    for( const COBJECT2D* object : aContainer->GetList() )
+    {
+        const CBBOX2D& bbox = object->GetBBox();
+
+        boxes.push_back( { { bbox.Min().x, bbox.Min().y, bbox.Max().x, bbox.Max().y } } );
+    }
+
+    std::sort( boxes.begin(), boxes.end() );
+
+    return boxes;
+}
+
+
+static void checkSameContainer( const CBVHCONTAINER2D* aA, const CBVHCONTAINER2D* aB )
+{
+    BOOST_REQUIRE_EQUAL( aA->GetList().size(), aB->GetList().size() );
+    BOOST_CHECK( objectBoxes( aA ) == objectBoxes( aB ) );
+}
+
+
+static void checkSameContainers( const MAP_CONTAINER_2D& aA, const MAP_CONTAINER_2D& aB )
+{
+    BOOST_REQUIRE_EQUAL( aA.size(), aB.size() );
+
+    for( const auto& entry : aA )
+    {
+        auto it = aB.find( entry.first );
+
+        BOOST_REQUIRE_MESSAGE( it != aB.end(), "missing layer " << entry.first );
+        BOOST_TEST_CHECKPOINT( "layer " << entry.first );
+        checkSameContainer( entry.second, it->second );
+    }
+}
+
+
+static void checkSamePolys( const SHAPE_POLY_SET& aA, const SHAPE_POLY_SET& aB )
+{
+    BOOST_CHECK_EQUAL( aA.OutlineCount(), aB.OutlineCount() );
+    BOOST_CHECK_EQUAL( aA.TotalVertices(), aB.TotalVertices() );
+}
+
+
+static void checkSamePolys( const MAP_POLY& aA, const MAP_POLY& aB )
+{
+    BOOST_REQUIRE_EQUAL( aA.size(), aB.size() );
+
+    for( const auto& entry : aA )
+    {
+        auto it = aB.find( entry.first );
+
+        BOOST_REQUIRE_MESSAGE( it != aB.end(), "missing layer " << entry.first );
+        BOOST_TEST_CHECKPOINT( "layer " << entry.first );
+        checkSamePolys( *entry.second, *it->second );
+    }
+}
+
+
+static void checkSameLayers( const CINFO3D_VISU& aA, const CINFO3D_VISU& aB )
+{
+    checkSameContainers( aA.GetMapLayers(), aB.GetMapLayers() );
+    checkSameContainers( aA.GetMapLayersHoles(), aB.GetMapLayersHoles() );
+
+    checkSamePolys( aA.GetPolyMap(), aB.GetPolyMap() );
+    checkSamePolys( aA.GetPolyMapHoles_Inner(), aB.GetPolyMapHoles_Inner() );
+    checkSamePolys( aA.GetPolyMapHoles_Outer(), aB.GetPolyMapHoles_Outer() );
+
+    checkSameContainer( &aA.GetThroughHole_Outer(), &aB.GetThroughHole_Outer() );
+    checkSameContainer( &aA.GetThroughHole_Inner(), &aB.GetThroughHole_Inner() );
+    checkSameContainer( &aA.GetThroughHole_Vias_Outer(), &aB.GetThroughHole_Vias_Outer() );
+    checkSameContainer( &aA.GetThroughHole_Vias_Inner(), &aB.GetThroughHole_Vias_Inner() );
+
+    checkSamePolys( aA.GetThroughHole_Outer_poly(), aB.GetThroughHole_Outer_poly() );
+    checkSamePolys( aA.GetThroughHole_Outer_poly_NPTH(), aB.GetThroughHole_Outer_poly_NPTH() );
+    checkSamePolys( aA.GetThroughHole_Inner_poly(), aB.GetThroughHole_Inner_poly() );
+}
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( CreateLayers, CreateLayersFixture )
+
+
+/**
+ * Check a rebuild without changes keeps every layer
+ */
+BOOST_AUTO_TEST_CASE( NoChange )
+{
+    const CBVHCONTAINER2D* frontCopper = m_settings.GetMapLayers().at( F_Cu );
+    const CBVHCONTAINER2D* frontSilk = m_settings.GetMapLayers().at( F_SilkS );
+
+    m_settings.InitSettings( NULL );
+
+    BOOST_CHECK( m_settings.GetMapLayers().at( F_Cu ) == frontCopper );
+    BOOST_CHECK( m_settings.GetMapLayers().at( F_SilkS ) == frontSilk );
+}
+
+
+/**
+ * Check the layers rebuilt after a track is moved, a text added and a footprint
+ * removed are the layers of a full build of the changed board
+ */
+BOOST_AUTO_TEST_CASE( IncrementalEqualsFull )
+{
+    const CBVHCONTAINER2D* backSilk = m_settings.GetMapLayers().at( B_SilkS );
+
+    // Move a front track
+    TRACK* track = m_board->m_Track;
+
+    while( track && ( track->Type() != PCB_TRACE_T || track->GetLayer() != F_Cu ) )
+        track = track->Next();
+
+    BOOST_REQUIRE( track );
+
+    std::unique_ptr<BOARD_ITEM> trackCopy( static_cast<BOARD_ITEM*>( track->Clone() ) );
+    track->Move( wxPoint( Millimeter2iu( 0.5 ), Millimeter2iu( 0.25 ) ) );
+    CommitModify( track, trackCopy.get() );
+
+    // Add a front silkscreen text inside the board
+    TEXTE_PCB* text = new TEXTE_PCB( m_board.get() );
+    text->SetText( wxT( "QA" ) );
+    text->SetLayer( F_SilkS );
+    text->SetTextPos( track->GetStart() );
+    m_board->Add( text );
+
+    // Remove a front footprint
+    MODULE* module = m_board->m_Modules;
+
+    while( module && module->GetLayer() != F_Cu )
+        module = module->Next();
+
+    BOOST_REQUIRE( module );
+
+    m_board->Remove( module );
+    delete module;
+
+    m_settings.InitSettings( NULL );
+
+    // the back silkscreen did not change, it is not rebuilt
+    BOOST_CHECK( m_settings.GetMapLayers().at( B_SilkS ) == backSilk );
+
+    CINFO3D_VISU full;
+
+    Setup( full );
+    full.InitSettings( NULL );
+
+    checkSameLayers( m_settings, full );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
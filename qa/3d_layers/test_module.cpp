@@ -0,0 +1,67 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+
+/**
+ * Main file for the 3D viewer board layers tests to be compiled
+ */
+
+#define BOOST_TEST_MODULE "3D viewer board layers tests"
+
+#include <boost/test/unit_test.hpp>
+
+#include <wx/init.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <kiway.h>
+
+
+static struct PGM_QA_3D_LAYERS : public PGM_BASE
+{
+    void MacOpenFile( const wxString& aFileName ) override {}
+}
+program;
+
+
+/**
+ * Initializes wxWidgets and the pcbnew kiface once for all the tests.
+ */
+struct LAYERS_TEST_SETUP
+{
+    LAYERS_TEST_SETUP()
+    {
+        wxInitialize();
+
+        // The pcbnew code gets the program object from the kiface getter
+        int kifaceVersion;
+        KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+    }
+
+    ~LAYERS_TEST_SETUP()
+    {
+        wxUninitialize();
+    }
+};
+
+BOOST_GLOBAL_FIXTURE( LAYERS_TEST_SETUP );
@@ -0,0 +1,164 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+#include <boost/test/test_case_template.hpp>
+
+#include <core/arena.h>
+#include <geometry/shape_line_chain.h>
+
+#include <memory>
+#include <vector>
+
+
+struct ArenaFixture
+{
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( Arena, ArenaFixture )
+
+
+/**
+ * Check that allocations are aligned and that big requests get their own block
+ */
+BOOST_AUTO_TEST_CASE( Allocate )
+{
+    MONOTONIC_ARENA arena( 256 );
+
+    for( int i = 0; i < 100; ++i )
+    {
+        void* p = arena.Allocate( 3 + i, 16 );
+        BOOST_CHECK_EQUAL( reinterpret_cast<uintptr_t>( p ) % 16, 0 );
+    }
+
+    void* big = arena.Allocate( 4096 );
+    BOOST_CHECK( big != nullptr );
+
+    arena.Release();
+    BOOST_CHECK( arena.Allocate( 8 ) != nullptr );
+}
+
+
+/**
+ * Check that line chains bind to the current arena only while a scope is active,
+ * and that copies made outside the scope do not depend on the arena
+ */
+BOOST_AUTO_TEST_CASE( LineChainScope )
+{
+    MONOTONIC_ARENA arena;
+    SHAPE_LINE_CHAIN persistent;
+
+    BOOST_CHECK( MONOTONIC_ARENA::Current() == nullptr );
+
+    {
+        SHAPE_LINE_CHAIN temp;
+
+        {
+            ARENA_SCOPE scope( arena );
+
+            BOOST_CHECK( MONOTONIC_ARENA::Current() == &arena );
+
+            SHAPE_LINE_CHAIN chain;
+
+            for( int i = 0; i < 1000; ++i )
+                chain.Append( i, 2 * i );
+
+            BOOST_CHECK( chain.CPoints().get_allocator().Arena() == &arena );
+            temp = chain;
+        }
+
+        BOOST_CHECK( MONOTONIC_ARENA::Current() == nullptr );
+        BOOST_CHECK( temp.CPoints().get_allocator().Arena() == nullptr );
+
+        SHAPE_LINE_CHAIN copy( temp );
+        persistent = copy;
+    }
+
+    arena.Release();
+
+    BOOST_CHECK_EQUAL( persistent.PointCount(), 1000 );
+    BOOST_CHECK_EQUAL( persistent.CPoint( 999 ), VECTOR2I( 999, 1998 ) );
+}
+
+
+/**
+ * Check that a long-lived container keeps its own memory when it is assigned or swapped
+ * with a container of an arena, so it stays valid once the arena is released
+ */
+BOOST_AUTO_TEST_CASE( NoPropagation )
+{
+    typedef ARENA_ALLOCATOR<int>             ALLOC;
+    typedef std::allocator_traits<ALLOC>     TRAITS;
+    typedef std::vector<int, ALLOC>          VECTOR;
+
+    BOOST_CHECK( !TRAITS::propagate_on_container_swap::value );
+    BOOST_CHECK( !TRAITS::propagate_on_container_move_assignment::value );
+    BOOST_CHECK( !TRAITS::propagate_on_container_copy_assignment::value );
+
+    MONOTONIC_ARENA arena;
+    VECTOR persistent( 10, 1 );
+    VECTOR assigned;
+
+    {
+        ARENA_SCOPE scope( arena );
+
+        VECTOR temp( 1000, 2 );
+        VECTOR moved( 500, 3 );
+
+        BOOST_CHECK( temp.get_allocator().Arena() == &arena );
+
+        SwapArenaContainers( persistent, temp );
+        assigned = std::move( moved );
+
+        BOOST_CHECK( persistent.get_allocator().Arena() == nullptr );
+        BOOST_CHECK( temp.get_allocator().Arena() == &arena );
+        BOOST_CHECK( assigned.get_allocator().Arena() == nullptr );
+        BOOST_CHECK_EQUAL( temp.size(), 10 );
+
+        // Same arena: the storage itself is swapped
+        VECTOR other( 5, 4 );
+        const int* data = other.data();
+
+        SwapArenaContainers( temp, other );
+        BOOST_CHECK( temp.data() == data );
+    }
+
+    arena.Release();
+
+    // Reuse the released blocks, so a dangling container would see other values
+    {
+        ARENA_SCOPE scope( arena );
+        VECTOR overwrite( 2000, 9 );
+    }
+
+    BOOST_CHECK_EQUAL( persistent.size(), 1000 );
+    BOOST_CHECK_EQUAL( persistent[999], 2 );
+    BOOST_CHECK_EQUAL( assigned.size(), 500 );
+    BOOST_CHECK_EQUAL( assigned[499], 3 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
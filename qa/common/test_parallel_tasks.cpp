@@ -0,0 +1,104 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <parallel_tasks.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+
+struct ParallelTasksFixture
+{
+};
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( ParallelTasks, ParallelTasksFixture )
+
+
+/**
+ * Check each task runs once, whatever the number of threads
+ */
+BOOST_AUTO_TEST_CASE( EachTaskOnce )
+{
+    const size_t taskCounts[] = { 0, 1, 2, 7, 1000 };
+    const size_t threadCounts[] = { 0, 1, 3, 64 };
+
+    for( size_t taskCount : taskCounts )
+    {
+        for( size_t threadCount : threadCounts )
+        {
+            BOOST_TEST_CHECKPOINT( "tasks " << taskCount << ", threads " << threadCount );
+
+            std::vector<std::atomic<int>> runs( taskCount );
+
+            for( std::atomic<int>& run : runs )
+                run = 0;
+
+            PARALLEL_TASKS::Run( taskCount, [&]( size_t i ) { runs[i]++; }, false,
+                                 threadCount );
+
+            for( size_t ii = 0; ii < taskCount; ++ii )
+                BOOST_REQUIRE_EQUAL( runs[ii].load(), 1 );
+        }
+    }
+}
+
+
+/**
+ * Check the tasks are done when IsDone() is true, and Cancel() skips the tasks
+ * not started yet
+ */
+BOOST_AUTO_TEST_CASE( PollAndCancel )
+{
+    const size_t taskCount = 100;
+    std::atomic<size_t> done( 0 );
+
+    PARALLEL_TASKS tasks( taskCount, [&]( size_t ) { done++; }, false, 2 );
+
+    while( !tasks.IsDone() )
+        std::this_thread::yield();
+
+    BOOST_CHECK_EQUAL( done.load(), taskCount );
+
+    std::atomic<size_t> started( 0 );
+    PARALLEL_TASKS cancelled( taskCount, [&]( size_t )
+    {
+        if( started++ == 0 )
+            std::this_thread::sleep_for( std::chrono::milliseconds( 50 ) );
+    }, false, 1 );
+
+    cancelled.Cancel();
+    cancelled.Wait();
+
+    BOOST_CHECK( cancelled.IsDone() );
+    BOOST_CHECK_LT( started.load(), taskCount );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,189 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see CHANGELOG.TXT for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+#include <boost/test/unit_test.hpp>
+
+#include <richio.h>
+#include <wrlproc.h>
+
+#include <locale>
+#include <sstream>
+
+
+/**
+ * Parses VRML text with WRLPROC.  The numeric readers parse the values in place
+ * from the line buffer, the tests check them against the values the previous
+ * std::istringstream based readers gave for the same text.
+ */
+struct WrlprocFixture
+{
+    WrlprocFixture() :
+        m_reader( nullptr ),
+        m_proc( nullptr )
+    {
+    }
+
+    ~WrlprocFixture()
+    {
+        delete m_proc;
+        delete m_reader;
+    }
+
+    WRLPROC& Open( const std::string& aBody )
+    {
+        delete m_proc;
+        delete m_reader;
+
+        m_reader = new STRING_LINE_READER( "#VRML V2.0 utf8\n" + aBody, "test.wrl" );
+        m_proc = new WRLPROC( m_reader );
+        return *m_proc;
+    }
+
+    STRING_LINE_READER* m_reader;
+    WRLPROC*            m_proc;
+};
+
+
+// The value the stream based reader gave for a number token
+template<typename T>
+static T streamValue( const std::string& aToken )
+{
+    std::istringstream istr;
+    istr.imbue( std::locale::classic() );
+    istr.str( aToken );
+
+    T value = 0;
+    istr >> value;
+    return value;
+}
+
+
+/**
+ * Declares a struct as the Boost test fixture.
+ */
+BOOST_FIXTURE_TEST_SUITE( Wrlproc, WrlprocFixture )
+
+
+/**
+ * Check the coordinates of a point array, with the separators, comments and line
+ * breaks found in exported models
+ */
+BOOST_AUTO_TEST_CASE( MFVec3f )
+{
+    const std::vector<std::string> tokens = {
+        "0", "1", "-1",
+        "+2.5", "0.001", "1e-3",
+        "-4.75E+2", "3.14159265", ".5",
+        "5.", "-0.3937", "12345.678",
+        "2.54e1", "-0.000001", "0.635"
+    };
+
+    const std::string body =
+        "[ 0 1 -1, +2.5 0.001 1e-3,\n"
+        "  # a comment between two points\n"
+        "  -4.75E+2\t3.14159265 .5,5.\n"
+        "  -0.3937 12345.678\n"
+        "  2.54e1 -0.000001 0.635 ]\n";
+
+    WRLPROC& proc = Open( body );
+    std::vector<WRLVEC3F> points;
+
+    BOOST_REQUIRE( proc.ReadMFVec3f( points ) );
+    BOOST_REQUIRE_EQUAL( points.size(), tokens.size() / 3 );
+
+    for( size_t i = 0; i < points.size(); ++i )
+    {
+        BOOST_CHECK_EQUAL( points[i].x, streamValue<float>( tokens[i * 3] ) );
+        BOOST_CHECK_EQUAL( points[i].y, streamValue<float>( tokens[i * 3 + 1] ) );
+        BOOST_CHECK_EQUAL( points[i].z, streamValue<float>( tokens[i * 3 + 2] ) );
+    }
+}
+
+
+/**
+ * Check the indices of a face set, including the -1 face separators and the
+ * hexadecimal form
+ */
+BOOST_AUTO_TEST_CASE( MFInt32 )
+{
+    const std::vector<int> expected = { 0, 1, 2, -1, 2, 3, 0, -1, 255, 16, -1, 100000 };
+
+    const std::string body =
+        "[ 0, 1, 2, -1,\n"
+        "  2 3 0 -1 # quad split in two\n"
+        "  0xFF,0x10 -1\n"
+        "  +100000 ]\n";
+
+    WRLPROC& proc = Open( body );
+    std::vector<int> indices;
+
+    BOOST_REQUIRE( proc.ReadMFInt( indices ) );
+    BOOST_CHECK_EQUAL_COLLECTIONS( indices.begin(), indices.end(),
+                                   expected.begin(), expected.end() );
+}
+
+
+/**
+ * Check a single value in place of an array, and that the parser continues after
+ * the last value
+ */
+BOOST_AUTO_TEST_CASE( SingleValues )
+{
+    WRLPROC& proc = Open( "1.5 -2 3e2\n7\n" );
+
+    std::vector<WRLVEC3F> points;
+    BOOST_REQUIRE( proc.ReadMFVec3f( points ) );
+    BOOST_REQUIRE_EQUAL( points.size(), 1 );
+    BOOST_CHECK_EQUAL( points[0].x, 1.5f );
+    BOOST_CHECK_EQUAL( points[0].y, -2.0f );
+    BOOST_CHECK_EQUAL( points[0].z, 300.0f );
+
+    int value = 0;
+    BOOST_REQUIRE( proc.ReadSFInt( value ) );
+    BOOST_CHECK_EQUAL( value, 7 );
+}
+
+
+/**
+ * Check that malformed numbers are rejected rather than read partially
+ */
+BOOST_AUTO_TEST_CASE( InvalidValues )
+{
+    const std::vector<std::string> floats = { "abc", "1.2.3", "1e", "-", "2x" };
+
+    for( const auto& text : floats )
+    {
+        float value;
+        BOOST_CHECK_MESSAGE( !Open( text + "\n" ).ReadSFFloat( value ), text );
+    }
+
+    const std::vector<std::string> ints = { "1.5", "0x", "0xFFFFFFFFF", "99999999999" };
+
+    for( const auto& text : ints )
+    {
+        int value;
+        BOOST_CHECK_MESSAGE( !Open( text + "\n" ).ReadSFInt( value ), text );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,195 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Loads VRML / X3D models with the VRML plugin and reports the load time and the
+ * peak memory used by each load, above the memory in use before the load.  Typical
+ * input: the large manufacturer models (connectors, QFN/BGA packages) of the KiCad
+ * packages3D library.  The peak memory is only reported on Linux.
+ *
+ * usage: vrml_benchmark [-r repeat_count] model.wrl [model.wrl ...]
+ */
+
+#include <wx/init.h>
+
+#include <plugins/3d/3d_plugin.h>
+#include <plugins/3dapi/ifsg_all.h>
+#include <profile.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __linux__
+#include <fstream>
+#include <string>
+#endif
+
+
+#ifdef __linux__
+// Read a memory field (in kB) of /proc/self/status
+static long readStatusField( const char* aField )
+{
+    std::ifstream status( "/proc/self/status" );
+    std::string line;
+    size_t len = strlen( aField );
+
+    while( std::getline( status, line ) )
+    {
+        if( line.compare( 0, len, aField ) == 0 )
+            return atol( line.c_str() + len + 1 );
+    }
+
+    return -1;
+}
+#endif
+
+
+// Current resident memory in kB, or -1 if not known
+static long currentRSS()
+{
+#ifdef __linux__
+    return readStatusField( "VmRSS" );
+#else
+    return -1;
+#endif
+}
+
+
+// Peak resident memory in kB since the last resetPeakRSS(), or -1 if not known
+static long peakRSS()
+{
+#ifdef __linux__
+    return readStatusField( "VmHWM" );
+#else
+    return -1;
+#endif
+}
+
+
+static void resetPeakRSS()
+{
+#ifdef __linux__
+    // Linux 4.0 and later reset the peak RSS (VmHWM) when "5" is written here
+    FILE* fp = fopen( "/proc/self/clear_refs", "w" );
+
+    if( fp )
+    {
+        fputs( "5", fp );
+        fclose( fp );
+    }
+#endif
+}
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return 1;
+    }
+
+    int repeat = 3;
+    int first = 1;
+
+    if( argc > 2 && strcmp( argv[1], "-r" ) == 0 )
+    {
+        repeat = std::max( 1, atoi( argv[2] ) );
+        first = 3;
+    }
+
+    if( first >= argc )
+    {
+        fprintf( stderr, "usage: %s [-r repeat_count] model.wrl [model.wrl ...]\n", argv[0] );
+        return 1;
+    }
+
+    printf( "%-40s %10s %10s %10s %12s %12s\n",
+            "model", "min ms", "avg ms", "vertices", "base kB", "peak+ kB" );
+
+    int errors = 0;
+
+    for( int i = first; i < argc; ++i )
+    {
+        double minTime = 0.0;
+        double totalTime = 0.0;
+        unsigned int nVertices = 0;
+        long peak = -1;
+        long base = -1;
+        bool ok = true;
+
+        for( int run = 0; run < repeat && ok; ++run )
+        {
+            base = currentRSS();
+            resetPeakRSS();
+
+            PROF_COUNTER counter;
+            SCENEGRAPH* scene = Load( argv[i] );
+            counter.Stop();
+
+            if( !scene )
+            {
+                ok = false;
+                break;
+            }
+
+            peak = std::max( peak, peakRSS() - base );
+
+            if( run == 0 || counter.msecs() < minTime )
+                minTime = counter.msecs();
+
+            totalTime += counter.msecs();
+
+            if( run == 0 )
+            {
+                S3DMODEL* model = S3D::GetModel( scene );
+
+                for( unsigned int j = 0; model && j < model->m_MeshesSize; ++j )
+                    nVertices += model->m_Meshes[j].m_VertexSize;
+
+                S3D::Destroy3DModel( &model );
+            }
+
+            S3D::DestroyNode( (SGNODE*) scene );
+        }
+
+        const char* name = strrchr( argv[i], '/' );
+        name = name ? name + 1 : argv[i];
+
+        if( !ok )
+        {
+            printf( "%-40s failed to load\n", name );
+            ++errors;
+            continue;
+        }
+
+        printf( "%-40s %10.1f %10.1f %10u %12ld %12ld\n",
+                name, minTime, totalTime / repeat, nVertices, base, peak );
+    }
+
+    return errors ? 1 : 0;
+}
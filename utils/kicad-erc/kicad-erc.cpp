@@ -0,0 +1,342 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Runs the electrical rules check of a schematic hierarchy, and writes the ERC markers
+ * in a JSON report, with the time taken by each step.  The symbols are found in the
+ * symbol library tables (global and project) and in the project cache library.
+ * Meant for build scripts and continuous integration, it does not need a display.
+ *
+ * The exit status is 0 if the schematic has no ERC error (warnings are allowed), 1 if
+ * it has errors or cannot be read, 2 if it is not fully annotated and 3 on command
+ * line errors.
+ */
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+#include <wx/ffile.h>
+#include <wx/filename.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <kiway.h>
+#include <project.h>
+#include <macros.h>
+#include <profile.h>
+#include <reporter.h>
+#include <convert_to_biu.h>
+#include <wildcards_and_files_ext.h>
+#include <general.h>
+#include <class_library.h>
+#include <symbol_lib_table.h>
+#include <sch_io_mgr.h>
+#include <sch_sheet.h>
+#include <sch_sheet_path.h>
+#include <sch_screen.h>
+#include <sch_component.h>
+#include <sch_collectors.h>
+#include <sch_marker.h>
+#include <sch_reference_list.h>
+#include <netlist_object.h>
+#include <erc.h>
+#include <json11.hpp>
+
+#include <cstdio>
+#include <memory>
+#include <string>
+
+
+extern int DiagErc[PINTYPE_COUNT][PINTYPE_COUNT];
+extern int DefaultDiagErc[PINTYPE_COUNT][PINTYPE_COUNT];
+
+
+/**
+ * The program object of the eeschema code: the tool has no application window,
+ * and uses the environment variables of the process.
+ */
+static struct PGM_KICAD_ERC : public PGM_BASE
+{
+    void MacOpenFile( const wxString& aFileName ) override {}
+}
+program;
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help", "show this help message",
+      wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "o", "output",
+      "JSON report file (default: the schematic file with a json extension)",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_SWITCH, NULL, "unique-global-labels",
+      "report the global labels connected to no other global label",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_SWITCH, NULL, "no-similar-labels",
+      "do not report the labels differing only by their case",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_PARAM, NULL, NULL, "root schematic file",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_NONE }
+};
+
+
+/**
+ * Finds the library symbols of the components of all the screens, in the symbol
+ * library tables and, for the symbols not found, in the project cache library.
+ */
+static void resolveSymbols( PROJECT& aProject, const wxFileName& aRootFile )
+{
+    SYMBOL_LIB_TABLE::LoadGlobalTable( SYMBOL_LIB_TABLE::GetGlobalLibTable() );
+
+    SYMBOL_LIB_TABLE libTable( &SYMBOL_LIB_TABLE::GetGlobalLibTable() );
+    wxFileName       libTableFile( aRootFile.GetPath(),
+                                   SYMBOL_LIB_TABLE::GetSymbolLibTableFileName() );
+
+    if( libTableFile.FileExists() )
+        libTable.Load( libTableFile.GetFullPath() );
+
+    std::unique_ptr<PART_LIB> cacheLib;
+    wxString cacheName = PART_LIBS::CacheName( aProject.GetProjectFullName() );
+
+    if( !cacheName.IsEmpty() )
+    {
+        cacheLib.reset( PART_LIB::LoadLibrary( cacheName ) );
+        cacheLib->SetCache();
+    }
+
+    SCH_SCREENS screens;
+
+    for( SCH_SCREEN* screen = screens.GetFirst(); screen; screen = screens.GetNext() )
+    {
+        SCH_TYPE_COLLECTOR components;
+
+        components.Collect( screen->GetDrawItems(), SCH_COLLECTOR::ComponentsOnly );
+        SCH_COMPONENT::ResolveAll( components, libTable, cacheLib.get() );
+    }
+}
+
+
+/**
+ * @return the report of the ERC markers of all the sheets
+ */
+static json11::Json buildReport( const wxFileName& aRootFile, int& aErrorCount )
+{
+    SCH_SHEET_LIST      sheetList( g_RootSheet );
+    json11::Json::array sheets;
+    int                 warningCount = 0;
+
+    aErrorCount = 0;
+
+    for( unsigned i = 0; i < sheetList.size(); i++ )
+    {
+        json11::Json::array markers;
+
+        for( SCH_ITEM* item = sheetList[i].LastDrawList(); item; item = item->Next() )
+        {
+            if( item->Type() != SCH_MARKER_T )
+                continue;
+
+            SCH_MARKER* marker = (SCH_MARKER*) item;
+
+            if( marker->GetMarkerType() != MARKER_BASE::MARKER_ERC )
+                continue;
+
+            const DRC_ITEM& drcItem = marker->GetReporter();
+            const char*     severity = "info";
+
+            if( marker->GetErrorLevel() == MARKER_BASE::MARKER_SEVERITY_ERROR )
+            {
+                severity = "error";
+                aErrorCount++;
+            }
+            else if( marker->GetErrorLevel() == MARKER_BASE::MARKER_SEVERITY_WARNING )
+            {
+                severity = "warning";
+                warningCount++;
+            }
+
+            json11::Json::object entry
+            {
+                { "code",     drcItem.GetErrorCode() },
+                { "severity", severity },
+                { "message",  TO_UTF8( drcItem.GetErrorText() ) },
+                { "item",     TO_UTF8( drcItem.GetTextA() ) },
+                { "x_mm",     Iu2Millimeter( drcItem.GetPointA().x ) },
+                { "y_mm",     Iu2Millimeter( drcItem.GetPointA().y ) },
+            };
+
+            if( drcItem.HasSecondItem() )
+            {
+                entry["aux_item"] = TO_UTF8( drcItem.GetTextB() );
+                entry["aux_x_mm"] = Iu2Millimeter( drcItem.GetPointB().x );
+                entry["aux_y_mm"] = Iu2Millimeter( drcItem.GetPointB().y );
+            }
+
+            markers.push_back( entry );
+        }
+
+        sheets.push_back( json11::Json::object
+        {
+            { "path",    TO_UTF8( sheetList[i].PathHumanReadable() ) },
+            { "markers", markers },
+        } );
+    }
+
+    return json11::Json::object
+    {
+        { "schematic", TO_UTF8( aRootFile.GetFullPath() ) },
+        { "errors",    aErrorCount },
+        { "warnings",  warningCount },
+        { "sheets",    sheets },
+    };
+}
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return 3;
+    }
+
+    wxCmdLineParser parser( g_cmdLineDesc, argc, argv );
+
+    switch( parser.Parse() )
+    {
+    case 0:
+        break;
+
+    case -1:    // help requested
+        return 0;
+
+    default:
+        return 3;
+    }
+
+    wxFileName rootFile( parser.GetParam( 0 ) );
+    rootFile.MakeAbsolute();
+
+    wxFileName reportFile( rootFile );
+    reportFile.SetExt( "json" );
+
+    wxString reportName;
+
+    if( parser.Found( "output", &reportName ) )
+        reportFile = wxFileName( reportName );
+
+    // The eeschema code gets the program object from the kiface getter
+    int kifaceVersion;
+    KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+
+    KIWAY kiway( &program, KFCTL_STANDALONE );
+    wxFileName projectFile( rootFile );
+    projectFile.SetExt( ProjectFileExtension );
+    kiway.Prj().SetProjectFullName( projectFile.GetFullPath() );
+
+    // Load the schematic hierarchy
+    unsigned stats_startLoadTime = GetRunningMicroSecs();
+
+    try
+    {
+        SCH_PLUGIN::SCH_PLUGIN_RELEASER pi( SCH_IO_MGR::FindPlugin( SCH_IO_MGR::SCH_LEGACY ) );
+
+        g_RootSheet = pi->Load( rootFile.GetFullPath(), &kiway );
+
+        if( !pi->GetError().IsEmpty() )
+        {
+            fprintf( stderr, "Error loading the hierarchical sheets:\n%s\n",
+                     TO_UTF8( pi->GetError() ) );
+            return 1;
+        }
+
+        resolveSymbols( kiway.Prj(), rootFile );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        fprintf( stderr, "Error loading schematic: %s\n", TO_UTF8( ioe.What() ) );
+        return 1;
+    }
+
+    unsigned stats_endLoadTime = GetRunningMicroSecs();
+
+    SCH_SHEET_LIST sheets( g_RootSheet );
+    sheets.AnnotatePowerSymbols();
+
+    SCH_REFERENCE_LIST components;
+    sheets.GetComponents( components );
+
+    if( components.CheckAnnotation( STDOUT_REPORTER::GetInstance() ) )
+    {
+        fprintf( stderr, "Annotation required\n" );
+        return 2;
+    }
+
+    // Build the connections
+    unsigned stats_startNetlistTime = GetRunningMicroSecs();
+    NETLIST_OBJECT_LIST netlist;
+    netlist.BuildNetListInfo( sheets );
+    unsigned stats_endNetlistTime = GetRunningMicroSecs();
+
+    // Run the same tests as the ERC dialog, with the default pin conflict table
+    memcpy( DiagErc, DefaultDiagErc, sizeof( DiagErc ) );
+
+    unsigned stats_startErcTime = GetRunningMicroSecs();
+    TestDuplicateSheetNames( true );
+    TestMultiunitFootprints( sheets );
+    TestConnections( &netlist, parser.Found( "unique-global-labels" ),
+                     !parser.Found( "no-similar-labels" ) );
+    unsigned stats_endErcTime = GetRunningMicroSecs();
+
+    int errorCount;
+    json11::Json::object report = buildReport( rootFile, errorCount ).object_items();
+
+    report["timing_ms"] = json11::Json::object
+    {
+        { "load",    ( stats_endLoadTime - stats_startLoadTime ) / 1000.0 },
+        { "netlist", ( stats_endNetlistTime - stats_startNetlistTime ) / 1000.0 },
+        { "erc",     ( stats_endErcTime - stats_startErcTime ) / 1000.0 },
+    };
+
+    std::string text = json11::Json( report ).dump() + "\n";
+    wxFFile     file( reportFile.GetFullPath(), "wt" );
+
+    if( !file.IsOpened() || file.Write( text.data(), text.size() ) != text.size() )
+    {
+        fprintf( stderr, "Unable to write the report %s\n",
+                 TO_UTF8( reportFile.GetFullPath() ) );
+        return 1;
+    }
+
+    printf( "%d ERC errors in %s\n", errorCount, TO_UTF8( rootFile.GetFullName() ) );
+    printf( "  Load schematic:        %.3f ms\n",
+            (float)( stats_endLoadTime - stats_startLoadTime ) / 1000.0f );
+    printf( "  Build netlist:         %.3f ms\n",
+            (float)( stats_endNetlistTime - stats_startNetlistTime ) / 1000.0f );
+    printf( "  ERC:                   %.3f ms\n",
+            (float)( stats_endErcTime - stats_startErcTime ) / 1000.0f );
+
+    return errorCount ? 1 : 0;
+}
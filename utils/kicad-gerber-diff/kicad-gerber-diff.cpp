@@ -0,0 +1,197 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Compares two sets of fabrication files (Gerber and Excellon drill files), for instance
+ * the files of a board plotted by two versions of KiCad, and prints the regions drawn by
+ * only one of the sets.  Two directories are compared file by file, the files having the
+ * same name.  Meant for build scripts and continuous integration, it does not need a
+ * display.
+ *
+ * The exit status is 0 if the files draw the same shapes, 1 if they have differences
+ * (or a file cannot be read) and 2 on command line errors.
+ */
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+#include <wx/dir.h>
+#include <wx/filename.h>
+#include <wx/image.h>
+
+#include <common.h>
+#include <macros.h>
+#include <profile.h>
+#include <reporter.h>
+#include <convert_to_biu.h>
+#include <wildcards_and_files_ext.h>
+#include <gerber_diff.h>
+
+#include <cstdio>
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help", "show this help message",
+      wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "r", "resolution",
+      "size of the smallest difference to report, in mm (default: 0.01)",
+      wxCMD_LINE_VAL_DOUBLE, 0 },
+    { wxCMD_LINE_OPTION, NULL, "png", "folder of the PNG images of the differences",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_PARAM, NULL, NULL, "reference file or folder",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_PARAM, NULL, NULL, "compared file or folder",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_NONE }
+};
+
+
+/**
+ * @return the names of the files of aDirectory which can be compared (the job files
+ * and the drill reports are not drawings)
+ */
+static wxArrayString listFiles( const wxString& aDirectory )
+{
+    wxArrayString files;
+    wxDir         dir( aDirectory );
+    wxString      filename;
+
+    for( bool found = dir.GetFirst( &filename, wxEmptyString, wxDIR_FILES );
+         found;
+         found = dir.GetNext( &filename ) )
+    {
+        wxString ext = wxFileName( filename ).GetExt();
+
+        if( ext.CmpNoCase( GerberJobFileExtension ) == 0
+                || ext.CmpNoCase( ReportFileExtension ) == 0 )
+            continue;
+
+        files.Add( filename );
+    }
+
+    files.Sort();
+    return files;
+}
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return 2;
+    }
+
+    wxCmdLineParser parser( g_cmdLineDesc, argc, argv );
+
+    switch( parser.Parse() )
+    {
+    case 0:
+        break;
+
+    case -1:    // help requested
+        return 0;
+
+    default:
+        return 2;
+    }
+
+    double resolution = 0.01;
+    parser.Found( "resolution", &resolution );
+
+    if( resolution < 0.0 )
+    {
+        fprintf( stderr, "Invalid resolution: %g\n", resolution );
+        return 2;
+    }
+
+    wxString reference = parser.GetParam( 0 );
+    wxString compared = parser.GetParam( 1 );
+    GERBER_DIFF_JOB diffJob( Millimeter2iu( resolution ) );
+    int onlyInOneSet = 0;
+
+    if( wxDirExists( reference ) && wxDirExists( compared ) )
+    {
+        wxArrayString referenceFiles = listFiles( reference );
+        wxArrayString comparedFiles = listFiles( compared );
+
+        for( const wxString& filename : referenceFiles )
+        {
+            if( comparedFiles.Index( filename ) == wxNOT_FOUND )
+            {
+                printf( "%s: only in %s\n", TO_UTF8( filename ), TO_UTF8( reference ) );
+                onlyInOneSet++;
+                continue;
+            }
+
+            diffJob.AddFiles( wxFileName( reference, filename ).GetFullPath(),
+                              wxFileName( compared, filename ).GetFullPath() );
+        }
+
+        for( const wxString& filename : comparedFiles )
+        {
+            if( referenceFiles.Index( filename ) == wxNOT_FOUND )
+            {
+                printf( "%s: only in %s\n", TO_UTF8( filename ), TO_UTF8( compared ) );
+                onlyInOneSet++;
+            }
+        }
+    }
+    else if( wxFileExists( reference ) && wxFileExists( compared ) )
+    {
+        diffJob.AddFiles( reference, compared );
+    }
+    else
+    {
+        fprintf( stderr, "The reference and compared paths must be two files or two folders\n" );
+        return 2;
+    }
+
+    wxString imageDir;
+
+    if( parser.Found( "png", &imageDir ) )
+    {
+        if( !wxDirExists( imageDir ) && !wxFileName::Mkdir( imageDir, wxS_DIR_DEFAULT,
+                                                            wxPATH_MKDIR_FULL ) )
+        {
+            fprintf( stderr, "Unable to create the folder %s\n", TO_UTF8( imageDir ) );
+            return 2;
+        }
+
+        wxImage::AddHandler( new wxPNGHandler );
+        diffJob.SetDiffImageDirectory( imageDir );
+    }
+
+    unsigned stats_startDiffTime = GetRunningMicroSecs();
+    bool identical = diffJob.Run( &STDOUT_REPORTER::GetInstance() );
+    unsigned stats_endDiffTime = GetRunningMicroSecs();
+
+    printf( "%d files with differences, %d files in only one set\n",
+            diffJob.GetDiffCount(), onlyInOneSet );
+    printf( "  Compare:               %.3f ms\n",
+            (float)( stats_endDiffTime - stats_startDiffTime ) / 1000.0f );
+
+    return identical && onlyInOneSet == 0 ? 0 : 1;
+}
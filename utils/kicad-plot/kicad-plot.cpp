@@ -0,0 +1,195 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Creates the fabrication files of a board: the Gerber files of the layers, the
+ * drill files and the Gerber job file.  The other plot options (aux origin,
+ * X2 attributes, ...) are the options saved in the board, the drill file options
+ * are the options of the pcbnew drill dialog.  Meant for build scripts
+ * and continuous integration, it does not need a display.
+ */
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+#include <wx/config.h>
+#include <wx/filename.h>
+#include <wx/tokenzr.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <kiway.h>
+#include <common.h>
+#include <macros.h>
+#include <profile.h>
+#include <reporter.h>
+#include <class_board.h>
+#include <kicad_plugin.h>
+#include <plot_job.h>
+
+#include <cstdio>
+#include <memory>
+
+
+/**
+ * The program object of the pcbnew code: the tool has no application window,
+ * and uses the environment variables of the process.
+ */
+static struct PGM_KICAD_PLOT : public PGM_BASE
+{
+    void MacOpenFile( const wxString& aFileName ) override {}
+}
+program;
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help", "show this help message",
+      wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "o", "output", "output folder (default: the board folder)",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, "l", "layers",
+      "comma separated list of the layer names to plot "
+      "(default: the enabled copper, mask, paste, silk screen and board outline layers)",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_SWITCH, NULL, "no-drill", "do not create the drill files",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_SWITCH, NULL, "no-job-file", "do not create the Gerber job file",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_SWITCH, NULL, "protel-ext", "use the Protel file name extensions",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_PARAM, NULL, NULL, "board file",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_NONE }
+};
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return 1;
+    }
+
+    wxCmdLineParser parser( g_cmdLineDesc, argc, argv );
+
+    switch( parser.Parse() )
+    {
+    case 0:
+        break;
+
+    case -1:    // help requested
+        return 0;
+
+    default:
+        return 1;
+    }
+
+    wxFileName boardFile( parser.GetParam( 0 ) );
+    boardFile.MakeAbsolute();
+
+    wxString outputDir = boardFile.GetPath();
+    parser.Found( "output", &outputDir );
+
+    // The pcbnew code gets the program object from the kiface getter
+    int kifaceVersion;
+    KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+
+    // Load the board
+    unsigned stats_startLoadTime = GetRunningMicroSecs();
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        PLUGIN::RELEASER pi( new PCB_IO );
+        board.reset( pi->Load( boardFile.GetFullPath(), NULL, NULL ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        fprintf( stderr, "Error loading board: %s\n", TO_UTF8( ioe.What() ) );
+        return 1;
+    }
+
+    unsigned stats_endLoadTime = GetRunningMicroSecs();
+
+    LSET layers;
+    wxString layerNames;
+
+    if( parser.Found( "layers", &layerNames ) )
+    {
+        wxStringTokenizer tokenizer( layerNames, "," );
+
+        while( tokenizer.HasMoreTokens() )
+        {
+            wxString name = tokenizer.GetNextToken().Trim().Trim( false );
+            PCB_LAYER_ID layer = board->GetLayerID( name );
+
+            if( layer == UNDEFINED_LAYER )
+            {
+                fprintf( stderr, "Unknown layer: %s\n", TO_UTF8( name ) );
+                return 1;
+            }
+
+            layers.set( layer );
+        }
+    }
+    else
+    {
+        layers = LSET::AllCuMask() | LSET( 7, F_Mask, B_Mask, F_Paste, B_Paste,
+                                           F_SilkS, B_SilkS, Edge_Cuts );
+        layers &= board->GetEnabledLayers();
+    }
+
+    PCB_PLOT_PARAMS plotOptions = board->GetPlotOptions();
+
+    plotOptions.SetFormat( PLOT_FORMAT_GERBER );
+    plotOptions.SetOutputDirectory( outputDir );
+    plotOptions.SetLayerSelection( layers );
+    plotOptions.SetCreateGerberJobFile( !parser.Found( "no-job-file" ) );
+    plotOptions.SetUseGerberProtelExtensions( parser.Found( "protel-ext" ) );
+    plotOptions.SetScale( 1 );
+    plotOptions.SetAutoScale( false );
+    plotOptions.SetMirror( false );
+    plotOptions.SetPlotFrameRef( false );
+
+    // The drill files use the options of the pcbnew drill dialog
+    std::unique_ptr<wxConfigBase> pcbnewConfig( GetNewConfig( wxT( "pcbnew" ) ) );
+
+    PLOT_JOB plotJob( board.get(), plotOptions );
+    plotJob.SetCreateDrillFiles( !parser.Found( "no-drill" ) );
+    plotJob.LoadDrillOptions( pcbnewConfig.get() );
+
+    unsigned stats_startPlotTime = GetRunningMicroSecs();
+    bool success = plotJob.Run( &STDOUT_REPORTER::GetInstance() );
+    unsigned stats_endPlotTime = GetRunningMicroSecs();
+
+    printf( "Plotted %u files of %s\n", (unsigned) plotJob.GetOutputFiles().GetCount(),
+            TO_UTF8( boardFile.GetFullName() ) );
+    printf( "  Load board:            %.3f ms\n",
+            (float)( stats_endLoadTime - stats_startLoadTime ) / 1000.0f );
+    printf( "  Plot:                  %.3f ms\n",
+            (float)( stats_endPlotTime - stats_startPlotTime ) / 1000.0f );
+
+    return success ? 0 : 1;
+}
@@ -0,0 +1,230 @@
+/*
+ * This program source code file is part of KiCad, a free EDA CAD application.
+ *
+ * Copyright (C) 2018 KiCad Developers, see AUTHORS.txt for contributors.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, you may find one here:
+ * http://www.gnu.org/licenses/old-licenses/gpl-2.0.html
+ * or you may search the http://www.gnu.org website for the version 2 license,
+ * or you may write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA
+ */
+
+/*
+ * Renders a board with the 3D viewer raytracer and saves the result as a PNG file.
+ * Rendering runs on the CPU only, so it does not need a display nor a graphics card.
+ */
+
+#include <wx/init.h>
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+#include <wx/image.h>
+
+#include <fctsys.h>
+#include <pgm_base.h>
+#include <kiway.h>
+#include <common.h>
+#include <macros.h>
+#include <profile.h>
+#include <class_board.h>
+#include <kicad_plugin.h>
+
+#include <3d_canvas/cinfo3d_visu.h>
+#include <3d_cache/3d_cache.h>
+#include <3d_rendering/3d_render_raytracing/c3d_render_raytracing.h>
+
+#include <cmath>
+#include <cstdio>
+#include <memory>
+
+
+/**
+ * The program object of the pcbnew code: the tool has no application window,
+ * and uses the environment variables of the process.
+ */
+static struct PGM_KICAD_RAYTRACE : public PGM_BASE
+{
+    void MacOpenFile( const wxString& aFileName ) override {}
+}
+program;
+
+
+static const wxCmdLineEntryDesc g_cmdLineDesc[] =
+{
+    { wxCMD_LINE_SWITCH, "h", "help", "show this help message",
+      wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+    { wxCMD_LINE_OPTION, "o", "output", "output PNG file (default: the board file name)",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_OPTION, NULL, "width", "image width in pixels (default: 1600)",
+      wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, NULL, "height", "image height in pixels (default: 900)",
+      wxCMD_LINE_VAL_NUMBER, 0 },
+    { wxCMD_LINE_OPTION, NULL, "rotate-x", "camera rotation around the X axis, in degrees",
+      wxCMD_LINE_VAL_DOUBLE, 0 },
+    { wxCMD_LINE_OPTION, NULL, "rotate-y", "camera rotation around the Y axis, in degrees",
+      wxCMD_LINE_VAL_DOUBLE, 0 },
+    { wxCMD_LINE_OPTION, NULL, "rotate-z", "camera rotation around the Z axis, in degrees",
+      wxCMD_LINE_VAL_DOUBLE, 0 },
+    { wxCMD_LINE_OPTION, NULL, "zoom", "zoom factor (default: 1)",
+      wxCMD_LINE_VAL_DOUBLE, 0 },
+    { wxCMD_LINE_SWITCH, "a", "antialias", "enable anti-aliasing",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_SWITCH, NULL, "no-post-processing", "disable ambient occlusion",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_SWITCH, NULL, "no-models", "do not load the 3D models",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_SWITCH, NULL, "floor", "render the back floor",
+      wxCMD_LINE_VAL_NONE, 0 },
+    { wxCMD_LINE_PARAM, NULL, NULL, "board file",
+      wxCMD_LINE_VAL_STRING, 0 },
+    { wxCMD_LINE_NONE }
+};
+
+
+int main( int argc, char** argv )
+{
+    wxInitializer initializer( argc, argv );
+
+    if( !initializer.IsOk() )
+    {
+        fprintf( stderr, "Failed to initialize wxWidgets\n" );
+        return 1;
+    }
+
+    wxCmdLineParser parser( g_cmdLineDesc, argc, argv );
+
+    switch( parser.Parse() )
+    {
+    case 0:
+        break;
+
+    case -1:    // help requested
+        return 0;
+
+    default:
+        return 1;
+    }
+
+    wxFileName boardFile( parser.GetParam( 0 ) );
+    boardFile.MakeAbsolute();
+
+    wxFileName outputFile( boardFile );
+    outputFile.SetExt( "png" );
+
+    wxString output;
+
+    if( parser.Found( "output", &output ) )
+        outputFile.Assign( output );
+
+    long width = 1600;
+    long height = 900;
+    double zoom = 1.0;
+    double rotation[3] = { 0.0, 0.0, 0.0 };
+
+    parser.Found( "width", &width );
+    parser.Found( "height", &height );
+    parser.Found( "zoom", &zoom );
+    parser.Found( "rotate-x", &rotation[0] );
+    parser.Found( "rotate-y", &rotation[1] );
+    parser.Found( "rotate-z", &rotation[2] );
+
+    wxImage::AddHandler( new wxPNGHandler );
+
+    // The pcbnew code gets the program object from the kiface getter
+    int kifaceVersion;
+    KIFACE_GETTER( &kifaceVersion, KIFACE_VERSION, &program );
+
+    // Load the board
+    unsigned stats_startLoadTime = GetRunningMicroSecs();
+    std::unique_ptr<BOARD> board;
+
+    try
+    {
+        PLUGIN::RELEASER pi( new PCB_IO );
+        board.reset( pi->Load( boardFile.GetFullPath(), NULL, NULL ) );
+    }
+    catch( const IO_ERROR& ioe )
+    {
+        fprintf( stderr, "Error loading board: %s\n", TO_UTF8( ioe.What() ) );
+        return 1;
+    }
+
+    unsigned stats_endLoadTime = GetRunningMicroSecs();
+
+    // Set up the scene
+    CINFO3D_VISU settings;
+
+    settings.SetBoard( board.get() );
+    settings.RenderEngineSet( RENDER_ENGINE_RAYTRACING );
+    settings.SetFlag( FL_RENDER_RAYTRACING_SHADOWS, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_REFRACTIONS, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_REFLECTIONS, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_PROCEDURAL_TEXTURES, true );
+    settings.SetFlag( FL_RENDER_RAYTRACING_POST_PROCESSING,
+                      !parser.Found( "no-post-processing" ) );
+    settings.SetFlag( FL_RENDER_RAYTRACING_ANTI_ALIASING, parser.Found( "antialias" ) );
+    settings.SetFlag( FL_RENDER_RAYTRACING_BACKFLOOR, parser.Found( "floor" ) );
+
+    // The models cache must outlive the renderer, which keeps pointers to the models
+    S3D_CACHE cache;
+
+    if( !parser.Found( "no-models" ) )
+    {
+        wxFileName cfgpath;
+        cfgpath.AssignDir( GetKicadConfigPath() );
+        cfgpath.AppendDir( wxT( "3d" ) );
+        cache.SetProgramBase( &program );
+        cache.Set3DConfigDir( cfgpath.GetFullPath() );
+        cache.SetProjectDir( boardFile.GetPath() );
+        settings.Set3DCacheManager( &cache );
+    }
+
+    CCAMERA& camera = settings.CameraGet();
+
+    camera.RotateX( (float)( rotation[0] * M_PI / 180.0 ) );
+    camera.RotateY( (float)( rotation[1] * M_PI / 180.0 ) );
+    camera.RotateZ( (float)( rotation[2] * M_PI / 180.0 ) );
+
+    if( zoom > 0.0 )
+        camera.Zoom( (float) zoom );
+
+    // Render
+    C3D_RENDER_RAYTRACING renderer( settings );
+    RT_RENDER_TIMES times;
+    wxImage image;
+
+    renderer.ReloadRequest();
+
+    if( !renderer.RenderToImage( wxSize( width, height ), image, &times ) )
+    {
+        fprintf( stderr, "Could not render the board\n" );
+        return 1;
+    }
+
+    if( !image.SaveFile( outputFile.GetFullPath(), wxBITMAP_TYPE_PNG ) )
+    {
+        fprintf( stderr, "Could not write %s\n", TO_UTF8( outputFile.GetFullPath() ) );
+        return 1;
+    }
+
+    printf( "Rendered %s (%ldx%ld)\n", TO_UTF8( outputFile.GetFullPath() ), width, height );
+    printf( "  Load board:            %.3f ms\n",
+            (float)( stats_endLoadTime - stats_startLoadTime ) / 1000.0f );
+    printf( "  Build scene:           %.3f ms\n", times.m_sceneBuild );
+    printf( "  Build BVH:             %.3f ms\n", times.m_acceleratorBuild );
+    printf( "  Trace:                 %.3f ms\n", times.m_tracing );
+    printf( "  Post process:          %.3f ms\n", times.m_postProcessing );
+
+    return 0;
+}